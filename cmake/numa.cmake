@@ -0,0 +1,33 @@
+# Copyright (C) 2016, MariaDB Corporation. All Rights Reserved.
+#
+# This program is free software; you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation; version 2 of the License.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+SET(WITH_NUMA OFF CACHE STRING
+  "Build with libnuma. Possible values are 'ON', 'OFF', 'AUTO' and default is 'OFF'")
+
+MACRO (MYSQL_CHECK_NUMA)
+  IF (WITH_NUMA STREQUAL "ON" OR WITH_NUMA STREQUAL "AUTO")
+    CHECK_INCLUDE_FILES(numa.h HAVE_NUMA_H)
+    CHECK_INCLUDE_FILES(numaif.h HAVE_NUMAIF_H)
+    CHECK_LIBRARY_EXISTS(numa numa_run_on_node "" HAVE_NUMA_SHARED_LIB)
+
+    IF(HAVE_NUMA_SHARED_LIB AND HAVE_NUMA_H AND HAVE_NUMAIF_H)
+      ADD_DEFINITIONS(-DHAVE_LIBNUMA=1)
+      LINK_LIBRARIES(numa)
+    ELSE()
+      IF (WITH_NUMA STREQUAL "ON")
+	MESSAGE(FATAL_ERROR "Required numa library is not found")
+      ENDIF()
+    ENDIF()
+  ENDIF()
+ENDMACRO()
@@ -77,7 +77,8 @@ typedef
 typedef
   void   (*CHANGE_KEY_CACHE_PARAM)
            (void *keycache_cb,
-            uint division_limit, uint age_threshold);
+            uint division_limit, uint age_threshold,
+            my_bool lockfree_hits);
 typedef
   uchar* (*KEY_CACHE_READ)
            (void *keycache_cb,
@@ -149,6 +150,7 @@ typedef struct st_key_cache
   ulonglong param_age_threshold; /* determines when hot block is downgraded  */
   ulonglong param_partitions;    /* number of the key cache partitions       */
   ulonglong changed_blocks_hash_size; /* number of hash buckets for changed files */
+  ulonglong param_lockfree_hits; /* read cached blocks without locking      */
   my_bool key_cache_inited;      /* <=> key cache has been created           */
   my_bool can_be_used;           /* usage of cache for read/write is allowed */
   my_bool in_init;               /* set to 1 in MySQL during init/resize     */
@@ -169,7 +171,7 @@ extern int resize_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
 			    size_t use_mem, uint division_limit,
 			    uint age_threshold, uint changed_blocks_hash_size);
 extern void change_key_cache_param(KEY_CACHE *keycache, uint division_limit,
-				   uint age_threshold);
+				   uint age_threshold, my_bool lockfree_hits);
 extern uchar *key_cache_read(KEY_CACHE *keycache,
                             File file, my_off_t filepos, int level,
                             uchar *buff, uint length,
@@ -266,9 +266,11 @@ extern ulong maria_concurrent_insert;
 extern my_bool maria_flush, maria_single_user, maria_page_checksums;
 extern my_bool maria_delay_key_write;
 extern my_off_t maria_max_temp_length;
+extern ulonglong maria_tmp_table_pagecache_size;
 extern ulong maria_bulk_insert_tree_size, maria_data_pointer_size;
 extern MY_TMPDIR *maria_tmpdir;
 extern my_bool maria_encrypt_tables;
+extern my_bool maria_row_locking;
 
 /*
   This is used to check if a symlink points into the mysql data home,
@@ -252,6 +252,7 @@ extern ulong myisam_data_pointer_size;
 /* which is normally forbidden                                        */
 extern int (*myisam_test_invalid_symlink)(const char *filename);
 extern ulonglong myisam_mmap_size, myisam_mmap_used;
+extern my_bool myisam_mmap_index;
 extern mysql_mutex_t THR_LOCK_myisam_mmap;
 
 	/* Prototypes for myisam-functions */
@@ -109,6 +109,7 @@ typedef struct st_handler_check_param
   uint out_flag, warning_printed, error_printed, note_printed, verbose;
   uint opt_sort_key, total_files, max_level;
   uint key_cache_block_size, pagecache_block_size;
+  uint repair_threads;                          /* 0: one per index */
   int tmpfile_createflag, err_count;
   myf myf_rw;
   uint16 language;
@@ -57,6 +57,12 @@ enum thr_lock_type { TL_IGNORE=-1,
 		       READ, if one could use concurrent insert on table.
 		     */
 		     TL_WRITE_CONCURRENT_INSERT,
+                     /*
+                       WRITE lock used by UPDATE and DELETE that lock the
+                       rows they change. Allows other such writers and
+                       concurrent inserts, but no READ locks.
+                     */
+                     TL_WRITE_CONCURRENT_UPDATE,
 		     /* Write used by INSERT DELAYED.  Allows READ locks */
 		     TL_WRITE_DELAYED,
                      /* 
@@ -125,6 +131,7 @@ typedef struct st_thr_lock {
   /* write_lock_count is incremented for write locks and reset on read locks */
   ulong write_lock_count;
   uint read_no_write_count;
+  uint write_no_read_count;             /* TL_WRITE_CONCURRENT_UPDATE locks */
   void (*get_status)(void*, my_bool);	/* When one gets a lock */
   void (*copy_status)(void*,void*);
   void (*update_status)(void*);		/* Before release of write */
@@ -35,6 +35,7 @@
 #include <my_bit.h>
 #include <errno.h>
 #include <stdarg.h>
+#include <my_atomic.h>
 #include "probes_mysql.h"
 
 /****************************************************************************** 
@@ -132,6 +133,31 @@
   cache. Since they increment and decrement 'cnt_for_resize_op', the
   next resizer can wait on the queue 'waiting_for_resize_cnt' until all
   I/O finished.
+
+  Lock-free hits
+  ==============
+
+  With lockfree_hits set (key_cache_lockfree_hits in the server) a read
+  request tries to find its blocks without taking the cache_lock first.
+  The hash_links and blocks live in arrays that are freed only by
+  end_simple_key_cache(), so a reader can walk a bucket chain while
+  other threads change it. What it finds is validated with the
+  lf_version of the block, used like a sequence lock: every change of
+  the page assigned to a block or of its buffer contents is done
+  between lf_block_change_begin() and lf_block_change_end() under the
+  cache_lock, which keep lf_version odd while the change is going on.
+  A reader that sees the same even lf_version before and after copying
+  the data has got a consistent page. Anything else, including a miss,
+  falls back to the locked path.
+
+  A lock-free hit does not register a request on the block, so the block
+  stays where it is in the LRU ring. It only sets lf_referenced. When
+  the block reaches the end of the LRU ring while lf_referenced is set,
+  find_key_block() relinks it as if it had been hit and takes the next
+  block instead (the second chance of the CLOCK algorithm).
+
+  end_simple_key_cache() clears lf_enabled and waits until the readers
+  counted in lf_slots have left before it frees the memory.
 */
 
 /* declare structures that is used by st_key_cache */
@@ -152,6 +178,17 @@ typedef struct st_keycache_wqueue
 /* Default size of hash for changed files */
 #define MIN_CHANGED_BLOCKS_HASH_SIZE 128
 
+/* Number of counters of lock-free readers, spread over cache lines */
+#define KEYCACHE_LF_SLOTS 32
+
+/* counters of lock-free readers, one cache line each */
+typedef struct st_keycache_lf_slot
+{
+  volatile int64 read_hits;      /* read requests served without cache_lock */
+  volatile int32 readers;        /* lock-free readers in the cache memory    */
+  char pad[64 - sizeof(int64) - sizeof(int32)];
+} KEYCACHE_LF_SLOT;
+
 /* Control block for a simple (non-partitioned) key cache */
 
 typedef struct st_simple_key_cache_cb
@@ -206,6 +243,9 @@ typedef struct st_simple_key_cache_cb
   int blocks;                   /* max number of blocks in the cache        */
   uint hash_factor;             /* factor used to calculate hash function   */
   my_bool in_init;		/* Set to 1 in MySQL during init/resize     */
+  my_bool lockfree_hits;        /* serve read hits without cache_lock       */
+  volatile int32 lf_enabled;    /* lockfree_hits and the memory is there    */
+  KEYCACHE_LF_SLOT lf_slots[KEYCACHE_LF_SLOTS]; /* lock-free readers        */
 } SIMPLE_KEY_CACHE_CB;
 
 /*
@@ -311,6 +351,9 @@ struct st_block_link
   uint hits_left;         /* number of hits left until promotion             */
   ulonglong last_hit_time; /* timestamp of the last hit                      */
   KEYCACHE_CONDVAR *condvar; /* condition variable for 'no readers' event    */
+  volatile int32 lf_version; /* odd while the page or buffer is changed     */
+  uint lf_changers;       /* nesting of lf_block_change_begin()              */
+  my_bool lf_referenced;  /* hit without cache_lock since last LRU move      */
 };
 
 KEY_CACHE dflt_key_cache_var;
@@ -432,6 +475,175 @@ static inline uint next_power(uint value)
 }
 
 
+/*
+  Lock-free hits need fences that the gcc __atomic builtins provide.
+  Without them every read takes the cache_lock.
+*/
+#ifdef __ATOMIC_SEQ_CST
+#define HAVE_KEYCACHE_LOCKFREE_HITS
+#define keycache_lf_rmb() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define keycache_lf_wmb() __atomic_thread_fence(__ATOMIC_RELEASE)
+#else
+#define keycache_lf_rmb() do { } while (0)
+#define keycache_lf_wmb() do { } while (0)
+#endif
+
+
+/*
+  Start a change of the page assigned to a block or of its buffer
+
+  SYNOPSIS
+    lf_block_change_begin()
+      block               the block to be changed
+
+  NOTES
+    Called with cache_lock held. Makes lf_version odd so that lock-free
+    readers discard what they copy from the block. Changes can nest,
+    several writers may copy into different parts of the same buffer.
+*/
+
+static inline void lf_block_change_begin(BLOCK_LINK *block)
+{
+  if (!block->lf_changers++)
+  {
+    my_atomic_add32(&block->lf_version, 1);
+    keycache_lf_wmb();
+  }
+}
+
+
+/*
+  End a change started with lf_block_change_begin()
+*/
+
+static inline void lf_block_change_end(BLOCK_LINK *block)
+{
+  DBUG_ASSERT(block->lf_changers);
+  if (!--block->lf_changers)
+    my_atomic_add32(&block->lf_version, 1);
+}
+
+
+/*
+  Allow or stop lock-free hits according to keycache->lockfree_hits
+
+  SYNOPSIS
+    set_lockfree_hits()
+      keycache            pointer to a key cache data structure
+
+  NOTES
+    Lock-free hits are stopped while the cache has no memory. Before
+    the memory is freed, we wait for the readers that are still in it.
+*/
+
+static void set_lockfree_hits(SIMPLE_KEY_CACHE_CB *keycache)
+{
+  uint i;
+#ifdef HAVE_KEYCACHE_LOCKFREE_HITS
+  if (keycache->lockfree_hits && keycache->disk_blocks > 0)
+  {
+    my_atomic_store32(&keycache->lf_enabled, 1);
+    return;
+  }
+#endif
+  my_atomic_store32(&keycache->lf_enabled, 0);
+  for (i= 0; i < KEYCACHE_LF_SLOTS; i++)
+  {
+    /* The readers only copy one block, so spin until they are out */
+    while (my_atomic_load32(&keycache->lf_slots[i].readers) && LF_BACKOFF)
+    {}
+  }
+}
+
+
+/*
+  Read data of one cache block without taking the cache_lock
+
+  SYNOPSIS
+    read_block_lockfree()
+      keycache            pointer to a key cache data structure
+      file                handler for the file to read page from
+      filepos             position of the page in the file
+      offset              offset of the data in the page
+      buff                buffer to copy the data to
+      length              length of the data, within the page
+
+  RETURN VALUE
+    1  the page was in the cache and its data is copied to buff
+    0  the data must be read with the cache_lock held
+*/
+
+static my_bool read_block_lockfree(SIMPLE_KEY_CACHE_CB *keycache,
+                                   File file, my_off_t filepos, uint offset,
+                                   uchar *buff, uint length)
+{
+#ifdef HAVE_KEYCACHE_LOCKFREE_HITS
+  KEYCACHE_LF_SLOT *slot= &keycache->lf_slots[my_thread_var->id %
+                                              KEYCACHE_LF_SLOTS];
+  my_bool hit= 0;
+
+  my_atomic_add32(&slot->readers, 1);
+  if (my_atomic_load32(&keycache->lf_enabled) && !keycache->in_resize)
+  {
+    HASH_LINK *hash_link= keycache->hash_root[KEYCACHE_HASH(file, filepos)];
+    BLOCK_LINK *block;
+    int steps= keycache->hash_links;
+
+    /*
+      A hash_link can be moved to another bucket or to the free list
+      while we follow the chain. Then we may miss the page or run in a
+      circle. The first is not worse than a miss, for the second we
+      limit the number of steps.
+    */
+    while (hash_link &&
+           (hash_link->diskpos != filepos || hash_link->file != file) &&
+           --steps > 0)
+      hash_link= hash_link->next;
+
+    if (hash_link && steps > 0 && (block= hash_link->block))
+    {
+      int32 version= my_atomic_load32(&block->lf_version);
+      if (!(version & 1) &&
+          block->hash_link == hash_link &&
+          hash_link->diskpos == filepos && hash_link->file == file &&
+          (block->status & (BLOCK_READ | BLOCK_ERROR | BLOCK_REASSIGNED)) ==
+          BLOCK_READ &&
+          block->length >= offset + length)
+      {
+        memcpy(buff, block->buffer + offset, (size_t) length);
+        keycache_lf_rmb();
+        if (my_atomic_load32(&block->lf_version) == version)
+        {
+          if (!block->lf_referenced)
+            block->lf_referenced= 1;
+          my_atomic_add64(&slot->read_hits, (int64) 1);
+          hit= 1;
+        }
+      }
+    }
+  }
+  my_atomic_add32(&slot->readers, -1);
+  return hit;
+#else
+  return 0;
+#endif
+}
+
+
+/*
+  Number of read requests served without the cache_lock
+*/
+
+static ulonglong lockfree_read_hits(SIMPLE_KEY_CACHE_CB *keycache)
+{
+  ulonglong hits= 0;
+  uint i;
+  for (i= 0; i < KEYCACHE_LF_SLOTS; i++)
+    hits+= my_atomic_load64(&keycache->lf_slots[i].read_hits);
+  return hits;
+}
+
+
 /*
   Initialize a simple key cache
 
@@ -478,6 +690,7 @@ int init_simple_key_cache(SIMPLE_KEY_CACHE_CB *keycache,
   ulong blocks, hash_links;
   size_t length;
   int error;
+  uint i;
   DBUG_ENTER("init_simple_key_cache");
   DBUG_ASSERT(key_cache_block_size >= 512);
 
@@ -501,6 +714,9 @@ int init_simple_key_cache(SIMPLE_KEY_CACHE_CB *keycache,
       Initialize these variables once only.
       Their value must survive re-initialization during resizing.
     */
+    keycache->lockfree_hits= 0;
+    keycache->lf_enabled= 0;
+    bzero(keycache->lf_slots, sizeof(keycache->lf_slots));
     keycache->in_resize= 0;
     keycache->resize_in_flush= 0;
     keycache->cnt_for_resize_op= 0;
@@ -510,6 +726,8 @@ int init_simple_key_cache(SIMPLE_KEY_CACHE_CB *keycache,
                      &keycache->cache_lock, MY_MUTEX_INIT_FAST);
     keycache->resize_queue.last_thread= NULL;
   }
+  for (i= 0; i < KEYCACHE_LF_SLOTS; i++)
+    keycache->lf_slots[i].read_hits= 0;
 
   keycache->key_cache_mem_size= use_mem;
   keycache->key_cache_block_size= key_cache_block_size;
@@ -604,6 +822,7 @@ int init_simple_key_cache(SIMPLE_KEY_CACHE_CB *keycache,
 			      blocks);
     keycache->changed_blocks_hash_size= changed_blocks_hash_size;
     keycache->can_be_used= 1;
+    set_lockfree_hits(keycache);
 
     keycache->waiting_for_hash_link.last_thread= NULL;
     keycache->waiting_for_block.last_thread= NULL;
@@ -898,6 +1117,7 @@ static inline void dec_counter_for_resize_op(SIMPLE_KEY_CACHE_CB *keycache)
     keycache                pointer to the control block of a simple key cache	
     division_limit          new division limit (if not zero)
     age_threshold           new age threshold (if not zero)
+    lockfree_hits           <=> serve read hits without the cache_lock
 
   DESCRIPTION
     This function is the implementation of the change_key_cache_param interface
@@ -913,7 +1133,8 @@ static inline void dec_counter_for_resize_op(SIMPLE_KEY_CACHE_CB *keycache)
 
   NOTES.
     Presently the function resets the key cache parameters concerning
-    midpoint insertion strategy - division_limit and age_threshold.
+    midpoint insertion strategy - division_limit and age_threshold,
+    and lockfree_hits.
     This function changes some parameters of a given key cache without
     reformatting it. The function does not touch the contents the key 
     cache blocks.    
@@ -921,7 +1142,7 @@ static inline void dec_counter_for_resize_op(SIMPLE_KEY_CACHE_CB *keycache)
 
 static
 void change_simple_key_cache_param(SIMPLE_KEY_CACHE_CB *keycache, uint division_limit,
-			           uint age_threshold)
+			           uint age_threshold, my_bool lockfree_hits)
 {
   DBUG_ENTER("change_simple_key_cache_param");
   keycache_pthread_mutex_lock(&keycache->cache_lock);
@@ -931,6 +1152,8 @@ void change_simple_key_cache_param(SIMPLE_KEY_CACHE_CB *keycache, uint division_
   if (age_threshold)
     keycache->age_threshold=   (keycache->disk_blocks *
 				age_threshold / 100);
+  keycache->lockfree_hits= lockfree_hits;
+  set_lockfree_hits(keycache);
   keycache_pthread_mutex_unlock(&keycache->cache_lock);
   DBUG_VOID_RETURN;
 }
@@ -969,6 +1192,9 @@ void end_simple_key_cache(SIMPLE_KEY_CACHE_CB *keycache, my_bool cleanup)
 
   if (keycache->disk_blocks > 0)
   {
+    /* Let the lock-free readers leave the memory before it is freed */
+    keycache->disk_blocks= -1;
+    set_lockfree_hits(keycache);
     if (keycache->block_mem)
     {
       my_large_free((uchar*) keycache->block_mem);
@@ -976,7 +1202,6 @@ void end_simple_key_cache(SIMPLE_KEY_CACHE_CB *keycache, my_bool cleanup)
       my_free(keycache->block_root);
       keycache->block_root= NULL;
     }
-    keycache->disk_blocks= -1;
     /* Reset blocks_changed to be safe if flush_all_key_blocks is called */
     keycache->blocks_changed= 0;
   }
@@ -1543,6 +1768,73 @@ static void reg_requests(SIMPLE_KEY_CACHE_CB *keycache,
 }
 
 
+/*
+  Link a block without requests into the LRU ring after a hit
+
+  SYNOPSIS
+    link_block_after_hit()
+    keycache            pointer to a key cache data structure
+    block               pointer to the block to link to the LRU chain
+    at_end              <-> to link the block at the end of the LRU chain
+
+  NOTES.
+    See unreg_request(). Also used to give a block that was hit without
+    the cache_lock a second chance when it reaches the end of the LRU
+    ring.
+*/
+
+static void link_block_after_hit(SIMPLE_KEY_CACHE_CB *keycache,
+                                 BLOCK_LINK *block, int at_end)
+{
+  my_bool hot;
+  block->lf_referenced= 0;
+  if (block->hits_left)
+    block->hits_left--;
+  hot= !block->hits_left && at_end &&
+    keycache->warm_blocks > keycache->min_warm_blocks;
+  if (hot)
+  {
+    if (block->temperature == BLOCK_WARM)
+      keycache->warm_blocks--;
+    block->temperature= BLOCK_HOT;
+    KEYCACHE_DBUG_PRINT("link_block_after_hit", ("#warm_blocks: %lu",
+                         keycache->warm_blocks));
+  }
+  link_block(keycache, block, hot, (my_bool)at_end);
+  block->last_hit_time= keycache->keycache_time;
+  keycache->keycache_time++;
+  /*
+    At this place, the block might be in the LRU ring or not. If an
+    evicter was waiting for a block, it was selected for eviction and
+    not linked in the LRU ring.
+  */
+
+  /*
+    Check if we should link a hot block to the warm block sub-chain.
+    It is possible that we select the same block as above. But it can
+    also be another block. In any case a block from the LRU ring is
+    selected. In other words it works even if the above block was
+    selected for eviction and not linked in the LRU ring. Since this
+    happens only if the LRU ring is empty, the block selected below
+    would be NULL and the rest of the function skipped.
+  */
+  block= keycache->used_ins;
+  if (block && keycache->keycache_time - block->last_hit_time >
+	keycache->age_threshold)
+  {
+    unlink_block(keycache, block);
+    link_block(keycache, block, 0, 0);
+    if (block->temperature != BLOCK_WARM)
+    {
+      keycache->warm_blocks++;
+      block->temperature= BLOCK_WARM;
+    }
+    KEYCACHE_DBUG_PRINT("link_block_after_hit", ("#warm_blocks: %lu",
+                         keycache->warm_blocks));
+  }
+}
+
+
 /*
   Unregister request for a block
   linking it to the LRU chain if it's the last request
@@ -1589,55 +1881,10 @@ static void unreg_request(SIMPLE_KEY_CACHE_CB *keycache,
     LRU ring.
   */
   if (!--block->requests && !(block->status & BLOCK_ERROR))
-  {
-    my_bool hot;
-    if (block->hits_left)
-      block->hits_left--;
-    hot= !block->hits_left && at_end &&
-      keycache->warm_blocks > keycache->min_warm_blocks;
-    if (hot)
-    {
-      if (block->temperature == BLOCK_WARM)
-        keycache->warm_blocks--;
-      block->temperature= BLOCK_HOT;
-      KEYCACHE_DBUG_PRINT("unreg_request", ("#warm_blocks: %lu",
-                           keycache->warm_blocks));
-    }
-    link_block(keycache, block, hot, (my_bool)at_end);
-    block->last_hit_time= keycache->keycache_time;
-    keycache->keycache_time++;
-    /*
-      At this place, the block might be in the LRU ring or not. If an
-      evicter was waiting for a block, it was selected for eviction and
-      not linked in the LRU ring.
-    */
-
-    /*
-      Check if we should link a hot block to the warm block sub-chain.
-      It is possible that we select the same block as above. But it can
-      also be another block. In any case a block from the LRU ring is
-      selected. In other words it works even if the above block was
-      selected for eviction and not linked in the LRU ring. Since this
-      happens only if the LRU ring is empty, the block selected below
-      would be NULL and the rest of the function skipped.
-    */
-    block= keycache->used_ins;
-    if (block && keycache->keycache_time - block->last_hit_time >
-	keycache->age_threshold)
-    {
-      unlink_block(keycache, block);
-      link_block(keycache, block, 0, 0);
-      if (block->temperature != BLOCK_WARM)
-      {
-        keycache->warm_blocks++;
-        block->temperature= BLOCK_WARM;
-      }
-      KEYCACHE_DBUG_PRINT("unreg_request", ("#warm_blocks: %lu",
-                           keycache->warm_blocks));
-    }
-  }
+    link_block_after_hit(keycache, block, at_end);
 }
 
+
 /*
   Remove a reader of the page in block
 */
@@ -1838,6 +2085,43 @@ static HASH_LINK *get_hash_link(SIMPLE_KEY_CACHE_CB *keycache,
 }
 
 
+/*
+  Select the last block from the LRU ring for eviction
+
+  SYNOPSIS
+    lru_victim()
+      keycache            pointer to a key cache data structure
+
+  RETURN VALUE
+    The block to evict. It is still linked in the LRU ring.
+
+  NOTES
+    A block that was hit without the cache_lock since it was linked into
+    the LRU ring is linked again as if it had been hit now, and the next
+    one is tried (the second chance of the CLOCK algorithm). This ends
+    at the latest when the whole ring has been passed once.
+*/
+
+static BLOCK_LINK *lru_victim(SIMPLE_KEY_CACHE_CB *keycache)
+{
+  BLOCK_LINK *block= keycache->used_last->next_used;
+  ulong blocks= keycache->blocks_used;
+
+  /*
+    With threads waiting for a block, link_block() would hand the block
+    over to them instead of linking it into the LRU ring.
+  */
+  while (block->lf_referenced && blocks-- &&
+         !keycache->waiting_for_block.last_thread)
+  {
+    unlink_block(keycache, block);
+    link_block_after_hit(keycache, block, 1);
+    block= keycache->used_last->next_used;
+  }
+  return block;
+}
+
+
 /*
   Get a block for the file page requested by a keycache read/write operation;
   If the page is not in the cache return a free block, if there is none
@@ -2292,6 +2576,7 @@ static BLOCK_LINK *find_key_block(SIMPLE_KEY_CACHE_CB *keycache,
         DBUG_ASSERT(!block->status);
         DBUG_ASSERT(!block->requests);
         keycache->blocks_unused--;
+        lf_block_change_begin(block);
         block->status= BLOCK_IN_USE;
         block->length= 0;
         block->offset= keycache->key_cache_block_size;
@@ -2299,9 +2584,11 @@ static BLOCK_LINK *find_key_block(SIMPLE_KEY_CACHE_CB *keycache,
         block->temperature= BLOCK_COLD;
         block->hits_left= init_hits_left;
         block->last_hit_time= 0;
+        block->lf_referenced= 0;
         block->hash_link= hash_link;
         hash_link->block= block;
         link_to_file_list(keycache, block, file, 0);
+        lf_block_change_end(block);
         page_status= PAGE_TO_BE_READ;
         KEYCACHE_DBUG_PRINT("find_key_block",
                             ("got free or never used block %u",
@@ -2355,7 +2642,7 @@ static BLOCK_LINK *find_key_block(SIMPLE_KEY_CACHE_CB *keycache,
         if (! block)
         {
           /* Select the last block from the LRU ring. */
-          block= keycache->used_last->next_used;
+          block= lru_victim(keycache);
           block->hits_left= init_hits_left;
           block->last_hit_time= 0;
           hash_link->block= block;
@@ -2450,6 +2737,12 @@ static BLOCK_LINK *find_key_block(SIMPLE_KEY_CACHE_CB *keycache,
           }
 
           block->status|= BLOCK_REASSIGNED;
+          /*
+            Lock-free readers of the old page must not trust what they
+            copy from now on. unlink_hash() may give the old hash_link
+            to another page while the block still refers to it.
+          */
+          lf_block_change_begin(block);
           /*
             The block comes from the LRU ring. It must have a hash_link
             assigned.
@@ -2504,8 +2797,10 @@ static BLOCK_LINK *find_key_block(SIMPLE_KEY_CACHE_CB *keycache,
           block->status= error ? BLOCK_ERROR : BLOCK_IN_USE ;
           block->length= 0;
           block->offset= keycache->key_cache_block_size;
+          block->lf_referenced= 0;
           block->hash_link= hash_link;
           link_to_file_list(keycache, block, file, 0);
+          lf_block_change_end(block);
           page_status= PAGE_TO_BE_READ;
 
           KEYCACHE_DBUG_ASSERT(block->hash_link->block == block);
@@ -2655,6 +2950,7 @@ static void read_block(SIMPLE_KEY_CACHE_CB *keycache,
 
     keycache->global_cache_read++;
     /* Page is not in buffer yet, is to be read from disk */
+    lf_block_change_begin(block);
     keycache_pthread_mutex_unlock(&keycache->cache_lock);
     /*
       Here other threads may step in and register as secondary readers.
@@ -2688,6 +2984,7 @@ static void read_block(SIMPLE_KEY_CACHE_CB *keycache,
         keycache->key_cache_block_size.
       */
     }
+    lf_block_change_end(block);
     KEYCACHE_DBUG_PRINT("read_block",
                         ("primary request: new page in cache"));
     /* Signal that all pending requests for this page now can be processed */
@@ -2779,6 +3076,27 @@ uchar *simple_key_cache_read(SIMPLE_KEY_CACHE_CB *keycache,
     uint offset;
     int page_st;
 
+    if (keycache->lockfree_hits)
+    {
+      /*
+        Copy the blocks that are in the cache without taking the
+        cache_lock. Continue with the first block that is not.
+      */
+      do
+      {
+        offset= (uint) (filepos % keycache->key_cache_block_size);
+        read_length= length;
+        set_if_smaller(read_length, keycache->key_cache_block_size-offset);
+        if (!read_block_lockfree(keycache, file, filepos - offset, offset,
+                                 buff, read_length))
+          break;
+        buff+= read_length;
+        filepos+= read_length;
+      } while ((length-= read_length));
+      if (!length)
+        DBUG_RETURN(start);
+    }
+
     if (MYSQL_KEYCACHE_READ_START_ENABLED())
     {
       MYSQL_KEYCACHE_READ_START(my_filename(file), length,
@@ -3127,6 +3445,7 @@ int simple_key_cache_insert(SIMPLE_KEY_CACHE_CB *keycache,
           DBUG_ASSERT((page_st == PAGE_TO_BE_READ) ||
                       (block->status & BLOCK_READ));
 
+          lf_block_change_begin(block);
 #if !defined(SERIALIZED_READ_FROM_CACHE)
           keycache_pthread_mutex_unlock(&keycache->cache_lock);
           /*
@@ -3152,6 +3471,7 @@ int simple_key_cache_insert(SIMPLE_KEY_CACHE_CB *keycache,
           */
           block->status|= BLOCK_READ;
           block->length= read_length+offset;
+          lf_block_change_end(block);
           /*
             Do not set block->offset here. If this block is marked
             BLOCK_CHANGED later, we want to flush only the modified part. So
@@ -3477,6 +3797,7 @@ int simple_key_cache_write(SIMPLE_KEY_CACHE_CB *keycache,
       */
       if (!(block->status & BLOCK_ERROR))
       {
+        lf_block_change_begin(block);
 #if !defined(SERIALIZED_READ_FROM_CACHE)
         keycache_pthread_mutex_unlock(&keycache->cache_lock);
 #endif
@@ -3485,6 +3806,7 @@ int simple_key_cache_write(SIMPLE_KEY_CACHE_CB *keycache,
 #if !defined(SERIALIZED_READ_FROM_CACHE)
         keycache_pthread_mutex_lock(&keycache->cache_lock);
 #endif
+        lf_block_change_end(block);
       }
 
       if (!dont_write)
@@ -3720,12 +4042,14 @@ static void free_block(SIMPLE_KEY_CACHE_CB *keycache, BLOCK_LINK *block)
   unlink_changed(block);
 
   /* Remove reference to block from hash table. */
+  lf_block_change_begin(block);
   unlink_hash(keycache, block->hash_link);
   block->hash_link= NULL;
 
   block->status= 0;
   block->length= 0;
   block->offset= keycache->key_cache_block_size;
+  lf_block_change_end(block);
   KEYCACHE_THREAD_TRACE("free block");
   KEYCACHE_DBUG_PRINT("free_block", ("block is freed"));
 
@@ -4539,6 +4863,7 @@ static
 int reset_simple_key_cache_counters(const char *name __attribute__((unused)),
                                     SIMPLE_KEY_CACHE_CB *keycache)
 {
+  uint i;
   DBUG_ENTER("reset_simple_key_cache_counters");
   if (!keycache->key_cache_inited)
   {
@@ -4552,6 +4877,8 @@ int reset_simple_key_cache_counters(const char *name __attribute__((unused)),
   keycache->global_cache_read= 0;       /* Key_reads */
   keycache->global_cache_w_requests= 0; /* Key_write_requests */
   keycache->global_cache_write= 0;      /* Key_writes */
+  for (i= 0; i < KEYCACHE_LF_SLOTS; i++)
+    my_atomic_store64(&keycache->lf_slots[i].read_hits, (int64) 0);
   DBUG_RETURN(0);
 }
 
@@ -4888,7 +5215,8 @@ void get_simple_key_cache_statistics(SIMPLE_KEY_CACHE_CB *keycache,
   keycache_stats->blocks_unused= keycache->blocks_unused;
   keycache_stats->blocks_changed= keycache->global_blocks_changed;
   keycache_stats->blocks_warm= keycache->warm_blocks;
-  keycache_stats->read_requests= keycache->global_cache_r_requests;
+  keycache_stats->read_requests= (keycache->global_cache_r_requests +
+                                  lockfree_read_hits(keycache));
   keycache_stats->reads= keycache->global_cache_read;
   keycache_stats->write_requests= keycache->global_cache_w_requests;
   keycache_stats->writes= keycache->global_cache_write;
@@ -5288,6 +5616,7 @@ int resize_partitioned_key_cache(PARTITIONED_KEY_CACHE_CB *keycache,
     keycache            pointer to the control block of a partitioned key cache
     division_limit      new division limit (if not zero)
     age_threshold       new age threshold (if not zero)
+    lockfree_hits       <=> serve read hits without the cache_lock
 
   DESCRIPTION
     This function is the implementation of the change_key_cache_param interface
@@ -5309,7 +5638,8 @@ int resize_partitioned_key_cache(PARTITIONED_KEY_CACHE_CB *keycache,
 static
 void change_partitioned_key_cache_param(PARTITIONED_KEY_CACHE_CB *keycache,
                                         uint division_limit,
-                                        uint age_threshold)
+                                        uint age_threshold,
+                                        my_bool lockfree_hits)
 {
   uint i;
   uint partitions= keycache->partitions;
@@ -5317,7 +5647,7 @@ void change_partitioned_key_cache_param(PARTITIONED_KEY_CACHE_CB *keycache,
   for (i= 0; i < partitions; i++)
   {
     change_simple_key_cache_param(keycache->partition_array[i], division_limit,
-                                  age_threshold);
+                                  age_threshold, lockfree_hits);
   }
   DBUG_VOID_RETURN;
 }
@@ -5777,7 +6107,8 @@ get_partitioned_key_cache_statistics(PARTITIONED_KEY_CACHE_CB *keycache,
     keycache_stats->blocks_unused+= partition->blocks_unused;
     keycache_stats->blocks_changed+= partition->global_blocks_changed;
     keycache_stats->blocks_warm+= partition->warm_blocks;
-    keycache_stats->read_requests+= partition->global_cache_r_requests;
+    keycache_stats->read_requests+= (partition->global_cache_r_requests +
+                                     lockfree_read_hits(partition));
     keycache_stats->reads+= partition->global_cache_read;
     keycache_stats->write_requests+= partition->global_cache_w_requests;
     keycache_stats->writes+= partition->global_cache_write;
@@ -6079,30 +6410,35 @@ int resize_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
     keycache            pointer to the key cache to change parameters for
     division_limit      new division limit (if not zero)
     age_threshold       new age threshold (if not zero)
+    lockfree_hits       <=> serve read hits without the cache_lock
 
   DESCRIPTION
     The function sets new values of the division limit and the age threshold 
     used when the key cache keycach employs midpoint insertion strategy.
     The parameters division_limit and age_threshold provide these new values.
+    The parameter lockfree_hits says whether blocks found in the cache
+    are read without locking the cache.
 
   RETURN VALUE
     none
 
   NOTES
     Currently the function is called when the values of the variables
-    key_cache_division_limit and/or key_cache_age_threshold are being reset
-    for the key cache keycache.
+    key_cache_division_limit, key_cache_age_threshold and/or
+    key_cache_lockfree_hits are being reset for the key cache keycache,
+    and after the key cache has been initialized or repartitioned.
 */
 
 void change_key_cache_param(KEY_CACHE *keycache, uint division_limit,
-			    uint age_threshold)
+			    uint age_threshold, my_bool lockfree_hits)
 {
   if (keycache->key_cache_inited)
   {
     pthread_mutex_lock(&keycache->op_lock);    
     keycache->interface_funcs->change_param(keycache->keycache_cb,
                                             division_limit,
-                                            age_threshold);    
+                                            age_threshold,
+                                            lockfree_hits);    
     pthread_mutex_unlock(&keycache->op_lock);
   }
 }
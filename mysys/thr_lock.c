@@ -32,6 +32,9 @@ TL_READ_NO_INSERT	# Read without concurrent inserts
 TL_WRITE_ALLOW_WRITE	# Write lock that allows other writers
 TL_WRITE_CONCURRENT_INSERT
 			# Insert that can be mixed when selects
+TL_WRITE_CONCURRENT_UPDATE
+			# Update that can be mixed with inserts and other
+			# updates, but not with selects
 TL_WRITE_DELAYED	# Used by delayed insert
 			# Allows lower locks to take over
 TL_WRITE_LOW_PRIORITY	# Low priority write
@@ -41,7 +44,8 @@ TL_WRITE_ONLY		# High priority write
 
 Locks are prioritized according to:
 
-WRITE_ALLOW_WRITE, WRITE_CONCURRENT_INSERT, WRITE_DELAYED,
+WRITE_ALLOW_WRITE, WRITE_CONCURRENT_INSERT, WRITE_CONCURRENT_UPDATE,
+WRITE_DELAYED,
 WRITE_LOW_PRIORITY, READ, WRITE, READ_HIGH_PRIORITY and WRITE_ONLY
 
 Locks in the same privilege level are scheduled in first-in-first-out order.
@@ -78,6 +82,10 @@ one TL_WRITE_DELAYED lock at the same time as multiple read locks.
 
 In addition, if lock->allow_multiple_concurrent_insert is set then there can
 be any number of TL_WRITE_CONCURRENT_INSERT locks aktive at the same time.
+There can then also be any number of TL_WRITE_CONCURRENT_UPDATE locks,
+mixed with the TL_WRITE_CONCURRENT_INSERT locks. These are given to
+writers that lock the rows they change and change them in place, so they
+are not given together with any read lock.
 */
 
 #if !defined(MAIN) && !defined(DBUG_OFF) && !defined(EXTRA_DEBUG)
@@ -190,6 +198,30 @@ thr_lock_owner_equal(THR_LOCK_INFO *rhs, THR_LOCK_INFO *lhs)
 }
 
 
+static inline my_bool
+has_old_lock(THR_LOCK_DATA *data, THR_LOCK_INFO *owner)
+{
+  for ( ; data ; data=data->next)
+  {
+    if (thr_lock_owner_equal(data->owner, owner))
+      return 1;					/* Already locked by thread */
+  }
+  return 0;
+}
+
+
+/*
+  Write locks that can be mixed with each other if
+  lock->allow_multiple_concurrent_insert is set
+*/
+
+static inline my_bool concurrent_write_lock(enum thr_lock_type type)
+{
+  return type == TL_WRITE_CONCURRENT_INSERT ||
+         type == TL_WRITE_CONCURRENT_UPDATE;
+}
+
+
 #ifdef EXTRA_DEBUG
 #define MAX_FOUND_ERRORS	10		/* Report 10 first errors */
 static uint found_errors=0;
@@ -226,7 +258,9 @@ static int check_lock(struct st_lock_list *list, const char* lock_type,
                 lock_type, where);
         return 1;
       }
-      if (data->type != last_lock_type)
+      if (data->type != last_lock_type &&
+          !(concurrent_write_lock(data->type) &&
+            concurrent_write_lock(last_lock_type)))
 	last_lock_type=TL_IGNORE;
       if (data->prev != prev)
       {
@@ -238,7 +272,7 @@ static int check_lock(struct st_lock_list *list, const char* lock_type,
       if (same_owner &&
           !thr_lock_owner_equal(data->owner, first_owner) &&
 	  last_lock_type != TL_WRITE_ALLOW_WRITE &&
-          last_lock_type != TL_WRITE_CONCURRENT_INSERT)
+          !concurrent_write_lock(last_lock_type))
       {
 	fprintf(stderr,
 		"Warning: Found locks from different threads for lock '%s' in '%s' at '%s'.  org_lock_type: %d  last_lock_type: %d  new_lock_type: %d\n",
@@ -310,6 +344,18 @@ static void check_locks(THR_LOCK *lock, const char *where,
 	fprintf(stderr,
 		"Warning at '%s': Locks read_no_write_count was %u when it should have been %u\n", where, lock->read_no_write_count,count);
       }      
+      count= 0;
+      for (data=lock->write.data ; data ; data=data->next)
+      {
+        if (data->type == TL_WRITE_CONCURRENT_UPDATE)
+          count++;
+      }
+      if (count != lock->write_no_read_count)
+      {
+	found_errors++;
+	fprintf(stderr,
+		"Warning at '%s': Locks write_no_read_count was %u when it should have been %u\n", where, lock->write_no_read_count,count);
+      }
 
       if (!lock->write.data)
       {
@@ -337,7 +383,8 @@ static void check_locks(THR_LOCK *lock, const char *where,
 	      (((lock->write_wait.data->type == TL_WRITE_CONCURRENT_INSERT ||
 		 lock->write_wait.data->type == TL_WRITE_ALLOW_WRITE) &&
 		!lock->read_no_write_count) ||
-	       (lock->write_wait.data->type == TL_WRITE_DELAYED &&
+	       ((lock->write_wait.data->type == TL_WRITE_DELAYED ||
+                 lock->write_wait.data->type == TL_WRITE_CONCURRENT_UPDATE) &&
 		!lock->read.data)))
 	  {
 	    found_errors++;
@@ -350,14 +397,14 @@ static void check_locks(THR_LOCK *lock, const char *where,
       else
       {
         /* We have at least one write lock */
-        if (lock->write.data->type == TL_WRITE_CONCURRENT_INSERT)
+        if (concurrent_write_lock(lock->write.data->type))
         {
           count= 0;
           for (data=lock->write.data->next;
                data && count < MAX_LOCKS;
                data=data->next)
           {
-            if (data->type != TL_WRITE_CONCURRENT_INSERT)
+            if (!concurrent_write_lock(data->type))
             {
               fprintf(stderr,
                       "Warning at '%s': Found TL_WRITE_CONCURRENT_INSERT lock mixed with other write lock: %d\n",
@@ -393,7 +440,9 @@ static void check_locks(THR_LOCK *lock, const char *where,
 		lock->write.data->type != TL_WRITE_ONLY) ||
 	       ((lock->write.data->type == TL_WRITE_CONCURRENT_INSERT ||
 		 lock->write.data->type == TL_WRITE_ALLOW_WRITE) &&
-                data->type == TL_READ_NO_INSERT)))
+                data->type == TL_READ_NO_INSERT) ||
+               (lock->write_no_read_count &&
+                !has_old_lock(lock->write.data, data->owner))))
             {
               found_errors++;
               fprintf(stderr,
@@ -409,7 +458,8 @@ static void check_locks(THR_LOCK *lock, const char *where,
 	if (lock->read_wait.data)
 	{
 	  if (!allow_no_locks && lock->write.data->type <= TL_WRITE_DELAYED &&
-	      lock->read_wait.data->type <= TL_READ_HIGH_PRIORITY)
+	      lock->read_wait.data->type <= TL_READ_HIGH_PRIORITY &&
+              !lock->write_no_read_count)
 	  {
 	    found_errors++;
 	    fprintf(stderr,
@@ -486,17 +536,6 @@ void thr_lock_data_init(THR_LOCK *lock,THR_LOCK_DATA *data, void *param)
 }
 
 
-static inline my_bool
-has_old_lock(THR_LOCK_DATA *data, THR_LOCK_INFO *owner)
-{
-  for ( ; data ; data=data->next)
-  {
-    if (thr_lock_owner_equal(data->owner, owner))
-      return 1;					/* Already locked by thread */
-  }
-  return 0;
-}
-
 static inline my_bool have_specific_lock(THR_LOCK_DATA *data,
 					 enum thr_lock_type type)
 {
@@ -791,8 +830,9 @@ thr_lock(THR_LOCK_DATA *data, THR_LOCK_INFO *owner, ulong lock_wait_timeout)
           /-------
          H|++++  WRITE_ALLOW_WRITE
          e|+++-  WRITE_CONCURRENT_INSERT
-         l|++++  WRITE_DELAYED
-         d ||||
+         l|----  WRITE_CONCURRENT_UPDATE
+         d|++++  WRITE_DELAYED
+           ||||
            |||\= READ_NO_INSERT
            ||\ = READ_HIGH_PRIORITY
            |\  = READ_WITH_SHARED_LOCKS
@@ -806,14 +846,21 @@ thr_lock(THR_LOCK_DATA *data, THR_LOCK_INFO *owner, ulong lock_wait_timeout)
         be incompatible. However this will cause starvation of
         LOCK TABLE READ in InnoDB under high write load.
         See Bug#42147 for more information.
+
+        WRITE_CONCURRENT_UPDATE may be behind WRITE_CONCURRENT_INSERT in
+        the write list, so it is checked with write_no_read_count. The
+        thread may then have a write lock that isn't the first one.
       */
 
       DBUG_PRINT("lock",("write locked 1 by thread: 0x%lx",
 			 lock->write.data->owner->thread_id));
       if (thr_lock_owner_equal(data->owner, lock->write.data->owner) ||
 	  (lock->write.data->type <= TL_WRITE_DELAYED &&
+           !lock->write_no_read_count &&
 	   (((int) lock_type <= (int) TL_READ_HIGH_PRIORITY) ||
-	    (lock->write.data->type != TL_WRITE_CONCURRENT_INSERT))))
+	    (lock->write.data->type != TL_WRITE_CONCURRENT_INSERT))) ||
+          (lock->write_no_read_count &&
+           has_old_lock(lock->write.data, data->owner)))
       {						/* Already got a write lock */
 	(*lock->read.last)=data;		/* Add to running FIFO */
 	data->prev=lock->read.last;
@@ -889,7 +936,7 @@ thr_lock(THR_LOCK_DATA *data, THR_LOCK_INFO *owner, ulong lock_wait_timeout)
 	goto end;
       }
     }
-    else if (lock_type == TL_WRITE_CONCURRENT_INSERT && ! lock->check_status)
+    else if (concurrent_write_lock(lock_type) && ! lock->check_status)
       data->type=lock_type= thr_upgraded_concurrent_insert_lock;
 
     if (lock->write.data)			/* If there is a write lock */
@@ -913,7 +960,9 @@ thr_lock(THR_LOCK_DATA *data, THR_LOCK_INFO *owner, ulong lock_wait_timeout)
         a write lock or if there is no pending write locks and if all
         write locks are of the same type and are either
         TL_WRITE_ALLOW_WRITE or TL_WRITE_CONCURRENT_INSERT and
-        there is no TL_READ_NO_INSERT lock.
+        there is no TL_READ_NO_INSERT lock. TL_WRITE_CONCURRENT_INSERT
+        and TL_WRITE_CONCURRENT_UPDATE count as the same type here, but
+        the latter also needs that there are no read locks.
 
         Note that, since lock requests for the same table are sorted in
         such way that requests with higher thr_lock_type value come first
@@ -944,12 +993,13 @@ thr_lock(THR_LOCK_DATA *data, THR_LOCK_INFO *owner, ulong lock_wait_timeout)
                      lock->write.data->type == TL_WRITE_LOW_PRIORITY)) &&
                    lock->write.data->type != TL_WRITE_DELAYED));
 
-      if (((lock_type == TL_WRITE_ALLOW_WRITE ||
-           (lock_type == TL_WRITE_CONCURRENT_INSERT &&
+      if (((lock_type == TL_WRITE_ALLOW_WRITE ?
+            lock->write.data->type == TL_WRITE_ALLOW_WRITE :
+            (concurrent_write_lock(lock_type) &&
              lock->allow_multiple_concurrent_insert &&
-            !lock->read_no_write_count)) &&
+             concurrent_write_lock(lock->write.data->type) &&
+             (lock_type != TL_WRITE_CONCURRENT_UPDATE || !lock->read.data))) &&
            ! lock->write_wait.data &&
-           lock->write.data->type == lock_type &&
            ! lock->read_no_write_count) ||
           has_old_lock(lock->write.data, data->owner))
       {
@@ -960,10 +1010,12 @@ thr_lock(THR_LOCK_DATA *data, THR_LOCK_INFO *owner, ulong lock_wait_timeout)
 	(*lock->write.last)=data;	/* Add to running fifo */
 	data->prev=lock->write.last;
 	lock->write.last= &data->next;
+        if (lock_type == TL_WRITE_CONCURRENT_UPDATE)
+          lock->write_no_read_count++;
 	check_locks(lock,"second write lock", lock_type, 0);
 	if (lock->get_status)
 	  (*lock->get_status)(data->status_param,
-                              lock_type == TL_WRITE_CONCURRENT_INSERT);
+                              concurrent_write_lock(lock_type));
 	statistic_increment(locks_immediate,&THR_LOCK_lock);
 	goto end;
       }
@@ -977,7 +1029,7 @@ thr_lock(THR_LOCK_DATA *data, THR_LOCK_INFO *owner, ulong lock_wait_timeout)
       if (!lock->write_wait.data)
       {						/* no scheduled write locks */
         my_bool concurrent_insert= 0;
-	if (lock_type == TL_WRITE_CONCURRENT_INSERT)
+	if (concurrent_write_lock(lock_type))
         {
           concurrent_insert= 1;
           if ((*lock->check_status)(data->status_param))
@@ -989,6 +1041,7 @@ thr_lock(THR_LOCK_DATA *data, THR_LOCK_INFO *owner, ulong lock_wait_timeout)
 
 	if (!lock->read.data ||
 	    (lock_type <= TL_WRITE_DELAYED &&
+             lock_type != TL_WRITE_CONCURRENT_UPDATE &&
 	     ((lock_type != TL_WRITE_CONCURRENT_INSERT &&
 	       lock_type != TL_WRITE_ALLOW_WRITE) ||
 	      !lock->read_no_write_count)))
@@ -996,6 +1049,8 @@ thr_lock(THR_LOCK_DATA *data, THR_LOCK_INFO *owner, ulong lock_wait_timeout)
 	  (*lock->write.last)=data;		/* Add as current write lock */
 	  data->prev=lock->write.last;
 	  lock->write.last= &data->next;
+          if (lock_type == TL_WRITE_CONCURRENT_UPDATE)
+            lock->write_no_read_count++;
 	  if (lock->get_status)
 	    (*lock->get_status)(data->status_param, concurrent_insert);
 	  check_locks(lock,"only write lock", lock_type, 0);
@@ -1123,6 +1178,8 @@ void thr_unlock(THR_LOCK_DATA *data, uint unlock_flags)
   }
   if (lock_type == TL_READ_NO_INSERT)
     lock->read_no_write_count--;
+  else if (lock_type == TL_WRITE_CONCURRENT_UPDATE)
+    lock->write_no_read_count--;
   data->type=TL_UNLOCK;				/* Mark unlocked */
   wake_up_waiters(lock);
   mysql_mutex_unlock(&lock->mutex);
@@ -1176,9 +1233,11 @@ static void wake_up_waiters(THR_LOCK *lock)
 	  data->prev=lock->write.last;
 	  data->next=0;
 	  lock->write.last= &data->next;
-	  if (data->type == TL_WRITE_CONCURRENT_INSERT &&
+	  if (concurrent_write_lock(data->type) &&
 	      (*lock->check_status)(data->status_param))
 	    data->type=TL_WRITE;			/* Upgrade lock */
+          if (data->type == TL_WRITE_CONCURRENT_UPDATE)
+            lock->write_no_read_count++;
           /* purecov: begin inspected */
 	  DBUG_PRINT("lock",("giving write lock of type %d to thread: 0x%lx",
 			     data->type, data->owner->thread_id));
@@ -1188,13 +1247,16 @@ static void wake_up_waiters(THR_LOCK *lock)
 	    data->cond=0;				/* Mark thread free */
             mysql_cond_signal(cond);                    /* Start waiting thread */
 	  }
-	  if (data->type != TL_WRITE_ALLOW_WRITE ||
-	      !lock->write_wait.data ||
-	      lock->write_wait.data->type != TL_WRITE_ALLOW_WRITE)
+	  if (!lock->write_wait.data ||
+              (data->type == TL_WRITE_ALLOW_WRITE ?
+               lock->write_wait.data->type != TL_WRITE_ALLOW_WRITE :
+               (!lock->allow_multiple_concurrent_insert ||
+                !concurrent_write_lock(data->type) ||
+                !concurrent_write_lock(lock->write_wait.data->type))))
 	    break;
 	  data=lock->write_wait.data;		/* Free this too */
 	}
-	if (data->type >= TL_WRITE_LOW_PRIORITY)
+	if (data->type >= TL_WRITE_LOW_PRIORITY || lock->write_no_read_count)
           goto end;
 	/* Release possible read locks together with the write lock */
       }
@@ -1210,6 +1272,7 @@ static void wake_up_waiters(THR_LOCK *lock)
     }
     else if (data &&
 	     (lock_type=data->type) <= TL_WRITE_DELAYED &&
+             lock_type != TL_WRITE_CONCURRENT_UPDATE &&
 	     ((lock_type != TL_WRITE_CONCURRENT_INSERT &&
 	       lock_type != TL_WRITE_ALLOW_WRITE) ||
 	      !lock->read_no_write_count))
@@ -1249,6 +1312,16 @@ static void wake_up_waiters(THR_LOCK *lock)
     else if (!data && lock->read_wait.data)
       free_all_read_locks(lock,0);
   }
+  else if (!lock->write_no_read_count && lock->read_wait.data &&
+           !lock->write_wait.data &&
+           lock->write.data->type == TL_WRITE_CONCURRENT_INSERT)
+  {
+    /*
+      The last TL_WRITE_CONCURRENT_UPDATE lock is gone. Start the read
+      locks that waited for it.
+    */
+    free_all_read_locks(lock, 1);
+  }
 end:
   check_locks(lock, "after waking up waiters", TL_UNLOCK, 0);
   DBUG_VOID_RETURN;
@@ -1751,10 +1824,12 @@ struct st_test test_12[] = {{0,TL_WRITE_CONCURRENT_INSERT},{1,TL_WRITE_CONCURREN
 struct st_test test_13[] = {{0,TL_WRITE_CONCURRENT_INSERT},{1,TL_READ}};
 struct st_test test_14[] = {{0,TL_WRITE_ALLOW_WRITE},{1,TL_READ}};
 struct st_test test_15[] = {{0,TL_WRITE_ALLOW_WRITE},{1,TL_WRITE_ALLOW_WRITE}};
+struct st_test test_16[] = {{0,TL_WRITE_CONCURRENT_UPDATE},{1,TL_WRITE_CONCURRENT_UPDATE}};
+struct st_test test_17[] = {{0,TL_WRITE_CONCURRENT_UPDATE},{1,TL_WRITE_CONCURRENT_INSERT},{2,TL_READ}};
 
 struct st_test *tests[] = {test_0,test_1,test_2,test_3,test_4,test_5,test_6,
 			   test_7,test_8,test_9,test_10,test_11,test_12,
-			   test_13,test_14,test_15};
+			   test_13,test_14,test_15,test_16,test_17};
 int lock_counts[]= {sizeof(test_0)/sizeof(struct st_test),
 		    sizeof(test_1)/sizeof(struct st_test),
 		    sizeof(test_2)/sizeof(struct st_test),
@@ -1770,7 +1845,9 @@ int lock_counts[]= {sizeof(test_0)/sizeof(struct st_test),
 		    sizeof(test_12)/sizeof(struct st_test),
 		    sizeof(test_13)/sizeof(struct st_test),
 		    sizeof(test_14)/sizeof(struct st_test),
-		    sizeof(test_15)/sizeof(struct st_test)
+		    sizeof(test_15)/sizeof(struct st_test),
+		    sizeof(test_16)/sizeof(struct st_test),
+		    sizeof(test_17)/sizeof(struct st_test)
 };
 
 
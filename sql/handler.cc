@@ -4750,13 +4750,17 @@ int ha_init_key_cache(const char *name, KEY_CACHE *key_cache, void *unused
     uint age_threshold=  (uint)key_cache->param_age_threshold;
     uint partitions=     (uint)key_cache->param_partitions;
     uint changed_blocks_hash_size=  (uint)key_cache->changed_blocks_hash_size;
+    my_bool lockfree_hits= (my_bool) key_cache->param_lockfree_hits;
     mysql_mutex_unlock(&LOCK_global_system_variables);
-    DBUG_RETURN(!init_key_cache(key_cache,
-				tmp_block_size,
-				tmp_buff_size,
-				division_limit, age_threshold,
-                                changed_blocks_hash_size,
-                                partitions));
+    if (!init_key_cache(key_cache,
+                        tmp_block_size,
+                        tmp_buff_size,
+                        division_limit, age_threshold,
+                        changed_blocks_hash_size,
+                        partitions))
+      DBUG_RETURN(1);
+    change_key_cache_param(key_cache, division_limit, age_threshold,
+                           lockfree_hits);
   }
   DBUG_RETURN(0);
 }
@@ -4799,8 +4803,10 @@ int ha_change_key_cache_param(KEY_CACHE *key_cache)
     mysql_mutex_lock(&LOCK_global_system_variables);
     uint division_limit= (uint)key_cache->param_division_limit;
     uint age_threshold=  (uint)key_cache->param_age_threshold;
+    my_bool lockfree_hits= (my_bool) key_cache->param_lockfree_hits;
     mysql_mutex_unlock(&LOCK_global_system_variables);
-    change_key_cache_param(key_cache, division_limit, age_threshold);
+    change_key_cache_param(key_cache, division_limit, age_threshold,
+                           lockfree_hits);
   }
   DBUG_RETURN(0);
 }
@@ -4822,12 +4828,17 @@ int ha_repartition_key_cache(KEY_CACHE *key_cache)
     uint age_threshold=  (uint)key_cache->param_age_threshold;
     uint partitions=     (uint)key_cache->param_partitions;
     uint changed_blocks_hash_size=  (uint)key_cache->changed_blocks_hash_size;
+    my_bool lockfree_hits= (my_bool) key_cache->param_lockfree_hits;
     mysql_mutex_unlock(&LOCK_global_system_variables);
-    DBUG_RETURN(!repartition_key_cache(key_cache, tmp_block_size,
-				       tmp_buff_size,
-				       division_limit, age_threshold,
-                                       changed_blocks_hash_size,
-                                       partitions));
+    if (!repartition_key_cache(key_cache, tmp_block_size,
+                               tmp_buff_size,
+                               division_limit, age_threshold,
+                               changed_blocks_hash_size,
+                               partitions))
+      DBUG_RETURN(1);
+    /* The new partitions start with lock-free hits disabled */
+    change_key_cache_param(key_cache, division_limit, age_threshold,
+                           lockfree_hits);
   }
   DBUG_RETURN(0);
 }
@@ -3148,6 +3148,14 @@ class handler :public Sql_alloc
   void ft_end() { ft_handler=NULL; }
   virtual FT_INFO *ft_init_ext(uint flags, uint inx,String *key)
     { return NULL; }
+  /*
+    Same as ft_init_ext(), but only the first 'limit' rows in relevance
+    order will be read (ORDER BY MATCH ... DESC LIMIT n), so the engine
+    may skip documents that cannot rank among them.
+  */
+  virtual FT_INFO *ft_init_ext_with_limit(uint flags, uint inx, String *key,
+                                          ha_rows limit)
+    { return ft_init_ext(flags, inx, key); }
 private:
   virtual int ft_read(uchar *buf) { return HA_ERR_WRONG_COMMAND; }
   virtual int rnd_next(uchar *buf)=0;
@@ -1909,6 +1909,7 @@ class Item_func_match :public Item_real_func
 public:
   uint key, flags;
   bool join_key;
+  ha_rows ft_limit;          // rows the query reads, see set_ft_limit()
   DTCollation cmp_collation;
   FT_INFO *ft_handler;
   TABLE *table;
@@ -1918,7 +1919,8 @@ class Item_func_match :public Item_real_func
   String search_value;       // key_item()'s value converted to cmp_collation
 
   Item_func_match(THD *thd, List<Item> &a, uint b):
-    Item_real_func(thd, a), key(0), flags(b), join_key(0), ft_handler(0),
+    Item_real_func(thd, a), key(0), flags(b), join_key(0),
+    ft_limit(HA_POS_ERROR), ft_handler(0),
     table(0), master(0), concat_ws(0) { }
   void cleanup()
   {
@@ -137,6 +137,7 @@ KEY_CACHE *create_key_cache(const char *name, uint length)
       key_cache->param_division_limit= dflt_key_cache_var.param_division_limit;
       key_cache->param_age_threshold=  dflt_key_cache_var.param_age_threshold;
       key_cache->param_partitions=     dflt_key_cache_var.param_partitions;
+      key_cache->param_lockfree_hits=  dflt_key_cache_var.param_lockfree_hits;
     }
   }
   DBUG_RETURN(key_cache);
@@ -9315,6 +9315,7 @@ mysql_getopt_value(const char *name, uint length,
   case OPT_KEY_CACHE_AGE_THRESHOLD:
   case OPT_KEY_CACHE_PARTITIONS:
   case OPT_KEY_CACHE_CHANGED_BLOCKS_HASH_SIZE:
+  case OPT_KEY_CACHE_LOCKFREE_HITS:
   {
     KEY_CACHE *key_cache;
     if (!(key_cache= get_or_create_key_cache(name, length)))
@@ -9336,6 +9337,8 @@ mysql_getopt_value(const char *name, uint length,
       return (uchar**) &key_cache->param_partitions;
     case OPT_KEY_CACHE_CHANGED_BLOCKS_HASH_SIZE:
       return (uchar**) &key_cache->changed_blocks_hash_size;
+    case OPT_KEY_CACHE_LOCKFREE_HITS:
+      return (uchar**) &key_cache->param_lockfree_hits;
     }
   }
 #ifdef HAVE_REPLICATION
@@ -605,6 +605,7 @@ enum options_mysqld
   OPT_KEY_CACHE_DIVISION_LIMIT,
   OPT_KEY_CACHE_PARTITIONS,
   OPT_KEY_CACHE_CHANGED_BLOCKS_HASH_SIZE,
+  OPT_KEY_CACHE_LOCKFREE_HITS,
   OPT_LOG_BASENAME,
   OPT_LOG_ERROR,
   OPT_LOWER_CASE_TABLE_NAMES,
@@ -1030,6 +1030,58 @@ bool JOIN::prepare_stage2()
   DBUG_RETURN(res);				/* purecov: inspected */
 }
 
+/**
+  Pass the LIMIT of a full-text top-k query down to the storage engine.
+
+  For a single-table query like
+
+    SELECT ... FROM t1 WHERE MATCH (a) AGAINST ('...')
+    ORDER BY MATCH (a) AGAINST ('...') DESC LIMIT n
+
+  that reads t1 through the full-text index, only the n most relevant
+  documents can make it to the result, which lets the engine stop
+  collecting documents that cannot rank among them.
+
+  @param join  the join being optimized
+*/
+
+static void set_ft_limit(JOIN *join)
+{
+  List_iterator<Item_func_match> li(*(join->select_lex->ftfunc_list));
+  Item_func_match *ifm;
+  Item *order_item;
+  Item *cond= join->conds;
+  ha_rows limit= HA_POS_ERROR;
+
+  if (join->table_count == 1 && !join->const_tables &&
+      join->join_tab->type == JT_FT &&
+      join->order && !join->order->next && !join->order->asc &&
+      !join->group_list && !join->tmp_table_param.sum_func_count &&
+      !join->select_distinct && !join->having &&
+      cond && cond->type() == Item::FUNC_ITEM &&
+      ((Item_func*) cond)->functype() == Item_func::FT_FUNC)
+  {
+    order_item= (*join->order->item)->real_item();
+    if (order_item->type() == Item::FUNC_ITEM &&
+        ((Item_func*) order_item)->functype() == Item_func::FT_FUNC &&
+        order_item->eq(cond, 1))
+      limit= join->select_limit;
+  }
+
+  while ((ifm= li++))
+  {
+    if (limit != HA_POS_ERROR && !ifm->eq(cond, 1))
+    {
+      /* Another MATCH needs the relevance of all documents */
+      limit= HA_POS_ERROR;
+      li.rewind();
+      continue;
+    }
+    ifm->ft_limit= limit;
+  }
+}
+
+
 int JOIN::optimize()
 {
   // to prevent double initialization on EXPLAIN
@@ -1799,7 +1851,10 @@ JOIN::optimize_inner()
 
   /* Perform FULLTEXT search before all regular searches */
   if (!(select_options & SELECT_DESCRIBE))
+  {
+    set_ft_limit(this);
     init_ftfuncs(thd, select_lex, MY_TEST(order));
+  }
 
   if (optimize_unflattened_subqueries())
     DBUG_RETURN(1);
@@ -20537,7 +20592,7 @@ uint find_shortest_key(TABLE *table, const key_map *usable_keys)
     {
       if (usable_keys->is_set(nr))
       {
-        double cost= table->file->keyread_time(nr, 1, table->file->records());
+        double cost= table->file->keyread_time(nr, 1, table->file->stats.records);
         if (cost < min_cost)
         {
           min_cost= cost;
@@ -9502,7 +9502,7 @@ copy_data_between_tables(THD *thd, TABLE *from, TABLE *to,
   if (to->default_field && to->update_default_fields())
     goto err;
 
-  thd->progress.max_counter= from->file->records();
+  thd->progress.max_counter= from->file->stats.records;
   time_to_report_progress= MY_HOW_OFTEN_TO_WRITE/10;
 
   while (!(error=info.read_record(&info)))
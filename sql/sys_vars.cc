@@ -1100,6 +1100,17 @@ static Sys_var_keycache Sys_key_cache_age_threshold(
        BLOCK_SIZE(100), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(change_keycache_param));
 
+static Sys_var_keycache Sys_key_cache_lockfree_hits(
+       "key_cache_lockfree_hits",
+       "Read index blocks that are already in the key cache without taking "
+       "the key cache lock. Such hits don't move blocks in the LRU chain; "
+       "a block that was hit gets a second chance before it is evicted",
+       KEYCACHE_VAR(param_lockfree_hits),
+       CMD_LINE(REQUIRED_ARG, OPT_KEY_CACHE_LOCKFREE_HITS),
+       VALID_RANGE(0, 1), DEFAULT(0),
+       BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(change_keycache_param));
+
 static Sys_var_keycache Sys_key_cache_file_hash_size(
        "key_cache_file_hash_size",
        "Number of hash buckets for open and changed files.  If you have a lot of MyISAM "
@@ -4374,6 +4374,7 @@ int ha_connect::start_stmt(THD *thd, thr_lock_type lock_type)
   switch (lock_type) {
     case TL_WRITE_ALLOW_WRITE:
     case TL_WRITE_CONCURRENT_INSERT:
+    case TL_WRITE_CONCURRENT_UPDATE:
     case TL_WRITE_DELAYED:
     case TL_WRITE_DEFAULT:
     case TL_WRITE_LOW_PRIORITY:
@@ -58,6 +58,7 @@ C_MODE_END
 #define THD_TRN (*(TRN **)thd_ha_data(thd, maria_hton))
 
 ulong pagecache_division_limit, pagecache_age_threshold, pagecache_file_hash_size;
+ulong pagecache_segments;
 ulonglong pagecache_buffer_size;
 const char *zerofill_error_msg=
   "Table is from another system and must be zerofilled or repaired to be "
@@ -163,6 +164,14 @@ static MYSQL_SYSVAR_ULONG(checkpoint_interval, checkpoint_interval,
        " 'no automatic checkpoints' which makes sense only for testing.",
        NULL, update_checkpoint_interval, 30, 0, UINT_MAX, 1);
 
+static MYSQL_SYSVAR_ULONG(checkpoint_flush_threads,
+       maria_checkpoint_flush_threads, PLUGIN_VAR_RQCMDARG,
+       "Number of threads that flush and sync the files of different tables "
+       "at the same time during a checkpoint and when closing the tables at "
+       "the end of recovery. 1 means that the tables are flushed one after "
+       "the other.",
+       0, 0, 1, 1, 64, 1);
+
 static MYSQL_SYSVAR_ULONG(checkpoint_log_activity, maria_checkpoint_min_log_activity,
        PLUGIN_VAR_RQCMDARG,
        "Number of bytes that the transaction log has to grow between checkpoints before a new "
@@ -255,15 +264,38 @@ static MYSQL_SYSVAR_ULONG(pagecache_file_hash_size, pagecache_file_hash_size,
        "value is probably 1/10 of number of possible open Aria files.", 0,0,
        512, 128, 16384, 1);
 
+static MYSQL_SYSVAR_ULONG(pagecache_segments, pagecache_segments,
+       PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+       "Number of segments of the page cache. Each segment has its own lock, "
+       "hash and LRU and dirty lists, and caches the pages of all files that "
+       "hash to it, so that threads that use different segments do not wait "
+       "for each other. 1 means that the page cache is not segmented.", 0, 0,
+       1, 1, MAX_PAGECACHE_SEGMENTS, 1);
+
 static MYSQL_SYSVAR_SET(recover, maria_recover_options, PLUGIN_VAR_OPCMDARG,
        "Specifies how corrupted tables should be automatically repaired",
        NULL, NULL, HA_RECOVER_DEFAULT, &maria_recover_typelib);
 
+static MYSQL_SYSVAR_ULONG(recovery_threads, maria_recovery_threads,
+       PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+       "Number of threads that apply the log records of different tables at "
+       "the same time during recovery. 1 means that the log is applied by "
+       "one thread.",
+       0, 0, 1, 1, 64, 1);
+
 static MYSQL_THDVAR_ULONG(repair_threads, PLUGIN_VAR_RQCMDARG,
        "Number of threads to use when repairing Aria tables. The value of 1 "
-       "disables parallel repair.",
+       "disables parallel repair. Tables with the PAGE row format are only "
+       "repaired in parallel by a quick repair, which keeps the data file.",
        0, 0, 1, 1, 128, 1);
 
+static MYSQL_SYSVAR_BOOL(row_locking, maria_row_locking,
+       PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+       "Let single table UPDATE and DELETE on transactional Aria tables lock "
+       "the rows they change instead of the table. Readers wait for such "
+       "UPDATE and DELETE statements, but not for concurrent inserts",
+       0, 0, 0);
+
 static MYSQL_THDVAR_ULONGLONG(sort_buffer_size, PLUGIN_VAR_RQCMDARG,
        "The buffer that is allocated when sorting the index when doing a "
        "REPAIR or when creating indexes with CREATE INDEX or ALTER TABLE.", NULL, NULL,
@@ -290,6 +322,13 @@ static MYSQL_SYSVAR_BOOL(used_for_temp_tables,
        "Whether temporary tables should be MyISAM or Aria", 0, 0,
        1);
 
+static MYSQL_SYSVAR_ULONGLONG(tmp_table_pagecache_size,
+       maria_tmp_table_pagecache_size, PLUGIN_VAR_RQCMDARG,
+       "Size of the private page cache that each internal temporary Aria "
+       "table gets for its pages instead of using the shared page cache. "
+       "0 means that internal temporary tables use the shared page cache.",
+       0, 0, 0, 0, ~(ulonglong) 0, 8192);
+
 static MYSQL_SYSVAR_BOOL(encrypt_tables, maria_encrypt_tables, PLUGIN_VAR_OPCMDARG,
        "Encrypt tables (only for tables with ROW_FORMAT=PAGE (default) "
        "and not FIXED/DYNAMIC)",
@@ -304,6 +343,7 @@ static PSI_mutex_info all_aria_mutexes[]=
   { &key_LOCK_trn_list, "LOCK_trn_list", PSI_FLAG_GLOBAL},
   { &key_SHARE_BITMAP_lock, "SHARE::bitmap::bitmap_lock", 0},
   { &key_SORT_INFO_mutex, "SORT_INFO::mutex", 0},
+  { &key_CHECK_print_msg_mutex, "HA_CHECK::print_msg_mutex", 0},
   { &key_TRANSLOG_BUFFER_mutex, "TRANSLOG_BUFFER::mutex", 0},
   { &key_TRANSLOG_DESCRIPTOR_dirty_buffer_mask_lock, "TRANSLOG_DESCRIPTOR::dirty_buffer_mask_lock", 0},
   { &key_TRANSLOG_DESCRIPTOR_sent_to_disk_lock, "TRANSLOG_DESCRIPTOR::sent_to_disk_lock", 0},
@@ -343,7 +383,8 @@ static PSI_thread_info all_aria_threads[]=
 {
   { &key_thread_checkpoint, "checkpoint_background", PSI_FLAG_GLOBAL},
   { &key_thread_soft_sync, "soft_sync_background", PSI_FLAG_GLOBAL},
-  { &key_thread_find_all_keys, "thr_find_all_keys", 0}
+  { &key_thread_find_all_keys, "thr_find_all_keys", 0},
+  { &key_thread_service_work, "service_work", 0}
 };
 
 static PSI_file_info all_aria_files[]=
@@ -441,6 +482,9 @@ static void _ma_check_print_msg(HA_CHECK *param, const char *msg_type,
     Also we likely need to lock mutex here (in both cases with protocol and
     push_warning).
   */
+  if (param->need_print_msg_lock)
+    mysql_mutex_lock(&param->print_msg_mutex);
+
   protocol->prepare_for_resend();
   protocol->store(name, length, system_charset_info);
   protocol->store(param->op_name, system_charset_info);
@@ -452,6 +496,9 @@ static void _ma_check_print_msg(HA_CHECK *param, const char *msg_type,
   else if (thd->variables.log_warnings > 2)
     sql_print_error("%s.%s: %s", param->db_name, param->table_name, msgbuf);
 
+  if (param->need_print_msg_lock)
+    mysql_mutex_unlock(&param->print_msg_mutex);
+
   return;
 }
 
@@ -1273,7 +1320,23 @@ int ha_maria::write_row(uchar * buf)
   {
     int error;
     if ((error= update_auto_increment()))
+    {
+      /* A failed reservation of values leaves the lock error in my_errno */
+      if (error == HA_ERR_AUTOINC_READ_FAILED &&
+          (my_errno == HA_ERR_LOCK_DEADLOCK ||
+           my_errno == HA_ERR_LOCK_WAIT_TIMEOUT))
+        error= my_errno;
       return error;
+    }
+    if (file->s->lock.allow_multiple_concurrent_insert &&
+        !table->s->next_number_key_offset)
+    {
+      ulonglong nr= (ulonglong) table->next_number_field->val_int();
+      if (((longlong) nr > 0 ||
+           (table->next_number_field->flags & UNSIGNED_FLAG)) &&
+          (error= _ma_update_auto_increment_reserved(file, nr)))
+        return error;
+    }
   }
   return maria_write(file, buf);
 }
@@ -1637,13 +1700,22 @@ int ha_maria::repair(THD *thd, HA_CHECK *param, bool do_optimize)
       local_testflag |= T_STATISTICS;
       param->testflag |= T_STATISTICS;           // We get this for free
       statistics_done= 1;
-      /* TODO: Remove BLOCK_RECORD test when parallel works with blocks */
+      /*
+        BLOCK_RECORD tables are repaired in parallel only when the data
+        file is kept, see maria_repair_parallel()
+      */
       if (THDVAR(thd,repair_threads) > 1 &&
-          share->data_file_type != BLOCK_RECORD)
+          (share->data_file_type != BLOCK_RECORD ||
+           ((param->testflag & T_QUICK) && !share->internal_table)))
       {
         char buf[40];
-        /* TODO: respect maria_repair_threads variable */
-        my_snprintf(buf, 40, "Repair with %d threads", my_count_bits(key_map));
+        uint threads= my_count_bits(key_map);
+        if (share->data_file_type == BLOCK_RECORD)
+        {
+          param->repair_threads= (uint) THDVAR(thd,repair_threads);
+          set_if_smaller(threads, param->repair_threads);
+        }
+        my_snprintf(buf, 40, "Repair with %d threads", threads);
         thd_proc_info(thd, buf);
         param->testflag|= T_REP_PARALLEL;
         error= maria_repair_parallel(param, file, fixed_name,
@@ -2155,6 +2227,15 @@ void ha_maria::start_bulk_insert(ha_rows rows, uint flags)
         my_bool all_keys= MY_TEST(flags & HA_CREATE_UNIQUE_INDEX_BY_SORT);
         maria_disable_indexes_for_rebuild(file, rows, all_keys);
       }
+      if (share->data_file_type == BLOCK_RECORD)
+      {
+        /*
+          Fill the pages of the empty table one after another instead of
+          searching the bitmap for the best fit for every row
+        */
+        share->insert_order= 1;
+        share->last_insert_bitmap= share->last_insert_page= 0;
+      }
       if (share->now_transactional)
       {
         bulk_insert_single_undo= BULK_INSERT_SINGLE_UNDO_AND_NO_REPAIR;
@@ -2201,6 +2282,8 @@ int ha_maria::end_bulk_insert()
   int err;
   DBUG_ENTER("ha_maria::end_bulk_insert");
   maria_end_bulk_insert(file);
+  file->s->insert_order= MY_TEST(file->s->base.extra_options &
+                                 MA_EXTRA_OPTIONS_INSERT_ORDER);
   if ((err= maria_extra(file, HA_EXTRA_NO_CACHE, 0)))
     goto end;
   if (can_enable_indexes && !file->s->deleting)
@@ -2304,23 +2387,51 @@ bool ha_maria::is_crashed() const
 
 int ha_maria::update_row(const uchar * old_data, uchar * new_data)
 {
-  CHECK_UNTIL_WE_FULLY_IMPLEMENTED_VERSIONING("UPDATE in WRITE CONCURRENT");
+  if (!file->lock_rows)
+    CHECK_UNTIL_WE_FULLY_IMPLEMENTED_VERSIONING("UPDATE in WRITE CONCURRENT");
   return maria_update(file, old_data, new_data);
 }
 
 
 int ha_maria::delete_row(const uchar * buf)
 {
-  CHECK_UNTIL_WE_FULLY_IMPLEMENTED_VERSIONING("DELETE in WRITE CONCURRENT");
+  if (!file->lock_rows)
+    CHECK_UNTIL_WE_FULLY_IMPLEMENTED_VERSIONING("DELETE in WRITE CONCURRENT");
   return maria_delete(file, buf);
 }
 
+
+/*
+  With row locks, the transaction we waited for may have deleted the row
+  that the index pointed to, or changed its key. The old key is then gone
+  from the index, so the caller can skip the row and search again.
+*/
+
+bool ha_maria::skip_changed_row(uchar *buf, int error)
+{
+  if (!file->lock_rows)
+    return 0;
+  if (error == HA_ERR_RECORD_DELETED)
+    return 1;
+  if (!error && _ma_row_key_changed(file, buf))
+  {
+    _ma_unlock_row(file);
+    return 1;
+  }
+  return 0;
+}
+
+
 int ha_maria::index_read_map(uchar * buf, const uchar * key,
 			     key_part_map keypart_map,
 			     enum ha_rkey_function find_flag)
 {
   DBUG_ASSERT(inited == INDEX);
-  int error= maria_rkey(file, buf, active_index, key, keypart_map, find_flag);
+  int error;
+  do
+  {
+    error= maria_rkey(file, buf, active_index, key, keypart_map, find_flag);
+  } while (skip_changed_row(buf, error));
   return error;
 }
 
@@ -2335,7 +2446,10 @@ int ha_maria::index_read_idx_map(uchar * buf, uint index, const uchar * key,
   if (index == pushed_idx_cond_keyno)
     ma_set_index_cond_func(file, handler_index_cond_check, this);
   
-  error= maria_rkey(file, buf, index, key, keypart_map, find_flag);
+  do
+  {
+    error= maria_rkey(file, buf, index, key, keypart_map, find_flag);
+  } while (skip_changed_row(buf, error));
    
   ma_set_index_cond_func(file, NULL, 0);
   return error;
@@ -2347,8 +2461,12 @@ int ha_maria::index_read_last_map(uchar * buf, const uchar * key,
 {
   DBUG_ENTER("ha_maria::index_read_last_map");
   DBUG_ASSERT(inited == INDEX);
-  int error= maria_rkey(file, buf, active_index, key, keypart_map,
-                        HA_READ_PREFIX_LAST);
+  int error;
+  do
+  {
+    error= maria_rkey(file, buf, active_index, key, keypart_map,
+                      HA_READ_PREFIX_LAST);
+  } while (skip_changed_row(buf, error));
   DBUG_RETURN(error);
 }
 
@@ -2356,7 +2474,11 @@ int ha_maria::index_read_last_map(uchar * buf, const uchar * key,
 int ha_maria::index_next(uchar * buf)
 {
   DBUG_ASSERT(inited == INDEX);
-  int error= maria_rnext(file, buf, active_index);
+  int error;
+  do
+  {
+    error= maria_rnext(file, buf, active_index);
+  } while (skip_changed_row(buf, error));
   return error;
 }
 
@@ -2364,7 +2486,11 @@ int ha_maria::index_next(uchar * buf)
 int ha_maria::index_prev(uchar * buf)
 {
   DBUG_ASSERT(inited == INDEX);
-  int error= maria_rprev(file, buf, active_index);
+  int error;
+  do
+  {
+    error= maria_rprev(file, buf, active_index);
+  } while (skip_changed_row(buf, error));
   return error;
 }
 
@@ -2373,6 +2499,8 @@ int ha_maria::index_first(uchar * buf)
 {
   DBUG_ASSERT(inited == INDEX);
   int error= maria_rfirst(file, buf, active_index);
+  while (skip_changed_row(buf, error))
+    error= maria_rnext(file, buf, active_index);
   return error;
 }
 
@@ -2381,6 +2509,8 @@ int ha_maria::index_last(uchar * buf)
 {
   DBUG_ASSERT(inited == INDEX);
   int error= maria_rlast(file, buf, active_index);
+  while (skip_changed_row(buf, error))
+    error= maria_rprev(file, buf, active_index);
   return error;
 }
 
@@ -2398,7 +2528,7 @@ int ha_maria::index_next_same(uchar * buf,
   do
   {
     error= maria_rnext_same(file,buf);
-  } while (error == HA_ERR_RECORD_DELETED);
+  } while (error == HA_ERR_RECORD_DELETED || skip_changed_row(buf, error));
   return error;
 }
 
@@ -2547,7 +2677,9 @@ int ha_maria::extra(enum ha_extra_function operation)
 {
   int tmp;
   TRN *old_trn= file->trn;
-  if ((specialflag & SPECIAL_SAFE_MODE) && operation == HA_EXTRA_KEYREAD)
+  /* With row locks all reads must read the row to lock it */
+  if (((specialflag & SPECIAL_SAFE_MODE) || file->lock_rows) &&
+      operation == HA_EXTRA_KEYREAD)
     return 0;
 #ifdef NOT_USED
   if (operation == HA_EXTRA_MMAP && !opt_maria_use_mmap)
@@ -2587,6 +2719,7 @@ int ha_maria::extra(enum ha_extra_function operation)
 
 int ha_maria::reset(void)
 {
+  _ma_release_auto_increment(file, 0);
   ma_set_index_cond_func(file, NULL, 0);
   ds_mrr.dsmrr_close();
   if (file->trn)
@@ -2612,6 +2745,9 @@ int ha_maria::delete_all_rows()
 {
   THD *thd= table->in_use;
   TRN *trn= file->trn;
+  /* Other transactions may have rows locked; delete rows one by one */
+  if (file->lock_rows)
+    return HA_ERR_WRONG_COMMAND;
   CHECK_UNTIL_WE_FULLY_IMPLEMENTED_VERSIONING("TRUNCATE in WRITE CONCURRENT");
 #ifdef EXTRA_DEBUG
   if (trn && ! (trnman_get_flags(trn) & TRN_STATE_INFO_LOGGED))
@@ -2666,6 +2802,33 @@ void ha_maria::change_table_ptr(TABLE *table_arg, TABLE_SHARE *share)
 }
 
 
+/*
+  Test if a statement changes rows in a way that row locks support
+
+  NOTES
+    SQLCOM_END is used by the replication slave.
+*/
+
+static bool maria_locks_rows(enum_sql_command sql_command)
+{
+  switch (sql_command) {
+  case SQLCOM_UPDATE:
+  case SQLCOM_UPDATE_MULTI:
+  case SQLCOM_DELETE:
+  case SQLCOM_DELETE_MULTI:
+  case SQLCOM_INSERT:
+  case SQLCOM_INSERT_SELECT:
+  case SQLCOM_REPLACE:
+  case SQLCOM_REPLACE_SELECT:
+  case SQLCOM_LOAD:
+  case SQLCOM_END:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+
 int ha_maria::external_lock(THD *thd, int lock_type)
 {
   DBUG_ENTER("ha_maria::external_lock");
@@ -2708,12 +2871,25 @@ int ha_maria::external_lock(THD *thd, int lock_type)
         DBUG_PRINT("info", ("Disabling logging for table"));
         _ma_tmp_disable_logging_for_table(file, TRUE);
       }
+      /*
+        Statements that change rows lock the rows they read and wait for
+        the row locks of other transactions, also if they lock the table.
+      */
+      file->lock_rows= (lock_type == F_WRLCK && file->s->row_locking &&
+                        file->s->now_transactional &&
+                        maria_locks_rows(thd->lex->sql_command));
     }
     else
     {
       TRN *trn= THD_TRN;
       /* End of transaction */
 
+      file->lock_rows= 0;
+      file->last_row_lock= 0;
+
+      /* Wake up writers that wait for auto-increment values of ours */
+      _ma_release_auto_increment(file, 0);
+
       /*
         We always re-enable, don't rely on thd->transaction.on as it is
         sometimes reset to true after unlocking (see mysql_truncate() for a
@@ -2772,6 +2948,14 @@ int ha_maria::external_lock(THD *thd, int lock_type)
                                                F_UNLCK : F_EXTRA_LCK)));
 }
 
+/* Called for rows that UPDATE or DELETE read but didn't change */
+
+void ha_maria::unlock_row()
+{
+  _ma_unlock_row(file);
+}
+
+
 int ha_maria::start_stmt(THD *thd, thr_lock_type lock_type)
 {
   TRN *trn;
@@ -2798,6 +2982,11 @@ int ha_maria::start_stmt(THD *thd, thr_lock_type lock_type)
       call to start_stmt().
     */
     trnman_new_statement(trn);
+    /* As in external_lock(), for each statement under LOCK TABLES */
+    file->lock_rows= (lock_type >= TL_WRITE_ALLOW_WRITE &&
+                      file->s->row_locking && file->s->now_transactional &&
+                      maria_locks_rows(thd->lex->sql_command));
+    file->last_row_lock= 0;
 
 #ifdef EXTRA_DEBUG
     if (!(trnman_get_flags(trn) & TRN_STATE_INFO_LOGGED) &&
@@ -3000,6 +3189,22 @@ THR_LOCK_DATA **ha_maria::store_lock(THD *thd,
           (sql_command == SQLCOM_LOAD && duplicates == DUP_REPLACE))
         lock_type= TL_WRITE;
     }
+    else if ((lock_type == TL_WRITE || lock_type == TL_WRITE_LOW_PRIORITY) &&
+             file->s->row_locking && file->s->now_transactional &&
+             (sql_command == SQLCOM_UPDATE || sql_command == SQLCOM_DELETE) &&
+             !thd->locked_tables_mode &&
+             (thd->is_current_stmt_binlog_format_row() ||
+              !(thd->variables.option_bits & OPTION_BIN_LOG) ||
+              !mysql_bin_log.is_open()))
+    {
+      /*
+        Single table UPDATE and DELETE lock the rows they change, so they
+        can run at the same time as other writers. Statement based logging
+        can't replay them in another order. Rows are changed in place, so
+        the lock keeps out readers.
+      */
+      lock_type= TL_WRITE_CONCURRENT_UPDATE;
+    }
     file->lock.type= lock_type;
   }
   *to++= &file->lock;
@@ -3171,10 +3376,28 @@ void ha_maria::get_auto_increment(ulonglong offset, ulonglong increment,
 {
   ulonglong nr;
   int error;
+  my_bool lock_rows;
   uchar key[MARIA_MAX_KEY_BUFF];
 
   if (!table->s->next_number_key_offset)
   {                                             // Autoincrement at key-start
+    if (file->s->lock.allow_multiple_concurrent_insert)
+    {
+      /*
+        Concurrent inserters get disjoint intervals. Statement based
+        binary logging can only replay consecutive values for a statement,
+        so then no one else may reserve values until the statement ends.
+      */
+      THD *thd= table->in_use;
+      my_bool consecutive= (mysql_bin_log.is_open() &&
+                            (thd->variables.option_bits & OPTION_BIN_LOG) &&
+                            !thd->is_current_stmt_binlog_format_row());
+      if (_ma_reserve_auto_increment(file, increment, nb_desired_values,
+                                     consecutive, first_value))
+        *first_value= ULONGLONG_MAX;
+      *nb_reserved_values= nb_desired_values;
+      return;
+    }
     ha_maria::info(HA_STATUS_AUTO);
     *first_value= stats.auto_increment_value;
     /* Maria has only table-level lock for now, so reserves to +inf */
@@ -3185,6 +3408,9 @@ void ha_maria::get_auto_increment(ulonglong offset, ulonglong increment,
   /* it's safe to call the following if bulk_insert isn't on */
   maria_flush_bulk_insert(file, table->s->next_number_index);
 
+  /* The row is only read for its value, so don't lock it */
+  lock_rows= file->lock_rows;
+  file->lock_rows= 0;
   (void) extra(HA_EXTRA_KEYREAD);
   key_copy(key, table->record[0],
            table->key_info + table->s->next_number_index,
@@ -3201,6 +3427,7 @@ void ha_maria::get_auto_increment(ulonglong offset, ulonglong increment,
          val_int_offset(table->s->rec_buff_length) + 1);
   }
   extra(HA_EXTRA_NO_KEYREAD);
+  file->lock_rows= lock_rows;
   *first_value= nr;
   /*
     MySQL needs to call us for next row: assume we are inserting ("a",null)
@@ -3212,6 +3439,12 @@ void ha_maria::get_auto_increment(ulonglong offset, ulonglong increment,
 }
 
 
+void ha_maria::release_auto_increment()
+{
+  _ma_release_auto_increment(file, next_insert_id);
+}
+
+
 /*
   Find out how many rows there is in the given range
 
@@ -3578,10 +3811,12 @@ static int ha_maria_init(void *p)
   res= maria_upgrade() || maria_init() || ma_control_file_open(TRUE, TRUE) ||
     ((force_start_after_recovery_failures != 0) &&
      mark_recovery_start(log_dir)) ||
-    !init_pagecache(maria_pagecache,
-                    (size_t) pagecache_buffer_size, pagecache_division_limit,
-                    pagecache_age_threshold, maria_block_size, pagecache_file_hash_size,
-                    0) ||
+    !init_segmented_pagecache(maria_pagecache,
+                              (size_t) pagecache_buffer_size,
+                              pagecache_division_limit,
+                              pagecache_age_threshold, maria_block_size,
+                              pagecache_file_hash_size,
+                              (uint) pagecache_segments, 0) ||
     !init_pagecache(maria_log_pagecache,
                     TRANSLOG_PAGECACHE_SIZE, 0, 0,
                     TRANSLOG_PAGE_SIZE, 0, 0) ||
@@ -3687,6 +3922,7 @@ my_bool ha_maria::register_query_cache_table(THD *thd, char *table_name,
 
 struct st_mysql_sys_var* system_variables[]= {
   MYSQL_SYSVAR(block_size),
+  MYSQL_SYSVAR(checkpoint_flush_threads),
   MYSQL_SYSVAR(checkpoint_interval),
   MYSQL_SYSVAR(checkpoint_log_activity),
   MYSQL_SYSVAR(force_start_after_recovery_failures),
@@ -3701,11 +3937,15 @@ struct st_mysql_sys_var* system_variables[]= {
   MYSQL_SYSVAR(pagecache_buffer_size),
   MYSQL_SYSVAR(pagecache_division_limit),
   MYSQL_SYSVAR(pagecache_file_hash_size),
+  MYSQL_SYSVAR(pagecache_segments),
   MYSQL_SYSVAR(recover),
+  MYSQL_SYSVAR(recovery_threads),
   MYSQL_SYSVAR(repair_threads),
+  MYSQL_SYSVAR(row_locking),
   MYSQL_SYSVAR(sort_buffer_size),
   MYSQL_SYSVAR(stats_method),
   MYSQL_SYSVAR(sync_log_dir),
+  MYSQL_SYSVAR(tmp_table_pagecache_size),
   MYSQL_SYSVAR(used_for_temp_tables),
   MYSQL_SYSVAR(encrypt_tables),
   NULL
@@ -3825,14 +4065,31 @@ static void update_log_file_size(MYSQL_THD thd,
 }
 
 
+static SHOW_VAR pagecache_status_variables[]= {
+  {"blocks_not_flushed", (char*) &maria_pagecache_var.global_blocks_changed, SHOW_LONG},
+  {"blocks_unused",      (char*) &maria_pagecache_var.blocks_unused, SHOW_LONG},
+  {"blocks_used",        (char*) &maria_pagecache_var.blocks_used, SHOW_LONG},
+  {"read_requests",      (char*) &maria_pagecache_var.global_cache_r_requests, SHOW_LONGLONG},
+  {"reads",              (char*) &maria_pagecache_var.global_cache_read, SHOW_LONGLONG},
+  {"write_requests",     (char*) &maria_pagecache_var.global_cache_w_requests, SHOW_LONGLONG},
+  {"writes",             (char*) &maria_pagecache_var.global_cache_write, SHOW_LONGLONG},
+  {NullS, NullS, SHOW_LONG}
+};
+
+/**
+   @brief Shows the page cache statistics, summed up over its segments
+*/
+
+static int show_pagecache_vars(THD *thd, SHOW_VAR *var, char *buff)
+{
+  pagecache_collect_stats(maria_pagecache);
+  var->type= SHOW_ARRAY;
+  var->value= (char*) &pagecache_status_variables;
+  return 0;
+}
+
 SHOW_VAR status_variables[]= {
-  {"pagecache_blocks_not_flushed", (char*) &maria_pagecache_var.global_blocks_changed, SHOW_LONG},
-  {"pagecache_blocks_unused",      (char*) &maria_pagecache_var.blocks_unused, SHOW_LONG},
-  {"pagecache_blocks_used",        (char*) &maria_pagecache_var.blocks_used, SHOW_LONG},
-  {"pagecache_read_requests",      (char*) &maria_pagecache_var.global_cache_r_requests, SHOW_LONGLONG},
-  {"pagecache_reads",              (char*) &maria_pagecache_var.global_cache_read, SHOW_LONGLONG},
-  {"pagecache_write_requests",     (char*) &maria_pagecache_var.global_cache_w_requests, SHOW_LONGLONG},
-  {"pagecache_writes",             (char*) &maria_pagecache_var.global_cache_write, SHOW_LONGLONG},
+  {"pagecache",                    (char*) &show_pagecache_vars, SHOW_FUNC},
   {"transaction_log_syncs",        (char*) &translog_syncs, SHOW_LONGLONG},
   {NullS, NullS, SHOW_LONG}
 };
@@ -118,6 +118,7 @@ class ha_maria :public handler
   int extra_opt(enum ha_extra_function operation, ulong cache_size);
   int reset(void);
   int external_lock(THD * thd, int lock_type);
+  void unlock_row();
   int start_stmt(THD *thd, thr_lock_type lock_type);
   int delete_all_rows(void);
   int disable_indexes(uint mode);
@@ -134,6 +135,7 @@ class ha_maria :public handler
                                   ulonglong nb_desired_values,
                                   ulonglong *first_value,
                                   ulonglong *nb_reserved_values);
+  virtual void release_auto_increment();
   int rename_table(const char *from, const char *to);
   int delete_table(const char *name);
   void drop_table(const char *name);
@@ -192,6 +194,7 @@ class ha_maria :public handler
   Item *idx_cond_push(uint keyno, Item* idx_cond);
 private:
   DsMrr_impl ds_mrr;
+  bool skip_changed_row(uchar *buf, int error);
   friend ICP_RESULT index_cond_func_maria(void *arg);
 };
 
@@ -122,6 +122,11 @@
    we didn't fill them)
  - Unlock the bitmap.
  - Mark the bitmap flushable (_ma_bitmap_flushable(X, -1))
+
+ With row locks several writers may change existing rows at the same time.
+ Pages that other writers have in flight, or that hold space freed by
+ another uncommitted transaction, are then kept out of the allocations.
+ See "Pages busy for writers with row locks" below.
 */
 
 #include "maria_def.h"
@@ -145,6 +150,11 @@ static my_bool _ma_bitmap_create_missing(MARIA_HA *info,
                                          MARIA_FILE_BITMAP *bitmap,
                                          pgcache_page_no_t page);
 static void _ma_bitmap_unpin_all(MARIA_SHARE *share);
+static my_bool set_page_bits(MARIA_HA *info, MARIA_FILE_BITMAP *bitmap,
+                             pgcache_page_no_t page, uint fill_pattern);
+static uint bitmap_get_page_bits(MARIA_HA *info, MARIA_FILE_BITMAP *bitmap,
+                                 pgcache_page_no_t page);
+static void unhide_busy_pages(MARIA_HA *info, MARIA_FILE_BITMAP *bitmap);
 
 
 /* Write bitmap page to key cache */
@@ -235,7 +245,10 @@ my_bool _ma_bitmap_init(MARIA_SHARE *share, File file,
 
   if (((bitmap->map= (uchar*) my_malloc(size, MYF(MY_WME))) == NULL) ||
       my_init_dynamic_array(&bitmap->pinned_pages,
-                            sizeof(MARIA_PINNED_PAGE), 1, 1, MYF(0)))
+                            sizeof(MARIA_PINNED_PAGE), 1, 1, MYF(0)) ||
+      my_hash_init(&bitmap->busy_pages, &my_charset_bin, 16,
+                   offsetof(MARIA_BUSY_PAGE, page),
+                   sizeof(pgcache_page_no_t), 0, my_free, HASH_UNIQUE))
     return 1;
 
   bitmap->share= share;
@@ -254,6 +267,8 @@ my_bool _ma_bitmap_init(MARIA_SHARE *share, File file,
   bitmap->flush_all_requested= bitmap->waiting_for_flush_all_requested= 
     bitmap->waiting_for_non_flushable= 0;
   bitmap->non_flushable= 0;
+  bitmap->hidden_pages= 0;
+  bitmap->waiting_for_busy_pages= 0;
 
   /* Update size for bits */
   /* TODO; Make this dependent of the row size */
@@ -326,11 +341,13 @@ my_bool _ma_bitmap_end(MARIA_SHARE *share)
   DBUG_ASSERT(share->bitmap.waiting_for_non_flushable == 0 &&
               share->bitmap.waiting_for_flush_all_requested == 0);
   DBUG_ASSERT(share->bitmap.pinned_pages.elements == 0);
+  DBUG_ASSERT(share->bitmap.busy_pages.records == 0);
 
   res= _ma_bitmap_flush(share);
   mysql_mutex_destroy(&share->bitmap.bitmap_lock);
   mysql_cond_destroy(&share->bitmap.bitmap_cond);
   delete_dynamic(&share->bitmap.pinned_pages);
+  my_hash_free(&share->bitmap.busy_pages);
   my_free(share->bitmap.map);
   share->bitmap.map= 0;
   /*
@@ -1139,6 +1156,8 @@ static my_bool move_to_next_bitmap(MARIA_HA *info, MARIA_FILE_BITMAP *bitmap)
   MARIA_STATE_INFO *state= &info->s->state;
   DBUG_ENTER("move_to_next_bitmap");
 
+  if (bitmap->hidden_pages)
+    unhide_busy_pages(info, bitmap);
   if (state->first_bitmap_with_space != ~(pgcache_page_no_t) 0 &&
       state->first_bitmap_with_space != page)
   {
@@ -1243,8 +1262,7 @@ static my_bool allocate_head(MARIA_FILE_BITMAP *bitmap, uint size,
   uint best_bits= (uint) -1, UNINIT_VAR(best_pos);
   uint first_pattern= 0; /* if doing insert_order */
   MARIA_SHARE *share= bitmap->share;
-  my_bool insert_order=
-      MY_TEST(share->base.extra_options & MA_EXTRA_OPTIONS_INSERT_ORDER);
+  my_bool insert_order= share->insert_order;
   DBUG_ENTER("allocate_head");
 
   DBUG_ASSERT(size <= FULL_PAGE_SIZE(share));
@@ -1586,6 +1604,334 @@ static ulong allocate_full_pages(MARIA_FILE_BITMAP *bitmap,
 }
 
 
+/****************************************************************************
+  Pages busy for writers with row locks
+****************************************************************************/
+
+/*
+  With row locks (see _ma_lock_row()) several UPDATE and DELETE statements
+  change the same table at once. Recovery must still be able to undo the
+  change of an uncommitted transaction at the original place of the row:
+  - A writer that changes a row claims the head and tail pages of the row
+    with _ma_bitmap_claim_pages(), and a writer that allocates a head or
+    tail records the page in busy_pages. No other writer with row locks
+    gets a page that is in flight for someone else.
+  - The pages of changed rows, and full pages freed by DELETE and UPDATE,
+    are reserved for the transaction until it ends. Only that transaction
+    may store new data in the space freed on them.
+  The allocators know nothing of this. A block they find on a busy page is
+  given back, the page is hidden by marking it full in the bitmap, and the
+  allocation is retried. The hidden pages get their real bits back before
+  we use the block or move to another bitmap.
+*/
+
+static MARIA_BUSY_PAGE *find_busy_page(MARIA_FILE_BITMAP *bitmap,
+                                       pgcache_page_no_t page)
+{
+  return (MARIA_BUSY_PAGE*) my_hash_search(&bitmap->busy_pages,
+                                           (uchar*) &page, sizeof(page));
+}
+
+
+/* Find or create the entry for a page */
+
+static MARIA_BUSY_PAGE *get_busy_page(MARIA_FILE_BITMAP *bitmap,
+                                      pgcache_page_no_t page)
+{
+  MARIA_BUSY_PAGE *busy;
+  if (!(busy= find_busy_page(bitmap, page)))
+  {
+    if (!(busy= (MARIA_BUSY_PAGE*) my_malloc(sizeof(*busy),
+                                             MYF(MY_WME | MY_ZEROFILL))))
+      return 0;
+    busy->page= page;
+    if (my_hash_insert(&bitmap->busy_pages, (uchar*) busy))
+    {
+      my_free(busy);
+      return 0;
+    }
+  }
+  return busy;
+}
+
+
+static void free_busy_page_if_unused(MARIA_FILE_BITMAP *bitmap,
+                                     MARIA_BUSY_PAGE *busy)
+{
+  if (!busy->writer && !busy->reserved)
+    my_hash_delete(&bitmap->busy_pages, (uchar*) busy);
+}
+
+
+/* Mark a page as in flight for the handler until release_busy_pages() */
+
+static MARIA_BUSY_PAGE *set_busy_page_writer(MARIA_HA *info,
+                                             MARIA_FILE_BITMAP *bitmap,
+                                             pgcache_page_no_t page)
+{
+  MARIA_BUSY_PAGE *busy;
+  if (!(busy= get_busy_page(bitmap, page)))
+    return 0;
+  if (busy->writer != info)
+  {
+    DBUG_ASSERT(!busy->writer);
+    if (insert_dynamic(&info->busy_pages, (uchar*) &page))
+    {
+      free_busy_page_if_unused(bitmap, busy);
+      return 0;
+    }
+    busy->writer= info;
+  }
+  return busy;
+}
+
+
+/* Reserve the space freed on a page until the transaction ends */
+
+static my_bool reserve_busy_page(MARIA_HA *info, MARIA_BUSY_PAGE *busy)
+{
+  MARIA_USED_TABLES *tables;
+  MARIA_RESERVED_PAGE *reserved;
+
+  if (busy->reserved && busy->reserved_trn == info->trn)
+    return 0;                                   /* Already reserved by us */
+  if (!(tables= _ma_get_used_table(info)) ||
+      !(reserved= (MARIA_RESERVED_PAGE*) my_malloc(sizeof(*reserved),
+                                                   MYF(MY_WME))))
+    return 1;
+  reserved->page= busy->page;
+  reserved->next= tables->reserved_pages;
+  tables->reserved_pages= reserved;
+  /* With many reservers we don't know which one may use the page */
+  busy->reserved_trn= busy->reserved++ ? 0 : info->trn;
+  return 0;
+}
+
+
+/* Forget the pages that the handler has in flight */
+
+static void release_busy_pages(MARIA_HA *info)
+{
+  MARIA_FILE_BITMAP *bitmap= &info->s->bitmap;
+  pgcache_page_no_t *page, *end;
+  mysql_mutex_assert_owner(&bitmap->bitmap_lock);
+
+  page= (pgcache_page_no_t*) info->busy_pages.buffer;
+  end= page + info->busy_pages.elements;
+  for (; page < end; page++)
+  {
+    MARIA_BUSY_PAGE *busy= find_busy_page(bitmap, *page);
+    DBUG_ASSERT(busy && busy->writer == info);
+    busy->writer= 0;
+    free_busy_page_if_unused(bitmap, busy);
+  }
+  info->busy_pages.elements= 0;
+  if (bitmap->waiting_for_busy_pages)
+    mysql_cond_broadcast(&bitmap->bitmap_cond);
+}
+
+
+static my_bool busy_for_others(MARIA_HA *info, MARIA_BUSY_PAGE *busy)
+{
+  return ((busy->writer && busy->writer != info) ||
+          (busy->reserved && busy->reserved_trn != info->trn));
+}
+
+
+/* Mark a busy page full in the bitmap until unhide_busy_pages() */
+
+static void hide_busy_page(MARIA_HA *info, MARIA_FILE_BITMAP *bitmap,
+                           MARIA_BUSY_PAGE *busy)
+{
+  uint used_size;
+  DBUG_ASSERT(busy->page > bitmap->page &&
+              busy->page < bitmap->page + bitmap->pages_covered);
+
+  busy->hidden_bits= bitmap_get_page_bits(info, bitmap, busy->page);
+  set_page_bits(info, bitmap, busy->page, FULL_TAIL_PAGE);
+  busy->next_hidden= bitmap->hidden_pages;
+  bitmap->hidden_pages= busy;
+  /* allocate_full_pages() assumes that all pages after used_size are free */
+  used_size= ((uint) (busy->page - bitmap->page - 1) / 16 + 1) * 6;
+  set_if_bigger(bitmap->used_size, used_size);
+}
+
+
+static void unhide_busy_pages(MARIA_HA *info, MARIA_FILE_BITMAP *bitmap)
+{
+  MARIA_BUSY_PAGE *busy;
+  for (busy= bitmap->hidden_pages; busy; busy= busy->next_hidden)
+    set_page_bits(info, bitmap, busy->page, busy->hidden_bits);
+  bitmap->hidden_pages= 0;
+}
+
+
+/*
+  Check that a block found by the allocators is not busy for others
+
+  SYNOPSIS
+    check_busy_block()
+    info		Maria handler
+    block		Block from allocate_head(), allocate_tail() or
+                        allocate_full_pages()
+    full_pages		1 if block is a range of full pages
+
+  NOTES
+    If the block is on a page that is busy for others, the block is given
+    back and the page is hidden, so that the caller can allocate again.
+
+  RETURN
+    0   ok, block can be used
+    1   block was given back; allocate again
+    -1  error
+*/
+
+static int check_busy_block(MARIA_HA *info, MARIA_BITMAP_BLOCK *block,
+                            my_bool full_pages)
+{
+  MARIA_SHARE *share= info->s;
+  MARIA_FILE_BITMAP *bitmap= &share->bitmap;
+
+  if (bitmap->busy_pages.records)
+  {
+    pgcache_page_no_t page= block->page;
+    pgcache_page_no_t end= page + (full_pages ? block->page_count : 1);
+    for (; page < end; page++)
+    {
+      MARIA_BUSY_PAGE *busy= find_busy_page(bitmap, page);
+      if (busy && busy_for_others(info, busy))
+      {
+        if (full_pages)
+          _ma_bitmap_reset_full_page_bits(info, bitmap, block->page,
+                                          block->page_count);
+        else
+          set_page_bits(info, bitmap, block->page, block->org_bitmap_value);
+        hide_busy_page(info, bitmap, busy);
+        return 1;
+      }
+    }
+    if (bitmap->hidden_pages)
+      unhide_busy_pages(info, bitmap);
+  }
+  if (!full_pages && share->row_locking && share->now_transactional &&
+      !set_busy_page_writer(info, bitmap, block->page))
+    return -1;
+  return 0;
+}
+
+
+/**
+   @brief Claim the pages of a row before changing it with row locks
+
+   @param info     Maria handler
+   @param page     Head page of the row
+   @param tails    Tail positions of the row, ending with 0
+
+   @note
+   Waits until no other writer has the pages in flight. The pages are
+   then in flight for us until _ma_bitmap_flushable(info, -1), and
+   reserved for the transaction until it ends.
+
+   @return Operation status
+     @retval 0      ok
+     @retval 1      error
+*/
+
+my_bool _ma_bitmap_claim_pages(MARIA_HA *info, pgcache_page_no_t page,
+                               MARIA_RECORD_POS *tails)
+{
+  MARIA_FILE_BITMAP *bitmap= &info->s->bitmap;
+  MARIA_BUSY_PAGE *busy;
+  MARIA_RECORD_POS *tail;
+  pgcache_page_no_t next;
+  my_bool res= 0;
+  DBUG_ENTER("_ma_bitmap_claim_pages");
+  DBUG_PRINT("enter", ("page: %lu", (ulong) page));
+
+  mysql_mutex_lock(&bitmap->bitmap_lock);
+  bitmap->waiting_for_busy_pages++;
+  for (next= page, tail= tails ;; )
+  {
+    if ((busy= find_busy_page(bitmap, next)) &&
+        busy->writer && busy->writer != info)
+    {
+      mysql_cond_wait(&bitmap->bitmap_cond, &bitmap->bitmap_lock);
+      next= page;                               /* Check all pages again */
+      tail= tails;
+      continue;
+    }
+    if (!*tail)
+      break;
+    next= ma_recordpos_to_page(*tail++);
+  }
+  bitmap->waiting_for_busy_pages--;
+
+  for (next= page, tail= tails ;; )
+  {
+    if (!(busy= set_busy_page_writer(info, bitmap, next)) ||
+        reserve_busy_page(info, busy))
+    {
+      if (info->busy_pages.elements)
+        release_busy_pages(info);
+      my_errno= HA_ERR_OUT_OF_MEM;
+      res= 1;
+      break;
+    }
+    if (!*tail)
+      break;
+    next= ma_recordpos_to_page(*tail++);
+  }
+  mysql_mutex_unlock(&bitmap->bitmap_lock);
+  DBUG_RETURN(res);
+}
+
+
+/* Check if the space freed on a page is reserved by another transaction */
+
+my_bool _ma_bitmap_page_is_reserved(MARIA_HA *info, pgcache_page_no_t page)
+{
+  MARIA_FILE_BITMAP *bitmap= &info->s->bitmap;
+  MARIA_BUSY_PAGE *busy;
+  my_bool res;
+
+  mysql_mutex_lock(&bitmap->bitmap_lock);
+  res= ((busy= find_busy_page(bitmap, page)) && busy->reserved &&
+        busy->reserved_trn != info->trn);
+  mysql_mutex_unlock(&bitmap->bitmap_lock);
+  return res;
+}
+
+
+/**
+   @brief Release the pages reserved by a transaction
+
+   @note Called when the transaction ends, see _ma_release_row_locks()
+*/
+
+void _ma_bitmap_release_reserved_pages(MARIA_SHARE *share,
+                                       MARIA_USED_TABLES *tables)
+{
+  MARIA_FILE_BITMAP *bitmap= &share->bitmap;
+  MARIA_RESERVED_PAGE *reserved, *next;
+
+  if (!tables->reserved_pages)
+    return;
+  mysql_mutex_lock(&bitmap->bitmap_lock);
+  for (reserved= tables->reserved_pages; reserved; reserved= next)
+  {
+    MARIA_BUSY_PAGE *busy= find_busy_page(bitmap, reserved->page);
+    next= reserved->next;
+    DBUG_ASSERT(busy && busy->reserved);
+    if (!--busy->reserved)
+      busy->reserved_trn= 0;
+    free_busy_page_if_unused(bitmap, busy);
+    my_free(reserved);
+  }
+  tables->reserved_pages= 0;
+  mysql_mutex_unlock(&bitmap->bitmap_lock);
+}
+
+
 /****************************************************************************
   Find right bitmaps where to store data
 ****************************************************************************/
@@ -1615,7 +1961,7 @@ static my_bool find_head(MARIA_HA *info, uint length, uint position)
   */
   block= dynamic_element(&info->bitmap_blocks, position, MARIA_BITMAP_BLOCK *);
 
-  if (info->s->base.extra_options & MA_EXTRA_OPTIONS_INSERT_ORDER)
+  if (info->s->insert_order)
   {
     if (bitmap->page != info->s->last_insert_bitmap &&
         _ma_change_bitmap_page(info, bitmap,
@@ -1629,10 +1975,19 @@ static my_bool find_head(MARIA_HA *info, uint length, uint position)
     We need to have DIRENTRY_SIZE here to take into account that we may
     need an extra directory entry for the row
   */
-  while (allocate_head(bitmap, length + DIR_ENTRY_SIZE, block))
-    if (move_to_next_bitmap(info, bitmap))
+  for (;;)
+  {
+    int busy;
+    if (allocate_head(bitmap, length + DIR_ENTRY_SIZE, block))
+    {
+      if (move_to_next_bitmap(info, bitmap))
+        return 1;
+    }
+    else if (!(busy= check_busy_block(info, block, 0)))
+      return 0;
+    else if (busy < 0)
       return 1;
-  return 0;
+  }
 }
 
 
@@ -1667,10 +2022,19 @@ static my_bool find_tail(MARIA_HA *info, uint length, uint position)
     We have to add DIR_ENTRY_SIZE to ensure we have space for the tail and
     it's directroy entry on the page
   */
-  while (allocate_tail(bitmap, length + DIR_ENTRY_SIZE, block))
-    if (move_to_next_bitmap(info, bitmap))
+  for (;;)
+  {
+    int busy;
+    if (allocate_tail(bitmap, length + DIR_ENTRY_SIZE, block))
+    {
+      if (move_to_next_bitmap(info, bitmap))
+        DBUG_RETURN(1);
+    }
+    else if (!(busy= check_busy_block(info, block, 0)))
+      DBUG_RETURN(0);
+    else if (busy < 0)
       DBUG_RETURN(1);
-  DBUG_RETURN(0);
+  }
 }
 
 
@@ -1698,12 +2062,19 @@ static my_bool find_mid(MARIA_HA *info, ulong pages, uint position)
   MARIA_BITMAP_BLOCK *block;
   block= dynamic_element(&info->bitmap_blocks, position, MARIA_BITMAP_BLOCK *);
 
-  while (!allocate_full_pages(bitmap, pages, block, 1))
+  for (;;)
   {
-    if (move_to_next_bitmap(info, bitmap))
+    int busy;
+    if (!allocate_full_pages(bitmap, pages, block, 1))
+    {
+      if (move_to_next_bitmap(info, bitmap))
+        return 1;
+    }
+    else if (!(busy= check_busy_block(info, block, 1)))
+      return 0;
+    else if (busy < 0)
       return 1;
   }
-  return 0;
 }
 
 
@@ -1769,6 +2140,8 @@ static my_bool find_blob(MARIA_HA *info, ulong length)
         if (move_to_next_bitmap(info, bitmap))
           DBUG_RETURN(1);
       }
+      else if (check_busy_block(info, block, 1))
+        continue;                               /* Given back; try again */
       else
       {
         pages-= used;
@@ -2523,6 +2896,8 @@ void _ma_bitmap_flushable(MARIA_HA *info, int non_flushable_inc)
   {
     DBUG_ASSERT((int) bitmap->non_flushable > 0);
     DBUG_ASSERT(info->non_flushable_state == 1);
+    if (info->busy_pages.elements)
+      release_busy_pages(info);
     if (--bitmap->non_flushable == 0)
     {
       /*
@@ -2687,6 +3062,8 @@ my_bool _ma_bitmap_release_unused(MARIA_HA *info, MARIA_BITMAP_BLOCKS *blocks)
   {
     DBUG_ASSERT(((int) (bitmap->non_flushable)) > 0);
     info->non_flushable_state= 0;
+    if (info->busy_pages.elements)
+      release_busy_pages(info);
     if (--bitmap->non_flushable == 0)
     {
       _ma_bitmap_unpin_all(info->s);
@@ -2747,6 +3124,23 @@ my_bool _ma_bitmap_free_full_pages(MARIA_HA *info, const uchar *extents,
         DBUG_RETURN(1);
       mysql_mutex_lock(&bitmap->bitmap_lock);
       res= _ma_bitmap_reset_full_page_bits(info, bitmap, page, page_count);
+      if (info->lock_rows && !res)
+      {
+        /* Recovery may need the pages back to undo the change */
+        pgcache_page_no_t end= page + page_count;
+        MARIA_BUSY_PAGE *busy;
+        for (; page < end; page++)
+        {
+          if (!(busy= get_busy_page(bitmap, page)) ||
+              reserve_busy_page(info, busy))
+          {
+            if (busy)
+              free_busy_page_if_unused(bitmap, busy);
+            res= 1;
+            break;
+          }
+        }
+      }
       mysql_mutex_unlock(&bitmap->bitmap_lock);
       if (res)
         DBUG_RETURN(1);
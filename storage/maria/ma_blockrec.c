@@ -2668,7 +2668,9 @@ static my_bool write_block_record(MARIA_HA *info,
   *data++= (uchar) flag;
   if (flag & ROW_FLAG_TRANSID)
   {
-    transid_store(data, info->trn->trid);
+    /* With row locks a changed row keeps the trid of its insert */
+    transid_store(data, (old_record && info->lock_rows ? row->trid :
+                         info->trn->trid));
     data+= TRANSID_SIZE;
   }
 
@@ -3708,7 +3710,7 @@ static my_bool _ma_update_block_record2(MARIA_HA *info,
   uchar *buff;
   MARIA_ROW *cur_row= &info->cur_row, *new_row= &info->new_row;
   MARIA_PINNED_PAGE page_link;
-  uint rownr, org_empty_size, head_length;
+  uint rownr, org_empty_size, usable_empty_size, head_length;
   uint block_size= info->s->block_size;
   uint errpos __attribute__((unused)) = 0;
   uchar *dir;
@@ -3734,6 +3736,12 @@ static my_bool _ma_update_block_record2(MARIA_HA *info,
   calc_record_size(info, record, new_row);
   page= ma_recordpos_to_page(record_pos);
 
+  if (info->lock_rows)
+  {
+    new_row->trid= cur_row->trid;
+    if (_ma_bitmap_claim_pages(info, page, cur_row->tail_positions))
+      DBUG_RETURN(1);
+  }
   _ma_bitmap_flushable(info, 1);
   buff= pagecache_read(share->pagecache,
                        &info->dfile, (pgcache_page_no_t) page, 0, 0,
@@ -3754,8 +3762,15 @@ static my_bool _ma_update_block_record2(MARIA_HA *info,
     since we read it.
   */
   head_length= uint2korr(dir + 2);
+  /*
+    Space freed by another transaction that is not yet committed must be
+    kept for the undo of its change
+  */
+  usable_empty_size= ((info->lock_rows &&
+                       _ma_bitmap_page_is_reserved(info, page)) ? 0 :
+                      org_empty_size);
 
-  if ((org_empty_size + head_length) >= new_row->total_length)
+  if ((usable_empty_size + head_length) >= new_row->total_length)
   {
     uint rec_offset, length;
     MARIA_BITMAP_BLOCK block;
@@ -3823,7 +3838,7 @@ static my_bool _ma_update_block_record2(MARIA_HA *info,
 
   head_length= uint2korr(dir + 2);
   if (_ma_bitmap_find_new_place(info, new_row, page, head_length +
-                                org_empty_size, blocks))
+                                usable_empty_size, blocks))
   {
     errpos= 6;
     goto err;
@@ -3837,7 +3852,7 @@ static my_bool _ma_update_block_record2(MARIA_HA *info,
   */
   if ((head_length < new_row->space_on_head_page ||
        (new_row->total_length <= head_length &&
-        org_empty_size + head_length >= new_row->total_length)))
+        usable_empty_size + head_length >= new_row->total_length)))
   {
     _ma_compact_block_page(share,
                            buff, rownr, 1,
@@ -4324,6 +4339,9 @@ my_bool _ma_delete_block_record(MARIA_HA *info, const uchar *record)
   DBUG_PRINT("enter", ("rowid: %lu (%lu:%u)", (ulong) info->cur_row.lastpos,
                        (ulong) page, record_number));
 
+  if (info->lock_rows &&
+      _ma_bitmap_claim_pages(info, page, info->cur_row.tail_positions))
+    DBUG_RETURN(1);
   _ma_bitmap_flushable(info, 1);
   if (delete_head_or_tail(info, page, record_number, 1, 0) ||
       delete_tails(info, info->cur_row.tail_positions))
@@ -4743,6 +4761,8 @@ int _ma_read_block_record2(MARIA_HA *info, uchar *record,
     if (!trnman_can_read_from(info->trn, cur_row->trid))
       DBUG_RETURN(my_errno= HA_ERR_ROW_NOT_VISIBLE);
   }
+  else
+    cur_row->trid= 0;
 
   /* Skip trans header (for now, until we have MVCC csupport) */
   data+= cur_row->header_length + 1 ;
@@ -5127,6 +5147,53 @@ static my_bool read_row_extent_info(MARIA_HA *info, uchar *buff,
 }
 
 
+/*
+  Lock a row and read it, for UPDATE and DELETE with row locks
+
+  @fn     read_and_lock_block_record()
+  @param info                Maria handler
+  @param record              Store record here
+  @param record_pos          Record position
+
+  @note
+  While we wait for the lock, the row may be changed or deleted, and the
+  page reused, by the transaction that had it locked. A row that is gone
+  or that we can't see is reported as deleted, so that the caller skips
+  it.
+
+  @return Status
+  @retval 0  ok
+  @retval #  Error number
+*/
+
+static int read_and_lock_block_record(MARIA_HA *info, uchar *record,
+                                      MARIA_RECORD_POS record_pos)
+{
+  MARIA_SHARE *share= info->s;
+  uchar *data, *end_of_data, *buff;
+  int ret;
+  DBUG_ENTER("read_and_lock_block_record");
+
+  if ((ret= _ma_lock_row(info, record_pos)))
+    DBUG_RETURN(ret);
+  if (!(buff= pagecache_read(share->pagecache,
+                             &info->dfile, ma_recordpos_to_page(record_pos), 0,
+                             info->buff, share->page_type,
+                             PAGECACHE_LOCK_LEFT_UNLOCKED, 0)))
+    ret= my_errno;
+  else if ((buff[PAGE_TYPE_OFFSET] & PAGE_TYPE_MASK) != HEAD_PAGE ||
+           !(data= get_record_position(share, buff,
+                                       ma_recordpos_to_dir_entry(record_pos),
+                                       &end_of_data)) ||
+           (ret= _ma_read_block_record2(info, record, data, end_of_data)) ==
+           HA_ERR_ROW_NOT_VISIBLE)
+    ret= my_errno= HA_ERR_RECORD_DELETED;
+  if (ret)
+    _ma_unlock_row(info);
+  DBUG_RETURN(ret);
+}
+
+
 /*
   Read a record based on record position
 
@@ -5155,6 +5222,9 @@ int _ma_read_block_record(MARIA_HA *info, uchar *record,
 
   offset= ma_recordpos_to_dir_entry(record_pos);
 
+  if (info->lock_rows)
+    DBUG_RETURN(read_and_lock_block_record(info, record, record_pos));
+
   if (!(buff= pagecache_read(share->pagecache,
                              &info->dfile, ma_recordpos_to_page(record_pos), 0,
                              info->buff, share->page_type,
@@ -5459,7 +5529,22 @@ int _ma_scan_block_record(MARIA_HA *info, uchar *record,
     }
 #endif
     DBUG_PRINT("info", ("rowid: %lu", (ulong) info->cur_row.lastpos));
-    error= _ma_read_block_record2(info, record, data, end_of_data);
+    if (info->lock_rows)
+    {
+      /*
+        Lock the row and read it again, as it may change until we have
+        the lock. Rows that went away meanwhile are skipped.
+      */
+      if ((data[0] & ROW_FLAG_TRANSID) &&
+          !trnman_can_read_from(info->trn, transid_korr(data + 1)))
+        error= HA_ERR_ROW_NOT_VISIBLE;
+      else if ((error= _ma_read_block_record(info, record,
+                                             info->cur_row.lastpos)) ==
+               HA_ERR_RECORD_DELETED)
+        error= HA_ERR_ROW_NOT_VISIBLE;
+    }
+    else
+      error= _ma_read_block_record2(info, record, data, end_of_data);
     if (error != HA_ERR_ROW_NOT_VISIBLE)
       DBUG_RETURN(error);
     record_pos++;
@@ -6364,12 +6449,15 @@ uint _ma_apply_redo_insert_row_head_or_tail(MARIA_HA *info, LSN lsn,
     unlock_method= PAGECACHE_LOCK_LEFT_WRITELOCKED;
     unpin_method=  PAGECACHE_PIN_LEFT_PINNED;
 
-    share->pagecache->readwrite_flags&= ~MY_WME;
+    pagecache_set_readwrite_flags(share->pagecache,
+                                  share->pagecache->readwrite_flags &
+                                  ~MY_WME);
     buff= pagecache_read(share->pagecache, &info->dfile,
                          page, 0, 0,
                          PAGECACHE_PLAIN_PAGE, PAGECACHE_LOCK_WRITE,
                          &page_link.link);
-    share->pagecache->readwrite_flags= share->pagecache->org_readwrite_flags;
+    pagecache_set_readwrite_flags(share->pagecache,
+                                  share->pagecache->org_readwrite_flags);
     if (!buff)
     {
       /* Skip errors when reading outside of file and uninitialized pages */
@@ -6862,14 +6950,17 @@ uint _ma_apply_redo_insert_row_blobs(MARIA_HA *info,
         }
         else
         {
-          share->pagecache->readwrite_flags&= ~MY_WME;
+          pagecache_set_readwrite_flags(share->pagecache,
+                                        share->pagecache->readwrite_flags &
+                                        ~MY_WME);
           buff= pagecache_read(share->pagecache,
                                &info->dfile,
                                page, 0, 0,
                                PAGECACHE_PLAIN_PAGE,
                                PAGECACHE_LOCK_WRITE, &page_link.link);
-          share->pagecache->readwrite_flags= share->pagecache->
-            org_readwrite_flags;
+          pagecache_set_readwrite_flags(share->pagecache,
+                                        share->pagecache->
+                                        org_readwrite_flags);
           if (!buff)
           {
             if (my_errno != HA_ERR_FILE_TOO_SHORT &&
@@ -238,6 +238,11 @@ uint _ma_bitmap_get_page_bits(MARIA_HA *info, MARIA_FILE_BITMAP *bitmap,
 void _ma_bitmap_delete_all(MARIA_SHARE *share);
 int  _ma_bitmap_create_first(MARIA_SHARE *share);
 void _ma_bitmap_flushable(MARIA_HA *info, int non_flushable_inc);
+my_bool _ma_bitmap_claim_pages(MARIA_HA *info, pgcache_page_no_t page,
+                               MARIA_RECORD_POS *tails);
+my_bool _ma_bitmap_page_is_reserved(MARIA_HA *info, pgcache_page_no_t page);
+void _ma_bitmap_release_reserved_pages(MARIA_SHARE *share,
+                                       MARIA_USED_TABLES *tables);
 void _ma_bitmap_lock(MARIA_SHARE *share);
 void _ma_bitmap_unlock(MARIA_SHARE *share);
 void _ma_bitmap_set_pagecache_callbacks(PAGECACHE_FILE *file,
@@ -45,6 +45,7 @@
 #include "ma_blockrec.h"
 #include "trnman.h"
 #include "ma_key_recover.h"
+#include "ma_servicethread.h"
 #include <my_check_opt.h>
 
 #include <stdarg.h>
@@ -4145,6 +4146,39 @@ int maria_repair_by_sort(HA_CHECK *param, register MARIA_HA *info,
 }
 
 
+/*
+  Read all keys of one index for maria_repair_parallel() of a BLOCK_RECORD
+  table. Called by ma_service_threads_run(), every index is read with its
+  own scan of the data file.
+*/
+
+static my_bool repair_scan_find_all_keys(void *item,
+                                         void *arg __attribute__((unused)))
+{
+  MARIA_SORT_PARAM *sort_param= (MARIA_SORT_PARAM*) item;
+  my_bool error;
+  DBUG_ENTER("repair_scan_find_all_keys");
+
+  if (sort_param->sort_info->got_error)
+    error= 1;
+  else if (maria_scan_init(sort_param->scan_info))
+  {
+    _ma_check_print_error(sort_param->sort_info->param,
+                          "%d when initializing scan", my_errno);
+    error= 1;
+  }
+  else
+  {
+    error= _ma_thr_find_all_keys_exec(sort_param);
+    maria_scan_end(sort_param->scan_info);
+  }
+  free_root(&sort_param->wordroot, MYF(0));
+  if (error)
+    sort_param->sort_info->got_error= 1;
+  DBUG_RETURN(error);
+}
+
+
 /*
   Threaded repair of table using sorting
 
@@ -4182,6 +4216,15 @@ int maria_repair_by_sort(HA_CHECK *param, register MARIA_HA *info,
       copies its write buffer to the read buffer for the other threads
       and wakes them.
 
+    BLOCK_RECORD
+
+      Only quick repair is done in parallel, a repair that rebuilds the
+      data file is done by maria_repair_by_sort(). Rows are not read
+      through a shared cache but with a scan of the data file through the
+      page cache, so there is no need for all indexes to be read at the
+      same time. Every index gets its own handler for its scan and the
+      indexes are handed out to at most param->repair_threads threads.
+
   RESULT
     0	ok
     <>0	Error
@@ -4209,8 +4252,17 @@ int maria_repair_parallel(HA_CHECK *param, register MARIA_HA *info,
   myf sync_dir= ((share->now_transactional && !share->temporary) ?
                  MY_SYNC_DIR : 0);
   my_bool reenable_logging= 0;
+  my_bool block_record= share->data_file_type == BLOCK_RECORD;
   DBUG_ENTER("maria_repair_parallel");
 
+  /*
+    Rows of a rebuilt BLOCK_RECORD data file can't be handed to other
+    threads while they are written. An internal temporary table can't be
+    cloned for the scans.
+  */
+  if (block_record && (!rep_quick || share->internal_table))
+    DBUG_RETURN(maria_repair_by_sort(param, info, name, rep_quick));
+
   got_error= 1;
   new_file= -1;
   start_records= share->state.state.records;
@@ -4263,13 +4315,17 @@ int maria_repair_parallel(HA_CHECK *param, register MARIA_HA *info,
   /* Initialize pthread structures before goto err. */
   mysql_mutex_init(key_SORT_INFO_mutex, &sort_info.mutex, MY_MUTEX_INIT_FAST);
   mysql_cond_init(key_SORT_INFO_cond, &sort_info.cond, 0);
+  mysql_mutex_init(key_CHECK_print_msg_mutex, &param->print_msg_mutex,
+                   MY_MUTEX_INIT_FAST);
+  param->need_print_msg_lock= 1;
 
   if (!(sort_info.key_block=
 	alloc_key_blocks(param, (uint) param->sort_key_blocks,
 			 share->base.max_key_block_length)))
     goto err;
 
-  if (init_io_cache(&param->read_cache, info->dfile.file,
+  if (!block_record &&
+      init_io_cache(&param->read_cache, info->dfile.file,
                     (uint) param->read_buffer_length,
                     READ_CACHE, share->pack.header_length, 1, MYF(MY_WME)))
     goto err;
@@ -4440,74 +4496,123 @@ int maria_repair_parallel(HA_CHECK *param, register MARIA_HA *info,
     goto err;
 
   sort_info.got_error=0;
-  mysql_mutex_lock(&sort_info.mutex);
-
-  /*
-    Initialize the I/O cache share for use with the read caches and, in
-    case of non-quick repair, the write cache. When all threads join on
-    the cache lock, the writer copies the write cache contents to the
-    read caches.
-  */
-  if (i > 1)
+  if (block_record)
   {
-    if (rep_quick)
-      init_io_cache_share(&param->read_cache, &io_share, NULL, i);
-    else
-      init_io_cache_share(&new_data_cache, &io_share, &info->rec_cache, i);
-  }
-  else
-    io_share.total_threads= 0; /* share not used */
+    uint threads= sort_info.total_keys;
+    enum pagecache_page_type save_page_type= share->page_type;
+    if (param->repair_threads)
+      set_if_smaller(threads, param->repair_threads);
 
-  (void) pthread_attr_init(&thr_attr);
-  (void) pthread_attr_setdetachstate(&thr_attr,PTHREAD_CREATE_DETACHED);
-
-  for (i=0 ; i < sort_info.total_keys ; i++)
-  {
     /*
-      Copy the properly initialized IO_CACHE structure so that every
-      thread has its own copy. In quick mode param->read_cache is shared
-      for use by all threads. In non-quick mode all threads but the
-      first copy the shared new_data_cache, which is synchronized to the
-      write cache of the first thread. The first thread copies
-      param->read_cache, which is not shared.
+      The scans read the rows with their own handlers but share the table.
+      What sort_get_next_record() sets in the share for every row is set
+      here once for all of them, so that they don't change it under each
+      other.
     */
-    sort_param[i].read_cache= ((rep_quick || !i) ? param->read_cache :
-                               new_data_cache);
-    DBUG_PRINT("io_cache_share", ("thread: %u  read_cache: 0x%lx",
-                                  i, (long) &sort_param[i].read_cache));
+    share->page_type= PAGECACHE_READ_UNKNOWN_PAGE;
+    share->state.state.data_file_length= sort_info.filelength;
+
+    for (i=0 ; i < sort_info.total_keys ; i++)
+    {
+      sort_param[i].sortbuff_size=
+        param->sort_buffer_length/sort_info.total_keys;
+      if (!(sort_param[i].scan_info= maria_clone(share, share->mode)))
+      {
+        _ma_check_print_error(param, "%d when opening table for scan",
+                              my_errno);
+        sort_info.got_error=1;
+        break;
+      }
+      maria_ignore_trids(sort_param[i].scan_info);
+    }
+    if (!sort_info.got_error)
+      (void) ma_service_threads_run(threads, sort_param, sizeof(*sort_param),
+                                    sort_info.total_keys,
+                                    repair_scan_find_all_keys, NULL);
+
+    for (i=0 ; i < sort_info.total_keys && sort_param[i].scan_info ; i++)
+    {
+      MARIA_HA *scan_info= sort_param[i].scan_info;
+      maria_ftparser_call_deinitializer(scan_info);
+      /* The clone of a temporary table has a write lock it didn't count */
+      scan_info->lock_type= F_UNLCK;
+      if (maria_close(scan_info))
+        sort_info.got_error=1;
+      sort_param[i].scan_info= 0;
+    }
+    share->page_type= save_page_type;
+  }
+  else
+  {
+    mysql_mutex_lock(&sort_info.mutex);
 
     /*
-      two approaches: the same amount of memory for each thread
-      or the memory for the same number of keys for each thread...
-      In the second one all the threads will fill their sort_buffers
-      (and call write_keys) at the same time, putting more stress on i/o.
+      Initialize the I/O cache share for use with the read caches and, in
+      case of non-quick repair, the write cache. When all threads join on
+      the cache lock, the writer copies the write cache contents to the
+      read caches.
     */
-    sort_param[i].sortbuff_size=
+    if (i > 1)
+    {
+      if (rep_quick)
+        init_io_cache_share(&param->read_cache, &io_share, NULL, i);
+      else
+        init_io_cache_share(&new_data_cache, &io_share, &info->rec_cache, i);
+    }
+    else
+      io_share.total_threads= 0; /* share not used */
+
+    (void) pthread_attr_init(&thr_attr);
+    (void) pthread_attr_setdetachstate(&thr_attr,PTHREAD_CREATE_DETACHED);
+
+    for (i=0 ; i < sort_info.total_keys ; i++)
+    {
+      /*
+        Copy the properly initialized IO_CACHE structure so that every
+        thread has its own copy. In quick mode param->read_cache is shared
+        for use by all threads. In non-quick mode all threads but the
+        first copy the shared new_data_cache, which is synchronized to the
+        write cache of the first thread. The first thread copies
+        param->read_cache, which is not shared.
+      */
+      sort_param[i].read_cache= ((rep_quick || !i) ? param->read_cache :
+                                 new_data_cache);
+      DBUG_PRINT("io_cache_share", ("thread: %u  read_cache: 0x%lx",
+                                    i, (long) &sort_param[i].read_cache));
+
+      /*
+        two approaches: the same amount of memory for each thread
+        or the memory for the same number of keys for each thread...
+        In the second one all the threads will fill their sort_buffers
+        (and call write_keys) at the same time, putting more stress on i/o.
+      */
+      sort_param[i].sortbuff_size=
 #ifndef USING_SECOND_APPROACH
-      param->sort_buffer_length/sort_info.total_keys;
+        param->sort_buffer_length/sort_info.total_keys;
 #else
-      param->sort_buffer_length*sort_param[i].key_length/total_key_length;
+        param->sort_buffer_length*sort_param[i].key_length/total_key_length;
 #endif
-    if (mysql_thread_create(key_thread_find_all_keys,
-                            &sort_param[i].thr, &thr_attr,
-	                    _ma_thr_find_all_keys, (void *) (sort_param+i)))
-    {
-      _ma_check_print_error(param,"Cannot start a repair thread");
-      /* Cleanup: Detach from the share. Avoid others to be blocked. */
-      if (io_share.total_threads)
-        remove_io_thread(&sort_param[i].read_cache);
-      DBUG_PRINT("error", ("Cannot start a repair thread"));
-      sort_info.got_error=1;
+      if (mysql_thread_create(key_thread_find_all_keys,
+                              &sort_param[i].thr, &thr_attr,
+                              _ma_thr_find_all_keys, (void *) (sort_param+i)))
+      {
+        _ma_check_print_error(param,"Cannot start a repair thread");
+        /* Cleanup: Detach from the share. Avoid others to be blocked. */
+        if (io_share.total_threads)
+          remove_io_thread(&sort_param[i].read_cache);
+        DBUG_PRINT("error", ("Cannot start a repair thread"));
+        sort_info.got_error=1;
+      }
+      else
+        sort_info.threads_running++;
     }
-    else
-      sort_info.threads_running++;
-  }
-  (void) pthread_attr_destroy(&thr_attr);
+    (void) pthread_attr_destroy(&thr_attr);
 
-  /* waiting for all threads to finish */
-  while (sort_info.threads_running)
-    mysql_cond_wait(&sort_info.cond, &sort_info.mutex);
-  mysql_mutex_unlock(&sort_info.mutex);
+    /* waiting for all threads to finish */
+    while (sort_info.threads_running)
+      mysql_cond_wait(&sort_info.cond, &sort_info.mutex);
+    mysql_mutex_unlock(&sort_info.mutex);
+  }
 
   if ((got_error= _ma_thr_write_keys(sort_param)))
   {
@@ -4665,6 +4770,8 @@ int maria_repair_parallel(HA_CHECK *param, register MARIA_HA *info,
 
   mysql_cond_destroy (&sort_info.cond);
   mysql_mutex_destroy(&sort_info.mutex);
+  mysql_mutex_destroy(&param->print_msg_mutex);
+  param->need_print_msg_lock= 0;
 
   /* If caller had disabled logging it's not up to us to re-enable it */
   if (reenable_logging)
@@ -4686,7 +4793,8 @@ static int sort_key_read(MARIA_SORT_PARAM *sort_param, uchar *key)
 {
   int error;
   MARIA_SORT_INFO *sort_info= sort_param->sort_info;
-  MARIA_HA *info= sort_info->info;
+  MARIA_HA *info= (sort_param->scan_info ? sort_param->scan_info :
+                   sort_info->info);
   MARIA_KEY int_key;
   DBUG_ENTER("sort_key_read");
 
@@ -4720,7 +4828,8 @@ static int sort_maria_ft_key_read(MARIA_SORT_PARAM *sort_param, uchar *key)
 {
   int error;
   MARIA_SORT_INFO *sort_info=sort_param->sort_info;
-  MARIA_HA *info=sort_info->info;
+  MARIA_HA *info= (sort_param->scan_info ? sort_param->scan_info :
+                   sort_info->info);
   FT_WORD *wptr=0;
   MARIA_KEY int_key;
   DBUG_ENTER("sort_maria_ft_key_read");
@@ -4812,7 +4921,8 @@ static int sort_get_next_record(MARIA_SORT_PARAM *sort_param)
   MARIA_BLOCK_INFO block_info;
   MARIA_SORT_INFO *sort_info=sort_param->sort_info;
   HA_CHECK *param=sort_info->param;
-  MARIA_HA *info=sort_info->info;
+  MARIA_HA *info= (sort_param->scan_info ? sort_param->scan_info :
+                   sort_info->info);
   MARIA_SHARE *share= info->s;
   char llbuff[22],llbuff2[22];
   DBUG_ENTER("sort_get_next_record");
@@ -4841,7 +4951,7 @@ static int sort_get_next_record(MARIA_SORT_PARAM *sort_param)
       */
       enum pagecache_page_type save_page_type= share->page_type;
       share->page_type= PAGECACHE_READ_UNKNOWN_PAGE;
-      if (info != sort_info->new_info)
+      if (sort_info->info != sort_info->new_info)
       {
         /* Safe scanning */
         flag= _ma_safe_scan_block_record(sort_info, info,
@@ -536,6 +536,8 @@ filter_flush_file_evenly(enum pagecache_page_type type,
 static ulong maria_checkpoint_min_cache_activity= 10*1024*1024;
 /* Set in ha_maria.cc */
 ulong maria_checkpoint_min_log_activity= 1*1024*1024;
+/* Number of threads that flush tables in a checkpoint and in recovery */
+ulong maria_checkpoint_flush_threads= 1;
 
 pthread_handler_t ma_checkpoint_background(void *arg)
 {
@@ -590,6 +592,8 @@ pthread_handler_t ma_checkpoint_background(void *arg)
       {
         TRANSLOG_ADDRESS horizon= translog_get_horizon();
 
+        /* Sum up global_cache_write of the page cache segments */
+        pagecache_collect_stats(maria_pagecache);
         /*
           With background flushing evenly distributed over the time
           between two checkpoints, we should have only little flushing to do
@@ -625,6 +629,7 @@ pthread_handler_t ma_checkpoint_background(void *arg)
           below is possibly greater than last_checkpoint_lsn.
         */
         log_horizon_at_last_checkpoint= translog_get_horizon();
+        pagecache_collect_stats(maria_pagecache);
         pagecache_flushes_at_last_checkpoint=
           maria_pagecache->global_cache_write;
         /*
@@ -725,6 +730,64 @@ pthread_handler_t ma_checkpoint_background(void *arg)
 }
 
 
+/** What checkpoint_flush_file() flushes */
+
+struct st_checkpoint_flush
+{
+  PAGECACHE_FLUSH_FILTER filter;
+  struct st_filter_param *filter_param;
+};
+
+
+/**
+   @brief Flushes and syncs the data and index files of one table.
+
+   Called by ma_service_threads_run() for each table stored in the
+   checkpoint record, from up to maria_checkpoint_flush_threads threads.
+   The filters of a checkpoint only read their filter_param, so it can be
+   shared by the threads.
+
+   @param  item                Data file in dfiles[], the index file is
+                               at the same position in kfiles[]
+   @param  arg                 struct st_checkpoint_flush
+
+   @return Operation status
+     @retval 0      OK
+     @retval 1      Error
+*/
+
+static my_bool checkpoint_flush_file(void *item, void *arg)
+{
+  PAGECACHE_FILE *dfile= (PAGECACHE_FILE *) item;
+  PAGECACHE_FILE *kfile= kfiles + (dfile - dfiles);
+  struct st_checkpoint_flush *flush= (struct st_checkpoint_flush *) arg;
+
+  if (flush->filter != NULL)
+  {
+    if ((flush_pagecache_blocks_with_filter(maria_pagecache,
+                                            dfile, FLUSH_KEEP_LAZY,
+                                            flush->filter,
+                                            flush->filter_param) &
+         PCFLUSH_ERROR))
+      ma_message_no_user(0, "checkpoint data page flush failed");
+    if ((flush_pagecache_blocks_with_filter(maria_pagecache,
+                                            kfile, FLUSH_KEEP_LAZY,
+                                            flush->filter,
+                                            flush->filter_param) &
+         PCFLUSH_ERROR))
+      ma_message_no_user(0, "checkpoint index page flush failed");
+  }
+  /*
+    fsyncs the fd, that's the loooong operation (e.g. max 150 fsync
+    per second, so if you have touched 1000 files it's 7 seconds).
+    In case of error, we continue because writing other tables to disk is
+    still useful.
+  */
+  return (mysql_file_sync(dfile->file, MYF(MY_WME | MY_IGNORE_BADFD)) |
+          mysql_file_sync(kfile->file, MYF(MY_WME | MY_IGNORE_BADFD))) != 0;
+}
+
+
 /**
    @brief Allocates buffer and stores in it some info about open tables,
    does some flushing on those.
@@ -1167,33 +1230,22 @@ static int collect_tables(LEX_STRING *str, LSN checkpoint_start_log_horizon)
       the evicter will fail to write their page: corruption.
     */
 
-    if (!ignore_share)
-    {
-      if (filter != NULL)
-      {
-        if ((flush_pagecache_blocks_with_filter(maria_pagecache,
-                                                &dfile, FLUSH_KEEP_LAZY,
-                                                filter, &filter_param) &
-             PCFLUSH_ERROR))
-          ma_message_no_user(0, "checkpoint data page flush failed");
-        if ((flush_pagecache_blocks_with_filter(maria_pagecache,
-                                                &kfile, FLUSH_KEEP_LAZY,
-                                                filter, &filter_param) &
-             PCFLUSH_ERROR))
-          ma_message_no_user(0, "checkpoint index page flush failed");
-      }
-      /*
-        fsyncs the fd, that's the loooong operation (e.g. max 150 fsync
-        per second, so if you have touched 1000 files it's 7 seconds).
-      */
-      sync_error|=
-        mysql_file_sync(dfile.file, MYF(MY_WME | MY_IGNORE_BADFD)) |
-        mysql_file_sync(kfile.file, MYF(MY_WME | MY_IGNORE_BADFD));
-      /*
-        in case of error, we continue because writing other tables to disk is
-        still useful.
-      */
-    }
+    /*
+      The files remembered in dfiles[] and kfiles[] are flushed and synced
+      below, once the states of all tables are written, so that several
+      tables can be flushed at the same time.
+    */
+  }
+
+  {
+    struct st_checkpoint_flush flush;
+    flush.filter= filter;
+    flush.filter_param= &filter_param;
+    sync_error|=
+      ma_service_threads_run((uint) maria_checkpoint_flush_threads,
+                             dfiles, sizeof(*dfiles),
+                             (uint) (dfiles_end - dfiles),
+                             checkpoint_flush_file, &flush);
   }
 
   if (sync_error)
@@ -169,6 +169,9 @@ int maria_close(register MARIA_HA *info)
         error= my_errno;
     }
     thr_lock_delete(&share->lock);
+    DBUG_ASSERT(!share->row_locks.records && !share->key_locks.records);
+    my_hash_free(&share->row_locks);
+    my_hash_free(&share->key_locks);
     mysql_mutex_destroy(&share->key_del_lock);
 
     {
@@ -241,6 +244,7 @@ int maria_close(register MARIA_HA *info)
   }
   if (share_can_be_freed)
   {
+    _ma_end_private_pagecache(share);
     ma_crypt_free(share);
     (void) mysql_mutex_destroy(&share->intern_lock);
     (void) mysql_mutex_destroy(&share->close_lock);
@@ -264,6 +268,7 @@ int maria_close(register MARIA_HA *info)
   }
 
   delete_dynamic(&info->pinned_pages);
+  delete_dynamic(&info->busy_pages);
   my_free(info);
 
   if (error)
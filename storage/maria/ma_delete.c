@@ -38,6 +38,7 @@ int maria_delete(MARIA_HA *info,const uchar *record)
   uint i;
   uchar *old_key;
   int save_errno;
+  my_bool error;
   char lastpos[8];
   MARIA_SHARE *share= info->s;
   MARIA_KEYDEF *keyinfo;
@@ -71,27 +72,34 @@ int maria_delete(MARIA_HA *info,const uchar *record)
   /* Remove all keys from the index file */
 
   old_key= info->lastkey_buff2;
+  /* The row keeps its lock until the transaction ends */
+  info->last_row_lock= 0;
 
   for (i=0, keyinfo= share->keyinfo ; i < share->base.keys ; i++, keyinfo++)
   {
     if (maria_is_key_active(share->state.key_map, i))
     {
+      /* With row locks other writers may change the index at the same time */
+      if (info->lock_rows)
+        mysql_rwlock_wrlock(&keyinfo->root_lock);
       keyinfo->version++;
       if (keyinfo->flag & HA_FULLTEXT)
-      {
-        if (_ma_ft_del(info, i, old_key, record, info->cur_row.lastpos))
-          goto err;
-      }
+        error= _ma_ft_del(info, i, old_key, record, info->cur_row.lastpos);
       else
       {
         MARIA_KEY key;
-        if (keyinfo->ck_delete(info,
-                               (*keyinfo->make_key)(info, &key, i, old_key,
-                                                    record,
-                                                    info->cur_row.lastpos,
-                                                    info->cur_row.trid)))
-          goto err;
+        error= ((info->lock_rows && (keyinfo->flag & HA_NOSAME) &&
+                 _ma_lock_unique_key(info, i, record)) ||
+                keyinfo->ck_delete(info,
+                                   (*keyinfo->make_key)(info, &key, i,
+                                                        old_key, record,
+                                                        info->cur_row.lastpos,
+                                                        info->cur_row.trid)));
       }
+      if (info->lock_rows)
+        mysql_rwlock_unlock(&keyinfo->root_lock);
+      if (error)
+        goto err;
       /* The above changed info->lastkey2. Inform maria_rnext_same(). */
       info->update&= ~HA_STATE_RNEXT_SAME;
     }
@@ -126,6 +134,8 @@ int maria_delete(MARIA_HA *info,const uchar *record)
     (*info->invalidator)(share->open_file_name.str);
     info->invalidator=0;
   }
+  if (share->private_pagecache)
+    (void) _ma_flush_private_pagecache(info);
   DBUG_RETURN(0);
 
 err:
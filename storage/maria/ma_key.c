@@ -336,6 +336,109 @@ MARIA_KEY *_ma_make_key(MARIA_HA *info, MARIA_KEY *int_key, uint keynr,
 } /* _ma_make_key */
 
 
+/*
+  Calculate a hash of the key value of a row
+
+  SYNOPSIS
+    _ma_key_hash()
+    info		Maria handler
+    keynr		Key number
+    record		Row to take the key value from
+    hash		Store hash here
+
+  NOTES
+    Values that are equal for the index get the same hash, also when their
+    bytes differ (like 'a' and 'A ' in a case insensitive collation).
+    Floating point and NUM parts are not part of the hash.
+    This is used to lock unique key values, see _ma_lock_unique_key().
+
+  RETURN
+    0   ok
+    1   A part of the key is NULL
+*/
+
+my_bool _ma_key_hash(MARIA_HA *info, uint keynr, const uchar *record,
+                     ha_checksum *hash)
+{
+  HA_KEYSEG *keyseg;
+  ulong seed1= 0, seed2= 4;
+  ha_checksum crc= 0;
+
+  for (keyseg= info->s->keyinfo[keynr].seg ; keyseg->type ; keyseg++)
+  {
+    enum ha_base_keytype type= (enum ha_base_keytype) keyseg->type;
+    const uchar *pos= record + keyseg->start;
+    uint length= keyseg->length;
+    uint char_length;
+    CHARSET_INFO *cs= keyseg->charset;
+
+    if (keyseg->null_bit && (record[keyseg->null_pos] & keyseg->null_bit))
+      return 1;
+    if (type == HA_KEYTYPE_FLOAT || type == HA_KEYTYPE_DOUBLE ||
+        type == HA_KEYTYPE_NUM)
+      continue;
+
+    char_length= ((cs && cs->mbmaxlen > 1) ? length/cs->mbmaxlen : length);
+    if (keyseg->flag & HA_VAR_LENGTH_PART)
+    {
+      uint pack_length= (keyseg->bit_start == 1 ? 1 : 2);
+      uint tmp_length= (pack_length == 1 ? (uint) *pos :
+                        uint2korr(pos));
+      pos+= pack_length;			/* Skip VARCHAR length */
+      set_if_smaller(length, tmp_length);
+    }
+    else if (keyseg->flag & HA_BLOB_PART)
+    {
+      uint tmp_length= _ma_calc_blob_length(keyseg->bit_start, pos);
+      memcpy(&pos, pos + keyseg->bit_start, sizeof(char*));
+      set_if_smaller(length, tmp_length);
+    }
+    if (type == HA_KEYTYPE_TEXT || type == HA_KEYTYPE_VARTEXT1 ||
+        type == HA_KEYTYPE_VARTEXT2)
+    {
+      FIX_LENGTH(cs, pos, length, char_length);
+      cs->coll->hash_sort(cs, pos, char_length, &seed1, &seed2);
+    }
+    else
+      my_hash_sort_bin((CHARSET_INFO*) 0, pos, length, &seed1, &seed2);
+    crc+= seed1;
+  }
+  *hash= crc;
+  return 0;
+}
+
+
+/*
+  Check if a row still has the key value that the last index read found
+
+  SYNOPSIS
+    _ma_row_key_changed()
+    info		Maria handler
+    record		Row read by the last index read
+
+  NOTES
+    With row locks the row may be changed by another transaction between
+    the index read and the time we get the lock on the row.
+
+  RETURN
+    0   Row has the key of info->last_key
+    1   Key of row has changed
+*/
+
+my_bool _ma_row_key_changed(MARIA_HA *info, const uchar *record)
+{
+  MARIA_KEY key;
+  uchar key_buff[MARIA_MAX_KEY_BUFF];
+  uint diff_pos[2];
+
+  if (info->lastinx < 0)
+    return 0;
+  _ma_make_key(info, &key, (uint) info->lastinx, key_buff, record, 0, 0);
+  return ha_key_cmp(key.keyinfo->seg, info->last_key.data, key.data,
+                    key.data_length, SEARCH_FIND, diff_pos) != 0;
+}
+
+
 /*
   Pack a key to intern format from given format (c_rkey)
 
@@ -20,6 +20,7 @@
 */
 
 #include "ma_ftdefs.h"
+#include "trnman.h"
 
 	/* lock table by F_UNLCK, F_RDLCK or F_WRLCK */
 
@@ -607,3 +608,468 @@ my_bool _ma_set_uuid(MARIA_SHARE *share, my_bool reset_uuid)
                              mi_uint2korr(share->state.header.base_pos),
                              MYF(MY_NABP));
 }
+
+
+/*
+  Auto-increment values for concurrent writers
+
+  Transactional block record tables allow many concurrent inserters. They
+  get disjoint intervals of auto-increment values from
+  share->auto_increment_reserved instead of reserving everything above
+  the current value for the duration of the statement.
+  A statement that needs consecutive values (statement based binary
+  logging only logs the first value of a statement) becomes the owner of
+  the reservations until it releases them. Other writers that want values
+  wait for the owner through the waiting_threads graph, which detects
+  deadlocks with waits for unique keys of other transactions.
+*/
+
+/**
+   @brief Wait until no other handler owns the auto-increment reservations
+
+   @note share->intern_lock must be locked
+
+   @return 0  ok
+   @return #  HA_ERR_LOCK_DEADLOCK or HA_ERR_LOCK_WAIT_TIMEOUT
+*/
+
+static int _ma_wait_for_auto_increment_owner(MARIA_HA *info)
+{
+  MARIA_SHARE *share= info->s;
+  MARIA_HA *owner;
+  DBUG_ENTER("_ma_wait_for_auto_increment_owner");
+
+  while ((owner= share->auto_increment_owner) && owner != info)
+  {
+    WT_RESOURCE_ID rc;
+    int res;
+    PSI_stage_info old_stage_info;
+
+    if (!info->trn->wt || !owner->trn->wt)
+      DBUG_RETURN(my_errno= HA_ERR_LOCK_WAIT_TIMEOUT);
+    rc.type= &ma_rc_auto_increment;
+    rc.value= (intptr) share;
+    if (wt_thd_will_wait_for(info->trn->wt, owner->trn->wt, &rc) != WT_OK)
+      DBUG_RETURN(my_errno= HA_ERR_LOCK_DEADLOCK);
+    proc_info_hook(0, &stage_waiting_for_a_resource, &old_stage_info,
+                   __func__, __FILE__, __LINE__);
+    res= wt_thd_cond_timedwait(info->trn->wt, &share->intern_lock);
+    proc_info_hook(0, &old_stage_info, 0, __func__, __FILE__, __LINE__);
+    if (res != WT_OK)
+      DBUG_RETURN(my_errno= (res == WT_TIMEOUT ? HA_ERR_LOCK_WAIT_TIMEOUT :
+                             HA_ERR_LOCK_DEADLOCK));
+  }
+  DBUG_RETURN(0);
+}
+
+
+/**
+   @brief Reserve an interval of auto-increment values
+
+   @param info               Maria handler
+   @param increment          auto_increment_increment of the statement
+   @param nb_desired_values  Number of values wanted
+   @param consecutive        Keep the reservations of the statement
+                             consecutive until _ma_release_auto_increment()
+   @param first_value        Store first value of interval here
+
+   @note The caller rounds first_value to its offset and increment.
+   The reserved interval covers nb_desired_values values after that.
+
+   @return 0  ok
+   @return #  HA_ERR_LOCK_DEADLOCK or HA_ERR_LOCK_WAIT_TIMEOUT
+*/
+
+int _ma_reserve_auto_increment(MARIA_HA *info, ulonglong increment,
+                               ulonglong nb_desired_values,
+                               my_bool consecutive, ulonglong *first_value)
+{
+  MARIA_SHARE *share= info->s;
+  ulonglong last;
+  int error;
+  DBUG_ENTER("_ma_reserve_auto_increment");
+
+  mysql_mutex_lock(&share->intern_lock);
+  if ((error= _ma_wait_for_auto_increment_owner(info)))
+  {
+    mysql_mutex_unlock(&share->intern_lock);
+    DBUG_RETURN(error);
+  }
+  if (consecutive)
+    share->auto_increment_owner= info;
+
+  last= MY_MAX(share->auto_increment_reserved, share->state.auto_increment);
+  *first_value= last + 1;
+  if (nb_desired_values * increment > ULONGLONG_MAX - last)
+    last= ULONGLONG_MAX;
+  else
+    last+= nb_desired_values * increment;
+  share->auto_increment_reserved= info->auto_increment_reserved_end= last;
+  /* Rollback of an insert must not lower the value below our interval */
+  share->last_auto_increment= ~(ulonglong) 0;
+  mysql_mutex_unlock(&share->intern_lock);
+  DBUG_PRINT("info", ("first: %llu  last: %llu  consecutive: %d",
+                      *first_value, last, (int) consecutive));
+  DBUG_RETURN(0);
+}
+
+
+/**
+   @brief Ensure that a written value is not reserved for another writer
+
+   @note Values that were not reserved come from the user or from the
+   binary log. They wait for a statement that needs consecutive values.
+
+   @return 0  ok
+   @return #  HA_ERR_LOCK_DEADLOCK or HA_ERR_LOCK_WAIT_TIMEOUT
+*/
+
+int _ma_update_auto_increment_reserved(MARIA_HA *info, ulonglong value)
+{
+  MARIA_SHARE *share= info->s;
+  int error= 0;
+
+  if (value <= share->auto_increment_reserved)
+    return 0;                                   /* Common case */
+  mysql_mutex_lock(&share->intern_lock);
+  if (value > share->auto_increment_reserved &&
+      !(error= _ma_wait_for_auto_increment_owner(info)))
+    set_if_bigger(share->auto_increment_reserved, value);
+  mysql_mutex_unlock(&share->intern_lock);
+  return error;
+}
+
+
+/**
+   @brief End the use of auto-increment values for the statement
+
+   @param info        Maria handler
+   @param next_value  First value that the statement did not use, 0 if
+                      not known
+
+   @note Returns the unused end of our last interval if no one reserved
+   values after it, and wakes up writers that wait for us.
+*/
+
+void _ma_release_auto_increment(MARIA_HA *info, ulonglong next_value)
+{
+  MARIA_SHARE *share= info->s;
+  DBUG_ENTER("_ma_release_auto_increment");
+
+  if (!info->auto_increment_reserved_end &&
+      share->auto_increment_owner != info)
+    DBUG_VOID_RETURN;
+
+  mysql_mutex_lock(&share->intern_lock);
+  if (next_value && next_value - 1 < info->auto_increment_reserved_end &&
+      share->auto_increment_reserved == info->auto_increment_reserved_end)
+    share->auto_increment_reserved= next_value - 1;
+  info->auto_increment_reserved_end= 0;
+  if (share->auto_increment_owner == info)
+  {
+    share->auto_increment_owner= 0;
+    if (info->trn && info->trn->wt)
+    {
+      WT_RESOURCE_ID rc;
+      rc.type= &ma_rc_auto_increment;
+      rc.value= (intptr) share;
+      wt_thd_release(info->trn->wt, &rc);
+    }
+  }
+  mysql_mutex_unlock(&share->intern_lock);
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Row locks for concurrent UPDATE and DELETE
+
+  With aria_row_locking, UPDATE and DELETE of transactional tables run at
+  the same time as other writers (see ha_maria::store_lock()). A row is
+  locked when it is read for the change, see _ma_read_block_record(). The
+  lock is kept until the transaction ends, or until the caller finds that
+  the row is not changed after all, see _ma_unlock_row().
+  Unique key values that UPDATE and DELETE remove are locked the same way,
+  so that no one inserts them again before the transaction ends; recovery
+  must be able to undo the change. The values that UPDATE adds are locked
+  too, as their keys carry the trid of the committed row. Writers of unique
+  keys wait for such locks in _ma_wait_for_unique_key().
+  All locks are resources in the waiting_threads graph, which detects
+  deadlocks, also with the waits for auto-increment values.
+*/
+
+/**
+   @brief Wait until the owner of a lock releases it
+
+   @note share->intern_lock must be locked
+
+   @return 0  ok; the lock may be gone
+   @return #  HA_ERR_LOCK_DEADLOCK or HA_ERR_LOCK_WAIT_TIMEOUT
+*/
+
+static int _ma_wait_for_lock(MARIA_HA *info, MARIA_ROW_LOCK *lock)
+{
+  MARIA_SHARE *share= info->s;
+  int res;
+  PSI_stage_info old_stage_info;
+  DBUG_ENTER("_ma_wait_for_lock");
+
+  if (!info->trn->wt || !lock->wt)
+    DBUG_RETURN(my_errno= HA_ERR_LOCK_WAIT_TIMEOUT);
+  if (wt_thd_will_wait_for(info->trn->wt, lock->wt, &lock->id) != WT_OK)
+    DBUG_RETURN(my_errno= HA_ERR_LOCK_DEADLOCK);
+  proc_info_hook(0, &stage_waiting_for_a_resource, &old_stage_info,
+                 __func__, __FILE__, __LINE__);
+  res= wt_thd_cond_timedwait(info->trn->wt, &share->intern_lock);
+  proc_info_hook(0, &old_stage_info, 0, __func__, __FILE__, __LINE__);
+  if (res != WT_OK)
+    DBUG_RETURN(my_errno= (res == WT_TIMEOUT ? HA_ERR_LOCK_WAIT_TIMEOUT :
+                           HA_ERR_LOCK_DEADLOCK));
+  DBUG_RETURN(0);
+}
+
+
+/**
+   @brief Add a lock of the transaction
+
+   @note share->intern_lock must be locked
+
+   @return lock, 0 if out of memory
+*/
+
+static MARIA_ROW_LOCK *_ma_add_lock(MARIA_HA *info, HASH *hash,
+                                    WT_RESOURCE_TYPE *type, ulonglong value)
+{
+  MARIA_USED_TABLES *tables;
+  MARIA_ROW_LOCK *lock;
+
+  if (!(tables= _ma_get_used_table(info)) ||
+      !(lock= (MARIA_ROW_LOCK*) my_malloc(sizeof(*lock), MYF(MY_WME))))
+    return 0;
+  lock->id.value= value;
+  lock->id.type= type;
+  lock->trn= info->trn;
+  lock->wt= info->trn->wt;
+  if (my_hash_insert(hash, (uchar*) lock))
+  {
+    my_free(lock);
+    return 0;
+  }
+  lock->next= tables->row_locks;
+  tables->row_locks= lock;
+  return lock;
+}
+
+
+/* Remove a lock and wake up those who wait for it */
+
+static void _ma_free_lock(MARIA_SHARE *share, MARIA_ROW_LOCK *lock)
+{
+  my_hash_delete(lock->id.type == &share->row_lock_rc ? &share->row_locks :
+                 &share->key_locks, (uchar*) lock);
+  if (lock->wt)
+    wt_thd_release(lock->wt, &lock->id);
+  my_free(lock);
+}
+
+
+/**
+   @brief Lock a row for UPDATE or DELETE
+
+   @param info   Maria handler
+   @param rowid  Row to lock
+
+   @note Waits while another transaction has the row locked. A new lock
+   is remembered in info->last_row_lock, see _ma_unlock_row().
+
+   @return 0  ok
+   @return #  HA_ERR_LOCK_DEADLOCK, HA_ERR_LOCK_WAIT_TIMEOUT or
+              HA_ERR_OUT_OF_MEM
+*/
+
+int _ma_lock_row(MARIA_HA *info, MARIA_RECORD_POS rowid)
+{
+  MARIA_SHARE *share= info->s;
+  MARIA_ROW_LOCK *lock;
+  ulonglong value= rowid;
+  int error= 0;
+  DBUG_ENTER("_ma_lock_row");
+  DBUG_PRINT("enter", ("rowid: %lu", (ulong) rowid));
+
+  info->last_row_lock= 0;
+  mysql_mutex_lock(&share->intern_lock);
+  while ((lock= (MARIA_ROW_LOCK*) my_hash_search(&share->row_locks,
+                                                 (uchar*) &value,
+                                                 sizeof(value))))
+  {
+    if (lock->trn == info->trn)
+      goto end;                                 /* Already locked by us */
+    if ((error= _ma_wait_for_lock(info, lock)))
+      goto end;
+  }
+  if (!(info->last_row_lock= _ma_add_lock(info, &share->row_locks,
+                                          &share->row_lock_rc, value)))
+    error= my_errno= HA_ERR_OUT_OF_MEM;
+end:
+  mysql_mutex_unlock(&share->intern_lock);
+  DBUG_RETURN(error);
+}
+
+
+/**
+   @brief Release the row lock taken by the last read
+
+   @note Only a lock that the last read took is released. Rows that the
+   transaction changed keep their locks until the transaction ends.
+*/
+
+void _ma_unlock_row(MARIA_HA *info)
+{
+  MARIA_SHARE *share= info->s;
+  MARIA_ROW_LOCK *lock, **prev;
+  DBUG_ENTER("_ma_unlock_row");
+
+  if (!(lock= info->last_row_lock))
+    DBUG_VOID_RETURN;
+  info->last_row_lock= 0;
+  mysql_mutex_lock(&share->intern_lock);
+  for (prev= &_ma_get_used_table(info)->row_locks;
+       *prev != lock;
+       prev= &(*prev)->next)
+    ;
+  *prev= lock->next;
+  _ma_free_lock(share, lock);
+  mysql_mutex_unlock(&share->intern_lock);
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+   @brief Lock a unique key value that UPDATE or DELETE removes, or that
+   UPDATE adds
+
+   @param info    Maria handler
+   @param keynr   Unique key
+   @param record  Row with the key value
+
+   @note Values are locked by a hash of the value, so a lock may also
+   delay writers of other values. NULL values are not locked as they are
+   never duplicates.
+
+   @return 0  ok
+   @return #  HA_ERR_OUT_OF_MEM
+*/
+
+int _ma_lock_unique_key(MARIA_HA *info, uint keynr, const uchar *record)
+{
+  MARIA_SHARE *share= info->s;
+  MARIA_ROW_LOCK *lock;
+  HASH_SEARCH_STATE state;
+  ha_checksum hash;
+  ulonglong value;
+  int error= 0;
+  DBUG_ENTER("_ma_lock_unique_key");
+
+  if (_ma_key_hash(info, keynr, record, &hash))
+    DBUG_RETURN(0);
+  value= ((ulonglong) keynr << 32) | hash;
+
+  mysql_mutex_lock(&share->intern_lock);
+  for (lock= (MARIA_ROW_LOCK*) my_hash_first(&share->key_locks,
+                                             (uchar*) &value, sizeof(value),
+                                             &state);
+       lock && lock->trn != info->trn;
+       lock= (MARIA_ROW_LOCK*) my_hash_next(&share->key_locks,
+                                            (uchar*) &value, sizeof(value),
+                                            &state))
+    ;
+  if (!lock &&
+      !_ma_add_lock(info, &share->key_locks, &share->key_lock_rc, value))
+    error= my_errno= HA_ERR_OUT_OF_MEM;
+  mysql_mutex_unlock(&share->intern_lock);
+  DBUG_RETURN(error);
+}
+
+
+/**
+   @brief Wait until no other transaction has a lock on a unique key value
+
+   @param info    Maria handler
+   @param keynr   Unique key
+   @param record  Row with the new key value
+
+   @note keyinfo->root_lock must be write locked. It is released while we
+   wait and is always locked again when we return.
+
+   @return 0  ok
+   @return #  HA_ERR_LOCK_DEADLOCK or HA_ERR_LOCK_WAIT_TIMEOUT
+*/
+
+int _ma_wait_for_unique_key(MARIA_HA *info, uint keynr, const uchar *record)
+{
+  MARIA_SHARE *share= info->s;
+  MARIA_KEYDEF *keyinfo= share->keyinfo + keynr;
+  MARIA_ROW_LOCK *lock;
+  HASH_SEARCH_STATE state;
+  ha_checksum hash;
+  ulonglong value;
+  int error;
+  DBUG_ENTER("_ma_wait_for_unique_key");
+
+  /*
+    Locks are added with root_lock locked, so we can't miss one that is
+    added for this key
+  */
+  if (!share->key_locks.records ||
+      _ma_key_hash(info, keynr, record, &hash))
+    DBUG_RETURN(0);
+  value= ((ulonglong) keynr << 32) | hash;
+
+  mysql_mutex_lock(&share->intern_lock);
+  for (;;)
+  {
+    for (lock= (MARIA_ROW_LOCK*) my_hash_first(&share->key_locks,
+                                               (uchar*) &value,
+                                               sizeof(value), &state);
+         lock && lock->trn == info->trn;
+         lock= (MARIA_ROW_LOCK*) my_hash_next(&share->key_locks,
+                                              (uchar*) &value,
+                                              sizeof(value), &state))
+      ;
+    if (!lock)
+      break;
+    /* Let the owner of the lock change the index while we wait */
+    mysql_rwlock_unlock(&keyinfo->root_lock);
+    error= _ma_wait_for_lock(info, lock);
+    mysql_mutex_unlock(&share->intern_lock);
+    mysql_rwlock_wrlock(&keyinfo->root_lock);
+    if (error)
+      DBUG_RETURN(error);
+    mysql_mutex_lock(&share->intern_lock);
+  }
+  mysql_mutex_unlock(&share->intern_lock);
+  DBUG_RETURN(0);
+}
+
+
+/**
+   @brief Release all row and key locks of a transaction on a table
+
+   @note share->intern_lock must be locked. Called when the transaction
+   ends, see _ma_trnman_end_trans_hook().
+*/
+
+void _ma_release_row_locks(MARIA_SHARE *share, MARIA_USED_TABLES *tables)
+{
+  MARIA_ROW_LOCK *lock, *next;
+  DBUG_ENTER("_ma_release_row_locks");
+  mysql_mutex_assert_owner(&share->intern_lock);
+
+  for (lock= tables->row_locks; lock; lock= next)
+  {
+    next= lock->next;
+    _ma_free_lock(share, lock);
+  }
+  tables->row_locks= 0;
+  DBUG_VOID_RETURN;
+}
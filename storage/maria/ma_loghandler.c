@@ -7711,6 +7711,7 @@ static my_bool translog_sync_files(uint32 min, uint32 max,
     DBUG_ASSERT(file != NULL);
     if (!file->is_sync)
     {
+      DBUG_EXECUTE_IF("translog_slow_sync", my_sleep(2000););
       if (mysql_file_sync(file->handler.file, MYF(MY_WME)))
       {
         rc= 1;
@@ -7864,15 +7865,18 @@ void translog_flush_buffers(TRANSLOG_ADDRESS *lsn,
   @note
 
   - Non group commit logic: Commits made in passes. Thread which started
-  flush first is performing actual flush, other threads sets new goal (LSN)
-  of the next pass (if it is maximum) and waits for the pass end or just
-  wait for the pass end.
+  flush first (the leader) is performing actual flush, other threads
+  (followers) sets new goal (LSN) of the next pass (if it is maximum) and
+  waits for the pass end or just wait for the pass end. Before syncing,
+  the leader sends the buffers up to the goal set by the followers to
+  disk too, so that one sync() covers all of them.
 
   - If hard group commit enabled and rate set to zero:
   The first thread sends all changed buffers to disk. This is repeated
   as long as there are new LSNs added. The process can not loop
   forever because we have limited number of threads and they will wait
-  for the data to be synced.
+  for the data to be synced, and because the number of passes is limited
+  to TRANSLOG_BUFFERS_NO.
   Pseudo code:
 
    do
@@ -7904,6 +7908,7 @@ my_bool translog_flush(TRANSLOG_ADDRESS lsn)
   TRANSLOG_ADDRESS flush_horizon;
   my_bool rc= 0;
   my_bool hgroup_commit_at_start;
+  uint group_passes= 0;
   DBUG_ENTER("translog_flush");
   DBUG_PRINT("enter", ("Flush up to LSN: (%lu,0x%lx)", LSN_IN_PARTS(lsn)));
   DBUG_ASSERT(translog_status == TRANSLOG_OK ||
@@ -7961,19 +7966,25 @@ my_bool translog_flush(TRANSLOG_ADDRESS lsn)
     /* Following function flushes buffers and makes translog_unlock() */
     translog_flush_buffers(&lsn, &sent_to_disk, &flush_horizon);
 
-    if (!hgroup_commit_at_start)
-      break;  /* flush pass is ended */
+    if (!hgroup_commit_at_start || flush_interval == 0)
+    {
+      /*
+        Threads which came while we were sending buffers to disk have set
+        the goal of the next pass and wait for the end of this one.
+        Send their records to disk too, so that they are covered by our
+        sync() instead of each pass doing its own.
+      */
+      mysql_mutex_lock(&log_descriptor.log_flush_lock);
+      if (log_descriptor.next_pass_max_lsn == LSN_IMPOSSIBLE ||
+          ++group_passes > TRANSLOG_BUFFERS_NO)
+      {
+        mysql_mutex_unlock(&log_descriptor.log_flush_lock);
+        break;  /* flush pass is ended */
+      }
+      goto next_goal;
+    }
 
 retest:
-    /*
-      We do not check time here because mysql_mutex_lock rarely takes
-      a lot of time so we can sacrifice a bit precision to performance
-      (taking into account that microsecond_interval_timer() might be
-      expensive call).
-    */
-    if (flush_interval == 0)
-      break;  /* flush pass is ended */
-
     mysql_mutex_lock(&log_descriptor.log_flush_lock);
     if (log_descriptor.next_pass_max_lsn == LSN_IMPOSSIBLE)
     {
@@ -7997,6 +8008,7 @@ my_bool translog_flush(TRANSLOG_ADDRESS lsn)
       goto retest;
     }
 
+next_goal:
     /* take next goal */
     lsn= log_descriptor.next_pass_max_lsn;
     log_descriptor.next_pass_max_lsn= LSN_IMPOSSIBLE;
@@ -163,7 +163,9 @@ static MARIA_HA *maria_clone_internal(MARIA_SHARE *share, const char *name,
   if (my_init_dynamic_array(&info.pinned_pages,
                             sizeof(MARIA_PINNED_PAGE),
                             MY_MAX(share->base.blobs*2 + 4,
-                                MARIA_MAX_TREE_LEVELS*3), 16, MYF(0)))
+                                MARIA_MAX_TREE_LEVELS*3), 16, MYF(0)) ||
+      my_init_dynamic_array(&info.busy_pages, sizeof(pgcache_page_no_t),
+                            4, 4, MYF(0)))
     goto err;
 
 
@@ -235,6 +237,7 @@ static MARIA_HA *maria_clone_internal(MARIA_SHARE *share, const char *name,
   case 6:
     (*share->end)(&info);
     delete_dynamic(&info.pinned_pages);
+    delete_dynamic(&info.busy_pages);
     my_free(m_info);
     /* fall through */
   case 5:
@@ -588,6 +591,8 @@ MARIA_HA *maria_open(const char *name, int mode, uint open_flags)
     errpos= 4;
 
     *share=share_buff;
+    if (internal_table)
+      _ma_init_private_pagecache(share);
     memcpy((char*) share->state.rec_per_key_part,
 	   (char*) rec_per_key_part, sizeof(double)*key_parts);
     memcpy((char*) share->state.nulls_per_key_part,
@@ -610,6 +615,8 @@ MARIA_HA *maria_open(const char *name, int mode, uint open_flags)
     {
       share->keypage_header+= ma_crypt_get_index_page_header_space(share);
     }
+    share->insert_order=
+      MY_TEST(share->base.extra_options & MA_EXTRA_OPTIONS_INSERT_ORDER);
 
     {
       HA_KEYSEG *pos=share->keyparts;
@@ -967,17 +974,29 @@ MARIA_HA *maria_open(const char *name, int mode, uint open_flags)
           share->lock.check_status=  _ma_block_check_status;
           share->lock.start_trans=   _ma_block_start_trans;
           /*
-            We can for the moment only allow multiple concurrent inserts
-            only if there is no auto-increment key.  To lift this restriction
-            we have to:
-            - Extend statement base replication to support auto-increment
-            intervalls.
-            - Fix that we allocate auto-increment in intervals and that
-              it's properly reset if the interval was not used
+            Multiple concurrent inserts are allowed also with an
+            auto-increment key: the inserters reserve disjoint intervals,
+            see _ma_reserve_auto_increment().
           */
-          share->lock.allow_multiple_concurrent_insert=
-            share->base.auto_key == 0;
+          share->lock.allow_multiple_concurrent_insert= 1;
           share->lock_restore_status= 0;
+          /*
+            UPDATE and DELETE may lock rows instead of the table. Not for
+            UNIQUE constraints, as their hash keys are not locked.
+          */
+          share->row_locking= (maria_row_locking && !uniques &&
+                               !maria_in_recovery);
+          share->row_lock_rc.compare= share->key_lock_rc.compare=
+            wt_resource_id_memcmp;
+          share->row_lock_rc.make_key= share->key_lock_rc.make_key= 0;
+          if (share->row_locking &&
+              (my_hash_init(&share->row_locks, &my_charset_bin, 16,
+                            offsetof(MARIA_ROW_LOCK, id.value),
+                            sizeof(ulonglong), 0, 0, HASH_UNIQUE) ||
+               my_hash_init(&share->key_locks, &my_charset_bin, 16,
+                            offsetof(MARIA_ROW_LOCK, id.value),
+                            sizeof(ulonglong), 0, 0, 0)))
+            goto err;
         }
         else
         {
@@ -1061,6 +1080,7 @@ MARIA_HA *maria_open(const char *name, int mode, uint open_flags)
     (*share->once_end)(share);
     /* fall through */
   case 4:
+    _ma_end_private_pagecache(share);
     ma_crypt_free(share);
     my_free(share);
     /* fall through */
@@ -495,6 +495,10 @@ static my_bool info_check_lock(PAGECACHE_BLOCK_LINK *block,
 
 static void free_block(PAGECACHE *pagecache, PAGECACHE_BLOCK_LINK *block);
 static void unlink_hash(PAGECACHE *pagecache, PAGECACHE_HASH_LINK *hash_link);
+static my_bool
+pagecache_collect_changed_blocks_of_segments(PAGECACHE *pagecache,
+                                             LEX_STRING *str,
+                                             LSN *min_rec_lsn);
 #ifndef DBUG_OFF
 static void test_key_cache(PAGECACHE *pagecache,
                            const char *where, my_bool lock);
@@ -504,6 +508,17 @@ static void test_key_cache(PAGECACHE *pagecache,
                                     (size_t) (f).file) & (p->hash_entries-1))
 #define FILE_HASH(f,cache) ((uint) (f).file & (cache->changed_blocks_hash_size-1))
 
+/*
+  The segment of a segmented page cache where a page is cached.
+  Consecutive pages of a file are spread over all segments.
+*/
+#define PAGECACHE_SEGMENT(p, f, pos)                                          \
+  ((p)->segment_array +                                                       \
+   (((size_t) (pos) + (size_t) (f)->file) % (p)->segments))
+/* The segment of the page of a block that is pinned or locked */
+#define PAGECACHE_BLOCK_SEGMENT(p, b)                                         \
+  PAGECACHE_SEGMENT(p, &(b)->hash_link->file, (b)->hash_link->pageno)
+
 #define DEFAULT_PAGECACHE_DEBUG_LOG  "pagecache_debug.log"
 
 #if defined(PAGECACHE_DEBUG) && ! defined(PAGECACHE_DEBUG_LOG)
@@ -916,6 +931,97 @@ size_t init_pagecache(PAGECACHE *pagecache, size_t use_mem,
 }
 
 
+/*
+  Initialize a segmented page cache
+
+  SYNOPSIS
+    init_segmented_pagecache()
+    pagecache			pointer to a page cache data structure
+    use_mem                     total memory to use for all segments
+    division_limit		division limit (may be zero)
+    age_threshold		age threshold (may be zero)
+    block_size                  size of block (should be power of 2)
+    changed_blocks_hash_size    number of hash buckets for files, per segment
+    segments                    number of segments
+    my_read_flags		Flags used for all pread/pwrite calls
+
+  RETURN VALUE
+    number of blocks in all segments, if successful,
+    0 - otherwise.
+
+  NOTES.
+    Each segment is a simple page cache with its own cache_lock, hash,
+    LRU chain and dirty lists, so that threads that access pages in
+    different segments do not wait for each other. With segments <= 1
+    this is the same as init_pagecache().
+*/
+
+size_t init_segmented_pagecache(PAGECACHE *pagecache, size_t use_mem,
+                                uint division_limit, uint age_threshold,
+                                uint block_size,
+                                uint changed_blocks_hash_size,
+                                uint segments, myf my_readwrite_flags)
+{
+  size_t blocks= 0;
+  uint i;
+  DBUG_ENTER("init_segmented_pagecache");
+  DBUG_PRINT("enter", ("segments: %u", segments));
+
+  if (segments <= 1)
+    DBUG_RETURN(init_pagecache(pagecache, use_mem, division_limit,
+                               age_threshold, block_size,
+                               changed_blocks_hash_size,
+                               my_readwrite_flags));
+  if (pagecache->inited && pagecache->disk_blocks > 0)
+  {
+    DBUG_PRINT("warning",("key cache already in use"));
+    DBUG_RETURN(0);
+  }
+  set_if_smaller(segments, MAX_PAGECACHE_SEGMENTS);
+
+  if (!(pagecache->segment_array= (PAGECACHE*)
+        my_malloc(sizeof(PAGECACHE) * segments, MYF(MY_WME | MY_ZEROFILL))))
+    DBUG_RETURN(0);
+
+  for (i= 0; i < segments; i++)
+  {
+    size_t segment_blocks;
+    if (!(segment_blocks= init_pagecache(pagecache->segment_array + i,
+                                         use_mem / segments, division_limit,
+                                         age_threshold, block_size,
+                                         changed_blocks_hash_size,
+                                         my_readwrite_flags)))
+    {
+      while (i-- > 0)
+        end_pagecache(pagecache->segment_array + i, TRUE);
+      my_free(pagecache->segment_array);
+      pagecache->segment_array= NULL;
+      DBUG_RETURN(0);
+    }
+    blocks+= segment_blocks;
+  }
+
+  pagecache->segments= segments;
+  pagecache->mem_size= use_mem;
+  pagecache->block_size= block_size;
+  pagecache->shift= my_bit_log2(block_size);
+  pagecache->readwrite_flags= pagecache->segment_array->readwrite_flags;
+  pagecache->org_readwrite_flags= pagecache->readwrite_flags;
+  pagecache->changed_blocks_hash_size=
+    pagecache->segment_array->changed_blocks_hash_size;
+  pagecache->disk_blocks= pagecache->blocks= blocks;
+  pagecache->blocks_unused= blocks;
+  pagecache->blocks_used= pagecache->blocks_changed= 0;
+  pagecache->global_blocks_changed= 0;
+  pagecache->global_cache_w_requests= pagecache->global_cache_r_requests= 0;
+  pagecache->global_cache_read= pagecache->global_cache_write= 0;
+  pagecache->inited= 1;
+  pagecache->in_init= 0;
+  pagecache->can_be_used= 1;
+  DBUG_RETURN(blocks);
+}
+
+
 /*
   Flush all blocks in the key cache to disk
 */
@@ -1105,6 +1211,15 @@ void change_pagecache_param(PAGECACHE *pagecache, uint division_limit,
 {
   DBUG_ENTER("change_pagecache_param");
 
+  if (pagecache->segments)
+  {
+    uint i;
+    for (i= 0; i < pagecache->segments; i++)
+      change_pagecache_param(pagecache->segment_array + i, division_limit,
+                             age_threshold);
+    DBUG_VOID_RETURN;
+  }
+
   pagecache_pthread_mutex_lock(&pagecache->cache_lock);
   if (division_limit)
     pagecache->min_warm_blocks= (pagecache->disk_blocks *
@@ -1168,6 +1283,23 @@ void end_pagecache(PAGECACHE *pagecache, my_bool cleanup)
   if (!pagecache->inited)
     DBUG_VOID_RETURN;
 
+  if (pagecache->segments)
+  {
+    uint i;
+    for (i= 0; i < pagecache->segments; i++)
+      end_pagecache(pagecache->segment_array + i, cleanup);
+    pagecache->disk_blocks= -1;
+    pagecache->blocks_changed= 0;
+    if (cleanup)
+    {
+      my_free(pagecache->segment_array);
+      pagecache->segment_array= NULL;
+      pagecache->segments= 0;
+      pagecache->inited= pagecache->can_be_used= 0;
+    }
+    DBUG_VOID_RETURN;
+  }
+
   if (pagecache->disk_blocks > 0)
   {
 #ifndef DBUG_OFF
@@ -2841,6 +2973,12 @@ void pagecache_unlock(PAGECACHE *pagecache,
   PAGECACHE_BLOCK_LINK *block;
   int page_st;
   DBUG_ENTER("pagecache_unlock");
+  if (pagecache->segments)
+  {
+    pagecache_unlock(PAGECACHE_SEGMENT(pagecache, file, pageno), file, pageno,
+                     lock, pin, first_REDO_LSN_for_page, lsn, was_changed);
+    DBUG_VOID_RETURN;
+  }
   DBUG_PRINT("enter", ("fd: %u  page: %lu  %s  %s",
                        (uint) file->file, (ulong) pageno,
                        page_cache_page_lock_str[lock],
@@ -2936,6 +3074,12 @@ void pagecache_unpin(PAGECACHE *pagecache,
   PAGECACHE_BLOCK_LINK *block;
   int page_st;
   DBUG_ENTER("pagecache_unpin");
+  if (pagecache->segments)
+  {
+    pagecache_unpin(PAGECACHE_SEGMENT(pagecache, file, pageno), file, pageno,
+                    lsn);
+    DBUG_VOID_RETURN;
+  }
   DBUG_PRINT("enter", ("fd: %u  page: %lu",
                        (uint) file->file, (ulong) pageno));
   pagecache_pthread_mutex_lock(&pagecache->cache_lock);
@@ -3013,6 +3157,13 @@ void pagecache_unlock_by_link(PAGECACHE *pagecache,
                               my_bool any)
 {
   DBUG_ENTER("pagecache_unlock_by_link");
+  if (pagecache->segments)
+  {
+    pagecache_unlock_by_link(PAGECACHE_BLOCK_SEGMENT(pagecache, block), block,
+                             lock, pin, first_REDO_LSN_for_page, lsn,
+                             was_changed, any);
+    DBUG_VOID_RETURN;
+  }
   DBUG_PRINT("enter", ("block: 0x%lx  fd: %u  page: %lu  changed: %d  %s  %s",
                        (ulong) block,
                        (uint) block->hash_link->file.file,
@@ -3126,6 +3277,12 @@ void pagecache_unpin_by_link(PAGECACHE *pagecache,
                              LSN lsn)
 {
   DBUG_ENTER("pagecache_unpin_by_link");
+  if (pagecache->segments)
+  {
+    pagecache_unpin_by_link(PAGECACHE_BLOCK_SEGMENT(pagecache, block), block,
+                            lsn);
+    DBUG_VOID_RETURN;
+  }
   DBUG_PRINT("enter", ("block: 0x%lx  fd: %u page: %lu",
                        (ulong) block,
                        (uint) block->hash_link->file.file,
@@ -3365,6 +3522,11 @@ uchar *pagecache_read(PAGECACHE *pagecache,
   DBUG_ASSERT(pageno < ((1ULL) << 40));
 #endif
 
+  if (pagecache->segments)
+    DBUG_RETURN(pagecache_read(PAGECACHE_SEGMENT(pagecache, file, pageno),
+                               file, pageno, level, buff, type, lock,
+                               page_link));
+
   if (!page_link)
     page_link= &fake_link;
   *page_link= 0;                                 /* Catch errors */
@@ -3689,6 +3851,10 @@ my_bool pagecache_delete_by_link(PAGECACHE *pagecache,
   my_bool error= 0;
   enum pagecache_page_pin pin= PAGECACHE_PIN_LEFT_PINNED;
   DBUG_ENTER("pagecache_delete_by_link");
+  if (pagecache->segments)
+    DBUG_RETURN(pagecache_delete_by_link(PAGECACHE_BLOCK_SEGMENT(pagecache,
+                                                                 block),
+                                         block, lock, flush));
   DBUG_PRINT("enter", ("fd: %d block 0x%lx  %s  %s",
                        block->hash_link->file.file,
                        (ulong) block,
@@ -3802,6 +3968,9 @@ my_bool pagecache_delete(PAGECACHE *pagecache,
   my_bool error= 0;
   enum pagecache_page_pin pin= lock_to_pin_one_phase[lock];
   DBUG_ENTER("pagecache_delete");
+  if (pagecache->segments)
+    DBUG_RETURN(pagecache_delete(PAGECACHE_SEGMENT(pagecache, file, pageno),
+                                 file, pageno, lock, flush));
   DBUG_PRINT("enter", ("fd: %u  page: %lu  %s  %s",
                        (uint) file->file, (ulong) pageno,
                        page_cache_page_lock_str[lock],
@@ -3995,6 +4164,13 @@ my_bool pagecache_write_part(PAGECACHE *pagecache,
   DBUG_ASSERT(pageno < ((1ULL) << 40));
 #endif
 
+  if (pagecache->segments)
+    DBUG_RETURN(pagecache_write_part(PAGECACHE_SEGMENT(pagecache, file,
+                                                       pageno),
+                                     file, pageno, level, buff, type, lock,
+                                     pin, write_mode, page_link,
+                                     first_REDO_LSN_for_page, offset, size));
+
   if (!page_link)
     page_link= &fake_link;
   *page_link= 0;
@@ -4805,6 +4981,16 @@ int flush_pagecache_blocks_with_filter(PAGECACHE *pagecache,
 
   if (pagecache->disk_blocks <= 0)
     DBUG_RETURN(0);
+  if (pagecache->segments)
+  {
+    uint i;
+    res= PCFLUSH_OK;
+    for (i= 0; i < pagecache->segments; i++)
+      res|= flush_pagecache_blocks_with_filter(pagecache->segment_array + i,
+                                               file, type, filter,
+                                               filter_arg);
+    DBUG_RETURN(res);
+  }
   pagecache_pthread_mutex_lock(&pagecache->cache_lock);
   inc_counter_for_resize_op(pagecache);
   res= flush_pagecache_blocks_int(pagecache, file, type, filter, filter_arg);
@@ -4841,6 +5027,12 @@ int reset_pagecache_counters(const char *name __attribute__((unused)),
   }
   DBUG_PRINT("info", ("Resetting counters for key cache %s.", name));
 
+  if (pagecache->segments)
+  {
+    uint i;
+    for (i= 0; i < pagecache->segments; i++)
+      reset_pagecache_counters(name, pagecache->segment_array + i);
+  }
   pagecache->global_blocks_changed= 0;   /* Key_blocks_not_flushed */
   pagecache->global_cache_r_requests= 0; /* Key_read_requests */
   pagecache->global_cache_read= 0;       /* Key_reads */
@@ -4850,6 +5042,67 @@ int reset_pagecache_counters(const char *name __attribute__((unused)),
 }
 
 
+/**
+  @brief Sums up the statistics of the segments of a segmented page cache
+
+  Updates the statistics variables of the segmented page cache from those
+  of its segments. The statistics of a simple page cache are always up
+  to date.
+
+  @param pagecache       pointer to the page cache
+*/
+
+void pagecache_collect_stats(PAGECACHE *pagecache)
+{
+  uint i;
+  size_t blocks_used= 0, blocks_unused= 0, blocks_changed= 0;
+  ulonglong cache_w_requests= 0, cache_write= 0;
+  ulonglong cache_r_requests= 0, cache_read= 0;
+
+  /*
+    The counters of the segments are read without their locks, like
+    a simple page cache's own counters are read by SHOW STATUS.
+  */
+  for (i= 0; i < pagecache->segments; i++)
+  {
+    PAGECACHE *segment= pagecache->segment_array + i;
+    blocks_used+= segment->blocks_used;
+    blocks_unused+= segment->blocks_unused;
+    blocks_changed+= segment->global_blocks_changed;
+    cache_w_requests+= segment->global_cache_w_requests;
+    cache_write+= segment->global_cache_write;
+    cache_r_requests+= segment->global_cache_r_requests;
+    cache_read+= segment->global_cache_read;
+  }
+  if (pagecache->segments)
+  {
+    pagecache->blocks_used= blocks_used;
+    pagecache->blocks_unused= blocks_unused;
+    pagecache->global_blocks_changed= blocks_changed;
+    pagecache->global_cache_w_requests= cache_w_requests;
+    pagecache->global_cache_write= cache_write;
+    pagecache->global_cache_r_requests= cache_r_requests;
+    pagecache->global_cache_read= cache_read;
+  }
+}
+
+
+/**
+  @brief Sets the flags of the reads and writes of a page cache
+
+  @param pagecache       pointer to the page cache
+  @param flags           flags for pread/pwrite()
+*/
+
+void pagecache_set_readwrite_flags(PAGECACHE *pagecache, myf flags)
+{
+  uint i;
+  pagecache->readwrite_flags= flags;
+  for (i= 0; i < pagecache->segments; i++)
+    pagecache->segment_array[i].readwrite_flags= flags;
+}
+
+
 /**
    @brief Allocates a buffer and stores in it some info about all dirty pages
 
@@ -4882,6 +5135,9 @@ my_bool pagecache_collect_changed_blocks_with_lsn(PAGECACHE *pagecache,
   DBUG_ENTER("pagecache_collect_changed_blocks_with_LSN");
 
   DBUG_ASSERT(NULL == str->str);
+  if (pagecache->segments)
+    DBUG_RETURN(pagecache_collect_changed_blocks_of_segments(pagecache, str,
+                                                             min_rec_lsn));
   /*
     We lock the entire cache but will be quick, just reading/writing a few MBs
     of memory at most.
@@ -5003,6 +5259,77 @@ my_bool pagecache_collect_changed_blocks_with_lsn(PAGECACHE *pagecache,
 }
 
 
+/**
+   @brief Collects the dirty pages of all segments of a segmented page cache
+
+   Does the same as pagecache_collect_changed_blocks_with_lsn() for each
+   segment, and concatenates the lists. The segments are locked one at a
+   time.
+
+   @param       pagecache   pointer to the segmented page cache
+   @param[out]  str         pointer to where the allocated buffer, and
+                            its size, will be put
+   @param[out]  min_rec_lsn pointer to where the minimum rec_lsn of all
+                            relevant dirty pages will be put
+   @return Operation status
+     @retval 0      OK
+     @retval 1      Error
+*/
+
+static my_bool
+pagecache_collect_changed_blocks_of_segments(PAGECACHE *pagecache,
+                                             LEX_STRING *str,
+                                             LSN *min_rec_lsn)
+{
+  LEX_STRING segment_str[MAX_PAGECACHE_SEGMENTS];
+  LSN minimum_rec_lsn= LSN_MAX;
+  ulonglong stored_list_size= 0;
+  size_t length= 8;
+  my_bool error= 0;
+  uint i;
+  char *ptr;
+  DBUG_ENTER("pagecache_collect_changed_blocks_of_segments");
+
+  bzero(segment_str, sizeof(segment_str));
+  for (i= 0; i < pagecache->segments; i++)
+  {
+    LSN segment_min_rec_lsn;
+    if (pagecache_collect_changed_blocks_with_lsn(pagecache->segment_array + i,
+                                                  segment_str + i,
+                                                  &segment_min_rec_lsn))
+    {
+      error= 1;
+      goto end;
+    }
+    stored_list_size+= uint8korr(segment_str[i].str);
+    length+= segment_str[i].length - 8;
+    if (cmp_translog_addr(segment_min_rec_lsn, minimum_rec_lsn) < 0)
+      minimum_rec_lsn= segment_min_rec_lsn;
+  }
+
+  if (NULL == (str->str= my_malloc(length, MYF(MY_WME))))
+  {
+    error= 1;
+    goto end;
+  }
+  str->length= length;
+  ptr= str->str;
+  int8store(ptr, stored_list_size);
+  ptr+= 8;
+  for (i= 0; i < pagecache->segments; i++)
+  {
+    memcpy(ptr, segment_str[i].str + 8, segment_str[i].length - 8);
+    ptr+= segment_str[i].length - 8;
+  }
+  *min_rec_lsn= minimum_rec_lsn;
+
+end:
+  for (i= 0; i < pagecache->segments; i++)
+    my_free(segment_str[i].str);
+  DBUG_RETURN(error);
+}
+
+
 #ifndef DBUG_OFF
 
 /**
@@ -5013,6 +5340,13 @@ void pagecache_file_no_dirty_page(PAGECACHE *pagecache, PAGECACHE_FILE *file)
 {
   File fd= file->file;
   PAGECACHE_BLOCK_LINK *block;
+  if (pagecache->segments)
+  {
+    uint i;
+    for (i= 0; i < pagecache->segments; i++)
+      pagecache_file_no_dirty_page(pagecache->segment_array + i, file);
+    return;
+  }
   for (block= pagecache->changed_blocks[FILE_HASH(*file, pagecache)];
        block != NULL;
        block= block->next_changed)
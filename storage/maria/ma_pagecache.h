@@ -123,6 +123,9 @@ typedef struct st_pagecache_hash_link PAGECACHE_HASH_LINK;
 #define PAGECACHE_PRIORITY_DEFAULT 3
 #define PAGECACHE_PRIORITY_HIGH 6
 
+/* Maximum number of segments of a segmented page cache */
+#define MAX_PAGECACHE_SEGMENTS 64
+
 /*
   The page cache structure
   It also contains read-only statistics parameters.
@@ -190,6 +193,15 @@ typedef struct st_pagecache
   my_bool in_init;		/* Set to 1 in MySQL during init/resize     */
   my_bool extra_debug;	        /* set to 1 if one wants extra logging */
   HASH    files_in_flush;       /**< files in flush_pagecache_blocks_int() */
+  /*
+    A segmented page cache consists of 'segments' independent page caches,
+    each with its own lock, hash, LRU and dirty lists. A page is always
+    cached in the segment chosen by its file and page number. The
+    segmented cache itself only holds the parameters and the statistics
+    collected by pagecache_collect_stats(). 0 for a simple page cache.
+  */
+  uint    segments;
+  struct st_pagecache *segment_array; /* the segments of the cache          */
 } PAGECACHE;
 
 /** @brief Return values for PAGECACHE_FLUSH_FILTER */
@@ -212,6 +224,11 @@ extern size_t init_pagecache(PAGECACHE *pagecache, size_t use_mem,
                             uint division_limit, uint age_threshold,
                             uint block_size, uint changed_blocks_hash_size,
                             myf my_read_flags);
+extern size_t init_segmented_pagecache(PAGECACHE *pagecache, size_t use_mem,
+                                       uint division_limit, uint age_threshold,
+                                       uint block_size,
+                                       uint changed_blocks_hash_size,
+                                       uint segments, myf my_read_flags);
 extern size_t resize_pagecache(PAGECACHE *pagecache,
                               size_t use_mem, uint division_limit,
                               uint age_threshold, uint changed_blocks_hash_size);
@@ -312,6 +329,8 @@ extern my_bool pagecache_collect_changed_blocks_with_lsn(PAGECACHE *pagecache,
                                                          LEX_STRING *str,
                                                          LSN *min_lsn);
 extern int reset_pagecache_counters(const char *name, PAGECACHE *pagecache);
+extern void pagecache_collect_stats(PAGECACHE *pagecache);
+extern void pagecache_set_readwrite_flags(PAGECACHE *pagecache, myf flags);
 extern uchar *pagecache_block_link_to_buffer(PAGECACHE_BLOCK_LINK *block);
 
 extern uint pagecache_pagelevel(PAGECACHE_BLOCK_LINK *block);
@@ -102,3 +102,107 @@ void multi_pagecache_change(PAGECACHE *old_data,
 {
   safe_hash_change(&pagecache_hash, (uchar*) old_data, (uchar*) new_data);
 }
+
+
+/*****************************************************************************
+  Private page caches of internal temporary tables
+*****************************************************************************/
+
+/*
+  Give an internal temporary table a page cache of its own
+
+  SYNOPSIS
+    _ma_init_private_pagecache()
+    share			Share of the table being opened
+
+  NOTES
+    Internal temporary tables are only used by the thread that created
+    them and their pages are never logged, synced or flushed by
+    checkpoint. Keeping them in a small cache of their own avoids that
+    they take cache_lock of the shared page cache and evict the pages
+    of the real tables from it.
+    If maria_tmp_table_pagecache_size is too small for the block size or
+    the cache can't be allocated, the table uses the shared page cache.
+*/
+
+void _ma_init_private_pagecache(MARIA_SHARE *share)
+{
+  PAGECACHE *pagecache;
+  uint block_size= share->base.block_size;
+  DBUG_ENTER("_ma_init_private_pagecache");
+
+  if (maria_tmp_table_pagecache_size <
+      (ulonglong) block_size * MARIA_MIN_PRIVATE_PAGECACHE_BLOCKS)
+    DBUG_VOID_RETURN;
+  if (!(pagecache= (PAGECACHE*) my_malloc(sizeof(*pagecache),
+                                          MYF(MY_ZEROFILL))))
+    DBUG_VOID_RETURN;
+  if (!init_pagecache(pagecache, (size_t) maria_tmp_table_pagecache_size,
+                      0, 0, block_size, 0, MYF(0)))
+  {
+    end_pagecache(pagecache, 1);
+    my_free(pagecache);
+    DBUG_VOID_RETURN;
+  }
+  share->pagecache= share->private_pagecache= pagecache;
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Free the private page cache of an internal temporary table
+
+  All pages of the table must have been flushed or dropped from it.
+*/
+
+void _ma_end_private_pagecache(MARIA_SHARE *share)
+{
+  DBUG_ENTER("_ma_end_private_pagecache");
+  if (share->private_pagecache)
+  {
+    end_pagecache(share->private_pagecache, 1);
+    my_free(share->private_pagecache);
+    share->pagecache= share->private_pagecache= 0;
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Write out the dirty pages of a private page cache in one sweep
+
+  SYNOPSIS
+    _ma_flush_private_pagecache()
+    info			Table that was just changed
+
+  NOTES
+    Without this, every page read into a full cache would first write
+    the dirty page it evicts. Once half of the blocks are dirty, all
+    dirty pages of the data and index files are written in file order
+    instead, and the blocks are kept for later reads.
+
+  RETURN
+    0  ok
+    1  error (table is marked crashed)
+*/
+
+int _ma_flush_private_pagecache(MARIA_HA *info)
+{
+  MARIA_SHARE *share= info->s;
+  PAGECACHE *pagecache= share->private_pagecache;
+  int error= 0;
+  DBUG_ENTER("_ma_flush_private_pagecache");
+
+  if (pagecache->blocks_changed < (size_t) (pagecache->blocks / 2))
+    DBUG_RETURN(0);
+  if (share->data_file_type == BLOCK_RECORD &&
+      (flush_pagecache_blocks(pagecache, &info->dfile, FLUSH_KEEP) &
+       PCFLUSH_ERROR))
+    error= 1;
+  if (flush_pagecache_blocks(pagecache, &share->kfile, FLUSH_KEEP) &
+      PCFLUSH_ERROR)
+    error= 1;
+  if (error)
+    _ma_set_fatal_error(share, HA_ERR_CRASHED);
+  DBUG_RETURN(error);
+}
@@ -28,6 +28,7 @@
 #include "trnman.h"
 #include "ma_key_recover.h"
 #include "ma_recovery_util.h"
+#include "ma_servicethread.h"
 #include "hash.h"
 #include <my_check_opt.h>
 
@@ -39,16 +40,16 @@ struct st_trn_for_recovery /* used only in the REDO phase */
 struct st_table_for_recovery /* used in the REDO and UNDO phase */
 {
   MARIA_HA *info;
+  uint redo_batch_table; /**< 1 + index in redo_batch.tables, or 0 */
 };
-/* Variables used by all functions of this module. Ok as single-threaded */
+/*
+  Variables used by all functions of this module. Ok as single-threaded;
+  the records of a REDO phase batch only use the variables of their table
+  and their REDO_THREAD.
+*/
 static struct st_trn_for_recovery *all_active_trans;
 static struct st_table_for_recovery *all_tables;
 static struct st_dirty_page *dirty_pages_pool;
-static LSN current_group_end_lsn;
-#ifndef DBUG_OFF
-/** Current group of REDOs is about this table and only this one */
-static MARIA_HA *current_group_table;
-#endif
 static TrID max_long_trid= 0; /**< max long trid seen by REDO phase */
 static my_bool skip_DDLs; /**< if REDO phase should skip DDL records */
 /** @brief to avoid writing a checkpoint if recovery did nothing. */
@@ -134,12 +135,13 @@ static int new_table(uint16 sid, const char *name, LSN lsn_of_file_id);
 static int new_page(uint32 fileid, pgcache_page_no_t pageid, LSN rec_lsn,
                     struct st_dirty_page *dirty_page);
 static int close_all_tables(void);
+static my_bool flush_all_tables_in_parallel(void);
 static my_bool close_one_table(const char *name, TRANSLOG_ADDRESS addr);
 static void print_redo_phase_progress(TRANSLOG_ADDRESS addr);
 static void delete_all_transactions();
 
 /** @brief global [out] buffer for translog_read_record(); never shrinks */
-static struct
+static struct st_log_record_buffer
 {
   /*
     uchar* is more adapted (less casts) than char*, thus we don't use
@@ -148,16 +150,80 @@ static struct
   uchar *str;
   size_t length;
 } log_record_buffer;
-static void enlarge_buffer(const TRANSLOG_HEADER_BUFFER *rec)
+static void enlarge_record_buffer(struct st_log_record_buffer *buffer,
+                                  const TRANSLOG_HEADER_BUFFER *rec)
 {
-  if (log_record_buffer.length < rec->record_length)
+  if (buffer->length < rec->record_length)
   {
-    log_record_buffer.length= rec->record_length;
-    log_record_buffer.str= my_realloc(log_record_buffer.str,
-                                      rec->record_length,
-                                      MYF(MY_WME | MY_ALLOW_ZERO_PTR));
+    buffer->length= rec->record_length;
+    buffer->str= my_realloc(buffer->str, rec->record_length,
+                            MYF(MY_WME | MY_ALLOW_ZERO_PTR));
   }
 }
+static void enlarge_buffer(const TRANSLOG_HEADER_BUFFER *rec)
+{
+  enlarge_record_buffer(&log_record_buffer, rec);
+}
+
+/**
+  @brief What a thread executing records in the REDO phase needs for itself
+
+  The REDO phase thread uses main_redo_thread. The threads which execute
+  the records of a batch (see apply_redo_record()) have their own.
+*/
+typedef struct st_redo_thread
+{
+  struct st_log_record_buffer *buffer; /**< for translog_read_record() */
+  LSN group_end_lsn; /**< LSN of the record which ends the current group */
+#ifndef DBUG_OFF
+  /** Current group of REDOs is about this table and only this one */
+  MARIA_HA *group_table;
+#endif
+} REDO_THREAD;
+static REDO_THREAD main_redo_thread;
+
+/** A record of a REDO phase batch */
+typedef struct st_redo_batch_record
+{
+  TRANSLOG_HEADER_BUFFER rec;
+  LSN group_end_lsn;
+  uint next; /**< next record of the same table, or REDO_BATCH_END */
+} REDO_BATCH_RECORD;
+
+/** The records of one table in a REDO phase batch */
+typedef struct st_redo_batch_table
+{
+  uint first, last;
+  uint16 sid;
+} REDO_BATCH_TABLE;
+
+#define REDO_BATCH_END      UINT_MAX
+/** Records collected before a batch is executed */
+#define REDO_BATCH_RECORDS  1024
+
+/**
+  @brief Records of the REDO phase which are executed by several threads,
+  those of one table in log order by one thread
+*/
+static struct st_redo_batch
+{
+  uint threads; /**< 0 or 1 if all records are executed by one thread */
+  DYNAMIC_ARRAY records, tables;
+  pthread_key(REDO_THREAD*, thread_key);
+} redo_batch;
+
+/** Number of threads which execute REDO records of different tables */
+ulong maria_recovery_threads= 1;
+
+static REDO_THREAD *redo_thread(void)
+{
+  REDO_THREAD *thread;
+  if (redo_batch.threads > 1 &&
+      (thread= my_pthread_getspecific_ptr(REDO_THREAD*,
+                                          redo_batch.thread_key)))
+    return thread;
+  return &main_redo_thread;
+}
 /** @brief Tells what kind of progress message was printed to the error log */
 static enum recovery_message_type
 {
@@ -1505,6 +1571,7 @@ static int new_table(uint16 sid, const char *name, LSN lsn_of_file_id)
 prototype_redo_exec_hook(REDO_INSERT_ROW_HEAD)
 {
   int error= 1;
+  REDO_THREAD *thread= redo_thread();
   uchar *buff= NULL;
   MARIA_HA *info= get_MARIA_HA_from_REDO_record(rec);
   if (info == NULL || maria_is_crashed(info))
@@ -1529,23 +1596,23 @@ prototype_redo_exec_hook(REDO_INSERT_ROW_HEAD)
     LSN"). But in a test scenario where we do updates at runtime, then remove
     tables, apply the log and check that this results in the same table as at
     runtime, putting the same LSN as runtime had done will decrease
-    differences. So we use the UNDO's LSN which is current_group_end_lsn.
+    differences. So we use the UNDO's LSN which ends the group.
   */
-  enlarge_buffer(rec);
-  if (log_record_buffer.str == NULL)
+  enlarge_record_buffer(thread->buffer, rec);
+  if (thread->buffer->str == NULL)
   {
     eprint(tracef, "Failed to read allocate buffer for record");
     goto end;
   }
   if (translog_read_record(rec->lsn, 0, rec->record_length,
-                           log_record_buffer.str, NULL) !=
+                           thread->buffer->str, NULL) !=
       rec->record_length)
   {
     eprint(tracef, "Failed to read record");
     goto end;
   }
-  buff= log_record_buffer.str;
-  if (_ma_apply_redo_insert_row_head_or_tail(info, current_group_end_lsn,
+  buff= thread->buffer->str;
+  if (_ma_apply_redo_insert_row_head_or_tail(info, thread->group_end_lsn,
                                              HEAD_PAGE,
                                              (rec->type ==
                                               LOGREC_REDO_NEW_ROW_HEAD),
@@ -1572,21 +1639,22 @@ prototype_redo_exec_hook(REDO_INSERT_ROW_HEAD)
 prototype_redo_exec_hook(REDO_INSERT_ROW_TAIL)
 {
   int error= 1;
+  REDO_THREAD *thread= redo_thread();
   uchar *buff;
   MARIA_HA *info= get_MARIA_HA_from_REDO_record(rec);
   if (info == NULL || maria_is_crashed(info))
     return 0;
-  enlarge_buffer(rec);
-  if (log_record_buffer.str == NULL ||
+  enlarge_record_buffer(thread->buffer, rec);
+  if (thread->buffer->str == NULL ||
       translog_read_record(rec->lsn, 0, rec->record_length,
-                           log_record_buffer.str, NULL) !=
+                           thread->buffer->str, NULL) !=
        rec->record_length)
   {
     eprint(tracef, "Failed to read record");
     goto end;
   }
-  buff= log_record_buffer.str;
-  if (_ma_apply_redo_insert_row_head_or_tail(info, current_group_end_lsn,
+  buff= thread->buffer->str;
+  if (_ma_apply_redo_insert_row_head_or_tail(info, thread->group_end_lsn,
                                              TAIL_PAGE,
                                              (rec->type ==
                                               LOGREC_REDO_NEW_ROW_TAIL),
@@ -1610,6 +1678,7 @@ prototype_redo_exec_hook(REDO_INSERT_ROW_TAIL)
 prototype_redo_exec_hook(REDO_INSERT_ROW_BLOBS)
 {
   int error= 1;
+  REDO_THREAD *thread= redo_thread();
   uchar *buff;
   uint number_of_blobs, number_of_ranges;
   pgcache_page_no_t first_page, last_page;
@@ -1617,17 +1686,17 @@ prototype_redo_exec_hook(REDO_INSERT_ROW_BLOBS)
   MARIA_HA *info= get_MARIA_HA_from_REDO_record(rec);
   if (info == NULL  || maria_is_crashed(info))
     return 0;
-  enlarge_buffer(rec);
-  if (log_record_buffer.str == NULL ||
+  enlarge_record_buffer(thread->buffer, rec);
+  if (thread->buffer->str == NULL ||
       translog_read_record(rec->lsn, 0, rec->record_length,
-                           log_record_buffer.str, NULL) !=
+                           thread->buffer->str, NULL) !=
        rec->record_length)
   {
     eprint(tracef, "Failed to read record");
     goto end;
   }
-  buff= log_record_buffer.str;
-  if (_ma_apply_redo_insert_row_blobs(info, current_group_end_lsn,
+  buff= thread->buffer->str;
+  if (_ma_apply_redo_insert_row_blobs(info, thread->group_end_lsn,
                                       buff, rec->lsn, &number_of_blobs,
                                       &number_of_ranges,
                                       &first_page, &last_page))
@@ -1648,10 +1717,11 @@ prototype_redo_exec_hook(REDO_INSERT_ROW_BLOBS)
 prototype_redo_exec_hook(REDO_PURGE_ROW_HEAD)
 {
   int error= 1;
+  REDO_THREAD *thread= redo_thread();
   MARIA_HA *info= get_MARIA_HA_from_REDO_record(rec);
   if (info == NULL || maria_is_crashed(info))
     return 0;
-  if (_ma_apply_redo_purge_row_head_or_tail(info, current_group_end_lsn,
+  if (_ma_apply_redo_purge_row_head_or_tail(info, thread->group_end_lsn,
                                             HEAD_PAGE,
                                             rec->header + FILEID_STORE_SIZE))
     goto end;
@@ -1664,10 +1734,11 @@ prototype_redo_exec_hook(REDO_PURGE_ROW_HEAD)
 prototype_redo_exec_hook(REDO_PURGE_ROW_TAIL)
 {
   int error= 1;
+  REDO_THREAD *thread= redo_thread();
   MARIA_HA *info= get_MARIA_HA_from_REDO_record(rec);
   if (info == NULL || maria_is_crashed(info))
     return 0;
-  if (_ma_apply_redo_purge_row_head_or_tail(info, current_group_end_lsn,
+  if (_ma_apply_redo_purge_row_head_or_tail(info, thread->group_end_lsn,
                                             TAIL_PAGE,
                                             rec->header + FILEID_STORE_SIZE))
     goto end;
@@ -1680,23 +1751,24 @@ prototype_redo_exec_hook(REDO_PURGE_ROW_TAIL)
 prototype_redo_exec_hook(REDO_FREE_BLOCKS)
 {
   int error= 1;
+  REDO_THREAD *thread= redo_thread();
   uchar *buff;
   MARIA_HA *info= get_MARIA_HA_from_REDO_record(rec);
   if (info == NULL || maria_is_crashed(info))
     return 0;
-  enlarge_buffer(rec);
+  enlarge_record_buffer(thread->buffer, rec);
 
-  if (log_record_buffer.str == NULL ||
+  if (thread->buffer->str == NULL ||
       translog_read_record(rec->lsn, 0, rec->record_length,
-                           log_record_buffer.str, NULL) !=
+                           thread->buffer->str, NULL) !=
        rec->record_length)
   {
     eprint(tracef, "Failed to read record");
     goto end;
   }
 
-  buff= log_record_buffer.str;
-  if (_ma_apply_redo_free_blocks(info, current_group_end_lsn, rec->lsn,
+  buff= thread->buffer->str;
+  if (_ma_apply_redo_free_blocks(info, thread->group_end_lsn, rec->lsn,
                                  buff))
     goto end;
   error= 0;
@@ -1708,11 +1780,12 @@ prototype_redo_exec_hook(REDO_FREE_BLOCKS)
 prototype_redo_exec_hook(REDO_FREE_HEAD_OR_TAIL)
 {
   int error= 1;
+  REDO_THREAD *thread= redo_thread();
   MARIA_HA *info= get_MARIA_HA_from_REDO_record(rec);
   if (info == NULL || maria_is_crashed(info))
     return 0;
 
-  if (_ma_apply_redo_free_head_or_tail(info, current_group_end_lsn,
+  if (_ma_apply_redo_free_head_or_tail(info, thread->group_end_lsn,
                                        rec->header + FILEID_STORE_SIZE))
     goto end;
   error= 0;
@@ -1740,22 +1813,23 @@ prototype_redo_exec_hook(REDO_DELETE_ALL)
 prototype_redo_exec_hook(REDO_INDEX)
 {
   int error= 1;
+  REDO_THREAD *thread= redo_thread();
   MARIA_HA *info= get_MARIA_HA_from_REDO_record(rec);
   if (info == NULL || maria_is_crashed(info))
     return 0;
-  enlarge_buffer(rec);
+  enlarge_record_buffer(thread->buffer, rec);
 
-  if (log_record_buffer.str == NULL ||
+  if (thread->buffer->str == NULL ||
       translog_read_record(rec->lsn, 0, rec->record_length,
-                           log_record_buffer.str, NULL) !=
+                           thread->buffer->str, NULL) !=
        rec->record_length)
   {
     eprint(tracef, "Failed to read record");
     goto end;
   }
 
-  if (_ma_apply_redo_index(info, current_group_end_lsn,
-                           log_record_buffer.str + FILEID_STORE_SIZE,
+  if (_ma_apply_redo_index(info, thread->group_end_lsn,
+                           thread->buffer->str + FILEID_STORE_SIZE,
                            rec->record_length - FILEID_STORE_SIZE))
     goto end;
   error= 0;
@@ -1766,22 +1840,23 @@ prototype_redo_exec_hook(REDO_INDEX)
 prototype_redo_exec_hook(REDO_INDEX_NEW_PAGE)
 {
   int error= 1;
+  REDO_THREAD *thread= redo_thread();
   MARIA_HA *info= get_MARIA_HA_from_REDO_record(rec);
   if (info == NULL || maria_is_crashed(info))
     return 0;
-  enlarge_buffer(rec);
+  enlarge_record_buffer(thread->buffer, rec);
 
-  if (log_record_buffer.str == NULL ||
+  if (thread->buffer->str == NULL ||
       translog_read_record(rec->lsn, 0, rec->record_length,
-                           log_record_buffer.str, NULL) !=
+                           thread->buffer->str, NULL) !=
        rec->record_length)
   {
     eprint(tracef, "Failed to read record");
     goto end;
   }
 
-  if (_ma_apply_redo_index_new_page(info, current_group_end_lsn,
-                                    log_record_buffer.str + FILEID_STORE_SIZE,
+  if (_ma_apply_redo_index_new_page(info, thread->group_end_lsn,
+                                    thread->buffer->str + FILEID_STORE_SIZE,
                                     rec->record_length - FILEID_STORE_SIZE))
     goto end;
   error= 0;
@@ -1793,11 +1868,12 @@ prototype_redo_exec_hook(REDO_INDEX_NEW_PAGE)
 prototype_redo_exec_hook(REDO_INDEX_FREE_PAGE)
 {
   int error= 1;
+  REDO_THREAD *thread= redo_thread();
   MARIA_HA *info= get_MARIA_HA_from_REDO_record(rec);
   if (info == NULL || maria_is_crashed(info))
     return 0;
 
-  if (_ma_apply_redo_index_free_page(info, current_group_end_lsn,
+  if (_ma_apply_redo_index_free_page(info, thread->group_end_lsn,
                                      rec->header + FILEID_STORE_SIZE))
     goto end;
   error= 0;
@@ -1809,14 +1885,15 @@ prototype_redo_exec_hook(REDO_INDEX_FREE_PAGE)
 prototype_redo_exec_hook(REDO_BITMAP_NEW_PAGE)
 {
   int error= 1;
+  REDO_THREAD *thread= redo_thread();
   MARIA_HA *info= get_MARIA_HA_from_REDO_record(rec);
   if (info == NULL || maria_is_crashed(info))
     return 0;
-  enlarge_buffer(rec);
+  enlarge_record_buffer(thread->buffer, rec);
 
-  if (log_record_buffer.str == NULL ||
+  if (thread->buffer->str == NULL ||
       translog_read_record(rec->lsn, 0, rec->record_length,
-                           log_record_buffer.str, NULL) !=
+                           thread->buffer->str, NULL) !=
        rec->record_length)
   {
     eprint(tracef, "Failed to read record");
@@ -1833,8 +1910,8 @@ prototype_redo_exec_hook(REDO_BITMAP_NEW_PAGE)
       and nocive (may not be corrected as REDOs can be skipped due to
       dirty-pages list).
     */
-    if (_ma_apply_redo_bitmap_new_page(info, current_group_end_lsn,
-                                       log_record_buffer.str +
+    if (_ma_apply_redo_bitmap_new_page(info, thread->group_end_lsn,
+                                       thread->buffer->str +
                                        FILEID_STORE_SIZE))
       goto end;
   }
@@ -1862,16 +1939,8 @@ prototype_redo_exec_hook(UNDO_ROW_INSERT)
   MARIA_HA *info= get_MARIA_HA_from_UNDO_record(rec);
   MARIA_SHARE *share;
 
-  set_undo_lsn_for_active_trans(rec->short_trid, rec->lsn);
   if (info == NULL)
-  {
-    /*
-      Note that we set undo_lsn anyway. So that if the transaction is later
-      rolled back, this UNDO is tried for execution and we get a warning (as
-      it would then be abnormal that info==NULL).
-    */
     return 0;
-  }
   share= info->s;
   if (cmp_translog_addr(rec->lsn, share->state.is_of_horizon) >= 0)
   {
@@ -1906,7 +1975,6 @@ prototype_redo_exec_hook(UNDO_ROW_DELETE)
   MARIA_HA *info= get_MARIA_HA_from_UNDO_record(rec);
   MARIA_SHARE *share;
 
-  set_undo_lsn_for_active_trans(rec->short_trid, rec->lsn);
   if (info == NULL)
     return 0;
   share= info->s;
@@ -1943,7 +2011,6 @@ prototype_redo_exec_hook(UNDO_ROW_UPDATE)
   MARIA_HA *info= get_MARIA_HA_from_UNDO_record(rec);
   MARIA_SHARE *share;
 
-  set_undo_lsn_for_active_trans(rec->short_trid, rec->lsn);
   if (info == NULL)
     return 0;
   share= info->s;
@@ -1974,8 +2041,8 @@ prototype_redo_exec_hook(UNDO_KEY_INSERT)
 {
   MARIA_HA *info;
   MARIA_SHARE *share;
+  REDO_THREAD *thread= redo_thread();
 
-  set_undo_lsn_for_active_trans(rec->short_trid, rec->lsn);
   if (!(info= get_MARIA_HA_from_UNDO_record(rec)))
     return 0;
   share= info->s;
@@ -1991,16 +2058,16 @@ prototype_redo_exec_hook(UNDO_KEY_INSERT)
       uchar *to;
       tprint(tracef, "   state older than record\n");
       /* we read the record to find the auto_increment value */
-      enlarge_buffer(rec);
-      if (log_record_buffer.str == NULL ||
+      enlarge_record_buffer(thread->buffer, rec);
+      if (thread->buffer->str == NULL ||
           translog_read_record(rec->lsn, 0, rec->record_length,
-                               log_record_buffer.str, NULL) !=
+                               thread->buffer->str, NULL) !=
           rec->record_length)
       {
         eprint(tracef, "Failed to read record");
         return 1;
       }
-      to= log_record_buffer.str + LSN_STORE_SIZE + FILEID_STORE_SIZE +
+      to= thread->buffer->str + LSN_STORE_SIZE + FILEID_STORE_SIZE +
         KEY_NR_STORE_SIZE;
       if (keyseg->flag & HA_SWAP_KEY)
       {
@@ -2030,7 +2097,6 @@ prototype_redo_exec_hook(UNDO_KEY_DELETE)
 {
   MARIA_HA *info;
 
-  set_undo_lsn_for_active_trans(rec->short_trid, rec->lsn);
   if (!(info= get_MARIA_HA_from_UNDO_record(rec)))
     return 0;
   _ma_unpin_all_pages(info, rec->lsn);
@@ -2043,7 +2109,6 @@ prototype_redo_exec_hook(UNDO_KEY_DELETE_WITH_ROOT)
   MARIA_HA *info= get_MARIA_HA_from_UNDO_record(rec);
   MARIA_SHARE *share;
 
-  set_undo_lsn_for_active_trans(rec->short_trid, rec->lsn);
   if (info == NULL)
     return 0;
   share= info->s;
@@ -2128,6 +2193,7 @@ prototype_redo_exec_hook(CLR_END)
   const LOG_DESC *log_desc;
   my_bool row_entry= 0;
   uchar *logpos;
+  REDO_THREAD *thread= redo_thread();
   DBUG_ENTER("exec_REDO_LOGREC_CLR_END");
 
   previous_undo_lsn= lsn_korr(rec->header);
@@ -2135,23 +2201,22 @@ prototype_redo_exec_hook(CLR_END)
     clr_type_korr(rec->header + LSN_STORE_SIZE + FILEID_STORE_SIZE);
   log_desc= &log_record_type_descriptor[undone_record_type];
 
-  set_undo_lsn_for_active_trans(rec->short_trid, previous_undo_lsn);
   if (info == NULL)
     DBUG_RETURN(0);
   share= info->s;
   tprint(tracef, "   CLR_END was about %s, undo_lsn now LSN (%lu,0x%lx)\n",
          log_desc->name, LSN_IN_PARTS(previous_undo_lsn));
 
-  enlarge_buffer(rec);
-  if (log_record_buffer.str == NULL ||
+  enlarge_record_buffer(thread->buffer, rec);
+  if (thread->buffer->str == NULL ||
       translog_read_record(rec->lsn, 0, rec->record_length,
-                           log_record_buffer.str, NULL) !=
+                           thread->buffer->str, NULL) !=
       rec->record_length)
   {
     eprint(tracef, "Failed to read record");
     return 1;
   }
-  logpos= (log_record_buffer.str + LSN_STORE_SIZE + FILEID_STORE_SIZE +
+  logpos= (thread->buffer->str + LSN_STORE_SIZE + FILEID_STORE_SIZE +
            CLR_TYPE_STORE_SIZE);
 
   if (cmp_translog_addr(rec->lsn, share->state.is_of_horizon) >= 0)
@@ -2534,6 +2599,238 @@ prototype_undo_exec_hook(UNDO_BULK_INSERT)
 }
 
 
+/**
+   @brief Sets up the batch of REDO phase records if maria_recovery_threads
+   asks for several threads
+*/
+
+static void init_redo_batch(void)
+{
+  redo_batch.threads= 1;
+  if (maria_recovery_threads <= 1 ||
+      pthread_key_create(&redo_batch.thread_key, NULL))
+    return;
+  my_init_dynamic_array(&redo_batch.records, sizeof(REDO_BATCH_RECORD),
+                        REDO_BATCH_RECORDS, 0, MYF(0));
+  my_init_dynamic_array(&redo_batch.tables, sizeof(REDO_BATCH_TABLE),
+                        16, 16, MYF(0));
+  redo_batch.threads= (uint) maria_recovery_threads;
+}
+
+
+/** @brief Frees the batch, without executing the records left in it */
+
+static void end_redo_batch(void)
+{
+  if (redo_batch.threads > 1)
+  {
+    redo_batch.threads= 1;
+    pthread_key_delete(redo_batch.thread_key);
+    delete_dynamic(&redo_batch.records);
+    delete_dynamic(&redo_batch.tables);
+  }
+}
+
+
+/**
+   @brief Executes the records of one table of the batch, in log order.
+   Called by ma_service_threads_run().
+*/
+
+static my_bool apply_redo_batch_table(void *item,
+                                      void *arg __attribute__((unused)))
+{
+  REDO_BATCH_TABLE *table= (REDO_BATCH_TABLE*) item;
+  REDO_BATCH_RECORD *record;
+  struct st_log_record_buffer buffer= { NULL, 0 };
+  REDO_THREAD thread;
+  uint i;
+  my_bool error= 0;
+
+  bzero(&thread, sizeof(thread));
+  thread.buffer= &buffer;
+  my_pthread_setspecific_ptr(redo_batch.thread_key, &thread);
+  for (i= table->first; i != REDO_BATCH_END && !error; i= record->next)
+  {
+    record= dynamic_element(&redo_batch.records, i, REDO_BATCH_RECORD*);
+    thread.group_end_lsn= record->group_end_lsn;
+    error= MY_TEST(display_and_apply_record(&log_record_type_descriptor
+                                            [record->rec.type],
+                                            &record->rec));
+#ifndef DBUG_OFF
+    if (record->group_end_lsn == LSN_IMPOSSIBLE)
+      thread.group_table= NULL;                 /* Group is finished */
+#endif
+  }
+  my_pthread_setspecific_ptr(redo_batch.thread_key, NULL);
+  my_free(buffer.str);
+  return error;
+}
+
+
+/**
+   @brief Executes the records collected in the batch
+
+   Every table of the batch is handed to one of the threads, which
+   executes the records of that table in log order.
+
+   @return Operation status
+     @retval 0      OK
+     @retval 1      Error
+*/
+
+static my_bool apply_redo_batch(void)
+{
+  my_bool error;
+  uint i;
+  if (redo_batch.threads <= 1 || !redo_batch.records.elements)
+    return 0;
+  error= ma_service_threads_run(redo_batch.threads, redo_batch.tables.buffer,
+                                sizeof(REDO_BATCH_TABLE),
+                                redo_batch.tables.elements,
+                                apply_redo_batch_table, NULL);
+  for (i= 0; i < redo_batch.tables.elements; i++)
+  {
+    REDO_BATCH_TABLE *table= dynamic_element(&redo_batch.tables, i,
+                                             REDO_BATCH_TABLE*);
+    all_tables[table->sid].redo_batch_table= 0;
+  }
+  reset_dynamic(&redo_batch.records);
+  reset_dynamic(&redo_batch.tables);
+  return error;
+}
+
+
+/**
+   @brief Adds a record to the batch, executes the batch when it is full
+   and no group is open
+
+   @param  sid             short id of the table of the record
+   @param  rec             record's header
+*/
+
+static my_bool add_to_redo_batch(uint16 sid, const TRANSLOG_HEADER_BUFFER *rec)
+{
+  REDO_BATCH_RECORD *record;
+  REDO_BATCH_TABLE *table;
+  uint nr= redo_batch.records.elements;
+
+  if (!(record= (REDO_BATCH_RECORD*) alloc_dynamic(&redo_batch.records)))
+    return 1;
+  record->rec= *rec;
+  /* The executors read the body by LSN, they don't need the groups */
+  record->rec.groups= NULL;
+  record->rec.groups_no= 0;
+  record->group_end_lsn= main_redo_thread.group_end_lsn;
+  record->next= REDO_BATCH_END;
+  if (all_tables[sid].redo_batch_table)
+  {
+    table= dynamic_element(&redo_batch.tables,
+                           all_tables[sid].redo_batch_table - 1,
+                           REDO_BATCH_TABLE*);
+    dynamic_element(&redo_batch.records, table->last,
+                    REDO_BATCH_RECORD*)->next= nr;
+    table->last= nr;
+  }
+  else
+  {
+    if (!(table= (REDO_BATCH_TABLE*) alloc_dynamic(&redo_batch.tables)))
+      return 1;
+    table->first= table->last= nr;
+    table->sid= sid;
+    all_tables[sid].redo_batch_table= redo_batch.tables.elements;
+  }
+  /*
+    A group is not split between batches, as the REDOs of a group leave
+    their pages pinned for the thread which executes the record ending it.
+  */
+  if (redo_batch.records.elements >= REDO_BATCH_RECORDS &&
+      main_redo_thread.group_end_lsn == LSN_IMPOSSIBLE)
+    return apply_redo_batch();
+  return 0;
+}
+
+
+/**
+   @brief Executes a record of the REDO phase, or adds it to the batch
+
+   The REDOs of pages and the UNDOs which update the state of a table only
+   change their table. With several recovery threads, they are collected
+   in a batch where the records of different tables are executed at the
+   same time and the records of each table in log order. Before any other
+   record that uses tables, the batch is executed, so that the record sees
+   all tables as if the log had been applied in order. Records which only
+   change the list of transactions are executed at once.
+
+   @param  log_desc        log record's descriptor
+   @param  rec             record's header
+
+   @return Operation status
+     @retval 0      OK
+     @retval !=0    Error
+*/
+
+static int apply_redo_record(const LOG_DESC *log_desc,
+                             const TRANSLOG_HEADER_BUFFER *rec)
+{
+  uint16 sid;
+  switch (rec->type) {
+  case LOGREC_UNDO_ROW_INSERT:
+  case LOGREC_UNDO_ROW_DELETE:
+  case LOGREC_UNDO_ROW_UPDATE:
+  case LOGREC_UNDO_KEY_INSERT:
+  case LOGREC_UNDO_KEY_DELETE:
+  case LOGREC_UNDO_KEY_DELETE_WITH_ROOT:
+    /*
+      Note that we set undo_lsn even if the table is skipped. So that if the
+      transaction is later rolled back, this UNDO is tried for execution and
+      we get a warning (as it would then be abnormal that info==NULL).
+    */
+    set_undo_lsn_for_active_trans(rec->short_trid, rec->lsn);
+    sid= fileid_korr(rec->header + LSN_STORE_SIZE);
+    break;
+  case LOGREC_CLR_END:
+    /* The transaction goes back to the UNDO before the undone one */
+    set_undo_lsn_for_active_trans(rec->short_trid, lsn_korr(rec->header));
+    sid= fileid_korr(rec->header + LSN_STORE_SIZE);
+    break;
+  case LOGREC_REDO_INSERT_ROW_HEAD:
+  case LOGREC_REDO_INSERT_ROW_TAIL:
+  case LOGREC_REDO_NEW_ROW_HEAD:
+  case LOGREC_REDO_NEW_ROW_TAIL:
+  case LOGREC_REDO_INSERT_ROW_BLOBS:
+  case LOGREC_REDO_PURGE_ROW_HEAD:
+  case LOGREC_REDO_PURGE_ROW_TAIL:
+  case LOGREC_REDO_FREE_HEAD_OR_TAIL:
+  case LOGREC_REDO_FREE_BLOCKS:
+  case LOGREC_REDO_INDEX:
+  case LOGREC_REDO_INDEX_NEW_PAGE:
+  case LOGREC_REDO_INDEX_FREE_PAGE:
+  case LOGREC_REDO_BITMAP_NEW_PAGE:
+    sid= fileid_korr(rec->header);
+    if (redo_batch.threads > 1)
+      print_redo_phase_progress(rec->lsn);
+    break;
+  case LOGREC_LONG_TRANSACTION_ID:
+  case LOGREC_COMMIT:
+  case LOGREC_CHECKPOINT:
+  case LOGREC_INCOMPLETE_GROUP:
+  case LOGREC_DEBUG_INFO:
+    return display_and_apply_record(log_desc, rec);
+  default:
+    sid= 0;
+    break;
+  }
+  if (redo_batch.threads <= 1)
+    return display_and_apply_record(log_desc, rec);
+  if (sid != 0)
+    return add_to_redo_batch(sid, rec);
+  if (apply_redo_batch())
+    return 1;
+  return display_and_apply_record(log_desc, rec);
+}
+
+
 static int run_redo_phase(LSN lsn, LSN lsn_end, enum maria_apply_log_way apply)
 {
   TRANSLOG_HEADER_BUFFER rec;
@@ -2596,9 +2893,10 @@ static int run_redo_phase(LSN lsn, LSN lsn_end, enum maria_apply_log_way apply)
   install_redo_exec_hook(IMPORTED_TABLE);
   install_redo_exec_hook(DEBUG_INFO);
 
-  current_group_end_lsn= LSN_IMPOSSIBLE;
+  main_redo_thread.buffer= &log_record_buffer;
+  main_redo_thread.group_end_lsn= LSN_IMPOSSIBLE;
 #ifndef DBUG_OFF
-  current_group_table= NULL;
+  main_redo_thread.group_table= NULL;
 #endif
 
   if (unlikely(lsn == LSN_IMPOSSIBLE || lsn == translog_get_horizon()))
@@ -2620,6 +2918,8 @@ static int run_redo_phase(LSN lsn, LSN lsn_end, enum maria_apply_log_way apply)
     tprint(tracef, "Scanner init failed\n");
     DBUG_RETURN(1);
   }
+  if (apply == MARIA_LOG_APPLY)
+    init_redo_batch();
   for (i= 1;;i++)
   {
     uint16 sid= rec.short_trid;
@@ -2669,6 +2969,9 @@ static int run_redo_phase(LSN lsn, LSN lsn_end, enum maria_apply_log_way apply)
                    "lsn_end reached at (%lu,0x%lx). "
                    "Skipping rest of redo entries",
                    LSN_IN_PARTS(rec2.lsn));
+            if (apply_redo_batch())
+              goto err;
+            end_redo_batch();
             translog_destroy_scanner(&scanner);
             translog_free_record_header(&rec);
             DBUG_RETURN(0);
@@ -2679,7 +2982,7 @@ static int run_redo_phase(LSN lsn, LSN lsn_end, enum maria_apply_log_way apply)
             tprint(tracef, "Scanner2 init failed\n");
             goto err;
           }
-          current_group_end_lsn= rec.lsn;
+          main_redo_thread.group_end_lsn= rec.lsn;
           do
           {
             if (rec2.short_trid == sid) /* it's in our group */
@@ -2703,7 +3006,7 @@ static int run_redo_phase(LSN lsn, LSN lsn_end, enum maria_apply_log_way apply)
                 }
               }
               if (apply == MARIA_LOG_APPLY &&
-                  display_and_apply_record(log_desc2, &rec2))
+                  apply_redo_record(log_desc2, &rec2))
               {
                 translog_destroy_scanner(&scanner2);
                 translog_free_record_header(&rec2);
@@ -2723,17 +3026,17 @@ static int run_redo_phase(LSN lsn, LSN lsn_end, enum maria_apply_log_way apply)
           while (rec2.lsn < rec.lsn);
           /* group finished */
           all_active_trans[sid].group_start_lsn= LSN_IMPOSSIBLE;
-          current_group_end_lsn= LSN_IMPOSSIBLE; /* for debugging */
+          main_redo_thread.group_end_lsn= LSN_IMPOSSIBLE;
           display_record_position(log_desc, &rec, 0);
           translog_destroy_scanner(&scanner2);
           translog_free_record_header(&rec2);
         }
       }
       if (apply == MARIA_LOG_APPLY &&
-          display_and_apply_record(log_desc, &rec))
+          apply_redo_record(log_desc, &rec))
         goto err;
 #ifndef DBUG_OFF
-      current_group_table= NULL;
+      main_redo_thread.group_table= NULL;
 #endif
     }
     else /* record does not end group */
@@ -2761,6 +3064,9 @@ static int run_redo_phase(LSN lsn, LSN lsn_end, enum maria_apply_log_way apply)
       break;
     }
   }
+  if (apply_redo_batch())
+    goto err;
+  end_redo_batch();
   translog_destroy_scanner(&scanner);
   translog_free_record_header(&rec);
   if (recovery_message_printed == REC_MSG_REDO)
@@ -2772,6 +3078,7 @@ static int run_redo_phase(LSN lsn, LSN lsn_end, enum maria_apply_log_way apply)
   DBUG_RETURN(0);
 
 err:
+  end_redo_batch();
   translog_destroy_scanner(&scanner);
   translog_free_record_header(&rec);
   DBUG_RETURN(1);
@@ -3052,8 +3359,11 @@ static MARIA_HA *get_MARIA_HA_from_REDO_record(const
   MARIA_SHARE *share;
   char llbuf[22];
   my_bool index_page_redo_entry= FALSE, page_redo_entry= FALSE;
+  REDO_THREAD *thread= redo_thread();
 
-  print_redo_phase_progress(rec->lsn);
+  /* The threads of a batch leave this to the REDO phase thread */
+  if (thread == &main_redo_thread)
+    print_redo_phase_progress(rec->lsn);
   sid= fileid_korr(rec->header);
   switch (rec->type) {
     /* not all REDO records have a page: */
@@ -3084,8 +3394,8 @@ static MARIA_HA *get_MARIA_HA_from_REDO_record(const
   tprint(tracef, "   For table of short id %u", sid);
   info= all_tables[sid].info;
 #ifndef DBUG_OFF
-  DBUG_ASSERT(current_group_table == NULL || current_group_table == info);
-  current_group_table= info;
+  DBUG_ASSERT(thread->group_table == NULL || thread->group_table == info);
+  thread->group_table= info;
 #endif
   if (info == NULL)
   {
@@ -3154,14 +3464,17 @@ static MARIA_HA *get_MARIA_HA_from_UNDO_record(const
   uint16 sid;
   MARIA_HA *info;
   MARIA_SHARE *share;
+#ifndef DBUG_OFF
+  REDO_THREAD *thread= redo_thread();
+#endif
 
   sid= fileid_korr(rec->header + LSN_STORE_SIZE);
   tprint(tracef, "   For table of short id %u", sid);
   info= all_tables[sid].info;
 #ifndef DBUG_OFF
   DBUG_ASSERT(!in_redo_phase ||
-              current_group_table == NULL || current_group_table == info);
-  current_group_table= info;
+              thread->group_table == NULL || thread->group_table == info);
+  thread->group_table= info;
 #endif
   if (info == NULL)
   {
@@ -3428,6 +3741,13 @@ static int close_all_tables(void)
     fprintf(stderr, "tables to flush:");
     recovery_message_printed= REC_MSG_FLUSH;
   }
+  if (maria_checkpoint_flush_threads > 1)
+  {
+    /* flush_all_tables_in_parallel() doesn't change maria_open_list */
+    mysql_mutex_unlock(&THR_LOCK_maria);
+    error|= flush_all_tables_in_parallel();
+    mysql_mutex_lock(&THR_LOCK_maria);
+  }
   /*
     Since the end of end_of_redo_phase(), we may have written new records
     (if UNDO phase ran)  and thus the state is newer than at
@@ -3475,6 +3795,53 @@ static int close_all_tables(void)
 }
 
 
+static my_bool flush_one_table(void *item,
+                               void *arg __attribute__((unused)))
+{
+  MARIA_HA *info= *(MARIA_HA**) item;
+  return (_ma_flush_table_files(info, MARIA_FLUSH_DATA | MARIA_FLUSH_INDEX,
+                                FLUSH_KEEP, FLUSH_KEEP) ||
+          _ma_sync_table_files(info));
+}
+
+
+/**
+   @brief Flushes and syncs all open tables with several threads
+
+   Most of the time of close_all_tables() is spent writing the pages that
+   the REDO and UNDO phases changed and syncing the files. Doing this for
+   several tables at once leaves only the writing of the state to
+   maria_close().
+
+   @return Operation status
+     @retval 0      OK
+     @retval 1      Error
+*/
+
+static my_bool flush_all_tables_in_parallel(void)
+{
+  MARIA_HA **tables;
+  LIST *list_element;
+  uint i, count;
+  my_bool error;
+  DBUG_ENTER("flush_all_tables_in_parallel");
+
+  for (count= 0, list_element= maria_open_list ; list_element;
+       count++, list_element= list_element->next)
+    ;
+  if (!(tables= (MARIA_HA **) my_malloc(count * sizeof(*tables), MYF(0))))
+    DBUG_RETURN(0);                     /* maria_close() will flush them */
+  for (i= 0, list_element= maria_open_list ; list_element;
+       i++, list_element= list_element->next)
+    tables[i]= (MARIA_HA*) list_element->data;
+  error= ma_service_threads_run((uint) maria_checkpoint_flush_threads,
+                                tables, sizeof(*tables), count,
+                                flush_one_table, NULL);
+  my_free(tables);
+  DBUG_RETURN(error);
+}
+
+
 /**
    @brief Close all table instances with a certain name which are present in
    all_tables.
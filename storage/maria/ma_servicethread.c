@@ -16,6 +16,7 @@
 
 #include "maria_def.h"
 #include "ma_servicethread.h"
+#include <my_atomic.h>
 
 /**
    Initializes the service thread
@@ -121,3 +122,100 @@ my_bool my_service_thread_sleep(MA_SERVICE_THREAD_CONTROL *control,
   mysql_mutex_unlock(control->LOCK_control);
   DBUG_RETURN(res);
 }
+
+
+/** Work shared by the threads of ma_service_threads_run() */
+
+typedef struct st_ma_service_work
+{
+  uchar *items;
+  size_t item_size;
+  int32 count;
+  int32 volatile next;                    /**< next item to process */
+  int32 volatile error;
+  MA_SERVICE_WORK_FUNC func;
+  void *arg;
+} MA_SERVICE_WORK;
+
+
+static void ma_service_work_loop(MA_SERVICE_WORK *work)
+{
+  int32 i;
+  while ((i= my_atomic_add32(&work->next, 1)) < work->count)
+  {
+    if ((*work->func)(work->items + i * work->item_size, work->arg))
+      my_atomic_store32(&work->error, 1);
+  }
+}
+
+
+pthread_handler_t ma_service_work_thread(void *arg)
+{
+  my_thread_init();
+  {
+    DBUG_ENTER("ma_service_work_thread");
+    ma_service_work_loop((MA_SERVICE_WORK *) arg);
+    DBUG_LEAVE;
+  }
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+/**
+   Calls a function for each item of an array, using several threads
+
+   The calling thread is one of them. Items are handed out one by one, so
+   the threads stay busy if the work per item is uneven. If a thread can't
+   be created, the work is done by the threads that could.
+
+   @param threads        maximum number of threads to use
+   @param items          array of items
+   @param item_size      size of one item
+   @param count          number of items
+   @param func           function to call, returns non zero on error
+   @param arg            argument passed to func
+
+   @return Operation status
+    @retval 0 OK
+    @retval 1 func returned an error for at least one item
+*/
+
+my_bool ma_service_threads_run(uint threads, void *items, size_t item_size,
+                               uint count, MA_SERVICE_WORK_FUNC func,
+                               void *arg)
+{
+  MA_SERVICE_WORK work;
+  pthread_t *thread_ids= NULL;
+  uint i, started= 0;
+  DBUG_ENTER("ma_service_threads_run");
+  DBUG_PRINT("enter", ("threads: %u  count: %u", threads, count));
+
+  work.items= (uchar*) items;
+  work.item_size= item_size;
+  work.count= (int32) count;
+  work.next= 0;
+  work.error= 0;
+  work.func= func;
+  work.arg= arg;
+
+  set_if_smaller(threads, count);
+  if (threads > 1 &&
+      (thread_ids= (pthread_t *) my_malloc(sizeof(pthread_t) * (threads - 1),
+                                           MYF(0))))
+  {
+    for (i= 0; i < threads - 1; i++)
+    {
+      if (mysql_thread_create(key_thread_service_work, thread_ids + started,
+                              NULL, ma_service_work_thread, &work))
+        break;
+      started++;
+    }
+  }
+  ma_service_work_loop(&work);
+  for (i= 0; i < started; i++)
+    pthread_join(thread_ids[i], NULL);
+  my_free(thread_ids);
+  DBUG_RETURN(work.error != 0);
+}
@@ -33,3 +33,8 @@ int ma_service_thread_control_init(MA_SERVICE_THREAD_CONTROL *control);
 void ma_service_thread_control_end(MA_SERVICE_THREAD_CONTROL *control);
 my_bool my_service_thread_sleep(MA_SERVICE_THREAD_CONTROL *control,
                                 ulonglong sleep_time);
+
+typedef my_bool (*MA_SERVICE_WORK_FUNC)(void *item, void *arg);
+my_bool ma_service_threads_run(uint threads, void *items, size_t item_size,
+                               uint count, MA_SERVICE_WORK_FUNC func,
+                               void *arg);
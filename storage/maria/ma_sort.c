@@ -364,7 +364,7 @@ static ha_rows find_all_keys(MARIA_SORT_PARAM *info, ha_rows keys,
 } /* find_all_keys */
 
 
-static my_bool _ma_thr_find_all_keys_exec(MARIA_SORT_PARAM* sort_param)
+my_bool _ma_thr_find_all_keys_exec(MARIA_SORT_PARAM* sort_param)
 {
   int error= 0;
   ulonglong memavl, old_memavl;
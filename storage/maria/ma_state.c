@@ -122,6 +122,26 @@ my_bool _ma_setup_live_state(MARIA_HA *info)
 }
 
 
+/**
+   @brief Find the entry of the table in the used tables of the transaction
+
+   @return 0 if the table is not part of the transaction
+*/
+
+MARIA_USED_TABLES *_ma_get_used_table(MARIA_HA *info)
+{
+  MARIA_USED_TABLES *tables;
+  for (tables= (MARIA_USED_TABLES*) info->trn->used_tables;
+       tables;
+       tables= tables->next)
+  {
+    if (tables->share == info->s)
+      break;
+  }
+  return tables;
+}
+
+
 /**
    @brief Remove states that are not visible by anyone
 
@@ -493,7 +513,10 @@ my_bool _ma_trnman_end_trans_hook(TRN *trn, my_bool commit,
             {
               /* purecov: begin inspected */
               error= 1;
+              if (tables->row_locks)
+                _ma_release_row_locks(share, tables);
               mysql_mutex_unlock(&share->intern_lock);
+              _ma_bitmap_release_reserved_pages(share, tables);
               my_free(tables);
               continue;
               /* purecov: end */
@@ -528,11 +551,19 @@ my_bool _ma_trnman_end_trans_hook(TRN *trn, my_bool commit,
                               (ulong) share, share->in_trans));
         }
       }
+      if (tables->row_locks)
+        _ma_release_row_locks(share, tables);
       share->in_trans--;
       mysql_mutex_unlock(&share->intern_lock);
     }
     else
     {
+      if (tables->row_locks)
+      {
+        mysql_mutex_lock(&share->intern_lock);
+        _ma_release_row_locks(share, tables);
+        mysql_mutex_unlock(&share->intern_lock);
+      }
 #ifndef DBUG_OFF
       /*
         We need to keep share->in_trans correct in the debug library
@@ -543,6 +574,7 @@ my_bool _ma_trnman_end_trans_hook(TRN *trn, my_bool commit,
       mysql_mutex_unlock(&share->intern_lock);
 #endif
     }
+    _ma_bitmap_release_reserved_pages(share, tables);
     my_free(tables);
   }
   trn->used_tables= 0;
@@ -577,6 +609,9 @@ void _ma_remove_table_from_trnman(MARIA_SHARE *share, TRN *trn)
     {
       *prev= tables->next;
       share->in_trans--;
+      if (tables->row_locks)
+        _ma_release_row_locks(share, tables);
+      _ma_bitmap_release_reserved_pages(share, tables);
       my_free(tables);
       break;
     }
@@ -612,13 +647,15 @@ void _ma_block_get_status(void* param, my_bool concurrent_insert)
   info->row_flag= info->s->base.default_row_flag;
   if (concurrent_insert)
   {
-    DBUG_ASSERT(info->lock.type == TL_WRITE_CONCURRENT_INSERT);
+    DBUG_ASSERT(info->lock.type == TL_WRITE_CONCURRENT_INSERT ||
+                info->lock.type == TL_WRITE_CONCURRENT_UPDATE);
     info->row_flag|= ROW_FLAG_TRANSID;
     info->row_base_length+= TRANSID_SIZE;
   }
   else
   {
-    DBUG_ASSERT(info->lock.type != TL_WRITE_CONCURRENT_INSERT);
+    DBUG_ASSERT(info->lock.type != TL_WRITE_CONCURRENT_INSERT &&
+                info->lock.type != TL_WRITE_CONCURRENT_UPDATE);
   }
   DBUG_VOID_RETURN;
 }
@@ -34,6 +34,8 @@ typedef struct st_used_tables {
   struct st_maria_share *share;
   MARIA_STATUS_INFO state_current;
   MARIA_STATUS_INFO state_start;
+  struct st_maria_row_lock *row_locks;  /* Rows and keys locked by trn */
+  struct st_maria_reserved_page *reserved_pages; /* Pages with freed space */
 } MARIA_USED_TABLES;
 
 
@@ -55,6 +57,7 @@ typedef struct st_state_history_closed {
 
 
 my_bool _ma_setup_live_state(MARIA_HA *info);
+MARIA_USED_TABLES *_ma_get_used_table(MARIA_HA *info);
 MARIA_STATE_HISTORY *_ma_remove_not_visible_states(MARIA_STATE_HISTORY
                                                    *org_history,
                                                    my_bool all,
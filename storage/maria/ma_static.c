@@ -41,6 +41,7 @@ my_bool maria_recovery_changed_data= 0, maria_recovery_verbose= 0;
 my_bool maria_assert_if_crashed_table= 0;
 my_bool maria_checkpoint_disabled= 0;
 my_bool maria_encrypt_tables= 0;
+my_bool maria_row_locking= 0;
 
 mysql_mutex_t THR_LOCK_maria;
 #ifdef DONT_USE_RW_LOCKS
@@ -51,6 +52,8 @@ ulong maria_concurrent_insert= 2;
 #endif
 
 my_off_t maria_max_temp_length= MAX_FILE_SIZE;
+/* Size of the page cache of each internal temporary table, 0 if shared */
+ulonglong maria_tmp_table_pagecache_size= 0;
 ulong    maria_bulk_insert_tree_size=8192*1024;
 ulong    maria_data_pointer_size= 6;
 
@@ -75,6 +78,8 @@ TRN dummy_transaction_object;
 
 /* a WT_RESOURCE_TYPE for transactions waiting on a unique key conflict */
 WT_RESOURCE_TYPE ma_rc_dup_unique={ wt_resource_id_memcmp, 0};
+/* and for writers waiting for the auto-increment values of a table */
+WT_RESOURCE_TYPE ma_rc_auto_increment={ wt_resource_id_memcmp, 0};
 
 /* Enough for comparing if number is zero */
 uchar maria_zero_string[]= {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
@@ -118,6 +123,7 @@ my_bool (*ma_killed)(MARIA_HA *)= ma_killed_standalone;
 #ifdef HAVE_PSI_INTERFACE
 
 PSI_mutex_key key_SHARE_BITMAP_lock, key_SORT_INFO_mutex,
+              key_CHECK_print_msg_mutex,
               key_THR_LOCK_maria, key_TRANSLOG_BUFFER_mutex,
               key_LOCK_soft_sync,
               key_TRANSLOG_DESCRIPTOR_dirty_buffer_mask_lock,
@@ -142,7 +148,7 @@ PSI_rwlock_key key_KEYINFO_root_lock, key_SHARE_mmap_lock,
                key_TRANSLOG_DESCRIPTOR_open_files_lock;
 
 PSI_thread_key key_thread_checkpoint, key_thread_find_all_keys,
-               key_thread_soft_sync;
+               key_thread_soft_sync, key_thread_service_work;
 
 PSI_file_key key_file_translog, key_file_kfile, key_file_dfile,
              key_file_control, key_file_tmp;
@@ -31,6 +31,7 @@ int maria_update(register MARIA_HA *info, const uchar *oldrec, uchar *newrec)
   ulonglong UNINIT_VAR(changed);
   MARIA_SHARE *share= info->s;
   MARIA_KEYDEF *keyinfo;
+  TrID new_trid;
   DBUG_ENTER("maria_update");
 
   DBUG_EXECUTE_IF("maria_pretend_crashed_table_on_usage",
@@ -82,6 +83,19 @@ int maria_update(register MARIA_HA *info, const uchar *oldrec, uchar *newrec)
   /* Ensure we don't try to restore auto_increment if it doesn't change */
   info->last_auto_increment= ~(ulonglong) 0;
 
+  /*
+    With row locks the row keeps the trid of its insert, so that other
+    transactions that wait for the row can still see it. The row keeps
+    its lock until the transaction ends.
+  */
+  if (info->lock_rows)
+  {
+    new_trid= info->cur_row.trid;
+    info->last_row_lock= 0;
+  }
+  else
+    new_trid= info->trn->trid;
+
   /* Check which keys changed from the original row */
 
   new_key_buff= info->lastkey_buff2;
@@ -113,7 +127,7 @@ int maria_update(register MARIA_HA *info, const uchar *oldrec, uchar *newrec)
         MARIA_KEY new_key, old_key;
 
         (*keyinfo->make_key)(info,&new_key, i, new_key_buff, newrec,
-                             pos, info->trn->trid);
+                             pos, new_trid);
         (*keyinfo->make_key)(info,&old_key, i, old_key_buff,
                              oldrec, pos, info->cur_row.trid);
 
@@ -125,12 +139,35 @@ int maria_update(register MARIA_HA *info, const uchar *oldrec, uchar *newrec)
 	{
 	  if ((int) i == info->lastinx)
 	    key_changed|=HA_STATE_WRITTEN;	/* Mark that keyfile changed */
+          if (info->lock_rows)
+          {
+            /* Other writers may change the index at the same time */
+            mysql_rwlock_wrlock(&keyinfo->root_lock);
+            /*
+              The new key keeps the committed trid of the row, so others
+              would take it as committed. Lock the new value as well, so
+              that they wait for us.
+            */
+            if ((keyinfo->flag & HA_NOSAME) &&
+                (_ma_lock_unique_key(info, i, oldrec) ||
+                 _ma_wait_for_unique_key(info, i, newrec) ||
+                 _ma_lock_unique_key(info, i, newrec)))
+            {
+              mysql_rwlock_unlock(&keyinfo->root_lock);
+              goto err;
+            }
+          }
 	  changed|=((ulonglong) 1 << i);
 	  keyinfo->version++;
-	  if (keyinfo->ck_delete(info,&old_key))
-            goto err;
-	  if (keyinfo->ck_insert(info,&new_key))
+	  if (keyinfo->ck_delete(info,&old_key) ||
+	      keyinfo->ck_insert(info,&new_key))
+          {
+            if (info->lock_rows)
+              mysql_rwlock_unlock(&keyinfo->root_lock);
             goto err;
+          }
+          if (info->lock_rows)
+            mysql_rwlock_unlock(&keyinfo->root_lock);
 	  if (share->base.auto_key == i+1)
 	    auto_key_changed=1;
 	}
@@ -193,6 +230,8 @@ int maria_update(register MARIA_HA *info, const uchar *oldrec, uchar *newrec)
     (*info->invalidator)(share->open_file_name.str);
     info->invalidator=0;
   }
+  if (share->private_pagecache)
+    (void) _ma_flush_private_pagecache(info);
   DBUG_RETURN(0);
 
 err:
@@ -203,10 +242,13 @@ int maria_update(register MARIA_HA *info, const uchar *oldrec, uchar *newrec)
     save_errno= HA_ERR_INTERNAL_ERROR;          /* Should never happen */
 
   if (my_errno == HA_ERR_FOUND_DUPP_KEY || my_errno == HA_ERR_OUT_OF_MEM ||
-      my_errno == HA_ERR_RECORD_FILE_FULL)
+      my_errno == HA_ERR_RECORD_FILE_FULL ||
+      my_errno == HA_ERR_LOCK_DEADLOCK || my_errno == HA_ERR_LOCK_WAIT_TIMEOUT)
   {
     info->errkey= (int) i;
-    flag=0;
+    /* A failed wait for a key lock happens before key i is changed */
+    flag= (my_errno == HA_ERR_LOCK_DEADLOCK ||
+           my_errno == HA_ERR_LOCK_WAIT_TIMEOUT);
     do
     {
       if (((ulonglong) 1 << i) & changed)
@@ -223,13 +265,18 @@ int maria_update(register MARIA_HA *info, const uchar *oldrec, uchar *newrec)
 	else
 	{
           MARIA_KEY new_key, old_key;
+          my_bool error;
           (*share->keyinfo[i].make_key)(info, &new_key, i, new_key_buff,
-                                        newrec, pos,
-                                        info->trn->trid);
+                                        newrec, pos, new_trid);
           (*share->keyinfo[i].make_key)(info, &old_key, i, old_key_buff,
                                         oldrec, pos, info->cur_row.trid);
-	  if ((flag++ && _ma_ck_delete(info, &new_key)) ||
-	      _ma_ck_write(info, &old_key))
+          if (info->lock_rows)
+            mysql_rwlock_wrlock(&share->keyinfo[i].root_lock);
+	  error= ((flag++ && _ma_ck_delete(info, &new_key)) ||
+                  _ma_ck_write(info, &old_key));
+          if (info->lock_rows)
+            mysql_rwlock_unlock(&share->keyinfo[i].root_lock);
+          if (error)
           {
             _ma_set_fatal_error(share, my_errno);
 	    break;
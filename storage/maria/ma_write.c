@@ -172,6 +172,13 @@ int maria_write(MARIA_HA *info, uchar *record)
       {
 	mysql_rwlock_wrlock(&keyinfo->root_lock);
 	keyinfo->version++;
+        /* Wait for transactions that removed the value, see ma_locking.c */
+        if (share->row_locking && (keyinfo->flag & HA_NOSAME) &&
+            _ma_wait_for_unique_key(info, i, record))
+        {
+          mysql_rwlock_unlock(&keyinfo->root_lock);
+          goto err;
+        }
       }
       if (keyinfo->flag & HA_FULLTEXT )
       {
@@ -322,6 +329,9 @@ int maria_write(MARIA_HA *info, uchar *record)
   if (share->is_log_table)
     _ma_update_status((void*) info);
 
+  /* A failed write is reported again when the page is evicted */
+  if (share->private_pagecache)
+    (void) _ma_flush_private_pagecache(info);
   DBUG_RETURN(0);
 
 err:
@@ -308,7 +308,7 @@ static struct my_option my_long_options[] =
    "Can fix almost anything except unique keys that aren't unique.",
    0, 0, 0, GET_NO_ARG, NO_ARG, 0, 0, 0, 0, 0, 0},
   {"parallel-recover", 'p',
-   "Same as '-r' but creates all the keys in parallel.",
+   "Same as '-r' but creates all the keys in parallel. Tables with the PAGE row format are only recovered in parallel together with -q.",
    0, 0, 0, GET_NO_ARG, NO_ARG, 0, 0, 0, 0, 0, 0},
   {"safe-recover", 'o',
    "Uses old recovery method; Slower than '-r' but can handle a couple of cases where '-r' reports that it can't fix the data file.",
@@ -535,7 +535,9 @@ Recover (repair)/ options (When using '--recover' or '--safe-recover'):\n\
 		      file would be very big.\n\
   -p, --parallel-recover\n\
                       Uses the same technique as '-r' and '-n', but creates\n\
-                      all the keys in parallel, in different threads.");
+                      all the keys in parallel, in different threads.\n\
+                      Tables with the PAGE row format are only recovered\n\
+                      in parallel together with -q.");
   puts("\
   -o, --safe-recover  Uses old recovery method; Slower than '-r' but can\n \
 		      handle a couple of cases where '-r' reports that it\n\
@@ -1054,12 +1056,6 @@ static int maria_chk(HA_CHECK *param, char *filename)
       error= 1;
       goto end2;
     }
-    /* We can't do parallel repair with BLOCK_RECORD yet */
-    if (param->testflag & T_REP_PARALLEL)
-    {
-      param->testflag&= ~T_REP_PARALLEL;
-      param->testflag|= T_REP_BY_SORT;
-    }
   }
 
   /*
@@ -82,6 +82,7 @@ typedef struct st_maria_sort_param
   
   MARIA_KEYDEF *keyinfo;
   MARIA_SORT_INFO *sort_info;
+  MARIA_HA *scan_info;     /* Own handler to read rows, if not sort_info->info */
   HA_KEYSEG *seg;
   uchar **sort_keys;
   uchar *rec_buff;
@@ -348,8 +349,48 @@ typedef struct st_maria_file_bitmap
   uint block_size;                    /* Block size of file */
   ulong pages_covered;                /* Pages covered by bitmap + 1 */
   DYNAMIC_ARRAY pinned_pages;         /**< not-yet-flushable bitmap pages */
+  /*
+    Pages that writers with row locks must not share. See
+    _ma_bitmap_claim_pages(). Protected by bitmap_lock.
+  */
+  HASH busy_pages;
+  struct st_maria_busy_page *hidden_pages; /* Hidden during an allocation */
+  uint waiting_for_busy_pages;        /* If someone waits for a claim */
 } MARIA_FILE_BITMAP;
 
+
+/* A page that is written, claimed or reserved by writers with row locks */
+
+typedef struct st_maria_busy_page
+{
+  pgcache_page_no_t page;
+  struct st_maria_handler *writer;    /* Handler that writes to the page */
+  struct st_ma_transaction *reserved_trn; /* Reserver, if only one */
+  uint reserved;                      /* Transactions that freed space */
+  uint hidden_bits;                   /* Real bits while hidden */
+  struct st_maria_busy_page *next_hidden;
+} MARIA_BUSY_PAGE;
+
+
+/* A page whose freed space is reserved until the transaction ends */
+
+typedef struct st_maria_reserved_page
+{
+  pgcache_page_no_t page;
+  struct st_maria_reserved_page *next;
+} MARIA_RESERVED_PAGE;
+
+
+/* A row or unique key value locked by a transaction */
+
+typedef struct st_maria_row_lock
+{
+  WT_RESOURCE_ID id;                  /* Rowid or keynr and key hash */
+  struct st_ma_transaction *trn;
+  WT_THD *wt;
+  struct st_maria_row_lock *next;     /* Next lock of the transaction */
+} MARIA_ROW_LOCK;
+
 #define MARIA_CHECKPOINT_LOOKS_AT_ME 1
 #define MARIA_CHECKPOINT_SHOULD_FREE_ME 2
 #define MARIA_CHECKPOINT_SEEN_IN_LOOP 4
@@ -377,12 +418,27 @@ typedef struct st_maria_share
   uchar *file_map;			/* mem-map of file if possible */
   LIST *open_list;			/* Tables open with this share */
   PAGECACHE *pagecache;			/* ref to the current key cache */
+  PAGECACHE *private_pagecache;		/* Owned by internal tmp table */
   MARIA_DECODE_TREE *decode_trees;
   /*
     Previous auto-increment value. Used to verify if we can restore the
     auto-increment counter if we have to abort an insert (duplicate key).
   */
   ulonglong last_auto_increment;
+  /*
+    Highest auto-increment value handed out to a writer. Protected by
+    intern_lock, like auto_increment_owner, the handler which runs a
+    statement that needs consecutive values (statement based binary log).
+  */
+  ulonglong auto_increment_reserved;
+  MARIA_HA *auto_increment_owner;
+  /*
+    Locks of UPDATE and DELETE with row locking, see _ma_lock_row().
+    Protected by intern_lock. The resource types identify the table in
+    the waiting_threads graph.
+  */
+  HASH row_locks, key_locks;
+  WT_RESOURCE_TYPE row_lock_rc, key_lock_rc;
   uint16 *decode_tables;
   uint16 id; /**< 2-byte id by which log records refer to the table */
   /* Called the first time the table instance is opened */
@@ -492,6 +548,7 @@ typedef struct st_maria_share
   */
   my_bool now_transactional;
   my_bool have_versioning;
+  my_bool row_locking;                  /* UPDATE and DELETE may lock rows */
   my_bool key_del_used;                         /* != 0 if key_del is locked */
   my_bool deleting;                     /* we are going to delete this table */
   THR_LOCK lock;
@@ -528,6 +585,11 @@ typedef struct st_maria_share
   */
   uint last_insert_page;
   pgcache_page_no_t last_insert_bitmap;
+  /*
+    Fill pages in insert order. Set for tables created with
+    MA_EXTRA_OPTIONS_INSERT_ORDER and during bulk insert into an empty table
+  */
+  my_bool insert_order;
 } MARIA_SHARE;
 
 
@@ -608,6 +670,8 @@ struct st_maria_handler
   MARIA_BIT_BUFF bit_buff;
   DYNAMIC_ARRAY bitmap_blocks;
   DYNAMIC_ARRAY pinned_pages;
+  DYNAMIC_ARRAY busy_pages;             /* Pages in share->bitmap.busy_pages */
+  MARIA_ROW_LOCK *last_row_lock;        /* Lock taken by last read */
   /* accumulate indexfile changes between write's */
   TREE *bulk_insert;
   LEX_CUSTRING *log_row_parts;		/* For logging */
@@ -632,6 +696,7 @@ struct st_maria_handler
   int (*read_record)(MARIA_HA *, uchar*, MARIA_RECORD_POS);
   invalidator_by_filename invalidator;	/* query cache invalidator */
   ulonglong last_auto_increment;        /* auto value at start of statement */
+  ulonglong auto_increment_reserved_end; /* Last value we have reserved */
   ulonglong row_changes;                /* Incremented for each change */
   ulong this_unique;			/* uniq filenumber or thread */
   ulong last_unique;			/* last unique number */
@@ -691,6 +756,7 @@ struct st_maria_handler
   my_bool once_flags;			/* For MARIA_MRG */
   /* For bulk insert enable/disable transactions control */
   my_bool switched_transactional;
+  my_bool lock_rows;                    /* UPDATE or DELETE with row locks */
 #ifdef _WIN32
   my_bool owned_by_merge;               /* This Maria table is part of a merge union */
 #endif
@@ -931,12 +997,14 @@ extern my_bool maria_inited, maria_in_ha_maria, maria_recovery_changed_data;
 extern my_bool maria_recovery_verbose, maria_checkpoint_disabled;
 extern my_bool maria_assert_if_crashed_table;
 extern ulong maria_checkpoint_min_log_activity;
+extern ulong maria_checkpoint_flush_threads, maria_recovery_threads;
 extern HASH maria_stored_state;
 extern int (*maria_create_trn_hook)(MARIA_HA *);
 extern my_bool (*ma_killed)(MARIA_HA *);
 
 #ifdef HAVE_PSI_INTERFACE
 extern PSI_mutex_key key_SHARE_BITMAP_lock, key_SORT_INFO_mutex,
+                     key_CHECK_print_msg_mutex,
                      key_THR_LOCK_maria, key_TRANSLOG_BUFFER_mutex,
                      key_LOCK_soft_sync,
                      key_TRANSLOG_DESCRIPTOR_dirty_buffer_mask_lock,
@@ -963,7 +1031,7 @@ extern PSI_rwlock_key key_KEYINFO_root_lock, key_SHARE_mmap_lock,
                       key_TRANSLOG_DESCRIPTOR_open_files_lock;
 
 extern PSI_thread_key key_thread_checkpoint, key_thread_find_all_keys,
-                      key_thread_soft_sync;
+                      key_thread_soft_sync, key_thread_service_work;
 
 extern PSI_file_key key_file_translog, key_file_kfile, key_file_dfile,
                     key_file_control, key_file_tmp;
@@ -1100,6 +1168,21 @@ void _ma_set_fatal_error(MARIA_SHARE *share, int error);
 extern my_bool _ma_set_uuid(MARIA_SHARE *info, my_bool reset_uuid);
 extern my_bool _ma_check_if_zero(uchar *pos, size_t size);
 extern int _ma_decrement_open_count(MARIA_HA *info, my_bool lock_table);
+extern int _ma_reserve_auto_increment(MARIA_HA *info, ulonglong increment,
+                                      ulonglong nb_desired_values,
+                                      my_bool consecutive,
+                                      ulonglong *first_value);
+extern int _ma_update_auto_increment_reserved(MARIA_HA *info,
+                                              ulonglong value);
+extern void _ma_release_auto_increment(MARIA_HA *info, ulonglong next_value);
+extern int _ma_lock_row(MARIA_HA *info, MARIA_RECORD_POS rowid);
+extern void _ma_unlock_row(MARIA_HA *info);
+extern int _ma_lock_unique_key(MARIA_HA *info, uint keynr,
+                               const uchar *record);
+extern int _ma_wait_for_unique_key(MARIA_HA *info, uint keynr,
+                                   const uchar *record);
+extern void _ma_release_row_locks(MARIA_SHARE *share,
+                                  MARIA_USED_TABLES *tables);
 extern int _ma_check_index(MARIA_HA *info, int inx);
 extern int _ma_search(MARIA_HA *info, MARIA_KEY *key, uint32 nextflag,
                       my_off_t pos);
@@ -1187,6 +1270,9 @@ void page_cleanup(MARIA_SHARE *share, MARIA_PAGE *page)
 extern MARIA_KEY *_ma_make_key(MARIA_HA *info, MARIA_KEY *int_key, uint keynr,
                                uchar *key, const uchar *record,
                                MARIA_RECORD_POS filepos, ulonglong trid);
+extern my_bool _ma_key_hash(MARIA_HA *info, uint keynr, const uchar *record,
+                            ha_checksum *hash);
+extern my_bool _ma_row_key_changed(MARIA_HA *info, const uchar *record);
 extern MARIA_KEY *_ma_pack_key(MARIA_HA *info, MARIA_KEY *int_key,
                                uint keynr, uchar *key,
                                const uchar *old, key_part_map keypart_map,
@@ -1371,6 +1457,12 @@ C_MODE_START
 int _ma_flush_table_files(MARIA_HA *info, uint flush_data_or_index,
                           enum flush_type flush_type_for_data,
                           enum flush_type flush_type_for_index);
+
+/* Smallest private page cache given to an internal temporary table */
+#define MARIA_MIN_PRIVATE_PAGECACHE_BLOCKS 16
+void _ma_init_private_pagecache(MARIA_SHARE *share);
+void _ma_end_private_pagecache(MARIA_SHARE *share);
+int _ma_flush_private_pagecache(MARIA_HA *info);
 /*
   Functions needed by _ma_check (are overridden in MySQL/ha_maria.cc).
   See ma_check_standalone.h .
@@ -1391,6 +1483,7 @@ int _ma_flush_pending_blocks(MARIA_SORT_PARAM *param);
 int _ma_sort_ft_buf_flush(MARIA_SORT_PARAM *sort_param);
 int _ma_thr_write_keys(MARIA_SORT_PARAM *sort_param);
 pthread_handler_t _ma_thr_find_all_keys(void *arg);
+my_bool _ma_thr_find_all_keys_exec(MARIA_SORT_PARAM *sort_param);
 
 int _ma_sort_write_record(MARIA_SORT_PARAM *sort_param);
 int _ma_create_index_by_sort(MARIA_SORT_PARAM *info, my_bool no_messages,
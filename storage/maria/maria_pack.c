@@ -52,6 +52,7 @@ struct st_file_buffer {
   my_off_t pos_in_file;
   int bits;
   ulonglong bitbucket;
+  my_bool in_memory;			/* Grown, not written, when full */
 };
 
 struct st_huff_tree;
@@ -120,6 +121,57 @@ typedef struct st_isam_mrg {
 } PACK_MRG_INFO;
 
 
+/*
+  With --threads the main thread reads the rows in batches, which the
+  worker threads take in read order. For the statistics every worker
+  counts into its own HUFF_COUNTS, which are merged at the end. For the
+  compression every worker packs its batch into a memory buffer, which
+  the main thread appends to the data file in the order of the batches.
+*/
+
+#define PACK_BATCH_SIZE		(1024*1024L)	/* Bytes of rows per batch */
+
+typedef struct st_pack_batch {
+  uchar *records;			/* Rows read into the batch */
+  uint rows;
+  MEM_ROOT blob_root;			/* Copies of the blobs of the rows */
+  struct st_file_buffer buff;		/* Packed rows */
+  uint min_record_length,max_record_length;
+  my_bool done;				/* Set when the worker is done */
+  my_bool error;
+} PACK_BATCH;
+
+struct st_pack_threads;
+
+typedef struct st_pack_worker {
+  struct st_pack_threads *threads;
+  pthread_t thread;
+  HUFF_COUNTS *huff_counts;		/* Statistics of this worker */
+  ha_checksum crc;
+  ulong max_blob_length;
+} PACK_WORKER;
+
+typedef struct st_pack_threads {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;			/* Batch read or batch done */
+  PACK_MRG_INFO *mrg;
+  HUFF_COUNTS *huff_counts;
+  PACK_BATCH *batch;
+  PACK_WORKER *worker;
+  uint batches,max_rows;
+  ulong filled,started;			/* Batches read, batches taken */
+  my_bool end_of_file,compress;
+  ha_checksum (*calc_checksum)(MARIA_HA *, const uchar *);
+  /* Used when packing the rows */
+  uint pack_version,max_calc_length,max_pack_length,pack_blob_length;
+  /* Result of all batches */
+  my_off_t records;
+  ha_checksum crc;
+  ulong max_blob_length;
+  uint min_record_length,max_record_length;
+} PACK_THREADS;
+
+
 extern int main(int argc,char * *argv);
 static void get_options(int *argc,char ***argv);
 static MARIA_HA *open_maria_file(char *name,int mode);
@@ -130,9 +182,12 @@ static void free_counts_and_tree_and_queue(HUFF_TREE *huff_trees,
 					   uint trees,
 					   HUFF_COUNTS *huff_counts,
 					   uint fields);
-static int compare_tree(void* cmp_arg __attribute__((unused)),
-			const uchar *s,const uchar *t);
+static void free_huff_counts(HUFF_COUNTS *huff_counts, uint fields);
+static int compare_tree(void* cmp_arg,const uchar *s,const uchar *t);
 static int get_statistic(PACK_MRG_INFO *mrg,HUFF_COUNTS *huff_counts);
+static ulong count_record_statistic(HUFF_COUNTS *huff_counts,
+                                    HUFF_COUNTS *end_count, uchar *record,
+                                    uint null_bytes);
 static void check_counts(HUFF_COUNTS *huff_counts,uint trees,
 			 my_off_t records);
 static int test_space_compress(HUFF_COUNTS *huff_counts,my_off_t records,
@@ -159,13 +214,19 @@ static uint *make_offset_code_tree(HUFF_TREE *huff_tree,
 				       uint *offset);
 static uint max_bit(uint value);
 static int compress_maria_file(PACK_MRG_INFO *file,HUFF_COUNTS *huff_counts);
+static ulong compress_record(struct st_file_buffer *buff,
+                             HUFF_COUNTS *huff_counts, HUFF_COUNTS *end_count,
+                             uchar *record, uint null_bytes,
+                             uint max_pack_length, uint pack_blob_length,
+                             uint pack_version);
+static int pack_in_threads(PACK_THREADS *threads);
 static char *make_new_name(char *new_name,char *old_name);
 static char *make_old_name(char *new_name,char *old_name);
 static void init_file_buffer(File file,pbool read_buffer);
-static int flush_buffer(ulong neaded_length);
+static int flush_buffer(struct st_file_buffer *buff,ulong neaded_length);
 static void end_file_buffer(void);
-static void write_bits(ulonglong value, uint bits);
-static void flush_bits(void);
+static void write_bits(struct st_file_buffer *buff,ulonglong value,uint bits);
+static void flush_bits(struct st_file_buffer *buff);
 static int save_state(MARIA_HA *isam_file,PACK_MRG_INFO *mrg,
                       my_off_t new_length, ha_checksum crc);
 static int save_state_mrg(File file,PACK_MRG_INFO *isam_file,
@@ -183,6 +244,7 @@ static int error_on_write=0,test_only=0,verbose=0,silent=0,
 	   write_loop=0,force_pack=0, isamchk_neaded=0;
 static int tmpfile_createflag=O_RDWR | O_TRUNC | O_EXCL;
 static my_bool backup, opt_wait;
+static uint opt_threads= 1;
 /*
   tree_buff_length is somewhat arbitrary. The bigger it is the better
   the chance to win in terms of compression factor. On the other hand,
@@ -195,7 +257,6 @@ static my_off_t intervall_length;
 static ha_checksum glob_crc;
 static struct st_file_buffer file_buffer;
 static QUEUE queue;
-static HUFF_COUNTS *global_count;
 static char zero_string[]={0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 static const char *load_default_groups[]= { "ariapack",0 };
 
@@ -250,7 +311,7 @@ int main(int argc, char **argv)
 #endif
 }
 
-enum options_mp {OPT_CHARSETS_DIR_MP=256, OPT_AUTO_CLOSE};
+enum options_mp {OPT_CHARSETS_DIR_MP=256, OPT_AUTO_CLOSE, OPT_THREADS_MP};
 
 static struct my_option my_long_options[] =
 {
@@ -276,6 +337,10 @@ static struct my_option my_long_options[] =
    0, 0, 0, GET_NO_ARG, NO_ARG, 0, 0, 0, 0, 0, 0},
   {"silent", 's', "Be more silent.",
    0, 0, 0, GET_NO_ARG, NO_ARG, 0, 0, 0, 0, 0, 0},
+  {"threads", OPT_THREADS_MP,
+   "Number of threads to use for gathering the statistics and for packing "
+   "the rows.",
+   &opt_threads, &opt_threads, 0, GET_UINT, REQUIRED_ARG, 1, 1, 64, 0, 1, 0},
   {"tmpdir", 'T', "Use temporary directory to store temporary table.",
    0, 0, 0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
   {"test", 't', "Don't pack table, only test packing it.",
@@ -799,7 +864,7 @@ static HUFF_COUNTS *init_huff_count(MARIA_HA *info,my_off_t records)
         This is accomplished by '-1' as the element size.
       */
       init_tree(&count[i].int_tree,0,0,-1,(qsort_cmp2) compare_tree, NULL,
-		NULL, MYF(0));
+		count+i, MYF(0));
       if (records && type != FIELD_BLOB && type != FIELD_VARCHAR)
 	count[i].tree_pos=count[i].tree_buff =
 	  my_malloc(count[i].field_length > 1 ? tree_buff_length : 2,
@@ -830,19 +895,25 @@ static void free_counts_and_tree_and_queue(HUFF_TREE *huff_trees, uint trees,
     my_free(huff_trees);
   }
   if (huff_counts)
+    free_huff_counts(huff_counts, fields);
+  delete_queue(&queue);		/* This is safe to free */
+  return;
+}
+
+
+static void free_huff_counts(HUFF_COUNTS *huff_counts, uint fields)
+{
+  register uint i;
+
+  for (i=0 ; i < fields ; i++)
   {
-    for (i=0 ; i < fields ; i++)
+    if (huff_counts[i].tree_buff)
     {
-      if (huff_counts[i].tree_buff)
-      {
-	my_free(huff_counts[i].tree_buff);
-	delete_tree(&huff_counts[i].int_tree);
-      }
+      my_free(huff_counts[i].tree_buff);
+      delete_tree(&huff_counts[i].int_tree);
     }
-    my_free(huff_counts);
   }
-  delete_queue(&queue);		/* This is safe to free */
-  return;
+  my_free(huff_counts);
 }
 
 	/* Read through old file and gather some statistics */
@@ -850,12 +921,11 @@ static void free_counts_and_tree_and_queue(HUFF_TREE *huff_trees, uint trees,
 static int get_statistic(PACK_MRG_INFO *mrg,HUFF_COUNTS *huff_counts)
 {
   int error;
-  uint length, null_bytes;
+  uint null_bytes;
   ulong reclength,max_blob_length;
-  uchar *record,*pos,*next_pos,*end_pos,*start_pos;
+  uchar *record;
   ha_rows record_count;
   HUFF_COUNTS *count,*end_count;
-  TREE_ELEMENT *element;
   ha_checksum(*calc_checksum)(MARIA_HA *, const uchar *);
   DBUG_ENTER("get_statistic");
 
@@ -873,200 +943,29 @@ static int get_statistic(PACK_MRG_INFO *mrg,HUFF_COUNTS *huff_counts)
     calc_checksum= _ma_checksum;
 
   mrg_reset(mrg);
-  while ((error=mrg_rrnd(mrg,record)) != HA_ERR_END_OF_FILE)
+  if (opt_threads > 1 && mrg->records)
+  {
+    PACK_THREADS threads;
+    bzero((char*) &threads, sizeof(threads));
+    threads.mrg= mrg;
+    threads.huff_counts= huff_counts;
+    threads.calc_checksum= calc_checksum;
+    if ((error= pack_in_threads(&threads)) != HA_ERR_END_OF_FILE)
+      fprintf(stderr, "Got error %d while reading rows\n", error);
+    glob_crc= threads.crc;
+    record_count= threads.records;
+    max_blob_length= threads.max_blob_length;
+  }
+  else while ((error=mrg_rrnd(mrg,record)) != HA_ERR_END_OF_FILE)
   {
-    ulong tot_blob_length=0;
+    ulong tot_blob_length;
     if (! error)
     {
       /* glob_crc is a checksum over all bytes of all records. */
       glob_crc+= (*calc_checksum)(mrg->file[0],record);
 
-      /* Count the incidence of values separately for every column. */
-      for (pos=record + null_bytes, count=huff_counts ;
-	   count < end_count ;
-	   count++,
-	   pos=next_pos)
-      {
-	next_pos=end_pos=(start_pos=pos)+count->field_length;
-
-	/*
-          Put the whole column value in a tree if there is room for it.
-          'int_tree' is used to quickly check for duplicate values.
-          'tree_buff' collects as many distinct column values as
-          possible. If the field length is > 1, it is tree_buff_length,
-          else 2 bytes. Each value is 'field_length' bytes big. If there
-          are more distinct column values than fit into the buffer, we
-          give up with this tree. BLOBs and VARCHARs do not have a
-          tree_buff as it can only be used with fixed length columns.
-          For the special case of field length == 1, we handle only the
-          case that there is only one distinct value in the table(s).
-          Otherwise, we can have a maximum of 256 distinct values. This
-          is then handled by the normal Huffman tree build.
-
-          Another limit for collecting distinct column values is the
-          number of values itself. Since we would need to build a
-          Huffman tree for the values, we are limited by the 'IS_OFFSET'
-          constant. This constant expresses a bit which is used to
-          determine if a tree element holds a final value or an offset
-          to a child element. Hence, all values and offsets need to be
-          smaller than 'IS_OFFSET'. A tree element is implemented with
-          two integer values, one for the left branch and one for the
-          right branch. For the extreme case that the first element
-          points to the last element, the number of integers in the tree
-          must be less or equal to IS_OFFSET. So the number of elements
-          must be less or equal to IS_OFFSET / 2.
-
-          WARNING: At first, we insert a pointer into the record buffer
-          as the key for the tree. If we got a new distinct value, which
-          is really inserted into the tree, instead of being counted
-          only, we will copy the column value from the record buffer to
-          'tree_buff' and adjust the key pointer of the tree accordingly.
-        */
-	if (count->tree_buff)
-	{
-	  global_count=count;
-	  if (!(element=tree_insert(&count->int_tree,pos, 0,
-				    count->int_tree.custom_arg)) ||
-	      (element->count == 1 &&
-	       (count->tree_buff + tree_buff_length <
-                count->tree_pos + count->field_length)) ||
-              (count->int_tree.elements_in_tree > IS_OFFSET / 2) ||
-	      (count->field_length == 1 &&
-	       count->int_tree.elements_in_tree > 1))
-	  {
-	    delete_tree(&count->int_tree);
-	    my_free(count->tree_buff);
-	    count->tree_buff=0;
-	  }
-	  else
-	  {
-            /*
-              If tree_insert() succeeds, it either creates a new element
-              or increments the counter of an existing element.
-            */
-	    if (element->count == 1)
-	    {
-              /* Copy the new column value into 'tree_buff'. */
-	      memcpy(count->tree_pos,pos,(size_t) count->field_length);
-              /* Adjust the key pointer in the tree. */
-	      tree_set_pointer(element,count->tree_pos);
-              /* Point behind the last column value so far. */
-	      count->tree_pos+=count->field_length;
-	    }
-	  }
-	}
-
-	/* Save character counters and space-counts and zero-field-counts */
-	if (count->field_type == FIELD_NORMAL ||
-	    count->field_type == FIELD_SKIP_ENDSPACE)
-	{
-          /* Ignore trailing space. */
-	  for ( ; end_pos > pos ; end_pos--)
-	    if (end_pos[-1] != ' ')
-	      break;
-          /* Empty fields are just counted. Go to the next record. */
-	  if (end_pos == pos)
-	  {
-	    count->empty_fields++;
-	    count->max_zero_fill=0;
-	    continue;
-	  }
-          /*
-            Count the total of all trailing spaces and the number of
-            short trailing spaces. Remember the longest trailing space.
-          */
-	  length= (uint) (next_pos-end_pos);
-	  count->tot_end_space+=length;
-	  if (length < 8)
-	    count->end_space[length]++;
-	  if (count->max_end_space < length)
-	    count->max_end_space = length;
-	}
-
-	if (count->field_type == FIELD_NORMAL ||
-	    count->field_type == FIELD_SKIP_PRESPACE)
-	{
-          /* Ignore leading space. */
-	  for (pos=start_pos; pos < end_pos ; pos++)
-	    if (pos[0] != ' ')
-	      break;
-          /* Empty fields are just counted. Go to the next record. */
-	  if (end_pos == pos)
-	  {
-	    count->empty_fields++;
-	    count->max_zero_fill=0;
-	    continue;
-	  }
-          /*
-            Count the total of all leading spaces and the number of
-            short leading spaces. Remember the longest leading space.
-          */
-	  length= (uint) (pos-start_pos);
-	  count->tot_pre_space+=length;
-	  if (length < 8)
-	    count->pre_space[length]++;
-	  if (count->max_pre_space < length)
-	    count->max_pre_space = length;
-	}
-
-        /* Calculate pos, end_pos, and max_length for variable length fields. */
-	if (count->field_type == FIELD_BLOB)
-	{
-	  uint field_length=count->field_length -portable_sizeof_char_ptr;
-	  ulong blob_length= _ma_calc_blob_length(field_length, start_pos);
-	  memcpy(&pos,  start_pos+field_length,sizeof(char*));
-	  end_pos=pos+blob_length;
-	  tot_blob_length+=blob_length;
-	  set_if_bigger(count->max_length,blob_length);
-	}
-	else if (count->field_type == FIELD_VARCHAR)
-	{
-          uint pack_length= HA_VARCHAR_PACKLENGTH(count->field_length-1);
-	  length= (pack_length == 1 ? (uint) *(uchar*) start_pos :
-                   uint2korr(start_pos));
-	  pos= start_pos+pack_length;
-	  end_pos= pos+length;
-	  set_if_bigger(count->max_length,length);
-	}
-
-        /* Evaluate 'max_zero_fill' for short fields. */
-	if (count->field_length <= 8 &&
-	    (count->field_type == FIELD_NORMAL ||
-	     count->field_type == FIELD_SKIP_ZERO))
-	{
-	  uint i;
-          /* Zero fields are just counted. Go to the next record. */
-	  if (!memcmp(start_pos, zero_string, count->field_length))
-	  {
-	    count->zero_fields++;
-	    continue;
-	  }
-          /*
-            max_zero_fill starts with field_length. It is decreased every
-            time a shorter "zero trailer" is found. It is set to zero when
-            an empty field is found (see above). This suggests that the
-            variable should be called 'min_zero_fill'.
-          */
-	  for (i =0 ; i < count->max_zero_fill && ! end_pos[-1 - (int) i] ;
-	       i++) ;
-	  if (i < count->max_zero_fill)
-	    count->max_zero_fill=i;
-	}
-
-        /* Ignore zero fields and check fields. */
-	if (count->field_type == FIELD_ZERO ||
-	    count->field_type == FIELD_CHECK)
-	  continue;
-
-        /*
-          Count the incidence of every uchar value in the
-          significant field value.
-        */
-	for ( ; pos < end_pos ; pos++)
-	  count->counts[(uchar) *pos]++;
-
-        /* Step to next field. */
-      }
+      tot_blob_length= count_record_statistic(huff_counts, end_count, record,
+                                              null_bytes);
 
       if (tot_blob_length > max_blob_length)
 	max_blob_length=tot_blob_length;
@@ -1149,6 +1048,219 @@ static int get_statistic(PACK_MRG_INFO *mrg,HUFF_COUNTS *huff_counts)
   DBUG_RETURN(error != HA_ERR_END_OF_FILE);
 }
 
+/*
+  Count the column values of one record into the statistics
+
+  SYNOPSIS
+    count_record_statistic()
+    huff_counts                 Statistics of the columns
+    end_count                   End of huff_counts
+    record                      The record
+    null_bytes                  Null bits at the start of the record
+
+  RETURN
+    Total length of the blobs of the record
+*/
+
+static ulong count_record_statistic(HUFF_COUNTS *huff_counts,
+                                    HUFF_COUNTS *end_count, uchar *record,
+                                    uint null_bytes)
+{
+  uint length;
+  ulong tot_blob_length=0;
+  uchar *pos,*next_pos,*end_pos,*start_pos;
+  HUFF_COUNTS *count;
+  TREE_ELEMENT *element;
+
+  /* Count the incidence of values separately for every column. */
+  for (pos=record + null_bytes, count=huff_counts ;
+       count < end_count ;
+       count++,
+       pos=next_pos)
+  {
+    next_pos=end_pos=(start_pos=pos)+count->field_length;
+
+    /*
+      Put the whole column value in a tree if there is room for it.
+      'int_tree' is used to quickly check for duplicate values.
+      'tree_buff' collects as many distinct column values as
+      possible. If the field length is > 1, it is tree_buff_length,
+      else 2 bytes. Each value is 'field_length' bytes big. If there
+      are more distinct column values than fit into the buffer, we
+      give up with this tree. BLOBs and VARCHARs do not have a
+      tree_buff as it can only be used with fixed length columns.
+      For the special case of field length == 1, we handle only the
+      case that there is only one distinct value in the table(s).
+      Otherwise, we can have a maximum of 256 distinct values. This
+      is then handled by the normal Huffman tree build.
+
+      Another limit for collecting distinct column values is the
+      number of values itself. Since we would need to build a
+      Huffman tree for the values, we are limited by the 'IS_OFFSET'
+      constant. This constant expresses a bit which is used to
+      determine if a tree element holds a final value or an offset
+      to a child element. Hence, all values and offsets need to be
+      smaller than 'IS_OFFSET'. A tree element is implemented with
+      two integer values, one for the left branch and one for the
+      right branch. For the extreme case that the first element
+      points to the last element, the number of integers in the tree
+      must be less or equal to IS_OFFSET. So the number of elements
+      must be less or equal to IS_OFFSET / 2.
+
+      WARNING: At first, we insert a pointer into the record buffer
+      as the key for the tree. If we got a new distinct value, which
+      is really inserted into the tree, instead of being counted
+      only, we will copy the column value from the record buffer to
+      'tree_buff' and adjust the key pointer of the tree accordingly.
+    */
+    if (count->tree_buff)
+    {
+      if (!(element=tree_insert(&count->int_tree,pos, 0,
+				count->int_tree.custom_arg)) ||
+	  (element->count == 1 &&
+	   (count->tree_buff + tree_buff_length <
+            count->tree_pos + count->field_length)) ||
+          (count->int_tree.elements_in_tree > IS_OFFSET / 2) ||
+	  (count->field_length == 1 &&
+	   count->int_tree.elements_in_tree > 1))
+      {
+	delete_tree(&count->int_tree);
+	my_free(count->tree_buff);
+	count->tree_buff=0;
+      }
+      else
+      {
+        /*
+          If tree_insert() succeeds, it either creates a new element
+          or increments the counter of an existing element.
+        */
+	if (element->count == 1)
+	{
+          /* Copy the new column value into 'tree_buff'. */
+	  memcpy(count->tree_pos,pos,(size_t) count->field_length);
+          /* Adjust the key pointer in the tree. */
+	  tree_set_pointer(element,count->tree_pos);
+          /* Point behind the last column value so far. */
+	  count->tree_pos+=count->field_length;
+	}
+      }
+    }
+
+    /* Save character counters and space-counts and zero-field-counts */
+    if (count->field_type == FIELD_NORMAL ||
+	count->field_type == FIELD_SKIP_ENDSPACE)
+    {
+      /* Ignore trailing space. */
+      for ( ; end_pos > pos ; end_pos--)
+	if (end_pos[-1] != ' ')
+	  break;
+      /* Empty fields are just counted. Go to the next record. */
+      if (end_pos == pos)
+      {
+	count->empty_fields++;
+	count->max_zero_fill=0;
+	continue;
+      }
+      /*
+        Count the total of all trailing spaces and the number of
+        short trailing spaces. Remember the longest trailing space.
+      */
+      length= (uint) (next_pos-end_pos);
+      count->tot_end_space+=length;
+      if (length < 8)
+	count->end_space[length]++;
+      if (count->max_end_space < length)
+	count->max_end_space = length;
+    }
+
+    if (count->field_type == FIELD_NORMAL ||
+	count->field_type == FIELD_SKIP_PRESPACE)
+    {
+      /* Ignore leading space. */
+      for (pos=start_pos; pos < end_pos ; pos++)
+	if (pos[0] != ' ')
+	  break;
+      /* Empty fields are just counted. Go to the next record. */
+      if (end_pos == pos)
+      {
+	count->empty_fields++;
+	count->max_zero_fill=0;
+	continue;
+      }
+      /*
+        Count the total of all leading spaces and the number of
+        short leading spaces. Remember the longest leading space.
+      */
+      length= (uint) (pos-start_pos);
+      count->tot_pre_space+=length;
+      if (length < 8)
+	count->pre_space[length]++;
+      if (count->max_pre_space < length)
+	count->max_pre_space = length;
+    }
+
+    /* Calculate pos, end_pos, and max_length for variable length fields. */
+    if (count->field_type == FIELD_BLOB)
+    {
+      uint field_length=count->field_length -portable_sizeof_char_ptr;
+      ulong blob_length= _ma_calc_blob_length(field_length, start_pos);
+      memcpy(&pos,  start_pos+field_length,sizeof(char*));
+      end_pos=pos+blob_length;
+      tot_blob_length+=blob_length;
+      set_if_bigger(count->max_length,blob_length);
+    }
+    else if (count->field_type == FIELD_VARCHAR)
+    {
+      uint pack_length= HA_VARCHAR_PACKLENGTH(count->field_length-1);
+      length= (pack_length == 1 ? (uint) *(uchar*) start_pos :
+               uint2korr(start_pos));
+      pos= start_pos+pack_length;
+      end_pos= pos+length;
+      set_if_bigger(count->max_length,length);
+    }
+
+    /* Evaluate 'max_zero_fill' for short fields. */
+    if (count->field_length <= 8 &&
+	(count->field_type == FIELD_NORMAL ||
+	 count->field_type == FIELD_SKIP_ZERO))
+    {
+      uint i;
+      /* Zero fields are just counted. Go to the next record. */
+      if (!memcmp(start_pos, zero_string, count->field_length))
+      {
+	count->zero_fields++;
+	continue;
+      }
+      /*
+        max_zero_fill starts with field_length. It is decreased every
+        time a shorter "zero trailer" is found. It is set to zero when
+        an empty field is found (see above). This suggests that the
+        variable should be called 'min_zero_fill'.
+      */
+      for (i =0 ; i < count->max_zero_fill && ! end_pos[-1 - (int) i] ;
+	   i++) ;
+      if (i < count->max_zero_fill)
+	count->max_zero_fill=i;
+    }
+
+    /* Ignore zero fields and check fields. */
+    if (count->field_type == FIELD_ZERO ||
+	count->field_type == FIELD_CHECK)
+      continue;
+
+    /*
+      Count the incidence of every uchar value in the
+      significant field value.
+    */
+    for ( ; pos < end_pos ; pos++)
+      count->counts[(uchar) *pos]++;
+
+    /* Step to next field. */
+  }
+  return tot_blob_length;
+}
+
+
 static int compare_huff_elements(void *not_used __attribute__((unused)),
 				 uchar *a, uchar *b)
 {
@@ -1663,11 +1775,11 @@ static int make_huff_tree(HUFF_TREE *huff_tree, HUFF_COUNTS *huff_counts)
   return 0;
 }
 
-static int compare_tree(void* cmp_arg __attribute__((unused)),
+static int compare_tree(void* cmp_arg,
 			register const uchar *s, register const uchar *t)
 {
   uint length;
-  for (length=global_count->field_length; length-- ;)
+  for (length=((HUFF_COUNTS*) cmp_arg)->field_length; length-- ;)
     if (*s++ != *t++)
       return (int) s[-1] - (int) t[-1];
   return 0;
@@ -2072,13 +2184,13 @@ static void write_field_info(HUFF_COUNTS *counts, uint fields, uint trees)
   }
   for (i=0 ; i++ < fields ; counts++)
   {
-    write_bits((ulonglong) (int) counts->field_type, 5);
-    write_bits(counts->pack_type,6);
+    write_bits(&file_buffer, (ulonglong) (int) counts->field_type, 5);
+    write_bits(&file_buffer, counts->pack_type,6);
     if (counts->pack_type & PACK_TYPE_ZERO_FILL)
-      write_bits(counts->max_zero_fill,5);
+      write_bits(&file_buffer, counts->max_zero_fill,5);
     else
-      write_bits(counts->length_bits,5);
-    write_bits((ulonglong) counts->tree->tree_number - 1, huff_tree_bits);
+      write_bits(&file_buffer, counts->length_bits,5);
+    write_bits(&file_buffer, (ulonglong) counts->tree->tree_number - 1, huff_tree_bits);
     DBUG_PRINT("info", ("column: %3u  type: %2u  pack: %2u  zero: %4u  "
                         "lbits: %2u  tree: %2u  length: %4u",
                         i , counts->field_type, counts->pack_type,
@@ -2090,7 +2202,7 @@ static void write_field_info(HUFF_COUNTS *counts, uint fields, uint trees)
                   counts->pack_type, counts->max_zero_fill, counts->length_bits,
                   counts->tree->tree_number, counts->field_length);
   }
-  flush_bits();
+  flush_bits(&file_buffer);
   return;
 }
 
@@ -2167,11 +2279,11 @@ static my_off_t write_huff_tree(HUFF_TREE *huff_tree, uint trees)
     if (!huff_tree->counts->tree_buff)
     {
       /* We do a uchar compression on this column. Mark with bit 0. */
-      write_bits(0,1);
-      write_bits(huff_tree->min_chr,8);
-      write_bits(huff_tree->elements,9);
-      write_bits(huff_tree->char_bits,5);
-      write_bits(huff_tree->offset_bits,5);
+      write_bits(&file_buffer, 0,1);
+      write_bits(&file_buffer, huff_tree->min_chr,8);
+      write_bits(&file_buffer, huff_tree->elements,9);
+      write_bits(&file_buffer, huff_tree->char_bits,5);
+      write_bits(&file_buffer, huff_tree->offset_bits,5);
       int_length=0;
     }
     else
@@ -2179,11 +2291,11 @@ static my_off_t write_huff_tree(HUFF_TREE *huff_tree, uint trees)
       int_length=(uint) (huff_tree->counts->tree_pos -
 			 huff_tree->counts->tree_buff);
       /* We have distinct column values for this column. Mark with bit 1. */
-      write_bits(1,1);
-      write_bits(huff_tree->elements,15);
-      write_bits(int_length,16);
-      write_bits(huff_tree->char_bits,5);
-      write_bits(huff_tree->offset_bits,5);
+      write_bits(&file_buffer, 1,1);
+      write_bits(&file_buffer, huff_tree->elements,15);
+      write_bits(&file_buffer, int_length,16);
+      write_bits(&file_buffer, huff_tree->char_bits,5);
+      write_bits(&file_buffer, huff_tree->offset_bits,5);
       intervall_length+=int_length;
     }
     DBUG_PRINT("info", ("tree: %2u  elements: %4u  char_bits: %2u  "
@@ -2213,10 +2325,10 @@ static my_off_t write_huff_tree(HUFF_TREE *huff_tree, uint trees)
     for (i=0 ; i < length ; i++)
     {
       if (packed_tree[i] & IS_OFFSET)
-	write_bits(packed_tree[i] - IS_OFFSET+ (1 << huff_tree->offset_bits),
+	write_bits(&file_buffer, packed_tree[i] - IS_OFFSET+ (1 << huff_tree->offset_bits),
 		   huff_tree->offset_bits+1);
       else
-	write_bits(packed_tree[i]-huff_tree->min_chr,huff_tree->char_bits+1);
+	write_bits(&file_buffer, packed_tree[i]-huff_tree->min_chr,huff_tree->char_bits+1);
       DBUG_PRINT("info", ("tree[0x%04x]: %s0x%04x",
                           i, (packed_tree[i] & IS_OFFSET) ?
                           " -> " : "", (packed_tree[i] & IS_OFFSET) ?
@@ -2227,7 +2339,7 @@ static my_off_t write_huff_tree(HUFF_TREE *huff_tree, uint trees)
                     (packed_tree[i] & IS_OFFSET) ?
                     packed_tree[i] - IS_OFFSET + i : packed_tree[i]);
     }
-    flush_bits();
+    flush_bits(&file_buffer);
 
     /*
       Display coding tables and check their correctness.
@@ -2313,7 +2425,7 @@ static my_off_t write_huff_tree(HUFF_TREE *huff_tree, uint trees)
     {
       for (i=0 ; i < int_length ; i++)
       {
- 	write_bits((ulonglong) (uchar) huff_tree->counts->tree_buff[i], 8);
+ 	write_bits(&file_buffer, (ulonglong) (uchar) huff_tree->counts->tree_buff[i], 8);
         DBUG_PRINT("info", ("column_values[0x%04x]: 0x%02x",
                             i, (uchar) huff_tree->counts->tree_buff[i]));
         if (verbose >= 3)
@@ -2321,7 +2433,7 @@ static my_off_t write_huff_tree(HUFF_TREE *huff_tree, uint trees)
                       i, (uchar) huff_tree->counts->tree_buff[i]);
       }
     }
-    flush_bits();
+    flush_bits(&file_buffer);
   }
   DBUG_PRINT("info", (" "));
   if (verbose >= 2)
@@ -2403,13 +2515,12 @@ static int compress_maria_file(PACK_MRG_INFO *mrg, HUFF_COUNTS *huff_counts)
 {
   int error;
   uint i,max_calc_length,pack_ref_length,min_record_length,max_record_length;
-  uint intervall,field_length,max_pack_length,pack_blob_length, null_bytes;
+  uint max_pack_length,pack_blob_length, null_bytes;
   my_off_t record_count;
   char llbuf[32];
-  ulong length,pack_length;
-  uchar *record,*pos,*end_pos,*record_pos,*start_pos;
-  HUFF_COUNTS *count,*end_count;
-  HUFF_TREE *tree;
+  ulong length;
+  uchar *record;
+  HUFF_COUNTS *end_count;
   MARIA_HA *isam_file=mrg->file[0];
   uint pack_version= (uint) isam_file->s->pack.version;
   DBUG_ENTER("compress_maria_file");
@@ -2461,300 +2572,32 @@ static int compress_maria_file(PACK_MRG_INFO *mrg, HUFF_COUNTS *huff_counts)
 
   DBUG_PRINT("fields", ("==="));
   mrg_reset(mrg);
-  while ((error=mrg_rrnd(mrg,record)) != HA_ERR_END_OF_FILE)
+  if (opt_threads > 1 && mrg->records)
+  {
+    PACK_THREADS threads;
+    bzero((char*) &threads, sizeof(threads));
+    threads.mrg= mrg;
+    threads.huff_counts= huff_counts;
+    threads.compress= 1;
+    threads.pack_version= pack_version;
+    threads.max_calc_length= max_calc_length;
+    threads.max_pack_length= max_pack_length;
+    threads.pack_blob_length= pack_blob_length;
+    error= pack_in_threads(&threads);
+    record_count= threads.records;
+    min_record_length= threads.min_record_length;
+    max_record_length= threads.max_record_length;
+  }
+  else while ((error=mrg_rrnd(mrg,record)) != HA_ERR_END_OF_FILE)
   {
-    ulong tot_blob_length=0;
     if (! error)
     {
-      if (flush_buffer((ulong) max_calc_length + (ulong) max_pack_length +
-                       null_bytes))
+      if (flush_buffer(&file_buffer, (ulong) max_calc_length +
+                       (ulong) max_pack_length + null_bytes))
 	break;
-      record_pos= file_buffer.pos;
-      file_buffer.pos+= max_pack_length;
-      if (null_bytes)
-      {
-        /* Copy null bits 'as is' */
-        memcpy(file_buffer.pos, record, null_bytes);
-        file_buffer.pos+= null_bytes;
-      }
-      for (start_pos=record+null_bytes, count= huff_counts;
-           count < end_count ;
-           count++)
-      {
-	end_pos=start_pos+(field_length=count->field_length);
-	tree=count->tree;
-
-        DBUG_PRINT("fields", ("column: %3lu  type: %2u  pack: %2u  zero: %4u  "
-                              "lbits: %2u  tree: %2u  length: %4u",
-                              (ulong) (count - huff_counts + 1),
-                              count->field_type,
-                              count->pack_type, count->max_zero_fill,
-                              count->length_bits, count->tree->tree_number,
-                              count->field_length));
-
-        /* Check if the column contains spaces only. */
-	if (count->pack_type & PACK_TYPE_SPACE_FIELDS)
-	{
-	  for (pos=start_pos ; *pos == ' ' && pos < end_pos; pos++) ;
-	  if (pos == end_pos)
-	  {
-            DBUG_PRINT("fields",
-                       ("PACK_TYPE_SPACE_FIELDS spaces only, bits:  1"));
-            DBUG_PRINT("fields", ("---"));
-	    write_bits(1,1);
-	    start_pos=end_pos;
-	    continue;
-	  }
-          DBUG_PRINT("fields",
-                     ("PACK_TYPE_SPACE_FIELDS not only spaces, bits:  1"));
-	  write_bits(0,1);
-	}
-	end_pos-=count->max_zero_fill;
-	field_length-=count->max_zero_fill;
-
-	switch (count->field_type) {
-	case FIELD_SKIP_ZERO:
-	  if (!memcmp(start_pos, zero_string, field_length))
-	  {
-            DBUG_PRINT("fields", ("FIELD_SKIP_ZERO zeroes only, bits:  1"));
-	    write_bits(1,1);
-	    start_pos=end_pos;
-	    break;
-	  }
-          DBUG_PRINT("fields", ("FIELD_SKIP_ZERO not only zeroes, bits:  1"));
-	  write_bits(0,1);
-	  /* Fall through */
-	case FIELD_NORMAL:
-          DBUG_PRINT("fields", ("FIELD_NORMAL %lu bytes",
-                                (ulong) (end_pos - start_pos)));
-	  for ( ; start_pos < end_pos ; start_pos++)
-          {
-            DBUG_PRINT("fields",
-                       ("value: 0x%02x  code: 0x%s  bits: %2u  bin: %s",
-                        (uchar) *start_pos,
-                        hexdigits(tree->code[(uchar) *start_pos]),
-                        (uint) tree->code_len[(uchar) *start_pos],
-                        bindigits(tree->code[(uchar) *start_pos],
-                                  (uint) tree->code_len[(uchar) *start_pos])));
-	    write_bits(tree->code[(uchar) *start_pos],
-		       (uint) tree->code_len[(uchar) *start_pos]);
-          }
-	  break;
-	case FIELD_SKIP_ENDSPACE:
-	  for (pos=end_pos ; pos > start_pos && pos[-1] == ' ' ; pos--) ;
-	  length= (ulong) (end_pos - pos);
-	  if (count->pack_type & PACK_TYPE_SELECTED)
-	  {
-	    if (length > count->min_space)
-	    {
-              DBUG_PRINT("fields",
-                         ("FIELD_SKIP_ENDSPACE more than min_space, bits:  1"));
-              DBUG_PRINT("fields",
-                         ("FIELD_SKIP_ENDSPACE skip %lu/%u bytes, bits: %2u",
-                          length, field_length, count->length_bits));
-	      write_bits(1,1);
-	      write_bits(length,count->length_bits);
-	    }
-	    else
-	    {
-              DBUG_PRINT("fields",
-                         ("FIELD_SKIP_ENDSPACE not more than min_space, "
-                          "bits:  1"));
-	      write_bits(0,1);
-	      pos=end_pos;
-	    }
-	  }
-	  else
-          {
-            DBUG_PRINT("fields",
-                       ("FIELD_SKIP_ENDSPACE skip %lu/%u bytes, bits: %2u",
-                        length, field_length, count->length_bits));
-	    write_bits(length,count->length_bits);
-          }
-          /* Encode all significant bytes. */
-          DBUG_PRINT("fields", ("FIELD_SKIP_ENDSPACE %lu bytes",
-                                (ulong) (pos - start_pos)));
-	  for ( ; start_pos < pos ; start_pos++)
-          {
-            DBUG_PRINT("fields",
-                       ("value: 0x%02x  code: 0x%s  bits: %2u  bin: %s",
-                        (uchar) *start_pos,
-                        hexdigits(tree->code[(uchar) *start_pos]),
-                        (uint) tree->code_len[(uchar) *start_pos],
-                        bindigits(tree->code[(uchar) *start_pos],
-                                  (uint) tree->code_len[(uchar) *start_pos])));
-	    write_bits(tree->code[(uchar) *start_pos],
-		       (uint) tree->code_len[(uchar) *start_pos]);
-          }
-	  start_pos=end_pos;
-	  break;
-	case FIELD_SKIP_PRESPACE:
-	  for (pos=start_pos ; pos < end_pos && pos[0] == ' ' ; pos++) ;
-          length= (ulong) (pos - start_pos);
-	  if (count->pack_type & PACK_TYPE_SELECTED)
-	  {
-	    if (length > count->min_space)
-	    {
-              DBUG_PRINT("fields",
-                         ("FIELD_SKIP_PRESPACE more than min_space, bits:  1"));
-              DBUG_PRINT("fields",
-                         ("FIELD_SKIP_PRESPACE skip %lu/%u bytes, bits: %2u",
-                          length, field_length, count->length_bits));
-	      write_bits(1,1);
-	      write_bits(length,count->length_bits);
-	    }
-	    else
-	    {
-              DBUG_PRINT("fields",
-                         ("FIELD_SKIP_PRESPACE not more than min_space, "
-                          "bits:  1"));
-	      pos=start_pos;
-	      write_bits(0,1);
-	    }
-	  }
-	  else
-          {
-            DBUG_PRINT("fields",
-                       ("FIELD_SKIP_PRESPACE skip %lu/%u bytes, bits: %2u",
-                        length, field_length, count->length_bits));
-	    write_bits(length,count->length_bits);
-          }
-          /* Encode all significant bytes. */
-          DBUG_PRINT("fields", ("FIELD_SKIP_PRESPACE %lu bytes",
-                                (ulong) (end_pos - start_pos)));
-	  for (start_pos=pos ; start_pos < end_pos ; start_pos++)
-          {
-            DBUG_PRINT("fields",
-                       ("value: 0x%02x  code: 0x%s  bits: %2u  bin: %s",
-                        (uchar) *start_pos,
-                        hexdigits(tree->code[(uchar) *start_pos]),
-                        (uint) tree->code_len[(uchar) *start_pos],
-                        bindigits(tree->code[(uchar) *start_pos],
-                                  (uint) tree->code_len[(uchar) *start_pos])));
-	    write_bits(tree->code[(uchar) *start_pos],
-		       (uint) tree->code_len[(uchar) *start_pos]);
-          }
-	  break;
-	case FIELD_CONSTANT:
-	case FIELD_ZERO:
-	case FIELD_CHECK:
-          DBUG_PRINT("fields", ("FIELD_CONSTANT/ZERO/CHECK"));
-	  start_pos=end_pos;
-	  break;
-	case FIELD_INTERVALL:
-	  global_count=count;
-	  pos=(uchar*) tree_search(&count->int_tree, start_pos,
-				  count->int_tree.custom_arg);
-	  intervall=(uint) (pos - count->tree_buff)/field_length;
-          DBUG_PRINT("fields", ("FIELD_INTERVALL"));
-          DBUG_PRINT("fields", ("index: %4u code: 0x%s  bits: %2u",
-                                intervall, hexdigits(tree->code[intervall]),
-                                (uint) tree->code_len[intervall]));
-	  write_bits(tree->code[intervall],(uint) tree->code_len[intervall]);
-	  start_pos=end_pos;
-	  break;
-	case FIELD_BLOB:
-	{
-	  ulong blob_length= _ma_calc_blob_length(field_length-
-						 portable_sizeof_char_ptr,
-						 start_pos);
-          /* Empty blobs are encoded with a single 1 bit. */
-	  if (!blob_length)
-	  {
-            DBUG_PRINT("fields", ("FIELD_BLOB empty, bits:  1"));
-            write_bits(1,1);
-	  }
-	  else
-	  {
-	    uchar *blob,*blob_end;
-            DBUG_PRINT("fields", ("FIELD_BLOB not empty, bits:  1"));
-	    write_bits(0,1);
-            /* Write the blob length. */
-            DBUG_PRINT("fields", ("FIELD_BLOB %lu bytes, bits: %2u",
-                                  blob_length, count->length_bits));
-	    write_bits(blob_length,count->length_bits);
-	    memcpy(&blob,end_pos-portable_sizeof_char_ptr, sizeof(char*));
-	    blob_end=blob+blob_length;
-            /* Encode the blob bytes. */
-	    for ( ; blob < blob_end ; blob++)
-            {
-              DBUG_PRINT("fields",
-                         ("value: 0x%02x  code: 0x%s  bits: %2u  bin: %s",
-                          (uchar) *blob, hexdigits(tree->code[(uchar) *blob]),
-                          (uint) tree->code_len[(uchar) *blob],
-                          bindigits(tree->code[(uchar) *start_pos],
-                                    (uint)tree->code_len[(uchar) *start_pos])));
-	      write_bits(tree->code[(uchar) *blob],
-			 (uint) tree->code_len[(uchar) *blob]);
-            }
-	    tot_blob_length+=blob_length;
-	  }
-	  start_pos= end_pos;
-	  break;
-	}
-	case FIELD_VARCHAR:
-	{
-          uint var_pack_length= HA_VARCHAR_PACKLENGTH(count->field_length-1);
-	  ulong col_length= (var_pack_length == 1 ?
-                             (uint) *(uchar*) start_pos :
-                             uint2korr(start_pos));
-          /* Empty varchar are encoded with a single 1 bit. */
-	  if (!col_length)
-	  {
-            DBUG_PRINT("fields", ("FIELD_VARCHAR empty, bits:  1"));
-	    write_bits(1,1);			/* Empty varchar */
-	  }
-	  else
-	  {
-	    uchar *end= start_pos + var_pack_length + col_length;
-            DBUG_PRINT("fields", ("FIELD_VARCHAR not empty, bits:  1"));
-	    write_bits(0,1);
-            /* Write the varchar length. */
-            DBUG_PRINT("fields", ("FIELD_VARCHAR %lu bytes, bits: %2u",
-                                  col_length, count->length_bits));
-	    write_bits(col_length,count->length_bits);
-            /* Encode the varchar bytes. */
-	    for (start_pos+= var_pack_length ; start_pos < end ; start_pos++)
-            {
-              DBUG_PRINT("fields",
-                         ("value: 0x%02x  code: 0x%s  bits: %2u  bin: %s",
-                          (uchar) *start_pos,
-                          hexdigits(tree->code[(uchar) *start_pos]),
-                          (uint) tree->code_len[(uchar) *start_pos],
-                          bindigits(tree->code[(uchar) *start_pos],
-                                    (uint)tree->code_len[(uchar) *start_pos])));
-	      write_bits(tree->code[(uchar) *start_pos],
-			 (uint) tree->code_len[(uchar) *start_pos]);
-            }
-	  }
-	  start_pos= end_pos;
-	  break;
-	}
-	case FIELD_LAST:
-        case FIELD_enum_val_count:
-	  abort();				/* Impossible */
-	}
-	start_pos+=count->max_zero_fill;
-        DBUG_PRINT("fields", ("---"));
-      }
-      flush_bits();
-      length=(ulong) (file_buffer.pos - record_pos) - max_pack_length;
-      pack_length= _ma_save_pack_length(pack_version, record_pos, length);
-      if (pack_blob_length)
-	pack_length+= _ma_save_pack_length(pack_version,
-                                           record_pos + pack_length,
-                                           tot_blob_length);
-      DBUG_PRINT("fields", ("record: %lu  length: %lu  blob-length: %lu  "
-                            "length-bytes: %lu", (ulong) record_count, length,
-                            tot_blob_length, pack_length));
-      DBUG_PRINT("fields", ("==="));
-
-      /* Correct file buffer if the header was smaller */
-      if (pack_length != max_pack_length)
-      {
-	bmove(record_pos+pack_length,record_pos+max_pack_length,length);
-	file_buffer.pos-= (max_pack_length-pack_length);
-      }
+      length= compress_record(&file_buffer, huff_counts, end_count, record,
+                              null_bytes, max_pack_length, pack_blob_length,
+                              pack_version);
       if (length < (ulong) min_record_length)
 	min_record_length=(uint) length;
       if (length > (ulong) max_record_length)
@@ -2782,7 +2625,324 @@ static int compress_maria_file(PACK_MRG_INFO *mrg, HUFF_COUNTS *huff_counts)
   mrg->ref_length=max_pack_length;
   mrg->min_pack_length=max_record_length ? min_record_length : 0;
   mrg->max_pack_length=max_record_length;
-  DBUG_RETURN(error || error_on_write || flush_buffer(~(ulong) 0));
+  DBUG_RETURN(error || error_on_write || flush_buffer(&file_buffer, ~(ulong) 0));
+}
+
+/*
+  Pack one record into a bit buffer
+
+  SYNOPSIS
+    compress_record()
+    buff                        Buffer with room for the packed record
+    huff_counts                 Column statistics and Huffman trees
+    end_count                   End of huff_counts
+    record                      The record to pack
+    null_bytes                  Null bits at the start of the record
+    max_pack_length             Bytes reserved for the record header
+    pack_blob_length            Bytes for the blob length in the header
+    pack_version                Version of the compressed file format
+
+  RETURN
+    Length of the packed record without its header
+*/
+
+static ulong compress_record(struct st_file_buffer *buff,
+                             HUFF_COUNTS *huff_counts, HUFF_COUNTS *end_count,
+                             uchar *record, uint null_bytes,
+                             uint max_pack_length, uint pack_blob_length,
+                             uint pack_version)
+{
+  uint intervall,field_length;
+  ulong length,pack_length,tot_blob_length=0;
+  uchar *pos,*end_pos,*record_pos,*start_pos;
+  HUFF_COUNTS *count;
+  HUFF_TREE *tree;
+
+  record_pos= buff->pos;
+  buff->pos+= max_pack_length;
+  if (null_bytes)
+  {
+    /* Copy null bits 'as is' */
+    memcpy(buff->pos, record, null_bytes);
+    buff->pos+= null_bytes;
+  }
+  for (start_pos=record+null_bytes, count= huff_counts;
+       count < end_count ;
+       count++)
+  {
+    end_pos=start_pos+(field_length=count->field_length);
+    tree=count->tree;
+
+    DBUG_PRINT("fields", ("column: %3lu  type: %2u  pack: %2u  zero: %4u  "
+                          "lbits: %2u  tree: %2u  length: %4u",
+                          (ulong) (count - huff_counts + 1),
+                          count->field_type,
+                          count->pack_type, count->max_zero_fill,
+                          count->length_bits, count->tree->tree_number,
+                          count->field_length));
+
+    /* Check if the column contains spaces only. */
+    if (count->pack_type & PACK_TYPE_SPACE_FIELDS)
+    {
+      for (pos=start_pos ; *pos == ' ' && pos < end_pos; pos++) ;
+      if (pos == end_pos)
+      {
+        DBUG_PRINT("fields",
+                   ("PACK_TYPE_SPACE_FIELDS spaces only, bits:  1"));
+        DBUG_PRINT("fields", ("---"));
+	write_bits(buff, 1,1);
+	start_pos=end_pos;
+	continue;
+      }
+      DBUG_PRINT("fields",
+                 ("PACK_TYPE_SPACE_FIELDS not only spaces, bits:  1"));
+      write_bits(buff, 0,1);
+    }
+    end_pos-=count->max_zero_fill;
+    field_length-=count->max_zero_fill;
+
+    switch (count->field_type) {
+    case FIELD_SKIP_ZERO:
+      if (!memcmp(start_pos, zero_string, field_length))
+      {
+        DBUG_PRINT("fields", ("FIELD_SKIP_ZERO zeroes only, bits:  1"));
+	write_bits(buff, 1,1);
+	start_pos=end_pos;
+	break;
+      }
+      DBUG_PRINT("fields", ("FIELD_SKIP_ZERO not only zeroes, bits:  1"));
+      write_bits(buff, 0,1);
+      /* Fall through */
+    case FIELD_NORMAL:
+      DBUG_PRINT("fields", ("FIELD_NORMAL %lu bytes",
+                            (ulong) (end_pos - start_pos)));
+      for ( ; start_pos < end_pos ; start_pos++)
+      {
+        DBUG_PRINT("fields",
+                   ("value: 0x%02x  code: 0x%s  bits: %2u  bin: %s",
+                    (uchar) *start_pos,
+                    hexdigits(tree->code[(uchar) *start_pos]),
+                    (uint) tree->code_len[(uchar) *start_pos],
+                    bindigits(tree->code[(uchar) *start_pos],
+                              (uint) tree->code_len[(uchar) *start_pos])));
+	write_bits(buff, tree->code[(uchar) *start_pos],
+		   (uint) tree->code_len[(uchar) *start_pos]);
+      }
+      break;
+    case FIELD_SKIP_ENDSPACE:
+      for (pos=end_pos ; pos > start_pos && pos[-1] == ' ' ; pos--) ;
+      length= (ulong) (end_pos - pos);
+      if (count->pack_type & PACK_TYPE_SELECTED)
+      {
+	if (length > count->min_space)
+	{
+          DBUG_PRINT("fields",
+                     ("FIELD_SKIP_ENDSPACE more than min_space, bits:  1"));
+          DBUG_PRINT("fields",
+                     ("FIELD_SKIP_ENDSPACE skip %lu/%u bytes, bits: %2u",
+                      length, field_length, count->length_bits));
+	  write_bits(buff, 1,1);
+	  write_bits(buff, length,count->length_bits);
+	}
+	else
+	{
+          DBUG_PRINT("fields",
+                     ("FIELD_SKIP_ENDSPACE not more than min_space, "
+                      "bits:  1"));
+	  write_bits(buff, 0,1);
+	  pos=end_pos;
+	}
+      }
+      else
+      {
+        DBUG_PRINT("fields",
+                   ("FIELD_SKIP_ENDSPACE skip %lu/%u bytes, bits: %2u",
+                    length, field_length, count->length_bits));
+	write_bits(buff, length,count->length_bits);
+      }
+      /* Encode all significant bytes. */
+      DBUG_PRINT("fields", ("FIELD_SKIP_ENDSPACE %lu bytes",
+                            (ulong) (pos - start_pos)));
+      for ( ; start_pos < pos ; start_pos++)
+      {
+        DBUG_PRINT("fields",
+                   ("value: 0x%02x  code: 0x%s  bits: %2u  bin: %s",
+                    (uchar) *start_pos,
+                    hexdigits(tree->code[(uchar) *start_pos]),
+                    (uint) tree->code_len[(uchar) *start_pos],
+                    bindigits(tree->code[(uchar) *start_pos],
+                              (uint) tree->code_len[(uchar) *start_pos])));
+	write_bits(buff, tree->code[(uchar) *start_pos],
+		   (uint) tree->code_len[(uchar) *start_pos]);
+      }
+      start_pos=end_pos;
+      break;
+    case FIELD_SKIP_PRESPACE:
+      for (pos=start_pos ; pos < end_pos && pos[0] == ' ' ; pos++) ;
+      length= (ulong) (pos - start_pos);
+      if (count->pack_type & PACK_TYPE_SELECTED)
+      {
+	if (length > count->min_space)
+	{
+          DBUG_PRINT("fields",
+                     ("FIELD_SKIP_PRESPACE more than min_space, bits:  1"));
+          DBUG_PRINT("fields",
+                     ("FIELD_SKIP_PRESPACE skip %lu/%u bytes, bits: %2u",
+                      length, field_length, count->length_bits));
+	  write_bits(buff, 1,1);
+	  write_bits(buff, length,count->length_bits);
+	}
+	else
+	{
+          DBUG_PRINT("fields",
+                     ("FIELD_SKIP_PRESPACE not more than min_space, "
+                      "bits:  1"));
+	  pos=start_pos;
+	  write_bits(buff, 0,1);
+	}
+      }
+      else
+      {
+        DBUG_PRINT("fields",
+                   ("FIELD_SKIP_PRESPACE skip %lu/%u bytes, bits: %2u",
+                    length, field_length, count->length_bits));
+	write_bits(buff, length,count->length_bits);
+      }
+      /* Encode all significant bytes. */
+      DBUG_PRINT("fields", ("FIELD_SKIP_PRESPACE %lu bytes",
+                            (ulong) (end_pos - start_pos)));
+      for (start_pos=pos ; start_pos < end_pos ; start_pos++)
+      {
+        DBUG_PRINT("fields",
+                   ("value: 0x%02x  code: 0x%s  bits: %2u  bin: %s",
+                    (uchar) *start_pos,
+                    hexdigits(tree->code[(uchar) *start_pos]),
+                    (uint) tree->code_len[(uchar) *start_pos],
+                    bindigits(tree->code[(uchar) *start_pos],
+                              (uint) tree->code_len[(uchar) *start_pos])));
+	write_bits(buff, tree->code[(uchar) *start_pos],
+		   (uint) tree->code_len[(uchar) *start_pos]);
+      }
+      break;
+    case FIELD_CONSTANT:
+    case FIELD_ZERO:
+    case FIELD_CHECK:
+      DBUG_PRINT("fields", ("FIELD_CONSTANT/ZERO/CHECK"));
+      start_pos=end_pos;
+      break;
+    case FIELD_INTERVALL:
+      pos=(uchar*) tree_search(&count->int_tree, start_pos,
+			      count->int_tree.custom_arg);
+      intervall=(uint) (pos - count->tree_buff)/field_length;
+      DBUG_PRINT("fields", ("FIELD_INTERVALL"));
+      DBUG_PRINT("fields", ("index: %4u code: 0x%s  bits: %2u",
+                            intervall, hexdigits(tree->code[intervall]),
+                            (uint) tree->code_len[intervall]));
+      write_bits(buff, tree->code[intervall],(uint) tree->code_len[intervall]);
+      start_pos=end_pos;
+      break;
+    case FIELD_BLOB:
+    {
+      ulong blob_length= _ma_calc_blob_length(field_length-
+					     portable_sizeof_char_ptr,
+					     start_pos);
+      /* Empty blobs are encoded with a single 1 bit. */
+      if (!blob_length)
+      {
+        DBUG_PRINT("fields", ("FIELD_BLOB empty, bits:  1"));
+        write_bits(buff, 1,1);
+      }
+      else
+      {
+	uchar *blob,*blob_end;
+        DBUG_PRINT("fields", ("FIELD_BLOB not empty, bits:  1"));
+	write_bits(buff, 0,1);
+        /* Write the blob length. */
+        DBUG_PRINT("fields", ("FIELD_BLOB %lu bytes, bits: %2u",
+                              blob_length, count->length_bits));
+	write_bits(buff, blob_length,count->length_bits);
+	memcpy(&blob,end_pos-portable_sizeof_char_ptr, sizeof(char*));
+	blob_end=blob+blob_length;
+        /* Encode the blob bytes. */
+	for ( ; blob < blob_end ; blob++)
+        {
+          DBUG_PRINT("fields",
+                     ("value: 0x%02x  code: 0x%s  bits: %2u  bin: %s",
+                      (uchar) *blob, hexdigits(tree->code[(uchar) *blob]),
+                      (uint) tree->code_len[(uchar) *blob],
+                      bindigits(tree->code[(uchar) *start_pos],
+                                (uint)tree->code_len[(uchar) *start_pos])));
+	  write_bits(buff, tree->code[(uchar) *blob],
+		     (uint) tree->code_len[(uchar) *blob]);
+        }
+	tot_blob_length+=blob_length;
+      }
+      start_pos= end_pos;
+      break;
+    }
+    case FIELD_VARCHAR:
+    {
+      uint var_pack_length= HA_VARCHAR_PACKLENGTH(count->field_length-1);
+      ulong col_length= (var_pack_length == 1 ?
+                         (uint) *(uchar*) start_pos :
+                         uint2korr(start_pos));
+      /* Empty varchar are encoded with a single 1 bit. */
+      if (!col_length)
+      {
+        DBUG_PRINT("fields", ("FIELD_VARCHAR empty, bits:  1"));
+	write_bits(buff, 1,1);			/* Empty varchar */
+      }
+      else
+      {
+	uchar *end= start_pos + var_pack_length + col_length;
+        DBUG_PRINT("fields", ("FIELD_VARCHAR not empty, bits:  1"));
+	write_bits(buff, 0,1);
+        /* Write the varchar length. */
+        DBUG_PRINT("fields", ("FIELD_VARCHAR %lu bytes, bits: %2u",
+                              col_length, count->length_bits));
+	write_bits(buff, col_length,count->length_bits);
+        /* Encode the varchar bytes. */
+	for (start_pos+= var_pack_length ; start_pos < end ; start_pos++)
+        {
+          DBUG_PRINT("fields",
+                     ("value: 0x%02x  code: 0x%s  bits: %2u  bin: %s",
+                      (uchar) *start_pos,
+                      hexdigits(tree->code[(uchar) *start_pos]),
+                      (uint) tree->code_len[(uchar) *start_pos],
+                      bindigits(tree->code[(uchar) *start_pos],
+                                (uint)tree->code_len[(uchar) *start_pos])));
+	  write_bits(buff, tree->code[(uchar) *start_pos],
+		     (uint) tree->code_len[(uchar) *start_pos]);
+        }
+      }
+      start_pos= end_pos;
+      break;
+    }
+    case FIELD_LAST:
+    case FIELD_enum_val_count:
+      abort();				/* Impossible */
+    }
+    start_pos+=count->max_zero_fill;
+    DBUG_PRINT("fields", ("---"));
+  }
+  flush_bits(buff);
+  length=(ulong) (buff->pos - record_pos) - max_pack_length;
+  pack_length= _ma_save_pack_length(pack_version, record_pos, length);
+  if (pack_blob_length)
+    pack_length+= _ma_save_pack_length(pack_version,
+                                       record_pos + pack_length,
+                                       tot_blob_length);
+  DBUG_PRINT("fields", ("length: %lu  blob-length: %lu  length-bytes: %lu",
+                        length, tot_blob_length, pack_length));
+  DBUG_PRINT("fields", ("==="));
+
+  /* Correct file buffer if the header was smaller */
+  if (pack_length != max_pack_length)
+  {
+    bmove(record_pos+pack_length,record_pos+max_pack_length,length);
+    buff->pos-= (max_pack_length-pack_length);
+  }
+  return length;
 }
 
 
@@ -2805,6 +2965,7 @@ static void init_file_buffer(File file, pbool read_buffer)
 					 MYF(MY_WME));
   file_buffer.end=file_buffer.buffer+ALIGN_SIZE(RECORD_CACHE_SIZE)-8;
   file_buffer.pos_in_file=0;
+  file_buffer.in_memory=0;
   error_on_write=0;
   if (read_buffer)
   {
@@ -2821,31 +2982,45 @@ static void init_file_buffer(File file, pbool read_buffer)
 }
 
 
-static int flush_buffer(ulong neaded_length)
+static int flush_buffer(struct st_file_buffer *buff, ulong neaded_length)
 {
   ulong length;
 
   /*
-    file_buffer.end is 8 bytes lower than the real end of the buffer.
+    buff->end is 8 bytes lower than the real end of the buffer.
     This is done so that the end-of-buffer condition does not need to be
     checked for every uchar (see write_bits()). Consequently,
-    file_buffer.pos can become greater than file_buffer.end. The
+    buff->pos can become greater than buff->end. The
     algorithms in the other functions ensure that there will never be
     more than 8 bytes written to the buffer without an end-of-buffer
     check. So the buffer cannot be overrun. But we need to check for the
     near-to-buffer-end condition to avoid a negative result, which is
     casted to unsigned and thus becomes giant.
   */
-  if ((file_buffer.pos < file_buffer.end) &&
-      ((ulong) (file_buffer.end - file_buffer.pos) > neaded_length))
+  if ((buff->pos < buff->end) &&
+      ((ulong) (buff->end - buff->pos) > neaded_length))
+    return 0;
+  length=(ulong) (buff->pos-buff->buffer);
+  if (buff->in_memory)
+  {
+    /* The buffer of a compression thread grows instead of being written */
+    ulong size= (ulong) (buff->end - buff->buffer + 8) * 2;
+    uchar *tmp;
+    if (neaded_length != ~(ulong) 0)
+      set_if_bigger(size, length + neaded_length + 256);
+    if (!(tmp= (uchar*) my_realloc(buff->buffer, size, MYF(MY_WME))))
+      return 1;
+    buff->buffer= tmp;
+    buff->pos=    tmp + length;
+    buff->end=    tmp + size - 8;
     return 0;
-  length=(ulong) (file_buffer.pos-file_buffer.buffer);
-  file_buffer.pos=file_buffer.buffer;
-  file_buffer.pos_in_file+=length;
+  }
+  buff->pos=buff->buffer;
+  buff->pos_in_file+=length;
   if (test_only)
     return 0;
-  if (error_on_write|| my_write(file_buffer.file,
-				(const uchar*) file_buffer.buffer,
+  if (error_on_write|| my_write(buff->file,
+				(const uchar*) buff->buffer,
 				length,
 				MYF(MY_WME | MY_NABP | MY_WAIT_IF_FULL)))
   {
@@ -2854,16 +3029,16 @@ static int flush_buffer(ulong neaded_length)
   }
 
   if (neaded_length != ~(ulong) 0 &&
-      (ulong) (file_buffer.end-file_buffer.buffer) < neaded_length)
+      (ulong) (buff->end-buff->buffer) < neaded_length)
   {
     uchar *tmp;
     neaded_length+=256;				/* some margin */
-    tmp= (uchar*) my_realloc(file_buffer.buffer, neaded_length,MYF(MY_WME));
+    tmp= (uchar*) my_realloc(buff->buffer, neaded_length,MYF(MY_WME));
     if (!tmp)
       return 1;
-    file_buffer.pos=    (tmp + (ulong) (file_buffer.pos - file_buffer.buffer));
-    file_buffer.buffer= tmp;
-    file_buffer.end=    (tmp+neaded_length-8);
+    buff->pos=    (tmp + (ulong) (buff->pos - buff->buffer));
+    buff->buffer= tmp;
+    buff->end=    (tmp+neaded_length-8);
   }
   return 0;
 }
@@ -2876,61 +3051,453 @@ static void end_file_buffer(void)
 
 	/* output `bits` low bits of `value' */
 
-static void write_bits(register ulonglong value, register uint bits)
+static void write_bits(struct st_file_buffer *buff,
+                       register ulonglong value, register uint bits)
 {
   DBUG_ASSERT(((bits < 8 * sizeof(value)) && ! (value >> bits)) ||
               (bits == 8 * sizeof(value)));
 
-  if ((file_buffer.bits-= (int) bits) >= 0)
+  if ((buff->bits-= (int) bits) >= 0)
   {
-    file_buffer.bitbucket|= value << file_buffer.bits;
+    buff->bitbucket|= value << buff->bits;
   }
   else
   {
     reg3 ulonglong bit_buffer;
-    bits= (uint) -file_buffer.bits;
-    bit_buffer= (file_buffer.bitbucket |
+    bits= (uint) -buff->bits;
+    bit_buffer= (buff->bitbucket |
                  ((bits != 8 * sizeof(value)) ? (value >> bits) : 0));
 #if BITS_SAVED == 64
-    *file_buffer.pos++= (uchar) (bit_buffer >> 56);
-    *file_buffer.pos++= (uchar) (bit_buffer >> 48);
-    *file_buffer.pos++= (uchar) (bit_buffer >> 40);
-    *file_buffer.pos++= (uchar) (bit_buffer >> 32);
+    *buff->pos++= (uchar) (bit_buffer >> 56);
+    *buff->pos++= (uchar) (bit_buffer >> 48);
+    *buff->pos++= (uchar) (bit_buffer >> 40);
+    *buff->pos++= (uchar) (bit_buffer >> 32);
 #endif
-    *file_buffer.pos++= (uchar) (bit_buffer >> 24);
-    *file_buffer.pos++= (uchar) (bit_buffer >> 16);
-    *file_buffer.pos++= (uchar) (bit_buffer >> 8);
-    *file_buffer.pos++= (uchar) (bit_buffer);
+    *buff->pos++= (uchar) (bit_buffer >> 24);
+    *buff->pos++= (uchar) (bit_buffer >> 16);
+    *buff->pos++= (uchar) (bit_buffer >> 8);
+    *buff->pos++= (uchar) (bit_buffer);
 
     if (bits != 8 * sizeof(value))
       value&= (((ulonglong) 1) << bits) - 1;
-    if (file_buffer.pos >= file_buffer.end)
-      flush_buffer(~ (ulong) 0);
-    file_buffer.bits=(int) (BITS_SAVED - bits);
-    file_buffer.bitbucket= value << (BITS_SAVED - bits);
+    if (buff->pos >= buff->end)
+      flush_buffer(buff, ~ (ulong) 0);
+    buff->bits=(int) (BITS_SAVED - bits);
+    buff->bitbucket= value << (BITS_SAVED - bits);
   }
   return;
 }
 
 	/* Flush bits in bit_buffer to buffer */
 
-static void flush_bits(void)
+static void flush_bits(struct st_file_buffer *buff)
 {
   int bits;
   ulonglong bit_buffer;
 
-  bits= file_buffer.bits & ~7;
-  bit_buffer= file_buffer.bitbucket >> bits;
+  bits= buff->bits & ~7;
+  bit_buffer= buff->bitbucket >> bits;
   bits= BITS_SAVED - bits;
   while (bits > 0)
   {
     bits-= 8;
-    *file_buffer.pos++= (uchar) (bit_buffer >> bits);
+    *buff->pos++= (uchar) (bit_buffer >> bits);
   }
-  if (file_buffer.pos >= file_buffer.end)
-    flush_buffer(~ (ulong) 0);
-  file_buffer.bits= BITS_SAVED;
-  file_buffer.bitbucket= 0;
+  if (buff->pos >= buff->end)
+    flush_buffer(buff, ~ (ulong) 0);
+  buff->bits= BITS_SAVED;
+  buff->bitbucket= 0;
+}
+
+
+/****************************************************************************
+** functions to read and pack the rows in several threads
+****************************************************************************/
+
+	/* Copy the blobs of a row, as they are in the buffer of the table */
+
+static my_bool copy_blobs(MARIA_HA *info, uchar *record, MEM_ROOT *blob_root)
+{
+  MARIA_BLOB *blob,*end;
+
+  for (blob=info->blobs, end=blob+info->s->base.blobs ; blob < end ; blob++)
+  {
+    uchar *pos=record+blob->offset,*data;
+    ulong length=_ma_calc_blob_length(blob->pack_length,pos);
+    if (!length)
+      continue;
+    memcpy(&data,pos+blob->pack_length,sizeof(char*));
+    if (!(data=(uchar*) memdup_root(blob_root,data,length)))
+      return 1;
+    memcpy(pos+blob->pack_length,&data,sizeof(char*));
+  }
+  return 0;
+}
+
+
+	/* Gather the statistics of the rows of a batch */
+
+static void count_batch(PACK_WORKER *worker, PACK_BATCH *batch)
+{
+  PACK_THREADS *threads=worker->threads;
+  MARIA_HA *isam_file=threads->mrg->file[0];
+  HUFF_COUNTS *end_count=worker->huff_counts+isam_file->s->base.fields;
+  ulong reclength=isam_file->s->base.reclength;
+  uchar *record,*end=batch->records+batch->rows*reclength;
+
+  for (record=batch->records ; record < end ; record+=reclength)
+  {
+    ulong tot_blob_length;
+    worker->crc+= (*threads->calc_checksum)(isam_file,record);
+    tot_blob_length=count_record_statistic(worker->huff_counts,end_count,
+                                           record,
+                                           isam_file->s->base.null_bytes);
+    set_if_bigger(worker->max_blob_length,tot_blob_length);
+  }
+}
+
+
+	/* Pack the rows of a batch into the buffer of the batch */
+
+static void compress_batch(PACK_THREADS *threads, PACK_BATCH *batch)
+{
+  MARIA_HA *isam_file=threads->mrg->file[0];
+  HUFF_COUNTS *end_count=threads->huff_counts+isam_file->s->base.fields;
+  ulong reclength=isam_file->s->base.reclength;
+  uint null_bytes=isam_file->s->base.null_bytes;
+  uchar *record,*end=batch->records+batch->rows*reclength;
+
+  batch->buff.pos=batch->buff.buffer;
+  batch->buff.bits=BITS_SAVED;
+  batch->buff.bitbucket=0;
+  batch->min_record_length= (uint) ~0;
+  batch->max_record_length=0;
+  for (record=batch->records ; record < end ; record+=reclength)
+  {
+    ulong length;
+    if (flush_buffer(&batch->buff,(ulong) threads->max_calc_length +
+                     (ulong) threads->max_pack_length + null_bytes))
+    {
+      batch->error=1;
+      break;
+    }
+    length=compress_record(&batch->buff,threads->huff_counts,end_count,
+                           record,null_bytes,threads->max_pack_length,
+                           threads->pack_blob_length,threads->pack_version);
+    set_if_smaller(batch->min_record_length,(uint) length);
+    set_if_bigger(batch->max_record_length,(uint) length);
+  }
+}
+
+
+static pthread_handler_t pack_worker_thread(void *arg)
+{
+  PACK_WORKER *worker= (PACK_WORKER*) arg;
+  PACK_THREADS *threads=worker->threads;
+
+  my_thread_init();
+  pthread_mutex_lock(&threads->lock);
+  for (;;)
+  {
+    PACK_BATCH *batch;
+    while (threads->started == threads->filled && !threads->end_of_file)
+      pthread_cond_wait(&threads->cond,&threads->lock);
+    if (threads->started == threads->filled)
+      break;
+    batch=threads->batch + threads->started++ % threads->batches;
+    pthread_mutex_unlock(&threads->lock);
+
+    if (threads->compress)
+      compress_batch(threads,batch);
+    else
+      count_batch(worker,batch);
+
+    pthread_mutex_lock(&threads->lock);
+    batch->done=1;
+    pthread_cond_broadcast(&threads->cond);
+  }
+  pthread_mutex_unlock(&threads->lock);
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+/*
+  Wait for a worker to be done with a batch and take its result.
+  Packed rows are added to the file buffer, so the batches must be
+  ended in the order they were read.
+*/
+
+static int end_pack_batch(PACK_THREADS *threads, PACK_BATCH *batch)
+{
+  pthread_mutex_lock(&threads->lock);
+  while (!batch->done)
+    pthread_cond_wait(&threads->cond,&threads->lock);
+  pthread_mutex_unlock(&threads->lock);
+  if (batch->error)
+    return HA_ERR_OUT_OF_MEM;
+
+  if (threads->compress)
+  {
+    ulong length= (ulong) (batch->buff.pos - batch->buff.buffer);
+    if (test_only)
+      file_buffer.pos_in_file+=length;
+    else
+    {
+      if (flush_buffer(&file_buffer,length))
+        return my_errno ? my_errno : HA_ERR_OUT_OF_MEM;
+      memcpy(file_buffer.pos,batch->buff.buffer,length);
+      file_buffer.pos+=length;
+    }
+    set_if_smaller(threads->min_record_length,batch->min_record_length);
+    set_if_bigger(threads->max_record_length,batch->max_record_length);
+  }
+  threads->records+=batch->rows;
+  if (write_loop &&
+      threads->records / WRITE_COUNT !=
+      (threads->records - batch->rows) / WRITE_COUNT)
+  {
+    printf("%lu\r", (ulong) threads->records);
+    fflush(stdout);
+  }
+  return 0;
+}
+
+
+	/* Add a distinct column value found by a worker to the main tree */
+
+static int merge_tree_value(uchar *key, element_count count,
+                            HUFF_COUNTS *huff_counts)
+{
+  TREE_ELEMENT *element;
+
+  if (!(element=tree_insert(&huff_counts->int_tree,key,0,
+                            huff_counts->int_tree.custom_arg)))
+    return 1;
+  if (element->count == 1)
+  {
+    /* Same limits as in count_record_statistic() */
+    if ((huff_counts->tree_buff + tree_buff_length <
+         huff_counts->tree_pos + huff_counts->field_length) ||
+        (huff_counts->int_tree.elements_in_tree > IS_OFFSET / 2) ||
+        (huff_counts->field_length == 1 &&
+         huff_counts->int_tree.elements_in_tree > 1))
+      return 1;
+    memcpy(huff_counts->tree_pos,key,(size_t) huff_counts->field_length);
+    tree_set_pointer(element,huff_counts->tree_pos);
+    huff_counts->tree_pos+=huff_counts->field_length;
+  }
+  element->count+= count - 1;
+  return 0;
+}
+
+
+	/* Add the statistics of a worker to the main statistics */
+
+static void merge_huff_counts(HUFF_COUNTS *count, HUFF_COUNTS *from,
+                              uint fields)
+{
+  HUFF_COUNTS *end_count=count+fields;
+  uint i;
+
+  for ( ; count < end_count ; count++, from++)
+  {
+    for (i=0 ; i < 256 ; i++)
+      count->counts[i]+=from->counts[i];
+    for (i=0 ; i < 8 ; i++)
+    {
+      count->end_space[i]+=from->end_space[i];
+      count->pre_space[i]+=from->pre_space[i];
+    }
+    count->tot_end_space+=from->tot_end_space;
+    count->tot_pre_space+=from->tot_pre_space;
+    count->zero_fields+=from->zero_fields;
+    count->empty_fields+=from->empty_fields;
+    set_if_bigger(count->max_end_space,from->max_end_space);
+    set_if_bigger(count->max_pre_space,from->max_pre_space);
+    set_if_bigger(count->max_length,from->max_length);
+    /* max_zero_fill is the shortest zero trailer of all values */
+    set_if_smaller(count->max_zero_fill,from->max_zero_fill);
+
+    if (count->tree_buff &&
+        (!from->tree_buff ||
+         tree_walk(&from->int_tree,(tree_walk_action) merge_tree_value,
+                   count,left_root_right)))
+    {
+      delete_tree(&count->int_tree);
+      my_free(count->tree_buff);
+      count->tree_buff=0;
+    }
+  }
+}
+
+
+/*
+  Read all rows and let --threads threads gather the statistics of them
+  or pack them
+
+  RETURN
+    HA_ERR_END_OF_FILE  All rows were read and handled
+    #                   Error number
+*/
+
+static int pack_in_threads(PACK_THREADS *threads)
+{
+  PACK_MRG_INFO *mrg=threads->mrg;
+  MARIA_HA *isam_file=mrg->file[0];
+  uint fields=isam_file->s->base.fields;
+  ulong reclength=isam_file->s->base.reclength;
+  ulong ended=0;
+  uint i,workers=0;
+  int error=0;
+  pthread_attr_t thr_attr;
+  DBUG_ENTER("pack_in_threads");
+
+  pthread_mutex_init(&threads->lock,MY_MUTEX_INIT_FAST);
+  pthread_cond_init(&threads->cond,0);
+  threads->batches=opt_threads*2;
+  threads->max_rows= (uint) MY_MAX(PACK_BATCH_SIZE / reclength, 1);
+  threads->min_record_length= (uint) ~0;
+  if (!(threads->batch= (PACK_BATCH*)
+        my_malloc(threads->batches*sizeof(PACK_BATCH),
+                  MYF(MY_WME | MY_ZEROFILL))) ||
+      !(threads->worker= (PACK_WORKER*)
+        my_malloc(opt_threads*sizeof(PACK_WORKER),
+                  MYF(MY_WME | MY_ZEROFILL))))
+  {
+    error=HA_ERR_OUT_OF_MEM;
+    goto end;
+  }
+  for (i=0 ; i < threads->batches ; i++)
+  {
+    PACK_BATCH *batch=threads->batch+i;
+    init_alloc_root(&batch->blob_root,65536,0,MYF(0));
+    batch->buff.in_memory=1;
+    if (!(batch->records= (uchar*) my_malloc(threads->max_rows*reclength,
+                                             MYF(MY_WME))))
+    {
+      error=HA_ERR_OUT_OF_MEM;
+      goto end;
+    }
+    if (threads->compress)
+    {
+      if (!(batch->buff.buffer= (uchar*) my_malloc(PACK_BATCH_SIZE,
+                                                   MYF(MY_WME))))
+      {
+        error=HA_ERR_OUT_OF_MEM;
+        goto end;
+      }
+      batch->buff.end=batch->buff.buffer+PACK_BATCH_SIZE-8;
+    }
+  }
+
+  (void) pthread_attr_init(&thr_attr);
+  for ( ; workers < opt_threads ; workers++)
+  {
+    PACK_WORKER *worker=threads->worker+workers;
+    worker->threads=threads;
+    if ((!threads->compress &&
+         !(worker->huff_counts=init_huff_count(isam_file,mrg->records))) ||
+        pthread_create(&worker->thread,&thr_attr,pack_worker_thread,
+                       (void*) worker))
+      break;
+  }
+  (void) pthread_attr_destroy(&thr_attr);
+  if (!workers)
+  {
+    error=HA_ERR_OUT_OF_MEM;
+    goto end;
+  }
+
+  /* Read the rows into the batches and hand them to the workers */
+  while (!error)
+  {
+    PACK_BATCH *batch=threads->batch + threads->filled % threads->batches;
+    if (threads->filled - ended == threads->batches &&
+        (error=end_pack_batch(threads,batch)))
+      break;
+    ended+= threads->filled - ended == threads->batches;
+
+    batch->rows=0;
+    batch->done=batch->error=0;
+    free_root(&batch->blob_root,MYF(MY_MARK_BLOCKS_FREE));
+    while (batch->rows < threads->max_rows)
+    {
+      uchar *record=batch->records+batch->rows*reclength;
+      if ((error=mrg_rrnd(mrg,record)))
+      {
+        if (error == HA_ERR_RECORD_DELETED)
+        {
+          error=0;
+          continue;
+        }
+        break;
+      }
+      if (copy_blobs(isam_file,record,&batch->blob_root))
+      {
+        error=HA_ERR_OUT_OF_MEM;
+        break;
+      }
+      batch->rows++;
+    }
+    if (batch->rows)
+    {
+      pthread_mutex_lock(&threads->lock);
+      threads->filled++;
+      pthread_cond_broadcast(&threads->cond);
+      pthread_mutex_unlock(&threads->lock);
+    }
+  }
+
+  pthread_mutex_lock(&threads->lock);
+  threads->end_of_file=1;
+  pthread_cond_broadcast(&threads->cond);
+  pthread_mutex_unlock(&threads->lock);
+  for ( ; ended < threads->filled && error == HA_ERR_END_OF_FILE ; ended++)
+  {
+    int tmp;
+    if ((tmp=end_pack_batch(threads,threads->batch +
+                            ended % threads->batches)))
+      error=tmp;
+  }
+  for (i=0 ; i < workers ; i++)
+    pthread_join(threads->worker[i].thread,NULL);
+
+  if (!threads->compress && error == HA_ERR_END_OF_FILE)
+  {
+    for (i=0 ; i < workers ; i++)
+    {
+      PACK_WORKER *worker=threads->worker+i;
+      merge_huff_counts(threads->huff_counts,worker->huff_counts,fields);
+      threads->crc+=worker->crc;
+      set_if_bigger(threads->max_blob_length,worker->max_blob_length);
+    }
+  }
+
+end:
+  if (threads->worker)
+  {
+    for (i=0 ; i < opt_threads ; i++)
+    {
+      if (threads->worker[i].huff_counts)
+        free_huff_counts(threads->worker[i].huff_counts,fields);
+    }
+    my_free(threads->worker);
+  }
+  if (threads->batch)
+  {
+    for (i=0 ; i < threads->batches ; i++)
+    {
+      my_free(threads->batch[i].records);
+      my_free(threads->batch[i].buff.buffer);
+      free_root(&threads->batch[i].blob_root,MYF(0));
+    }
+    my_free(threads->batch);
+  }
+  pthread_cond_destroy(&threads->cond);
+  pthread_mutex_destroy(&threads->lock);
+  DBUG_RETURN(error);
 }
 
 
@@ -59,7 +59,7 @@ struct st_ma_transaction
 #define TRANSACTION_LOGGED_LONG_ID 0x8000000000000000ULL
 #define MAX_TRID (~(TrID)0)
 
-extern WT_RESOURCE_TYPE ma_rc_dup_unique;
+extern WT_RESOURCE_TYPE ma_rc_dup_unique, ma_rc_auto_increment;
 
 #ifdef HAVE_PSI_INTERFACE
 extern PSI_mutex_key key_LOCK_trn_list, key_TRN_state_lock;
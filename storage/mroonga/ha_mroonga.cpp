@@ -354,6 +354,11 @@ static const char *mrn_inspect_thr_lock_type(enum thr_lock_type lock_type)
   case TL_WRITE_CONCURRENT_INSERT:
     inspected = "TL_WRITE_CONCURRENT_INSERT";
     break;
+#ifdef MRN_HAVE_TL_WRITE_CONCURRENT_UPDATE
+  case TL_WRITE_CONCURRENT_UPDATE:
+    inspected = "TL_WRITE_CONCURRENT_UPDATE";
+    break;
+#endif
 #ifdef MRN_HAVE_TL_WRITE_DELAYED
   case TL_WRITE_DELAYED:
     inspected = "TL_WRITE_DELAYED";
@@ -131,6 +131,10 @@ extern "C" {
 #  define MRN_HAVE_TL_WRITE_CONCURRENT_DEFAULT
 #endif
 
+#ifdef MRN_MARIADB_P
+#  define MRN_HAVE_TL_WRITE_CONCURRENT_UPDATE
+#endif
+
 #ifdef MRN_MARIADB_P
 #  define MRN_HANDLER_AUTO_REPAIR_HAVE_ERROR
 #endif
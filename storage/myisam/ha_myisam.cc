@@ -83,6 +83,11 @@ static MYSQL_THDVAR_ULONGLONG(sort_buffer_size, PLUGIN_VAR_RQCMDARG,
 static MYSQL_SYSVAR_BOOL(use_mmap, opt_myisam_use_mmap, PLUGIN_VAR_NOCMDARG,
   "Use memory mapping for reading and writing MyISAM tables", NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_BOOL(mmap_index, myisam_mmap_index, PLUGIN_VAR_NOCMDARG,
+  "Memory map the index files of compressed (myisampack) tables and "
+  "search their index pages in the mapping instead of the key cache. "
+  "Takes effect when a table is opened", NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_ULONGLONG(mmap_size, myisam_mmap_size,
   PLUGIN_VAR_RQCMDARG|PLUGIN_VAR_READONLY, "Restricts the total memory "
   "used for memory mapping of MySQL tables", NULL, NULL,
@@ -1113,6 +1118,16 @@ int ha_myisam::repair(THD *thd, HA_CHECK &param, bool do_optimize)
     }
   }
 
+#ifdef HAVE_MMAP
+  /*
+    Repair and sorting of the index write or replace the index file with
+    file I/O. Don't keep a mapping of the old file.
+  */
+  bool remap_index= MY_TEST(share->index_map);
+  if (remap_index)
+    _mi_unmap_index(file);
+#endif
+
   if (!do_optimize ||
       ((file->state->del || share->state.split != file->state->records) &&
        (!(param.testflag & T_QUICK) ||
@@ -1233,6 +1248,10 @@ int ha_myisam::repair(THD *thd, HA_CHECK &param, bool do_optimize)
     update_state_info(&param, file, 0);
   }
   thd_proc_info(thd, old_proc_info);
+#ifdef HAVE_MMAP
+  if (remap_index && !error)
+    (void) _mi_memmap_index(file);
+#endif
   if (locking)
     mi_lock_database(file,F_UNLCK);
   DBUG_RETURN(error ? HA_ADMIN_FAILED :
@@ -1720,6 +1739,8 @@ int ha_myisam::index_end()
   active_index=MAX_KEY;
   //pushed_idx_cond_keyno= MAX_KEY;
   mi_set_index_cond_func(file, NULL, 0);
+  if (file->opt_flag & INDEX_MAP_SCAN_USED)
+    _mi_memmap_index_scan(file, 0);
   in_range_check_pushed_down= FALSE;
   ds_mrr.dsmrr_close();
 #if !defined(DBUG_OFF) && defined(SQL_SELECT_FIXED_FOR_UPDATE)
@@ -2266,6 +2287,7 @@ static struct st_mysql_sys_var* myisam_sysvars[]= {
   MYSQL_SYSVAR(repair_threads),
   MYSQL_SYSVAR(sort_buffer_size),
   MYSQL_SYSVAR(use_mmap),
+  MYSQL_SYSVAR(mmap_index),
   MYSQL_SYSVAR(mmap_size),
   MYSQL_SYSVAR(stats_method),
   0
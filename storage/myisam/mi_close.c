@@ -31,6 +31,8 @@ int mi_close(register MI_INFO *info)
 		      (long) info, (uint) share->reopen,
                       (uint) share->tot_locks));
 
+  if (info->opt_flag & INDEX_MAP_SCAN_USED)
+    _mi_memmap_index_scan(info, 0);
   if (info->open_list.data)
     mysql_mutex_lock(&THR_LOCK_myisam);
   if (info->lock_type == F_EXTRA_LCK)
@@ -95,6 +97,8 @@ int mi_close(register MI_INFO *info)
       else
         mi_munmap_file(info);
     }
+    if (share->index_map)
+      _mi_unmap_index(info);
 #endif
     if (share->decode_trees)
     {
@@ -463,6 +463,8 @@ int mi_reset(MI_INFO *info)
     madvise((char*) share->file_map, share->state.state.data_file_length,
             MADV_RANDOM);
 #endif
+  if (info->opt_flag & INDEX_MAP_SCAN_USED)
+    _mi_memmap_index_scan(info, 0);
   info->opt_flag&= ~(KEY_READ_USED | REMEMBER_OLD_POS);
   info->quick_mode=0;
   info->lastinx= 0;			/* Use first index as def */
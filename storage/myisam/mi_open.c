@@ -569,6 +569,14 @@ MI_INFO *mi_open(const char *name, int mode, uint open_flags)
       info.s= share;
       mi_extra(&info, HA_EXTRA_MMAP, 0);
     }
+#ifdef HAVE_MMAP
+    /* The index of a compressed table never changes; search it mapped */
+    if (myisam_mmap_index && (share->options & HA_OPTION_COMPRESS_RECORD))
+    {
+      info.s= share;
+      (void) _mi_memmap_index(&info);
+    }
+#endif
   }
   else
   {
@@ -1562,6 +1562,153 @@ void _mi_unmap_file(MI_INFO *info)
 }
 
 
+/*
+  Map the index file of a compressed table
+
+  SYNOPSIS
+    _mi_memmap_index()
+    info                MyISAM handler
+
+  DESCRIPTION
+    Compressed tables are read only, so their index pages never change
+    while the table is open. _mi_fetch_keypage() searches the pages
+    directly in the mapping instead of going through the key cache.
+    The mapping counts against myisam_mmap_size like the mapping of
+    the data file.
+
+  RETURN
+    0  Index is not mapped
+    1  ok
+*/
+
+my_bool _mi_memmap_index(MI_INFO *info)
+{
+  MYISAM_SHARE *share= info->s;
+  my_off_t key_file_length= share->state.state.key_file_length;
+  my_bool eom;
+  uchar *map;
+  DBUG_ENTER("_mi_memmap_index");
+  DBUG_ASSERT(share->options & HA_OPTION_COMPRESS_RECORD);
+
+  if (share->index_map)
+    DBUG_RETURN(1);
+  if (key_file_length <= share->base.keystart ||
+      key_file_length > (my_off_t) (~((size_t) 0)))
+    DBUG_RETURN(0);
+
+  if (myisam_mmap_size != SIZE_T_MAX)
+  {
+    mysql_mutex_lock(&THR_LOCK_myisam_mmap);
+    eom= key_file_length > myisam_mmap_size - myisam_mmap_used;
+    if (!eom)
+      myisam_mmap_used+= key_file_length;
+    mysql_mutex_unlock(&THR_LOCK_myisam_mmap);
+  }
+  else
+    eom= 0;
+  if (eom)
+  {
+    DBUG_PRINT("warning", ("Index file is too large for mmap"));
+    DBUG_RETURN(0);
+  }
+
+  map= 0;
+  if (mysql_file_seek(share->kfile, 0L, MY_SEEK_END, MYF(0)) >=
+      key_file_length)
+  {
+    map= (uchar*) my_mmap(0, (size_t) key_file_length, PROT_READ,
+                          MAP_SHARED | MAP_NORESERVE, share->kfile, 0L);
+    if (map == (uchar*) MAP_FAILED)
+      map= 0;
+  }
+  if (!map)
+  {
+    DBUG_PRINT("warning", ("Could not map index file"));
+    if (myisam_mmap_size != SIZE_T_MAX)
+    {
+      mysql_mutex_lock(&THR_LOCK_myisam_mmap);
+      myisam_mmap_used-= key_file_length;
+      mysql_mutex_unlock(&THR_LOCK_myisam_mmap);
+    }
+    DBUG_RETURN(0);
+  }
+#if defined(HAVE_MADVISE)
+  /* B-tree searches jump around in the file */
+  madvise((char*) map, (size_t) key_file_length, MADV_RANDOM);
+#endif
+  share->index_map= map;
+  share->index_mapped_length= key_file_length;
+  DBUG_RETURN(1);
+}
+
+
+void _mi_unmap_index(MI_INFO *info)
+{
+  MYISAM_SHARE *share= info->s;
+  DBUG_ENTER("_mi_unmap_index");
+
+  (void) my_munmap((char*) share->index_map,
+                   (size_t) share->index_mapped_length);
+  if (myisam_mmap_size != SIZE_T_MAX)
+  {
+    mysql_mutex_lock(&THR_LOCK_myisam_mmap);
+    myisam_mmap_used-= share->index_mapped_length;
+    mysql_mutex_unlock(&THR_LOCK_myisam_mmap);
+  }
+  share->index_map= 0;
+  share->index_mapped_length= 0;
+  share->index_map_scans= 0;
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Start or end an index scan on the mapped index
+
+  SYNOPSIS
+    _mi_memmap_index_scan()
+    info                MyISAM handler
+    scan                1 at the start of a scan, 0 at its end
+
+  DESCRIPTION
+    The mapping is advised MADV_SEQUENTIAL while any handler scans the
+    index in key order, and MADV_RANDOM again when the last scan ends.
+*/
+
+void _mi_memmap_index_scan(MI_INFO *info, my_bool scan)
+{
+  MYISAM_SHARE *share= info->s;
+  DBUG_ENTER("_mi_memmap_index_scan");
+
+  if (MY_TEST(info->opt_flag & INDEX_MAP_SCAN_USED) == scan ||
+      (scan && !share->index_map))
+    DBUG_VOID_RETURN;
+  mysql_mutex_lock(&share->intern_lock);
+  if (scan)
+  {
+    info->opt_flag|= INDEX_MAP_SCAN_USED;
+#if defined(HAVE_MADVISE)
+    if (!share->index_map_scans++)
+      madvise((char*) share->index_map, (size_t) share->index_mapped_length,
+              MADV_SEQUENTIAL);
+#endif
+  }
+  else
+  {
+    info->opt_flag&= ~INDEX_MAP_SCAN_USED;
+#if defined(HAVE_MADVISE)
+    /* The index may have been unmapped and mapped again by a repair */
+    if (share->index_map_scans && !--share->index_map_scans &&
+        share->index_map)
+      madvise((char*) share->index_map, (size_t) share->index_mapped_length,
+              MADV_RANDOM);
+#endif
+  }
+  mysql_mutex_unlock(&share->intern_lock);
+  DBUG_VOID_RETURN;
+}
+
+
 static uchar *_mi_mempack_get_block_info(MI_INFO *myisam, MI_BIT_BUFF *bit_buff,
                                          MI_BLOCK_INFO *info, uchar **rec_buff_p,
 					 uchar *header)
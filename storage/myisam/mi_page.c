@@ -29,11 +29,23 @@ uchar *_mi_fetch_keypage(register MI_INFO *info, MI_KEYDEF *keyinfo,
   DBUG_ENTER("_mi_fetch_keypage");
   DBUG_PRINT("enter",("page: %ld", (long) page));
 
-  tmp=(uchar*) key_cache_read(info->s->key_cache,
-                             info->s->kfile, page, level, (uchar*) buff,
-			     (uint) keyinfo->block_length,
-			     (uint) keyinfo->block_length,
-			     return_buffer);
+  if (info->s->index_map &&
+      page + keyinfo->block_length <= info->s->index_mapped_length)
+  {
+    /* Read only index that is mapped; no need for the key cache */
+    tmp= info->s->index_map + page;
+    if (!return_buffer)
+    {
+      memcpy(buff, tmp, keyinfo->block_length);
+      tmp= buff;
+    }
+  }
+  else
+    tmp=(uchar*) key_cache_read(info->s->key_cache,
+                               info->s->kfile, page, level, (uchar*) buff,
+                               (uint) keyinfo->block_length,
+                               (uint) keyinfo->block_length,
+                               return_buffer);
   if (tmp == info->buff)
     info->buff_used=1;
   else if (!tmp)
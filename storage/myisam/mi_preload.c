@@ -36,6 +36,8 @@
     At present pages for all indexes are preloaded.
     In future only pages for indexes specified in the key_map parameter
     of the table will be preloaded.
+    A mapped index (see _mi_memmap_index()) is not read through the key
+    cache, so for it we only ask the OS to read the whole index file.
 */
 
 int mi_preload(MI_INFO *info, ulonglong key_map, my_bool ignore_leaves)
@@ -53,6 +55,15 @@ int mi_preload(MI_INFO *info, ulonglong key_map, my_bool ignore_leaves)
   if (!keys || !mi_is_any_key_active(key_map) || key_file_length == pos)
     DBUG_RETURN(0);
 
+  if (share->index_map)
+  {
+#if defined(HAVE_MMAP) && defined(HAVE_MADVISE)
+    madvise((char*) share->index_map, (size_t) share->index_mapped_length,
+            MADV_WILLNEED);
+#endif
+    DBUG_RETURN(0);
+  }
+
   /* Preload into a non initialized key cache should never happen. */
   DBUG_ASSERT(share->key_cache->key_cache_inited);
 
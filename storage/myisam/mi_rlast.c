@@ -21,6 +21,8 @@
 int mi_rlast(MI_INFO *info, uchar *buf, int inx)
 {
   DBUG_ENTER("mi_rlast");
+  if (info->s->index_map)
+    _mi_memmap_index_scan(info, 1);         /* Scan of the whole index */
   info->lastpos= HA_OFFSET_ERROR;
   info->update|= HA_STATE_NEXT_FOUND;
   DBUG_RETURN(mi_rprev(info,buf,inx));
@@ -40,6 +40,7 @@ ulong myisam_concurrent_insert= 0;
 ulonglong myisam_max_temp_length= MAX_FILE_SIZE;
 ulong    myisam_data_pointer_size=4;
 ulonglong    myisam_mmap_size= SIZE_T_MAX, myisam_mmap_used= 0;
+my_bool myisam_mmap_index= 0;
 my_bool (*mi_killed)(MI_INFO *)= mi_killed_standalone;
 
 static int always_valid(const char *filename __attribute__((unused)))
@@ -169,6 +169,7 @@ typedef struct st_mi_isam_share
   char  *data_file_name,		/* Resolved path names from symlinks */
         *index_file_name;
   uchar *file_map;			/* mem-map of file if possible */
+  uchar *index_map;			/* mem-map of index file if used */
   KEY_CACHE *key_cache;			/* ref to the current key cache */
   /* To mark the key cache partitions containing dirty pages for this file */ 
   ulonglong dirty_part_map;   
@@ -223,6 +224,8 @@ typedef struct st_mi_isam_share
   mysql_mutex_t intern_lock;            /* Locking for use with _locking */
   mysql_rwlock_t *key_root_lock;
   my_off_t mmaped_length;
+  my_off_t index_mapped_length;         /* Length of index_map */
+  uint index_map_scans;                 /* Index scans using index_map */
   uint     nonmmaped_inserts;           /* counter of writing in non-mmaped
                                            area */
   mysql_rwlock_t mmap_lock;
@@ -312,6 +315,7 @@ struct st_myisam_info
 /* bits in opt_flag */
 #define MEMMAP_USED     32
 #define REMEMBER_OLD_POS 64
+#define INDEX_MAP_SCAN_USED 128
 
 #define WRITEINFO_UPDATE_KEYFILE        1
 #define WRITEINFO_NO_UNLOCK             2
@@ -664,6 +668,9 @@ extern void _myisam_log_record(enum myisam_log_commands command, MI_INFO *info,
 extern void mi_report_error(int errcode, const char *file_name);
 extern my_bool _mi_memmap_file(MI_INFO *info);
 extern void _mi_unmap_file(MI_INFO *info);
+extern my_bool _mi_memmap_index(MI_INFO *info);
+extern void _mi_unmap_index(MI_INFO *info);
+extern void _mi_memmap_index_scan(MI_INFO *info, my_bool scan);
 extern uint save_pack_length(uint version, uchar *block_buff, ulong length);
 extern uint calc_pack_length(uint version, ulong length);
 extern size_t mi_mmap_pread(MI_INFO *info, uchar *Buffer,
@@ -2512,6 +2512,7 @@ static inline PFS_TL_LOCK_TYPE lock_flags_to_lock_type(uint flags)
     case TL_WRITE_ALLOW_WRITE:
       return PFS_TL_WRITE_ALLOW_WRITE;
     case TL_WRITE_CONCURRENT_INSERT:
+    case TL_WRITE_CONCURRENT_UPDATE:
       return PFS_TL_WRITE_CONCURRENT_INSERT;
     case TL_WRITE_DELAYED:
       return PFS_TL_WRITE_DELAYED;
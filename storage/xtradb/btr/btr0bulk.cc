@@ -0,0 +1,549 @@
+/*****************************************************************************
+
+Copyright (c) 2016, MariaDB Corporation.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file btr/btr0bulk.cc
+Bottom-up bulk load of a B-tree
+
+Created 12/05/2016
+*******************************************************/
+
+#include "btr0bulk.h"
+#include "btr0btr.h"
+#include "data0data.h"
+#include "dict0dict.h"
+#include "fsp0fsp.h"
+#include "ibuf0ibuf.h"
+#include "log0log.h"
+#include "mtr0mtr.h"
+#include "page0cur.h"
+#include "page0page.h"
+#include "rem0rec.h"
+
+/** A level of an index tree that is being bulk loaded */
+struct btr_bulk_level_t {
+	ulint		first_page_no;	/*!< leftmost page of the level */
+	ulint		page_no;	/*!< rightmost page of the level,
+					or FIL_NULL if the level has not
+					been started */
+	ulint		n_pages;	/*!< number of pages on the level */
+	dtuple_t*	first;		/*!< copy of the first record of the
+					level, for building the node pointer
+					to first_page_no */
+};
+
+/** Bulk loader of an index tree */
+struct btr_bulk_t {
+	dict_index_t*	index;		/*!< index being loaded */
+	trx_id_t	trx_id;		/*!< PAGE_MAX_TRX_ID of leaf pages */
+	ulint		max_data_size;	/*!< a new page is started when a
+					record would make page_get_data_size()
+					exceed this */
+	ulint		n_levels;	/*!< number of levels started */
+	btr_bulk_level_t levels[BTR_MAX_LEVELS];
+					/*!< the levels, leaf level first */
+	mem_heap_t*	heap;		/*!< heap for the first records of
+					the levels */
+	mem_heap_t*	offsets_heap;	/*!< heap for offsets */
+	ulint*		offsets;	/*!< offsets of the inserted record */
+	bool		mtr_active;	/*!< whether mtr is active */
+	mtr_t		mtr;		/*!< mini-transaction that latches
+					the rightmost leaf page between
+					calls of btr_bulk_insert() */
+	page_cur_t	cur;		/*!< cursor on the last record of the
+					rightmost leaf page, when mtr_active */
+};
+
+/*********************************************************************//**
+Checks if an index can be built with the bulk loader.
+@return true if btr_bulk_create() may be used on the index */
+UNIV_INTERN
+bool
+btr_bulk_is_supported(
+/*==================*/
+	const dict_index_t*	index)	/*!< in: index */
+{
+	/* Clustered index records may have externally stored columns,
+	and compressed pages would have to be compressed one record at
+	a time; both are left to the ordinary insert path. */
+	return(!dict_index_is_clust(index)
+	       && !dict_index_is_ibuf(index)
+	       && !(index->type & DICT_FTS)
+	       && !dict_table_zip_size(index->table));
+}
+
+/*********************************************************************//**
+Creates a bulk loader for an index. The index must be empty, and it must
+not be accessed by other threads until btr_bulk_finish() returns.
+@return bulk loader */
+UNIV_INTERN
+btr_bulk_t*
+btr_bulk_create(
+/*============*/
+	dict_index_t*	index,		/*!< in: secondary index */
+	trx_id_t	trx_id,		/*!< in: PAGE_MAX_TRX_ID of the
+					leaf pages */
+	ulint		fill_factor)	/*!< in: percentage of each page to
+					fill, BTR_BULK_MIN_FILL_FACTOR..100 */
+{
+	btr_bulk_t*	bulk;
+
+	ut_ad(btr_bulk_is_supported(index));
+	ut_ad(fill_factor >= BTR_BULK_MIN_FILL_FACTOR);
+	ut_ad(fill_factor <= 100);
+
+	bulk = static_cast<btr_bulk_t*>(mem_zalloc(sizeof *bulk));
+
+	bulk->index = index;
+	bulk->trx_id = trx_id;
+	bulk->max_data_size = page_get_free_space_of_empty(
+		dict_table_is_comp(index->table)) * fill_factor / 100;
+
+	for (ulint i = 0; i < BTR_MAX_LEVELS; i++) {
+		bulk->levels[i].first_page_no = FIL_NULL;
+		bulk->levels[i].page_no = FIL_NULL;
+	}
+
+	bulk->heap = mem_heap_create(1024);
+	bulk->offsets_heap = mem_heap_create(1024);
+
+	return(bulk);
+}
+
+/*********************************************************************//**
+Builds a node pointer from the first record of a page.
+@return node pointer to page_no */
+static
+dtuple_t*
+btr_bulk_build_node_ptr(
+/*====================*/
+	const dict_index_t*	index,	/*!< in: index */
+	const dtuple_t*		tuple,	/*!< in: first record on the page */
+	ulint			page_no,/*!< in: page number */
+	mem_heap_t*		heap)	/*!< in: memory heap */
+{
+	dtuple_t*	node_ptr;
+	dfield_t*	field;
+	byte*		buf;
+	ulint		n_unique = dict_index_get_n_unique_in_tree(index);
+
+	ut_ad(dtuple_get_n_fields(tuple) >= n_unique);
+
+	node_ptr = dtuple_create(heap, n_unique + 1);
+
+	/* Like in dict_index_build_node_ptr(), the child page number
+	must not be compared when searching. */
+	dtuple_set_n_fields_cmp(node_ptr, n_unique);
+
+	for (ulint i = 0; i < n_unique; i++) {
+		dfield_copy(dtuple_get_nth_field(node_ptr, i),
+			    dtuple_get_nth_field(tuple, i));
+	}
+
+	buf = static_cast<byte*>(mem_heap_alloc(heap, 4));
+
+	mach_write_to_4(buf, page_no);
+
+	field = dtuple_get_nth_field(node_ptr, n_unique);
+	dfield_set_data(field, buf, 4);
+
+	dtype_set(dfield_get_type(field), DATA_SYS_CHILD, DATA_NOT_NULL, 4);
+
+	dtuple_set_info_bits(node_ptr, REC_STATUS_NODE_PTR);
+
+	ut_ad(dtuple_check_typed(node_ptr));
+
+	return(node_ptr);
+}
+
+/*********************************************************************//**
+Allocates a page to the right end of a level. The index tree latch is
+acquired for the allocation only: the tree is not visible to other
+threads yet, but the file segment and the root page are modified in the
+same way as in a page split. The caller must not hold any page latches
+in mtr, because the index tree latch precedes the page latches in the
+latching order; the rightmost page of the level is latched here.
+@return DB_SUCCESS, DB_OUT_OF_FILE_SPACE or DB_CORRUPTION */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+btr_bulk_alloc_page(
+/*================*/
+	btr_bulk_t*	bulk,		/*!< in/out: bulk loader */
+	ulint		level,		/*!< in: level of the page */
+	mtr_t*		mtr)		/*!< in/out: mini-transaction */
+{
+	dict_index_t*		index	= bulk->index;
+	btr_bulk_level_t*	lvl	= &bulk->levels[level];
+	buf_block_t*		prev_block = NULL;
+	buf_block_t*		block;
+	page_t*			page;
+	ulint			n_reserved;
+
+	mtr_x_lock(dict_index_get_lock(index), mtr);
+
+	if (lvl->page_no != FIL_NULL) {
+		prev_block = btr_block_get(index->space,
+					   dict_table_zip_size(index->table),
+					   lvl->page_no, RW_X_LATCH,
+					   index, mtr);
+
+		if (prev_block == NULL) {
+			return(DB_CORRUPTION);
+		}
+	}
+
+	if (!fsp_reserve_free_extents(&n_reserved, index->space, 2,
+				      FSP_NORMAL, mtr)) {
+		return(DB_OUT_OF_FILE_SPACE);
+	}
+
+	block = btr_page_alloc(index,
+			       lvl->page_no == FIL_NULL
+			       ? 0 : lvl->page_no + 1,
+			       FSP_UP, level, mtr, mtr);
+
+	fil_space_release_free_extents(index->space, n_reserved);
+
+	if (block == NULL) {
+		return(DB_OUT_OF_FILE_SPACE);
+	}
+
+	page = buf_block_get_frame(block);
+
+	btr_page_create(block, NULL, index, level, mtr);
+	btr_page_set_prev(page, NULL, lvl->page_no, mtr);
+	btr_page_set_next(page, NULL, FIL_NULL, mtr);
+
+	if (prev_block) {
+		btr_page_set_next(buf_block_get_frame(prev_block), NULL,
+				  buf_block_get_page_no(block), mtr);
+	} else {
+		lvl->first_page_no = buf_block_get_page_no(block);
+	}
+
+	if (level == 0) {
+		page_update_max_trx_id(block, NULL, bulk->trx_id, mtr);
+		/* The change buffer must not assume free space on
+		a page that has not been completed yet. */
+		ibuf_reset_free_bits(block);
+	}
+
+	lvl->page_no = buf_block_get_page_no(block);
+	lvl->n_pages++;
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Starts a mini-transaction and latches the rightmost page of a level,
+positioning the cursor on its last record.
+@return DB_SUCCESS or DB_CORRUPTION */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+btr_bulk_latch_page(
+/*================*/
+	btr_bulk_t*	bulk,		/*!< in: bulk loader */
+	ulint		level,		/*!< in: level */
+	page_cur_t*	cur,		/*!< out: cursor */
+	mtr_t*		mtr)		/*!< out: mini-transaction */
+{
+	dict_index_t*	index	= bulk->index;
+	buf_block_t*	block;
+
+	ut_ad(bulk->levels[level].page_no != FIL_NULL);
+
+	log_free_check();
+
+	mtr_start(mtr);
+
+	block = btr_block_get(index->space,
+			      dict_table_zip_size(index->table),
+			      bulk->levels[level].page_no,
+			      RW_X_LATCH, index, mtr);
+
+	if (block == NULL) {
+		mtr_commit(mtr);
+		return(DB_CORRUPTION);
+	}
+
+	page_cur_position(
+		page_rec_get_prev(page_get_supremum_rec(
+					  buf_block_get_frame(block))),
+		block, cur);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Appends a record to the rightmost page of a level, starting a new page
+and adding a node pointer to it on the parent level when the page is
+full. Only the leaf level keeps its mini-transaction open between calls.
+@return DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+btr_bulk_insert_low(
+/*================*/
+	btr_bulk_t*	bulk,		/*!< in/out: bulk loader */
+	ulint		level,		/*!< in: level */
+	const dtuple_t*	tuple)		/*!< in: record to append */
+{
+	dict_index_t*		index	= bulk->index;
+	btr_bulk_level_t*	lvl	= &bulk->levels[level];
+	mtr_t			local_mtr;
+	page_cur_t		local_cur;
+	mtr_t*			mtr;
+	page_cur_t*		cur;
+	page_t*			page;
+	rec_t*			rec	= NULL;
+	mem_heap_t*		heap;
+	dberr_t			err;
+
+	if (level == 0) {
+		mtr = &bulk->mtr;
+		cur = &bulk->cur;
+	} else {
+		ut_ad(!bulk->mtr_active);
+		mtr = &local_mtr;
+		cur = &local_cur;
+	}
+
+	if (lvl->page_no == FIL_NULL) {
+		/* Start a new level. */
+		if (level >= BTR_MAX_LEVELS) {
+			return(DB_CORRUPTION);
+		}
+
+		mtr_start(mtr);
+		err = btr_bulk_alloc_page(bulk, level, mtr);
+		mtr_commit(mtr);
+
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+
+		lvl->first = dtuple_copy(tuple, bulk->heap);
+
+		for (ulint i = 0; i < dtuple_get_n_fields(tuple); i++) {
+			dfield_dup(dtuple_get_nth_field(lvl->first, i),
+				   bulk->heap);
+		}
+
+		bulk->n_levels = level + 1;
+	}
+
+	if (level == 0 && bulk->mtr_active) {
+		/* The page is still latched from the previous call. */
+	} else {
+		err = btr_bulk_latch_page(bulk, level, cur, mtr);
+
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+
+		bulk->mtr_active = (level == 0);
+	}
+
+	page = page_cur_get_page(cur);
+
+	if (!page_get_n_recs(page)
+	    || page_get_data_size(page)
+	    + rec_get_converted_size(index, tuple, 0)
+	    <= bulk->max_data_size) {
+		rec = page_cur_tuple_insert(cur, tuple, index,
+					    &bulk->offsets,
+					    &bulk->offsets_heap, 0, mtr);
+	}
+
+	if (rec == NULL) {
+		if (!page_get_n_recs(page)) {
+			err = DB_TOO_BIG_RECORD;
+			goto func_exit;
+		}
+
+		/* The page is full. Start a new page to the right of it,
+		and add a node pointer to the new page to the parent level
+		before appending the record. The page latch is released
+		first, so that the index tree latch can be acquired. */
+		mtr_commit(mtr);
+		bulk->mtr_active = false;
+
+		log_free_check();
+
+		mtr_start(mtr);
+		err = btr_bulk_alloc_page(bulk, level, mtr);
+		mtr_commit(mtr);
+
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+
+		heap = mem_heap_create(1024);
+
+		if (lvl->n_pages == 2) {
+			/* The level got its second page: the parent level
+			starts with the node pointer to the first page. */
+			err = btr_bulk_insert_low(
+				bulk, level + 1,
+				btr_bulk_build_node_ptr(
+					index, lvl->first,
+					lvl->first_page_no, heap));
+		}
+
+		if (err == DB_SUCCESS) {
+			err = btr_bulk_insert_low(
+				bulk, level + 1,
+				btr_bulk_build_node_ptr(
+					index, tuple, lvl->page_no, heap));
+		}
+
+		mem_heap_free(heap);
+
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+
+		err = btr_bulk_latch_page(bulk, level, cur, mtr);
+
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+
+		bulk->mtr_active = (level == 0);
+
+		rec = page_cur_tuple_insert(cur, tuple, index,
+					    &bulk->offsets,
+					    &bulk->offsets_heap, 0, mtr);
+
+		if (rec == NULL) {
+			err = DB_TOO_BIG_RECORD;
+			goto func_exit;
+		}
+	}
+
+	/* The next record will be appended after this one. */
+	page_cur_move_to_next(cur);
+
+	if (level > 0 && lvl->n_pages == 1
+	    && page_get_n_recs(page_cur_get_page(cur)) == 1) {
+		/* The leftmost node pointer on each non-leaf level
+		must carry the minimum record flag. */
+		btr_set_min_rec_mark(rec, mtr);
+	}
+
+func_exit:
+	if (level > 0 || err != DB_SUCCESS) {
+		mtr_commit(mtr);
+		bulk->mtr_active = false;
+	}
+
+	return(err);
+}
+
+/*********************************************************************//**
+Appends a record to the leaf level of the index. The record must be
+greater than any record that was inserted before.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_insert(
+/*============*/
+	btr_bulk_t*	bulk,		/*!< in/out: bulk loader */
+	const dtuple_t*	tuple)		/*!< in: index entry without
+					externally stored columns */
+{
+	mem_heap_empty(bulk->offsets_heap);
+	bulk->offsets = NULL;
+
+	return(btr_bulk_insert_low(bulk, 0, tuple));
+}
+
+/*********************************************************************//**
+Completes the index tree by copying the topmost level into the root page,
+and frees the bulk loader. If err != DB_SUCCESS, only releases the pages;
+the partially built tree will be freed when the index is dropped.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_finish(
+/*============*/
+	btr_bulk_t*	bulk,		/*!< in,own: bulk loader */
+	dberr_t		err)		/*!< in: error from btr_bulk_insert(),
+					or DB_SUCCESS */
+{
+	dict_index_t*	index	= bulk->index;
+
+	if (bulk->mtr_active) {
+		mtr_commit(&bulk->mtr);
+	}
+
+	if (err == DB_SUCCESS && bulk->n_levels > 0) {
+		const ulint		level	= bulk->n_levels - 1;
+		const ulint		zip_size
+			= dict_table_zip_size(index->table);
+		buf_block_t*		root_block;
+		buf_block_t*		block;
+		mtr_t			mtr;
+
+		ut_ad(bulk->levels[level].n_pages == 1);
+
+		log_free_check();
+
+		mtr_start(&mtr);
+		mtr_x_lock(dict_index_get_lock(index), &mtr);
+
+		root_block = btr_block_get(index->space, zip_size,
+					   dict_index_get_page(index),
+					   RW_X_LATCH, index, &mtr);
+		block = btr_block_get(index->space, zip_size,
+				      bulk->levels[level].page_no,
+				      RW_X_LATCH, index, &mtr);
+
+		if (root_block == NULL || block == NULL) {
+			err = DB_CORRUPTION;
+		} else {
+			/* The topmost level consists of a single page.
+			Move its records to the root page, which was
+			created empty together with the index. */
+			btr_page_empty(root_block, NULL, index, level, &mtr);
+
+			page_copy_rec_list_end(
+				root_block, block,
+				page_get_infimum_rec(
+					buf_block_get_frame(block)),
+				index, &mtr);
+
+			btr_page_free(index, block, &mtr);
+
+			/* The freed page stays in the buffer pool with
+			a copy of the root's records. Do not let it
+			pass for a page of the index. */
+			mlog_write_ulint(buf_block_get_frame(block)
+					 + FIL_PAGE_TYPE,
+					 FIL_PAGE_TYPE_ALLOCATED,
+					 MLOG_2BYTES, &mtr);
+		}
+
+		mtr_commit(&mtr);
+	}
+
+	mem_heap_free(bulk->offsets_heap);
+	mem_heap_free(bulk->heap);
+	mem_free(bulk);
+
+	return(err);
+}
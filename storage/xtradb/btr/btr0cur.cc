@@ -57,6 +57,7 @@ Created 10/16/1994 Heikki Tuuri
 #include "rem0rec.h"
 #include "rem0cmp.h"
 #include "buf0lru.h"
+#include "buf0rea.h"
 #include "btr0btr.h"
 #include "btr0sea.h"
 #include "row0log.h"
@@ -379,6 +380,46 @@ btr_cur_latch_leaves(
 	ut_error;
 }
 
+/********************************************************************//**
+Issues asynchronous reads of the leaf pages that follow a node pointer on
+a page one level above the leaves, so that a forward scan that is about
+to descend to the child of the node pointer finds its next leaf pages in
+the buffer pool. At most srv_scan_read_ahead_pages pages are read. */
+static
+void
+btr_cur_read_ahead_leaves(
+/*======================*/
+	const rec_t*	node_ptr,	/*!< in: node pointer to the leaf
+					page that is being descended to */
+	dict_index_t*	index,		/*!< in: index */
+	ulint		space,		/*!< in: space id */
+	ulint		zip_size,	/*!< in: compressed page size, or 0 */
+	mem_heap_t**	heap)		/*!< in/out: memory heap */
+{
+	ulint		page_nos[BUF_READ_AHEAD_SCAN_MAX];
+	ulint		n_pages = 0;
+	ulint		n_max = srv_scan_read_ahead_pages;
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*		offsets = offsets_;
+	const rec_t*	rec = page_rec_get_next_const(node_ptr);
+
+	rec_offs_init(offsets_);
+
+	if (n_max > BUF_READ_AHEAD_SCAN_MAX) {
+		n_max = BUF_READ_AHEAD_SCAN_MAX;
+	}
+
+	while (n_pages < n_max && !page_rec_is_supremum(rec)) {
+		offsets = rec_get_offsets(rec, index, offsets,
+					  ULINT_UNDEFINED, heap);
+		page_nos[n_pages++] = btr_node_ptr_get_child_page_no(
+			rec, offsets);
+		rec = page_rec_get_next_const(rec);
+	}
+
+	buf_read_ahead_scan(space, zip_size, page_nos, n_pages, NULL);
+}
+
 /********************************************************************//**
 Searches an index tree and positions a tree cursor on a given level.
 NOTE: n_fields_cmp in tuple must be set so that it cannot be compared
@@ -438,6 +479,7 @@ btr_cur_search_to_nth_level(
 	ulint		page_mode;
 	ulint		buf_mode;
 	ulint		estimate;
+	ulint		read_ahead;
 	ulint		zip_size;
 	page_cur_t*	page_cursor;
 	btr_op_t	btr_op;
@@ -511,10 +553,12 @@ btr_cur_search_to_nth_level(
 	ut_ad(btr_op == BTR_NO_OP || !dict_index_is_clust(index));
 
 	estimate = latch_mode & BTR_ESTIMATE;
+	read_ahead = latch_mode & BTR_READ_AHEAD;
 
 	/* Turn the flags unrelated to the latch mode off. */
 	latch_mode = BTR_LATCH_MODE_WITHOUT_FLAGS(latch_mode);
 
+	ut_ad(!read_ahead || latch_mode == BTR_SEARCH_LEAF);
 	ut_ad(!s_latch_by_caller
 	      || latch_mode == BTR_SEARCH_LEAF
 	      || latch_mode == BTR_MODIFY_LEAF);
@@ -539,6 +583,7 @@ btr_cur_search_to_nth_level(
 	    && latch_mode <= BTR_MODIFY_LEAF
 	    && info->last_hash_succ
 	    && !estimate
+	    && !read_ahead
 # ifdef PAGE_CUR_LE_OR_EXTENDS
 	    && mode != PAGE_CUR_LE_OR_EXTENDS
 # endif /* PAGE_CUR_LE_OR_EXTENDS */
@@ -856,6 +901,12 @@ btr_cur_search_to_nth_level(
 		/* Go to the child node */
 		page_no = btr_node_ptr_get_child_page_no(node_ptr, offsets);
 
+		if (read_ahead && height == 0
+		    && !dict_index_is_ibuf(index)) {
+			btr_cur_read_ahead_leaves(
+				node_ptr, index, space, zip_size, &heap);
+		}
+
 		if (UNIV_UNLIKELY(height == 0 && dict_index_is_ibuf(index))) {
 			/* We're doing a search on an ibuf tree and we're one
 			level above the leaf page. */
@@ -939,6 +990,7 @@ btr_cur_open_at_index_side_func(
 	ulint		root_height = 0; /* remove warning */
 	rec_t*		node_ptr;
 	ulint		estimate;
+	ulint		read_ahead;
 	ulint		savepoint;
 	mem_heap_t*	heap		= NULL;
 	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
@@ -948,7 +1000,8 @@ btr_cur_open_at_index_side_func(
 	rec_offs_init(offsets_);
 
 	estimate = latch_mode & BTR_ESTIMATE;
-	latch_mode &= ~BTR_ESTIMATE;
+	read_ahead = from_left ? latch_mode & BTR_READ_AHEAD : 0;
+	latch_mode &= ~(BTR_ESTIMATE | BTR_READ_AHEAD);
 
 	ut_ad(level != ULINT_UNDEFINED);
 
@@ -1100,6 +1153,12 @@ btr_cur_open_at_index_side_func(
 					  ULINT_UNDEFINED, &heap);
 		/* Go to the child node */
 		page_no = btr_node_ptr_get_child_page_no(node_ptr, offsets);
+
+		if (read_ahead && height == 0 && level == 0
+		    && !dict_index_is_ibuf(index)) {
+			btr_cur_read_ahead_leaves(
+				node_ptr, index, space, zip_size, &heap);
+		}
 	}
 
 exit_loop:
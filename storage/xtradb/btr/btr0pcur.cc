@@ -172,6 +172,7 @@ btr_pcur_store_position(
 		&cursor->old_rec_buf, &cursor->buf_size);
 
 	cursor->block_when_stored = block;
+	cursor->withdraw_clock = buf_withdraw_clock;
 	cursor->modify_clock = buf_block_get_modify_clock(block);
 }
 
@@ -257,9 +258,10 @@ btr_pcur_restore_position_func(
 			index, latch_mode,
 			btr_pcur_get_btr_cur(cursor), 0, mtr);
 
-		cursor->latch_mode = latch_mode;
+		cursor->latch_mode = BTR_LATCH_MODE_WITHOUT_FLAGS(latch_mode);
 		cursor->pos_state = BTR_PCUR_IS_POSITIONED;
 		cursor->block_when_stored = btr_pcur_get_block(cursor);
+		cursor->withdraw_clock = buf_withdraw_clock;
 
 		return(FALSE);
 	}
@@ -267,9 +269,11 @@ btr_pcur_restore_position_func(
 	ut_a(cursor->old_rec);
 	ut_a(cursor->old_n_fields);
 
-	if (UNIV_LIKELY(latch_mode == BTR_SEARCH_LEAF)
-	    || UNIV_LIKELY(latch_mode == BTR_MODIFY_LEAF)) {
-		/* Try optimistic restoration. */
+	if ((UNIV_LIKELY(latch_mode == BTR_SEARCH_LEAF)
+	     || UNIV_LIKELY(latch_mode == BTR_MODIFY_LEAF))
+	    && !buf_pool_is_obsolete(cursor->withdraw_clock)) {
+		/* Try optimistic restoration, unless a buffer pool
+		resize may have freed block_when_stored. */
 
 		if (buf_page_optimistic_get(latch_mode,
 					    cursor->block_when_stored,
@@ -363,6 +367,7 @@ btr_pcur_restore_position_func(
 
 			cursor->block_when_stored =
 				btr_pcur_get_block(cursor);
+			cursor->withdraw_clock = buf_withdraw_clock;
 			cursor->modify_clock =
 				buf_block_get_modify_clock(
 					cursor->block_when_stored);
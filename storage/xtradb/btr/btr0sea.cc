@@ -235,6 +235,45 @@ btr_search_sys_free(void)
 	btr_search_sys = NULL;
 }
 
+/*****************************************************************//**
+Resizes the hash tables of the adaptive search system after the buffer
+pool has been resized.  Does nothing if the adaptive hash index has
+been enabled again in the meantime, because the tables must be empty. */
+UNIV_INTERN
+void
+btr_search_sys_resize(
+/*==================*/
+	ulint	hash_size)	/*!< in: hash index hash table size */
+{
+	ulint	i;
+
+	hash_size /= btr_search_index_num;
+
+	btr_search_x_lock_all();
+
+	if (btr_search_enabled) {
+		btr_search_x_unlock_all();
+
+		return;
+	}
+
+	for (i = 0; i < btr_search_index_num; i++) {
+
+		mem_heap_free(btr_search_sys->hash_tables[i]->heap);
+
+		hash_table_free(btr_search_sys->hash_tables[i]);
+
+		btr_search_sys->hash_tables[i]
+			= ha_create(hash_size, 0, MEM_HEAP_FOR_BTR_SEARCH, 0);
+
+#if defined UNIV_AHI_DEBUG || defined UNIV_DEBUG
+		btr_search_sys->hash_tables[i]->adaptive = TRUE;
+#endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
+	}
+
+	btr_search_x_unlock_all();
+}
+
 /********************************************************************//**
 Set index->ref_count = 0 on all indexes of a table. */
 static
@@ -1070,7 +1109,7 @@ btr_search_guess_on_hash(
 	/* Increment the page get statistics though we did not really
 	fix the page: for user info only */
 	buf_pool = buf_pool_from_bpage(&block->page);
-	buf_pool->stat.n_page_gets++;
+	buf_pool_stat_page_get(buf_pool);
 
 	return(TRUE);
 
@@ -324,6 +324,18 @@ buf_buddy_alloc_zip(
 
 	buf = UT_LIST_GET_FIRST(buf_pool->zip_free[i]);
 
+	if (buf_pool->withdraw_target > 0
+	    && UT_LIST_GET_LEN(buf_pool->withdraw)
+	    < buf_pool->withdraw_target) {
+		/* Do not hand out memory from chunks that are being
+		withdrawn by buf_pool_resize(). */
+		while (buf != NULL
+		       && buf_frame_will_withdrawn(
+			       buf_pool, reinterpret_cast<byte*>(buf))) {
+			buf = UT_LIST_GET_NEXT(list, buf);
+		}
+	}
+
 	if (buf) {
 		buf_buddy_remove_from_free(buf_pool, buf, i);
 	} else if (i + 1 < BUF_BUDDY_SIZES) {
@@ -573,6 +585,8 @@ buf_buddy_relocate(
 	prio_rw_lock_t*	hash_lock = buf_page_hash_lock_get(buf_pool, fold);
 
 	rw_lock_x_lock(hash_lock);
+	hash_lock = hash_lock_x_confirm(
+		hash_lock, buf_pool->page_hash, fold);
 
 	bpage = buf_page_hash_get_low(buf_pool, space, offset, fold);
 
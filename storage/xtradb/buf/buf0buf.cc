@@ -58,6 +58,7 @@ Created 11/5/1995 Heikki Tuuri
 #ifdef HAVE_LIBNUMA
 #include <numa.h>
 #include <numaif.h>
+#include <sched.h>
 #endif // HAVE_LIBNUMA
 #include "trx0trx.h"
 #include "srv0start.h"
@@ -302,6 +303,22 @@ static const ulint BUF_PAGE_READ_MAX_RETRIES = 100;
 /** The buffer pools of the database */
 UNIV_INTERN buf_pool_t*	buf_pool_ptr;
 
+/** Incremented once all blocks of the chunks to be freed by a buffer
+pool resize have been withdrawn. Block pointers that are kept without
+a buffer-fix, such as btr_pcur_t::block_when_stored, are saved
+together with this clock and must not be dereferenced after it
+has changed. */
+UNIV_INTERN volatile ulint	buf_withdraw_clock;
+
+#ifdef HAVE_LIBNUMA
+/** Number of NUMA nodes the buffer pool instances are bound to,
+or 0 if innodb_numa_bind is not in effect */
+static ulint	buf_numa_n_nodes;
+/** The NUMA nodes the buffer pool instances are bound to; instance i
+is bound to buf_numa_nodes[i % buf_numa_n_nodes] */
+static ulint	buf_numa_nodes[MAX_BUFFER_POOLS];
+#endif // HAVE_LIBNUMA
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 static ulint	buf_dbg_counter	= 0; /*!< This is used to insert validation
 					operations in execution in the
@@ -522,6 +539,7 @@ buf_get_total_stat(
 
 		buf_stat = &buf_pool->stat;
 		tot_stat->n_page_gets += buf_stat->n_page_gets;
+		tot_stat->n_page_gets_remote += buf_stat->n_page_gets_remote;
 		tot_stat->n_pages_read += buf_stat->n_pages_read;
 		tot_stat->n_pages_written += buf_stat->n_pages_written;
 		tot_stat->n_pages_created += buf_stat->n_pages_created;
@@ -535,6 +553,47 @@ buf_get_total_stat(
 	}
 }
 
+/********************************************************************//**
+Determines the NUMA node the calling thread is running on.
+@return NUMA node, or ULINT_UNDEFINED if not known */
+UNIV_INTERN
+ulint
+buf_numa_get_curr_node(void)
+/*========================*/
+{
+#ifdef HAVE_LIBNUMA
+	int	cpu = sched_getcpu();
+	int	node = cpu < 0 ? -1 : numa_node_of_cpu(cpu);
+
+	if (node >= 0) {
+		return(node);
+	}
+#endif // HAVE_LIBNUMA
+
+	return(ULINT_UNDEFINED);
+}
+
+/********************************************************************//**
+Moves the calling thread to the CPUs of a NUMA node. */
+UNIV_INTERN
+void
+buf_numa_run_on_node(
+/*=================*/
+	ulint	node)		/*!< in: NUMA node, or ULINT_UNDEFINED
+				to allow the thread to run anywhere */
+{
+#ifdef HAVE_LIBNUMA
+	if (numa_run_on_node(node == ULINT_UNDEFINED ? -1 : int(node))) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Failed to move thread %lu to NUMA node %ld"
+			" (error: %s).",
+			os_thread_pf(os_thread_get_curr_id()),
+			node == ULINT_UNDEFINED ? -1L : long(node),
+			strerror(errno));
+	}
+#endif // HAVE_LIBNUMA
+}
+
 /********************************************************************//**
 Allocates a buffer block.
 @return own: the allocated block, in state BUF_BLOCK_MEMORY */
@@ -555,6 +614,22 @@ buf_block_alloc(
 		we spread the grace on all buffer pool instances. */
 		index = buf_pool_index++ % srv_buf_pool_instances;
 		buf_pool = buf_pool_from_array(index);
+
+		if (buf_pool->numa_node != ULINT_UNDEFINED) {
+			/* Prefer the next instance that is bound
+			to the NUMA node of the calling thread. */
+			ulint	node = buf_numa_get_curr_node();
+
+			for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+				buf_pool_t*	b = buf_pool_from_array(
+					(index + i) % srv_buf_pool_instances);
+
+				if (b->numa_node == node) {
+					buf_pool = b;
+					break;
+				}
+			}
+		}
 	}
 
 	block = buf_LRU_get_free_block(buf_pool);
@@ -1297,6 +1372,23 @@ buf_chunk_init(
 				" pool page frames to MPOL_INTERLEAVE"
 				" (error: %s).", strerror(errno));
 		}
+	} else if (buf_pool->numa_node != ULINT_UNDEFINED) {
+		struct bitmask*	nodes = numa_allocate_nodemask();
+
+		numa_bitmask_setbit(nodes, buf_pool->numa_node);
+
+		int	st = mbind(chunk->mem, chunk->mem_size,
+				   MPOL_PREFERRED, nodes->maskp, nodes->size,
+				   MPOL_MF_MOVE);
+		if (st != 0) {
+			ib_logf(IB_LOG_LEVEL_WARN,
+				"Failed to set NUMA memory policy of buffer"
+				" pool page frames to MPOL_PREFERRED"
+				" for node " ULINTPF " (error: %s).",
+				buf_pool->numa_node, strerror(errno));
+		}
+
+		numa_free_nodemask(nodes);
 	}
 #endif // HAVE_LIBNUMA
 
@@ -1356,6 +1448,25 @@ buf_chunk_init(
 	return(chunk);
 }
 
+/********************************************************************//**
+Frees the latches of the blocks of a chunk before its memory is freed. */
+static
+void
+buf_chunk_free_blocks(
+/*==================*/
+	buf_chunk_t*	chunk)	/*!< in/out: chunk of buffers */
+{
+	buf_block_t*	block = chunk->blocks;
+
+	for (ulint i = chunk->size; i--; block++) {
+		mutex_free(&block->mutex);
+		rw_lock_free(&block->lock);
+#ifdef UNIV_SYNC_DEBUG
+		rw_lock_free(&block->debug_latch);
+#endif /* UNIV_SYNC_DEBUG */
+	}
+}
+
 #ifdef UNIV_DEBUG
 /*********************************************************************//**
 Finds a block in the given buffer chunk that points to a
@@ -1501,6 +1612,16 @@ buf_pool_init_instance(
 	ulint		i;
 	buf_chunk_t*	chunk;
 
+	ut_ad(buf_pool_size % srv_buf_pool_chunk_unit == 0);
+
+#ifdef HAVE_LIBNUMA
+	buf_pool->numa_node = buf_numa_n_nodes
+		? buf_numa_nodes[instance_no % buf_numa_n_nodes]
+		: ULINT_UNDEFINED;
+#else
+	buf_pool->numa_node = ULINT_UNDEFINED;
+#endif // HAVE_LIBNUMA
+
 	/* 1. Initialize general fields
 	------------------------------- */
 	mutex_create(buf_pool_LRU_list_mutex_key,
@@ -1517,23 +1638,39 @@ buf_pool_init_instance(
 		     &buf_pool->flush_state_mutex, SYNC_BUF_FLUSH_STATE);
 
 	if (buf_pool_size > 0) {
-		buf_pool->n_chunks = 1;
+		buf_pool->n_chunks = buf_pool->n_chunks_new
+			= buf_pool_size / srv_buf_pool_chunk_unit;
 
-		buf_pool->chunks = chunk =
-			(buf_chunk_t*) mem_zalloc(sizeof *chunk);
+		buf_pool->chunks = chunk = (buf_chunk_t*) mem_zalloc(
+			buf_pool->n_chunks * sizeof *chunk);
+		buf_pool->chunks_old = NULL;
 
 		UT_LIST_INIT(buf_pool->free);
+		UT_LIST_INIT(buf_pool->withdraw);
+		buf_pool->withdraw_target = 0;
+		buf_pool->curr_size = 0;
+
+		do {
+			if (!buf_chunk_init(buf_pool, chunk,
+					    srv_buf_pool_chunk_unit)) {
+				while (--chunk >= buf_pool->chunks) {
+					buf_chunk_free_blocks(chunk);
+					os_mem_free_large(chunk->mem,
+							  chunk->mem_size);
+				}
 
-		if (!buf_chunk_init(buf_pool, chunk, buf_pool_size)) {
-			mem_free(chunk);
-			mem_free(buf_pool);
+				mem_free(buf_pool->chunks);
+				mem_free(buf_pool);
 
-			return(DB_ERROR);
-		}
+				return(DB_ERROR);
+			}
+
+			buf_pool->curr_size += chunk->size;
+		} while (++chunk < buf_pool->chunks + buf_pool->n_chunks);
 
 		buf_pool->instance_no = instance_no;
 		buf_pool->old_pool_size = buf_pool_size;
-		buf_pool->curr_size = chunk->size;
+		buf_pool->old_size = buf_pool->curr_size;
 		buf_pool->read_ahead_area
 			= ut_min(64, ut_2_power_up(buf_pool->curr_size / 32));
 		buf_pool->curr_pool_size = buf_pool->curr_size * UNIV_PAGE_SIZE;
@@ -1569,6 +1706,15 @@ buf_pool_init_instance(
 
 	/* All fields are initialized by mem_zalloc(). */
 
+	if (srv_lru_algorithm == SRV_LRU_ALGORITHM_ADAPTIVE) {
+		/* Remember about as many evicted pages as there are
+		pages in the instance, like the ghost lists of ARC. */
+		buf_pool->LRU_ghost_size = ut_max(buf_pool->curr_size, 1);
+		buf_pool->LRU_ghost = (buf_LRU_ghost_t*) mem_zalloc(
+			sizeof(*buf_pool->LRU_ghost)
+			* buf_pool->LRU_ghost_size);
+	}
+
 	/* Initialize the temporal memory array and slots */
 	buf_pool->tmp_arr = (buf_tmp_array_t *)mem_zalloc(sizeof(buf_tmp_array_t));
 	ulint n_slots = srv_n_read_io_threads * srv_n_write_io_threads * (8 * OS_AIO_N_PENDING_IOS_PER_THREAD);
@@ -1619,6 +1765,11 @@ buf_pool_free_instance(
 	mem_free(buf_pool->watch);
 	buf_pool->watch = NULL;
 
+	if (buf_pool->LRU_ghost) {
+		mem_free(buf_pool->LRU_ghost);
+		buf_pool->LRU_ghost = NULL;
+	}
+
 	for (i = BUF_FLUSH_LRU; i < BUF_FLUSH_N_TYPES; i++) {
 		os_event_free(buf_pool->no_flush[i]);
 	}
@@ -1634,18 +1785,15 @@ buf_pool_free_instance(
 	chunk = chunks + buf_pool->n_chunks;
 
 	while (--chunk >= chunks) {
-		buf_block_t* block = chunk->blocks;
-		for (i = 0; i < chunk->size; i++, block++) {
-			mutex_free(&block->mutex);
-			rw_lock_free(&block->lock);
-#ifdef UNIV_SYNC_DEBUG
-			rw_lock_free(&block->debug_latch);
-#endif
-		}
+		buf_chunk_free_blocks(chunk);
 		os_mem_free_large(chunk->mem, chunk->mem_size);
 	}
 
 	mem_free(buf_pool->chunks);
+
+	if (buf_pool->chunks_old != NULL) {
+		mem_free(buf_pool->chunks_old);
+	}
 	ha_clear(buf_pool->page_hash);
 	hash_table_free(buf_pool->page_hash);
 	hash_table_free(buf_pool->zip_hash);
@@ -1707,6 +1855,30 @@ buf_pool_init(
 				strerror(errno));
 		}
 	}
+
+	buf_numa_n_nodes = 0;
+
+	if (srv_numa_bind && srv_numa_interleave) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"innodb_numa_bind is ignored because"
+			" innodb_numa_interleave is set.");
+	} else if (srv_numa_bind && numa_available() == -1) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"innodb_numa_bind is ignored because NUMA"
+			" is not available on this system.");
+	} else if (srv_numa_bind) {
+		for (int node = 0; node <= numa_max_node()
+			     && buf_numa_n_nodes < MAX_BUFFER_POOLS; node++) {
+			if (numa_bitmask_isbitset(numa_all_nodes_ptr, node)) {
+				buf_numa_nodes[buf_numa_n_nodes++] = node;
+			}
+		}
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Binding " ULINTPF " buffer pool instances to "
+			ULINTPF " NUMA nodes", n_instances,
+			ut_min(n_instances, buf_numa_n_nodes));
+	}
 #endif // HAVE_LIBNUMA
 
 	buf_pool_ptr = (buf_pool_t*) mem_zalloc(
@@ -1715,6 +1887,15 @@ buf_pool_init(
 	for (i = 0; i < n_instances; i++) {
 		buf_pool_t*	ptr	= &buf_pool_ptr[i];
 
+#ifdef HAVE_LIBNUMA
+		/* Allocate the control structures of the instance
+		on its node as well. */
+		if (buf_numa_n_nodes) {
+			numa_set_preferred(
+				buf_numa_nodes[i % buf_numa_n_nodes]);
+		}
+#endif // HAVE_LIBNUMA
+
 		if (buf_pool_init_instance(ptr, size, i) != DB_SUCCESS) {
 
 			/* Free all the instances created so far. */
@@ -1724,6 +1905,12 @@ buf_pool_init(
 		}
 	}
 
+#ifdef HAVE_LIBNUMA
+	if (buf_numa_n_nodes) {
+		numa_set_localalloc();
+	}
+#endif // HAVE_LIBNUMA
+
 	buf_pool_set_sizes();
 	buf_LRU_old_ratio_update(100 * 3/ 8, FALSE);
 
@@ -1763,6 +1950,679 @@ buf_pool_free(
 	buf_pool_ptr = NULL;
 }
 
+/********************************************************************//**
+Determines if a block is intended to be withdrawn. The caller must
+hold buf_pool->free_list_mutex or otherwise ensure that the chunks
+being withdrawn cannot change.
+@return true if will be withdrawn */
+UNIV_INTERN
+bool
+buf_block_will_withdrawn(
+/*=====================*/
+	buf_pool_t*		buf_pool,	/*!< in: buffer pool instance */
+	const buf_block_t*	block)		/*!< in: pointer to control
+						block */
+{
+	const buf_chunk_t*	chunk
+		= buf_pool->chunks + buf_pool->n_chunks_new;
+	const buf_chunk_t*	echunk
+		= buf_pool->chunks + buf_pool->n_chunks;
+
+	while (chunk < echunk) {
+		if (block >= chunk->blocks
+		    && block < chunk->blocks + chunk->size) {
+			return(true);
+		}
+		++chunk;
+	}
+
+	return(false);
+}
+
+/********************************************************************//**
+Determines if a frame is intended to be withdrawn. The caller must
+hold buf_pool->free_list_mutex, buf_pool->zip_free_mutex or otherwise
+ensure that the chunks being withdrawn cannot change.
+@return true if will be withdrawn */
+UNIV_INTERN
+bool
+buf_frame_will_withdrawn(
+/*=====================*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	const byte*	ptr)		/*!< in: pointer to a frame */
+{
+	const buf_chunk_t*	chunk
+		= buf_pool->chunks + buf_pool->n_chunks_new;
+	const buf_chunk_t*	echunk
+		= buf_pool->chunks + buf_pool->n_chunks;
+
+	while (chunk < echunk) {
+		if (ptr >= chunk->blocks->frame
+		    && ptr < chunk->blocks->frame
+		    + chunk->size * UNIV_PAGE_SIZE) {
+			return(true);
+		}
+		++chunk;
+	}
+
+	return(false);
+}
+
+/********************************************************************//**
+Sets the global variable that feeds MySQL's
+innodb_buffer_pool_resize_status to the specified string and writes it
+to the error log. The format and the following parameters are the same
+as the ones used for printf(3). */
+static MY_ATTRIBUTE((nonnull, format(printf, 1, 2)))
+void
+buf_resize_status(
+/*==============*/
+	const char*	fmt,	/*!< in: format */
+	...)			/*!< in: extra parameters according
+				to fmt */
+{
+	va_list	ap;
+
+	va_start(ap, fmt);
+
+	ut_vsnprintf(
+		export_vars.innodb_buffer_pool_resize_status,
+		sizeof(export_vars.innodb_buffer_pool_resize_status),
+		fmt, ap);
+
+	va_end(ap);
+
+	ib_logf(IB_LOG_LEVEL_INFO, "%s",
+		export_vars.innodb_buffer_pool_resize_status);
+}
+
+/********************************************************************//**
+Tries to evict or write out a page that is in the way of shrinking the
+buffer pool.  The caller must hold buf_pool->LRU_list_mutex and the
+block mutex of bpage.  Both are released by this function.
+@return true if the page was evicted or written out */
+static
+bool
+buf_pool_withdraw_page(
+/*===================*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_page_t*	bpage)		/*!< in: page to get rid of */
+{
+	ib_mutex_t*	block_mutex = buf_page_get_mutex(bpage);
+
+	ut_ad(mutex_own(&buf_pool->LRU_list_mutex));
+	ut_ad(mutex_own(block_mutex));
+
+	if (buf_flush_ready_for_replace(bpage)) {
+		if (buf_LRU_free_page(bpage, true)) {
+			/* buf_LRU_free_page() released the LRU list
+			mutex; the freed block went to the withdraw list
+			if it belongs to a chunk being withdrawn. */
+			mutex_exit(block_mutex);
+			return(true);
+		}
+	} else if (buf_flush_ready_for_flush(bpage, BUF_FLUSH_SINGLE_PAGE)
+		   && buf_flush_page(buf_pool, bpage,
+				     BUF_FLUSH_SINGLE_PAGE, true)) {
+		/* buf_flush_page() released both mutexes.  The page is
+		clean now and will be evicted by the next pass. */
+		return(true);
+	}
+
+	mutex_exit(block_mutex);
+	mutex_exit(&buf_pool->LRU_list_mutex);
+
+	return(false);
+}
+
+/********************************************************************//**
+Withdraws the blocks of the chunks that a shrinking buf_pool_resize() is
+going to free.  Free blocks are moved to buf_pool->withdraw.  Clean file
+pages are evicted and dirty ones are written out so that a later pass
+can evict them.  Compressed pages whose frames were allocated from the
+withdrawn chunks are evicted, too.  Blocks that are buffer-fixed,
+I/O-fixed or used for other purposes (BUF_BLOCK_MEMORY) are skipped;
+they reach the withdraw list when they are eventually freed.
+@return true if the withdraw list is still short of the target and the
+caller should retry later */
+static
+bool
+buf_pool_withdraw_blocks(
+/*=====================*/
+	buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+{
+	buf_page_t*	bpage;
+	ulint		n_withdrawn;
+
+	ut_ad(buf_pool->withdraw_target > 0);
+
+	/* 1. Take the free blocks of the withdrawn chunks. */
+	mutex_enter(&buf_pool->free_list_mutex);
+
+	bpage = UT_LIST_GET_FIRST(buf_pool->free);
+
+	while (bpage != NULL
+	       && UT_LIST_GET_LEN(buf_pool->withdraw)
+	       < buf_pool->withdraw_target) {
+
+		buf_page_t*	next = UT_LIST_GET_NEXT(list, bpage);
+
+		if (buf_block_will_withdrawn(
+			    buf_pool, reinterpret_cast<buf_block_t*>(bpage))) {
+
+			ut_ad(bpage->in_free_list);
+			ut_d(bpage->in_free_list = FALSE);
+			UT_LIST_REMOVE(list, buf_pool->free, bpage);
+			UT_LIST_ADD_LAST(list, buf_pool->withdraw, bpage);
+		}
+
+		bpage = next;
+	}
+
+	n_withdrawn = UT_LIST_GET_LEN(buf_pool->withdraw);
+
+	mutex_exit(&buf_pool->free_list_mutex);
+
+	if (n_withdrawn >= buf_pool->withdraw_target) {
+		return(false);
+	}
+
+	/* 2. Evict or write out the file pages that live in the
+	withdrawn chunks.  Only this thread changes buf_pool->chunks. */
+	for (buf_chunk_t* chunk = buf_pool->chunks + buf_pool->n_chunks_new;
+	     chunk < buf_pool->chunks + buf_pool->n_chunks;
+	     chunk++) {
+
+		buf_block_t*	block = chunk->blocks;
+
+		for (ulint i = chunk->size; i--; block++) {
+
+			if (buf_block_get_state(block)
+			    != BUF_BLOCK_FILE_PAGE) {
+				/* A dirty read: the state is checked
+				again below. */
+				continue;
+			}
+
+			mutex_enter(&buf_pool->LRU_list_mutex);
+			mutex_enter(&block->mutex);
+
+			if (buf_block_get_state(block)
+			    != BUF_BLOCK_FILE_PAGE) {
+				mutex_exit(&block->mutex);
+				mutex_exit(&buf_pool->LRU_list_mutex);
+				continue;
+			}
+
+			buf_pool_withdraw_page(buf_pool, &block->page);
+		}
+	}
+
+	/* 3. Evict the compressed pages whose frames were allocated by
+	the buddy allocator from the withdrawn chunks, so that those
+	blocks are returned as well.  Every successful eviction releases
+	the LRU list mutex and restarts the scan; bound the work done by
+	one pass. */
+	mutex_enter(&buf_pool->LRU_list_mutex);
+
+	ulint	n_scan_left = 2 * UT_LIST_GET_LEN(buf_pool->LRU);
+
+	bpage = UT_LIST_GET_LAST(buf_pool->LRU);
+
+	while (bpage != NULL && n_scan_left-- > 0) {
+
+		buf_page_t*	prev = UT_LIST_GET_PREV(LRU, bpage);
+
+		if (bpage->zip.data != NULL
+		    && buf_frame_will_withdrawn(
+			    buf_pool,
+			    static_cast<const byte*>(bpage->zip.data))) {
+
+			ib_mutex_t*	block_mutex = buf_page_get_mutex(bpage);
+
+			mutex_enter(block_mutex);
+
+			if (buf_flush_ready_for_replace(bpage)
+			    || buf_flush_ready_for_flush(
+				    bpage, BUF_FLUSH_SINGLE_PAGE)) {
+
+				/* This releases the mutexes; start over. */
+				buf_pool_withdraw_page(buf_pool, bpage);
+
+				mutex_enter(&buf_pool->LRU_list_mutex);
+				bpage = UT_LIST_GET_LAST(buf_pool->LRU);
+				continue;
+			}
+
+			mutex_exit(block_mutex);
+		}
+
+		bpage = prev;
+	}
+
+	mutex_exit(&buf_pool->LRU_list_mutex);
+
+	mutex_enter(&buf_pool->free_list_mutex);
+	n_withdrawn = UT_LIST_GET_LEN(buf_pool->withdraw);
+	mutex_exit(&buf_pool->free_list_mutex);
+
+	return(n_withdrawn < buf_pool->withdraw_target);
+}
+
+/********************************************************************//**
+Gives the withdrawn blocks back to the free list when a shrinking
+buf_pool_resize() is abandoned. */
+static
+void
+buf_pool_withdraw_cancel(
+/*=====================*/
+	buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+{
+	buf_page_t*	bpage;
+
+	mutex_enter(&buf_pool->free_list_mutex);
+
+	while ((bpage = UT_LIST_GET_FIRST(buf_pool->withdraw)) != NULL) {
+		UT_LIST_REMOVE(list, buf_pool->withdraw, bpage);
+		UT_LIST_ADD_LAST(list, buf_pool->free, bpage);
+		ut_d(bpage->in_free_list = TRUE);
+	}
+
+	buf_pool->withdraw_target = 0;
+	buf_pool->n_chunks_new = buf_pool->n_chunks;
+	buf_pool->curr_size = buf_pool->old_size;
+
+	mutex_exit(&buf_pool->free_list_mutex);
+}
+
+/********************************************************************//**
+Rebuilds the page hash and the zip hash of a buffer pool instance for
+its new size.  The page_hash keeps its rw_locks; only the cell array is
+replaced.  hash_lock_s_confirm() and hash_lock_x_confirm() make the
+threads that were waiting for a page_hash latch notice that the latch
+protecting their fold may have changed.  The caller must hold the LRU
+list mutex, all page_hash latches and the zip hash mutex. */
+static
+void
+buf_pool_resize_hash(
+/*=================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	hash_table_t*	new_hash_table;
+
+	ut_ad(mutex_own(&buf_pool->zip_hash_mutex));
+
+	new_hash_table = hash_create(2 * buf_pool->curr_size);
+
+	for (ulint i = 0; i < hash_get_n_cells(buf_pool->page_hash); i++) {
+		buf_page_t*	bpage = static_cast<buf_page_t*>(
+			HASH_GET_FIRST(buf_pool->page_hash, i));
+
+		while (bpage) {
+			buf_page_t*	next = static_cast<buf_page_t*>(
+				HASH_GET_NEXT(hash, bpage));
+
+			HASH_INSERT(buf_page_t, hash, new_hash_table,
+				    buf_page_address_fold(bpage->space,
+							  bpage->offset),
+				    bpage);
+
+			bpage = next;
+		}
+	}
+
+	std::swap(buf_pool->page_hash->array, new_hash_table->array);
+	std::swap(buf_pool->page_hash->n_cells, new_hash_table->n_cells);
+	hash_table_free(new_hash_table);
+
+	new_hash_table = hash_create(2 * buf_pool->curr_size);
+
+	for (ulint i = 0; i < hash_get_n_cells(buf_pool->zip_hash); i++) {
+		buf_page_t*	bpage = static_cast<buf_page_t*>(
+			HASH_GET_FIRST(buf_pool->zip_hash, i));
+
+		while (bpage) {
+			buf_page_t*	next = static_cast<buf_page_t*>(
+				HASH_GET_NEXT(hash, bpage));
+
+			HASH_INSERT(buf_page_t, hash, new_hash_table,
+				    BUF_POOL_ZIP_FOLD_BPAGE(bpage), bpage);
+
+			bpage = next;
+		}
+	}
+
+	hash_table_free(buf_pool->zip_hash);
+	buf_pool->zip_hash = new_hash_table;
+}
+
+/********************************************************************//**
+Frees the withdrawn chunks or allocates the new chunks of a buffer pool
+instance.  The caller must hold the LRU list mutex, all page_hash
+latches, the free list mutex and the zip free and zip hash mutexes.
+@return false if not all new chunks could be allocated */
+static
+bool
+buf_pool_resize_chunks(
+/*===================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	bool	success = true;
+
+	ut_ad(mutex_own(&buf_pool->LRU_list_mutex));
+	ut_ad(mutex_own(&buf_pool->free_list_mutex));
+
+	if (buf_pool->n_chunks_new < buf_pool->n_chunks) {
+		/* Every block of the withdrawn chunks is in
+		buf_pool->withdraw, and nothing else is. */
+		ut_a(UT_LIST_GET_LEN(buf_pool->withdraw)
+		     == buf_pool->withdraw_target);
+
+		UT_LIST_INIT(buf_pool->withdraw);
+		buf_pool->withdraw_target = 0;
+
+		buf_chunk_t*	chunk = buf_pool->chunks + buf_pool->n_chunks;
+		buf_chunk_t*	echunk
+			= buf_pool->chunks + buf_pool->n_chunks_new;
+
+		/* Latch-free readers of buf_pool->chunks look at
+		n_chunks first; the array itself stays as it is. */
+		buf_pool->n_chunks = buf_pool->n_chunks_new;
+		os_wmb;
+
+		while (--chunk >= echunk) {
+			buf_chunk_free_blocks(chunk);
+			os_mem_free_large(chunk->mem, chunk->mem_size);
+		}
+	} else if (buf_pool->n_chunks_new > buf_pool->n_chunks) {
+		buf_chunk_t*	new_chunks = static_cast<buf_chunk_t*>(
+			mem_zalloc(buf_pool->n_chunks_new
+				   * sizeof *new_chunks));
+		buf_chunk_t*	chunk = new_chunks + buf_pool->n_chunks;
+
+		memcpy(new_chunks, buf_pool->chunks,
+		       buf_pool->n_chunks * sizeof *new_chunks);
+
+		for (; chunk < new_chunks + buf_pool->n_chunks_new; chunk++) {
+			if (!buf_chunk_init(buf_pool, chunk,
+					    srv_buf_pool_chunk_unit)) {
+				ib_logf(IB_LOG_LEVEL_ERROR,
+					"Cannot allocate memory for"
+					" buffer pool instance %lu chunk %lu.",
+					buf_pool->instance_no,
+					(ulint) (chunk - new_chunks));
+				success = false;
+				break;
+			}
+		}
+
+		buf_pool->n_chunks_new = chunk - new_chunks;
+
+		/* Publish the array before the number of chunks, see
+		buf_block_align_instance().  The replaced array is freed
+		by the next resize. */
+		ut_ad(buf_pool->chunks_old == NULL);
+		buf_pool->chunks_old = buf_pool->chunks;
+		buf_pool->chunks = new_chunks;
+		os_wmb;
+		buf_pool->n_chunks = buf_pool->n_chunks_new;
+	}
+
+	buf_pool->curr_size = 0;
+
+	for (ulint i = 0; i < buf_pool->n_chunks; i++) {
+		buf_pool->curr_size += buf_pool->chunks[i].size;
+	}
+
+	buf_pool->old_size = buf_pool->curr_size;
+	buf_pool->curr_pool_size = buf_pool->curr_size * UNIV_PAGE_SIZE;
+	buf_pool->old_pool_size = buf_pool->n_chunks * srv_buf_pool_chunk_unit;
+	buf_pool->read_ahead_area
+		= ut_min(64, ut_2_power_up(buf_pool->curr_size / 32));
+
+	return(success);
+}
+
+/********************************************************************//**
+Resizes the buffer pool to srv_buf_pool_size while the server keeps
+running.  Every instance grows or shrinks by whole chunks of
+srv_buf_pool_chunk_unit bytes.  When shrinking, the blocks of the
+chunks to be freed are first withdrawn while the rest of the buffer
+pool is in use; the whole buffer pool is latched only for the short
+time it takes to free or allocate the chunks and to rebuild the
+page hash. */
+static
+void
+buf_pool_resize(void)
+/*=================*/
+{
+	const ulint	target_size = srv_buf_pool_size;
+	const ulint	n_chunks_new = target_size / srv_buf_pool_instances
+		/ srv_buf_pool_chunk_unit;
+	bool		btr_search_was_enabled;
+	bool		success = true;
+	ulint		retry_interval = 1;
+	ib_time_t	last_report = ut_time();
+
+	ut_ad(!srv_read_only_mode);
+	ut_ad(target_size % (srv_buf_pool_instances
+			     * srv_buf_pool_chunk_unit) == 0);
+
+	buf_resize_status("Resizing buffer pool from %lu to %lu"
+			  " (unit=%lu).",
+			  srv_buf_pool_old_size, target_size,
+			  srv_buf_pool_chunk_unit);
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		mutex_enter(&buf_pool->LRU_list_mutex);
+
+		/* Nobody can be scanning the array that the previous
+		resize replaced any more. */
+		if (buf_pool->chunks_old != NULL) {
+			mem_free(buf_pool->chunks_old);
+			buf_pool->chunks_old = NULL;
+		}
+
+		mutex_enter(&buf_pool->free_list_mutex);
+
+		ut_ad(buf_pool->withdraw_target == 0);
+		ut_ad(UT_LIST_GET_LEN(buf_pool->withdraw) == 0);
+
+		buf_pool->old_size = buf_pool->curr_size;
+		buf_pool->n_chunks_new = n_chunks_new;
+
+		for (ulint j = n_chunks_new; j < buf_pool->n_chunks; j++) {
+			buf_pool->withdraw_target += buf_pool->chunks[j].size;
+		}
+
+		/* Size the LRU list for the new size right away. */
+		buf_pool->curr_size -= buf_pool->withdraw_target;
+
+		mutex_exit(&buf_pool->free_list_mutex);
+		mutex_exit(&buf_pool->LRU_list_mutex);
+	}
+
+	/* The adaptive hash index points into the frames that may be
+	freed, and its hash tables are sized by the buffer pool size. */
+	btr_search_was_enabled = btr_search_enabled;
+
+	if (btr_search_was_enabled) {
+		buf_resize_status("Disabling adaptive hash index.");
+		btr_search_disable();
+	}
+
+withdraw_retry:
+	bool	should_retry_withdraw = false;
+	ulint	n_withdrawn = 0;
+	ulint	n_withdraw_target = 0;
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		if (buf_pool->withdraw_target > 0) {
+			should_retry_withdraw
+				|= buf_pool_withdraw_blocks(buf_pool);
+			n_withdrawn += UT_LIST_GET_LEN(buf_pool->withdraw);
+			n_withdraw_target += buf_pool->withdraw_target;
+		}
+	}
+
+	if (srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+		for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+			buf_pool_withdraw_cancel(buf_pool_from_array(i));
+		}
+
+		srv_buf_pool_size = srv_buf_pool_old_size;
+		buf_resize_status("Resizing buffer pool was aborted.");
+
+		goto func_exit;
+	}
+
+	if (should_retry_withdraw) {
+		if (ut_time() - last_report >= 10) {
+			buf_resize_status("Withdrawing blocks to be shrunken"
+					  " (%lu/%lu). Blocks that are in"
+					  " use by long running transactions"
+					  " may delay this.",
+					  n_withdrawn, n_withdraw_target);
+			last_report = ut_time();
+		}
+
+		os_thread_sleep(retry_interval * 100000);
+
+		if (retry_interval < 10) {
+			retry_interval++;
+		}
+
+		goto withdraw_retry;
+	}
+
+	/* No block of the withdrawn chunks is in use any more. Make
+	the block pointers that were saved before this point obsolete;
+	the chunks will be freed once the whole buffer pool is latched. */
+	buf_withdraw_clock++;
+	os_wmb;
+
+	buf_resize_status("Latching whole of buffer pool.");
+
+	/* buf_pool_clear_hash_index() scans the chunks while holding
+	the adaptive hash index latches. */
+	btr_search_x_lock_all();
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		mutex_enter(&buf_pool->LRU_list_mutex);
+		hash_lock_x_all(buf_pool->page_hash);
+		mutex_enter(&buf_pool->free_list_mutex);
+		mutex_enter(&buf_pool->zip_free_mutex);
+		mutex_enter(&buf_pool->zip_hash_mutex);
+	}
+
+	buf_resize_status("%s chunks.",
+			  target_size < srv_buf_pool_old_size
+			  ? "Freeing" : "Allocating");
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		if (!buf_pool_resize_chunks(buf_pool)) {
+			success = false;
+		}
+
+		/* Rebuild the hash tables if the new size differs from
+		the one they were sized for by more than a factor of 2. */
+		if (buf_pool->curr_size > hash_get_n_cells(buf_pool->page_hash)
+		    || buf_pool->curr_size * 4
+		    < hash_get_n_cells(buf_pool->page_hash)) {
+			buf_pool_resize_hash(buf_pool);
+		}
+	}
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		mutex_exit(&buf_pool->zip_hash_mutex);
+		mutex_exit(&buf_pool->zip_free_mutex);
+		mutex_exit(&buf_pool->free_list_mutex);
+		hash_unlock_x_all(buf_pool->page_hash);
+		mutex_exit(&buf_pool->LRU_list_mutex);
+	}
+
+	btr_search_x_unlock_all();
+
+	buf_pool_set_sizes();
+
+	if (success) {
+		srv_buf_pool_old_size = target_size;
+	} else {
+		/* Some chunks could not be allocated.  Settle for what
+		we have. */
+		ulint	size = 0;
+
+		for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+			size += buf_pool_from_array(i)->n_chunks
+				* srv_buf_pool_chunk_unit;
+		}
+
+		srv_buf_pool_old_size = srv_buf_pool_size = size;
+	}
+
+	btr_search_sys_resize(buf_pool_get_curr_size() / sizeof(void*) / 64);
+
+	buf_resize_status("Completed resizing buffer pool%s. New size %lu.",
+			  success ? "" : " with errors",
+			  srv_buf_pool_size);
+
+func_exit:
+	if (btr_search_was_enabled) {
+		btr_search_enable();
+	}
+
+#if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
+	ut_a(buf_validate());
+#endif /* UNIV_DEBUG || UNIV_BUF_DEBUG */
+}
+
+/*****************************************************************//**
+This is the thread that resizes the buffer pool online. It waits for
+srv_buf_resize_event and resizes the buffer pool to srv_buf_pool_size.
+@return this function does not return, it calls os_thread_exit() */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_resize_thread)(
+/*==============================*/
+	void*	arg MY_ATTRIBUTE((unused)))	/*!< in: a dummy parameter
+						required by os_thread_create */
+{
+	ut_ad(!srv_read_only_mode);
+
+	srv_buf_resize_thread_active = TRUE;
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+
+		os_event_wait(srv_buf_resize_event);
+		os_event_reset(srv_buf_resize_event);
+
+		/* innodb_buffer_pool_size may be changed again while
+		a resize is running; keep going until it settles. */
+		while (srv_shutdown_state == SRV_SHUTDOWN_NONE
+		       && buf_pool_is_resizing()) {
+			buf_pool_resize();
+		}
+	}
+
+	srv_buf_resize_thread_active = FALSE;
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /********************************************************************//**
 Clears the adaptive hash index on all pages in the buffer pool. */
 UNIV_INTERN
@@ -2092,6 +2952,8 @@ buf_pool_watch_unset(
 	prio_rw_lock_t*	hash_lock = buf_page_hash_lock_get(buf_pool, fold);
 
 	rw_lock_x_lock(hash_lock);
+	hash_lock = hash_lock_x_confirm(
+		hash_lock, buf_pool->page_hash, fold);
 
 	/* The page must exist because buf_pool_watch_set() increments
 	buf_fix_count. */
@@ -2138,6 +3000,8 @@ buf_pool_watch_occurred(
 							     fold);
 
 	rw_lock_s_lock(hash_lock);
+	hash_lock = hash_lock_s_confirm(
+		hash_lock, buf_pool->page_hash, fold);
 
 	/* The page must exist because buf_pool_watch_set()
 	increments buf_fix_count. */
@@ -2351,7 +3215,7 @@ buf_page_get_zip(
 	if (UNIV_UNLIKELY(innobase_get_slow_log())) {
 		trx = innobase_get_trx();
 	}
-	buf_pool->stat.n_page_gets++;
+	buf_pool_stat_page_get(buf_pool);
 
 	for (;;) {
 lookup:
@@ -2593,12 +3457,20 @@ buf_block_align_instance(
 	buf_chunk_t*	chunk;
 	ulint		i;
 
-	/* TODO: protect buf_pool->chunks with a mutex (it will
-	currently remain constant after buf_pool_init()) */
-	for (chunk = buf_pool->chunks, i = buf_pool->n_chunks; i--; chunk++) {
+	/* buf_pool->chunks is scanned without a latch.  buf_pool_resize()
+	publishes a bigger chunks array before it increments n_chunks,
+	decrements n_chunks without shrinking the array, and keeps a
+	replaced array until the next resize.  Chunks that are not
+	known to contain ptr are never dereferenced, because their
+	memory may just have been freed. */
+	i = buf_pool->n_chunks;
+	os_rmb;
+	for (chunk = buf_pool->chunks; i--; chunk++) {
 		ulint	offs;
 
-		if (UNIV_UNLIKELY(ptr < chunk->blocks->frame)) {
+		if (ptr < (const byte*) chunk->mem
+		    || ptr >= (const byte*) chunk->mem + chunk->mem_size
+		    || UNIV_UNLIKELY(ptr < chunk->blocks->frame)) {
 
 			continue;
 		}
@@ -2721,11 +3593,13 @@ buf_pointer_is_block_field_instance(
 	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
 	const void*	ptr)		/*!< in: pointer not dereferenced */
 {
+	const ulint			n_chunks = buf_pool->n_chunks;
+	os_rmb;
 	const buf_chunk_t*		chunk	= buf_pool->chunks;
-	const buf_chunk_t* const	echunk	= chunk + buf_pool->n_chunks;
+	const buf_chunk_t* const	echunk	= chunk + n_chunks;
 
-	/* TODO: protect buf_pool->chunks with a mutex (it will
-	currently remain constant after buf_pool_init()) */
+	/* buf_pool->chunks is scanned without a latch, see
+	buf_block_align_instance() */
 	while (chunk < echunk) {
 		if (ptr >= (void*) chunk->blocks
 		    && ptr < (void*) (chunk->blocks + chunk->size)) {
@@ -2936,13 +3810,15 @@ buf_page_get_gen(
 	if (UNIV_UNLIKELY(innobase_get_slow_log())) {
 		trx = innobase_get_trx();
 	}
-	buf_pool->stat.n_page_gets++;
+	buf_pool_stat_page_get(buf_pool);
 	fold = buf_page_address_fold(space, offset);
 	hash_lock = buf_page_hash_lock_get(buf_pool, fold);
 loop:
 	block = guess;
 
 	rw_lock_s_lock(hash_lock);
+	hash_lock = hash_lock_s_confirm(
+		hash_lock, buf_pool->page_hash, fold);
 
 	if (block != NULL) {
 
@@ -2981,6 +3857,8 @@ buf_page_get_gen(
 		if (mode == BUF_GET_IF_IN_POOL_OR_WATCH) {
 			mutex_enter(&buf_pool->LRU_list_mutex);
 			rw_lock_x_lock(hash_lock);
+			hash_lock = hash_lock_x_confirm(
+				hash_lock, buf_pool->page_hash, fold);
 			block = (buf_block_t*) buf_pool_watch_set(
 				space, offset, fold);
 			mutex_exit(&buf_pool->LRU_list_mutex);
@@ -3206,6 +4084,8 @@ buf_page_get_gen(
 		mutex_enter(&buf_pool->LRU_list_mutex);
 
 		rw_lock_x_lock(hash_lock);
+		hash_lock = hash_lock_x_confirm(
+			hash_lock, buf_pool->page_hash, fold);
 
 		/* Buffer-fixing prevents the page_hash from changing. */
 		ut_ad(bpage == buf_page_hash_get_low(
@@ -3381,6 +4261,8 @@ buf_page_get_gen(
 			if (mode == BUF_GET_IF_IN_POOL_OR_WATCH) {
 				mutex_enter(&buf_pool->LRU_list_mutex);
 				rw_lock_x_lock(hash_lock);
+				hash_lock = hash_lock_x_confirm(
+					hash_lock, buf_pool->page_hash, fold);
 
 				/* Set the watch, as it would have
 				been set if the page were not in the
@@ -3390,6 +4272,8 @@ buf_page_get_gen(
 				mutex_exit(&buf_pool->LRU_list_mutex);
 			} else {
 				rw_lock_x_lock(hash_lock);
+				hash_lock = hash_lock_x_confirm(
+					hash_lock, buf_pool->page_hash, fold);
 				block = (buf_block_t*) buf_page_hash_get_low(
 					buf_pool, space, offset, fold);
 			}
@@ -3637,7 +4521,7 @@ buf_page_optimistic_get(
 			    buf_block_get_page_no(block)) == 0);
 #endif
 	buf_pool = buf_pool_from_block(block);
-	buf_pool->stat.n_page_gets++;
+	buf_pool_stat_page_get(buf_pool);
 
 	if (UNIV_UNLIKELY(trx && trx->take_stats)) {
 		_increment_page_get_statistics(block, trx);
@@ -3744,7 +4628,7 @@ buf_page_get_known_nowait(
 	     || (ibuf_count_get(buf_block_get_space(block),
 				buf_block_get_page_no(block)) == 0));
 #endif
-	buf_pool->stat.n_page_gets++;
+	buf_pool_stat_page_get(buf_pool);
 
 	if (UNIV_UNLIKELY(innobase_get_slow_log())) {
 
@@ -3846,7 +4730,7 @@ buf_page_try_get_func(
 #endif /* UNIV_DEBUG_FILE_ACCESSES || UNIV_DEBUG */
 	buf_block_dbg_add_level(block, SYNC_NO_ORDER_CHECK);
 
-	buf_pool->stat.n_page_gets++;
+	buf_pool_stat_page_get(buf_pool);
 
 #ifdef UNIV_IBUF_COUNT_DEBUG
 	ut_a(ibuf_count_get(buf_block_get_space(block),
@@ -3869,6 +4753,8 @@ buf_page_init_low(
 	bpage->buf_fix_count = 0;
 	bpage->freed_page_clock = 0;
 	bpage->access_time = 0;
+	bpage->access_ref = 0;
+	bpage->made_young = 0;
 	bpage->newest_modification = 0;
 	bpage->oldest_modification = 0;
 	bpage->write_size = 0;
@@ -4055,6 +4941,8 @@ buf_page_init_for_read(
 	ut_ad(!mutex_own(&buf_pool->LRU_list_mutex));
 	mutex_enter(&buf_pool->LRU_list_mutex);
 	rw_lock_x_lock(hash_lock);
+	hash_lock = hash_lock_x_confirm(
+		hash_lock, buf_pool->page_hash, fold);
 
 	watch_page = buf_page_hash_get_low(buf_pool, space, offset, fold);
 	if (watch_page && !buf_pool_watch_is_sentinel(buf_pool, watch_page)) {
@@ -4156,6 +5044,8 @@ buf_page_init_for_read(
 		data = buf_buddy_alloc(buf_pool, zip_size, &lru);
 
 		rw_lock_x_lock(hash_lock);
+		hash_lock = hash_lock_x_confirm(
+			hash_lock, buf_pool->page_hash, fold);
 
 		/* We must check the page_hash again, as it may have been
 		modified. */
@@ -4301,6 +5191,8 @@ buf_page_create(
 	ut_ad(!mutex_own(&buf_pool->LRU_list_mutex));
 	mutex_enter(&buf_pool->LRU_list_mutex);
 	rw_lock_x_lock(hash_lock);
+	hash_lock = hash_lock_x_confirm(
+		hash_lock, buf_pool->page_hash, fold);
 
 	block = (buf_block_t*) buf_page_hash_get_low(
 		buf_pool, space, offset, fold);
@@ -4551,6 +5443,8 @@ buf_mark_space_corrupt(
 	if (!bpage->encrypted) {
 		mutex_enter(&buf_pool->LRU_list_mutex);
 		rw_lock_x_lock(hash_lock);
+		hash_lock = hash_lock_x_confirm(
+			hash_lock, buf_pool->page_hash, fold);
 		mutex_enter(buf_page_get_mutex(bpage));
 		ut_ad(buf_page_get_io_fix(bpage) == BUF_IO_READ);
 		ut_ad(bpage->buf_fix_count == 0);
@@ -5379,7 +6273,8 @@ buf_pool_validate_instance(
 
 	mutex_exit(&buf_pool->zip_mutex);
 
-	if (n_lru + n_free > buf_pool->curr_size + n_zip) {
+	if (n_lru + n_free
+	    > ut_max(buf_pool->curr_size, buf_pool->old_size) + n_zip) {
 		fprintf(stderr, "n LRU %lu, n free %lu, pool %lu zip %lu\n",
 			n_lru, n_free,
 			buf_pool->curr_size, n_zip);
@@ -5390,9 +6285,14 @@ buf_pool_validate_instance(
 
 	mutex_exit(&buf_pool->LRU_list_mutex);
 
-	if (UT_LIST_GET_LEN(buf_pool->free) != n_free) {
-		fprintf(stderr, "Free list len %lu, free blocks %lu\n",
+	/* Free blocks in chunks that are being withdrawn may be
+	in buf_pool->withdraw instead of buf_pool->free. */
+	if (UT_LIST_GET_LEN(buf_pool->free)
+	    + UT_LIST_GET_LEN(buf_pool->withdraw) != n_free) {
+		fprintf(stderr, "Free list len %lu, withdraw list len %lu,"
+			" free blocks %lu\n",
 			UT_LIST_GET_LEN(buf_pool->free),
+			UT_LIST_GET_LEN(buf_pool->withdraw),
 			n_free);
 		ut_error;
 	}
@@ -5767,6 +6667,8 @@ buf_stats_aggregate_pool_info(
 	total_info->n_pages_created += pool_info->n_pages_created;
 	total_info->n_pages_written += pool_info->n_pages_written;
 	total_info->n_page_gets += pool_info->n_page_gets;
+	total_info->n_page_gets_remote += pool_info->n_page_gets_remote;
+	total_info->numa_node = ULINT_UNDEFINED;
 	total_info->n_ra_pages_read_rnd += pool_info->n_ra_pages_read_rnd;
 	total_info->n_ra_pages_read += pool_info->n_ra_pages_read;
 	total_info->n_ra_pages_evicted += pool_info->n_ra_pages_evicted;
@@ -5861,6 +6763,10 @@ buf_stats_get_pool_info(
 
 	pool_info->n_page_gets = buf_pool->stat.n_page_gets;
 
+	pool_info->n_page_gets_remote = buf_pool->stat.n_page_gets_remote;
+
+	pool_info->numa_node = buf_pool->numa_node;
+
 	pool_info->n_ra_pages_read_rnd = buf_pool->stat.n_ra_pages_read_rnd;
 	pool_info->n_ra_pages_read = buf_pool->stat.n_ra_pages_read;
 
@@ -5979,6 +6885,13 @@ buf_print_io_instance(
 		pool_info->pages_created_rate,
 		pool_info->pages_written_rate);
 
+	if (pool_info->numa_node != ULINT_UNDEFINED) {
+		fprintf(file,
+			"NUMA node %lu, page gets from other nodes %lu\n",
+			pool_info->numa_node,
+			pool_info->n_page_gets_remote);
+	}
+
 	if (pool_info->n_page_get_delta) {
 		double hit_rate = ((1000 * pool_info->page_read_delta)
 				/ pool_info->n_page_get_delta);
@@ -32,6 +32,7 @@ Created 2011/12/19
 
 #include "buf0buf.h"
 #include "buf0checksum.h"
+#include "buf0flu.h"
 #include "srv0start.h"
 #include "srv0srv.h"
 #include "page0zip.h"
@@ -44,11 +45,21 @@ Created 2011/12/19
 #ifdef UNIV_PFS_MUTEX
 /* Key to register the mutex with performance schema */
 UNIV_INTERN mysql_pfs_key_t	buf_dblwr_mutex_key;
+/* Key to register the parallel doublewrite shard mutexes with
+performance schema */
+UNIV_INTERN mysql_pfs_key_t	buf_dblwr_shard_mutex_key;
 #endif /* UNIV_PFS_RWLOCK */
 
 /** The doublewrite buffer */
 UNIV_INTERN buf_dblwr_t*	buf_dblwr = NULL;
 
+/** The parallel doublewrite file */
+UNIV_INTERN buf_parallel_dblwr_t*	buf_parallel_dblwr = NULL;
+
+/** Pages read from the parallel doublewrite file at startup. They are
+referenced from recv_sys->dblwr and freed once recovery is over. */
+static byte*	buf_parallel_dblwr_recv_buf = NULL;
+
 /** Set to TRUE when the doublewrite buffer is being created */
 UNIV_INTERN ibool	buf_dblwr_being_created = FALSE;
 
@@ -351,6 +362,325 @@ buf_dblwr_create(void)
 	goto start_again;
 }
 
+/****************************************************************//**
+Checks if the parallel doublewrite file is enabled in the configuration.
+@return true if innodb_parallel_doublewrite_path is set */
+static
+bool
+buf_parallel_dblwr_enabled(void)
+/*============================*/
+{
+	return(srv_parallel_doublewrite_path != NULL
+	       && *srv_parallel_doublewrite_path != '\0');
+}
+
+/****************************************************************//**
+Builds the path of the parallel doublewrite file. A relative
+innodb_parallel_doublewrite_path is taken relative to the data home
+directory.
+@return path allocated with mem_alloc(), to be freed with mem_free() */
+static
+char*
+buf_parallel_dblwr_make_path(void)
+/*==============================*/
+{
+	const char*	name = srv_parallel_doublewrite_path;
+
+	if (*name == SRV_PATH_SEPARATOR
+#ifdef __WIN__
+	    || (*name != '\0' && name[1] == ':')
+#endif /* __WIN__ */
+	    ) {
+		return(mem_strdup(name));
+	}
+
+	ulint	dirnamelen = strlen(srv_data_home);
+	char*	path = static_cast<char*>(
+		mem_alloc(dirnamelen + strlen(name) + 2));
+
+	memcpy(path, srv_data_home, dirnamelen);
+
+	/* Add a path separator if needed. */
+	if (dirnamelen && path[dirnamelen - 1] != SRV_PATH_SEPARATOR) {
+		path[dirnamelen++] = SRV_PATH_SEPARATOR;
+	}
+
+	strcpy(path + dirnamelen, name);
+
+	return(path);
+}
+
+/****************************************************************//**
+Reads the parallel doublewrite file left by the previous server run, if
+any, and adds its non-empty pages to the pages that crash recovery may
+restore half-written pages from. */
+static
+void
+buf_parallel_dblwr_load_pages(void)
+/*===============================*/
+{
+	ibool		success;
+	os_file_t	file;
+	os_offset_t	size;
+	char*		path;
+	ulint		n_loaded = 0;
+
+	ut_ad(buf_parallel_dblwr_recv_buf == NULL);
+
+	if (!buf_parallel_dblwr_enabled()) {
+		return;
+	}
+
+	path = buf_parallel_dblwr_make_path();
+
+	file = os_file_create_simple_no_error_handling(
+		innodb_file_data_key, path, OS_FILE_OPEN, OS_FILE_READ_ONLY,
+		&success, FALSE);
+
+	if (!success) {
+		/* The file does not exist on the first start with the
+		parallel doublewrite file enabled. */
+		mem_free(path);
+		return;
+	}
+
+	size = os_file_get_size(file);
+
+	if (size == (os_offset_t) -1 || size % UNIV_PAGE_SIZE != 0) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Ignoring parallel doublewrite file %s of unexpected "
+			"size " UINT64PF " bytes.", path, size);
+		goto func_exit;
+	}
+
+	if (size == 0) {
+		goto func_exit;
+	}
+
+	buf_parallel_dblwr_recv_buf = static_cast<byte*>(
+		ut_malloc(size + UNIV_PAGE_SIZE));
+
+	{
+		byte*	buf = static_cast<byte*>(
+			ut_align(buf_parallel_dblwr_recv_buf,
+				 UNIV_PAGE_SIZE));
+
+		if (!os_file_read(file, buf, 0, size)) {
+			ib_logf(IB_LOG_LEVEL_ERROR,
+				"Cannot read parallel doublewrite file %s.",
+				path);
+			goto func_exit;
+		}
+
+		for (byte* page = buf; page < buf + size;
+		     page += UNIV_PAGE_SIZE) {
+
+			if (!buf_page_is_zeroes(page, 0)) {
+				recv_sys->dblwr.add(page);
+				n_loaded++;
+			}
+		}
+	}
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Read " ULINTPF " pages from parallel doublewrite file %s.",
+		n_loaded, path);
+
+func_exit:
+	os_file_close(file);
+	mem_free(path);
+}
+
+/****************************************************************//**
+Frees the parallel doublewrite file shards and closes the file. */
+static
+void
+buf_parallel_dblwr_free(void)
+/*=========================*/
+{
+	if (buf_parallel_dblwr_recv_buf != NULL) {
+		ut_free(buf_parallel_dblwr_recv_buf);
+		buf_parallel_dblwr_recv_buf = NULL;
+	}
+
+	if (buf_parallel_dblwr == NULL) {
+		return;
+	}
+
+	for (ulint i = 0; i < buf_parallel_dblwr->n_shards; i++) {
+		buf_dblwr_shard_t*	shard = &buf_parallel_dblwr->shards[i];
+
+		ut_ad(shard->b_reserved == 0);
+
+		os_event_free(shard->b_event);
+		mem_free(shard->buf_block_arr);
+		mutex_free(&shard->mutex);
+	}
+
+	os_file_close(buf_parallel_dblwr->file);
+
+	mem_free(buf_parallel_dblwr->shards);
+	ut_free(buf_parallel_dblwr->write_buf_unaligned);
+	mem_free(buf_parallel_dblwr->path);
+	mem_free(buf_parallel_dblwr);
+	buf_parallel_dblwr = NULL;
+}
+
+/****************************************************************//**
+Prevents or allows LRU and flush list batches in all buffer pool
+instances. When preventing, waits for running batches to complete. */
+static
+void
+buf_parallel_dblwr_hold_batches(
+/*============================*/
+	bool	hold)	/*!< in: true to prevent, false to allow */
+{
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		for (ulint j = 0; j < 2; j++) {
+			buf_flush_t	flush_type = j == 0
+				? BUF_FLUSH_LRU : BUF_FLUSH_LIST;
+
+			if (!hold) {
+				buf_flush_end(buf_pool, flush_type);
+				continue;
+			}
+
+			/* Reserve the instance like a batch would,
+			so that no batch can start until the
+			reservation is released. */
+			while (!buf_flush_start(buf_pool, flush_type)) {
+				buf_flush_wait_batch_end(buf_pool, flush_type);
+			}
+		}
+	}
+}
+
+/****************************************************************//**
+Creates or recreates the parallel doublewrite file and allocates its
+shards. Must be called after crash recovery, before the page cleaner and
+LRU manager threads are started. Does nothing if the parallel doublewrite
+file is disabled.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+buf_parallel_dblwr_create(void)
+/*===========================*/
+{
+	ibool			success;
+	os_file_t		file;
+	char*			path;
+	buf_parallel_dblwr_t*	dblwr;
+	ulint			n_shards;
+	ulint			batch_size;
+	byte*			write_buf;
+
+	ut_ad(buf_parallel_dblwr == NULL);
+
+	/* Recovery is over, recv_sys->dblwr no longer references the
+	pages read from the old file. */
+	buf_parallel_dblwr_free();
+
+	if (!srv_use_doublewrite_buf || buf_dblwr == NULL
+	    || srv_read_only_mode || !buf_parallel_dblwr_enabled()) {
+		return(DB_SUCCESS);
+	}
+
+	/* Do not switch in the middle of a batch that posted its pages to
+	the doublewrite buffer in the system tablespace. */
+	buf_parallel_dblwr_hold_batches(true);
+
+	n_shards = 2 * srv_buf_pool_instances;
+	batch_size = srv_parallel_doublewrite_batch_size;
+
+	path = buf_parallel_dblwr_make_path();
+
+	file = os_file_create(
+		innodb_file_data_key, path,
+		OS_FILE_OVERWRITE | OS_FILE_ON_ERROR_NO_EXIT, OS_FILE_NORMAL,
+		OS_DATA_FILE, &success, FALSE);
+
+	if (!success) {
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Cannot create parallel doublewrite file %s.", path);
+		mem_free(path);
+		buf_parallel_dblwr_hold_batches(false);
+		return(DB_ERROR);
+	}
+
+	if (!os_file_set_size(path, file, (os_offset_t) n_shards
+			      * batch_size * UNIV_PAGE_SIZE)) {
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Cannot set the size of parallel doublewrite file %s "
+			"to " ULINTPF " pages.", path, n_shards * batch_size);
+		os_file_close(file);
+		mem_free(path);
+		buf_parallel_dblwr_hold_batches(false);
+		return(DB_ERROR);
+	}
+
+	dblwr = static_cast<buf_parallel_dblwr_t*>(
+		mem_zalloc(sizeof(buf_parallel_dblwr_t)));
+
+	dblwr->path = path;
+	dblwr->file = file;
+	dblwr->n_shards = n_shards;
+	dblwr->batch_size = batch_size;
+
+	dblwr->write_buf_unaligned = static_cast<byte*>(
+		ut_malloc((1 + n_shards * batch_size) * UNIV_PAGE_SIZE));
+
+	write_buf = static_cast<byte*>(
+		ut_align(dblwr->write_buf_unaligned, UNIV_PAGE_SIZE));
+
+	dblwr->shards = static_cast<buf_dblwr_shard_t*>(
+		mem_zalloc(n_shards * sizeof(buf_dblwr_shard_t)));
+
+	for (ulint i = 0; i < n_shards; i++) {
+		buf_dblwr_shard_t*	shard = &dblwr->shards[i];
+
+		mutex_create(buf_dblwr_shard_mutex_key,
+			     &shard->mutex, SYNC_DOUBLEWRITE);
+
+		shard->b_event = os_event_create();
+		shard->offset = (os_offset_t) i * batch_size
+			* UNIV_PAGE_SIZE;
+		shard->write_buf = write_buf + i * batch_size
+			* UNIV_PAGE_SIZE;
+		shard->buf_block_arr = static_cast<buf_page_t**>(
+			mem_zalloc(batch_size * sizeof(void*)));
+	}
+
+	buf_parallel_dblwr = dblwr;
+
+	buf_parallel_dblwr_hold_batches(false);
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Using parallel doublewrite file %s with " ULINTPF
+		" shards of " ULINTPF " pages.", path, n_shards, batch_size);
+
+	return(DB_SUCCESS);
+}
+
+/****************************************************************//**
+Returns the parallel doublewrite shard of a batch.
+@return shard used by the batch */
+UNIV_INLINE
+buf_dblwr_shard_t*
+buf_parallel_dblwr_get_shard(
+/*=========================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_flush_t		flush_type)	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
+{
+	ut_ad(buf_parallel_dblwr != NULL);
+	ut_ad(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
+
+	return(&buf_parallel_dblwr->shards[
+		       buf_pool->instance_no * 2 + flush_type]);
+}
+
 /****************************************************************//**
 At a database startup initializes the doublewrite buffer memory structure if
 we already have a doublewrite buffer created in the data files. If we are
@@ -478,6 +808,10 @@ buf_dblwr_init_or_load_pages(
 
 leave_func:
 	ut_free(unaligned_read_buf);
+
+	if (load_corrupt_pages) {
+		buf_parallel_dblwr_load_pages();
+	}
 }
 
 /****************************************************************//**
@@ -676,6 +1010,8 @@ buf_dblwr_free(void)
 	ut_ad(buf_dblwr->s_reserved == 0);
 	ut_ad(buf_dblwr->b_reserved == 0);
 
+	buf_parallel_dblwr_free();
+
 	os_event_free(buf_dblwr->b_event);
 	os_event_free(buf_dblwr->s_event);
 	ut_free(buf_dblwr->write_buf_unaligned);
@@ -708,6 +1044,37 @@ buf_dblwr_update(
 	switch (flush_type) {
 	case BUF_FLUSH_LIST:
 	case BUF_FLUSH_LRU:
+		if (buf_parallel_dblwr != NULL) {
+			buf_dblwr_shard_t*	shard
+				= buf_parallel_dblwr_get_shard(
+					buf_pool_from_bpage(bpage),
+					flush_type);
+
+			mutex_enter(&shard->mutex);
+
+			ut_ad(shard->batch_running);
+			ut_ad(shard->b_reserved > 0);
+			ut_ad(shard->b_reserved <= shard->first_free);
+
+			shard->b_reserved--;
+
+			if (shard->b_reserved == 0) {
+				mutex_exit(&shard->mutex);
+				/* This will finish the batch. Sync data
+				files to the disk. */
+				fil_flush_file_spaces(FIL_TABLESPACE);
+				mutex_enter(&shard->mutex);
+
+				/* We can now reuse the shard: */
+				shard->first_free = 0;
+				shard->batch_running = false;
+				os_event_set(shard->b_event);
+			}
+
+			mutex_exit(&shard->mutex);
+			break;
+		}
+
 		mutex_enter(&buf_dblwr->mutex);
 
 		ut_ad(buf_dblwr->batch_running);
@@ -902,6 +1269,251 @@ buf_dblwr_write_block_to_datafile(
 		(ulint *)&bpage->write_size);
 }
 
+/********************************************************************//**
+Copies a page to a doublewrite write buffer slot. A compressed page is
+padded with zeroes up to UNIV_PAGE_SIZE. */
+static
+void
+buf_dblwr_copy_page(
+/*================*/
+	byte*			dst,	/*!< out: doublewrite buffer slot */
+	const buf_page_t*	bpage)	/*!< in: page to copy */
+{
+	ulint	zip_size = buf_page_get_zip_size(bpage);
+	void*	frame = buf_page_get_frame(bpage);
+
+	if (zip_size) {
+		UNIV_MEM_ASSERT_RW(bpage->zip.data, zip_size);
+		/* Copy the compressed page and clear the rest. */
+		memcpy(dst, frame, zip_size);
+		memset(dst + zip_size, 0, UNIV_PAGE_SIZE - zip_size);
+	} else {
+		ut_a(buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE);
+		UNIV_MEM_ASSERT_RW(((buf_block_t*) bpage)->frame,
+				   UNIV_PAGE_SIZE);
+
+		memcpy(dst, frame, UNIV_PAGE_SIZE);
+	}
+}
+
+/********************************************************************//**
+Checks the blocks of a doublewrite batch and their copies in the write
+buffer before the batch is written to disk. */
+static
+void
+buf_dblwr_check_batch(
+/*==================*/
+	buf_page_t**	buf_block_arr,	/*!< in: blocks of the batch */
+	const byte*	write_buf,	/*!< in: copies of the blocks */
+	ulint		n_pages)	/*!< in: number of pages */
+{
+	for (ulint len = 0, i = 0; i < n_pages;
+	     len += UNIV_PAGE_SIZE, i++) {
+
+		const buf_block_t*	block;
+
+		block = (buf_block_t*) buf_block_arr[i];
+
+		if (buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
+		    || block->page.zip.data) {
+			/* No simple validate for compressed
+			pages exists. */
+			continue;
+		}
+
+		/* Check that the actual page in the buffer pool is
+		not corrupt and the LSN values are sane. */
+		buf_dblwr_check_block(block);
+
+		/* Check that the page as written to the doublewrite
+		buffer has sane LSN values. */
+		buf_dblwr_check_page_lsn(write_buf + len);
+	}
+}
+
+#ifndef DBUG_OFF
+/********************************************************************//**
+Simulates a crash in the middle of the datafile writes of a parallel
+doublewrite shard that has already been synced: the first half of each
+uncompressed page of a single-table tablespace in the shard is written
+to its datafile, leaving a torn page behind.
+@return true if any page was torn */
+static
+bool
+buf_parallel_dblwr_tear_pages(
+/*==========================*/
+	const buf_dblwr_shard_t*	shard,		/*!< in: shard */
+	ulint				first_free)	/*!< in: number of
+							pages in shard */
+{
+	bool	torn = false;
+
+	for (ulint i = 0; i < first_free; i++) {
+		const buf_page_t*	bpage = shard->buf_block_arr[i];
+
+		if (buf_page_get_space(bpage) == TRX_SYS_SPACE
+		    || bpage->zip.data) {
+			continue;
+		}
+
+		fil_io(OS_FILE_WRITE, true, buf_page_get_space(bpage), 0,
+		       buf_page_get_page_no(bpage), 0, UNIV_PAGE_SIZE / 2,
+		       shard->write_buf + i * UNIV_PAGE_SIZE, NULL, NULL);
+		torn = true;
+	}
+
+	if (torn) {
+		fil_flush_file_spaces(FIL_TABLESPACE);
+	}
+
+	return(torn);
+}
+#endif /* !DBUG_OFF */
+
+/********************************************************************//**
+Writes the pages buffered in a parallel doublewrite shard to the parallel
+doublewrite file, syncs it and posts the writes of the pages to the data
+files. The datafiles are synced and the shard freed for reuse by the I/O
+completion of the last page, see buf_dblwr_update(). */
+static
+void
+buf_parallel_dblwr_flush_shard(
+/*===========================*/
+	buf_dblwr_shard_t*	shard)	/*!< in/out: shard to flush */
+{
+	ulint	first_free;
+
+	mutex_enter(&shard->mutex);
+
+	if (shard->first_free == 0 || shard->batch_running) {
+		/* Nothing buffered, or the buffered pages have already
+		been written and their datafile writes posted. */
+		mutex_exit(&shard->mutex);
+		return;
+	}
+
+	ut_ad(shard->first_free == shard->b_reserved);
+
+	/* Block the thread filling the shard until the batch ends. */
+	shard->batch_running = true;
+	first_free = shard->first_free;
+
+	mutex_exit(&shard->mutex);
+
+	buf_dblwr_check_batch(shard->buf_block_arr, shard->write_buf,
+			      first_free);
+
+	if (!os_file_write(buf_parallel_dblwr->path,
+			   buf_parallel_dblwr->file, shard->write_buf,
+			   shard->offset, first_free * UNIV_PAGE_SIZE)
+	    || !os_file_flush(buf_parallel_dblwr->file)) {
+		ib_logf(IB_LOG_LEVEL_FATAL,
+			"Cannot write to parallel doublewrite file %s.",
+			buf_parallel_dblwr->path);
+	}
+
+	DBUG_EXECUTE_IF("ib_parallel_dblwr_torn_page",
+			if (buf_parallel_dblwr_tear_pages(shard, first_free)) {
+				DBUG_SUICIDE();
+			});
+
+	/* increment the doublewrite flushed pages counter */
+	srv_stats.dblwr_pages_written.add(first_free);
+	srv_stats.dblwr_writes.inc();
+
+	/* The shard is on disk, now do the writes to the intended
+	positions. As in buf_dblwr_flush_buffered_writes(), the batch may
+	complete before the loop ends, so only the local copy of
+	first_free may be used here. */
+	for (ulint i = 0; i < first_free; i++) {
+		buf_dblwr_write_block_to_datafile(
+			shard->buf_block_arr[i], false);
+	}
+
+	/* Wake possible simulated aio thread to actually post the
+	writes to the operating system. */
+	os_aio_simulated_wake_handler_threads();
+}
+
+/********************************************************************//**
+Flushes the buffered writes of one LRU or flush list batch. If the
+parallel doublewrite file is in use, only the shard of the given buffer
+pool instance and flush type is written, otherwise the shared doublewrite
+buffer is flushed as by buf_dblwr_flush_buffered_writes(). */
+UNIV_INTERN
+void
+buf_dblwr_flush_batch(
+/*==================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_flush_t		flush_type)	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
+{
+	if (buf_parallel_dblwr == NULL) {
+		buf_dblwr_flush_buffered_writes();
+		return;
+	}
+
+	buf_parallel_dblwr_flush_shard(
+		buf_parallel_dblwr_get_shard(buf_pool, flush_type));
+}
+
+/********************************************************************//**
+Posts a buffer page of an LRU or flush list batch to its parallel
+doublewrite shard. If the shard is full, it is flushed first. */
+static
+void
+buf_parallel_dblwr_add_to_batch(
+/*============================*/
+	buf_page_t*	bpage)	/*!< in: buffer block to write */
+{
+	buf_dblwr_shard_t*	shard = buf_parallel_dblwr_get_shard(
+		buf_pool_from_bpage(bpage), buf_page_get_flush_type(bpage));
+	const ulint		batch_size = buf_parallel_dblwr->batch_size;
+
+try_again:
+	mutex_enter(&shard->mutex);
+
+	ut_a(shard->first_free <= batch_size);
+
+	if (shard->batch_running) {
+		/* The previous batch of the shard has not reached the
+		datafiles yet. */
+		ib_int64_t	sig_count = os_event_reset(shard->b_event);
+		mutex_exit(&shard->mutex);
+
+		os_event_wait_low(shard->b_event, sig_count);
+		goto try_again;
+	}
+
+	if (shard->first_free == batch_size) {
+		mutex_exit(&shard->mutex);
+
+		buf_parallel_dblwr_flush_shard(shard);
+
+		goto try_again;
+	}
+
+	buf_dblwr_copy_page(shard->write_buf
+			    + UNIV_PAGE_SIZE * shard->first_free, bpage);
+
+	shard->buf_block_arr[shard->first_free] = bpage;
+
+	shard->first_free++;
+	shard->b_reserved++;
+
+	ut_ad(shard->first_free == shard->b_reserved);
+
+	if (shard->first_free == batch_size) {
+		mutex_exit(&shard->mutex);
+
+		buf_parallel_dblwr_flush_shard(shard);
+
+		return;
+	}
+
+	mutex_exit(&shard->mutex);
+}
+
 /********************************************************************//**
 Flushes possible buffered writes from the doublewrite memory buffer to disk,
 and also wakes up the aio thread if simulated aio is used. It is very
@@ -963,29 +1575,8 @@ buf_dblwr_flush_buffered_writes(void)
 
 	write_buf = buf_dblwr->write_buf;
 
-	for (ulint len2 = 0, i = 0;
-	     i < buf_dblwr->first_free;
-	     len2 += UNIV_PAGE_SIZE, i++) {
-
-		const buf_block_t*	block;
-
-		block = (buf_block_t*) buf_dblwr->buf_block_arr[i];
-
-		if (buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
-		    || block->page.zip.data) {
-			/* No simple validate for compressed
-			pages exists. */
-			continue;
-		}
-
-		/* Check that the actual page in the buffer pool is
-		not corrupt and the LSN values are sane. */
-		buf_dblwr_check_block(block);
-
-		/* Check that the page as written to the doublewrite
-		buffer has sane LSN values. */
-		buf_dblwr_check_page_lsn(write_buf + len2);
-	}
+	buf_dblwr_check_batch(buf_dblwr->buf_block_arr, write_buf,
+			      first_free);
 
 	/* Write out the first block of the doublewrite buffer */
 	len = ut_min(TRX_SYS_DOUBLEWRITE_BLOCK_SIZE,
@@ -1072,11 +1663,14 @@ buf_dblwr_add_to_batch(
 /*====================*/
 	buf_page_t*	bpage)	/*!< in: buffer block to write */
 {
-	ulint	zip_size;
-
 	ut_a(buf_page_in_file(bpage));
 	ut_ad(!mutex_own(&buf_pool_from_bpage(bpage)->LRU_list_mutex));
 
+	if (buf_parallel_dblwr != NULL) {
+		buf_parallel_dblwr_add_to_batch(bpage);
+		return;
+	}
+
 try_again:
 	mutex_enter(&buf_dblwr->mutex);
 
@@ -1105,27 +1699,8 @@ buf_dblwr_add_to_batch(
 		goto try_again;
 	}
 
-	zip_size = buf_page_get_zip_size(bpage);
-	void * frame = buf_page_get_frame(bpage);
-
-	if (zip_size) {
-		UNIV_MEM_ASSERT_RW(bpage->zip.data, zip_size);
-		/* Copy the compressed page and clear the rest. */
-		memcpy(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free,
-                       frame, zip_size);
-		memset(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free
-		       + zip_size, 0, UNIV_PAGE_SIZE - zip_size);
-	} else {
-		ut_a(buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE);
-		UNIV_MEM_ASSERT_RW(((buf_block_t*) bpage)->frame,
-				   UNIV_PAGE_SIZE);
-
-		memcpy(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free,
-		       frame, UNIV_PAGE_SIZE);
-	}
+	buf_dblwr_copy_page(buf_dblwr->write_buf
+			    + UNIV_PAGE_SIZE * buf_dblwr->first_free, bpage);
 
 	buf_dblwr->buf_block_arr[buf_dblwr->first_free] = bpage;
 
@@ -32,9 +32,11 @@ Created April 08, 2011 Vasil Dimov
 #include "buf0dump.h"
 #include "db0err.h"
 #include "dict0dict.h" /* dict_operation_lock */
+#include "mach0data.h" /* mach_write_to_4() */
 #include "os0file.h" /* OS_FILE_MAX_PATH */
 #include "os0sync.h" /* os_event* */
 #include "os0thread.h" /* os_thread_* */
+#include "buf0rea.h" /* buf_read_load_pages() */
 #include "srv0srv.h" /* srv_fast_shutdown, srv_buf_dump* */
 #include "srv0start.h" /* srv_shutdown_state */
 #include "sync0rw.h" /* rw_lock_s_lock() */
@@ -68,6 +70,62 @@ typedef ib_uint64_t	buf_dump_t;
 #define BUF_DUMP_SPACE(a)		((ulint) ((a) >> 32))
 #define BUF_DUMP_PAGE(a)		((ulint) ((a) & 0xFFFFFFFFUL))
 
+/* The dump file starts with BUF_DUMP_MAGIC and a 4-byte format version,
+followed by one BUF_DUMP_ENTRY_SIZE byte entry per page, each holding
+the space id, the page number and the position of the page in the LRU
+list of its buffer pool instance (0 = most recently used), all as 4-byte
+big-endian numbers. Files in the older text format of "space,page" lines
+can still be loaded. */
+#define BUF_DUMP_MAGIC			"IBBPDUMP"
+#define BUF_DUMP_MAGIC_LEN		8
+#define BUF_DUMP_VERSION		1
+#define BUF_DUMP_HEADER_SIZE		(BUF_DUMP_MAGIC_LEN + 4)
+#define BUF_DUMP_ENTRY_SIZE		12
+
+/* A periodic dump is skipped unless at least 1/BUF_DUMP_CHANGE_DIV of
+the buffer pool has been read or created since the previous dump */
+#define BUF_DUMP_CHANGE_DIV		100
+
+/* The load reads the hottest pages first, in windows of at least
+BUF_LOAD_MIN_WINDOW pages and at most 1/BUF_LOAD_N_WINDOWS of the dump.
+Each window is sorted on space id and page number and split into runs
+of at most BUF_LOAD_READ_BATCH pages of one tablespace that the load
+threads read as one batch. */
+#define BUF_LOAD_MIN_WINDOW		16384
+#define BUF_LOAD_N_WINDOWS		8
+#define BUF_LOAD_READ_BATCH		64
+
+/** A page of a buffer pool dump that is being loaded */
+struct buf_load_entry_t {
+	buf_dump_t	page;		/*!< space id and page number */
+	ulint		lru_pos;	/*!< position in the LRU list at the
+					time of the dump, 0 if unknown */
+};
+
+/** Shared state of the threads of a buffer pool load */
+struct buf_load_t {
+	const buf_load_entry_t*	dump;	/*!< pages to load, sorted */
+	const ulint*	runs;		/*!< start of each run in dump[],
+					runs[n_runs] is the number of
+					pages */
+	ulint		n_runs;		/*!< number of runs */
+	ulint		n_threads;	/*!< number of load threads */
+	ulint		next_run;	/*!< next run to read */
+	ulint		n_done;		/*!< pages whose reads were issued */
+	volatile bool	abort;		/*!< set to stop all load threads */
+};
+
+/** A thread of a buffer pool load */
+struct buf_load_thread_t {
+	buf_load_t*	load;		/*!< shared state */
+	ulint		thread_no;	/*!< number of this thread */
+	os_thread_t	thread_hdl;	/*!< thread handle */
+};
+
+/* Pages read or created in the buffer pool up to the last dump, see
+buf_dump_get_n_pages_in() */
+static ulint	buf_dump_last_n_pages_in = 0;
+
 /*****************************************************************//**
 Wakes up the buffer pool dump/load thread and instructs it to start
 a dump. This function is called by MySQL code via buffer_pool_dump_now()
@@ -163,6 +221,27 @@ buf_load_status(
 	va_end(ap);
 }
 
+/*****************************************************************//**
+Counts the pages that have entered the buffer pools since startup,
+either by being read or by being created.
+@return number of pages read or created */
+static
+ulint
+buf_dump_get_n_pages_in()
+/*=====================*/
+{
+	ulint	n = 0;
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		const buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		n += buf_pool->stat.n_pages_read
+			+ buf_pool->stat.n_pages_created;
+	}
+
+	return(n);
+}
+
 /** Returns the directory path where the buffer pool dump file will be created.
 @return directory path */
 static
@@ -200,9 +279,11 @@ buf_dump(
 	char	full_filename[OS_FILE_MAX_PATH];
 	char	tmp_filename[OS_FILE_MAX_PATH];
 	char	now[32];
+	byte	header[BUF_DUMP_HEADER_SIZE];
 	FILE*	f;
 	ulint	i;
 	int	ret;
+	ulint	n_pages_in = buf_dump_get_n_pages_in();
 
 	ut_snprintf(full_filename, sizeof(full_filename),
 		    "%s%c%s", get_buf_dump_dir(), SRV_PATH_SEPARATOR,
@@ -214,7 +295,7 @@ buf_dump(
 	buf_dump_status(STATUS_NOTICE, "Dumping buffer pool(s) to %s",
 			full_filename);
 
-	f = fopen(tmp_filename, "w");
+	f = fopen(tmp_filename, "wb");
 	if (f == NULL) {
 		buf_dump_status(STATUS_ERR,
 				"Cannot open '%s' for writing: %s",
@@ -223,6 +304,18 @@ buf_dump(
 	}
 	/* else */
 
+	memcpy(header, BUF_DUMP_MAGIC, BUF_DUMP_MAGIC_LEN);
+	mach_write_to_4(header + BUF_DUMP_MAGIC_LEN, BUF_DUMP_VERSION);
+
+	if (fwrite(header, sizeof header, 1, f) != 1) {
+		fclose(f);
+		buf_dump_status(STATUS_ERR,
+				"Cannot write to '%s': %s",
+				tmp_filename, strerror(errno));
+		/* leave tmp_filename to exist */
+		return;
+	}
+
 	/* walk through each buffer pool */
 	for (i = 0; i < srv_buf_pool_instances && !SHOULD_QUIT(); i++) {
 		buf_pool_t*		buf_pool;
@@ -289,10 +382,14 @@ buf_dump(
 		counter = 0;
 
 		for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
-			ret = fprintf(f, ULINTPF "," ULINTPF "\n",
-				      BUF_DUMP_SPACE(dump[j]),
-				      BUF_DUMP_PAGE(dump[j]));
-			if (ret < 0) {
+			byte	entry[BUF_DUMP_ENTRY_SIZE];
+
+			/* The dump[] is in LRU order, j is the position. */
+			mach_write_to_4(entry, BUF_DUMP_SPACE(dump[j]));
+			mach_write_to_4(entry + 4, BUF_DUMP_PAGE(dump[j]));
+			mach_write_to_4(entry + 8, j);
+
+			if (fwrite(entry, sizeof entry, 1, f) != 1) {
 				ut_free(dump);
 				fclose(f);
 				buf_dump_status(STATUS_ERR,
@@ -355,27 +452,56 @@ buf_dump(
 
 	/* success */
 
+	buf_dump_last_n_pages_in = n_pages_in;
+
 	ut_sprintf_timestamp(now);
 
 	buf_dump_status(STATUS_NOTICE,
 			"Buffer pool(s) dump completed at %s", now);
 }
 
+/*****************************************************************//**
+Performs a periodic buffer pool dump, see innodb_buffer_pool_dump_interval.
+The dump is skipped if few pages have entered the buffer pool since the
+previous dump, because the previous dump still describes the buffer
+pool well enough. */
+static
+void
+buf_dump_periodic()
+/*===============*/
+{
+	ulint	n_pages = 0;
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		n_pages += buf_pool_from_array(i)->curr_size;
+	}
+
+	if (buf_dump_last_n_pages_in != 0
+	    && buf_dump_get_n_pages_in() - buf_dump_last_n_pages_in
+	    < n_pages / BUF_DUMP_CHANGE_DIV) {
+		return;
+	}
+
+	buf_dump(TRUE /* quit on shutdown */);
+}
+
 /*****************************************************************//**
 Compare two buffer pool dump entries, used to sort the dump on
-space_no,page_no before loading in order to increase the chance for
-sequential IO.
+lru_pos,space_no,page_no before loading, so that the most recently used
+pages are loaded first.
 @return -1/0/1 if entry 1 is smaller/equal/bigger than entry 2 */
 static
 lint
-buf_dump_cmp(
-/*=========*/
-	const buf_dump_t	d1,	/*!< in: buffer pool dump entry 1 */
-	const buf_dump_t	d2)	/*!< in: buffer pool dump entry 2 */
+buf_load_cmp_lru(
+/*=============*/
+	const buf_load_entry_t&	e1,	/*!< in: buffer pool dump entry 1 */
+	const buf_load_entry_t&	e2)	/*!< in: buffer pool dump entry 2 */
 {
-	if (d1 < d2) {
+	if (e1.lru_pos != e2.lru_pos) {
+		return(e1.lru_pos < e2.lru_pos ? -1 : 1);
+	} else if (e1.page < e2.page) {
 		return(-1);
-	} else if (d1 == d2) {
+	} else if (e1.page == e2.page) {
 		return(0);
 	} else {
 		return(1);
@@ -383,18 +509,53 @@ buf_dump_cmp(
 }
 
 /*****************************************************************//**
-Sort a buffer pool dump on space_no, page_no. */
+Compare two buffer pool dump entries, used to sort a window of the dump
+on space_no,page_no in order to increase the chance for sequential IO.
+@return -1/0/1 if entry 1 is smaller/equal/bigger than entry 2 */
+static
+lint
+buf_load_cmp_page(
+/*==============*/
+	const buf_load_entry_t&	e1,	/*!< in: buffer pool dump entry 1 */
+	const buf_load_entry_t&	e2)	/*!< in: buffer pool dump entry 2 */
+{
+	if (e1.page < e2.page) {
+		return(-1);
+	} else if (e1.page == e2.page) {
+		return(0);
+	} else {
+		return(1);
+	}
+}
+
+/*****************************************************************//**
+Sort a buffer pool dump on lru_pos, space_no, page_no. */
 static
 void
-buf_dump_sort(
-/*==========*/
-	buf_dump_t*	dump,	/*!< in/out: buffer pool dump to sort */
-	buf_dump_t*	tmp,	/*!< in/out: temp storage */
-	ulint		low,	/*!< in: lowest index (inclusive) */
-	ulint		high)	/*!< in: highest index (non-inclusive) */
+buf_load_sort_lru(
+/*==============*/
+	buf_load_entry_t*	dump,	/*!< in/out: buffer pool dump to sort */
+	buf_load_entry_t*	tmp,	/*!< in/out: temp storage */
+	ulint			low,	/*!< in: lowest index (inclusive) */
+	ulint			high)	/*!< in: highest index (non-inclusive) */
 {
-	UT_SORT_FUNCTION_BODY(buf_dump_sort, dump, tmp, low, high,
-			      buf_dump_cmp);
+	UT_SORT_FUNCTION_BODY(buf_load_sort_lru, dump, tmp, low, high,
+			      buf_load_cmp_lru);
+}
+
+/*****************************************************************//**
+Sort a part of a buffer pool dump on space_no, page_no. */
+static
+void
+buf_load_sort_page(
+/*===============*/
+	buf_load_entry_t*	dump,	/*!< in/out: buffer pool dump to sort */
+	buf_load_entry_t*	tmp,	/*!< in/out: temp storage */
+	ulint			low,	/*!< in: lowest index (inclusive) */
+	ulint			high)	/*!< in: highest index (non-inclusive) */
+{
+	UT_SORT_FUNCTION_BODY(buf_load_sort_page, dump, tmp, low, high,
+			      buf_load_cmp_page);
 }
 
 /*****************************************************************//**
@@ -408,12 +569,17 @@ buf_load_throttle_if_needed(
 	ulint*	last_check_time,	/*!< in/out: miliseconds since epoch
 					of the last time we did check if
 					throttling is needed, we do the check
-					every srv_io_capacity IO ops. */
+					every io_capacity IO ops. */
 	ulint*	last_activity_count,
-	ulint	n_io)			/*!< in: number of IO ops done since
-					buffer pool load has started */
+	ulint	n_io_before,		/*!< in: number of IO ops done by
+					this thread before the last batch */
+	ulint	n_io,			/*!< in: number of IO ops done by
+					this thread since buffer pool load
+					has started */
+	ulint	io_capacity)		/*!< in: share of srv_io_capacity
+					of this thread */
 {
-	if (n_io % srv_io_capacity < srv_io_capacity - 1) {
+	if (n_io / io_capacity == n_io_before / io_capacity) {
 		return;
 	}
 
@@ -423,8 +589,8 @@ buf_load_throttle_if_needed(
 		return;
 	}
 
-	/* srv_io_capacity IO operations have been performed by buffer pool
-	load since the last time we were here. */
+	/* io_capacity IO operations have been performed by this thread
+	since the last time we were here. */
 
 	/* If no other activity, then keep going without any delay. */
 	if (srv_get_activity_count() == *last_activity_count) {
@@ -437,19 +603,19 @@ buf_load_throttle_if_needed(
 	ulint	elapsed_time = now - *last_check_time;
 
 	/* Notice that elapsed_time is not the time for the last
-	srv_io_capacity IO operations performed by BP load. It is the
+	io_capacity IO operations performed by BP load. It is the
 	time elapsed since the last time we detected that there has been
 	other activity. This has a small and acceptable deficiency, e.g.:
 	1. BP load runs and there is no other activity.
 	2. Other activity occurs, we run N IO operations after that and
-	   enter here (where 0 <= N < srv_io_capacity).
+	   enter here (where 0 <= N < io_capacity).
 	3. last_check_time is very old and we do not sleep at this time, but
 	   only update last_check_time and last_activity_count.
-	4. We run srv_io_capacity more IO operations and call this function
+	4. We run io_capacity more IO operations and call this function
 	   again.
 	5. There has been more other activity and thus we enter here.
 	6. Now last_check_time is recent and we sleep if necessary to prevent
-	   more than srv_io_capacity IO operations per second.
+	   more than io_capacity IO operations per second.
 	The deficiency is that we could have slept at 3., but for this we
 	would have to update last_check_time before the
 	"cur_activity_count == *last_activity_count" check and calling
@@ -464,54 +630,175 @@ buf_load_throttle_if_needed(
 }
 
 /*****************************************************************//**
-Perform a buffer pool load from the file specified by
-innodb_buffer_pool_filename. If any errors occur then the value of
-innodb_buffer_pool_load_status will be set accordingly, see buf_load_status().
-The dump filename can be specified by (relative to srv_data_home):
-SET GLOBAL innodb_buffer_pool_filename='filename'; */
+Reads runs of pages until all of them have been read or the load is
+aborted. Each thread gets an equal share of srv_io_capacity when the
+load is throttled. The thread with thread_no == 0 reports the progress. */
 static
 void
-buf_load()
-/*======*/
+buf_load_read(
+/*==========*/
+	buf_load_t*	load,		/*!< in/out: buffer pool load */
+	ulint		thread_no)	/*!< in: number of this thread */
 {
-	char		full_filename[OS_FILE_MAX_PATH];
-	char		now[32];
-	FILE*		f;
-	buf_dump_t*	dump;
-	buf_dump_t*	dump_tmp;
-	ulint		dump_n;
-	ulint		total_buffer_pools_pages;
-	ulint		i;
-	ulint		space_id;
-	ulint		page_no;
-	int		fscanf_ret;
+	ulint	page_nos[BUF_LOAD_READ_BATCH];
+	ulint	last_check_time = 0;
+	ulint	last_activity_cnt = 0;
+	ulint	n_io = 0;
+	ulint	io_capacity = ut_max(srv_io_capacity / load->n_threads, 1);
+	ulint	dump_n = load->runs[load->n_runs];
 
-	/* Ignore any leftovers from before */
-	buf_load_abort_flag = FALSE;
+	while (!load->abort && !SHUTTING_DOWN()) {
+		ulint	i = os_atomic_increment_ulint(&load->next_run, 1) - 1;
 
-	ut_snprintf(full_filename, sizeof(full_filename),
-		    "%s%c%s", get_buf_dump_dir(), SRV_PATH_SEPARATOR,
-		    srv_buf_dump_filename);
+		if (i >= load->n_runs) {
+			break;
+		}
 
-	buf_load_status(STATUS_NOTICE,
-			"Loading buffer pool(s) from %s", full_filename);
+		const ulint	first = load->runs[i];
+		const ulint	n = load->runs[i + 1] - first;
 
-	f = fopen(full_filename, "r");
-	if (f == NULL) {
+		ut_ad(n <= BUF_LOAD_READ_BATCH);
+
+		for (ulint j = 0; j < n; j++) {
+			page_nos[j] = BUF_DUMP_PAGE(load->dump[first + j].page);
+		}
+
+		buf_read_load_pages(BUF_DUMP_SPACE(load->dump[first].page),
+				    page_nos, n);
+
+		ulint	n_done = os_atomic_increment_ulint(&load->n_done, n);
+
+		if (thread_no == 0) {
+			buf_load_status(STATUS_INFO,
+					"Loaded " ULINTPF "/" ULINTPF " pages",
+					n_done, dump_n);
+		}
+
+		if (buf_load_abort_flag) {
+			load->abort = true;
+			break;
+		}
+
+		buf_load_throttle_if_needed(
+			&last_check_time, &last_activity_cnt,
+			n_io, n_io + n, io_capacity);
+
+		n_io += n;
+	}
+}
+
+/*****************************************************************//**
+Thread of a buffer pool load.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_load_thread)(
+/*============================*/
+	void*	arg)	/*!< in: buf_load_thread_t */
+{
+	buf_load_thread_t*	thr = static_cast<buf_load_thread_t*>(arg);
+
+	buf_load_read(thr->load, thr->thread_no);
+
+	os_thread_exit(NULL, false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*****************************************************************//**
+Reads a buffer pool dump file in the binary format, positioned after the
+header. Pages whose LRU position is at or beyond max_lru_pos are skipped.
+@return array of dump entries, to be freed with ut_free(), or NULL in case
+of an error, in which case the load status has been set */
+static
+buf_load_entry_t*
+buf_load_read_binary(
+/*=================*/
+	FILE*		f,		/*!< in: dump file */
+	const char*	full_filename,	/*!< in: name of the file */
+	ulint*		dump_n)		/*!< out: number of entries */
+{
+	buf_load_entry_t*	dump;
+	long			file_size;
+	ulint			n;
+	ulint			i;
+
+	if (fseek(f, 0, SEEK_END) != 0
+	    || (file_size = ftell(f)) < BUF_DUMP_HEADER_SIZE
+	    || fseek(f, BUF_DUMP_HEADER_SIZE, SEEK_SET) != 0) {
+		buf_load_status(STATUS_ERR, "Error reading '%s', "
+				"unable to load buffer pool (stage 1)",
+				full_filename);
+		return(NULL);
+	}
+
+	n = (ulint) (file_size - BUF_DUMP_HEADER_SIZE) / BUF_DUMP_ENTRY_SIZE;
+
+	dump = static_cast<buf_load_entry_t*>(
+		ut_malloc(ut_max(n, 1) * sizeof(*dump)));
+
+	if (dump == NULL) {
 		buf_load_status(STATUS_ERR,
-				"Cannot open '%s' for reading: %s",
-				full_filename, strerror(errno));
-		return;
+				"Cannot allocate " ULINTPF " bytes: %s",
+				(ulint) (n * sizeof(*dump)),
+				strerror(errno));
+		return(NULL);
 	}
-	/* else */
+
+	for (i = 0; i < n && !SHUTTING_DOWN(); i++) {
+		byte	entry[BUF_DUMP_ENTRY_SIZE];
+
+		if (fread(entry, sizeof entry, 1, f) != 1) {
+			/* The file may have been truncated after we
+			determined its size. */
+			if (feof(f)) {
+				break;
+			}
+
+			ut_free(dump);
+			buf_load_status(STATUS_ERR, "Error reading '%s', "
+					"unable to load buffer pool (stage 2)",
+					full_filename);
+			return(NULL);
+		}
+
+		dump[i].page = BUF_DUMP_CREATE(mach_read_from_4(entry),
+					       mach_read_from_4(entry + 4));
+		dump[i].lru_pos = mach_read_from_4(entry + 8);
+	}
+
+	*dump_n = i;
+
+	return(dump);
+}
+
+/*****************************************************************//**
+Reads a buffer pool dump file in the text format of "space,page" lines
+that was written by older versions. The LRU positions are unknown.
+@return array of dump entries, to be freed with ut_free(), or NULL in case
+of an error, in which case the load status has been set */
+static
+buf_load_entry_t*
+buf_load_read_text(
+/*===============*/
+	FILE*		f,		/*!< in: dump file, at the start */
+	const char*	full_filename,	/*!< in: name of the file */
+	ulint*		dump_n)		/*!< out: number of entries */
+{
+	buf_load_entry_t*	dump;
+	ulint			n;
+	ulint			i;
+	ulint			space_id;
+	ulint			page_no;
+	int			fscanf_ret;
 
 	/* First scan the file to estimate how many entries are in it.
 	This file is tiny (approx 500KB per 1GB buffer pool), reading it
 	two times is fine. */
-	dump_n = 0;
+	n = 0;
 	while (fscanf(f, ULINTPF "," ULINTPF, &space_id, &page_no) == 2
 	       && !SHUTTING_DOWN()) {
-		dump_n++;
+		n++;
 	}
 
 	if (!SHUTTING_DOWN() && !feof(f)) {
@@ -522,49 +809,26 @@ buf_load()
 		} else {
 			what = "parsing";
 		}
-		fclose(f);
 		buf_load_status(STATUS_ERR, "Error %s '%s', "
 				"unable to load buffer pool (stage 1)",
 				what, full_filename);
-		return;
-	}
-
-	/* If dump is larger than the buffer pool(s), then we ignore the
-	extra trailing. This could happen if a dump is made, then buffer
-	pool is shrunk and then load it attempted. */
-	total_buffer_pools_pages = buf_pool_get_n_pages()
-		* srv_buf_pool_instances;
-	if (dump_n > total_buffer_pools_pages) {
-		dump_n = total_buffer_pools_pages;
+		return(NULL);
 	}
 
-	dump = static_cast<buf_dump_t*>(ut_malloc(dump_n * sizeof(*dump)));
+	dump = static_cast<buf_load_entry_t*>(
+		ut_malloc(ut_max(n, 1) * sizeof(*dump)));
 
 	if (dump == NULL) {
-		fclose(f);
 		buf_load_status(STATUS_ERR,
 				"Cannot allocate " ULINTPF " bytes: %s",
-				(ulint) (dump_n * sizeof(*dump)),
+				(ulint) (n * sizeof(*dump)),
 				strerror(errno));
-		return;
-	}
-
-	dump_tmp = static_cast<buf_dump_t*>(
-		ut_malloc(dump_n * sizeof(*dump_tmp)));
-
-	if (dump_tmp == NULL) {
-		ut_free(dump);
-		fclose(f);
-		buf_load_status(STATUS_ERR,
-				"Cannot allocate " ULINTPF " bytes: %s",
-				(ulint) (dump_n * sizeof(*dump_tmp)),
-				strerror(errno));
-		return;
+		return(NULL);
 	}
 
 	rewind(f);
 
-	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+	for (i = 0; i < n && !SHUTTING_DOWN(); i++) {
 		fscanf_ret = fscanf(f, ULINTPF "," ULINTPF,
 				    &space_id, &page_no);
 
@@ -575,19 +839,15 @@ buf_load()
 			/* else */
 
 			ut_free(dump);
-			ut_free(dump_tmp);
-			fclose(f);
 			buf_load_status(STATUS_ERR,
 					"Error parsing '%s', unable "
 					"to load buffer pool (stage 2)",
 					full_filename);
-			return;
+			return(NULL);
 		}
 
 		if (space_id > ULINT32_MASK || page_no > ULINT32_MASK) {
 			ut_free(dump);
-			ut_free(dump_tmp);
-			fclose(f);
 			buf_load_status(STATUS_ERR,
 					"Error parsing '%s': bogus "
 					"space,page " ULINTPF "," ULINTPF
@@ -596,19 +856,99 @@ buf_load()
 					full_filename,
 					space_id, page_no,
 					i);
-			return;
+			return(NULL);
 		}
 
-		dump[i] = BUF_DUMP_CREATE(space_id, page_no);
+		dump[i].page = BUF_DUMP_CREATE(space_id, page_no);
+		dump[i].lru_pos = 0;
 	}
 
 	/* Set dump_n to the actual number of initialized elements,
-	i could be smaller than dump_n here if the file got truncated after
+	i could be smaller than n here if the file got truncated after
 	we read it the first time. */
-	dump_n = i;
+	*dump_n = i;
+
+	return(dump);
+}
+
+/*****************************************************************//**
+Perform a buffer pool load from the file specified by
+innodb_buffer_pool_filename. If any errors occur then the value of
+innodb_buffer_pool_load_status will be set accordingly, see buf_load_status().
+The dump filename can be specified by (relative to srv_data_home):
+SET GLOBAL innodb_buffer_pool_filename='filename';
+
+The most recently used pages are loaded first. The dump is split into
+windows of pages of similar LRU positions, each window is sorted on
+space id and page number and split into runs of pages of one tablespace,
+and innodb_buffer_pool_load_threads threads issue asynchronous reads
+for one run at a time. */
+static
+void
+buf_load()
+/*======*/
+{
+	char			full_filename[OS_FILE_MAX_PATH];
+	char			now[32];
+	byte			header[BUF_DUMP_HEADER_SIZE];
+	FILE*			f;
+	buf_load_entry_t*	dump;
+	buf_load_entry_t*	dump_tmp;
+	ulint*			runs;
+	ulint			n_runs;
+	ulint			dump_n;
+	ulint			total_buffer_pools_pages;
+	ulint			window;
+	ulint			n_threads;
+	buf_load_t		load;
+	buf_load_thread_t*	thr;
+
+	/* Ignore any leftovers from before */
+	buf_load_abort_flag = FALSE;
+
+	ut_snprintf(full_filename, sizeof(full_filename),
+		    "%s%c%s", get_buf_dump_dir(), SRV_PATH_SEPARATOR,
+		    srv_buf_dump_filename);
+
+	buf_load_status(STATUS_NOTICE,
+			"Loading buffer pool(s) from %s", full_filename);
+
+	f = fopen(full_filename, "rb");
+	if (f == NULL) {
+		buf_load_status(STATUS_ERR,
+				"Cannot open '%s' for reading: %s",
+				full_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
+	if (fread(header, sizeof header, 1, f) == 1
+	    && !memcmp(header, BUF_DUMP_MAGIC, BUF_DUMP_MAGIC_LEN)) {
+
+		if (mach_read_from_4(header + BUF_DUMP_MAGIC_LEN)
+		    != BUF_DUMP_VERSION) {
+			fclose(f);
+			buf_load_status(STATUS_ERR,
+					"Unsupported format version " ULINTPF
+					" of '%s', unable to load buffer pool",
+					mach_read_from_4(
+						header + BUF_DUMP_MAGIC_LEN),
+					full_filename);
+			return;
+		}
+
+		dump = buf_load_read_binary(f, full_filename, &dump_n);
+	} else {
+		rewind(f);
+		dump = buf_load_read_text(f, full_filename, &dump_n);
+	}
 
 	fclose(f);
 
+	if (dump == NULL) {
+		return;
+	}
+
 	if (dump_n == 0) {
 		ut_free(dump);
 		ut_sprintf_timestamp(now);
@@ -618,45 +958,96 @@ buf_load()
 		return;
 	}
 
-	if (!SHUTTING_DOWN()) {
-		buf_dump_sort(dump, dump_tmp, 0, dump_n);
+	dump_tmp = static_cast<buf_load_entry_t*>(
+		ut_malloc(dump_n * sizeof(*dump_tmp)));
+
+	runs = static_cast<ulint*>(ut_malloc((dump_n + 1) * sizeof(*runs)));
+
+	if (dump_tmp == NULL || runs == NULL) {
+		ut_free(dump_tmp);
+		ut_free(runs);
+		ut_free(dump);
+		buf_load_status(STATUS_ERR,
+				"Cannot allocate " ULINTPF " bytes: %s",
+				(ulint) (dump_n * (sizeof(*dump_tmp)
+						   + sizeof(*runs))),
+				strerror(errno));
+		return;
 	}
 
-	ut_free(dump_tmp);
+	/* Hottest pages first. If the dump is larger than the buffer
+	pool(s), then we ignore the coldest pages. This could happen if a
+	dump is made, then buffer pool is shrunk and then load it
+	attempted. */
+	buf_load_sort_lru(dump, dump_tmp, 0, dump_n);
 
-	ulint	last_check_time = 0;
-	ulint	last_activity_cnt = 0;
+	total_buffer_pools_pages = buf_pool_get_n_pages()
+		* srv_buf_pool_instances;
+	if (dump_n > total_buffer_pools_pages) {
+		dump_n = total_buffer_pools_pages;
+	}
 
-	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+	window = ut_max(dump_n / BUF_LOAD_N_WINDOWS, BUF_LOAD_MIN_WINDOW);
+	n_runs = 0;
 
-		buf_read_page_async(BUF_DUMP_SPACE(dump[i]),
-				    BUF_DUMP_PAGE(dump[i]));
+	for (ulint start = 0; start < dump_n; start += window) {
+		ulint	end = ut_min(start + window, dump_n);
 
-		if (i % 64 == 63) {
-			os_aio_simulated_wake_handler_threads();
-		}
+		buf_load_sort_page(dump, dump_tmp, start, end);
 
-		if (i % 128 == 0) {
-			buf_load_status(STATUS_INFO,
-					"Loaded " ULINTPF "/" ULINTPF " pages",
-					i + 1, dump_n);
+		for (ulint i = start; i < end; i++) {
+			if (i == start
+			    || i - runs[n_runs - 1] == BUF_LOAD_READ_BATCH
+			    || BUF_DUMP_SPACE(dump[i].page)
+			    != BUF_DUMP_SPACE(dump[i - 1].page)) {
+				runs[n_runs++] = i;
+			}
 		}
+	}
 
-		if (buf_load_abort_flag) {
-			buf_load_abort_flag = FALSE;
-			ut_free(dump);
-			buf_load_status(
-				STATUS_NOTICE,
-				"Buffer pool(s) load aborted on request");
-			return;
-		}
+	runs[n_runs] = dump_n;
 
-		buf_load_throttle_if_needed(
-			&last_check_time, &last_activity_cnt, i);
+	ut_free(dump_tmp);
+
+	n_threads = ut_min(ut_max(srv_buf_load_threads, 1), n_runs);
+
+	load.dump = dump;
+	load.runs = runs;
+	load.n_runs = n_runs;
+	load.n_threads = n_threads;
+	load.next_run = 0;
+	load.n_done = 0;
+	load.abort = false;
+
+	thr = static_cast<buf_load_thread_t*>(
+		ut_malloc(n_threads * sizeof(*thr)));
+
+	for (ulint i = 1; i < n_threads; i++) {
+		os_thread_id_t	thread_id;
+
+		thr[i].load = &load;
+		thr[i].thread_no = i;
+		thr[i].thread_hdl = os_thread_create(
+			buf_load_thread, &thr[i], &thread_id);
 	}
 
+	buf_load_read(&load, 0);
+
+	for (ulint i = 1; i < n_threads; i++) {
+		os_thread_join(thr[i].thread_hdl);
+	}
+
+	ut_free(thr);
+	ut_free(runs);
 	ut_free(dump);
 
+	if (load.abort && buf_load_abort_flag) {
+		buf_load_abort_flag = FALSE;
+		buf_load_status(STATUS_NOTICE,
+				"Buffer pool(s) load aborted on request");
+		return;
+	}
+
 	ut_sprintf_timestamp(now);
 
 	buf_load_status(STATUS_NOTICE,
@@ -678,7 +1069,8 @@ buf_load_abort()
 /*****************************************************************//**
 This is the main thread for buffer pool dump/load. It waits for an
 event and when waked up either performs a dump or load and sleeps
-again.
+again. If innodb_buffer_pool_dump_interval is set, it also dumps the
+buffer pool periodically.
 @return this function does not return, it calls os_thread_exit() */
 extern "C" UNIV_INTERN
 os_thread_ret_t
@@ -700,7 +1092,15 @@ DECLARE_THREAD(buf_dump_thread)(
 
 	while (!SHUTTING_DOWN()) {
 
-		os_event_wait(srv_buf_dump_event);
+		if (srv_buf_dump_interval == 0) {
+			os_event_wait(srv_buf_dump_event);
+		} else if (os_event_wait_time(
+				   srv_buf_dump_event,
+				   srv_buf_dump_interval * 1000000)
+			   == OS_SYNC_TIME_EXCEEDED
+			   && !SHUTTING_DOWN()) {
+			buf_dump_periodic();
+		}
 
 		if (buf_dump_should_start) {
 			buf_dump_should_start = FALSE;
@@ -72,8 +72,35 @@ UNIV_INTERN mysql_pfs_key_t buf_page_cleaner_thread_key;
 UNIV_INTERN mysql_pfs_key_t buf_lru_manager_thread_key;
 #endif /* UNIV_PFS_THREAD */
 
+/** Whether the current thread is the page_cleaner or the lru_manager and
+should follow the buffer pool instances it flushes to their NUMA nodes */
+static UNIV_THREAD_LOCAL bool buf_flush_numa_follow;
+
+/** The NUMA node the current thread was last moved to, or
+ULINT_UNDEFINED */
+static UNIV_THREAD_LOCAL ulint buf_flush_numa_node = ULINT_UNDEFINED;
+
 /* @} */
 
+/******************************************************************//**
+Moves the page_cleaner or the lru_manager thread to the NUMA node of the
+buffer pool instance it is about to flush, so that the flush list and
+LRU scans touch local memory. Other threads are left where they are. */
+static
+void
+buf_flush_numa_run_on_node(
+/*=======================*/
+	const buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+{
+	if (buf_flush_numa_follow
+	    && buf_pool->numa_node != ULINT_UNDEFINED
+	    && buf_pool->numa_node != buf_flush_numa_node) {
+
+		buf_numa_run_on_node(buf_pool->numa_node);
+		buf_flush_numa_node = buf_pool->numa_node;
+	}
+}
+
 /******************************************************************//**
 Increases flush_list size in bytes with zip_size for compressed page,
 UNIV_PAGE_SIZE for uncompressed page in inline function */
@@ -1096,7 +1123,7 @@ buf_flush_page(
 			/* avoiding deadlock possibility involves doublewrite
 			buffer, should flush it, because it might hold the
 			another block->lock. */
-			buf_dblwr_flush_buffered_writes();
+			buf_dblwr_flush_batch(buf_pool, flush_type);
 
 			rw_lock_s_lock_gen(rw_lock, BUF_IO_WRITE);
                 }
@@ -1547,12 +1574,18 @@ buf_flush_LRU_list_batch(
 	       && scanned < max_scanned_pages) {
 
 		ib_mutex_t* block_mutex = buf_page_get_mutex(bpage);
+		buf_page_t* prev_bpage = UT_LIST_GET_PREV(LRU, bpage);
 		ibool	 evict;
 		ulint	failed_acquire;
 
 		++scanned;
 		++lru_position;
 
+		if (buf_LRU_second_chance(bpage)) {
+			bpage = prev_bpage;
+			continue;
+		}
+
 		failed_acquire = mutex_enter_nowait(block_mutex);
 
 		evict = UNIV_LIKELY(!failed_acquire)
@@ -1592,9 +1625,6 @@ buf_flush_LRU_list_batch(
 
 			ulint		space;
 			ulint		offset;
-			buf_page_t*	prev_bpage;
-
-			prev_bpage = UT_LIST_GET_PREV(LRU, bpage);
 
 			/* Save the previous bpage */
 
@@ -1821,6 +1851,13 @@ buf_flush_batch(
 		ut_error;
 	}
 
+	if (buf_parallel_dblwr != NULL) {
+		/* The doublewrite shard of this batch must be written
+		before another batch of the same type may start on this
+		instance. */
+		buf_dblwr_flush_batch(buf_pool, flush_type);
+	}
+
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints && n->flushed > 0) {
 		fprintf(stderr, flush_type == BUF_FLUSH_LRU
@@ -2086,6 +2123,8 @@ buf_flush_list(
 
 				buf_pool = buf_pool_from_array(i);
 
+				buf_flush_numa_run_on_node(buf_pool);
+
 				if (!buf_flush_start(buf_pool,
 						     BUF_FLUSH_LIST)) {
 
@@ -2298,6 +2337,8 @@ buf_flush_LRU_tail(void)
 			ulint free_len = free_list_lwm;
 			buf_pool_t* buf_pool = buf_pool_from_array(i);
 
+			buf_flush_numa_run_on_node(buf_pool);
+
 			do {
 				flush_counters_t	n;
 
@@ -2752,6 +2793,8 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 
 	os_thread_set_priority(srv_cleaner_tid, srv_sched_priority_cleaner);
 
+	buf_flush_numa_follow = true;
+
 #ifdef UNIV_DEBUG_THREAD_CREATION
 	fprintf(stderr, "InnoDB: page_cleaner thread running, id %lu\n",
 		os_thread_pf(os_thread_get_curr_id()));
@@ -2902,6 +2945,8 @@ DECLARE_THREAD(buf_flush_lru_manager_thread)(
 	os_thread_set_priority(srv_lru_manager_tid,
 			       srv_sched_priority_cleaner);
 
+	buf_flush_numa_follow = true;
+
 #ifdef UNIV_DEBUG_THREAD_CREATION
 	fprintf(stderr, "InnoDB: lru_manager thread running, id %lu\n",
 		os_thread_pf(os_thread_get_curr_id()));
@@ -790,6 +790,8 @@ buf_LRU_remove_all_pages(
 			hash_lock = buf_page_hash_lock_get(buf_pool, fold);
 
 			rw_lock_x_lock(hash_lock);
+			hash_lock = hash_lock_x_confirm(
+				hash_lock, buf_pool->page_hash, fold);
 
 			block_mutex = buf_page_get_mutex(bpage);
 			mutex_enter(block_mutex);
@@ -1093,6 +1095,11 @@ buf_LRU_free_from_common_LRU_list(
 		ut_ad(buf_page_in_file(bpage));
 		ut_ad(bpage->in_LRU_list);
 
+		if (buf_LRU_second_chance(bpage)) {
+			bpage = prev_bpage;
+			continue;
+		}
+
 		accessed = buf_page_is_accessed(bpage);
 
 		mutex_enter(block_mutex);
@@ -1198,6 +1205,22 @@ buf_LRU_get_free_only(
 
 	block = (buf_block_t*) UT_LIST_GET_LAST(buf_pool->free);
 
+	while (block != NULL
+	       && buf_pool->withdraw_target > 0
+	       && UT_LIST_GET_LEN(buf_pool->withdraw)
+	       < buf_pool->withdraw_target
+	       && buf_block_will_withdrawn(buf_pool, block)) {
+
+		/* The buffer pool is being shrunk and this block
+		belongs to a chunk that is going to be freed. */
+		ut_ad(block->page.in_free_list);
+		ut_d(block->page.in_free_list = FALSE);
+		UT_LIST_REMOVE(list, buf_pool->free, (&block->page));
+		UT_LIST_ADD_LAST(list, buf_pool->withdraw, (&block->page));
+
+		block = (buf_block_t*) UT_LIST_GET_LAST(buf_pool->free);
+	}
+
 	if (block) {
 
 		ut_ad(block->page.in_free_list);
@@ -1893,6 +1916,126 @@ buf_LRU_add_block_low(
 	}
 }
 
+/******************************************************************//**
+Computes the LRU_ghost fingerprint of a page.
+@return fingerprint, with the lowest bit clear and never 0 */
+UNIV_INLINE
+ulint
+buf_LRU_ghost_fold(
+/*===============*/
+	const buf_page_t*	bpage)	/*!< in: control block */
+{
+	ulint	fold = buf_page_address_fold(bpage->space, bpage->offset);
+
+	return((fold << 1) | 2);
+}
+
+/******************************************************************//**
+Remembers a page that is being evicted in buf_pool->LRU_ghost, so that
+buf_LRU_ghost_hit() can tell when it is read in again. */
+static
+void
+buf_LRU_ghost_add(
+/*==============*/
+	buf_pool_t*		buf_pool,	/*!< in/out: buffer pool
+						instance */
+	const buf_page_t*	bpage)		/*!< in: page being evicted */
+{
+	ulint			fold	= buf_LRU_ghost_fold(bpage);
+	buf_LRU_ghost_t*	ghost	= &buf_pool->LRU_ghost[
+		fold % buf_pool->LRU_ghost_size];
+
+	ut_ad(mutex_own(&buf_pool->LRU_list_mutex));
+
+	if (ghost->fold) {
+		buf_pool->LRU_ghost_n[ghost->fold & 1]--;
+	}
+
+	ghost->fold = fold | (bpage->made_young ? 1 : 0);
+	ghost->evicted = buf_pool->freed_page_clock;
+	buf_pool->LRU_ghost_n[ghost->fold & 1]++;
+}
+
+/******************************************************************//**
+Adapts the length of the old sublist when a page that was recently
+evicted is read in again. A page that was evicted from the old sublist
+without having been made young means that the old sublist is too short
+to let pages prove themselves; a page that had been made young means
+that the new sublist is too short for the working set. The adjustment
+is weighted by the ratio of the two kinds of evicted pages, as in ARC.
+Like the ghost lists of ARC, a page that was evicted from the old sublist
+only counts while the ghost and the old sublist together are no longer
+than the LRU list, so that a scan over more pages than the buffer pool
+holds does not push out the working set. */
+static
+void
+buf_LRU_ghost_hit(
+/*==============*/
+	buf_pool_t*		buf_pool,	/*!< in/out: buffer pool
+						instance */
+	const buf_page_t*	bpage)		/*!< in: page being read in */
+{
+	ulint			fold	= buf_LRU_ghost_fold(bpage);
+	buf_LRU_ghost_t*	ghost	= &buf_pool->LRU_ghost[
+		fold % buf_pool->LRU_ghost_size];
+	ulint			len	= UT_LIST_GET_LEN(buf_pool->LRU);
+	ulint			hot;
+	ulint			window;
+	ulint			target;
+	ulint			ratio;
+
+	ut_ad(mutex_own(&buf_pool->LRU_list_mutex));
+
+	if ((ghost->fold & ~1UL) != fold || len < BUF_LRU_OLD_MIN_LEN) {
+		return;
+	}
+
+	hot = ghost->fold & 1;
+	ghost->fold = 0;
+	buf_pool->LRU_ghost_n[hot]--;
+
+	window = hot ? len : len - buf_pool->LRU_old_len;
+
+	if (buf_pool->freed_page_clock - ghost->evicted > window) {
+		return;
+	}
+
+	target = buf_pool->LRU_old_target;
+
+	if (target == 0) {
+		target = len * buf_pool->LRU_old_ratio / BUF_LRU_OLD_RATIO_DIV;
+	}
+
+	if (hot) {
+		ulint	delta = ut_max(1, buf_pool->LRU_ghost_n[0]
+				       / ut_max(1, buf_pool->LRU_ghost_n[1]));
+
+		target = target > delta ? target - delta : 0;
+	} else {
+		target += ut_max(1, buf_pool->LRU_ghost_n[1]
+				 / ut_max(1, buf_pool->LRU_ghost_n[0]));
+	}
+
+	target = ut_max(target,
+			len * BUF_LRU_OLD_RATIO_MIN / BUF_LRU_OLD_RATIO_DIV);
+	target = ut_min(target,
+			len * BUF_LRU_OLD_RATIO_MAX / BUF_LRU_OLD_RATIO_DIV);
+
+	buf_pool->LRU_old_target = target;
+
+	ratio = target * BUF_LRU_OLD_RATIO_DIV / len;
+	ratio = ut_max(ratio, BUF_LRU_OLD_RATIO_MIN);
+	ratio = ut_min(ratio, BUF_LRU_OLD_RATIO_MAX);
+
+	if (ratio != buf_pool->LRU_old_ratio) {
+		buf_pool->LRU_old_ratio = ratio;
+
+		if (buf_pool->LRU_old) {
+			buf_LRU_old_adjust_len(buf_pool);
+		}
+	}
+}
+
 /******************************************************************//**
 Adds a block to the LRU list. Please make sure that the zip_size is
 already set into the page zip when invoking the function, so that we
@@ -1909,6 +2052,12 @@ buf_LRU_add_block(
 				added to the start, regardless of this
 				parameter */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_bpage(bpage);
+
+	if (old && buf_pool->LRU_ghost) {
+		buf_LRU_ghost_hit(buf_pool, bpage);
+	}
+
 	buf_LRU_add_block_low(bpage, old);
 }
 
@@ -1928,10 +2077,36 @@ buf_LRU_make_block_young(
 		buf_pool->stat.n_pages_made_young++;
 	}
 
+	bpage->made_young = 1;
+
 	buf_LRU_remove_block(bpage);
 	buf_LRU_add_block_low(bpage, FALSE);
 }
 
+/******************************************************************//**
+Gives a block that was accessed since it became too old a second chance
+instead of evicting it (innodb_lru_algorithm=ADAPTIVE): the block is moved
+to the start of the LRU list. The caller must hold the LRU list mutex.
+@return true if the block was moved */
+UNIV_INTERN
+bool
+buf_LRU_second_chance(
+/*==================*/
+	buf_page_t*	bpage)	/*!< in/out: control block */
+{
+	ut_ad(mutex_own(&buf_pool_from_bpage(bpage)->LRU_list_mutex));
+	ut_ad(bpage->in_LRU_list);
+
+	if (!bpage->access_ref) {
+		return(false);
+	}
+
+	bpage->access_ref = 0;
+	buf_LRU_make_block_young(bpage);
+
+	return(true);
+}
+
 /******************************************************************//**
 Moves a block to the end of the LRU list. */
 UNIV_INTERN
@@ -2022,6 +2197,8 @@ buf_LRU_free_page(
 	mutex_exit(block_mutex);
 
 	rw_lock_x_lock(hash_lock);
+	hash_lock = hash_lock_x_confirm(
+		hash_lock, buf_pool->page_hash, fold);
 	mutex_enter(block_mutex);
 
 	if (UNIV_UNLIKELY(!buf_page_can_relocate(bpage)
@@ -2046,6 +2223,8 @@ buf_LRU_free_page(
 
 	if (b) {
 		memcpy(b, bpage, sizeof *b);
+	} else if (buf_pool->LRU_ghost) {
+		buf_LRU_ghost_add(buf_pool, bpage);
 	}
 
 	if (!buf_LRU_block_remove_hashed(bpage, zip)) {
@@ -2078,6 +2257,8 @@ buf_LRU_free_page(
 		buf_page_t*	prev_b	= UT_LIST_GET_PREV(LRU, b);
 
 		rw_lock_x_lock(hash_lock);
+		hash_lock = hash_lock_x_confirm(
+			hash_lock, buf_pool->page_hash, fold);
 		mutex_enter(block_mutex);
 
 		ut_a(!buf_page_hash_get_low(
@@ -2278,8 +2459,19 @@ buf_LRU_block_free_non_file_page(
 
 	mutex_enter_first(&buf_pool->free_list_mutex);
 	buf_block_set_state(block, BUF_BLOCK_NOT_USED);
-	UT_LIST_ADD_FIRST(list, buf_pool->free, (&block->page));
-	ut_d(block->page.in_free_list = TRUE);
+
+	if (buf_pool->withdraw_target > 0
+	    && UT_LIST_GET_LEN(buf_pool->withdraw)
+	    < buf_pool->withdraw_target
+	    && buf_block_will_withdrawn(buf_pool, block)) {
+		/* This block is in a chunk that is going to be
+		freed by buf_pool_resize(). */
+		UT_LIST_ADD_LAST(list, buf_pool->withdraw, (&block->page));
+	} else {
+		UT_LIST_ADD_FIRST(list, buf_pool->free, (&block->page));
+		ut_d(block->page.in_free_list = TRUE);
+	}
+
 	mutex_exit(&buf_pool->free_list_mutex);
 
 	UNIV_MEM_ASSERT_AND_FREE(block->frame, UNIV_PAGE_SIZE);
@@ -2631,6 +2823,8 @@ buf_LRU_old_ratio_update_instance(
 	if (adjust) {
 		mutex_enter(&buf_pool->LRU_list_mutex);
 
+		buf_pool->LRU_old_target = 0;
+
 		if (ratio != buf_pool->LRU_old_ratio) {
 			buf_pool->LRU_old_ratio = ratio;
 
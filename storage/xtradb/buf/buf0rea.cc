@@ -42,6 +42,8 @@ Created 11/5/1995 Heikki Tuuri
 #include "mysql/plugin.h"
 #include "mysql/service_thd_wait.h"
 
+#include <algorithm>
+
 /** There must be at least this many pages in buf_pool in the area to start
 a random read-ahead */
 #define BUF_READ_AHEAD_RANDOM_THRESHOLD(b)	\
@@ -70,6 +72,8 @@ buf_read_page_handle_error(
 
 	mutex_enter(&buf_pool->LRU_list_mutex);
 	rw_lock_x_lock(hash_lock);
+	hash_lock = hash_lock_x_confirm(
+		hash_lock, buf_pool->page_hash, fold);
 	mutex_enter(buf_page_get_mutex(bpage));
 
 	/* First unfix and release lock on the bpage */
@@ -532,6 +536,131 @@ buf_read_page_async(
 	return(count > 0);
 }
 
+/********************************************************************//**
+Issues asynchronous reads of pages of one tablespace for a buffer pool
+load. The page numbers should be sorted, so that the requests for
+adjacent pages reach the i/o handler threads together and can be
+merged. Pages that are already in the buffer pool are skipped.
+@return number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_load_pages(
+/*================*/
+	ulint		space,		/*!< in: space id */
+	const ulint*	page_nos,	/*!< in: page numbers */
+	ulint		n_pages)	/*!< in: number of pages */
+{
+	ulint		zip_size;
+	ib_int64_t	tablespace_version;
+	ulint		count = 0;
+	dberr_t		err;
+
+	zip_size = fil_space_get_zip_size(space);
+
+	if (zip_size == ULINT_UNDEFINED) {
+		return(0);
+	}
+
+	tablespace_version = fil_space_get_version(space);
+
+	for (ulint i = 0; i < n_pages; i++) {
+		count += buf_read_page_low(
+			&err, false, BUF_READ_ANY_PAGE
+			| OS_AIO_SIMULATED_WAKE_LATER
+			| BUF_READ_IGNORE_NONEXISTENT_PAGES,
+			space, zip_size, FALSE, tablespace_version,
+			page_nos[i], NULL, NULL);
+
+		if (err == DB_TABLESPACE_DELETED) {
+			break;
+		}
+	}
+
+	/* Let the simulated aio handler threads see the whole batch
+	at once, so that they can merge the reads of adjacent pages. */
+	os_aio_simulated_wake_handler_threads();
+
+	srv_stats.buf_pool_reads.add(count);
+
+	/* As in buf_read_page_async(), these reads are not counted in
+	buf_LRU_stat_inc_io(). */
+
+	return(count);
+}
+
+/********************************************************************//**
+Issues asynchronous reads of the leaf pages that a forward index scan
+is about to visit, as listed by the node pointers of their parent page.
+The requests are queued in ascending page number order before the aio
+handler threads are woken up, so that the reads of adjacent pages can be
+merged into larger requests. Pages that are already in the buffer pool
+are skipped, and nothing is read if too many reads are already pending.
+@return number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_ahead_scan(
+/*================*/
+	ulint		space,		/*!< in: space id */
+	ulint		zip_size,	/*!< in: compressed page size in
+					bytes, or 0 */
+	ulint*		page_nos,	/*!< in/out: page numbers; sorted
+					by this function */
+	ulint		n_pages,	/*!< in: number of pages */
+	trx_t*		trx)		/*!< in: transaction, or NULL */
+{
+	ib_int64_t	tablespace_version;
+	ulint		count = 0;
+	dberr_t		err;
+
+	if (n_pages == 0 || srv_startup_is_before_trx_rollback_phase) {
+		return(0);
+	}
+
+	tablespace_version = fil_space_get_version(space);
+
+	std::sort(page_nos, page_nos + n_pages);
+
+	for (ulint i = 0; i < n_pages; i++) {
+		buf_pool_t*	buf_pool = buf_pool_get(space, page_nos[i]);
+
+		/* Do not let the prefetch crowd out the reads that
+		threads are actually waiting for. */
+		if (buf_pool->n_pend_reads
+		    > buf_pool->curr_size / BUF_READ_AHEAD_PEND_LIMIT) {
+			break;
+		}
+
+		if (buf_read_page_low(
+			    &err, false,
+			    BUF_READ_ANY_PAGE | OS_AIO_SIMULATED_WAKE_LATER,
+			    space, zip_size, FALSE, tablespace_version,
+			    page_nos[i], trx, NULL)) {
+			buf_pool->stat.n_ra_pages_read++;
+			count++;
+		}
+
+		if (err == DB_TABLESPACE_DELETED) {
+			break;
+		}
+	}
+
+	/* In simulated aio we wake the aio handler threads only after
+	queuing all aio requests, in native aio the following call does
+	nothing: */
+
+	os_aio_simulated_wake_handler_threads();
+
+	if (count > 0) {
+		/* Read ahead is considered one I/O operation for the
+		purpose of LRU policy decision. */
+		buf_LRU_stat_inc_io();
+	}
+
+	srv_stats.buf_pool_reads.add(count);
+
+	return(count);
+}
+
 /********************************************************************//**
 Applies linear read-ahead if in the buf_pool the page is a border page of
 a linear read-ahead area and all the pages in the area have been accessed.
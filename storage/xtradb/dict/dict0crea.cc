@@ -1225,6 +1225,11 @@ dict_create_index_step(
 					index_cache->words = 0;
 				}
 
+				if (index_cache->sync_words) {
+					rbt_free(index_cache->sync_words);
+					index_cache->sync_words = 0;
+				}
+
 				ib_vector_remove(
 					node->table->fts->cache->indexes,
 					*reinterpret_cast<void**>(index_cache));
@@ -157,6 +157,10 @@ struct index_cmp
 
 typedef std::map<const char*, dict_index_t*, index_cmp>	index_map_t;
 
+/** Number of index pages that the calculation of persistent statistics
+has read since startup */
+UNIV_INTERN ulint	dict_stats_n_pages_sampled;
+
 /*********************************************************************//**
 Checks whether an index should be ignored in stats manipulations:
 * stats fetch
@@ -1961,6 +1965,7 @@ dict_stats_analyze_index(
 	ulint		n_prefix;
 	ib_uint64_t	total_recs;
 	ib_uint64_t	total_pages;
+	ib_uint64_t	n_pages_read;
 	mtr_t		mtr;
 	ulint		size;
 	DBUG_ENTER("dict_stats_analyze_index");
@@ -1972,6 +1977,10 @@ dict_stats_analyze_index(
 
 	dict_stats_empty_index(index, false);
 
+	/* The modifications made from now on are counted towards the
+	next recalculation */
+	index->stat_modified_counter = 0;
+
 	mtr_start(&mtr);
 
 	mtr_s_lock(dict_index_get_lock(index), &mtr);
@@ -2042,6 +2051,9 @@ dict_stats_analyze_index(
 
 		mtr_commit(&mtr);
 
+		os_atomic_increment_ulint(&dict_stats_n_pages_sampled,
+					  (ulint) total_pages);
+
 		dict_stats_assert_initialized_index(index);
 		DBUG_VOID_RETURN;
 	}
@@ -2076,6 +2088,8 @@ dict_stats_analyze_index(
 	level = root_level;
 	level_is_analyzed = false;
 
+	n_pages_read = 0;
+
 	for (n_prefix = n_uniq; n_prefix >= 1; n_prefix--) {
 
 		DEBUG_PRINTF("  %s(): searching level with >=%llu "
@@ -2167,6 +2181,8 @@ dict_stats_analyze_index(
 						       n_diff_boundaries,
 						       &mtr);
 
+			n_pages_read += total_pages;
+
 			level_is_analyzed = true;
 
 			if (level == 1
@@ -2221,10 +2237,15 @@ dict_stats_analyze_index(
 		dict_stats_analyze_index_for_n_prefix(
 			index, n_prefix, &n_diff_boundaries[n_prefix - 1],
 			data, &mtr);
+
+		n_pages_read += data->n_leaf_pages_to_analyze;
 	}
 
 	mtr_commit(&mtr);
 
+	os_atomic_increment_ulint(&dict_stats_n_pages_sampled,
+				  (ulint) n_pages_read);
+
 	delete[] n_diff_boundaries;
 
 	delete[] n_diff_on_level;
@@ -2250,7 +2271,11 @@ static
 dberr_t
 dict_stats_update_persistent(
 /*=========================*/
-	dict_table_t*	table)		/*!< in/out: table */
+	dict_table_t*	table,		/*!< in/out: table */
+	bool		only_changed)	/*!< in: whether to keep the
+					statistics of the secondary indexes
+					that changed little since they were
+					last analyzed */
 {
 	dict_index_t*	index;
 
@@ -2287,6 +2312,11 @@ dict_stats_update_persistent(
 
 	table->stat_sum_of_other_index_sizes = 0;
 
+	/* A secondary index that got less than 10% of the rows modified
+	keeps its statistics; the clustered index is always analyzed,
+	because the row count of the table comes from it */
+	only_changed = only_changed && table->stat_initialized;
+
 	for (index = dict_table_get_next_index(index);
 	     index != NULL;
 	     index = dict_table_get_next_index(index)) {
@@ -2297,6 +2327,16 @@ dict_stats_update_persistent(
 			continue;
 		}
 
+		if (only_changed
+		    && !dict_stats_should_ignore_index(index)
+		    && index->stat_modified_counter
+		    <= 16 + table->stat_n_rows / 10) {
+
+			table->stat_sum_of_other_index_sizes
+				+= index->stat_index_size;
+			continue;
+		}
+
 		dict_stats_empty_index(index, false);
 
 		if (dict_stats_should_ignore_index(index)) {
@@ -3204,6 +3244,7 @@ dict_stats_update(
 
 	switch (stats_upd_option) {
 	case DICT_STATS_RECALC_PERSISTENT:
+	case DICT_STATS_RECALC_PERSISTENT_CHANGED:
 
 		if (srv_read_only_mode) {
 			goto transient;
@@ -3227,7 +3268,10 @@ dict_stats_update(
 
 			dberr_t	err;
 
-			err = dict_stats_update_persistent(table);
+			err = dict_stats_update_persistent(
+				table,
+				stats_upd_option
+				== DICT_STATS_RECALC_PERSISTENT_CHANGED);
 
 			if (err != DB_SUCCESS) {
 				return(err);
@@ -62,6 +62,23 @@ static recalc_pool_t		recalc_pool;
 
 typedef recalc_pool_t::iterator	recalc_pool_iterator_t;
 
+/** Tables whose statistics are recalculated in one round of the
+background stats thread, shared by the recalculation threads */
+struct dict_stats_recalc_t {
+	recalc_pool_t	tables;		/*!< ids of the tables */
+	ulint		next;		/*!< next slot of tables[] to process */
+	ulint		start_time_ms;	/*!< ut_time_ms() at the start
+					of the round */
+	ulint		n_pages_start;	/*!< dict_stats_n_pages_sampled at
+					the start of the round */
+};
+
+/** A thread recalculating the statistics of tables */
+struct dict_stats_recalc_thread_t {
+	dict_stats_recalc_t*	recalc;	/*!< shared state */
+	os_thread_t		thread_hdl;/*!< thread handle */
+};
+
 /** Indices whose defrag stats need to be saved to persistent storage.*/
 struct defrag_pool_item_t {
 	table_id_t	table_id;
@@ -148,17 +165,18 @@ dict_stats_recalc_pool_add(
 }
 
 /*****************************************************************//**
-Get a table from the auto recalc pool. The returned table id is removed
-from the pool.
-@return true if the pool was non-empty and "id" was set, false otherwise */
+Get all tables from the auto recalc pool. The returned table ids are
+removed from the pool.
+@return true if the pool was non-empty and "ids" was set, false otherwise */
 static
 bool
-dict_stats_recalc_pool_get(
-/*=======================*/
-	table_id_t*	id)	/*!< out: table id, or unmodified if list is
-				empty */
+dict_stats_recalc_pool_get_all(
+/*===========================*/
+	recalc_pool_t*	ids)	/*!< out: table ids, in the order they
+				were added; must be empty */
 {
 	ut_ad(!srv_read_only_mode);
+	ut_ad(ids->empty());
 
 	mutex_enter(&recalc_pool_mutex);
 
@@ -167,9 +185,9 @@ dict_stats_recalc_pool_get(
 		return(false);
 	}
 
-	*id = recalc_pool[0];
+	ids->swap(recalc_pool);
 
-	recalc_pool.erase(recalc_pool.begin());
+	recalc_pool.reserve(RECALC_POOL_INITIAL_SLOTS);
 
 	mutex_exit(&recalc_pool_mutex);
 
@@ -391,23 +409,16 @@ dict_stats_thread_deinit()
 }
 
 /*****************************************************************//**
-Get the first table that has been added for auto recalc and eventually
-update its stats. */
+Eventually update the stats of a table that has been added for auto
+recalc. */
 static
 void
-dict_stats_process_entry_from_recalc_pool()
-/*=======================================*/
+dict_stats_process_entry_from_recalc_pool(
+/*======================================*/
+	table_id_t	table_id)	/*!< in: id of the table */
 {
-	table_id_t	table_id;
-
 	ut_ad(!srv_read_only_mode);
 
-	/* pop the first table from the auto recalc pool */
-	if (!dict_stats_recalc_pool_get(&table_id)) {
-		/* no tables for auto recalc */
-		return;
-	}
-
 	dict_table_t*	table;
 
 	mutex_enter(&dict_sys->mutex);
@@ -450,7 +461,10 @@ dict_stats_process_entry_from_recalc_pool()
 
 	} else {
 
-		dict_stats_update(table, DICT_STATS_RECALC_PERSISTENT);
+		dict_stats_update(table,
+				  srv_stats_recalc_incremental
+				  ? DICT_STATS_RECALC_PERSISTENT_CHANGED
+				  : DICT_STATS_RECALC_PERSISTENT);
 	}
 
 	mutex_enter(&dict_sys->mutex);
@@ -462,6 +476,130 @@ dict_stats_process_entry_from_recalc_pool()
 	mutex_exit(&dict_sys->mutex);
 }
 
+/*****************************************************************//**
+Wait until the background recalculation can read more index pages
+without exceeding innodb_stats_recalc_io_budget pages per second. The
+pages read by ANALYZE TABLE meanwhile count against the budget too. */
+static
+void
+dict_stats_recalc_throttle(
+/*=======================*/
+	const dict_stats_recalc_t*	recalc)	/*!< in: current round */
+{
+	for (;;) {
+		ulint	budget = srv_stats_recalc_io_budget;
+
+		if (budget == 0 || SHUTTING_DOWN()) {
+			return;
+		}
+
+		ulint	n_pages = dict_stats_n_pages_sampled
+			- recalc->n_pages_start;
+		ulint	elapsed_ms = ut_time_ms() - recalc->start_time_ms;
+
+		/* Allow a burst of one second worth of pages, so that
+		the first table of a round is never delayed */
+		if (n_pages <= budget + budget * elapsed_ms / 1000) {
+			return;
+		}
+
+		os_thread_sleep(100000);
+	}
+}
+
+/*****************************************************************//**
+Recalculate the stats of the tables of a round until all of them have
+been processed or shutdown is initiated. */
+static
+void
+dict_stats_recalc_tables(
+/*=====================*/
+	dict_stats_recalc_t*	recalc)	/*!< in/out: current round */
+{
+	for (;;) {
+		dict_stats_recalc_throttle(recalc);
+
+		if (SHUTTING_DOWN()) {
+			return;
+		}
+
+		ulint	i = os_atomic_increment_ulint(&recalc->next, 1) - 1;
+
+		if (i >= recalc->tables.size()) {
+			return;
+		}
+
+		dict_stats_process_entry_from_recalc_pool(recalc->tables[i]);
+	}
+}
+
+/*****************************************************************//**
+Thread recalculating the stats of the tables of a round.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(dict_stats_recalc_thread)(
+/*=====================================*/
+	void*	arg)	/*!< in: dict_stats_recalc_thread_t */
+{
+	dict_stats_recalc_thread_t*	thr
+		= static_cast<dict_stats_recalc_thread_t*>(arg);
+
+	dict_stats_recalc_tables(thr->recalc);
+
+	os_thread_exit(NULL, false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*****************************************************************//**
+Take all tables that have been added for auto recalc and eventually
+update their stats, using innodb_stats_recalc_threads threads. */
+static
+void
+dict_stats_process_recalc_pool()
+/*============================*/
+{
+	dict_stats_recalc_t	recalc;
+
+	ut_ad(!srv_read_only_mode);
+
+	if (!dict_stats_recalc_pool_get_all(&recalc.tables)) {
+		/* no tables for auto recalc */
+		return;
+	}
+
+	recalc.next = 0;
+	recalc.start_time_ms = ut_time_ms();
+	recalc.n_pages_start = dict_stats_n_pages_sampled;
+
+	ulint	n_threads = ut_min(ut_max(srv_stats_recalc_threads, 1),
+				   recalc.tables.size());
+
+	dict_stats_recalc_thread_t*	thr = NULL;
+
+	if (n_threads > 1) {
+		thr = static_cast<dict_stats_recalc_thread_t*>(
+			ut_malloc(n_threads * sizeof(*thr)));
+	}
+
+	for (ulint i = 1; i < n_threads; i++) {
+		os_thread_id_t	thread_id;
+
+		thr[i].recalc = &recalc;
+		thr[i].thread_hdl = os_thread_create(
+			dict_stats_recalc_thread, &thr[i], &thread_id);
+	}
+
+	dict_stats_recalc_tables(&recalc);
+
+	for (ulint i = 1; i < n_threads; i++) {
+		os_thread_join(thr[i].thread_hdl);
+	}
+
+	ut_free(thr);
+}
+
 /*****************************************************************//**
 Get the first index that has been added for updating persistent defrag
 stats and eventually save its stats. */
@@ -539,7 +677,7 @@ DECLARE_THREAD(dict_stats_thread)(
 
 		/* Wake up periodically even if not signaled. This is
 		because we may lose an event - if the below call to
-		dict_stats_process_entry_from_recalc_pool() puts the entry back
+		dict_stats_process_recalc_pool() puts an entry back
 		in the list, the os_event_set() will be lost by the subsequent
 		os_event_reset(). */
 		os_event_wait_time(
@@ -549,7 +687,7 @@ DECLARE_THREAD(dict_stats_thread)(
 			break;
 		}
 
-		dict_stats_process_entry_from_recalc_pool();
+		dict_stats_process_recalc_pool();
 
 		while (defrag_pool.size())
 			dict_stats_process_entry_from_defrag_pool();
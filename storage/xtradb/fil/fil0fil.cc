@@ -5470,6 +5470,78 @@ fil_extend_space_to_desired_size(
 	return(success);
 }
 
+#ifndef UNIV_HOTBACKUP
+/**********************************************************************//**
+Shrinks the single data file of an undo tablespace to the given number of
+pages. The caller must have removed all pages of the tablespace from the
+buffer pool, and must prevent any access to it until the space header has
+been initialized again.
+@return	true if success */
+UNIV_INTERN
+bool
+fil_truncate_undo_tablespace(
+/*=========================*/
+	ulint	space_id,	/*!< in: undo tablespace id */
+	ulint	size)		/*!< in: new size in pages */
+{
+	fil_node_t*	node;
+	fil_space_t*	space;
+	ibool		success;
+
+	ut_ad(!srv_read_only_mode);
+	ut_ad(space_id != 0);
+
+retry:
+	fil_mutex_enter_and_prepare_for_io(space_id);
+
+	space = fil_space_get_by_id(space_id);
+	ut_a(space);
+	ut_a(UT_LIST_GET_LEN(space->chain) == 1);
+
+	node = UT_LIST_GET_FIRST(space->chain);
+
+	if (node->being_extended) {
+		/* Wait for the extension of the file to finish. */
+		mutex_exit(&fil_system->mutex);
+		os_thread_sleep(100000);
+		goto retry;
+	}
+
+	if (!fil_node_prepare_for_io(node, fil_system, space)) {
+		mutex_exit(&fil_system->mutex);
+
+		return(false);
+	}
+
+	/* Prevent the file from being closed or extended while it
+	is being truncated, like fil_extend_space_to_desired_size(). */
+	node->being_extended = TRUE;
+
+	mutex_exit(&fil_system->mutex);
+
+	success = os_file_set_eof_at(
+		node->handle, (os_offset_t) size * UNIV_PAGE_SIZE);
+
+	if (success) {
+		success = os_file_flush(node->handle);
+	}
+
+	mutex_enter(&fil_system->mutex);
+
+	if (success) {
+		space->size = node->size = size;
+	}
+
+	node->being_extended = FALSE;
+
+	fil_node_complete_io(node, fil_system, OS_FILE_READ);
+
+	mutex_exit(&fil_system->mutex);
+
+	return(success);
+}
+#endif /* !UNIV_HOTBACKUP */
+
 #ifdef UNIV_HOTBACKUP
 /********************************************************************//**
 Extends all tablespaces to the size stored in the space header. During the
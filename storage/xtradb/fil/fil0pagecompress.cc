@@ -79,6 +79,9 @@ static ulint srv_data_read, srv_data_written;
 #ifdef HAVE_SNAPPY
 #include "snappy-c.h"
 #endif
+#ifdef HAVE_ZSTD
+#include "zstd.h"
+#endif
 
 /* Used for debugging */
 //#define UNIV_PAGECOMPRESS_DEBUG 1
@@ -299,6 +302,35 @@ fil_compress_page(
 	}
 #endif /* HAVE_SNAPPY */
 
+#ifdef HAVE_ZSTD
+	case PAGE_ZSTD_ALGORITHM:
+	{
+		size_t	cret = ZSTD_compress(
+			out_buf + header_len, (size_t)write_size,
+			buf, (size_t)len, comp_level);
+
+		if (ZSTD_isError(cret)
+		    || cret > UNIV_PAGE_SIZE - header_len) {
+			if (space->printed_compression_failure == false) {
+				ib_logf(IB_LOG_LEVEL_WARN,
+					"Compression failed for space %lu name %s len %lu err %s write_size %lu.",
+					space_id, fil_space_name(space), len,
+					ZSTD_isError(cret)
+					? ZSTD_getErrorName(cret) : "overflow",
+					(ulint) cret);
+				space->printed_compression_failure = true;
+			}
+
+			srv_stats.pages_page_compression_error.inc();
+			*out_len = len;
+			goto err_exit;
+		}
+
+		write_size = cret;
+		break;
+	}
+#endif /* HAVE_ZSTD */
+
 	case PAGE_ZLIB_ALGORITHM:
 		err = compress2(out_buf+header_len, (ulong*)&write_size, buf, len, comp_level);
 
@@ -692,6 +724,32 @@ fil_decompress_page(
 		break;
 	}
 #endif /* HAVE_SNAPPY */
+#ifdef HAVE_ZSTD
+	case PAGE_ZSTD_ALGORITHM:
+	{
+		size_t	olen = ZSTD_decompress(
+			in_buf, UNIV_PAGE_SIZE,
+			buf + header_len, (size_t)actual_size);
+
+		if (ZSTD_isError(olen) || olen == 0 || olen > UNIV_PAGE_SIZE) {
+			ib_logf(IB_LOG_LEVEL_ERROR,
+				"Corruption: Page is marked as compressed"
+				" but decompression read only %lu bytes"
+				" size %lu len %lu err %s.",
+				ZSTD_isError(olen) ? 0 : (ulint) olen,
+				actual_size, len,
+				ZSTD_isError(olen)
+				? ZSTD_getErrorName(olen) : "none");
+			fflush(stderr);
+
+			if (return_error) {
+				goto error_return;
+			}
+			ut_error;
+		}
+		break;
+	}
+#endif /* HAVE_ZSTD */
 	default:
 		ib_logf(IB_LOG_LEVEL_ERROR,
 			"Corruption: Page is marked as compressed"
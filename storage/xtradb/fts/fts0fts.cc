@@ -27,10 +27,12 @@ Full Text Search interface
 #include "row0upd.h"
 #include "dict0types.h"
 #include "row0sel.h"
+#include "row0ins.h"
 
 #include "fts0fts.h"
 #include "fts0priv.h"
 #include "fts0types.h"
+#include "row0ftsort.h"
 
 #include "fts0types.ic"
 #include "fts0vlc.ic"
@@ -265,7 +267,6 @@ static const char* fts_config_table_insert_values_sql =
 /** Run SYNC on the table, i.e., write out data from the cache to the
 FTS auxiliary INDEX table and clear the cache at the end.
 @param[in,out]	sync		sync state
-@param[in]	unlock_cache	whether unlock cache lock when write node
 @param[in]	wait		whether wait when a sync is in progress
 @param[in]      has_dict        whether has dict operation lock
 @return DB_SUCCESS if all OK */
@@ -273,7 +274,6 @@ static
 dberr_t
 fts_sync(
 	fts_sync_t*	sync,
-	bool		unlock_cache,
 	bool		wait,
 	bool		has_dict);
 
@@ -574,7 +574,6 @@ fts_index_cache_init(
 		allocator, sizeof(fts_doc_stats_t), 4);
 
 	for (i = 0; fts_index_selector[i].value; ++i) {
-		ut_a(index_cache->ins_graph[i] == NULL);
 		ut_a(index_cache->sel_graph[i] == NULL);
 	}
 }
@@ -894,6 +893,11 @@ fts_drop_index(
 				rbt_free(index_cache->words);
 			}
 
+			if (index_cache->sync_words) {
+				fts_words_free(index_cache->sync_words);
+				rbt_free(index_cache->sync_words);
+			}
+
 			ib_vector_remove(cache->indexes, *(void**) index_cache);
 		}
 
@@ -1027,10 +1031,6 @@ fts_cache_index_cache_create(
 
 	n_bytes = sizeof(que_t*) * sizeof(fts_index_selector);
 
-	index_cache->ins_graph = static_cast<que_t**>(
-		mem_heap_zalloc(static_cast<mem_heap_t*>(
-			cache->self_heap->arg), n_bytes));
-
 	index_cache->sel_graph = static_cast<que_t**>(
 		mem_heap_zalloc(static_cast<mem_heap_t*>(
 			cache->self_heap->arg), n_bytes));
@@ -1079,6 +1079,41 @@ fts_words_free(
 	}
 }
 
+/** Free the cache contents that SYNC has written to disk, or that a
+failed SYNC left behind.
+@param[in,out]	cache	fts cache */
+static
+void
+fts_cache_sync_free(
+	fts_cache_t*	cache)
+{
+	fts_sync_t*	sync = cache->sync;
+
+	if (sync->heap == NULL) {
+		return;
+	}
+
+	for (ulint i = 0; i < ib_vector_size(cache->indexes); ++i) {
+		fts_index_cache_t*	index_cache;
+
+		index_cache = static_cast<fts_index_cache_t*>(
+			ib_vector_get(cache->indexes, i));
+
+		if (index_cache->sync_words != NULL) {
+			fts_words_free(index_cache->sync_words);
+			rbt_free(index_cache->sync_words);
+			index_cache->sync_words = NULL;
+		}
+	}
+
+	mutex_enter((ib_mutex_t*) &cache->deleted_lock);
+	sync->deleted_doc_ids = NULL;
+	mutex_exit((ib_mutex_t*) &cache->deleted_lock);
+
+	mem_heap_free(sync->heap);
+	sync->heap = NULL;
+}
+
 /** Clear cache.
 @param[in,out]	cache	fts cache */
 UNIV_INTERN
@@ -1088,6 +1123,8 @@ fts_cache_clear(
 {
 	ulint		i;
 
+	fts_cache_sync_free(cache);
+
 	for (i = 0; i < ib_vector_size(cache->indexes); ++i) {
 		ulint			j;
 		fts_index_cache_t*	index_cache;
@@ -1103,15 +1140,6 @@ fts_cache_clear(
 
 		for (j = 0; fts_index_selector[j].value; ++j) {
 
-			if (index_cache->ins_graph[j] != NULL) {
-
-				fts_que_graph_free_check_lock(
-					NULL, index_cache,
-					index_cache->ins_graph[j]);
-
-				index_cache->ins_graph[j] = NULL;
-			}
-
 			if (index_cache->sel_graph[j] != NULL) {
 
 				fts_que_graph_free_check_lock(
@@ -1442,7 +1470,7 @@ fts_cache_add_doc(
 				ib_vector_last(word->nodes));
 		}
 
-		if (fts_node == NULL || fts_node->synced
+		if (fts_node == NULL
 		    || fts_node->ilist_size > FTS_ILIST_MAX_SIZE
 		    || doc_id < fts_node->last_doc_id) {
 
@@ -3572,7 +3600,7 @@ fts_add_doc_by_id(
 
 				DBUG_EXECUTE_IF(
 					"fts_instrument_sync_debug",
-					fts_sync(cache->sync, true, true, false);
+					fts_sync(cache->sync, true, false);
 				);
 
 				DEBUG_SYNC_C("fts_instrument_sync_request");
@@ -3908,8 +3936,8 @@ static MY_ATTRIBUTE((nonnull, warn_unused_result))
 dberr_t
 fts_sync_add_deleted_cache(
 /*=======================*/
-	fts_sync_t*	sync,			/*!< in: sync state */
-	ib_vector_t*	doc_ids)		/*!< in: doc ids to add */
+	fts_sync_t*		sync,		/*!< in: sync state */
+	const ib_vector_t*	doc_ids)	/*!< in: sorted doc ids to add */
 {
 	ulint		i;
 	pars_info_t*	info;
@@ -3921,7 +3949,8 @@ fts_sync_add_deleted_cache(
 
 	ut_a(ib_vector_size(doc_ids) > 0);
 
-	ib_vector_sort(doc_ids, fts_update_doc_id_cmp);
+	/* fts_sync_begin() sorted the doc ids; queries may be reading
+	them, so they must not be sorted here. */
 
 	info = pars_info_create();
 
@@ -3936,10 +3965,11 @@ fts_sync_add_deleted_cache(
 		"BEGIN INSERT INTO \"%s\" VALUES (:doc_id);");
 
 	for (i = 0; i < n_elems && error == DB_SUCCESS; ++i) {
-		fts_update_t*	update;
-		doc_id_t	write_doc_id;
+		const fts_update_t*	update;
+		doc_id_t		write_doc_id;
 
-		update = static_cast<fts_update_t*>(ib_vector_get(doc_ids, i));
+		update = static_cast<const fts_update_t*>(
+			ib_vector_get_const(doc_ids, i));
 
 		/* Convert to "storage" byte order. */
 		fts_write_doc_id((byte*) &write_doc_id, update->doc_id);
@@ -3953,17 +3983,146 @@ fts_sync_add_deleted_cache(
 	return(error);
 }
 
-/** Write the words and ilist to disk.
+/** Inserter of rows into an FTS auxiliary INDEX table. SYNC writes the
+rows through an insert node of its own instead of an InnoDB SQL graph, so
+that it need not go through the parser or bind the columns by name. */
+struct fts_aux_ins_t {
+	dict_table_t*	table;		/*!< auxiliary INDEX table, or NULL
+					if not opened yet */
+	que_t*		graph;		/*!< insert graph */
+	ins_node_t*	node;		/*!< insert node */
+};
+
+/** Open an auxiliary INDEX table for inserting rows.
+@param[in,out]	trx		transaction
+@param[in,out]	ins		inserter, zero-initialized
+@param[in]	fts_table	auxiliary table
+@return DB_SUCCESS or DB_TABLE_NOT_FOUND */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+fts_aux_ins_open(
+	trx_t*			trx,
+	fts_aux_ins_t*		ins,
+	const fts_table_t*	fts_table)
+{
+	char*		table_name;
+	mem_heap_t*	heap;
+	dtuple_t*	row;
+	que_thr_t*	thr;
+	ibool		dict_locked;
+
+	ut_ad(ins->table == NULL);
+
+	dict_locked = fts_table->table->fts
+		&& (fts_table->table->fts->fts_status & TABLE_DICT_LOCKED);
+
+	table_name = fts_get_table_name(fts_table);
+
+	ins->table = dict_table_open_on_name(
+		table_name, dict_locked, FALSE, DICT_ERR_IGNORE_NONE);
+
+	mem_free(table_name);
+
+	if (ins->table == NULL) {
+		return(DB_TABLE_NOT_FOUND);
+	}
+
+	heap = mem_heap_create(512);
+
+	ins->node = ins_node_create(INS_DIRECT, ins->table, heap);
+
+	row = dtuple_create(heap, dict_table_get_n_cols(ins->table));
+	dict_table_copy_types(row, ins->table);
+
+	ins_node_set_new_row(ins->node, row);
+
+	thr = pars_complete_graph_for_exec(ins->node, trx, heap);
+
+	ins->graph = static_cast<que_t*>(que_node_get_parent(thr));
+
+	return(DB_SUCCESS);
+}
+
+/** Close an auxiliary INDEX table inserter.
+@param[in,out]	ins		inserter
+@param[in]	fts_table	auxiliary table */
+static
+void
+fts_aux_ins_close(
+	fts_aux_ins_t*		ins,
+	const fts_table_t*	fts_table)
+{
+	ibool		dict_locked;
+
+	if (ins->table == NULL) {
+		return;
+	}
+
+	dict_locked = fts_table->table->fts
+		&& (fts_table->table->fts->fts_status & TABLE_DICT_LOCKED);
+
+	que_graph_free(ins->graph);
+
+	dict_table_close(ins->table, dict_locked, FALSE);
+
+	ins->table = NULL;
+}
+
+/** Write out a single word's data as a new entry in an auxiliary INDEX
+table, like fts_write_node() does.
+@param[in,out]	trx	transaction
+@param[in,out]	ins	inserter of the auxiliary table
+@param[in]	word	word in UTF-8
+@param[in]	node	node columns
+@return DB_SUCCESS if all OK */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+fts_aux_ins_node(
+	trx_t*			trx,
+	fts_aux_ins_t*		ins,
+	const fts_string_t*	word,
+	const fts_node_t*	node)
+{
+	dtuple_t*	row = ins->node->row;
+	byte		first_doc_id[8];
+	byte		last_doc_id[8];
+	byte		doc_count[4];
+	ib_time_t	start_time;
+	dberr_t		error;
+
+	ut_a(node->last_doc_id >= node->first_doc_id);
+
+	/* Convert to "storage" byte order. */
+	fts_write_doc_id(first_doc_id, node->first_doc_id);
+	fts_write_doc_id(last_doc_id, node->last_doc_id);
+	mach_write_to_4(doc_count, node->doc_count);
+
+	/* The columns are (word, first_doc_id, last_doc_id, doc_count,
+	ilist), see fts_create_one_index_table(). */
+	dfield_set_data(dtuple_get_nth_field(row, 0), word->f_str, word->f_len);
+	dfield_set_data(dtuple_get_nth_field(row, 1), first_doc_id, 8);
+	dfield_set_data(dtuple_get_nth_field(row, 2), last_doc_id, 8);
+	dfield_set_data(dtuple_get_nth_field(row, 3), doc_count, 4);
+	dfield_set_data(
+		dtuple_get_nth_field(row, 4), node->ilist, node->ilist_size);
+
+	start_time = ut_time();
+	error = fts_eval_sql(trx, ins->graph);
+	elapsed_time += ut_time() - start_time;
+	++n_nodes;
+
+	return(error);
+}
+
+/** Write the words and ilist that SYNC detached from the cache to disk.
 @param[in,out]	trx		transaction
 @param[in]	index_cache	index cache
-@param[in]	unlock_cache	whether unlock cache when write node
 @return DB_SUCCESS if all went well else error code */
 static MY_ATTRIBUTE((nonnull, warn_unused_result))
 dberr_t
 fts_sync_write_words(
 	trx_t*			trx,
-	fts_index_cache_t*	index_cache,
-	bool			unlock_cache)
+	fts_index_cache_t*	index_cache)
 {
 	fts_table_t	fts_table;
 	ulint		n_nodes = 0;
@@ -3971,21 +4130,22 @@ fts_sync_write_words(
 	const ib_rbt_node_t* rbt_node;
 	dberr_t		error = DB_SUCCESS;
 	ibool		print_error = FALSE;
-	dict_table_t*	table = index_cache->index->table;
+	fts_aux_ins_t	ins[FTS_NUM_AUX_INDEX];
 #ifdef FTS_DOC_STATS_DEBUG
+	dict_table_t*	table = index_cache->index->table;
 	ulint		n_new_words = 0;
 #endif /* FTS_DOC_STATS_DEBUG */
 
 	FTS_INIT_INDEX_TABLE(
 		&fts_table, NULL, FTS_INDEX_TABLE, index_cache->index);
 
-	n_words = rbt_size(index_cache->words);
+	memset(ins, 0, sizeof ins);
+
+	n_words = rbt_size(index_cache->sync_words);
 
-	/* We iterate over the entire tree, even if there is an error,
-	since we want to free the memory used during caching. */
-	for (rbt_node = rbt_first(index_cache->words);
-	     rbt_node;
-	     rbt_node = rbt_next(index_cache->words, rbt_node)) {
+	for (rbt_node = rbt_first(index_cache->sync_words);
+	     rbt_node != NULL && error == DB_SUCCESS;
+	     rbt_node = rbt_next(index_cache->sync_words, rbt_node)) {
 
 		ulint			i;
 		ulint			selected;
@@ -3997,12 +4157,14 @@ fts_sync_write_words(
 			index_cache->charset, word->text.f_str,
 			word->text.f_len);
 
+		ut_ad(selected < FTS_NUM_AUX_INDEX);
+
 		fts_table.suffix = fts_get_suffix(selected);
 
 #ifdef FTS_DOC_STATS_DEBUG
 		/* Check if the word exists in the FTS index and if not
 		then we need to increment the total word count stats. */
-		if (error == DB_SUCCESS && fts_enable_diag_print) {
+		if (fts_enable_diag_print) {
 			ibool	found = FALSE;
 
 			error = fts_is_word_in_index(
@@ -4018,43 +4180,29 @@ fts_sync_write_words(
 		}
 #endif /* FTS_DOC_STATS_DEBUG */
 
-		/* We iterate over all the nodes even if there was an error */
-		for (i = 0; i < ib_vector_size(word->nodes); ++i) {
-
-			fts_node_t* fts_node = static_cast<fts_node_t*>(
-				ib_vector_get(word->nodes, i));
-
-			if (fts_node->synced) {
-				continue;
-			} else {
-				fts_node->synced = true;
-			}
+		if (error == DB_SUCCESS && ins[selected].table == NULL) {
+			error = fts_aux_ins_open(
+				trx, &ins[selected], &fts_table);
+		}
 
-			/*FIXME: we need to handle the error properly. */
-			if (error == DB_SUCCESS) {
-				if (unlock_cache) {
-					rw_lock_x_unlock(
-						&table->fts->cache->lock);
-				}
+		for (i = 0;
+		     i < ib_vector_size(word->nodes) && error == DB_SUCCESS;
+		     ++i) {
 
-				error = fts_write_node(
-					trx,
-					&index_cache->ins_graph[selected],
-					&fts_table, &word->text, fts_node);
+			const fts_node_t* fts_node
+				= static_cast<const fts_node_t*>(
+					ib_vector_get_const(word->nodes, i));
 
-				DEBUG_SYNC_C("fts_write_node");
-				DBUG_EXECUTE_IF("fts_write_node_crash",
-					DBUG_SUICIDE(););
+			error = fts_aux_ins_node(
+				trx, &ins[selected], &word->text, fts_node);
 
-				DBUG_EXECUTE_IF("fts_instrument_sync_sleep",
-					os_thread_sleep(1000000);
-				);
+			DEBUG_SYNC_C("fts_write_node");
+			DBUG_EXECUTE_IF("fts_write_node_crash",
+				DBUG_SUICIDE(););
 
-				if (unlock_cache) {
-					rw_lock_x_lock(
-						&table->fts->cache->lock);
-				}
-			}
+			DBUG_EXECUTE_IF("fts_instrument_sync_sleep",
+				os_thread_sleep(1000000);
+			);
 		}
 
 		n_nodes += ib_vector_size(word->nodes);
@@ -4069,6 +4217,11 @@ fts_sync_write_words(
 		}
 	}
 
+	for (ulint i = 0; i < FTS_NUM_AUX_INDEX; ++i) {
+		fts_table.suffix = fts_get_suffix(i);
+		fts_aux_ins_close(&ins[i], &fts_table);
+	}
+
 #ifdef FTS_DOC_STATS_DEBUG
 	if (error == DB_SUCCESS && n_new_words > 0 && fts_enable_diag_print) {
 		fts_table_t	fts_table;
@@ -4318,7 +4471,7 @@ fts_is_word_in_index(
 #endif /* FTS_DOC_STATS_DEBUG */
 
 /*********************************************************************//**
-Begin Sync, create transaction, acquire locks, etc. */
+Begin Sync, create transaction, detach the cache contents to write. */
 static
 void
 fts_sync_begin(
@@ -4327,6 +4480,10 @@ fts_sync_begin(
 {
 	fts_cache_t*	cache = sync->table->fts->cache;
 
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(&cache->lock, RW_LOCK_EX));
+#endif
+
 	n_nodes = 0;
 	elapsed_time = 0;
 
@@ -4342,6 +4499,43 @@ fts_sync_begin(
 			ib_vector_size(cache->deleted_doc_ids),
 			cache->total_size);
 	}
+
+	/* If the previous SYNC failed, write its contents first. The
+	documents added since then stay in the cache for the next SYNC. */
+	if (sync->heap != NULL) {
+		return;
+	}
+
+	/* Detach the words and the deleted doc ids, and let the cache
+	carry on with empty ones, so that documents can be added and
+	deleted while SYNC is writing. */
+	sync->heap = static_cast<mem_heap_t*>(cache->sync_heap->arg);
+	cache->sync_heap->arg = NULL;
+
+	sync->sync_doc_id = sync->max_doc_id;
+
+	for (ulint i = 0; i < ib_vector_size(cache->indexes); ++i) {
+		fts_index_cache_t*	index_cache;
+
+		index_cache = static_cast<fts_index_cache_t*>(
+			ib_vector_get(cache->indexes, i));
+
+		ut_ad(index_cache->sync_words == NULL);
+
+		index_cache->sync_words = index_cache->words;
+		index_cache->words = NULL;
+		index_cache->doc_stats = NULL;
+	}
+
+	mutex_enter((ib_mutex_t*) &cache->deleted_lock);
+	/* Sort the doc ids before they are written to the DELETED_CACHE
+	table; nothing is added to the detached array after this. */
+	ib_vector_sort(cache->deleted_doc_ids, fts_update_doc_id_cmp);
+	sync->deleted_doc_ids = cache->deleted_doc_ids;
+	cache->deleted_doc_ids = NULL;
+	mutex_exit((ib_mutex_t*) &cache->deleted_lock);
+
+	fts_cache_init(cache);
 }
 
 /*********************************************************************//**
@@ -4362,12 +4556,12 @@ fts_sync_index(
 
 	if (fts_enable_diag_print) {
 		ib_logf(IB_LOG_LEVEL_INFO,
-			"SYNC words: %ld", rbt_size(index_cache->words));
+			"SYNC words: %ld", rbt_size(index_cache->sync_words));
 	}
 
-	ut_ad(rbt_validate(index_cache->words));
+	ut_ad(rbt_validate(index_cache->sync_words));
 
-	error = fts_sync_write_words(sync->trx, index_cache, sync->unlock_cache);
+	error = fts_sync_write_words(sync->trx, index_cache);
 
 #ifdef FTS_DOC_STATS_DEBUG
 	/* FTS_RESOLVE: the word counter info in auxiliary table "DOC_ID"
@@ -4383,57 +4577,6 @@ fts_sync_index(
 	return(error);
 }
 
-/** Check if index cache has been synced completely
-@param[in,out]	index_cache	index cache
-@return true if index is synced, otherwise false. */
-static
-bool
-fts_sync_index_check(
-	fts_index_cache_t*	index_cache)
-{
-	const ib_rbt_node_t*	rbt_node;
-
-	for (rbt_node = rbt_first(index_cache->words);
-	     rbt_node != NULL;
-	     rbt_node = rbt_next(index_cache->words, rbt_node)) {
-
-		fts_tokenizer_word_t*	word;
-		word = rbt_value(fts_tokenizer_word_t, rbt_node);
-
-		fts_node_t*	fts_node;
-		fts_node = static_cast<fts_node_t*>(ib_vector_last(word->nodes));
-
-		if (!fts_node->synced) {
-			return(false);
-		}
-	}
-
-	return(true);
-}
-
-/** Reset synced flag in index cache when rollback
-@param[in,out]	index_cache	index cache */
-static
-void
-fts_sync_index_reset(
-	fts_index_cache_t*	index_cache)
-{
-	const ib_rbt_node_t*	rbt_node;
-
-	for (rbt_node = rbt_first(index_cache->words);
-	     rbt_node != NULL;
-	     rbt_node = rbt_next(index_cache->words, rbt_node)) {
-
-		fts_tokenizer_word_t*	word;
-		word = rbt_value(fts_tokenizer_word_t, rbt_node);
-
-		fts_node_t*	fts_node;
-		fts_node = static_cast<fts_node_t*>(ib_vector_last(word->nodes));
-
-		fts_node->synced = false;
-	}
-}
-
 /** Commit the SYNC, change state of processed doc ids etc.
 @param[in,out]	sync	sync state
 @return DB_SUCCESS if all OK */
@@ -4451,31 +4594,32 @@ fts_sync_commit(
 
 	/* After each Sync, update the CONFIG table about the max doc id
 	we just sync-ed to index table */
-	error = fts_cmp_set_sync_doc_id(sync->table, sync->max_doc_id, FALSE,
+	error = fts_cmp_set_sync_doc_id(sync->table, sync->sync_doc_id, FALSE,
 					&last_doc_id);
 
 	/* Get the list of deleted documents that are either in the
 	cache or were headed there but were deleted before the add
-	thread got to them. */
+	thread got to them. fts_sync_begin() detached them, so that
+	fts_delete() can add new ones meanwhile. */
 
-	if (error == DB_SUCCESS && ib_vector_size(cache->deleted_doc_ids) > 0) {
+	if (error == DB_SUCCESS && ib_vector_size(sync->deleted_doc_ids) > 0) {
 
 		error = fts_sync_add_deleted_cache(
-			sync, cache->deleted_doc_ids);
+			sync, sync->deleted_doc_ids);
 	}
 
-	/* We need to do this within the deleted lock since fts_delete() can
-	attempt to add a deleted doc id to the cache deleted id array. */
-	fts_cache_clear(cache);
-	DEBUG_SYNC_C("fts_deleted_doc_ids_clear");
-	fts_cache_init(cache);
-	rw_lock_x_unlock(&cache->lock);
-
 	if (error == DB_SUCCESS) {
+		/* Queries look up the words of the SYNC in the cache
+		until they can be read from the INDEX table. */
+		rw_lock_x_lock(&cache->lock);
 
 		fts_sql_commit(trx);
 
-	} else if (error != DB_SUCCESS) {
+		fts_cache_sync_free(cache);
+		DEBUG_SYNC_C("fts_deleted_doc_ids_clear");
+
+		rw_lock_x_unlock(&cache->lock);
+	} else {
 
 		fts_sql_rollback(trx);
 
@@ -4500,7 +4644,8 @@ fts_sync_commit(
 	return(error);
 }
 
-/** Rollback a sync operation
+/** Rollback a sync operation. The detached cache contents are kept, and
+written by the next SYNC.
 @param[in,out]	sync	sync state */
 static
 void
@@ -4510,6 +4655,8 @@ fts_sync_rollback(
 	trx_t*		trx = sync->trx;
 	fts_cache_t*	cache = sync->table->fts->cache;
 
+	rw_lock_x_lock(&cache->lock);
+
 	for (ulint i = 0; i < ib_vector_size(cache->indexes); ++i) {
 		ulint			j;
 		fts_index_cache_t*	index_cache;
@@ -4517,21 +4664,8 @@ fts_sync_rollback(
 		index_cache = static_cast<fts_index_cache_t*>(
 			ib_vector_get(cache->indexes, i));
 
-		/* Reset synced flag so nodes will not be skipped
-		in the next sync, see fts_sync_write_words(). */
-		fts_sync_index_reset(index_cache);
-
 		for (j = 0; fts_index_selector[j].value; ++j) {
 
-			if (index_cache->ins_graph[j] != NULL) {
-
-				fts_que_graph_free_check_lock(
-					NULL, index_cache,
-					index_cache->ins_graph[j]);
-
-				index_cache->ins_graph[j] = NULL;
-			}
-
 			if (index_cache->sel_graph[j] != NULL) {
 
 				fts_que_graph_free_check_lock(
@@ -4553,9 +4687,10 @@ fts_sync_rollback(
 }
 
 /** Run SYNC on the table, i.e., write out data from the cache to the
-FTS auxiliary INDEX table and clear the cache at the end.
+FTS auxiliary INDEX table and clear the cache at the end. The cache
+contents are detached when SYNC starts, so that the cache lock is not
+held while they are written.
 @param[in,out]	sync		sync state
-@param[in]	unlock_cache	whether unlock cache lock when write node
 @param[in]	wait		whether wait when a sync is in progress
 @param[in]      has_dict        whether has dict operation lock
 @return DB_SUCCESS if all OK */
@@ -4563,7 +4698,6 @@ static
 dberr_t
 fts_sync(
 	fts_sync_t*	sync,
-	bool		unlock_cache,
 	bool		wait,
 	bool		has_dict)
 {
@@ -4573,9 +4707,7 @@ fts_sync(
 
 	rw_lock_x_lock(&cache->lock);
 
-	/* Check if cache is being synced.
-	Note: we release cache lock in fts_sync_write_words() to
-	avoid long wait for the lock by other threads. */
+	/* Check if cache is being synced. */
 	while (sync->in_progress) {
 		rw_lock_x_unlock(&cache->lock);
 
@@ -4588,33 +4720,27 @@ fts_sync(
 		rw_lock_x_lock(&cache->lock);
 	}
 
-	sync->unlock_cache = unlock_cache;
 	sync->in_progress = true;
 
 	DEBUG_SYNC_C("fts_sync_begin");
 	fts_sync_begin(sync);
 
+	rw_lock_x_unlock(&cache->lock);
+
 	/* When sync in background, we hold dict operation lock
 	to prevent DDL like DROP INDEX, etc. */
 	if (has_dict) {
 		sync->trx->dict_operation_lock_mode = RW_S_LATCH;
 	}
 
-begin_sync:
-	if (cache->total_size > fts_max_cache_size) {
-		/* Avoid the case: sync never finish when
-		insert/update keeps comming. */
-		ut_ad(sync->unlock_cache);
-		sync->unlock_cache = false;
-	}
-
 	for (i = 0; i < ib_vector_size(cache->indexes); ++i) {
 		fts_index_cache_t*	index_cache;
 
 		index_cache = static_cast<fts_index_cache_t*>(
 			ib_vector_get(cache->indexes, i));
 
-		if (index_cache->index->to_be_dropped) {
+		if (index_cache->index->to_be_dropped
+		    || index_cache->sync_words == NULL) {
 			continue;
 		}
 
@@ -4632,21 +4758,6 @@ fts_sync(
 			goto end_sync;
 	);
 
-	/* Make sure all the caches are synced. */
-	for (i = 0; i < ib_vector_size(cache->indexes); ++i) {
-		fts_index_cache_t*	index_cache;
-
-		index_cache = static_cast<fts_index_cache_t*>(
-			ib_vector_get(cache->indexes, i));
-
-		if (index_cache->index->to_be_dropped
-		    || fts_sync_index_check(index_cache)) {
-			continue;
-		}
-
-		goto begin_sync;
-	}
-
 end_sync:
 	if (error == DB_SUCCESS && !sync->interrupted) {
 		error = fts_sync_commit(sync);
@@ -4677,7 +4788,6 @@ fts_sync(
 /** Run SYNC on the table, i.e., write out data from the cache to the
 FTS auxiliary INDEX table and clear the cache at the end.
 @param[in,out]	table		fts table
-@param[in]	unlock_cache	whether unlock cache when write node
 @param[in]	wait		whether wait for existing sync to finish
 @param[in]	has_dict	whether has dict operation lock
 @return DB_SUCCESS on success, error code on failure. */
@@ -4685,7 +4795,6 @@ UNIV_INTERN
 dberr_t
 fts_sync_table(
 	dict_table_t*	table,
-	bool		unlock_cache,
 	bool		wait,
 	bool		has_dict)
 {
@@ -4694,8 +4803,7 @@ fts_sync_table(
 	ut_ad(table->fts);
 
 	if (!dict_table_is_discarded(table) && table->fts->cache) {
-		err = fts_sync(table->fts->cache->sync,
-			       unlock_cache, wait, has_dict);
+		err = fts_sync(table->fts->cache->sync, wait, has_dict);
 	}
 
 	return(err);
@@ -5307,6 +5415,8 @@ const ib_vector_t*
 fts_cache_find_word(
 /*================*/
 	const fts_index_cache_t*index_cache,	/*!< in: cache to search */
+	const ib_rbt_t*		words,		/*!< in: words or sync_words
+						of index_cache */
 	const fts_string_t*	text)		/*!< in: word to search for */
 {
 	ib_rbt_bound_t		parent;
@@ -5318,8 +5428,11 @@ fts_cache_find_word(
 	ut_ad(rw_lock_own((rw_lock_t*) &cache->lock, RW_LOCK_EX));
 #endif
 
+	ut_ad(words == index_cache->words
+	      || words == index_cache->sync_words);
+
 	/* Lookup the word in the rb tree */
-	if (rbt_search(index_cache->words, &parent, text) == 0) {
+	if (rbt_search(words, &parent, text) == 0) {
 		const fts_tokenizer_word_t*	word;
 
 		word = rbt_value(fts_tokenizer_word_t, parent.last);
@@ -5358,6 +5471,24 @@ fts_cache_is_deleted_doc_id(
 		}
 	}
 
+	/* The doc ids that a SYNC is writing to DELETED_CACHE */
+	const ib_vector_t*	sync_doc_ids = cache->sync->deleted_doc_ids;
+
+	if (sync_doc_ids != NULL) {
+
+		for (i = 0; i < ib_vector_size(sync_doc_ids); ++i) {
+			const fts_update_t*	update;
+
+			update = static_cast<const fts_update_t*>(
+				ib_vector_get_const(sync_doc_ids, i));
+
+			if (doc_id == update->doc_id) {
+
+				return(TRUE);
+			}
+		}
+	}
+
 	return(FALSE);
 }
 
@@ -5374,19 +5505,27 @@ fts_cache_append_deleted_doc_ids(
 
 	mutex_enter((ib_mutex_t*) &cache->deleted_lock);
 
-	if (cache->deleted_doc_ids == NULL) {
-		mutex_exit((ib_mutex_t*) &cache->deleted_lock);
-		return;
-	}
+	/* Include the doc ids that a SYNC is writing to the DELETED_CACHE
+	table, as it has not been committed yet. */
+	const ib_vector_t*	doc_ids[2];
 
+	doc_ids[0] = cache->sync->deleted_doc_ids;
+	doc_ids[1] = cache->deleted_doc_ids;
 
-	for (i = 0; i < ib_vector_size(cache->deleted_doc_ids); ++i) {
-		fts_update_t*	update;
+	for (ulint j = 0; j < 2; ++j) {
 
-		update = static_cast<fts_update_t*>(
-			ib_vector_get(cache->deleted_doc_ids, i));
+		if (doc_ids[j] == NULL) {
+			continue;
+		}
 
-		ib_vector_push(vector, &update->doc_id);
+		for (i = 0; i < ib_vector_size(doc_ids[j]); ++i) {
+			const fts_update_t*	update;
+
+			update = static_cast<const fts_update_t*>(
+				ib_vector_get_const(doc_ids[j], i));
+
+			ib_vector_push(vector, &update->doc_id);
+		}
 	}
 
 	mutex_exit((ib_mutex_t*) &cache->deleted_lock);
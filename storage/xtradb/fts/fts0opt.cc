@@ -235,6 +235,9 @@ struct fts_msg_t {
 /** The number of words to read and optimize in a single pass. */
 UNIV_INTERN ulong	fts_num_word_optimize;
 
+/** The number of threads that optimize the words read in a pass. */
+UNIV_INTERN ulong	fts_optimize_threads;
+
 // FIXME
 UNIV_INTERN char	fts_enable_diag_print;
 
@@ -1777,6 +1780,278 @@ fts_optimize_get_time_limit(
 }
 
 
+/** Shared state of a parallel OPTIMIZE of the words of an FTS index */
+struct fts_optimize_pll_t {
+	fts_optimize_t*	optim;		/*!< optimize instance */
+	ib_vector_t*	words;		/*!< the words to optimize, in
+					order, of type fts_string_t */
+	byte*		completed;	/*!< completed[i] is set once the
+					i'th word has been committed */
+	ulint		next;		/*!< next word to optimize,
+					incremented atomically */
+	ib_time_t	start_time;	/*!< optimize start time */
+	volatile bool	stop;		/*!< set to stop all threads */
+	dberr_t		error;		/*!< error that stopped the
+					threads, or DB_SUCCESS */
+};
+
+/** A thread of a parallel OPTIMIZE */
+struct fts_optimize_thread_t {
+	fts_optimize_pll_t*	pll;		/*!< shared state */
+	os_thread_t		thread_hdl;	/*!< thread handle */
+};
+
+/**********************************************************************//**
+Optimize words of an FTS index, claiming them one at a time, until all
+have been optimized or the optimize is stopped. Each word is rewritten
+and committed in a transaction of this thread. */
+static
+void
+fts_optimize_words_pll(
+/*===================*/
+	fts_optimize_pll_t*	pll)	/*!< in/out: shared state */
+{
+	fts_optimize_t*	optim = pll->optim;
+	fts_fetch_t	fetch;
+	que_t*		graph = NULL;
+	ulint		selected = ULINT_UNDEFINED;
+	mem_heap_t*	heap = mem_heap_create(1024);
+	ib_alloc_t*	heap_alloc = ib_heap_allocator_create(heap);
+	ib_vector_t*	words = ib_vector_create(
+		heap_alloc, sizeof(fts_word_t), 4);
+	trx_t*		trx = trx_allocate_for_background();
+
+	/* fts_index_fetch_nodes() and fts_optimize_write_word() set the
+	suffix of the aux table, so each thread needs its own copy. */
+	fts_table_t	fts_table = optim->fts_index_table;
+
+	/* The threads work on adjacent words of the same aux tables; do
+	not let them block each other with gap locks. */
+	trx->isolation_level = TRX_ISO_READ_COMMITTED;
+
+	fetch.read_arg = words;
+	fetch.read_record = fts_optimize_index_fetch_node;
+
+	while (!pll->stop) {
+		ulint		i = os_atomic_increment_ulint(&pll->next, 1) - 1;
+		fts_string_t*	word;
+		dberr_t		error;
+
+		if (i >= ib_vector_size(pll->words)) {
+			break;
+		}
+
+		word = static_cast<fts_string_t*>(ib_vector_get(pll->words, i));
+
+		if (selected != fts_select_index(
+			    fts_table.charset, word->f_str, word->f_len)) {
+
+			selected = fts_select_index(
+				fts_table.charset, word->f_str, word->f_len);
+
+			if (graph != NULL) {
+				fts_que_graph_free(graph);
+				graph = NULL;
+			}
+		}
+
+		do {
+			ut_a(ib_vector_size(words) == 0);
+
+			/* Read the index records to optimize. */
+			fetch.total_memory = 0;
+			error = fts_index_fetch_nodes(
+				trx, &graph, &fts_table, word, &fetch);
+			ut_ad(fetch.total_memory < fts_result_cache_limit);
+
+			for (ulint j = 0; j < ib_vector_size(words); ++j) {
+				fts_word_t*	fts_word;
+
+				fts_word = static_cast<fts_word_t*>(
+					ib_vector_get(words, j));
+
+				if (error == DB_SUCCESS) {
+					ib_vector_t*	nodes;
+
+					nodes = fts_optimize_word(
+						optim, fts_word);
+
+					error = fts_optimize_write_word(
+						trx, &fts_table,
+						&fts_word->text, nodes);
+				}
+
+				fts_word_free(fts_word);
+			}
+
+			ib_vector_reset(words);
+
+			if (error == DB_SUCCESS) {
+				fts_sql_commit(trx);
+			} else {
+				fts_sql_rollback(trx);
+			}
+
+			if (error == DB_LOCK_WAIT_TIMEOUT) {
+				fprintf(stderr, "InnoDB: Warning: lock wait "
+					"timeout during optimize. Retrying!\n");
+
+				trx->error_state = DB_SUCCESS;
+			} else if (error == DB_DEADLOCK) {
+				fprintf(stderr, "InnoDB: Warning: deadlock "
+					"during optimize. Retrying!\n");
+
+				trx->error_state = DB_SUCCESS;
+			} else {
+				break;
+			}
+		} while (!pll->stop);
+
+		if (error == DB_SUCCESS) {
+			pll->completed[i] = 1;
+		} else {
+			pll->error = error;
+			pll->stop = true;
+		}
+
+		if (fts_optimize_time_limit > 0
+		    && (ut_time() - pll->start_time)
+		    > fts_optimize_time_limit) {
+
+			pll->stop = true;
+		}
+	}
+
+	if (graph != NULL) {
+		fts_que_graph_free(graph);
+	}
+
+	trx_free_for_background(trx);
+
+	mem_heap_free(heap);
+}
+
+/*********************************************************************//**
+Thread of a parallel OPTIMIZE.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(fts_optimize_words_thread)(
+/*======================================*/
+	void*	arg)	/*!< in: fts_optimize_thread_t */
+{
+	fts_optimize_thread_t*	thr = static_cast<fts_optimize_thread_t*>(arg);
+
+	my_thread_init();
+
+	fts_optimize_words_pll(thr->pll);
+
+	my_thread_end();
+
+	os_thread_exit(NULL, false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/**********************************************************************//**
+Optimize the words read into optim->zip with several threads, see
+fts_optimize_words(). Since the words are not completed in order, the
+last optimized word that is stored in the config table is the last one
+of the leading words that have all been completed. */
+static
+void
+fts_optimize_words_parallel(
+/*========================*/
+	fts_optimize_t*	optim,		/*!< in: optimize instance */
+	dict_index_t*	index,		/*!< in: current FTS being optimized */
+	fts_string_t*	word,		/*!< in: the starting word to
+					optimize */
+	ulint		n_threads,	/*!< in: number of threads */
+	ib_time_t	start_time)	/*!< in: optimize start time */
+{
+	fts_optimize_pll_t	pll;
+	fts_optimize_thread_t*	thr;
+	ulint			n_done;
+	mem_heap_t*		heap = mem_heap_create(1024);
+	ib_alloc_t*		heap_alloc = ib_heap_allocator_create(heap);
+
+	pll.optim = optim;
+	pll.words = ib_vector_create(
+		heap_alloc, sizeof(fts_string_t), optim->zip->n_words);
+
+	/* Decompress all the words, so that the threads can claim them. */
+	do {
+		fts_string_t*	copy = static_cast<fts_string_t*>(
+			ib_vector_push(pll.words, NULL));
+
+		copy->f_str = static_cast<byte*>(
+			mem_heap_alloc(heap, word->f_len + 1));
+		memcpy(copy->f_str, word->f_str, word->f_len);
+		copy->f_str[word->f_len] = '\0';
+		copy->f_len = word->f_len;
+		copy->f_n_char = word->f_n_char;
+	} while (fts_zip_read_word(optim->zip, word));
+
+	pll.completed = static_cast<byte*>(
+		mem_heap_zalloc(heap, ib_vector_size(pll.words)));
+	pll.next = 0;
+	pll.start_time = start_time;
+	pll.stop = false;
+	pll.error = DB_SUCCESS;
+
+	n_threads = ut_min(n_threads, ib_vector_size(pll.words));
+
+	thr = static_cast<fts_optimize_thread_t*>(
+		mem_heap_alloc(heap, n_threads * sizeof(*thr)));
+
+	for (ulint i = 1; i < n_threads; i++) {
+		os_thread_id_t	thread_id;
+
+		thr[i].pll = &pll;
+		thr[i].thread_hdl = os_thread_create(
+			fts_optimize_words_thread, &thr[i], &thread_id);
+	}
+
+	fts_optimize_words_pll(&pll);
+
+	for (ulint i = 1; i < n_threads; i++) {
+		os_thread_join(thr[i].thread_hdl);
+	}
+
+	for (n_done = 0;
+	     n_done < ib_vector_size(pll.words) && pll.completed[n_done];
+	     ++n_done) {
+		/* No op */
+	}
+
+	if (n_done > 0) {
+		dberr_t	error;
+
+		/* Write the last word optimized to the config table,
+		we use this value for restarting optimize. */
+		error = fts_config_set_index_value(
+			optim->trx, index, FTS_LAST_OPTIMIZED_WORD,
+			static_cast<fts_string_t*>(
+				ib_vector_get(pll.words, n_done - 1)));
+
+		if (error == DB_SUCCESS) {
+			fts_sql_commit(optim->trx);
+		} else {
+			fts_sql_rollback(optim->trx);
+		}
+	}
+
+	if (pll.error != DB_SUCCESS) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr, " InnoDB: Error: (%s) while optimizing "
+			"FTS index %s.\n", ut_strerr(pll.error), index->name);
+	}
+
+	optim->done = TRUE;
+
+	mem_heap_free(heap);
+}
+
 /**********************************************************************//**
 Run OPTIMIZE on the given table. Note: this can take a very long time
 (hours). */
@@ -1801,6 +2076,12 @@ fts_optimize_words(
 
 	start_time = ut_time();
 
+	if (fts_optimize_threads > 1 && optim->zip->n_words > 1) {
+		fts_optimize_words_parallel(
+			optim, index, word, fts_optimize_threads, start_time);
+		return;
+	}
+
 	/* Setup the callback to use for fetching the word ilist etc. */
 	fetch.read_arg = optim->words;
 	fetch.read_record = fts_optimize_index_fetch_node;
@@ -2987,7 +3268,7 @@ fts_optimize_sync_table(
 
 	if (table) {
 		if (dict_table_has_fts_index(table) && table->fts->cache) {
-			fts_sync_table(table, true, false, true);
+			fts_sync_table(table, false, true);
 		}
 
 		dict_table_close(table, FALSE, FALSE);
@@ -40,6 +40,7 @@ Completed 2011/7/10 Sunny and Jimmy Yang
 #include "fts0vlc.ic"
 #endif
 
+#include <algorithm>
 #include <vector>
 
 #define FTS_ELEM(t, n, i, j) (t[(i) * n + (j)])
@@ -57,6 +58,10 @@ Completed 2011/7/10 Sunny and Jimmy Yang
 /*Initial byte length for 'words' in fts_ranking_t */
 #define RANKING_WORDS_INIT_LEN	4
 
+/* Relative margin between a top-k query threshold and the score bound of
+a document, so that float rounding of the ranks cannot reorder them */
+#define TOPK_SCORE_MARGIN	0.001
+
 // FIXME: Need to have a generic iterator that traverses the ilist.
 
 typedef std::vector<fts_string_t>	word_vector_t;
@@ -145,6 +150,10 @@ struct fts_query_t {
 					fts_word_freq_t */
 
 	bool		multi_exist;	/*!< multiple FTS_EXIST oper */
+
+	ulint		limit;		/*!< Number of most relevant documents
+					that the caller reads, or
+					ULINT_UNDEFINED if it reads all */
 };
 
 /** For phrase matching, first we collect the documents and the positions
@@ -234,6 +243,49 @@ struct fts_word_freq_t {
 	double		idf;		/*!< Inverse document frequency */
 };
 
+/** A node of a term read by a top-k query, either an FTS INDEX row or
+an FTS cache node. The highest word frequency of a document in the node
+bounds the score that the term can add to any of its documents. */
+struct fts_topk_block_t {
+	doc_id_t	first_doc_id;	/*!< First doc id in ilist */
+	doc_id_t	last_doc_id;	/*!< Last doc id in ilist */
+	byte*		ilist;		/*!< Doc ids and positions, allocated
+					on the query heap */
+	ulint		ilist_size;	/*!< Size of ilist in bytes */
+	ulint		max_freq;	/*!< Highest frequency of the word
+					in a document of the ilist */
+};
+
+typedef std::vector<fts_topk_block_t>	topk_block_vector_t;
+
+/** A term of a top-k query */
+struct fts_topk_term_t {
+	fts_word_freq_t*
+			word_freq;	/*!< Frequency of the term */
+	ulint		no;		/*!< Position of the term in the
+					query, without duplicates */
+	double		max_score;	/*!< Upper bound of the score that
+					the term adds to a document */
+	topk_block_vector_t
+			blocks;		/*!< Nodes of the term */
+};
+
+/** A document collected by a top-k query */
+struct fts_topk_doc_t {
+	doc_id_t	doc_id;		/*!< Document id */
+	double		score;		/*!< Score from the terms that have
+					been processed */
+	ulint*		freqs;		/*!< Frequency of each query term in
+					the document, allocated on the query
+					heap */
+};
+
+/** Argument of the top-k query FTS INDEX fetch callback */
+struct fts_topk_fetch_t {
+	fts_query_t*	query;		/*!< Query instance */
+	fts_topk_term_t*term;		/*!< Term being fetched */
+};
+
 /********************************************************************
 Callback function to fetch the rows in an FTS INDEX record.
 @return always TRUE */
@@ -1036,6 +1088,8 @@ fts_cache_find_wildcard(
 /*====================*/
 	fts_query_t*		query,		/*!< in: query instance */
 	const fts_index_cache_t*index_cache,	/*!< in: cache to search */
+	const ib_rbt_t*		words,		/*!< in: words or sync_words
+						of index_cache */
 	const fts_string_t*	token)		/*!< in: token to search */
 {
 	ib_rbt_bound_t		parent;
@@ -1053,7 +1107,7 @@ fts_cache_find_wildcard(
 	srch_text.f_str = term;
 
 	/* Lookup the word in the rb tree */
-	if (rbt_search_cmp(index_cache->words, &parent, &srch_text, NULL,
+	if (rbt_search_cmp(words, &parent, &srch_text, NULL,
 			   innobase_fts_text_cmp_prefix) == 0) {
 		const fts_tokenizer_word_t*     word;
 		ulint				i;
@@ -1100,12 +1154,10 @@ fts_cache_find_wildcard(
 			num_word++;
 
 			if (!forward) {
-				cur_node = rbt_prev(
-					index_cache->words, cur_node);
+				cur_node = rbt_prev(words, cur_node);
 			} else {
 cont_search:
-				cur_node = rbt_next(
-					index_cache->words, cur_node);
+				cur_node = rbt_next(words, cur_node);
 			}
 
 			if (!cur_node) {
@@ -1125,6 +1177,49 @@ fts_cache_find_wildcard(
 	return(num_word);
 }
 
+/*****************************************************************//**
+Look up a token in the index cache, i.e., in the words being added to
+it and in the words that a SYNC is writing to the INDEX table. */
+static
+void
+fts_cache_find_token(
+/*=================*/
+	fts_query_t*		query,		/*!< in: query instance */
+	const fts_index_cache_t*index_cache,	/*!< in: cache to search */
+	const fts_string_t*	token,		/*!< in: token to search */
+	bool			wildcard)	/*!< in: whether to do a
+						wildcard search */
+{
+	const ib_rbt_t*	words[2];
+
+	words[0] = index_cache->sync_words;
+	words[1] = index_cache->words;
+
+	for (ulint j = 0; j < 2 && query->error == DB_SUCCESS; ++j) {
+		const ib_vector_t*	nodes;
+
+		if (words[j] == NULL) {
+			continue;
+		} else if (wildcard) {
+			fts_cache_find_wildcard(
+				query, index_cache, words[j], token);
+			continue;
+		}
+
+		nodes = fts_cache_find_word(index_cache, words[j], token);
+
+		for (ulint i = 0; nodes && i < ib_vector_size(nodes)
+		     && query->error == DB_SUCCESS; ++i) {
+			const fts_node_t*	node;
+
+			node = static_cast<const fts_node_t*>(
+				ib_vector_get_const(nodes, i));
+
+			fts_query_check_node(query, token, node);
+		}
+	}
+}
+
 /*****************************************************************//**
 Set difference.
 @return DB_SUCCESS if all go well */
@@ -1152,9 +1247,7 @@ fts_query_difference(
 
 	/* There is nothing we can substract from an empty set. */
 	if (query->doc_ids && !rbt_empty(query->doc_ids)) {
-		ulint			i;
 		fts_fetch_t		fetch;
-		const ib_vector_t*	nodes;
 		const fts_index_cache_t*index_cache;
 		que_t*			graph = NULL;
 		fts_cache_t*		cache = table->fts->cache;
@@ -1168,23 +1261,11 @@ fts_query_difference(
 		ut_a(index_cache != NULL);
 
 		/* Search the cache for a matching word first. */
-		if (query->cur_node->term.wildcard
-		    && query->flags != FTS_PROXIMITY
-		    && query->flags != FTS_PHRASE) {
-			fts_cache_find_wildcard(query, index_cache, token);
-		} else {
-			nodes = fts_cache_find_word(index_cache, token);
-
-			for (i = 0; nodes && i < ib_vector_size(nodes)
-			     && query->error == DB_SUCCESS; ++i) {
-				const fts_node_t*	node;
-
-				node = static_cast<const fts_node_t*>(
-					ib_vector_get_const(nodes, i));
-
-				fts_query_check_node(query, token, node);
-			}
-		}
+		fts_cache_find_token(
+			query, index_cache, token,
+			query->cur_node->term.wildcard
+			&& query->flags != FTS_PROXIMITY
+			&& query->flags != FTS_PHRASE);
 
 		rw_lock_x_unlock(&cache->lock);
 
@@ -1241,9 +1322,7 @@ fts_query_intersect(
 	we know the intersection set is empty in advance. */
 	if (!(rbt_empty(query->doc_ids) && query->multi_exist)) {
 		ulint                   n_doc_ids = 0;
-		ulint			i;
 		fts_fetch_t		fetch;
-		const ib_vector_t*	nodes;
 		const fts_index_cache_t*index_cache;
 		que_t*			graph = NULL;
 		fts_cache_t*		cache = table->fts->cache;
@@ -1289,22 +1368,9 @@ fts_query_intersect(
 		/* Must find the index cache. */
 		ut_a(index_cache != NULL);
 
-		if (query->cur_node->term.wildcard) {
-			/* Wildcard search the index cache */
-			fts_cache_find_wildcard(query, index_cache, token);
-		} else {
-			nodes = fts_cache_find_word(index_cache, token);
-
-			for (i = 0; nodes && i < ib_vector_size(nodes)
-			     && query->error == DB_SUCCESS; ++i) {
-				const fts_node_t*	node;
-
-				node = static_cast<const fts_node_t*>(
-					ib_vector_get_const(nodes, i));
-
-				fts_query_check_node(query, token, node);
-			}
-		}
+		fts_cache_find_token(
+			query, index_cache, token,
+			query->cur_node->term.wildcard);
 
 		rw_lock_x_unlock(&cache->lock);
 
@@ -1368,27 +1434,11 @@ fts_query_cache(
 	/* Must find the index cache. */
 	ut_a(index_cache != NULL);
 
-	if (query->cur_node->term.wildcard
-	    && query->flags != FTS_PROXIMITY
-	    && query->flags != FTS_PHRASE) {
-		/* Wildcard search the index cache */
-		fts_cache_find_wildcard(query, index_cache, token);
-	} else {
-		const ib_vector_t*      nodes;
-		ulint			i;
-
-		nodes = fts_cache_find_word(index_cache, token);
-
-		for (i = 0; nodes && i < ib_vector_size(nodes)
-		     && query->error == DB_SUCCESS; ++i) {
-			const fts_node_t*	node;
-
-			node = static_cast<const fts_node_t*>(
-				ib_vector_get_const(nodes, i));
-
-			fts_query_check_node(query, token, node);
-		}
-	}
+	fts_cache_find_token(
+		query, index_cache, token,
+		query->cur_node->term.wildcard
+		&& query->flags != FTS_PROXIMITY
+		&& query->flags != FTS_PHRASE);
 
 	rw_lock_x_unlock(&cache->lock);
 
@@ -3460,6 +3510,602 @@ fts_retrieve_ranking(
 	DBUG_RETURN(0);
 }
 
+/*****************************************************************//**
+Compare two fts_topk_doc_t instances on their doc ids.
+@return < 0 if n1 < n2, 0 if n1 == n2, > 0 if n1 > n2 */
+static
+int
+fts_topk_doc_cmp(
+/*=============*/
+	const void*	p1,		/*!< in: doc 1 */
+	const void*	p2)		/*!< in: doc 2 */
+{
+	doc_id_t	id1 = static_cast<const fts_topk_doc_t*>(p1)->doc_id;
+	doc_id_t	id2 = static_cast<const fts_topk_doc_t*>(p2)->doc_id;
+
+	return(id1 < id2 ? -1 : (id1 > id2 ? 1 : 0));
+}
+
+/*****************************************************************//**
+Compare two top-k query terms on the score that they can add to a
+document, in descending order.
+@return true if t1 must be processed before t2 */
+static
+bool
+fts_topk_term_cmp(
+/*==============*/
+	const fts_topk_term_t*	t1,	/*!< in: term 1 */
+	const fts_topk_term_t*	t2)	/*!< in: term 2 */
+{
+	if (t1->max_score != t2->max_score) {
+		return(t1->max_score > t2->max_score);
+	}
+
+	return(t1->no < t2->no);
+}
+
+/*****************************************************************//**
+Scan an ilist without collecting anything, to find how many documents
+it has and the highest word frequency among them.
+@return highest word frequency */
+static
+ulint
+fts_query_topk_scan_ilist(
+/*======================*/
+	byte*		ilist,		/*!< in: doc id ilist */
+	ulint		len,		/*!< in: doc id ilist size */
+	ulint*		n_docs)		/*!< out: number of documents */
+{
+	byte*		ptr = ilist;
+	ulint		max_freq = 0;
+
+	*n_docs = 0;
+
+	while (ulint(ptr - ilist) < len) {
+		ulint	freq = 0;
+
+		/* Skip the doc id delta. */
+		fts_decode_vlc(&ptr);
+
+		while (*ptr) {
+			fts_decode_vlc(&ptr);
+			++freq;
+		}
+
+		/* Skip the end of word position marker. */
+		++ptr;
+
+		max_freq = ut_max(max_freq, freq);
+		++*n_docs;
+	}
+
+	return(max_freq);
+}
+
+/*****************************************************************//**
+Add a copy of an ilist to the nodes of a top-k query term.
+@return DB_SUCCESS or DB_FTS_EXCEED_RESULT_CACHE_LIMIT */
+static
+dberr_t
+fts_query_topk_add_block(
+/*=====================*/
+	fts_query_t*		query,		/*!< in/out: query instance */
+	fts_topk_term_t*	term,		/*!< in/out: term of the node */
+	doc_id_t		first_doc_id,	/*!< in: first doc id */
+	doc_id_t		last_doc_id,	/*!< in: last doc id */
+	const byte*		ilist,		/*!< in: doc id ilist */
+	ulint			len,		/*!< in: doc id ilist size */
+	ulint*			n_docs)		/*!< out: number of documents
+						in the ilist */
+{
+	fts_topk_block_t	block;
+
+	block.first_doc_id = first_doc_id;
+	block.last_doc_id = last_doc_id;
+	block.ilist = static_cast<byte*>(mem_heap_dup(query->heap, ilist, len));
+	block.ilist_size = len;
+	block.max_freq = fts_query_topk_scan_ilist(block.ilist, len, n_docs);
+
+	term->blocks.push_back(block);
+
+	query->total_size += sizeof(block) + len;
+
+	if (query->total_size > fts_result_cache_limit) {
+		return(DB_FTS_EXCEED_RESULT_CACHE_LIMIT);
+	}
+
+	return(DB_SUCCESS);
+}
+
+/*****************************************************************//**
+Callback function to fetch the rows of a top-k query term from the FTS
+INDEX.
+@return TRUE to continue, FALSE to stop on error */
+static
+ibool
+fts_query_topk_fetch_nodes(
+/*=======================*/
+	void*		row,		/*!< in: sel_node_t* */
+	void*		user_arg)	/*!< in: pointer to fts_fetch_t */
+{
+	sel_node_t*		sel_node = static_cast<sel_node_t*>(row);
+	fts_fetch_t*		fetch = static_cast<fts_fetch_t*>(user_arg);
+	fts_topk_fetch_t*	arg = static_cast<fts_topk_fetch_t*>(
+		fetch->read_arg);
+	fts_query_t*		query = arg->query;
+	fts_word_freq_t*	word_freq = arg->term->word_freq;
+	doc_id_t		first_doc_id = 0;
+	doc_id_t		last_doc_id = 0;
+	ulint			n_docs;
+	ulint			i = 0;
+
+	/* Note: The column numbers below must match the SELECT in
+	fts_index_fetch_nodes(). */
+	for (que_node_t* exp = sel_node->select_list;
+	     exp != NULL && query->error == DB_SUCCESS;
+	     exp = que_node_get_next(exp), ++i) {
+
+		dfield_t*	dfield = que_node_get_val(exp);
+		byte*		data = static_cast<byte*>(
+			dfield_get_data(dfield));
+		ulint		len = dfield_get_len(dfield);
+
+		ut_a(len != UNIV_SQL_NULL);
+
+		switch (i) {
+		case 0: /* WORD */
+			break;
+
+		case 1: /* DOC_COUNT */
+			word_freq->doc_count += mach_read_from_4(data);
+			break;
+
+		case 2: /* FIRST_DOC_ID */
+			first_doc_id = fts_read_doc_id(data);
+			break;
+
+		case 3: /* LAST_DOC_ID */
+			last_doc_id = fts_read_doc_id(data);
+			break;
+
+		case 4: /* ILIST */
+			query->error = fts_query_topk_add_block(
+				query, arg->term, first_doc_id, last_doc_id,
+				data, len, &n_docs);
+			break;
+
+		default:
+			ut_error;
+		}
+	}
+
+	return(query->error == DB_SUCCESS);
+}
+
+/*****************************************************************//**
+Read the nodes of a top-k query term from the FTS cache and from the FTS
+INDEX, and count the documents containing the term.
+@return DB_SUCCESS if all go well */
+static
+dberr_t
+fts_query_topk_read_term(
+/*=====================*/
+	fts_query_t*		query,	/*!< in/out: query instance */
+	fts_topk_term_t*	term)	/*!< in/out: term to read */
+{
+	const fts_index_cache_t*index_cache;
+	fts_cache_t*		cache = query->index->table->fts->cache;
+	const fts_string_t*	token = &term->word_freq->word;
+	fts_topk_fetch_t	arg;
+	fts_fetch_t		fetch;
+	que_t*			graph = NULL;
+	dberr_t			error;
+
+	/* Like fts_query_cache(), search the words being added to the
+	cache and the words that a SYNC is writing. */
+	rw_lock_x_lock(&cache->lock);
+
+	index_cache = fts_find_index_cache(cache, query->index);
+	ut_a(index_cache != NULL);
+
+	const ib_rbt_t*	words[2] = {
+		index_cache->sync_words, index_cache->words
+	};
+
+	for (ulint j = 0; j < 2 && query->error == DB_SUCCESS; ++j) {
+		const ib_vector_t*	nodes = NULL;
+
+		if (words[j] != NULL) {
+			nodes = fts_cache_find_word(
+				index_cache, words[j], token);
+		}
+
+		for (ulint i = 0; nodes && i < ib_vector_size(nodes)
+		     && query->error == DB_SUCCESS; ++i) {
+			const fts_node_t*	node;
+			ulint			n_docs;
+
+			node = static_cast<const fts_node_t*>(
+				ib_vector_get_const(nodes, i));
+
+			query->error = fts_query_topk_add_block(
+				query, term, node->first_doc_id,
+				node->last_doc_id, node->ilist,
+				node->ilist_size, &n_docs);
+
+			term->word_freq->doc_count += n_docs;
+		}
+	}
+
+	rw_lock_x_unlock(&cache->lock);
+
+	if (query->error != DB_SUCCESS) {
+		return(query->error);
+	}
+
+	arg.query = query;
+	arg.term = term;
+	fetch.read_arg = &arg;
+	fetch.read_record = fts_query_topk_fetch_nodes;
+
+	error = fts_index_fetch_nodes(
+		query->trx, &graph, &query->fts_index_table, token, &fetch);
+
+	/* DB_FTS_EXCEED_RESULT_CACHE_LIMIT passed by 'query->error' */
+	ut_ad(!(query->error != DB_SUCCESS && error != DB_SUCCESS));
+	if (error != DB_SUCCESS) {
+		query->error = error;
+	}
+
+	fts_que_graph_free(graph);
+
+	return(query->error);
+}
+
+/*****************************************************************//**
+Check whether a top-k query collected a document in a doc id range.
+@return true if some document between first_doc_id and last_doc_id
+has been collected */
+static
+bool
+fts_query_topk_has_doc(
+/*===================*/
+	const ib_rbt_t*	docs,		/*!< in: collected documents */
+	doc_id_t	first_doc_id,	/*!< in: first doc id */
+	doc_id_t	last_doc_id)	/*!< in: last doc id */
+{
+	const ib_rbt_node_t*	node;
+	fts_topk_doc_t		key;
+
+	key.doc_id = first_doc_id;
+
+	node = rbt_lower_bound(docs, &key);
+
+	return(node != NULL
+	       && rbt_value(fts_topk_doc_t, node)->doc_id <= last_doc_id);
+}
+
+/*****************************************************************//**
+Find the score that the query->limit best documents collected so far
+exceed.
+@return the threshold, or 0 if fewer documents have been collected */
+static
+double
+fts_query_topk_threshold(
+/*=====================*/
+	const fts_query_t*	query,	/*!< in: query instance */
+	const ib_rbt_t*		docs)	/*!< in: collected documents */
+{
+	std::vector<double>	scores;
+
+	if (rbt_size(docs) < query->limit) {
+		return(0);
+	}
+
+	scores.reserve(rbt_size(docs));
+
+	for (const ib_rbt_node_t* node = rbt_first(docs);
+	     node != NULL;
+	     node = rbt_next(docs, node)) {
+
+		scores.push_back(rbt_value(fts_topk_doc_t, node)->score);
+	}
+
+	std::nth_element(scores.begin(), scores.begin() + query->limit - 1,
+			 scores.end(), std::greater<double>());
+
+	return(scores[query->limit - 1]);
+}
+
+/*****************************************************************//**
+Collect the documents of the next top-k query term in processing order.
+A document that is not collected yet is left out if the score it can
+reach with this and the remaining terms is below the score of the
+query->limit best documents collected so far: it cannot rank among
+them. A node whose documents can all be left out is skipped without
+decoding its ilist.
+@return DB_SUCCESS or DB_FTS_EXCEED_RESULT_CACHE_LIMIT */
+static
+dberr_t
+fts_query_topk_collect(
+/*===================*/
+	fts_query_t*		query,		/*!< in/out: query instance */
+	const fts_topk_term_t*	term,		/*!< in: term to process */
+	ulint			n_terms,	/*!< in: number of terms */
+	double			remaining,	/*!< in: highest score that
+						the terms after this one
+						can add */
+	ib_rbt_t*		docs,		/*!< in/out: collected
+						documents */
+	double*			threshold,	/*!< in/out: score of the
+						query->limit best documents */
+	double*			bound)		/*!< in/out: highest score
+						that a left out document
+						can reach, or -1 */
+{
+	ulint		size = ib_vector_size(query->deleted->doc_ids);
+	fts_update_t*	array = (fts_update_t*) query->deleted->doc_ids->data;
+	double		weight = term->word_freq->idf * term->word_freq->idf;
+	/* Min-heap of the query->limit highest scores that this term adds
+	to a document. They bound the threshold from below too. */
+	std::vector<double>	heap;
+
+	for (topk_block_vector_t::const_iterator it = term->blocks.begin();
+	     it != term->blocks.end(); ++it) {
+
+		double	block_bound = (weight * it->max_freq + remaining)
+			* (1 + TOPK_SCORE_MARGIN);
+		double	cur = *threshold;
+		bool	prune;
+
+		if (heap.size() == query->limit) {
+			cur = ut_max(cur, heap.front());
+		}
+
+		prune = cur * (1 - TOPK_SCORE_MARGIN) > block_bound;
+
+		if (prune && !fts_query_topk_has_doc(
+			    docs, it->first_doc_id, it->last_doc_id)) {
+			*bound = ut_max(*bound, block_bound);
+			continue;
+		}
+
+		byte*		ptr = it->ilist;
+		doc_id_t	doc_id = 0;
+
+		while (ulint(ptr - it->ilist) < it->ilist_size) {
+			ib_rbt_bound_t	parent;
+			fts_topk_doc_t*	doc;
+			ulint		freq = 0;
+
+			doc_id += fts_decode_vlc(&ptr);
+
+			while (*ptr) {
+				fts_decode_vlc(&ptr);
+				++freq;
+			}
+
+			/* Skip the end of word position marker. */
+			++ptr;
+
+			if (fts_bsearch(array, 0, static_cast<int>(size),
+					doc_id) >= 0) {
+				continue;
+			}
+
+			if (rbt_search(docs, &parent, &doc_id) == 0) {
+				doc = rbt_value(fts_topk_doc_t, parent.last);
+
+				/* Avoid duplicating frequency tally. */
+				if (doc->freqs[term->no] != 0) {
+					continue;
+				}
+			} else if (prune) {
+				*bound = ut_max(*bound, block_bound);
+				continue;
+			} else {
+				fts_topk_doc_t	new_doc;
+
+				new_doc.doc_id = doc_id;
+				new_doc.score = 0;
+				new_doc.freqs = static_cast<ulint*>(
+					mem_heap_zalloc(
+						query->heap,
+						n_terms * sizeof(ulint)));
+
+				doc = rbt_value(
+					fts_topk_doc_t,
+					rbt_add_node(docs, &parent, &new_doc));
+
+				query->total_size += SIZEOF_RBT_NODE_ADD
+					+ sizeof(new_doc)
+					+ n_terms * sizeof(ulint);
+
+				if (query->total_size
+				    > fts_result_cache_limit) {
+					return(DB_FTS_EXCEED_RESULT_CACHE_LIMIT);
+				}
+			}
+
+			double	score = weight * freq;
+
+			doc->freqs[term->no] = freq;
+			doc->score += score;
+
+			if (heap.size() < query->limit) {
+				heap.push_back(score);
+				std::push_heap(heap.begin(), heap.end(),
+					       std::greater<double>());
+			} else if (score > heap.front()) {
+				std::pop_heap(heap.begin(), heap.end(),
+					      std::greater<double>());
+				heap.back() = score;
+				std::push_heap(heap.begin(), heap.end(),
+					       std::greater<double>());
+			}
+		}
+	}
+
+	*threshold = fts_query_topk_threshold(query, docs);
+
+	return(DB_SUCCESS);
+}
+
+/*****************************************************************//**
+Execute a natural language query of which the caller only reads the
+query->limit most relevant documents. The terms are processed in
+descending order of the score that they can add to a document, like
+in MaxScore, and the highest word frequency in each node bounds the
+score of the documents in it, so that the documents and nodes that
+cannot rank among the best ones are left out (see
+fts_query_topk_collect()). The rank of the documents that are
+returned is the same as fts_query_calculate_ranking() computes.
+@return result, NULL on error */
+static
+fts_result_t*
+fts_query_topk(
+/*===========*/
+	fts_query_t*	query)		/*!< in/out: query instance */
+{
+	std::vector<fts_topk_term_t>	terms;
+	std::vector<fts_topk_term_t*>	order;
+	fts_result_t*			result;
+	ib_rbt_t*			docs;
+	double				threshold = 0;
+	double				bound = -1;
+	double				remaining = 0;
+
+	DBUG_ENTER("fts_query_topk");
+
+	/* Collect the distinct terms in query order. */
+	for (fts_ast_node_t* node = query->root->list.head;
+	     node != NULL;
+	     node = node->next) {
+
+		fts_string_t		token;
+		fts_topk_term_t		term;
+		fts_word_freq_t*	word_freq;
+
+		token.f_str = node->term.ptr->str;
+		token.f_len = node->term.ptr->len;
+		token.f_n_char = 0;
+
+		word_freq = fts_query_add_word_freq(query, &token);
+
+		for (ulint i = 0; i < terms.size(); ++i) {
+			if (terms[i].word_freq == word_freq) {
+				word_freq = NULL;
+				break;
+			}
+		}
+
+		if (word_freq != NULL && token.f_len > 0) {
+			term.word_freq = word_freq;
+			term.no = terms.size();
+			term.max_score = 0;
+			terms.push_back(term);
+		}
+	}
+
+	for (ulint i = 0; i < terms.size(); ++i) {
+		if (fts_query_topk_read_term(query, &terms[i])
+		    != DB_SUCCESS) {
+			DBUG_RETURN(NULL);
+		}
+	}
+
+	fts_query_calculate_idf(query);
+
+	for (ulint i = 0; i < terms.size(); ++i) {
+		fts_topk_term_t*	term = &terms[i];
+		ulint			max_freq = 0;
+
+		for (ulint j = 0; j < term->blocks.size(); ++j) {
+			max_freq = ut_max(max_freq, term->blocks[j].max_freq);
+		}
+
+		term->max_score = term->word_freq->idf * term->word_freq->idf
+			* max_freq;
+
+		remaining += term->max_score;
+		order.push_back(term);
+	}
+
+	std::sort(order.begin(), order.end(), fts_topk_term_cmp);
+
+	docs = rbt_create(sizeof(fts_topk_doc_t), fts_topk_doc_cmp);
+	query->total_size += SIZEOF_RBT_CREATE;
+
+	for (ulint i = 0; i < order.size(); ++i) {
+		remaining -= order[i]->max_score;
+
+		/* Don't let rounding make the bound too low. */
+		if (i + 1 == order.size() || remaining < 0) {
+			remaining = 0;
+		}
+
+		query->error = fts_query_topk_collect(
+			query, order[i], terms.size(), remaining, docs,
+			&threshold, &bound);
+
+		if (query->error != DB_SUCCESS) {
+			rbt_free(docs);
+			DBUG_RETURN(NULL);
+		}
+	}
+
+	result = static_cast<fts_result_t*>(ut_malloc(sizeof(*result)));
+	memset(result, 0x0, sizeof(*result));
+
+	result->rankings_by_id = rbt_create(
+		sizeof(fts_ranking_t), fts_ranking_doc_id_cmp);
+	result->pruned = bound >= 0;
+
+	query->total_size += sizeof(fts_result_t) + SIZEOF_RBT_CREATE;
+
+	for (const ib_rbt_node_t* node = rbt_first(docs);
+	     node != NULL;
+	     node = rbt_next(docs, node)) {
+
+		const fts_topk_doc_t*	doc = rbt_value(fts_topk_doc_t, node);
+		fts_ranking_t		ranking;
+
+		ranking.doc_id = doc->doc_id;
+		ranking.rank = 0;
+		ranking.words = NULL;
+		ranking.words_len = 0;
+
+		/* Add up the terms in the same order as
+		fts_query_calculate_ranking(), so that the rank does not
+		depend on the limit. */
+		for (ulint i = 0; i < terms.size(); ++i) {
+			const fts_word_freq_t*	word_freq;
+			double			weight;
+
+			if (doc->freqs[i] == 0) {
+				continue;
+			}
+
+			word_freq = terms[i].word_freq;
+			weight = (double) doc->freqs[i] * word_freq->idf;
+
+			ranking.rank += (fts_rank_t) (weight * word_freq->idf);
+		}
+
+		/* Return only the documents that rank above every
+		document that was left out, so that the result is a
+		prefix of the full result in rank order. */
+		if (ranking.rank > bound) {
+			fts_query_add_ranking(
+				query, result->rankings_by_id, &ranking);
+		}
+	}
+
+	rbt_free(docs);
+
+	DBUG_RETURN(result);
+}
+
 /*****************************************************************//**
 Create the result and copy the data to it. */
 static
@@ -3733,6 +4379,43 @@ fts_query_can_optimize(
 	}
 }
 
+/*******************************************************************//**
+FTS Query optimization
+Set query->limit if the caller reads only the limit most relevant
+documents of a natural language query of several terms */
+static
+void
+fts_query_can_limit(
+/*================*/
+	fts_query_t*	query,		/*!< in/out: query instance */
+	uint		flags,		/*!< in: FTS search mode */
+	ulint		limit)		/*!< in: number of most relevant
+					documents that the caller reads,
+					or ULINT_UNDEFINED */
+{
+	fts_ast_node_t*	node = query->root;
+
+	query->limit = ULINT_UNDEFINED;
+
+	if (limit == ULINT_UNDEFINED || limit == 0
+	    || (flags & (FTS_BOOL | FTS_EXPAND))
+	    || query->flags == FTS_OPT_RANKING) {
+		return;
+	}
+
+	ut_ad(node->type == FTS_AST_LIST);
+
+	for (node = node->list.head; node != NULL; node = node->next) {
+		if (node->type != FTS_AST_TERM || node->term.wildcard) {
+			return;
+		}
+	}
+
+	if (query->root->list.head != NULL) {
+		query->limit = limit;
+	}
+}
+
 /*******************************************************************//**
 Pre-process the query string
 1) make it lower case
@@ -3830,6 +4513,9 @@ fts_query(
 	const byte*	query_str,	/*!< in: FTS query */
 	ulint		query_len,	/*!< in: FTS query string len
 					in bytes */
+	ulint		limit,		/*!< in: number of most relevant
+					documents that the caller reads,
+					or ULINT_UNDEFINED */
 	fts_result_t**	result)		/*!< in/out: result doc ids */
 {
 	fts_query_t	query;
@@ -3856,6 +4542,7 @@ fts_query(
 	query.boolean_mode = boolean_mode;
 	query.deleted = fts_doc_ids_create();
 	query.cur_node = NULL;
+	query.limit = ULINT_UNDEFINED;
 
 	query.fts_common_table.type = FTS_COMMON_TABLE;
 	query.fts_common_table.table_id = index->table->id;
@@ -3961,32 +4648,44 @@ fts_query(
 		/* Optimize query to check if it's a single term */
 		fts_query_can_optimize(&query, flags);
 
+		/* Check if only the most relevant documents are needed */
+		fts_query_can_limit(&query, flags, limit);
+
 		DBUG_EXECUTE_IF("fts_instrument_result_cache_limit",
 			        fts_result_cache_limit = 2048;
 		);
 
-		/* Traverse the Abstract Syntax Tree (AST) and execute
-		the query. */
-		query.error = fts_ast_visit(
-			FTS_NONE, ast, fts_query_visitor,
-			&query, &will_be_ignored);
-
-		/* If query expansion is requested, extend the search
-		with first search pass result */
-		if (query.error == DB_SUCCESS && (flags & FTS_EXPAND)) {
-			query.error = fts_expand_query(index, &query);
-		}
+		if (query.limit != ULINT_UNDEFINED) {
+			/* Collect the documents that can be among the
+			query.limit most relevant ones. */
+			*result = fts_query_topk(&query);
+		} else {
+			/* Traverse the Abstract Syntax Tree (AST) and
+			execute the query. */
+			query.error = fts_ast_visit(
+				FTS_NONE, ast, fts_query_visitor,
+				&query, &will_be_ignored);
+
+			/* If query expansion is requested, extend the
+			search with first search pass result */
+			if (query.error == DB_SUCCESS
+			    && (flags & FTS_EXPAND)) {
+				query.error = fts_expand_query(index, &query);
+			}
 
-		/* Calculate the inverse document frequency of the terms. */
-		if (query.error == DB_SUCCESS
-		    && query.flags != FTS_OPT_RANKING) {
-			fts_query_calculate_idf(&query);
-		}
+			/* Calculate the inverse document frequency of
+			the terms. */
+			if (query.error == DB_SUCCESS
+			    && query.flags != FTS_OPT_RANKING) {
+				fts_query_calculate_idf(&query);
+			}
 
-		/* Copy the result from the query state, so that we can
-		return it to the caller. */
-		if (query.error == DB_SUCCESS) {
-			*result = fts_query_get_result(&query, *result);
+			/* Copy the result from the query state, so that
+			we can return it to the caller. */
+			if (query.error == DB_SUCCESS) {
+				*result = fts_query_get_result(
+					&query, *result);
+			}
 		}
 
 		error = query.error;
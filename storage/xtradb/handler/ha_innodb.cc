@@ -58,6 +58,7 @@ this program; if not, write to the Free Software Foundation, Inc.,
 #include "univ.i"
 #include "buf0dump.h"
 #include "buf0lru.h"
+#include "buf0rea.h"
 #include "buf0flu.h"
 #include "buf0dblwr.h"
 #include "btr0sea.h"
@@ -87,6 +88,8 @@ this program; if not, write to the Free Software Foundation, Inc.,
 #include "fil0crypt.h"
 #include "trx0xa.h"
 #include "row0merge.h"
+#include "row0pread.h"
+#include "btr0bulk.h"
 #include "dict0boot.h"
 #include "dict0stats.h"
 #include "dict0stats_bg.h"
@@ -358,6 +361,21 @@ static TYPELIB innodb_empty_free_list_algorithm_typelib = {
 	NULL
 };
 
+/** Possible values for system variable "innodb_lru_algorithm".  */
+static const char* innodb_lru_algorithm_names[] = {
+	"MIDPOINT",
+	"ADAPTIVE",
+	NullS
+};
+
+/** Enumeration for innodb_lru_algorithm.  */
+static TYPELIB innodb_lru_algorithm_typelib = {
+	array_elements(innodb_lru_algorithm_names) - 1,
+	"innodb_lru_algorithm_typelib",
+	innodb_lru_algorithm_names,
+	NULL
+};
+
 /** Possible values of the parameter innodb_lock_schedule_algorithm */
 static const char* innodb_lock_schedule_algorithm_names[] = {
 	"fcfs",
@@ -486,6 +504,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&sync_thread_mutex_key, "sync_thread_mutex", 0},
 #  endif /* UNIV_SYNC_DEBUG */
 	{&buf_dblwr_mutex_key, "buf_dblwr_mutex", 0},
+	{&buf_dblwr_shard_mutex_key, "buf_dblwr_shard_mutex", 0},
 	{&trx_undo_mutex_key, "trx_undo_mutex", 0},
 	{&srv_sys_mutex_key, "srv_sys_mutex", 0},
 	{&lock_sys_mutex_key, "lock_mutex", 0},
@@ -949,6 +968,34 @@ innodb_encrypt_tables_validate(
 						for update function */
 	struct st_mysql_value*		value);	/*!< in: incoming string */
 
+/*************************************************************//**
+Check a new value of innodb_buffer_pool_size.
+@return	0 for a valid innodb_buffer_pool_size */
+static
+int
+innodb_buffer_pool_size_validate(
+/*=============================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				save,	/*!< out: immediate result
+						for update function */
+	struct st_mysql_value*		value);	/*!< in: incoming value */
+
+/*************************************************************//**
+Start resizing the buffer pool to a new innodb_buffer_pool_size. */
+static
+void
+innodb_buffer_pool_size_update(
+/*===========================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to
+						system variable */
+	void*				var_ptr,/*!< out: where the
+						formal string goes */
+	const void*			save);	/*!< in: immediate result
+						from check function */
+
 static const char innobase_hton_name[]= "InnoDB";
 
 static MYSQL_THDVAR_BOOL(support_xa, PLUGIN_VAR_OPCMDARG,
@@ -1008,6 +1055,7 @@ static ibool innodb_have_lz4=IF_LZ4(1, 0);
 static ibool innodb_have_lzma=IF_LZMA(1, 0);
 static ibool innodb_have_bzip2=IF_BZIP2(1, 0);
 static ibool innodb_have_snappy=IF_SNAPPY(1, 0);
+static ibool innodb_have_zstd=IF_ZSTD(1, 0);
 
 static SHOW_VAR innodb_status_variables[]= {
   {"available_undo_logs",
@@ -1022,6 +1070,8 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_buffer_pool_dump_status,	  SHOW_CHAR},
   {"buffer_pool_load_status",
   (char*) &export_vars.innodb_buffer_pool_load_status,	  SHOW_CHAR},
+  {"buffer_pool_resize_status",
+  (char*) &export_vars.innodb_buffer_pool_resize_status,  SHOW_CHAR},
   {"buffer_pool_pages_data",
   (char*) &export_vars.innodb_buffer_pool_pages_data,	  SHOW_LONG},
   {"buffer_pool_pages_dirty",
@@ -1054,6 +1104,8 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_buffer_pool_read_ahead_rnd, SHOW_LONG},
   {"buffer_pool_read_requests",
   (char*) &export_vars.innodb_buffer_pool_read_requests,  SHOW_LONG},
+  {"buffer_pool_read_requests_remote",
+  (char*) &export_vars.innodb_buffer_pool_read_requests_remote, SHOW_LONG},
   {"buffer_pool_reads",
   (char*) &export_vars.innodb_buffer_pool_reads,	  SHOW_LONG},
   {"buffer_pool_wait_free",
@@ -1160,6 +1212,8 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_page0_read,		  SHOW_LONG},
   {"pages_written",
   (char*) &export_vars.innodb_pages_written,		  SHOW_LONG},
+  {"purge_threads_active",
+  (char*) &export_vars.innodb_purge_threads_active,	  SHOW_LONG},
   {"purge_trx_id",
   (char*) &export_vars.innodb_purge_trx_id,		  SHOW_LONGLONG},
 #ifdef UNIV_DEBUG
@@ -1208,6 +1262,8 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_s_lock_spin_waits,	  SHOW_LONGLONG},
   {"truncated_status_writes",
   (char*) &export_vars.innodb_truncated_status_writes,	  SHOW_LONG},
+  {"undo_truncations",
+  (char*) &export_vars.innodb_undo_truncations,		  SHOW_LONG},
   {"x_lock_os_waits",
   (char*) &export_vars.innodb_x_lock_os_waits,		  SHOW_LONGLONG},
   {"x_lock_spin_rounds",
@@ -1260,6 +1316,8 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &innodb_have_bzip2,		  SHOW_BOOL},
   {"have_snappy",
   (char*) &innodb_have_snappy,		  SHOW_BOOL},
+  {"have_zstd",
+  (char*) &innodb_have_zstd,		  SHOW_BOOL},
 
   /* Defragment */
   {"defragment_compression_failures",
@@ -3210,7 +3268,7 @@ ha_innobase::ha_innobase(
 		  HA_CAN_GEOMETRY | HA_PARTIAL_COLUMN_READ |
 		  HA_TABLE_SCAN_ON_INDEX | HA_CAN_FULLTEXT |
 		  (srv_force_primary_key ? HA_REQUIRE_PRIMARY_KEY : 0 ) |
-		  HA_CAN_FULLTEXT_EXT | HA_CAN_EXPORT),
+		  HA_CAN_FULLTEXT_EXT | HA_CAN_EXPORT | HA_HAS_RECORDS),
 	start_of_scan(0),
 	num_write_row(0),
 	ha_partition_stats(NULL)
@@ -3983,6 +4041,15 @@ innobase_init(
 	}
 #endif
 
+#ifndef HAVE_ZSTD
+	if (innodb_compression_algorithm == PAGE_ZSTD_ALGORITHM) {
+		sql_print_error("InnoDB: innodb_compression_algorithm = %lu unsupported.\n"
+				"InnoDB: libzstd is not installed. \n",
+				innodb_compression_algorithm);
+		goto error;
+	}
+#endif
+
 	if ((srv_encrypt_tables || srv_encrypt_log)
 	     && !encryption_key_id_exists(FIL_DEFAULT_ENCRYPTION_KEY)) {
 		sql_print_error("InnoDB: cannot enable encryption, "
@@ -4477,6 +4544,9 @@ innobase_init(
 		goto mem_free_and_error;
 	}
 
+	/* The buffer pool size was rounded to whole chunks. */
+	innobase_buffer_pool_size = static_cast<long long>(srv_buf_pool_size);
+
 	/* Adjust the innodb_undo_logs config object */
 	innobase_undo_logs_init_default_max();
 
@@ -10730,6 +10800,23 @@ ha_innobase::ft_init_ext(
 	uint			flags,	/* in: */
 	uint			keynr,	/* in: */
 	String*			key)	/* in: */
+{
+	return(ft_init_ext_with_limit(flags, keynr, key, HA_POS_ERROR));
+}
+
+/**********************************************************************//**
+Initialize FT index scan of which only the limit most relevant rows
+are read
+@return FT_INFO structure if successful or NULL */
+UNIV_INTERN
+FT_INFO*
+ha_innobase::ft_init_ext_with_limit(
+/*================================*/
+	uint			flags,	/* in: */
+	uint			keynr,	/* in: */
+	String*			key,	/* in: */
+	ha_rows			limit)	/* in: number of rows read, or
+					HA_POS_ERROR */
 {
 	trx_t*			trx;
 	dict_table_t*		ft_table;
@@ -10815,7 +10902,10 @@ ha_innobase::ft_init_ext(
 		ft_table->fts->fts_status |= ADDED_TABLE_SYNCED;
 	}
 
-	error = fts_query(trx, index, flags, query, query_len, &result);
+	error = fts_query(trx, index, flags, query, query_len,
+			  limit == HA_POS_ERROR
+			  ? ULINT_UNDEFINED : ulint(limit),
+			  &result);
 
 	if (error != DB_SUCCESS) {
 		my_error(convert_error_code_to_mysql(error, 0, NULL),
@@ -10831,6 +10921,24 @@ ha_innobase::ft_init_ext(
 	fts_hdl->could_you = const_cast<_ft_vft_ext*>(&ft_vft_ext_result);
 	fts_hdl->ft_prebuilt = prebuilt;
 	fts_hdl->ft_result = result;
+	fts_hdl->ft_index = index;
+	fts_hdl->ft_flags = flags;
+	fts_hdl->ft_query = NULL;
+	fts_hdl->ft_query_len = 0;
+
+	if (result->pruned) {
+		/* Keep the query in case a row of the result is not
+		visible to the transaction, see ft_read(). */
+		fts_hdl->ft_query = static_cast<byte*>(
+			my_memdup(query, query_len, MYF(0)));
+		fts_hdl->ft_query_len = query_len;
+
+		if (fts_hdl->ft_query == NULL) {
+			innobase_fts_close_ranking((FT_INFO*) fts_hdl);
+			my_error(ER_OUTOFMEMORY, MYF(0), query_len);
+			return(NULL);
+		}
+	}
 
 	/* FIXME: Re-evluate the condition when Bug 14469540
 	is resolved */
@@ -10883,6 +10991,59 @@ innobase_fts_create_doc_id_key(
 	}
 }
 
+/**********************************************************************//**
+Run a full-text query whose result was pruned to its most relevant
+documents again without a limit, and position the new result on the
+document after the current one. The rows of the pruned result that have
+been read are the first ones of the new result, because the top-k
+query returns only documents that rank above all that it left out.
+@return DB_SUCCESS or error code */
+static
+dberr_t
+innobase_fts_query_again(
+/*=====================*/
+	NEW_FT_INFO*	fts_hdl)	/*!< in/out: FTS handler */
+{
+	fts_result_t*	old_result = fts_hdl->ft_result;
+	fts_result_t*	result;
+	fts_ranking_t	current;
+	dberr_t		error;
+
+	ut_ad(old_result->pruned);
+	ut_ad(old_result->current != NULL);
+
+	current = *rbt_value(fts_ranking_t, old_result->current);
+
+	error = fts_query(fts_hdl->ft_prebuilt->trx, fts_hdl->ft_index,
+			  fts_hdl->ft_flags, fts_hdl->ft_query,
+			  fts_hdl->ft_query_len, ULINT_UNDEFINED, &result);
+
+	if (error != DB_SUCCESS) {
+		return(error);
+	}
+
+	if (result->rankings_by_id != NULL) {
+		const ib_rbt_node_t*	node;
+
+		fts_query_sort_result_on_rank(result);
+
+		node = rbt_lower_bound(result->rankings_by_rank, &current);
+
+		if (node != NULL
+		    && rbt_value(fts_ranking_t, node)->doc_id
+		    == current.doc_id) {
+			node = rbt_next(result->rankings_by_rank, node);
+		}
+
+		result->current = const_cast<ib_rbt_node_t*>(node);
+	}
+
+	fts_query_free_result(old_result);
+	fts_hdl->ft_result = result;
+
+	return(DB_SUCCESS);
+}
+
 /**********************************************************************//**
 Fetch next result from the FT result set
 @return error code */
@@ -10968,9 +11129,27 @@ ha_innobase::ft_read(
 			table->status = 0;
 			break;
 		case DB_RECORD_NOT_FOUND:
-			result->current = const_cast<ib_rbt_node_t*>(
-				rbt_next(result->rankings_by_rank,
-					 result->current));
+			if (result->pruned) {
+				/* The documents that were left out of
+				the result may be needed in place of the
+				row that is not visible. */
+				ret = innobase_fts_query_again(
+					(NEW_FT_INFO*) ft_handler);
+
+				if (ret != DB_SUCCESS) {
+					error = convert_error_code_to_mysql(
+						ret, 0, user_thd);
+					table->status = STATUS_NOT_FOUND;
+					break;
+				}
+
+				result = ((NEW_FT_INFO*) ft_handler)
+					->ft_result;
+			} else {
+				result->current = const_cast<ib_rbt_node_t*>(
+					rbt_next(result->rankings_by_rank,
+						 result->current));
+			}
 
 			if (!result->current) {
 				/* exhaust the result set, should return
@@ -14055,6 +14234,76 @@ ha_innobase::estimate_rows_upper_bound()
 	DBUG_RETURN((ha_rows) estimate);
 }
 
+/*********************************************************************//**
+Returns the exact number of rows in the table for SELECT COUNT(*),
+counted by a parallel scan of the clustered index in the read view of
+the transaction.
+@return	number of rows, or HA_POS_ERROR if the rows must be counted by
+a table scan instead */
+UNIV_INTERN
+ha_rows
+ha_innobase::records()
+/*==================*/
+{
+	dict_index_t*	index;
+	ulint		n_rows;
+	dberr_t		err;
+
+	DBUG_ENTER("ha_innobase::records");
+
+	if (srv_parallel_read_threads == 0
+	    || prebuilt->select_lock_type != LOCK_NONE) {
+		/* The parallel read is disabled, or this is a locking
+		read that must lock the records it counts. */
+		DBUG_RETURN(HA_POS_ERROR);
+	}
+
+	update_thd(ha_thd());
+
+	/* A dirty read cannot be done by the parallel read. Let the
+	table scan report a missing or unreadable tablespace. */
+	if (prebuilt->trx->isolation_level == TRX_ISO_READ_UNCOMMITTED
+	    || dict_table_is_discarded(prebuilt->table)
+	    || prebuilt->table->ibd_file_missing
+	    || prebuilt->table->is_encrypted) {
+		DBUG_RETURN(HA_POS_ERROR);
+	}
+
+	index = dict_table_get_first_index(prebuilt->table);
+
+	if (dict_index_is_corrupted(index)) {
+		DBUG_RETURN(HA_POS_ERROR);
+	}
+
+	prebuilt->trx->op_info = "counting rows";
+
+	/* In case MySQL calls this in the middle of a SELECT query, release
+	possible adaptive hash latch to avoid deadlocks of threads */
+
+	trx_search_latch_release_if_reserved(prebuilt->trx);
+
+	innobase_srv_conc_enter_innodb(prebuilt->trx);
+
+	trx_start_if_not_started(prebuilt->trx);
+	trx_assign_read_view(prebuilt->trx);
+
+	err = row_pread_count(prebuilt->trx, index,
+			      srv_parallel_read_threads, false,
+			      &n_rows, NULL);
+
+	innobase_srv_conc_exit_innodb(prebuilt->trx);
+
+	prebuilt->trx->op_info = "";
+
+	if (err != DB_SUCCESS) {
+		/* On DB_INTERRUPTED, the table scan will notice
+		the kill, too. */
+		DBUG_RETURN(HA_POS_ERROR);
+	}
+
+	DBUG_RETURN((ha_rows) n_rows);
+}
+
 /*********************************************************************//**
 How many seeks it will take to read through the table. This is to be
 comparable to the number returned by records_in_range so that we can
@@ -14810,7 +15059,7 @@ ha_innobase::optimize(
 	if (innodb_optimize_fulltext_only) {
 		if (prebuilt->table->fts && prebuilt->table->fts->cache
 		    && !dict_table_is_discarded(prebuilt->table)) {
-			fts_sync_table(prebuilt->table, false, true, false);
+			fts_sync_table(prebuilt->table, true, false);
 			fts_optimize_table(prebuilt->table);
 		}
 		return(HA_ADMIN_OK);
@@ -15027,8 +15276,34 @@ ha_innobase::check(
 
 		prebuilt->select_lock_type = LOCK_NONE;
 
-		bool check_result
-			= row_check_index_for_mysql(prebuilt, index, &n_rows);
+		bool check_result;
+
+		if (dict_index_is_clust(index)
+		    && srv_parallel_read_threads > 0) {
+			/* Count and check the clustered index with
+			a parallel scan. */
+			trx_start_if_not_started(prebuilt->trx);
+			trx_assign_read_view(prebuilt->trx);
+
+			dberr_t	err = row_pread_count(
+				prebuilt->trx, index,
+				srv_parallel_read_threads, true,
+				&n_rows, &check_result);
+
+			if (err != DB_SUCCESS && err != DB_INTERRUPTED) {
+				/* This error is ignored by CHECK TABLE,
+				like in row_check_index_for_mysql(). */
+				ib_logf(IB_LOG_LEVEL_WARN,
+					"CHECK TABLE on index %s of table %s"
+					" returned %s",
+					index->name, index->table_name,
+					ut_strerr(err));
+			}
+		} else {
+			check_result = row_check_index_for_mysql(
+				prebuilt, index, &n_rows);
+		}
+
 		DBUG_EXECUTE_IF(
 				"dict_set_index_corrupted",
 				if (!(index->type & DICT_CLUSTERED)) {
@@ -19540,6 +19815,7 @@ innobase_fts_close_ranking(
 
 	fts_query_free_result(result);
 
+	my_free(((NEW_FT_INFO*) fts_hdl)->ft_query);
 	my_free((uchar*) fts_hdl);
 
 	return;
@@ -19867,6 +20143,28 @@ buffer_pool_load_abort(
 	}
 }
 
+/****************************************************************//**
+Update innodb_buffer_pool_dump_interval and wake up the buffer pool
+dump/load thread, so that it waits for the new interval.
+This function is registered as a callback with MySQL. */
+static
+void
+buffer_pool_dump_interval_update(
+/*=============================*/
+	THD*				thd	/*!< in: thread handle */
+					__attribute__((unused)),
+	struct st_mysql_sys_var*	var	/*!< in: pointer to system
+						variable */
+					__attribute__((unused)),
+	void*				var_ptr,/*!< out: where the formal
+						string goes */
+	const void*			save)	/*!< in: immediate result from
+						check function */
+{
+	*static_cast<ulong*>(var_ptr) = *static_cast<const ulong*>(save);
+	os_event_set(srv_buf_dump_event);
+}
+
 /** Update innodb_status_output or innodb_status_output_locks,
 which control InnoDB "status monitor" output to the error log.
 @param[in]	thd	thread handle
@@ -20419,6 +20717,21 @@ static MYSQL_SYSVAR_BOOL(doublewrite, innobase_use_doublewrite,
   "Disable with --skip-innodb-doublewrite.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_STR(parallel_doublewrite_path,
+  srv_parallel_doublewrite_path,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Path of the parallel doublewrite file used by LRU and flush list "
+  "batches, relative to the data directory unless absolute. If empty, "
+  "the doublewrite buffer in the system tablespace is used.",
+  NULL, NULL, NULL);
+
+static MYSQL_SYSVAR_ULONG(parallel_doublewrite_batch_size,
+  srv_parallel_doublewrite_batch_size,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of pages in each buffer pool instance and flush type shard of "
+  "the parallel doublewrite file.",
+  NULL, NULL, 120, 1, 1024, 0);
+
 static MYSQL_SYSVAR_BOOL(use_atomic_writes, innobase_use_atomic_writes,
   PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
   "Prevent partial page writes, via atomic writes (beta). "
@@ -20719,6 +21032,25 @@ static MYSQL_SYSVAR_BOOL(stats_traditional, srv_stats_sample_traditional,
   "Enable traditional statistic calculation based on number of configured pages (default true)",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_ULONG(stats_recalc_threads, srv_stats_recalc_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads that recalculate in parallel the persistent "
+  "statistics of the tables changed by more than 10% (default 1)",
+  NULL, NULL, 1, 1, 32, 0);
+
+static MYSQL_SYSVAR_ULONG(stats_recalc_io_budget, srv_stats_recalc_io_budget,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum number of index pages per second that the automatic "
+  "recalculation of persistent statistics may read (default 0 = no limit)",
+  NULL, NULL, 0, 0, ULONG_MAX, 0);
+
+static MYSQL_SYSVAR_BOOL(stats_recalc_incremental, srv_stats_recalc_incremental,
+  PLUGIN_VAR_OPCMDARG,
+  "Let the automatic recalculation of persistent statistics keep the "
+  "statistics of the secondary indexes that changed little since they were "
+  "last analyzed (default true)",
+  NULL, NULL, TRUE);
+
 static MYSQL_SYSVAR_BOOL(adaptive_hash_index, btr_search_enabled,
   PLUGIN_VAR_OPCMDARG,
   "Enable InnoDB adaptive hash index (enabled by default).  "
@@ -20762,9 +21094,16 @@ static MYSQL_SYSVAR_ULONG(autoextend_increment, srv_auto_extend_increment,
   NULL, NULL, 64L, 1L, 1000L, 0);
 
 static MYSQL_SYSVAR_LONGLONG(buffer_pool_size, innobase_buffer_pool_size,
-  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  PLUGIN_VAR_RQCMDARG,
   "The size of the memory buffer InnoDB uses to cache data and indexes of its tables.",
-  NULL, NULL, 128*1024*1024L, 5*1024*1024L, LONGLONG_MAX, 1024*1024L);
+  innodb_buffer_pool_size_validate, innodb_buffer_pool_size_update,
+  128*1024*1024L, 5*1024*1024L, LONGLONG_MAX, 1024*1024L);
+
+static MYSQL_SYSVAR_ULONG(buffer_pool_chunk_size, srv_buf_pool_chunk_unit,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Size of a single memory chunk within each buffer pool instance."
+  " The buffer pool is resized online in units of this size.",
+  NULL, NULL, 128*1024*1024L, 1024*1024L, LONG_MAX, 1024*1024L);
 
 static MYSQL_SYSVAR_BOOL(buffer_pool_populate, innodb_buffer_pool_populate,
   PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
@@ -20934,6 +21273,13 @@ static MYSQL_SYSVAR_ULONG(buffer_pool_dump_pct, srv_buf_pool_dump_pct,
   "Dump only the hottest N% of each buffer pool, defaults to 100",
   NULL, NULL, 100, 1, 100, 0);
 
+static MYSQL_SYSVAR_ULONG(buffer_pool_dump_interval, srv_buf_dump_interval,
+  PLUGIN_VAR_RQCMDARG,
+  "Dump the buffer pool into a file named @@innodb_buffer_pool_filename"
+  " every N seconds, if it has changed noticeably since the previous dump."
+  " 0 (the default) disables periodic dumps.",
+  NULL, buffer_pool_dump_interval_update, 0, 0, 7 * 24 * 3600, 0);
+
 #ifdef UNIV_DEBUG
 static MYSQL_SYSVAR_STR(buffer_pool_evict, srv_buffer_pool_evict,
   PLUGIN_VAR_RQCMDARG,
@@ -20957,6 +21303,11 @@ static MYSQL_SYSVAR_BOOL(buffer_pool_load_at_startup, srv_buffer_pool_load_at_st
   "Load the buffer pool from a file named @@innodb_buffer_pool_filename",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_ULONG(buffer_pool_load_threads, srv_buf_load_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads that read pages during a buffer pool load",
+  NULL, NULL, 4, 1, 64, 0);
+
 static MYSQL_SYSVAR_BOOL(defragment, srv_defragment,
   PLUGIN_VAR_RQCMDARG,
   "Enable/disable InnoDB defragmentation (default FALSE). When set to FALSE, all existing "
@@ -21094,6 +21445,11 @@ static MYSQL_SYSVAR_ULONG(ft_num_word_optimize, fts_num_word_optimize,
   "InnoDB Fulltext search number of words to optimize for each optimize table call ",
   NULL, NULL, 2000, 1000, 10000, 0);
 
+static MYSQL_SYSVAR_ULONG(ft_optimize_threads, fts_optimize_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "InnoDB Fulltext search number of threads that optimize the words of an index in parallel for each optimize table call",
+  NULL, NULL, 2, 1, 16, 0);
+
 static MYSQL_SYSVAR_ULONG(ft_sort_pll_degree, fts_sort_pll_degree,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "InnoDB Fulltext search parallel sort degree, will round up to nearest power of 2 number",
@@ -21104,6 +21460,13 @@ static MYSQL_SYSVAR_ULONG(sort_buffer_size, srv_sort_buf_size,
   "Memory buffer size for index creation",
   NULL, NULL, 1048576, 65536, 64<<20, 0);
 
+static MYSQL_SYSVAR_ULONG(fill_factor, srv_fill_factor,
+  PLUGIN_VAR_RQCMDARG,
+  "Percentage of each B-tree page to fill when the sorted records of a "
+  "new secondary index are loaded into it. The remaining space is left "
+  "for future inserts.",
+  NULL, NULL, 100, BTR_BULK_MIN_FILL_FACTOR, 100, 0);
+
 static MYSQL_SYSVAR_ULONGLONG(online_alter_log_max_size, srv_online_max_size,
   PLUGIN_VAR_RQCMDARG,
   "Maximum modification log file size for online index creation",
@@ -21176,6 +21539,18 @@ static MYSQL_SYSVAR_UINT(old_blocks_time, buf_LRU_old_threshold_ms,
   " The timeout is disabled if 0.",
   NULL, NULL, 1000, 0, UINT_MAX32, 0);
 
+static MYSQL_SYSVAR_ENUM(lru_algorithm, srv_lru_algorithm,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "The buffer pool replacement policy.  Allowed values: "
+  "MIDPOINT: (default) blocks that are accessed are moved to the start of"
+  " the LRU list, as tuned by innodb_old_blocks_pct and"
+  " innodb_old_blocks_time; "
+  "ADAPTIVE: accesses only mark the block, the LRU scans give marked"
+  " blocks a second chance, and the share of old blocks adapts to the"
+  " evicted pages that are read back in.",
+  NULL, NULL, SRV_LRU_ALGORITHM_MIDPOINT,
+  &innodb_lru_algorithm_typelib);
+
 static MYSQL_SYSVAR_LONG(open_files, innobase_open_files,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "How many files at the maximum InnoDB keeps open at the same time.",
@@ -21248,6 +21623,32 @@ static MYSQL_SYSVAR_ULONG(undo_logs, srv_undo_logs,
   1,			/* Minimum value */
   TRX_SYS_N_RSEGS, 0);	/* Maximum value */
 
+static MYSQL_SYSVAR_BOOL(undo_log_truncate, srv_undo_log_truncate,
+  PLUGIN_VAR_OPCMDARG,
+  "Truncate an undo tablespace that has grown beyond"
+  " innodb_max_undo_log_size once purge has processed all of its"
+  " undo logs. Requires at least 2 undo tablespaces.",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_ULONGLONG(max_undo_log_size, srv_max_undo_log_size,
+  PLUGIN_VAR_OPCMDARG,
+  "Size of an undo tablespace in bytes above which it is truncated"
+  " when innodb_undo_log_truncate is enabled.",
+  NULL, NULL,
+  1024 * 1024 * 1024ULL,	/* Default setting */
+  10 * 1024 * 1024ULL,		/* Minimum value */
+  ~0ULL, 0);			/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(purge_rseg_truncate_frequency,
+  srv_purge_rseg_truncate_frequency,
+  PLUGIN_VAR_OPCMDARG,
+  "Number of purge batches after which the history list is truncated"
+  " and the undo tablespaces are checked for truncation.",
+  NULL, NULL,
+  128,			/* Default setting */
+  1,			/* Minimum value */
+  128, 0);		/* Maximum value */
+
 /* Alias for innodb_undo_logs, this config variable is deprecated. */
 static MYSQL_SYSVAR_ULONG(rollback_segments, srv_undo_logs,
   PLUGIN_VAR_OPCMDARG,
@@ -21290,6 +21691,12 @@ static MYSQL_SYSVAR_BOOL(numa_interleave, srv_numa_interleave,
   PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
   "Use NUMA interleave memory policy to allocate InnoDB buffer pool.",
   NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_BOOL(numa_bind, srv_numa_bind,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Place the InnoDB buffer pool instances on the NUMA nodes round-robin"
+  " and flush each instance from its own node.",
+  NULL, NULL, FALSE);
 #endif // HAVE_LIBNUMA
 
 static MYSQL_SYSVAR_BOOL(api_enable_binlog, ib_binlog_enabled,
@@ -21437,6 +21844,21 @@ static MYSQL_SYSVAR_ULONG(read_ahead_threshold, srv_read_ahead_threshold,
   "trigger a readahead.",
   NULL, NULL, 56, 0, 64, 0);
 
+static MYSQL_SYSVAR_ULONG(scan_read_ahead_pages, srv_scan_read_ahead_pages,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum number of leaf pages that a forward index range scan reads "
+  "ahead asynchronously, as listed in the parent page of the leaf page "
+  "being scanned. 0 (the default) disables the scan read-ahead.",
+  NULL, NULL, 0, 0, BUF_READ_AHEAD_SCAN_MAX, 0);
+
+static MYSQL_SYSVAR_ULONG(parallel_read_threads, srv_parallel_read_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads that scan the clustered index in parallel for "
+  "SELECT COUNT(*), CHECK TABLE and online ADD INDEX, and that sort "
+  "the new indexes of ADD INDEX in parallel. 0 (the default) disables "
+  "the parallel scan.",
+  NULL, NULL, 0, 0, ROW_PREAD_MAX_THREADS, 0);
+
 static MYSQL_SYSVAR_STR(monitor_enable, innobase_enable_monitor_counter,
   PLUGIN_VAR_RQCMDARG,
   "Turn on a monitor counter",
@@ -21598,7 +22020,7 @@ static MYSQL_SYSVAR_BOOL(use_trim, srv_use_trim,
   "Use trim. Default FALSE.",
   NULL, NULL, FALSE);
 
-static const char *page_compression_algorithms[]= { "none", "zlib", "lz4", "lzo", "lzma", "bzip2", "snappy", 0 };
+static const char *page_compression_algorithms[]= { "none", "zlib", "lz4", "lzo", "lzma", "bzip2", "snappy", "zstd", 0 };
 static TYPELIB page_compression_algorithms_typelib=
 {
   array_elements(page_compression_algorithms) - 1, 0,
@@ -21606,7 +22028,7 @@ static TYPELIB page_compression_algorithms_typelib=
 };
 static MYSQL_SYSVAR_ENUM(compression_algorithm, innodb_compression_algorithm,
   PLUGIN_VAR_OPCMDARG,
-  "Compression algorithm used on page compression. One of: none, zlib, lz4, lzo, lzma, or bzip2",
+  "Compression algorithm used on page compression. One of: none, zlib, lz4, lzo, lzma, bzip2, snappy, or zstd",
   innodb_compression_algorithm_validate, NULL,
   /* We use here the largest number of supported compression method to
   enable all those methods that are available. Availability of compression
@@ -21756,18 +22178,21 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(api_bk_commit_interval),
   MYSQL_SYSVAR(autoextend_increment),
   MYSQL_SYSVAR(buffer_pool_size),
+  MYSQL_SYSVAR(buffer_pool_chunk_size),
   MYSQL_SYSVAR(buffer_pool_populate),
   MYSQL_SYSVAR(buffer_pool_instances),
   MYSQL_SYSVAR(buffer_pool_filename),
   MYSQL_SYSVAR(buffer_pool_dump_now),
   MYSQL_SYSVAR(buffer_pool_dump_at_shutdown),
   MYSQL_SYSVAR(buffer_pool_dump_pct),
+  MYSQL_SYSVAR(buffer_pool_dump_interval),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(buffer_pool_evict),
 #endif /* UNIV_DEBUG */
   MYSQL_SYSVAR(buffer_pool_load_now),
   MYSQL_SYSVAR(buffer_pool_load_abort),
   MYSQL_SYSVAR(buffer_pool_load_at_startup),
+  MYSQL_SYSVAR(buffer_pool_load_threads),
   MYSQL_SYSVAR(defragment),
   MYSQL_SYSVAR(defragment_n_pages),
   MYSQL_SYSVAR(defragment_stats_accuracy),
@@ -21786,6 +22211,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(data_file_path),
   MYSQL_SYSVAR(data_home_dir),
   MYSQL_SYSVAR(doublewrite),
+  MYSQL_SYSVAR(parallel_doublewrite_path),
+  MYSQL_SYSVAR(parallel_doublewrite_batch_size),
   MYSQL_SYSVAR(api_enable_binlog),
   MYSQL_SYSVAR(api_enable_mdl),
   MYSQL_SYSVAR(api_disable_rowlock),
@@ -21814,6 +22241,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(ft_max_token_size),
   MYSQL_SYSVAR(ft_min_token_size),
   MYSQL_SYSVAR(ft_num_word_optimize),
+  MYSQL_SYSVAR(ft_optimize_threads),
   MYSQL_SYSVAR(ft_sort_pll_degree),
   MYSQL_SYSVAR(large_prefix),
   MYSQL_SYSVAR(force_load_corrupted),
@@ -21840,6 +22268,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(max_purge_lag_delay),
   MYSQL_SYSVAR(mirrored_log_groups),
   MYSQL_SYSVAR(old_blocks_pct),
+  MYSQL_SYSVAR(lru_algorithm),
   MYSQL_SYSVAR(old_blocks_time),
   MYSQL_SYSVAR(open_files),
   MYSQL_SYSVAR(optimize_fulltext_only),
@@ -21857,6 +22286,9 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(stats_auto_recalc),
   MYSQL_SYSVAR(stats_modified_counter),
   MYSQL_SYSVAR(stats_traditional),
+  MYSQL_SYSVAR(stats_recalc_threads),
+  MYSQL_SYSVAR(stats_recalc_io_budget),
+  MYSQL_SYSVAR(stats_recalc_incremental),
   MYSQL_SYSVAR(adaptive_hash_index),
   MYSQL_SYSVAR(adaptive_hash_index_partitions),
   MYSQL_SYSVAR(stats_method),
@@ -21865,6 +22297,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(strict_mode),
   MYSQL_SYSVAR(support_xa),
   MYSQL_SYSVAR(sort_buffer_size),
+  MYSQL_SYSVAR(fill_factor),
   MYSQL_SYSVAR(online_alter_log_max_size),
   MYSQL_SYSVAR(sync_spin_loops),
   MYSQL_SYSVAR(spin_wait_delay),
@@ -21883,6 +22316,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(use_native_aio),
 #ifdef HAVE_LIBNUMA
   MYSQL_SYSVAR(numa_interleave),
+  MYSQL_SYSVAR(numa_bind),
 #endif // HAVE_LIBNUMA
   MYSQL_SYSVAR(change_buffering),
   MYSQL_SYSVAR(change_buffer_max_size),
@@ -21898,6 +22332,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
 #endif /* WITH_INNODB_DISALLOW_WRITES */
   MYSQL_SYSVAR(random_read_ahead),
   MYSQL_SYSVAR(read_ahead_threshold),
+  MYSQL_SYSVAR(scan_read_ahead_pages),
+  MYSQL_SYSVAR(parallel_read_threads),
   MYSQL_SYSVAR(read_only),
   MYSQL_SYSVAR(io_capacity),
   MYSQL_SYSVAR(io_capacity_max),
@@ -21948,6 +22384,9 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(rollback_segments),
   MYSQL_SYSVAR(undo_directory),
   MYSQL_SYSVAR(undo_tablespaces),
+  MYSQL_SYSVAR(undo_log_truncate),
+  MYSQL_SYSVAR(max_undo_log_size),
+  MYSQL_SYSVAR(purge_rseg_truncate_frequency),
   MYSQL_SYSVAR(sync_array_size),
   MYSQL_SYSVAR(compression_failure_threshold_pct),
   MYSQL_SYSVAR(compression_pad_pct_max),
@@ -22623,6 +23062,17 @@ innodb_compression_algorithm_validate(
 		DBUG_RETURN(1);
 	}
 #endif
+
+#ifndef HAVE_ZSTD
+	if (compression_algorithm == PAGE_ZSTD_ALGORITHM) {
+		push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
+				    HA_ERR_UNSUPPORTED,
+				    "InnoDB: innodb_compression_algorithm = %lu unsupported.\n"
+				    "InnoDB: libzstd is not installed. \n",
+				    compression_algorithm);
+		DBUG_RETURN(1);
+	}
+#endif
 	DBUG_RETURN(0);
 }
 
@@ -22812,3 +23262,97 @@ ib_push_frm_error(
 		break;
 	}
 }
+
+/*************************************************************//**
+Check a new value of innodb_buffer_pool_size.  The value is rounded up
+to a multiple of innodb_buffer_pool_chunk_size *
+innodb_buffer_pool_instances.
+@return	0 for a valid innodb_buffer_pool_size */
+static
+int
+innodb_buffer_pool_size_validate(
+/*=============================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				save,	/*!< out: immediate result
+						for update function */
+	struct st_mysql_value*		value)	/*!< in: incoming value */
+{
+	long long	intbuf;
+
+	DBUG_ENTER("innodb_buffer_pool_size_validate");
+
+	value->val_int(value, &intbuf);
+
+	if (srv_read_only_mode) {
+		push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
+				    ER_WRONG_ARGUMENTS,
+				    "InnoDB: Cannot resize the buffer pool"
+				    " in read-only mode.");
+		DBUG_RETURN(1);
+	}
+
+	if (buf_pool_is_resizing()) {
+		push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
+				    ER_WRONG_ARGUMENTS,
+				    "InnoDB: Another buffer pool resize is"
+				    " already in progress.");
+		DBUG_RETURN(1);
+	}
+
+	if (intbuf < MYSQL_SYSVAR_NAME(buffer_pool_size).min_val
+	    || (sizeof(ulint) == 4 && intbuf > (long long) UINT_MAX32)) {
+		push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
+				    ER_WRONG_ARGUMENTS,
+				    "InnoDB: innodb_buffer_pool_size must be"
+				    " between %lld and %lld.",
+				    MYSQL_SYSVAR_NAME(buffer_pool_size).min_val,
+				    sizeof(ulint) == 4
+				    ? (long long) UINT_MAX32
+				    : MYSQL_SYSVAR_NAME(buffer_pool_size).max_val);
+		DBUG_RETURN(1);
+	}
+
+	*static_cast<long long*>(save) = static_cast<long long>(
+		buf_pool_size_align(static_cast<ulint>(intbuf)));
+
+	DBUG_RETURN(0);
+}
+
+/*************************************************************//**
+Start resizing the buffer pool to a new innodb_buffer_pool_size.  The
+resize itself is done by buf_resize_thread, whose progress is shown by
+the Innodb_buffer_pool_resize_status status variable. */
+static
+void
+innodb_buffer_pool_size_update(
+/*===========================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to
+						system variable */
+	void*				var_ptr,/*!< out: where the
+						formal string goes */
+	const void*			save)	/*!< in: immediate result
+						from check function */
+{
+	long long	in_val = *static_cast<const long long*>(save);
+
+	*static_cast<long long*>(var_ptr) = in_val;
+
+	if (static_cast<ulint>(in_val) == srv_buf_pool_size) {
+		return;
+	}
+
+	srv_buf_pool_size = static_cast<ulint>(in_val);
+
+	ut_snprintf(export_vars.innodb_buffer_pool_resize_status,
+		    sizeof(export_vars.innodb_buffer_pool_resize_status),
+		    "Requested to resize buffer pool.");
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Requested to resize buffer pool. (new size: %lld bytes)",
+		in_val);
+
+	os_event_set(srv_buf_resize_event);
+}
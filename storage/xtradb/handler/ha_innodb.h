@@ -175,6 +175,8 @@ class ha_innobase: public handler
 	int ft_init();
 	void ft_end();
 	FT_INFO *ft_init_ext(uint flags, uint inx, String* key);
+	FT_INFO *ft_init_ext_with_limit(
+		uint flags, uint inx, String* key, ha_rows limit);
 	int ft_read(uchar* buf);
 
 	void position(const uchar *record);
@@ -191,6 +193,7 @@ class ha_innobase: public handler
 	ha_rows records_in_range(uint inx, key_range *min_key, key_range
 								*max_key);
 	ha_rows estimate_rows_upper_bound();
+	ha_rows records();
 
 	void update_create_info(HA_CREATE_INFO* create_info);
 	int parse_table_name(const char*name,
@@ -513,6 +516,12 @@ typedef struct new_ft_info
 	struct _ft_vft_ext	*could_you;
 	row_prebuilt_t*		ft_prebuilt;
 	fts_result_t*		ft_result;
+	/* The query, to run it again without a limit if ft_result
+	has been pruned */
+	dict_index_t*		ft_index;
+	uint			ft_flags;
+	byte*			ft_query;
+	ulint			ft_query_len;
 } NEW_FT_INFO;
 
 /*********************************************************************//**
@@ -3221,6 +3221,8 @@ int
 i_s_fts_index_cache_fill_one_index(
 /*===============================*/
 	fts_index_cache_t*	index_cache,	/*!< in: FTS index cache */
+	const ib_rbt_t*		words,		/*!< in: words or sync_words
+						of index_cache */
 	THD*			thd,		/*!< in: thread */
 	TABLE_LIST*		tables)		/*!< in/out: tables to fill */
 {
@@ -3243,9 +3245,9 @@ i_s_fts_index_cache_fill_one_index(
 	conv_str.f_n_char = 0;
 
 	/* Go through each word in the index cache */
-	for (rbt_node = rbt_first(index_cache->words);
+	for (rbt_node = rbt_first(words);
 	     rbt_node;
-	     rbt_node = rbt_next(index_cache->words, rbt_node)) {
+	     rbt_node = rbt_next(words, rbt_node)) {
 		fts_tokenizer_word_t* word;
 
 		word = rbt_value(fts_tokenizer_word_t, rbt_node);
@@ -3365,15 +3367,28 @@ i_s_fts_index_cache_fill(
 
 	ut_a(cache);
 
+	/* The words that a SYNC is writing to disk are freed once the
+	SYNC is committed, under the exclusive cache lock. */
+	rw_lock_s_lock(&cache->lock);
+
 	for (ulint i = 0; i < ib_vector_size(cache->indexes); i++) {
 		fts_index_cache_t*      index_cache;
 
 		index_cache = static_cast<fts_index_cache_t*> (
 			ib_vector_get(cache->indexes, i));
 
-		i_s_fts_index_cache_fill_one_index(index_cache, thd, tables);
+		if (index_cache->sync_words != NULL) {
+			i_s_fts_index_cache_fill_one_index(
+				index_cache, index_cache->sync_words,
+				thd, tables);
+		}
+
+		i_s_fts_index_cache_fill_one_index(
+			index_cache, index_cache->words, thd, tables);
 	}
 
+	rw_lock_s_unlock(&cache->lock);
+
 	dict_table_close(user_table, FALSE, FALSE);
 
 	DBUG_RETURN(0);
@@ -4385,6 +4400,24 @@ static ST_FIELD_INFO	i_s_innodb_buffer_stats_fields_info[] =
 	 STRUCT_FLD(old_name,		""),
 	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
 
+#define IDX_BUF_STATS_NUMA_NODE		32
+	{STRUCT_FLD(field_name,		"NUMA_NODE"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED | MY_I_S_MAYBE_NULL),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_BUF_STATS_PAGE_GETS_REMOTE	33
+	{STRUCT_FLD(field_name,		"NUMBER_PAGES_GET_REMOTE"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
 	END_OF_ST_FIELD_INFO
 };
 
@@ -4522,6 +4555,12 @@ i_s_innodb_stats_fill(
 	OK(fields[IDX_BUF_STATS_UNZIP_CUR]->store(
 		static_cast<double>(info->unzip_cur)));
 
+	OK(field_store_ulint(fields[IDX_BUF_STATS_NUMA_NODE],
+			     info->numa_node));
+
+	OK(fields[IDX_BUF_STATS_PAGE_GETS_REMOTE]->store(
+		static_cast<double>(info->n_page_gets_remote)));
+
 	DBUG_RETURN(schema_table_store_record(thd, table));
 }
 
@@ -5181,26 +5220,38 @@ i_s_innodb_fill_buffer_pool(
 
 	heap = mem_heap_create(10000);
 
-	/* Go through each chunk of buffer pool. Currently, we only
-	have one single chunk for each buffer pool */
-	for (ulint n = 0; n < buf_pool->n_chunks; n++) {
+	/* Go through each chunk of buffer pool. The chunks may be
+	freed by an online resize of the buffer pool, which holds
+	buf_pool->LRU_list_mutex while doing so. Hold the mutex
+	while reading each batch of blocks and stop when the chunk
+	is gone. */
+	for (ulint n = 0; ; n++) {
 		const buf_block_t*	block;
 		ulint			n_blocks;
 		buf_page_info_t*	info_buffer;
 		ulint			num_page;
 		ulint			mem_size;
 		ulint			chunk_size;
+		ulint			chunk_done = 0;
 		ulint			num_to_process = 0;
 		ulint			block_id = 0;
 
+		mutex_enter(&buf_pool->LRU_list_mutex);
+
+		if (n >= buf_pool->n_chunks) {
+			mutex_exit(&buf_pool->LRU_list_mutex);
+			break;
+		}
+
 		/* Get buffer block of the nth chunk */
 		block = buf_get_nth_chunk_block(buf_pool, n, &chunk_size);
+		mutex_exit(&buf_pool->LRU_list_mutex);
 		num_page = 0;
 
-		while (chunk_size > 0) {
+		while (chunk_done < chunk_size) {
 			/* we cache maximum MAX_BUF_INFO_CACHED number of
 			buffer page info */
-			num_to_process = ut_min(chunk_size,
+			num_to_process = ut_min(chunk_size - chunk_done,
 						MAX_BUF_INFO_CACHED);
 
 			mem_size = num_to_process * sizeof(buf_page_info_t);
@@ -5211,6 +5262,17 @@ i_s_innodb_fill_buffer_pool(
 			info_buffer = (buf_page_info_t*) mem_heap_zalloc(
 				heap, mem_size);
 
+			mutex_enter(&buf_pool->LRU_list_mutex);
+
+			if (n >= buf_pool->n_chunks) {
+				/* The chunk was freed by a resize. */
+				mutex_exit(&buf_pool->LRU_list_mutex);
+				break;
+			}
+
+			block = buf_get_nth_chunk_block(
+				buf_pool, n, &chunk_size) + chunk_done;
+
 			/* GO through each block in the chunk */
 			for (n_blocks = num_to_process; n_blocks--; block++) {
 				i_s_innodb_buffer_page_get_info(
@@ -5220,6 +5282,8 @@ i_s_innodb_fill_buffer_pool(
 				num_page++;
 			}
 
+			mutex_exit(&buf_pool->LRU_list_mutex);
+
 			/* Fill in information schema table with information
 			just collected from the buffer chunk scan */
 			status = i_s_innodb_buffer_page_fill(
@@ -5232,9 +5296,13 @@ i_s_innodb_fill_buffer_pool(
 			}
 
 			mem_heap_empty(heap);
-			chunk_size -= num_to_process;
+			chunk_done += num_to_process;
 			num_page = 0;
 		}
+
+		if (status) {
+			break;
+		}
 	}
 
 	mem_heap_free(heap);
@@ -6272,6 +6340,24 @@ static ST_FIELD_INFO	innodb_sys_tablestats_fields_info[] =
 	 STRUCT_FLD(old_name,		""),
 	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
 
+#define SYS_TABLESTATS_PURGED_RECS	9
+	{STRUCT_FLD(field_name,		"PURGED_RECS"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define SYS_TABLESTATS_PURGE_LAG	10
+	{STRUCT_FLD(field_name,		"PURGE_LAG"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
 	END_OF_ST_FIELD_INFO
 };
 
@@ -6334,6 +6420,18 @@ i_s_dict_fill_sys_tablestats(
 	OK(fields[SYS_TABLESTATS_TABLE_REF_COUNT]->store(
 		static_cast<double>(table->n_ref_count)));
 
+	OK(fields[SYS_TABLESTATS_PURGED_RECS]->store(
+		table->purge_n_recs, TRUE));
+
+	/* The number of transactions that have been started since the
+	newest purged undo log record of the table was written */
+	trx_id_t	purge_trx_no	= table->purge_trx_no;
+	trx_id_t	max_trx_id	= trx_sys_get_max_trx_id();
+
+	OK(fields[SYS_TABLESTATS_PURGE_LAG]->store(
+		purge_trx_no && max_trx_id > purge_trx_no
+		? max_trx_id - purge_trx_no : 0, TRUE));
+
 	OK(schema_table_store_record(thd, table_to_fill));
 
 	DBUG_RETURN(0);
@@ -0,0 +1,100 @@
+/*****************************************************************************
+
+Copyright (c) 2016, MariaDB Corporation.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/btr0bulk.h
+Bottom-up bulk load of a B-tree
+
+Records are appended in ascending order to the rightmost page of the
+leaf level, which is filled up to innodb_fill_factor percent before a
+new page is started. Node pointers to the new pages are appended to the
+upper levels in the same way, so that no page is ever split. When all
+records have been inserted, the single page of the topmost level is
+copied to the root page.
+
+Created 12/05/2016
+*******************************************************/
+
+#ifndef btr0bulk_h
+#define btr0bulk_h
+
+#include "univ.i"
+#include "db0err.h"
+#include "dict0types.h"
+#include "data0types.h"
+#include "trx0types.h"
+
+/** Bulk loader of an index tree */
+struct btr_bulk_t;
+
+/** Minimum value of innodb_fill_factor */
+#define BTR_BULK_MIN_FILL_FACTOR	10
+
+/*********************************************************************//**
+Checks if an index can be built with the bulk loader.
+@return true if btr_bulk_create() may be used on the index */
+UNIV_INTERN
+bool
+btr_bulk_is_supported(
+/*==================*/
+	const dict_index_t*	index)	/*!< in: index */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+
+/*********************************************************************//**
+Creates a bulk loader for an index. The index must be empty, and it must
+not be accessed by other threads until btr_bulk_finish() returns.
+@return bulk loader */
+UNIV_INTERN
+btr_bulk_t*
+btr_bulk_create(
+/*============*/
+	dict_index_t*	index,		/*!< in: secondary index */
+	trx_id_t	trx_id,		/*!< in: PAGE_MAX_TRX_ID of the
+					leaf pages */
+	ulint		fill_factor)	/*!< in: percentage of each page to
+					fill, BTR_BULK_MIN_FILL_FACTOR..100 */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+
+/*********************************************************************//**
+Appends a record to the leaf level of the index. The record must be
+greater than any record that was inserted before.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_insert(
+/*============*/
+	btr_bulk_t*	bulk,		/*!< in/out: bulk loader */
+	const dtuple_t*	tuple)		/*!< in: index entry without
+					externally stored columns */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+
+/*********************************************************************//**
+Completes the index tree by copying the topmost level into the root page,
+and frees the bulk loader. If err != DB_SUCCESS, only releases the pages;
+the partially built tree will be freed when the index is dropped.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_finish(
+/*============*/
+	btr_bulk_t*	bulk,		/*!< in,own: bulk loader */
+	dberr_t		err)		/*!< in: error from btr_bulk_insert(),
+					or DB_SUCCESS */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+
+#endif /* btr0bulk_h */
@@ -518,6 +518,8 @@ struct btr_pcur_t{
 					old_rec record */
 	buf_block_t*	block_when_stored;/* buffer block when the position was
 					stored */
+	ulint		withdraw_clock;	/*!< buf_withdraw_clock when
+					block_when_stored was set */
 	ib_uint64_t	modify_clock;	/*!< the modify clock value of the
 					buffer block when the cursor position
 					was stored */
@@ -47,6 +47,15 @@ UNIV_INTERN
 void
 btr_search_sys_free(void);
 /*=====================*/
+/*****************************************************************//**
+Resizes the hash tables of the adaptive search system after the buffer
+pool has been resized.  Does nothing if the adaptive hash index has
+been enabled again in the meantime, because the tables must be empty. */
+UNIV_INTERN
+void
+btr_search_sys_resize(
+/*==================*/
+	ulint	hash_size);	/*!< in: hash index hash table size */
 
 /********************************************************************//**
 Disable the adaptive hash search system and empty the index. */
@@ -85,6 +85,9 @@ Created 11/5/1995 Heikki Tuuri
 
 extern	buf_pool_t*	buf_pool_ptr;	/*!< The buffer pools
 					of the database */
+extern volatile ulint	buf_withdraw_clock;/*!< incremented before
+					the chunks withdrawn by a buffer
+					pool resize are freed */
 #ifdef UNIV_DEBUG
 extern ibool		buf_debug_prints;/*!< If this is set TRUE, the program
 					prints info whenever read or flush
@@ -152,6 +155,8 @@ struct buf_pool_info_t{
 	ulint	n_pages_created;	/*!< buf_pool->n_pages_created */
 	ulint	n_pages_written;	/*!< buf_pool->n_pages_written */
 	ulint	n_page_gets;		/*!< buf_pool->n_page_gets */
+	ulint	n_page_gets_remote;	/*!< buf_pool->n_page_gets_remote */
+	ulint	numa_node;		/*!< buf_pool->numa_node */
 	ulint	n_ra_pages_read_rnd;	/*!< buf_pool->n_ra_pages_read_rnd,
 					number of pages readahead */
 	ulint	n_ra_pages_read;	/*!< buf_pool->n_ra_pages_read, number
@@ -225,6 +230,66 @@ buf_pool_free(
 /*==========*/
 	ulint	n_instances);	/*!< in: numbere of instances to free */
 
+/********************************************************************//**
+Determines if a block is intended to be withdrawn. The caller must
+hold buf_pool->free_list_mutex or otherwise ensure that the chunks
+being withdrawn cannot change.
+@return true if will be withdrawn */
+UNIV_INTERN
+bool
+buf_block_will_withdrawn(
+/*=====================*/
+	buf_pool_t*		buf_pool,	/*!< in: buffer pool instance */
+	const buf_block_t*	block);		/*!< in: pointer to control
+						block */
+/********************************************************************//**
+Determines if a frame is intended to be withdrawn. The caller must
+hold buf_pool->free_list_mutex, buf_pool->zip_free_mutex or otherwise
+ensure that the chunks being withdrawn cannot change.
+@return true if will be withdrawn */
+UNIV_INTERN
+bool
+buf_frame_will_withdrawn(
+/*=====================*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	const byte*	ptr);		/*!< in: pointer to a frame */
+/********************************************************************//**
+Rounds a requested buffer pool size up to a multiple of
+innodb_buffer_pool_chunk_size * innodb_buffer_pool_instances.
+@return aligned size in bytes */
+UNIV_INLINE
+ulint
+buf_pool_size_align(
+/*================*/
+	ulint	size);	/*!< in: size in bytes */
+/********************************************************************//**
+Checks whether a buffer pool resize is pending or in progress.
+@return true if the buffer pool is being resized */
+UNIV_INLINE
+bool
+buf_pool_is_resizing(void);
+/********************************************************************//**
+Checks whether a block pointer that was saved together with
+buf_withdraw_clock may point to memory freed by a buffer pool resize.
+@return true if the saved block pointer must not be dereferenced */
+UNIV_INLINE
+bool
+buf_pool_is_obsolete(
+/*=================*/
+	ulint	withdraw_clock);	/*!< in: buf_withdraw_clock when
+					the pointer was saved */
+/*======================*/
+/*****************************************************************//**
+This is the thread that resizes the buffer pool online. It waits for
+srv_buf_resize_event and resizes the buffer pool to srv_buf_pool_size.
+@return this function does not return, it calls os_thread_exit() */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_resize_thread)(
+/*==============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+
 /********************************************************************//**
 Clears the adaptive hash index on all pages in the buffer pool. */
 UNIV_INTERN
@@ -558,14 +623,15 @@ buf_page_peek_if_young(
 	const buf_page_t*	bpage);	/*!< in: block */
 /********************************************************************//**
 Recommends a move of a block to the start of the LRU list if there is danger
-of dropping from the buffer pool. NOTE: does not reserve the buffer pool
-mutex.
+of dropping from the buffer pool. With innodb_lru_algorithm=ADAPTIVE, the
+block is only marked as referenced instead, and the LRU scans move it when
+they reach it. NOTE: does not reserve the buffer pool mutex.
 @return	TRUE if should be made younger */
 UNIV_INLINE
 ibool
 buf_page_peek_if_too_old(
 /*=====================*/
-	const buf_page_t*	bpage);	/*!< in: block to make younger */
+	buf_page_t*	bpage);	/*!< in/out: block to make younger */
 /********************************************************************//**
 Gets the youngest modification log sequence number for a frame.
 Returns zero if not file page or no modification occurred yet.
@@ -1285,6 +1351,28 @@ buf_pool_from_array(
 /*================*/
 	ulint	index);		/*!< in: array index to get
 				buffer pool instance from */
+/********************************************************************//**
+Determines the NUMA node the calling thread is running on.
+@return NUMA node, or ULINT_UNDEFINED if not known */
+UNIV_INTERN
+ulint
+buf_numa_get_curr_node(void);
+/*========================*/
+/********************************************************************//**
+Moves the calling thread to the CPUs of a NUMA node. */
+UNIV_INTERN
+void
+buf_numa_run_on_node(
+/*=================*/
+	ulint	node);		/*!< in: NUMA node, or ULINT_UNDEFINED
+				to allow the thread to run anywhere */
+/********************************************************************//**
+Counts a page get in the statistics of a buffer pool instance. */
+UNIV_INLINE
+void
+buf_pool_stat_page_get(
+/*===================*/
+	buf_pool_t*	buf_pool);	/*!< in/out: buffer pool instance */
 /******************************************************************//**
 Returns the control block of a file page, NULL if not found.
 @return	block, NULL if not found */
@@ -1753,6 +1841,15 @@ struct buf_page_t{
 					0 if the block was never accessed
 					in the buffer pool. Protected by
 					block mutex */
+	byte		access_ref;	/*!< with innodb_lru_algorithm=
+					ADAPTIVE, nonzero if the block was
+					accessed after it became too old;
+					set without holding any mutex, reset
+					under the LRU list mutex */
+	byte		made_young;	/*!< nonzero if the block has been
+					moved to the start of the LRU list
+					since it was read in.  Protected by
+					the LRU list mutex */
 	ibool		is_corrupt;
 # if defined UNIV_DEBUG_FILE_ACCESSES || defined UNIV_DEBUG
 	ibool		file_page_was_freed;
@@ -1933,6 +2030,9 @@ struct buf_pool_stat_t{
 				also successful searches through
 				the adaptive hash index are
 				counted as page gets. */
+	ulint	n_page_gets_remote;/*!< number of page gets performed
+				by threads running on another NUMA
+				node than buf_pool_t::numa_node */
 	ulint	n_pages_read;	/*!< number read operations.  Accessed
 				atomically. */
 	ulint	n_pages_written;/*!< number write operations.  Accessed
@@ -1967,6 +2067,15 @@ struct buf_buddy_stat_t {
 	ib_uint64_t	relocated_usec;
 };
 
+/** A recently evicted page in buf_pool_t::LRU_ghost. */
+struct buf_LRU_ghost_t {
+	/** Fingerprint of the page, with the lowest bit telling whether
+	the page had been made young, or 0 for an empty slot */
+	ulint		fold;
+	/** buf_pool_t::freed_page_clock when the page was evicted */
+	ulint		evicted;
+};
+
 /** @brief The temporary memory array structure.
 
 NOTE! The definition appears here only for other modules of this
@@ -1999,6 +2108,10 @@ struct buf_pool_t{
 					mutex */
 	ulint		instance_no;	/*!< Array index of this buffer
 					pool instance */
+	ulint		numa_node;	/*!< NUMA node the memory of this
+					instance is bound to, or
+					ULINT_UNDEFINED if innodb_numa_bind
+					is not in effect */
 	ulint		old_pool_size;  /*!< Old pool size in bytes */
 	ulint		curr_pool_size;	/*!< Current pool size in bytes */
 	ulint		LRU_old_ratio;  /*!< Reserve this much of the buffer
@@ -2008,8 +2121,15 @@ struct buf_pool_t{
 					the buffer pool to the buddy system */
 #endif
 	ulint		n_chunks;	/*!< number of buffer pool chunks */
+	ulint		n_chunks_new;	/*!< new number of buffer pool chunks
+					while a resize is in progress */
 	buf_chunk_t*	chunks;		/*!< buffer pool chunks */
+	buf_chunk_t*	chunks_old;	/*!< the chunks array replaced by the
+					previous resize; kept until the next
+					resize because buf_block_align() and
+					friends scan chunks without a latch */
 	ulint		curr_size;	/*!< current pool size in pages */
+	ulint		old_size;	/*!< previous pool size in pages */
 	ulint		read_ahead_area;/*!< size in pages of the area which
 					the read-ahead algorithms read if
 					invoked */
@@ -2112,6 +2232,17 @@ struct buf_pool_t{
 	UT_LIST_BASE_NODE_T(buf_page_t) free;
 					/*!< base node of the free
 					block list */
+	UT_LIST_BASE_NODE_T(buf_page_t) withdraw;
+					/*!< base node of the withdrawn
+					block list. It is only used while
+					shrinking the buffer pool: blocks
+					of the chunks that are going to be
+					freed are moved here instead of to
+					the free list. Protected by
+					free_list_mutex */
+	ulint		withdraw_target;/*!< target length of the withdraw
+					list, 0 if nothing is being withdrawn.
+					Protected by free_list_mutex */
 	UT_LIST_BASE_NODE_T(buf_page_t) LRU;
 					/*!< base node of the LRU list */
 	buf_page_t*	LRU_old;	/*!< pointer to the about
@@ -2128,6 +2259,21 @@ struct buf_pool_t{
 					on this value; 0 if LRU_old == NULL;
 					NOTE: LRU_old_len must be adjusted
 					whenever LRU_old shrinks or grows! */
+	buf_LRU_ghost_t* LRU_ghost;	/*!< with innodb_lru_algorithm=
+					ADAPTIVE, a direct-mapped table of
+					recently evicted pages; NULL with
+					MIDPOINT. Protected by
+					LRU_list_mutex */
+	ulint		LRU_ghost_size;	/*!< number of slots in LRU_ghost */
+	ulint		LRU_ghost_n[2];	/*!< number of LRU_ghost entries of
+					pages that were evicted without
+					having been made young [0] and after
+					having been made young [1] */
+	ulint		LRU_old_target;	/*!< with innodb_lru_algorithm=
+					ADAPTIVE, the length of the old
+					sublist that LRU_old_ratio is tuned
+					towards, or 0 if not initialized.
+					Protected by LRU_list_mutex */
 
 	UT_LIST_BASE_NODE_T(buf_block_t) unzip_LRU;
 					/*!< base node of the
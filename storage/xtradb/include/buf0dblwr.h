@@ -35,6 +35,8 @@ Created 2011/12/19 Inaam Rana
 
 /** Doublewrite system */
 extern buf_dblwr_t*	buf_dblwr;
+/** Parallel doublewrite file, NULL if not in use */
+extern buf_parallel_dblwr_t*	buf_parallel_dblwr;
 /** Set to TRUE when the doublewrite buffer is being created */
 extern ibool		buf_dblwr_being_created;
 
@@ -108,6 +110,28 @@ void
 buf_dblwr_flush_buffered_writes(void);
 /*=================================*/
 /********************************************************************//**
+Flushes the buffered writes of one LRU or flush list batch. If the
+parallel doublewrite file is in use, only the shard of the given buffer
+pool instance and flush type is written, otherwise the shared doublewrite
+buffer is flushed as by buf_dblwr_flush_buffered_writes(). */
+UNIV_INTERN
+void
+buf_dblwr_flush_batch(
+/*==================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_flush_t		flush_type);	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
+/****************************************************************//**
+Creates or recreates the parallel doublewrite file and allocates its
+shards. Must be called after crash recovery, before the page cleaner and
+LRU manager threads are started. Does nothing if the parallel doublewrite
+file is disabled.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+buf_parallel_dblwr_create(void);
+/*===========================*/
+/********************************************************************//**
 Writes a page to the doublewrite buffer on disk, sync it, then write
 the page to the datafile and sync the datafile. This function is used
 for single page flushes. If all the buffers allocated for single page
@@ -156,6 +180,39 @@ struct buf_dblwr_t{
 				cached to write_buf */
 };
 
+/** One shard of the parallel doublewrite file. Each buffer pool instance
+has one shard for LRU and one for flush list batches. As only one batch of
+a given type can run on an instance at a time, a shard is filled by a single
+thread and its mutex is only shared with the I/O completion threads. */
+struct buf_dblwr_shard_t{
+	ib_mutex_t	mutex;	/*!< mutex protecting the fields below */
+	ulint		first_free;/*!< first free position in write_buf
+				measured in units of UNIV_PAGE_SIZE */
+	ulint		b_reserved;/*!< number of pages of the shard
+				whose datafile writes are pending */
+	bool		batch_running;/*!< true if the shard has been
+				written to the file and its pages are
+				being written to the datafiles */
+	os_event_t	b_event;/*!< event where threads wait for the
+				shard batch to end */
+	os_offset_t	offset;	/*!< offset of the shard in the file */
+	byte*		write_buf;/*!< write buffer of the shard, aligned
+				to UNIV_PAGE_SIZE */
+	buf_page_t**	buf_block_arr;/*!< blocks cached to write_buf */
+};
+
+/** Parallel doublewrite file control struct */
+struct buf_parallel_dblwr_t{
+	char*		path;	/*!< path of the doublewrite file */
+	os_file_t	file;	/*!< doublewrite file handle */
+	ulint		n_shards;/*!< number of shards, two per buffer
+				pool instance */
+	ulint		batch_size;/*!< shard size in pages */
+	byte*		write_buf_unaligned;/*!< memory for the write
+				buffers of all the shards */
+	buf_dblwr_shard_t* shards;/*!< array of n_shards shards */
+};
+
 
 #endif /* UNIV_HOTBACKUP */
 
@@ -198,6 +198,16 @@ buf_LRU_make_block_young(
 /*=====================*/
 	buf_page_t*	bpage);	/*!< in: control block */
 /******************************************************************//**
+Gives a block that was accessed since it became too old a second chance
+instead of evicting it (innodb_lru_algorithm=ADAPTIVE): the block is moved
+to the start of the LRU list. The caller must hold the LRU list mutex.
+@return true if the block was moved */
+UNIV_INTERN
+bool
+buf_LRU_second_chance(
+/*==================*/
+	buf_page_t*	bpage);	/*!< in/out: control block */
+/******************************************************************//**
 Moves a block to the end of the LRU list. */
 UNIV_INTERN
 void
@@ -59,6 +59,41 @@ buf_read_page_async(
 	ulint	space,	/*!< in: space id */
 	ulint	offset);/*!< in: page number */
 /********************************************************************//**
+Issues asynchronous reads of pages of one tablespace for a buffer pool
+load. The page numbers should be sorted, so that the requests for
+adjacent pages reach the i/o handler threads together and can be
+merged. Pages that are already in the buffer pool are skipped.
+@return number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_load_pages(
+/*================*/
+	ulint		space,		/*!< in: space id */
+	const ulint*	page_nos,	/*!< in: page numbers */
+	ulint		n_pages);	/*!< in: number of pages */
+/** Maximum number of pages that buf_read_ahead_scan() is asked to read
+at a time */
+#define BUF_READ_AHEAD_SCAN_MAX		256
+
+/********************************************************************//**
+Issues asynchronous reads of the leaf pages that a forward index scan
+is about to visit, as listed by the node pointers of their parent page.
+The requests are queued in ascending page number order before the aio
+handler threads are woken up, so that the reads of adjacent pages can be
+merged. Pages that are already in the buffer pool are skipped.
+@return number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_ahead_scan(
+/*================*/
+	ulint		space,		/*!< in: space id */
+	ulint		zip_size,	/*!< in: compressed page size in
+					bytes, or 0 */
+	ulint*		page_nos,	/*!< in/out: page numbers; sorted
+					by this function */
+	ulint		n_pages,	/*!< in: number of pages */
+	trx_t*		trx);		/*!< in: transaction, or NULL */
+/********************************************************************//**
 Applies a random read-ahead in buf_pool if there are at least a threshold
 value of accessed pages from the random read-ahead area. Does not read any
 page, not even the one at the position (space, offset), if the read-ahead
@@ -42,8 +42,14 @@ struct buf_pool_t;
 struct buf_pool_stat_t;
 /** Buffer pool buddy statistics struct */
 struct buf_buddy_stat_t;
+/** Recently evicted page, for innodb_lru_algorithm=ADAPTIVE */
+struct buf_LRU_ghost_t;
 /** Doublewrite memory struct */
 struct buf_dblwr_t;
+/** Parallel doublewrite file */
+struct buf_parallel_dblwr_t;
+/** Shard of the parallel doublewrite file */
+struct buf_dblwr_shard_t;
 
 /** A buffer frame. @see page_t */
 typedef	byte	buf_frame_t;
@@ -133,6 +139,20 @@ enum srv_empty_free_list_t {
 					thread */
 };
 
+/** Alternatives for srv_lru_algorithm, set through the
+innodb_lru_algorithm variable */
+enum srv_lru_algorithm_t {
+	SRV_LRU_ALGORITHM_MIDPOINT,	/*!< Midpoint insertion; blocks
+					are moved to the start of the LRU
+					list when they are accessed */
+	SRV_LRU_ALGORITHM_ADAPTIVE	/*!< Accesses only set a reference
+					flag that the LRU scans act upon
+					(CLOCK), and the size of the old
+					sublist is tuned from the recently
+					evicted pages that are read again
+					(ARC) */
+};
+
 /** Parameters of binary buddy system for compressed pages (buf0buddy.h) */
 /* @{ */
 /** Zip shift value for the smallest page size */
@@ -759,6 +759,14 @@ struct dict_index_t{
 	ulint		stat_n_leaf_pages;
 				/*!< approximate number of leaf pages in the
 				index tree */
+	ib_uint64_t	stat_modified_counter;
+				/*!< number of records inserted into or
+				updated in this index since its statistics
+				were last calculated; the background
+				recalculation of persistent statistics
+				skips the secondary indexes that did not
+				change enough. Not protected by any latch
+				for performance reasons. */
 	bool		stats_error_printed;
 				/*!< has persistent statistics error printed
 				for this index ? */
@@ -1292,6 +1300,23 @@ struct dict_table_t{
 				/*!< Has persistent stats error beein
 				already printed for this table ? */
 				/* @} */
+	/*----------------------*/
+				/** Purge statistics, shown in
+				INFORMATION_SCHEMA.INNODB_SYS_TABLESTATS.
+				A purge batch assigns all undo log records
+				of a table to the same purge thread, and
+				the batches are separated by waiting for
+				all threads to complete, so these fields
+				are not protected by any latch. */
+				/* @{ */
+	ib_uint64_t	purge_n_recs;
+				/*!< number of undo log records of this
+				table processed by purge */
+	trx_id_t	purge_trx_no;
+				/*!< transaction serialisation number of
+				the newest undo log record of this table
+				processed by purge, or 0 */
+				/* @} */
 	/*----------------------*/
 				/**!< The following fields are used by the
 				AUTOINC code.  The actual collection of
@@ -39,6 +39,12 @@ enum dict_stats_upd_option_t {
 				storage, if the persistent storage is
 				not present then emit a warning and
 				fall back to transient stats */
+	DICT_STATS_RECALC_PERSISTENT_CHANGED,/* like
+				DICT_STATS_RECALC_PERSISTENT, but keep the
+				statistics of the secondary indexes that
+				changed little since they were last
+				analyzed; used by the background
+				recalculation */
 	DICT_STATS_RECALC_TRANSIENT,/* (re) calculate the statistics
 				using an imprecise quick algo
 				without saving the results
@@ -54,6 +60,10 @@ enum dict_stats_upd_option_t {
 				otherwise do nothing */
 };
 
+/** Number of index pages that the calculation of persistent statistics
+has read since startup; used to throttle the background recalculation */
+extern ulint	dict_stats_n_pages_sampled;
+
 /*********************************************************************//**
 Calculates new estimates for table and index statistics. This function
 is relatively quick and is used to calculate transient statistics that
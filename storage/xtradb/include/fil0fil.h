@@ -945,6 +945,20 @@ fil_extend_space_to_desired_size(
 	ulint	size_after_extend);/*!< in: desired size in pages after the
 				extension; if the current space size is bigger
 				than this already, the function does nothing */
+#ifndef UNIV_HOTBACKUP
+/**********************************************************************//**
+Shrinks the single data file of an undo tablespace to the given number of
+pages. The caller must have removed all pages of the tablespace from the
+buffer pool, and must prevent any access to it until the space header has
+been initialized again.
+@return	true if success */
+UNIV_INTERN
+bool
+fil_truncate_undo_tablespace(
+/*=========================*/
+	ulint	space_id,	/*!< in: undo tablespace id */
+	ulint	size);		/*!< in: new size in pages */
+#endif /* !UNIV_HOTBACKUP */
 /*******************************************************************//**
 Tries to reserve free extents in a file space.
 @return	TRUE if succeed */
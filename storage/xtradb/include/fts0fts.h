@@ -106,6 +106,10 @@ extern ulong		fts_sort_pll_degree;
 call */
 extern ulong		fts_num_word_optimize;
 
+/** Variable specifying the number of threads that optimize the words
+of an index in parallel, for each optimize table call */
+extern ulong		fts_optimize_threads;
+
 /** Variable specifying whether we do additional FTS diagnostic printout
 in the log */
 extern char		fts_enable_diag_print;
@@ -259,6 +263,11 @@ struct fts_result_t {
 					indexed by doc id */
 	ib_rbt_t*	rankings_by_rank;/*!< RB tree of type fts_ranking_t
 					indexed by rank */
+
+	bool		pruned;		/*!< true if documents that cannot
+					be among the most relevant ones
+					were left out, see the limit of
+					fts_query() */
 };
 
 /** This is used to generate the FTS auxiliary table name, we need the
@@ -572,6 +581,10 @@ fts_query(
 	const byte*	query,			/*!< in: FTS query */
 	ulint		query_len,		/*!< in: FTS query string len
 						in bytes */
+	ulint		limit,			/*!< in: number of most
+						relevant documents that the
+						caller reads, or
+						ULINT_UNDEFINED for all */
 	fts_result_t**	result)			/*!< out: query result, to be
 						freed by the caller.*/
 	MY_ATTRIBUTE((nonnull, warn_unused_result));
@@ -849,7 +862,6 @@ fts_drop_index_split_tables(
 /** Run SYNC on the table, i.e., write out data from the cache to the
 FTS auxiliary INDEX table and clear the cache at the end.
 @param[in,out]	table		fts table
-@param[in]	unlock_cache	whether unlock cache when write node
 @param[in]	wait		whether wait for existing sync to finish
 @param[in]      has_dict        whether has dict operation lock
 @return DB_SUCCESS on success, error code on failure. */
@@ -857,7 +869,6 @@ UNIV_INTERN
 dberr_t
 fts_sync_table(
 	dict_table_t*	table,
-	bool		unlock_cache,
 	bool		wait,
 	bool		has_dict);
 
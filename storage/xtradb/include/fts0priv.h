@@ -498,6 +498,8 @@ fts_cache_find_word(
 /*================*/
 	const fts_index_cache_t*
 			index_cache,	/*!< in: cache to search */
+	const ib_rbt_t*	words,		/*!< in: words or sync_words
+					of index_cache */
 	const fts_string_t*
 			text)		/*!< in: word to search for */
 	MY_ATTRIBUTE((nonnull, warn_unused_result));
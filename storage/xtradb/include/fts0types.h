@@ -66,6 +66,10 @@ struct fts_index_cache_t {
 	ib_rbt_t*	words;		/*!< Nodes; indexed by fts_string_t*,
 					cells are fts_tokenizer_word_t*.*/
 
+	ib_rbt_t*	sync_words;	/*!< The words that SYNC is writing
+					to the INDEX table while new documents
+					are being added to words, or NULL */
+
 	ib_vector_t*	doc_stats;	/*!< Array of the fts_doc_stats_t
 					contained in the memory buffer.
 					Must be in sorted order (ascending).
@@ -73,8 +77,6 @@ struct fts_index_cache_t {
 					the rb tree imposes a space overhead
 					that we can do without */
 
-	que_t**		ins_graph;	/*!< Insert query graphs */
-
 	que_t**		sel_graph;	/*!< Select query graphs */
 	CHARSET_INFO*	charset;	/*!< charset */
 };
@@ -124,9 +126,20 @@ struct fts_sync_t {
 					set the upper_limit field */
 	ib_time_t	start_time;	/*!< SYNC start time */
 	bool		in_progress;	/*!< flag whether sync is in progress.*/
-	bool		unlock_cache;	/*!< flag whether unlock cache when
-					write fts node */
 	os_event_t	event;		/*!< sync finish event */
+	mem_heap_t*	heap;		/*!< The heap of the cache contents
+					that SYNC is writing, i.e., the words
+					in fts_index_cache_t::sync_words and
+					deleted_doc_ids below; the cache
+					carries on with a new sync_heap. NULL
+					if there is nothing to write. If SYNC
+					fails, the contents are kept and
+					written by the next SYNC */
+	ib_vector_t*	deleted_doc_ids;/*!< Array of the doc ids that were
+					deleted before SYNC started, each
+					element is of type fts_update_t;
+					covered by fts_cache_t::deleted_lock */
+	doc_id_t	sync_doc_id;	/*!< max_doc_id when SYNC started */
 };
 
 /** The cache for the FTS system. It is a memory-based inverted index
@@ -166,8 +179,8 @@ struct fts_cache_t {
 					disk */
 	ib_alloc_t*	sync_heap;	/*!< The heap allocator, for indexes
 					and deleted_doc_ids, ie. transient
-					objects, they are recreated after
-					a SYNC is completed */
+					objects, they are recreated when
+					a SYNC starts */
 
 	ib_alloc_t*	self_heap;	/*!< This heap is the heap out of
 					which an instance of the cache itself
@@ -215,7 +228,6 @@ struct fts_node_t {
 	ulint		ilist_size_alloc;
 					/*!< Allocated size of ilist in
 					bytes */
-	bool		synced;		/*!< flag whether the node is synced */
 };
 
 /** A tokenizer word. Contains information about one word. */
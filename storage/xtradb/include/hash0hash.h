@@ -442,6 +442,30 @@ hash_get_lock(
 	hash_table_t*	table,	/*!< in: hash table */
 	ulint		fold);	/*!< in: fold */
 /************************************************************//**
+Makes sure that an s-latched rw_lock is still the one protecting a fold
+value. The number of cells of a hash table may change while the latch
+is being waited for (see buf_pool_resize()); in that case the latch is
+released and the correct one is acquired instead.
+@return s-latched rw_lock protecting the fold */
+UNIV_INLINE
+prio_rw_lock_t*
+hash_lock_s_confirm(
+/*================*/
+	prio_rw_lock_t*	hash_lock,	/*!< in: s-latched rw_lock */
+	hash_table_t*	table,		/*!< in: hash table */
+	ulint		fold);		/*!< in: fold */
+/************************************************************//**
+Makes sure that an x-latched rw_lock is still the one protecting a fold
+value, see hash_lock_s_confirm().
+@return x-latched rw_lock protecting the fold */
+UNIV_INLINE
+prio_rw_lock_t*
+hash_lock_x_confirm(
+/*================*/
+	prio_rw_lock_t*	hash_lock,	/*!< in: x-latched rw_lock */
+	hash_table_t*	table,		/*!< in: hash table */
+	ulint		fold);		/*!< in: fold */
+/************************************************************//**
 Reserves the mutex for a fold value in a hash table. */
 UNIV_INTERN
 void
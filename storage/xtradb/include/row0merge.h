@@ -134,6 +134,13 @@ struct row_merge_dup_t {
 					(index->table), or NULL if not
 					rebuilding table */
 	ulint			n_dup;	/*!< number of duplicates */
+	ulint*			n_reported;/*!< number of duplicates
+					reported to table by concurrent
+					sorts that share it, or NULL if
+					no other sort uses table */
+	bool			reported;/*!< whether this index
+					reported a duplicate to table
+					when n_reported != NULL */
 };
 
 /*************************************************************//**
@@ -397,7 +404,8 @@ row_merge_sort(
 					index entries */
 	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
 	int*			tmpfd,	/*!< in/out: temporary file handle */
-	const bool		update_progress, /*!< in: update progress status variable or not */
+	const bool		update_progress, /*!< in: update progress status variable
+						 and thd progress, or not */
 	const float		pct_progress, /*!< in: total progress percent until now */
 	const float		pct_cost, /*!< in: current progress percent */
 	fil_space_crypt_t*	crypt_data,/*!< in: table crypt data */
@@ -911,6 +911,13 @@ struct row_prebuilt_t {
 	ulint		n_rows_fetched;	/*!< number of rows fetched after
 					positioning the current cursor */
 	ulint		fetch_direction;/*!< ROW_SEL_NEXT or ROW_SEL_PREV */
+	ulint		read_ahead_countdown;
+					/*!< number of leaf pages that a
+					forward scan may still enter before
+					the next restoration of the cursor
+					position reads ahead more leaf pages;
+					0 if that restoration should read
+					ahead; see srv_scan_read_ahead_pages */
 	byte*		fetch_cache[MYSQL_FETCH_CACHE_SIZE];
 					/*!< a cache for fetched rows if we
 					fetch many rows from the same cursor:
@@ -0,0 +1,102 @@
+/*****************************************************************************
+
+Copyright (c) 2016, MariaDB Corporation.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/row0pread.h
+Parallel read of a clustered index
+
+The clustered index is split into key ranges using the node pointers
+of its upper levels, and the ranges are scanned concurrently by
+several threads, each with its own persistent cursor, under the read
+view of a single transaction.
+
+Created 11/24/2016
+*******************************************************/
+
+#ifndef row0pread_h
+#define row0pread_h
+
+#include "univ.i"
+#include "db0err.h"
+#include "dict0types.h"
+#include "trx0types.h"
+#include "rem0types.h"
+
+/** Maximum number of threads of a parallel read */
+#define ROW_PREAD_MAX_THREADS	256
+
+/** Callback invoked by a parallel read for each record that is
+visible in the read view. The record is S-latched for the duration
+of the call. Records of one range are passed in ascending key order,
+from the thread that scans the range.
+@param thread_no	in: number of the calling thread,
+			0 <= thread_no < number of threads
+@param rec		in: clustered index record
+@param offsets		in: rec_get_offsets(rec, index)
+@param arg		in/out: argument passed to row_pread_clust_index()
+@return DB_SUCCESS to continue the scan, or an error code to abort it */
+typedef dberr_t (*row_pread_func_t)(
+	ulint		thread_no,
+	const rec_t*	rec,
+	const ulint*	offsets,
+	void*		arg);
+
+/*********************************************************************//**
+Scans the clustered index in the read view of trx, splitting the index
+into key ranges that are scanned by up to n_threads threads. The
+calling thread is one of the scanning threads. Delete-marked records and
+records that are not visible in the read view are skipped.
+@return DB_SUCCESS, DB_INTERRUPTED, or the first error returned by
+func or by the scan */
+UNIV_INTERN
+dberr_t
+row_pread_clust_index(
+/*==================*/
+	trx_t*		trx,		/*!< in: transaction with a
+					read view */
+	dict_index_t*	index,		/*!< in: clustered index */
+	ulint		n_threads,	/*!< in: maximum number of threads */
+	row_pread_func_t func,		/*!< in: callback for each record */
+	void*		arg,		/*!< in/out: argument of func */
+	ulint*		n_threads_used)	/*!< out: number of threads that
+					were used, or NULL; func is called
+					with thread_no < *n_threads_used */
+	MY_ATTRIBUTE((nonnull(1,2,4), warn_unused_result));
+
+/*********************************************************************//**
+Counts the records of the clustered index that are visible in the read
+view of trx, using up to n_threads threads. If check is set, also checks
+that the records of each range are in ascending order and that no key
+is duplicated, like row_check_index_for_mysql() does.
+@return DB_SUCCESS, DB_INTERRUPTED or error code */
+UNIV_INTERN
+dberr_t
+row_pread_count(
+/*============*/
+	trx_t*		trx,		/*!< in: transaction with a
+					read view */
+	dict_index_t*	index,		/*!< in: clustered index */
+	ulint		n_threads,	/*!< in: maximum number of threads */
+	bool		check,		/*!< in: whether to check the
+					order of the records */
+	ulint*		n_rows,		/*!< out: number of records */
+	bool*		is_ok)		/*!< out: false if check was set
+					and the index is corrupted, or NULL */
+	MY_ATTRIBUTE((nonnull(1,2,5), warn_unused_result));
+
+#endif /* row0pread_h */
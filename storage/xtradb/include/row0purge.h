@@ -89,6 +89,8 @@ struct purge_node_t{
 	/*----------------------*/
 	/* Local storage for this graph node */
 	roll_ptr_t	roll_ptr;/* roll pointer to undo log record */
+	trx_id_t	trx_no;	/*!< serialisation number of the transaction
+				that wrote the undo log record */
 	ib_vector_t*    undo_recs;/*!< Undo recs to purge */
 
 	undo_no_t	undo_no;/* undo number of the record */
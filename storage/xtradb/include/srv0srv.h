@@ -205,6 +205,9 @@ extern os_event_t	srv_error_event;
 /** The buffer pool dump/load thread waits on this event. */
 extern os_event_t	srv_buf_dump_event;
 
+/** The buffer pool resize thread waits on this event. */
+extern os_event_t	srv_buf_resize_event;
+
 /** The buffer pool dump/load file name */
 #define SRV_BUF_DUMP_FILENAME_DEFAULT	"ib_buffer_pool"
 extern char*		srv_buf_dump_filename;
@@ -214,6 +217,12 @@ and/or load it during startup. */
 extern char		srv_buffer_pool_dump_at_shutdown;
 extern char		srv_buffer_pool_load_at_startup;
 
+/** Seconds between periodic buffer pool dumps, 0 if disabled */
+extern ulong		srv_buf_dump_interval;
+
+/** Number of threads that issue the reads of a buffer pool load */
+extern ulong		srv_buf_load_threads;
+
 /* Whether to disable file system cache if it is defined */
 extern char		srv_disable_sort_file_cache;
 
@@ -293,6 +302,9 @@ extern ibool	srv_locks_unsafe_for_binlog;
 
 /** Sort buffer size in index creation */
 extern ulong	srv_sort_buf_size;
+/** Percentage of each B-tree page to fill when building an index
+with the bulk loader */
+extern ulong	srv_fill_factor;
 /** Maximum modification log file size for online index creation */
 extern unsigned long long	srv_online_max_size;
 
@@ -302,6 +314,7 @@ use simulated aio we build below with threads.
 Currently we support native aio on windows and linux */
 extern my_bool	srv_use_native_aio;
 extern my_bool	srv_numa_interleave;
+extern my_bool	srv_numa_bind;
 #ifdef __WIN__
 extern ibool	srv_use_native_conditions;
 #endif /* __WIN__ */
@@ -341,6 +354,21 @@ extern ulint	srv_undo_tablespaces_open;
 /* The number of undo segments to use */
 extern ulong	srv_undo_logs;
 
+/** Default undo tablespace size in UNIV_PAGEs count (10MB). An undo
+tablespace is truncated back to this size. */
+#define SRV_UNDO_TABLESPACE_SIZE_IN_PAGES		\
+	(((1024 * 1024) * 10) / UNIV_PAGE_SIZE_DEF)
+
+/** Whether to truncate undo tablespaces that exceed srv_max_undo_log_size */
+extern my_bool	srv_undo_log_truncate;
+
+/** Size of an undo tablespace in bytes above which it is truncated */
+extern unsigned long long	srv_max_undo_log_size;
+
+/** Every this many purge batches, the history list is truncated and the
+undo tablespaces are checked for truncation */
+extern ulong	srv_purge_rseg_truncate_frequency;
+
 extern ulint	srv_n_data_files;
 extern char**	srv_data_file_names;
 extern ulint*	srv_data_file_sizes;
@@ -400,6 +428,9 @@ extern ibool	srv_use_sys_malloc;
 #endif /* UNIV_HOTBACKUP */
 extern ulint	srv_buf_pool_size;	/*!< requested size in bytes */
 extern ulint    srv_buf_pool_instances; /*!< requested number of buffer pool instances */
+extern ulong	srv_buf_pool_chunk_unit;/*!< size of a buffer pool chunk
+					in bytes; the pool grows and
+					shrinks by whole chunks */
 extern ulong	srv_n_page_hash_locks;	/*!< number of locks to
 					protect buf_pool->page_hash */
 extern ulong	srv_LRU_scan_depth;	/*!< Scan depth for LRU
@@ -451,10 +482,15 @@ extern ulong	srv_cleaner_lsn_age_factor;
 extern ulong	srv_empty_free_list_algorithm;
 					/*!< Empty free list for a query thread
 					handling algorithm option */
+extern ulong	srv_lru_algorithm;
+					/*!< Buffer pool replacement policy,
+					srv_lru_algorithm_t */
 
 extern ulint	srv_n_file_io_threads;
 extern my_bool	srv_random_read_ahead;
 extern ulong	srv_read_ahead_threshold;
+extern ulong	srv_scan_read_ahead_pages;
+extern ulong	srv_parallel_read_threads;
 extern ulint	srv_n_read_io_threads;
 extern ulint	srv_n_write_io_threads;
 /* Defragmentation, Origianlly facebook default value is 100, but it's too high */
@@ -523,9 +559,14 @@ extern unsigned long long	srv_stats_persistent_sample_pages;
 extern my_bool			srv_stats_auto_recalc;
 extern unsigned long long	srv_stats_modified_counter;
 extern my_bool			srv_stats_sample_traditional;
+extern ulong			srv_stats_recalc_threads;
+extern ulong			srv_stats_recalc_io_budget;
+extern my_bool			srv_stats_recalc_incremental;
 
 extern ibool	srv_use_doublewrite_buf;
 extern ulong	srv_doublewrite_batch_size;
+extern char*	srv_parallel_doublewrite_path;
+extern ulong	srv_parallel_doublewrite_batch_size;
 
 extern ulong	srv_log_arch_expire_sec;
 
@@ -580,6 +621,9 @@ extern ibool	srv_error_monitor_active;
 /* TRUE during the lifetime of the buffer pool dump/load thread */
 extern ibool	srv_buf_dump_thread_active;
 
+/* TRUE during the lifetime of the buffer pool resize thread */
+extern ibool	srv_buf_resize_thread_active;
+
 /* TRUE during the lifetime of the stats thread */
 extern ibool	srv_dict_stats_thread_active;
 
@@ -596,6 +640,8 @@ extern ibool	srv_priority_boost;
 
 extern ulint	srv_truncated_status_writes;
 extern ulint	srv_available_undo_logs;
+/** Number of undo tablespace truncations since startup */
+extern ulint	srv_undo_truncations;
 
 extern ulint	srv_column_compressed;
 extern ulint	srv_column_decompressed;
@@ -685,6 +731,9 @@ extern my_bool srv_master_thread_priority;
 /* the number of purge threads to use from the worker pool (currently 0 or 1) */
 extern ulong srv_n_purge_threads;
 
+/* The number of purge threads used for the latest purge batch */
+extern ulint srv_n_purge_threads_active;
+
 /* the number of pages to purge in one batch */
 extern ulong srv_purge_batch_size;
 
@@ -1112,6 +1161,8 @@ struct export_var_t{
 	ulint innodb_data_reads;		/*!< I/O read requests */
 	char  innodb_buffer_pool_dump_status[512];/*!< Buf pool dump status */
 	char  innodb_buffer_pool_load_status[512];/*!< Buf pool load status */
+	char  innodb_buffer_pool_resize_status[512];/*!< Buf pool resize
+						status */
 	ulint innodb_buffer_pool_pages_total;	/*!< Buffer pool size */
 	ulint innodb_buffer_pool_pages_data;	/*!< Data pages */
 	ulint innodb_buffer_pool_bytes_data;	/*!< File bytes used */
@@ -1126,6 +1177,8 @@ struct export_var_t{
 	ulint innodb_buffer_pool_pages_made_young;
 	ulint innodb_buffer_pool_pages_old;
 	ulint innodb_buffer_pool_read_requests;	/*!< buf_pool->stat.n_page_gets */
+	ulint innodb_buffer_pool_read_requests_remote;/*!< buf_pool->stat.
+						n_page_gets_remote */
 	ulint innodb_buffer_pool_reads;		/*!< srv_buf_pool_reads */
 	ulint innodb_buffer_pool_wait_free;	/*!< srv_buf_pool_wait_free */
 	ulint innodb_buffer_pool_pages_flushed;	/*!< srv_buf_pool_flushed */
@@ -1176,6 +1229,7 @@ struct export_var_t{
 	ulint innodb_pages_read;		/*!< buf_pool->stat.n_pages_read*/
 	ulint innodb_page0_read;		/*!< srv_stats.page0_read */
 	ulint innodb_pages_written;		/*!< buf_pool->stat.n_pages_written */
+	ulint innodb_purge_threads_active;	/*!< srv_n_purge_threads_active */
 	ib_int64_t innodb_purge_trx_id;
 	ib_int64_t innodb_purge_undo_no;
 	ulint innodb_row_lock_waits;		/*!< srv_n_lock_wait_count */
@@ -1199,6 +1253,7 @@ struct export_var_t{
 	ulint innodb_num_open_files;		/*!< fil_n_file_opened */
 	ulint innodb_truncated_status_writes;	/*!< srv_truncated_status_writes */
 	ulint innodb_available_undo_logs;       /*!< srv_available_undo_logs */
+	ulint innodb_undo_truncations;		/*!< srv_undo_truncations */
 	ulint innodb_read_views_memory;		/*!< srv_read_views_memory */
 	ulint innodb_descriptors_memory;	/*!< srv_descriptors_memory */
 	ib_int64_t innodb_s_lock_os_waits;
@@ -1313,6 +1368,7 @@ struct srv_slot_t{
 # define srv_use_adaptive_hash_indexes		FALSE
 # define srv_use_native_aio			FALSE
 # define srv_numa_interleave			FALSE
+# define srv_numa_bind				FALSE
 # define srv_force_recovery			0UL
 # define srv_set_io_thread_op_info(t,info)	((void) 0)
 # define srv_reset_io_thread_op_info()		((void) 0)
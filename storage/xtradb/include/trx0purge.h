@@ -102,6 +102,41 @@ UNIV_INTERN
 void
 trx_purge_run(void);
 /*================*/
+/*******************************************************************//**
+Checks if an undo tablespace was being truncated when the server was
+killed, and if so, completes the truncation of the file. Called at startup
+for each undo tablespace, before redo log apply.
+@return false if the truncation could not be completed */
+UNIV_INTERN
+bool
+trx_purge_undo_trunc_recover(
+/*=========================*/
+	const char*	name,		/*!< in: data file name */
+	ulint		space_id);	/*!< in: undo tablespace id */
+/*******************************************************************//**
+Checks if the redo log for a tablespace must be ignored because the
+tablespace was truncated by trx_purge_undo_trunc_recover().
+@return true if the tablespace is being re-initialized */
+UNIV_INTERN
+bool
+trx_purge_undo_trunc_is_pending(
+/*============================*/
+	ulint	space_id);	/*!< in: tablespace id */
+/*******************************************************************//**
+Re-creates the space header and the rollback segment headers of the undo
+tablespaces that were truncated by trx_purge_undo_trunc_recover(). Called
+before the rollback segments are read from the TRX_SYS page. */
+UNIV_INTERN
+void
+trx_purge_undo_trunc_fixup(void);
+/*============================*/
+/*******************************************************************//**
+Makes the re-created undo tablespaces durable with a checkpoint, and
+removes their truncation log files. Called after redo log apply. */
+UNIV_INTERN
+void
+trx_purge_undo_trunc_fixup_done(void);
+/*=================================*/
 
 /** Purge states */
 enum purge_state_t {
@@ -207,12 +242,23 @@ struct trx_purge_t{
 					rseg_queue_t::trx_no. It is protected
 					by the bh_mutex */
 	ib_mutex_t		bh_mutex;	/*!< Mutex protecting ib_bh */
+	/*-----------------------------*/
+	ulint		undo_trunc_space;/*!< Undo tablespace whose rollback
+					segments are not assigned to new
+					transactions because it is waiting
+					to be truncated, or ULINT_UNDEFINED.
+					Only accessed by the purge
+					coordinator */
+	ulint		undo_trunc_last;/*!< The undo tablespace that was
+					last marked for truncation */
 };
 
 /** Info required to purge a record */
 struct trx_purge_rec_t {
 	trx_undo_rec_t*	undo_rec;	/*!< Record to purge */
 	roll_ptr_t	roll_ptr;	/*!< File pointr to UNDO record */
+	trx_id_t	trx_no;		/*!< Serialisation number of the
+					transaction that wrote the record */
 };
 
 #ifndef UNIV_NONINL
@@ -123,6 +123,17 @@ void
 trx_rseg_mem_free(
 /*==============*/
 	trx_rseg_t*	rseg);		/*!< in, own: instance to free */
+/***********************************************************************//**
+Resets the memory object of a rollback segment whose header has been
+re-created by trx_rseg_header_create() in a truncated undo tablespace. */
+UNIV_INTERN
+void
+trx_rseg_mem_reset(
+/*===============*/
+	trx_rseg_t*	rseg,	/*!< in/out: rollback segment that no
+				transaction is using */
+	ulint		page_no);/*!< in: page number of the new rollback
+				segment header */
 
 /*********************************************************************
 Creates a rollback segment. */
@@ -189,6 +200,14 @@ struct trx_rseg_t{
 					yet purged log */
 	ibool		last_del_marks;	/*!< TRUE if the last not yet purged log
 					needs purging */
+	/*--------------------------------------------------------*/
+	ulint		trx_ref_count;	/*!< number of transactions that have
+					been assigned this rollback segment;
+					protected by mutex */
+	bool		skip_allocation;/*!< true if the rollback segment is
+					not assigned to new transactions,
+					because its undo tablespace is about
+					to be truncated; protected by mutex */
 };
 
 /** For prioritising the rollback segments for purge. */
@@ -382,6 +382,12 @@ typedef enum innodb_file_formats_enum innodb_file_formats_t;
 #define IF_SNAPPY(A,B) B
 #endif
 
+#ifdef HAVE_ZSTD
+#define IF_ZSTD(A,B) A
+#else
+#define IF_ZSTD(A,B) B
+#endif
+
 /** The universal page size of the database */
 #define UNIV_PAGE_SIZE		((ulint) srv_page_size)
 
@@ -59,6 +59,7 @@ Created 9/20/1997 Heikki Tuuri
 #include "ibuf0ibuf.h"
 #include "trx0undo.h"
 #include "trx0rec.h"
+#include "trx0purge.h"
 #include "fil0fil.h"
 #include "fil0crypt.h"
 #ifndef UNIV_HOTBACKUP
@@ -1505,6 +1506,13 @@ recv_add_to_hash_table(
 		return;
 	}
 
+	if (trx_purge_undo_trunc_is_pending(space)) {
+		/* The undo tablespace was truncated, and it will be
+		initialized again by trx_purge_undo_trunc_fixup() */
+
+		return;
+	}
+
 	len = rec_end - body;
 
 	recv = static_cast<recv_t*>(
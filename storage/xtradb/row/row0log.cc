@@ -2861,7 +2861,7 @@ row_log_table_apply(
 	} else {
 		row_merge_dup_t	dup = {
 			clust_index, table,
-			clust_index->online_log->col_map, 0
+			clust_index->online_log->col_map, 0, NULL, false
 		};
 
 		error = row_log_table_apply_ops(thr, &dup);
@@ -3664,7 +3664,7 @@ row_log_apply(
 {
 	dberr_t		error;
 	row_log_t*	log;
-	row_merge_dup_t	dup = { index, table, NULL, 0 };
+	row_merge_dup_t	dup = { index, table, NULL, 0, NULL, false };
 	DBUG_ENTER("row_log_apply");
 
 	ut_ad(dict_index_is_online_ddl(index));
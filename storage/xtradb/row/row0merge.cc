@@ -42,6 +42,9 @@ Completed by Sunny Bains and Marko Makela
 #include "ha_prototypes.h"
 #include "math.h" /* log2() */
 #include "fil0crypt.h"
+#include "btr0bulk.h"
+#include "row0pread.h"
+#include "os0thread.h"
 
 float my_log2f(float n)
 {
@@ -735,10 +738,24 @@ row_merge_dup_report(
 	row_merge_dup_t*	dup,	/*!< in/out: for reporting duplicates */
 	const dfield_t*		entry)	/*!< in: duplicate index entry */
 {
-	if (!dup->n_dup++) {
-		/* Only report the first duplicate record,
-		but count all duplicate records. */
-		innobase_fields_to_mysql(dup->table, dup->index, entry);
+	if (dup->n_reported == NULL) {
+		if (!dup->n_dup++) {
+			/* Only report the first duplicate record,
+			but count all duplicate records. */
+			innobase_fields_to_mysql(
+				dup->table, dup->index, entry);
+		}
+	} else {
+		/* Several threads may be sorting into the same table
+		record. Only the first duplicate of any of them is
+		copied to it. */
+		os_atomic_increment_ulint(&dup->n_dup, 1);
+
+		if (os_atomic_increment_ulint(dup->n_reported, 1) == 1) {
+			innobase_fields_to_mysql(
+				dup->table, dup->index, entry);
+			dup->reported = true;
+		}
 	}
 }
 
@@ -1974,7 +1991,8 @@ row_merge_read_clustered_index(
 			if (buf->n_tuples) {
 				if (dict_index_is_unique(buf->index)) {
 					row_merge_dup_t	dup = {
-						buf->index, table, col_map, 0};
+						buf->index, table, col_map,
+						0, NULL, false};
 
 					row_merge_buf_sort(buf, &dup);
 
@@ -2184,7 +2202,7 @@ row_merge_read_clustered_index(
 		/* Sync fts cache for other fts indexes to keep all
 		fts indexes consistent in sync_doc_id. */
 		err = fts_sync_table(const_cast<dict_table_t*>(new_table),
-				     false, true, false);
+				     true, false);
 
 		if (err == DB_SUCCESS) {
 			fts_update_next_doc_id(
@@ -2197,6 +2215,396 @@ row_merge_read_clustered_index(
 	DBUG_RETURN(err);
 }
 
+/** Per-thread state of a parallel scan for creating indexes */
+struct row_merge_pscan_thread_t {
+	row_merge_buf_t**	merge_buf;	/*!< record buffers, one per
+						index, or NULL if the thread
+						has not been used yet */
+	ib_uint64_t*		n_rec;		/*!< number of records added,
+						per index */
+	mem_heap_t*		row_heap;	/*!< heap for row_build() */
+	ulint			block_size;	/*!< size of block and
+						crypt_block */
+	row_merge_block_t*	block;		/*!< file buffer */
+	row_merge_block_t*	crypt_block;	/*!< encryption buffer,
+						or NULL */
+	ulint			n_read;		/*!< rows that have not been
+						added to the progress yet */
+};
+
+/** Parallel scan of the clustered index for creating secondary indexes */
+struct row_merge_pscan_t {
+	trx_t*			trx;		/*!< transaction */
+	const dict_table_t*	table;		/*!< table */
+	dict_index_t**		index;		/*!< indexes to be created */
+	merge_file_t*		files;		/*!< temporary files, shared
+						by all threads */
+	row_merge_dup_t*	dup;		/*!< duplicate reporters,
+						shared by all threads */
+	ulint			n_index;	/*!< number of indexes */
+	fil_space_crypt_t*	crypt_data;	/*!< crypt data, or NULL */
+	row_merge_pscan_thread_t* thr;		/*!< per-thread state */
+	ulint			err_index;	/*!< position of the index that
+						an error was reported for, or
+						ULINT_UNDEFINED */
+	ulint			n_read;		/*!< number of rows read */
+	ib_int64_t		table_total_rows;/*!< estimated number of rows */
+	float			pct_cost;	/*!< percent of the task weight
+						out of the total alter job */
+};
+
+/*********************************************************************//**
+Allocates the buffers of a thread of a parallel scan.
+@return DB_SUCCESS or DB_OUT_OF_MEMORY */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+row_merge_pscan_thread_init(
+/*========================*/
+	const row_merge_pscan_t*	pscan,	/*!< in: parallel scan */
+	row_merge_pscan_thread_t*	thr)	/*!< out: thread state */
+{
+	thr->merge_buf = static_cast<row_merge_buf_t**>(
+		mem_alloc(pscan->n_index * sizeof *thr->merge_buf));
+	thr->n_rec = static_cast<ib_uint64_t*>(
+		mem_zalloc(pscan->n_index * sizeof *thr->n_rec));
+
+	for (ulint i = 0; i < pscan->n_index; i++) {
+		thr->merge_buf[i] = row_merge_buf_create(pscan->index[i]);
+	}
+
+	thr->row_heap = mem_heap_create(sizeof(mrec_buf_t));
+
+	thr->block_size = srv_sort_buf_size;
+	thr->block = static_cast<row_merge_block_t*>(
+		os_mem_alloc_large(&thr->block_size));
+
+	if (thr->block && pscan->crypt_data) {
+		thr->crypt_block = static_cast<row_merge_block_t*>(
+			os_mem_alloc_large(&thr->block_size));
+
+		if (thr->crypt_block == NULL) {
+			return(DB_OUT_OF_MEMORY);
+		}
+	}
+
+	return(thr->block ? DB_SUCCESS : DB_OUT_OF_MEMORY);
+}
+
+/*********************************************************************//**
+Sorts the buffer of one index of a thread of a parallel scan and writes it
+to the temporary file of the index as a run of its own. The runs of all
+threads are merged by row_merge_sort(), regardless of their order.
+@return DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+row_merge_pscan_flush(
+/*==================*/
+	row_merge_pscan_t*		pscan,	/*!< in/out: parallel scan */
+	row_merge_pscan_thread_t*	thr,	/*!< in/out: thread state */
+	ulint				i)	/*!< in: position of the index */
+{
+	row_merge_buf_t*	buf	= thr->merge_buf[i];
+	merge_file_t*		file	= &pscan->files[i];
+
+	if (buf->n_tuples == 0) {
+		return(DB_SUCCESS);
+	}
+
+	if (dict_index_is_unique(buf->index)) {
+		row_merge_buf_sort(buf, &pscan->dup[i]);
+
+		if (pscan->dup[i].n_dup) {
+			return(DB_DUPLICATE_KEY);
+		}
+	} else {
+		row_merge_buf_sort(buf, NULL);
+	}
+
+	row_merge_buf_write(buf, file, thr->block);
+
+	if (!row_merge_write(file->fd,
+			     os_atomic_increment_ulint(&file->offset, 1) - 1,
+			     thr->block, pscan->crypt_data, thr->crypt_block,
+			     pscan->table->space)) {
+		return(DB_TEMP_FILE_WRITE_FAILURE);
+	}
+
+	UNIV_MEM_INVALID(&thr->block[0], srv_sort_buf_size);
+
+	thr->merge_buf[i] = row_merge_buf_empty(buf);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Adds the entries of a clustered index record to the record buffers of the
+calling thread. Callback of row_pread_clust_index().
+@return DB_SUCCESS or error code */
+static
+dberr_t
+row_merge_pscan_rec(
+/*================*/
+	ulint		thread_no,	/*!< in: number of the thread */
+	const rec_t*	rec,		/*!< in: clustered index record */
+	const ulint*	offsets,	/*!< in: rec_get_offsets(rec) */
+	void*		arg)		/*!< in/out: row_merge_pscan_t */
+{
+	row_merge_pscan_t*		pscan
+		= static_cast<row_merge_pscan_t*>(arg);
+	row_merge_pscan_thread_t*	thr	= &pscan->thr[thread_no];
+	const dtuple_t*			row;
+	row_ext_t*			ext;
+	dberr_t				err;
+
+	if (thr->merge_buf == NULL) {
+		err = row_merge_pscan_thread_init(pscan, thr);
+
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+	}
+
+	row = row_build(ROW_COPY_POINTERS,
+			dict_table_get_first_index(pscan->table),
+			rec, offsets, pscan->table,
+			NULL, NULL, &ext, thr->row_heap);
+
+	for (ulint i = 0; i < pscan->n_index; i++) {
+		doc_id_t	doc_id		= 0;
+		bool		exceed_page	= false;
+		ulint		rows_added;
+
+		rows_added = row_merge_buf_add(
+			thr->merge_buf[i], NULL, pscan->table, NULL,
+			row, ext, &doc_id, NULL, &exceed_page, pscan->trx);
+
+		if (!rows_added) {
+			/* The buffer is full. Write it out, and try
+			adding the record again. */
+			err = row_merge_pscan_flush(pscan, thr, i);
+
+			if (err != DB_SUCCESS) {
+				pscan->err_index = i;
+				return(err);
+			}
+
+			rows_added = row_merge_buf_add(
+				thr->merge_buf[i], NULL, pscan->table, NULL,
+				row, ext, &doc_id, NULL, &exceed_page,
+				pscan->trx);
+
+			/* An empty buffer should have enough room
+			for at least one record. */
+			ut_a(rows_added);
+		}
+
+		if (exceed_page) {
+			pscan->err_index = i;
+			return(DB_TOO_BIG_RECORD);
+		}
+
+		thr->n_rec[i] += rows_added;
+	}
+
+	mem_heap_empty(thr->row_heap);
+
+	/* Increment innodb_onlineddl_pct_progress status variable */
+	if (++thr->n_read == 1000) {
+		ulint	n_read = os_atomic_increment_ulint(
+			&pscan->n_read, thr->n_read);
+		float	curr_progress = (ib_int64_t) n_read
+			>= pscan->table_total_rows
+			? pscan->pct_cost
+			: (pscan->pct_cost * n_read)
+			/ pscan->table_total_rows;
+
+		thr->n_read = 0;
+		/* presenting 10.12% as 1012 integer */
+		onlineddl_pct_progress = curr_progress * 100;
+	}
+
+	return(DB_SUCCESS);
+}
+
+/** Reads the clustered index with several threads and creates temporary
+files containing the entries of the indexes to be created. This is a
+variant of row_merge_read_clustered_index() for creating secondary indexes
+online without rebuilding the table, when no FULLTEXT index is created.
+@param[in]	trx		transaction with a read view
+@param[in,out]	table		MySQL table object, for reporting erroneous
+				records
+@param[in]	old_table	table where rows are read from
+@param[in]	index		indexes to be created
+@param[in]	files		temporary files
+@param[in]	key_numbers	MySQL key numbers to create
+@param[in]	n_index		number of indexes to create
+@param[in,out]	tmpfd		temporary file handle
+@param[in]	pct_cost	percent of task weight out of total alter job
+@param[in]	crypt_data	crypt data, or NULL
+@return	DB_SUCCESS or error */
+static MY_ATTRIBUTE((nonnull(1,2,3,4,5,6,8), warn_unused_result))
+dberr_t
+row_merge_read_clustered_index_parallel(
+	trx_t*			trx,
+	struct TABLE*		table,
+	const dict_table_t*	old_table,
+	dict_index_t**		index,
+	merge_file_t*		files,
+	const ulint*		key_numbers,
+	ulint			n_index,
+	int*			tmpfd,
+	float			pct_cost,
+	fil_space_crypt_t*	crypt_data)
+{
+	row_merge_pscan_t	pscan;
+	const ulint		n_threads = srv_parallel_read_threads;
+	ulint			n_reported = 0;
+	dberr_t			err = DB_SUCCESS;
+
+	DBUG_ENTER("row_merge_read_clustered_index_parallel");
+
+	ut_ad(trx->read_view);
+	ut_ad(n_threads > 1);
+
+	trx->op_info = "reading clustered index";
+
+	ut_ad(trx->mysql_thd != NULL);
+	const char*	path = thd_innodb_tmpdir(trx->mysql_thd);
+
+	/* All threads append their runs to the same files. */
+	for (ulint i = 0; i < n_index; i++) {
+		if (row_merge_file_create_if_needed(
+			    &files[i], tmpfd, 0, path) < 0) {
+			trx->error_key_num = i;
+			trx->op_info = "";
+			DBUG_RETURN(DB_OUT_OF_MEMORY);
+		}
+	}
+
+	pscan.trx = trx;
+	pscan.table = old_table;
+	pscan.index = index;
+	pscan.files = files;
+	pscan.n_index = n_index;
+	pscan.crypt_data = crypt_data;
+	pscan.err_index = ULINT_UNDEFINED;
+	pscan.n_read = 0;
+	pscan.pct_cost = pct_cost;
+	pscan.table_total_rows = dict_table_get_n_rows(old_table);
+
+	if (pscan.table_total_rows == 0) {
+		/* We don't know total row count */
+		pscan.table_total_rows = 1;
+	}
+
+	pscan.dup = static_cast<row_merge_dup_t*>(
+		mem_alloc(n_index * sizeof *pscan.dup));
+
+	for (ulint i = 0; i < n_index; i++) {
+		pscan.dup[i].index = index[i];
+		pscan.dup[i].table = table;
+		pscan.dup[i].col_map = NULL;
+		pscan.dup[i].n_dup = 0;
+		pscan.dup[i].n_reported = &n_reported;
+		pscan.dup[i].reported = false;
+	}
+
+	pscan.thr = static_cast<row_merge_pscan_thread_t*>(
+		mem_zalloc(n_threads * sizeof *pscan.thr));
+
+	err = row_pread_clust_index(
+		trx, dict_table_get_first_index(old_table), n_threads,
+		row_merge_pscan_rec, &pscan, NULL);
+
+	/* Write out the last runs, and free the buffers. */
+	for (ulint t = 0; t < n_threads; t++) {
+		row_merge_pscan_thread_t*	thr = &pscan.thr[t];
+
+		if (thr->merge_buf == NULL) {
+			continue;
+		}
+
+		for (ulint i = 0; i < n_index; i++) {
+			if (err == DB_SUCCESS && thr->block != NULL) {
+				err = row_merge_pscan_flush(&pscan, thr, i);
+
+				if (err != DB_SUCCESS) {
+					pscan.err_index = i;
+				}
+			}
+
+			files[i].n_rec += thr->n_rec[i];
+			row_merge_buf_free(thr->merge_buf[i]);
+		}
+
+		mem_free(thr->merge_buf);
+		mem_free(thr->n_rec);
+		mem_heap_free(thr->row_heap);
+
+		if (thr->block != NULL) {
+			os_mem_free_large(thr->block, thr->block_size);
+		}
+
+		if (thr->crypt_block != NULL) {
+			os_mem_free_large(thr->crypt_block, thr->block_size);
+		}
+	}
+
+	switch (err) {
+	case DB_SUCCESS:
+		for (ulint i = 0; i < n_index; i++) {
+			/* Note the newest transaction that modified
+			this index when the scan was completed. We
+			prevent older readers from accessing this
+			index, to ensure read consistency. */
+			trx_id_t	max_trx_id;
+
+			rw_lock_x_lock(dict_index_get_lock(index[i]));
+			ut_a(dict_index_get_online_status(index[i])
+			     == ONLINE_INDEX_CREATION);
+
+			max_trx_id = row_log_get_max_trx(index[i]);
+
+			if (max_trx_id > index[i]->trx_id) {
+				index[i]->trx_id = max_trx_id;
+			}
+
+			rw_lock_x_unlock(dict_index_get_lock(index[i]));
+
+			if (files[i].offset == 0) {
+				/* No records; there is nothing to
+				sort or insert. */
+				row_merge_file_destroy(&files[i]);
+			}
+		}
+		break;
+	case DB_DUPLICATE_KEY:
+		for (ulint i = 0; i < n_index; i++) {
+			if (pscan.dup[i].reported) {
+				trx->error_key_num = key_numbers[i];
+			}
+		}
+		break;
+	case DB_TEMP_FILE_WRITE_FAILURE:
+	case DB_OUT_OF_MEMORY:
+	case DB_TOO_BIG_RECORD:
+		if (pscan.err_index != ULINT_UNDEFINED) {
+			trx->error_key_num = pscan.err_index;
+			break;
+		}
+		/* fall through */
+	default:
+		trx->error_key_num = 0;
+	}
+
+	mem_free(pscan.thr);
+	mem_free(pscan.dup);
+
+	trx->op_info = "";
+
+	DBUG_RETURN(err);
+}
+
 /** Write a record via buffer 2 and read the next record to buffer N.
 @param N	number of the buffer (0 or 1)
 @param INDEX	record descriptor
@@ -2594,7 +3002,8 @@ row_merge_sort(
 					*/
 	const bool		update_progress,
 					/*!< in: update progress
-					status variable or not */
+					status variable and thd
+					progress, or not */
 	const float 		pct_progress,
 					/*!< in: total progress percent
 					until now */
@@ -2639,8 +3048,9 @@ row_merge_sort(
 	of file marker).  Thus, it must be at least one block. */
 	ut_ad(file->offset > 0);
 
-	/* Progress report only for "normal" indexes. */
-	if (!(dup->index->type & DICT_FTS)) {
+	/* Progress report only for "normal" indexes that are not
+	sorted by a background thread. */
+	if (update_progress) {
 		thd_progress_init(trx->mysql_thd, 1);
 	}
 
@@ -2650,8 +3060,7 @@ row_merge_sort(
 	do {
 		/* Report progress of merge sort to MySQL for
 		show processlist progress field */
-		/* Progress report only for "normal" indexes. */
-		if (!(dup->index->type & DICT_FTS)) {
+		if (update_progress) {
 			thd_progress_report(trx->mysql_thd, file->offset - num_runs, file->offset);
 		}
 
@@ -2677,8 +3086,7 @@ row_merge_sort(
 
 	mem_free(run_offset);
 
-	/* Progress report only for "normal" indexes. */
-	if (!(dup->index->type & DICT_FTS)) {
+	if (update_progress) {
 		thd_progress_end(trx->mysql_thd);
 	}
 
@@ -2759,12 +3167,21 @@ row_merge_insert_index_tuples(
 	mrec_buf_t*		buf;
 	ib_int64_t		inserted_rows = 0;
 	float			curr_progress;
+	btr_bulk_t*		bulk = NULL;
 	DBUG_ENTER("row_merge_insert_index_tuples");
 
 	ut_ad(!srv_read_only_mode);
 	ut_ad(!(index->type & DICT_FTS));
 	ut_ad(trx_id);
 
+	if (index->table == old_table && btr_bulk_is_supported(index)) {
+		/* Build the tree bottom-up instead of inserting the
+		sorted records one by one from the root. The indexes
+		of a table that is being rebuilt keep using the
+		ordinary insert path. */
+		bulk = btr_bulk_create(index, trx_id, srv_fill_factor);
+	}
+
 	tuple_heap = mem_heap_create(1000);
 
 	{
@@ -2795,6 +3212,7 @@ row_merge_insert_index_tuples(
 			rec_t*		rec;
 			btr_cur_t	cursor;
 			mtr_t		mtr;
+			ulint*		ins_offsets = NULL;
 
 			b = row_merge_read_rec(block, buf, b, index,
 					       fd, &foffs, &mrec, offsets,
@@ -2851,6 +3269,18 @@ row_merge_insert_index_tuples(
 			}
 
 			ut_ad(dtuple_validate(dtuple));
+
+			if (bulk != NULL) {
+				ut_ad(!n_ext);
+				error = btr_bulk_insert(bulk, dtuple);
+
+				if (error != DB_SUCCESS) {
+					goto err_exit;
+				}
+
+				goto next_tuple;
+			}
+
 			log_free_check();
 
 			mtr_start(&mtr);
@@ -2875,8 +3305,6 @@ row_merge_insert_index_tuples(
 				      > 0);
 			}
 #endif /* UNIV_DEBUG */
-			ulint*	ins_offsets = NULL;
-
 			error = btr_cur_optimistic_insert(
 				BTR_NO_UNDO_LOG_FLAG | BTR_NO_LOCKING_FLAG
 				| BTR_KEEP_SYS_FLAG | BTR_CREATE_FLAG,
@@ -2934,7 +3362,7 @@ row_merge_insert_index_tuples(
 			if (error != DB_SUCCESS) {
 				goto err_exit;
 			}
-
+next_tuple:
 			mem_heap_empty(tuple_heap);
 			mem_heap_empty(ins_heap);
 
@@ -2954,6 +3382,10 @@ row_merge_insert_index_tuples(
 	}
 
 err_exit:
+	if (bulk != NULL) {
+		error = btr_bulk_finish(bulk, error);
+	}
+
 	mem_heap_free(tuple_heap);
 	mem_heap_free(ins_heap);
 	mem_heap_free(heap);
@@ -3924,6 +4356,255 @@ row_merge_drop_table(
 	return(row_drop_table_for_mysql(table->name, trx, false, false, false));
 }
 
+/** Sorting and loading of several indexes by concurrent threads */
+struct row_merge_pbuild_t {
+	trx_t*			trx;		/*!< transaction */
+	const dict_table_t*	old_table;	/*!< table where rows are
+						read from */
+	dict_index_t**		indexes;	/*!< indexes to be created */
+	merge_file_t*		files;		/*!< temporary files */
+	row_merge_dup_t*	dup;		/*!< duplicate reporters,
+						one per index */
+	dberr_t*		errors;		/*!< out: result, per index */
+	ulint*			order;		/*!< positions of the indexes
+						that may be built by any
+						thread */
+	ulint			n_order;	/*!< size of order[] */
+	ulint			next;		/*!< number of entries of
+						order[] handed out */
+	const char*		path;		/*!< temporary directory */
+	fil_space_crypt_t*	crypt_data;	/*!< crypt data, or NULL */
+	ulint			space;		/*!< space id */
+	float			pct_progress;	/*!< progress of the alter
+						job before the sort */
+};
+
+/*********************************************************************//**
+Merge sorts the temporary file of an index and loads the index from it.
+@return DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull(1,4,6), warn_unused_result))
+dberr_t
+row_merge_pbuild_index(
+/*===================*/
+	row_merge_pbuild_t*	pbuild,		/*!< in/out: parallel build */
+	ulint			i,		/*!< in: position of the index */
+	bool			update_progress,/*!< in: whether to report
+						thd progress */
+	row_merge_block_t*	block,		/*!< in/out: 3 buffers */
+	row_merge_block_t*	crypt_block,	/*!< in/out: crypt buffers,
+						or NULL */
+	int*			tmpfd)		/*!< in/out: temporary file */
+{
+	merge_file_t*	file	= &pbuild->files[i];
+	dberr_t		err;
+
+	if (file->fd == -1) {
+		return(DB_SUCCESS);
+	}
+
+	if (row_merge_tmpfile_if_needed(tmpfd, pbuild->path) < 0) {
+		return(DB_OUT_OF_MEMORY);
+	}
+
+	err = row_merge_sort(pbuild->trx, &pbuild->dup[i], file,
+			     block, tmpfd, update_progress,
+			     pbuild->pct_progress, 0,
+			     pbuild->crypt_data, crypt_block, pbuild->space);
+
+	if (err == DB_SUCCESS) {
+		err = row_merge_insert_index_tuples(
+			pbuild->trx->id, pbuild->indexes[i],
+			pbuild->old_table, file->fd, block, file->n_rec,
+			pbuild->pct_progress, 0,
+			pbuild->crypt_data, crypt_block, pbuild->space);
+	}
+
+	return(err);
+}
+
+/*********************************************************************//**
+Builds the indexes of order[] that have not been handed out to another
+thread yet. */
+static
+void
+row_merge_pbuild_work(
+/*==================*/
+	row_merge_pbuild_t*	pbuild,		/*!< in/out: parallel build */
+	row_merge_block_t*	block,		/*!< in/out: 3 buffers */
+	row_merge_block_t*	crypt_block,	/*!< in/out: crypt buffers,
+						or NULL */
+	int*			tmpfd)		/*!< in/out: temporary file */
+{
+	for (;;) {
+		ulint	n = os_atomic_increment_ulint(&pbuild->next, 1) - 1;
+
+		if (n >= pbuild->n_order) {
+			break;
+		}
+
+		ulint	i = pbuild->order[n];
+
+		pbuild->errors[i] = row_merge_pbuild_index(
+			pbuild, i, false, block, crypt_block, tmpfd);
+	}
+}
+
+/*********************************************************************//**
+Thread that sorts and loads indexes of a parallel build.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(row_merge_pbuild_thread)(
+/*====================================*/
+	void*	arg)	/*!< in/out: row_merge_pbuild_t */
+{
+	row_merge_pbuild_t*	pbuild	= static_cast<row_merge_pbuild_t*>(arg);
+	ulint			block_size = 3 * srv_sort_buf_size;
+	row_merge_block_t*	block;
+	row_merge_block_t*	crypt_block = NULL;
+	int			tmpfd	= -1;
+
+	block = static_cast<row_merge_block_t*>(
+		os_mem_alloc_large(&block_size));
+
+	if (block != NULL && pbuild->crypt_data != NULL) {
+		crypt_block = static_cast<row_merge_block_t*>(
+			os_mem_alloc_large(&block_size));
+	}
+
+	/* If the buffers cannot be allocated, leave the indexes
+	to the other threads. */
+	if (block != NULL
+	    && (crypt_block != NULL || pbuild->crypt_data == NULL)) {
+		row_merge_pbuild_work(pbuild, block, crypt_block, &tmpfd);
+	}
+
+	row_merge_file_destroy_low(tmpfd);
+
+	if (block != NULL) {
+		os_mem_free_large(block, block_size);
+	}
+
+	if (crypt_block != NULL) {
+		os_mem_free_large(crypt_block, block_size);
+	}
+
+	os_thread_exit(NULL, false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/** Merge sorts the temporary files of several indexes and loads the
+indexes from them concurrently. UNIQUE indexes may copy a duplicate record
+to the MySQL table object, also while merging the files, so they are built
+one at a time by the calling thread, while the other indexes are built by
+background threads, and by the calling thread when it is done with the
+UNIQUE indexes. The building of UNIQUE indexes stops at the first error.
+@param[in]	trx		transaction
+@param[in]	old_table	table where rows are read from
+@param[in]	indexes		indexes to be created
+@param[in,out]	files		temporary files
+@param[in]	n_indexes	number of indexes
+@param[in,out]	table		MySQL table object, for reporting erroneous
+				records
+@param[in,out]	block		file buffer of the calling thread
+@param[in,out]	crypt_block	crypt buffer of the calling thread, or NULL
+@param[in,out]	tmpfd		temporary file of the calling thread
+@param[in]	crypt_data	crypt data, or NULL
+@param[in]	space		space id
+@param[in]	pct_progress	progress of the alter job before the sort
+@return result of each index, to be freed with mem_free() */
+static MY_ATTRIBUTE((nonnull(1,2,3,4,6,7,9), warn_unused_result))
+dberr_t*
+row_merge_build_parallel(
+	trx_t*			trx,
+	const dict_table_t*	old_table,
+	dict_index_t**		indexes,
+	merge_file_t*		files,
+	ulint			n_indexes,
+	struct TABLE*		table,
+	row_merge_block_t*	block,
+	row_merge_block_t*	crypt_block,
+	int*			tmpfd,
+	fil_space_crypt_t*	crypt_data,
+	ulint			space,
+	float			pct_progress)
+{
+	row_merge_pbuild_t	pbuild;
+	os_thread_t*		thread_hdl;
+	ulint			n_threads;
+
+	pbuild.trx = trx;
+	pbuild.old_table = old_table;
+	pbuild.indexes = indexes;
+	pbuild.files = files;
+	pbuild.path = thd_innodb_tmpdir(trx->mysql_thd);
+	pbuild.crypt_data = crypt_data;
+	pbuild.space = space;
+	pbuild.pct_progress = pct_progress;
+	pbuild.next = 0;
+	pbuild.n_order = 0;
+
+	pbuild.dup = static_cast<row_merge_dup_t*>(
+		mem_alloc(n_indexes * sizeof *pbuild.dup));
+	pbuild.errors = static_cast<dberr_t*>(
+		mem_alloc(n_indexes * sizeof *pbuild.errors));
+	pbuild.order = static_cast<ulint*>(
+		mem_alloc(n_indexes * sizeof *pbuild.order));
+
+	for (ulint i = 0; i < n_indexes; i++) {
+		pbuild.dup[i].index = indexes[i];
+		pbuild.dup[i].table = table;
+		pbuild.dup[i].col_map = NULL;
+		pbuild.dup[i].n_dup = 0;
+		pbuild.dup[i].n_reported = NULL;
+		pbuild.dup[i].reported = false;
+		pbuild.errors[i] = DB_SUCCESS;
+
+		if (!dict_index_is_unique(indexes[i])) {
+			pbuild.order[pbuild.n_order++] = i;
+		}
+	}
+
+	n_threads = ut_min(pbuild.n_order,
+			   (ulint) srv_parallel_read_threads - 1);
+
+	thread_hdl = static_cast<os_thread_t*>(
+		mem_alloc((n_threads + 1) * sizeof *thread_hdl));
+
+	for (ulint i = 0; i < n_threads; i++) {
+		thread_hdl[i] = os_thread_create(
+			row_merge_pbuild_thread, &pbuild, NULL);
+	}
+
+	for (ulint i = 0; i < n_indexes; i++) {
+		if (!dict_index_is_unique(indexes[i])) {
+			continue;
+		}
+
+		pbuild.errors[i] = row_merge_pbuild_index(
+			&pbuild, i, true, block, crypt_block, tmpfd);
+
+		if (pbuild.errors[i] != DB_SUCCESS) {
+			/* Do not let another UNIQUE index overwrite
+			the record of a duplicate in table. */
+			break;
+		}
+	}
+
+	row_merge_pbuild_work(&pbuild, block, crypt_block, tmpfd);
+
+	for (ulint i = 0; i < n_threads; i++) {
+		os_thread_join(thread_hdl[i]);
+	}
+
+	mem_free(thread_hdl);
+	mem_free(pbuild.order);
+	mem_free(pbuild.dup);
+
+	return(pbuild.errors);
+}
+
 /*********************************************************************//**
 Build indexes on a table by reading a clustered index,
 creating a temporary file containing index entries, merge sorting
@@ -3972,6 +4653,7 @@ row_merge_build_indexes(
 	ib_int64_t		sig_count = 0;
 	bool			fts_psort_initiated = false;
 	fil_space_crypt_t *	crypt_data = NULL;
+	dberr_t*		pbuild_errors = NULL;
 
 	float total_static_cost = 0;
 	float total_dynamic_cost = 0;
@@ -4051,6 +4733,8 @@ row_merge_build_indexes(
 			dup->table = table;
 			dup->col_map = col_map;
 			dup->n_dup = 0;
+			dup->n_reported = NULL;
+			dup->reported = false;
 
 			row_fts_psort_info_init(
 				trx, dup, new_table, opt_doc_id_size,
@@ -4086,12 +4770,23 @@ row_merge_build_indexes(
 	/* Read clustered index of the table and create files for
 	secondary index entries for merge sort */
 
-	error = row_merge_read_clustered_index(
+	if (online && old_table == new_table && !fts_sort_idx
+	    && srv_parallel_read_threads > 1) {
+		ut_ad(!add_cols);
+		ut_ad(add_autoinc == ULINT_UNDEFINED);
+
+		error = row_merge_read_clustered_index_parallel(
+			trx, table, old_table, indexes, merge_files,
+			key_numbers, n_indexes, &tmpfd, pct_cost,
+			crypt_data);
+	} else {
+		error = row_merge_read_clustered_index(
 			trx, table, old_table, new_table, online, indexes,
 			fts_sort_idx, psort_info, merge_files, key_numbers,
 			n_indexes, add_cols, col_map,
 			add_autoinc, sequence, block, &tmpfd, pct_cost,
 			crypt_data, crypt_block);
+	}
 
 	pct_progress += pct_cost;
 
@@ -4115,6 +4810,20 @@ row_merge_build_indexes(
 		"ib_merge_wait_after_read",
 		os_thread_sleep(20000000););  /* 20 sec */
 
+	if (!fts_sort_idx && n_indexes > 1
+	    && srv_parallel_read_threads > 1) {
+		sql_print_information("InnoDB: Online DDL : Start merge-sorting"
+			" and building %lu indexes in parallel", n_indexes);
+
+		pbuild_errors = row_merge_build_parallel(
+			trx, old_table, indexes, merge_files, n_indexes,
+			table, block, crypt_block, &tmpfd, crypt_data,
+			new_table->space, pct_progress);
+
+		sql_print_information("InnoDB: Online DDL : End of merge-sorting"
+			" and building %lu indexes in parallel", n_indexes);
+	}
+
 	for (i = 0; i < n_indexes; i++) {
 		dict_index_t*	sort_idx = indexes[i];
 
@@ -4191,11 +4900,14 @@ row_merge_build_indexes(
 #ifdef FTS_INTERNAL_DIAG_PRINT
 			DEBUG_FTS_SORT_PRINT("FTS_SORT: Complete Insert\n");
 #endif
+		} else if (pbuild_errors != NULL) {
+			/* The index was built by row_merge_build_parallel(). */
+			error = pbuild_errors[i];
 		} else if (merge_files[i].fd != -1) {
 			char		buf[3 * NAME_LEN];
 			char		*bufend;
 			row_merge_dup_t	dup = {
-				sort_idx, table, col_map, 0};
+				sort_idx, table, col_map, 0, NULL, false};
 
 			pct_cost = (COST_BUILD_INDEX_STATIC +
 				(total_dynamic_cost * merge_files[i].offset /
@@ -4318,6 +5030,10 @@ row_merge_build_indexes(
 		dict_mem_index_free(fts_sort_idx);
 	}
 
+	if (pbuild_errors) {
+		mem_free(pbuild_errors);
+	}
+
 	mem_free(merge_files);
 	os_mem_free_large(block, block_size);
 
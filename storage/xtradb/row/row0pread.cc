@@ -0,0 +1,627 @@
+/*****************************************************************************
+
+Copyright (c) 2016, MariaDB Corporation.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file row/row0pread.cc
+Parallel read of a clustered index
+
+Created 11/24/2016
+*******************************************************/
+
+#include "row0pread.h"
+#include "btr0btr.h"
+#include "btr0pcur.h"
+#include "dict0dict.h"
+#include "os0thread.h"
+#include "os0sync.h"
+#include "read0read.h"
+#include "rem0cmp.h"
+#include "row0row.h"
+#include "row0vers.h"
+#include "trx0trx.h"
+#include "ut0counter.h"
+
+/** Number of key ranges to create per thread, so that threads that
+finish early can pick up work from the slower ones */
+#define ROW_PREAD_RANGES_PER_THREAD	8
+
+/** State shared by the threads of a parallel read */
+struct row_pread_t {
+	trx_t*		trx;		/*!< transaction whose read view
+					is used */
+	dict_index_t*	index;		/*!< clustered index */
+	dtuple_t**	bounds;		/*!< n_ranges - 1 split keys in
+					ascending order; range i is
+					[bounds[i - 1], bounds[i]) */
+	ulint		n_ranges;	/*!< number of key ranges */
+	ulint		next_range;	/*!< number of ranges that have
+					been handed out to threads */
+	row_pread_func_t func;		/*!< callback for each record */
+	void*		arg;		/*!< argument of func */
+	volatile bool	abort;		/*!< set when a thread failed, to
+					stop the others */
+};
+
+/** A thread of a parallel read */
+struct row_pread_thread_t {
+	row_pread_t*	pread;		/*!< shared state */
+	ulint		thread_no;	/*!< number of this thread */
+	dberr_t		err;		/*!< result of the thread */
+	os_thread_t	thread_hdl;	/*!< thread handle */
+};
+
+/*********************************************************************//**
+Collects the node pointers of one level of the clustered index as split
+keys. If there are more than max_bounds node pointers on the level, only
+every stride'th of them is kept, doubling stride as needed.
+@return number of split keys collected */
+static
+ulint
+row_pread_collect_level(
+/*====================*/
+	dict_index_t*	index,		/*!< in: clustered index */
+	ulint		level,		/*!< in: level, > 0 */
+	ulint		max_bounds,	/*!< in: maximum number of keys */
+	dtuple_t**	bounds,		/*!< out: 2 * max_bounds keys */
+	mem_heap_t*	heap,		/*!< in/out: heap for the keys */
+	mtr_t*		mtr)		/*!< in/out: mini-transaction holding
+					an S-latch on the index */
+{
+	btr_pcur_t	pcur;
+	ulint		n_uniq	= dict_index_get_n_unique_in_tree(index);
+	ulint		n	= 0;
+	ulint		stride	= 1;
+	ulint		n_recs	= 0;
+
+	ut_ad(level > 0);
+
+	btr_pcur_open_at_index_side(
+		true, index, BTR_SEARCH_LEAF | BTR_ALREADY_S_LATCHED,
+		&pcur, true, level, mtr);
+
+	for (btr_pcur_move_to_next_user_rec(&pcur, mtr);
+	     btr_pcur_is_on_user_rec(&pcur);
+	     btr_pcur_move_to_next_user_rec(&pcur, mtr)) {
+
+		rec_t*		rec = btr_pcur_get_rec(&pcur);
+		dtuple_t*	tuple;
+
+		/* The leftmost node pointer on each level is the
+		"minimum record" and does not carry a key. */
+		if (rec_get_info_bits(rec, dict_table_is_comp(index->table))
+		    & REC_INFO_MIN_REC_FLAG) {
+			continue;
+		}
+
+		if (++n_recs % stride) {
+			continue;
+		}
+
+		tuple = dict_index_build_data_tuple(index, rec, n_uniq, heap);
+
+		for (ulint i = 0; i < n_uniq; i++) {
+			dfield_dup(dtuple_get_nth_field(tuple, i), heap);
+		}
+
+		bounds[n++] = tuple;
+
+		if (n == 2 * max_bounds) {
+			/* Keep every other key and halve the
+			sampling rate. */
+			for (ulint i = 0; i < max_bounds; i++) {
+				bounds[i] = bounds[2 * i + 1];
+			}
+
+			n = max_bounds;
+			stride *= 2;
+		}
+	}
+
+	btr_pcur_close(&pcur);
+
+	return(n);
+}
+
+/*********************************************************************//**
+Splits the clustered index into key ranges, using the highest non-leaf
+level that has enough node pointers.
+@return number of split keys in *bounds; the number of ranges is one more */
+static
+ulint
+row_pread_split(
+/*============*/
+	dict_index_t*	index,		/*!< in: clustered index */
+	ulint		n_wanted,	/*!< in: desired number of ranges */
+	dtuple_t***	bounds,		/*!< out: split keys */
+	mem_heap_t*	heap)		/*!< in/out: heap for the keys */
+{
+	mtr_t		mtr;
+	ulint		level;
+	ulint		n	= 0;
+	ulint		max_bounds = n_wanted - 1;
+
+	ut_ad(n_wanted > 1);
+
+	*bounds = static_cast<dtuple_t**>(
+		mem_heap_alloc(heap, 2 * max_bounds * sizeof **bounds));
+
+	mtr_start(&mtr);
+	mtr_s_lock(dict_index_get_lock(index), &mtr);
+
+	for (level = btr_height_get(index, &mtr); level > 0; level--) {
+
+		n = row_pread_collect_level(
+			index, level, max_bounds, *bounds, heap, &mtr);
+
+		if (n >= max_bounds) {
+			break;
+		}
+	}
+
+	mtr_commit(&mtr);
+
+	/* The stride sampling may leave up to 2 * max_bounds - 1
+	keys. Thin them out evenly. */
+	if (n > max_bounds) {
+		for (ulint i = 0; i < max_bounds; i++) {
+			(*bounds)[i] = (*bounds)[i * n / max_bounds];
+		}
+
+		n = max_bounds;
+	}
+
+	return(n);
+}
+
+/*********************************************************************//**
+Scans one key range of the clustered index and invokes the callback for
+each record that is visible in the read view.
+@return DB_SUCCESS or error code */
+static
+dberr_t
+row_pread_scan_range(
+/*=================*/
+	row_pread_t*	pread,		/*!< in/out: parallel read */
+	ulint		thread_no,	/*!< in: number of this thread */
+	const dtuple_t*	low,		/*!< in: first key of the range,
+					or NULL for the start of the index */
+	const dtuple_t*	high)		/*!< in: first key after the range,
+					or NULL for the end of the index */
+{
+	dict_index_t*	index	= pread->index;
+	trx_t*		trx	= pread->trx;
+	ibool		comp	= dict_table_is_comp(index->table);
+	btr_pcur_t	pcur;
+	page_cur_t*	cur	= btr_pcur_get_page_cur(&pcur);
+	mem_heap_t*	row_heap;
+	dberr_t		err	= DB_SUCCESS;
+	mtr_t		mtr;
+
+	row_heap = mem_heap_create(UNIV_PAGE_SIZE / 8);
+
+	mtr_start(&mtr);
+
+	/* Position the cursor before the first record of the range. */
+	if (low != NULL) {
+		btr_pcur_open(index, low, PAGE_CUR_L, BTR_SEARCH_LEAF,
+			      &pcur, &mtr);
+	} else {
+		btr_pcur_open_at_index_side(
+			true, index, BTR_SEARCH_LEAF, &pcur, true, 0, &mtr);
+	}
+
+	for (;;) {
+		const rec_t*	rec;
+		ulint*		offsets;
+
+		/* Do not continue if table pages are still encrypted */
+		if (index->table->is_encrypted) {
+			err = DB_DECRYPTION_FAILED;
+			break;
+		}
+
+		page_cur_move_to_next(cur);
+
+		if (page_cur_is_after_last(cur)) {
+			if (UNIV_UNLIKELY(trx_is_interrupted(trx))) {
+				err = DB_INTERRUPTED;
+				break;
+			}
+
+			if (pread->abort) {
+				break;
+			}
+
+			if (rw_lock_get_waiters(dict_index_get_lock(index))) {
+				/* There are waiters on the clustered
+				index tree lock. Store and restore the
+				cursor position, and yield so that
+				scanning a large table will not starve
+				other threads. */
+				btr_pcur_move_to_prev_on_page(&pcur);
+				btr_pcur_store_position(&pcur, &mtr);
+				mtr_commit(&mtr);
+
+				os_thread_yield();
+
+				mtr_start(&mtr);
+				btr_pcur_restore_position(
+					BTR_SEARCH_LEAF, &pcur, &mtr);
+
+				if (!btr_pcur_move_to_next_user_rec(
+					    &pcur, &mtr)) {
+					break;
+				}
+			} else {
+				ulint		next_page_no;
+				buf_block_t*	block;
+
+				next_page_no = btr_page_get_next(
+					page_cur_get_page(cur), &mtr);
+
+				if (next_page_no == FIL_NULL) {
+					break;
+				}
+
+				block = page_cur_get_block(cur);
+				block = btr_block_get(
+					buf_block_get_space(block),
+					buf_block_get_zip_size(block),
+					next_page_no, BTR_SEARCH_LEAF,
+					index, &mtr);
+
+				btr_leaf_page_release(page_cur_get_block(cur),
+						      BTR_SEARCH_LEAF, &mtr);
+				page_cur_set_before_first(block, cur);
+				page_cur_move_to_next(cur);
+
+				ut_ad(!page_cur_is_after_last(cur));
+			}
+		}
+
+		rec = page_cur_get_rec(cur);
+
+		SRV_CORRUPT_TABLE_CHECK(rec,
+		{
+			err = DB_CORRUPTION;
+			goto func_exit;
+		});
+
+		mem_heap_empty(row_heap);
+
+		offsets = rec_get_offsets(rec, index, NULL,
+					  ULINT_UNDEFINED, &row_heap);
+
+		if (high != NULL && cmp_dtuple_rec(high, rec, offsets) <= 0) {
+			/* The rest of the index belongs to other
+			ranges. */
+			break;
+		}
+
+		if (!read_view_sees_trx_id(
+			    trx->read_view,
+			    row_get_rec_trx_id(rec, index, offsets))) {
+			rec_t*	old_vers;
+
+			row_vers_build_for_consistent_read(
+				rec, &mtr, index, &offsets,
+				trx->read_view, &row_heap,
+				row_heap, &old_vers);
+
+			rec = old_vers;
+
+			if (!rec) {
+				continue;
+			}
+		}
+
+		if (rec_get_deleted_flag(rec, comp)) {
+			continue;
+		}
+
+		err = pread->func(thread_no, rec, offsets, pread->arg);
+
+		if (err != DB_SUCCESS) {
+			break;
+		}
+	}
+
+func_exit:
+	mtr_commit(&mtr);
+	btr_pcur_close(&pcur);
+	mem_heap_free(row_heap);
+
+	return(err);
+}
+
+/*********************************************************************//**
+Scans key ranges until all of them have been handed out or the read
+is aborted.
+@return DB_SUCCESS or error code */
+static
+dberr_t
+row_pread_scan(
+/*===========*/
+	row_pread_t*	pread,		/*!< in/out: parallel read */
+	ulint		thread_no)	/*!< in: number of this thread */
+{
+	dberr_t	err = DB_SUCCESS;
+
+	while (!pread->abort) {
+		ulint	i = os_atomic_increment_ulint(
+			&pread->next_range, 1) - 1;
+
+		if (i >= pread->n_ranges) {
+			break;
+		}
+
+		err = row_pread_scan_range(
+			pread, thread_no,
+			i > 0 ? pread->bounds[i - 1] : NULL,
+			i + 1 < pread->n_ranges ? pread->bounds[i] : NULL);
+
+		if (err != DB_SUCCESS) {
+			pread->abort = true;
+			break;
+		}
+	}
+
+	return(err);
+}
+
+/*********************************************************************//**
+Thread of a parallel read.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(row_pread_thread)(
+/*=============================*/
+	void*	arg)	/*!< in: row_pread_thread_t */
+{
+	row_pread_thread_t*	thr = static_cast<row_pread_thread_t*>(arg);
+
+	thr->err = row_pread_scan(thr->pread, thr->thread_no);
+
+	os_thread_exit(NULL, false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*********************************************************************//**
+Scans the clustered index in the read view of trx, splitting the index
+into key ranges that are scanned by up to n_threads threads. The
+calling thread is one of the scanning threads. Delete-marked records and
+records that are not visible in the read view are skipped.
+@return DB_SUCCESS, DB_INTERRUPTED, or the first error returned by
+func or by the scan */
+UNIV_INTERN
+dberr_t
+row_pread_clust_index(
+/*==================*/
+	trx_t*		trx,		/*!< in: transaction with a
+					read view */
+	dict_index_t*	index,		/*!< in: clustered index */
+	ulint		n_threads,	/*!< in: maximum number of threads */
+	row_pread_func_t func,		/*!< in: callback for each record */
+	void*		arg,		/*!< in/out: argument of func */
+	ulint*		n_threads_used)	/*!< out: number of threads that
+					were used, or NULL; func is called
+					with thread_no < *n_threads_used */
+{
+	row_pread_t		pread;
+	row_pread_thread_t*	thr;
+	mem_heap_t*		heap;
+	dberr_t			err;
+
+	ut_ad(dict_index_is_clust(index));
+	ut_ad(trx->read_view != NULL);
+
+	n_threads = ut_min(ut_max(n_threads, 1),
+			   (ulint) ROW_PREAD_MAX_THREADS);
+
+	heap = mem_heap_create(1024);
+
+	memset(&pread, 0, sizeof pread);
+	pread.trx = trx;
+	pread.index = index;
+	pread.func = func;
+	pread.arg = arg;
+	pread.n_ranges = 1;
+
+	if (n_threads > 1) {
+		pread.n_ranges = 1 + row_pread_split(
+			index, n_threads * ROW_PREAD_RANGES_PER_THREAD,
+			&pread.bounds, heap);
+
+		/* A small index may not have enough node pointers. */
+		n_threads = ut_min(n_threads, pread.n_ranges);
+	}
+
+	if (n_threads_used != NULL) {
+		*n_threads_used = n_threads;
+	}
+
+	thr = static_cast<row_pread_thread_t*>(
+		mem_heap_zalloc(heap, n_threads * sizeof *thr));
+
+	for (ulint i = 1; i < n_threads; i++) {
+		os_thread_id_t	thread_id;
+
+		thr[i].pread = &pread;
+		thr[i].thread_no = i;
+		thr[i].thread_hdl = os_thread_create(
+			row_pread_thread, &thr[i], &thread_id);
+	}
+
+	err = row_pread_scan(&pread, 0);
+
+	for (ulint i = 1; i < n_threads; i++) {
+		os_thread_join(thr[i].thread_hdl);
+
+		if (err == DB_SUCCESS) {
+			err = thr[i].err;
+		}
+	}
+
+	mem_heap_free(heap);
+
+	return(err);
+}
+
+/** State of row_pread_count() for one thread, padded to a cache line
+so that the threads do not share the counters */
+struct row_pread_count_slot_t {
+	ulint		n_rows;		/*!< number of records seen */
+	dtuple_t*	prev_entry;	/*!< previous record, or NULL */
+	mem_heap_t*	heap;		/*!< heap for prev_entry */
+	byte		pad[CACHE_LINE_SIZE];
+};
+
+/** Arguments of row_pread_count_rec() */
+struct row_pread_count_t {
+	trx_t*		trx;		/*!< transaction */
+	dict_index_t*	index;		/*!< clustered index */
+	bool		check;		/*!< whether to check the order */
+	bool		is_ok;		/*!< false if corruption was found */
+	row_pread_count_slot_t*	slots;	/*!< per-thread state */
+};
+
+/*********************************************************************//**
+Counts a record and optionally checks that it is greater than the
+previous record seen by the same thread.
+@return DB_SUCCESS */
+static
+dberr_t
+row_pread_count_rec(
+/*================*/
+	ulint		thread_no,	/*!< in: thread number */
+	const rec_t*	rec,		/*!< in: record */
+	const ulint*	offsets,	/*!< in: rec_get_offsets(rec) */
+	void*		arg)		/*!< in/out: row_pread_count_t */
+{
+	row_pread_count_t*	count = static_cast<row_pread_count_t*>(arg);
+	row_pread_count_slot_t*	slot = &count->slots[thread_no];
+
+	slot->n_rows++;
+
+	if (!count->check) {
+		return(DB_SUCCESS);
+	}
+
+	if (slot->prev_entry != NULL) {
+		ulint	matched_fields = 0;
+		ulint	matched_bytes = 0;
+		int	cmp;
+
+		cmp = cmp_dtuple_rec_with_match(slot->prev_entry, rec,
+						offsets, &matched_fields,
+						&matched_bytes);
+
+		if (cmp > 0) {
+			fputs("InnoDB: index records in a wrong order in ",
+			      stderr);
+not_ok:
+			dict_index_name_print(stderr, count->trx,
+					      count->index);
+			fputs("\n"
+			      "InnoDB: prev record ", stderr);
+			dtuple_print(stderr, slot->prev_entry);
+			fputs("\n"
+			      "InnoDB: record ", stderr);
+			rec_print_new(stderr, rec, offsets);
+			putc('\n', stderr);
+			count->is_ok = false;
+		} else if (matched_fields
+			   >= dict_index_get_n_ordering_defined_by_user(
+				   count->index)) {
+
+			fputs("InnoDB: duplicate key in ", stderr);
+			goto not_ok;
+		}
+	}
+
+	ulint	n_ext;
+
+	mem_heap_empty(slot->heap);
+
+	slot->prev_entry = row_rec_to_index_entry(
+		rec, count->index, offsets, &n_ext, slot->heap);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Counts the records of the clustered index that are visible in the read
+view of trx, using up to n_threads threads. If check is set, also checks
+that the records of each range are in ascending order and that no key
+is duplicated, like row_check_index_for_mysql() does.
+@return DB_SUCCESS, DB_INTERRUPTED or error code */
+UNIV_INTERN
+dberr_t
+row_pread_count(
+/*============*/
+	trx_t*		trx,		/*!< in: transaction with a
+					read view */
+	dict_index_t*	index,		/*!< in: clustered index */
+	ulint		n_threads,	/*!< in: maximum number of threads */
+	bool		check,		/*!< in: whether to check the
+					order of the records */
+	ulint*		n_rows,		/*!< out: number of records */
+	bool*		is_ok)		/*!< out: false if check was set
+					and the index is corrupted, or NULL */
+{
+	row_pread_count_t	count;
+	dberr_t			err;
+
+	n_threads = ut_min(ut_max(n_threads, 1),
+			   (ulint) ROW_PREAD_MAX_THREADS);
+
+	count.trx = trx;
+	count.index = index;
+	count.check = check;
+	count.is_ok = true;
+	count.slots = static_cast<row_pread_count_slot_t*>(
+		mem_zalloc(n_threads * sizeof *count.slots));
+
+	if (check) {
+		for (ulint i = 0; i < n_threads; i++) {
+			count.slots[i].heap = mem_heap_create(100);
+		}
+	}
+
+	err = row_pread_clust_index(trx, index, n_threads,
+				    row_pread_count_rec, &count, NULL);
+
+	*n_rows = 0;
+
+	for (ulint i = 0; i < n_threads; i++) {
+		*n_rows += count.slots[i].n_rows;
+
+		if (count.slots[i].heap != NULL) {
+			mem_heap_free(count.slots[i].heap);
+		}
+	}
+
+	mem_free(count.slots);
+
+	if (is_ok != NULL) {
+		*is_ok = count.is_ok;
+	}
+
+	return(err);
+}
@@ -787,6 +787,12 @@ row_purge_parse_undo_rec(
 		goto err_exit;
 	}
 
+	node->table->purge_n_recs++;
+
+	if (node->trx_no > node->table->purge_trx_no) {
+		node->table->purge_trx_no = node->trx_no;
+	}
+
 	clust_index = dict_table_get_first_index(node->table);
 
 	if (clust_index == NULL) {
@@ -990,6 +996,7 @@ row_purge_step(
 			ib_vector_pop(node->undo_recs));
 
 		node->roll_ptr = purge_rec->roll_ptr;
+		node->trx_no = purge_rec->trx_no;
 
 		row_purge(node, purge_rec->undo_rec, thr);
 
@@ -3228,6 +3228,33 @@ row_sel_get_clust_rec_for_mysql(
 	return(err);
 }
 
+/********************************************************************//**
+Determines the latch mode for restoring the cursor position of a scan.
+Once a forward scan has entered the leaf pages that were read ahead the
+last time, the restoration searches the tree again, reading ahead the
+leaf pages that follow the cursor position in the parent page.
+@return BTR_SEARCH_LEAF, possibly ORed with BTR_READ_AHEAD */
+static
+ulint
+row_sel_restore_latch_mode(
+/*=======================*/
+	row_prebuilt_t*	prebuilt,	/*!< in/out: prebuilt struct */
+	ibool		moves_up)	/*!< in: TRUE if the scan moves
+					forward */
+{
+	ulint	n_pages = srv_scan_read_ahead_pages;
+
+	if (!moves_up || n_pages == 0 || prebuilt->read_ahead_countdown) {
+		return(BTR_SEARCH_LEAF);
+	}
+
+	/* Read ahead again when the scan has consumed half of the
+	pages that will be read ahead now. */
+	prebuilt->read_ahead_countdown = ut_max(n_pages / 2, 1);
+
+	return(BTR_SEARCH_LEAF | BTR_READ_AHEAD);
+}
+
 /********************************************************************//**
 Restores cursor position after it has been stored. We have to take into
 account that the record cursor was positioned on may have been deleted.
@@ -3819,6 +3846,9 @@ row_search_for_mysql(
 		prebuilt->n_rows_fetched = 0;
 		prebuilt->n_fetch_cached = 0;
 		prebuilt->fetch_cache_first = 0;
+		/* Only read ahead once the scan proves to span more
+		than one leaf page. */
+		prebuilt->read_ahead_countdown = 1;
 
 		if (prebuilt->sel_graph == NULL) {
 			/* Build a dummy select query graph */
@@ -4134,7 +4164,8 @@ row_search_for_mysql(
 
 	if (UNIV_LIKELY(direction != 0)) {
 		ibool	need_to_process = sel_restore_position_for_mysql(
-			&same_user_rec, BTR_SEARCH_LEAF,
+			&same_user_rec,
+			row_sel_restore_latch_mode(prebuilt, moves_up),
 			pcur, moves_up, &mtr);
 
 		if (UNIV_UNLIKELY(need_to_process)) {
@@ -5133,9 +5164,10 @@ row_search_for_mysql(
 		mtr_has_extra_clust_latch = FALSE;
 
 		mtr_start_trx(&mtr, trx);
-		if (sel_restore_position_for_mysql(&same_user_rec,
-						   BTR_SEARCH_LEAF,
-						   pcur, moves_up, &mtr)) {
+		if (sel_restore_position_for_mysql(
+			    &same_user_rec,
+			    row_sel_restore_latch_mode(prebuilt, moves_up),
+			    pcur, moves_up, &mtr)) {
 #ifdef UNIV_SEARCH_DEBUG
 			cnt++;
 #endif /* UNIV_SEARCH_DEBUG */
@@ -5145,6 +5177,12 @@ row_search_for_mysql(
 	}
 
 	if (moves_up) {
+		if (btr_pcur_is_after_last_on_page(pcur)
+		    && prebuilt->read_ahead_countdown > 0) {
+			/* We are about to enter the next leaf page */
+			prebuilt->read_ahead_countdown--;
+		}
+
 		if (UNIV_UNLIKELY(!btr_pcur_move_to_next(pcur, &mtr))) {
 not_moved:
 			btr_pcur_store_position(pcur, &mtr);
@@ -2069,7 +2069,13 @@ row_upd_sec_step(
 	if (node->state == UPD_NODE_UPDATE_ALL_SEC
 	    || row_upd_changes_ord_field_binary(node->index, node->update,
 						thr, node->row, node->ext)) {
-		return(row_upd_sec_index_entry(node, thr));
+		dberr_t	err = row_upd_sec_index_entry(node, thr);
+
+		if (err == DB_SUCCESS) {
+			node->index->stat_modified_counter++;
+		}
+
+		return(err);
 	}
 
 	return(DB_SUCCESS);
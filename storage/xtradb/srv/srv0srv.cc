@@ -112,6 +112,8 @@ UNIV_INTERN ibool	srv_error_monitor_active = FALSE;
 
 UNIV_INTERN ibool	srv_buf_dump_thread_active = FALSE;
 
+UNIV_INTERN ibool	srv_buf_resize_thread_active = FALSE;
+
 UNIV_INTERN ibool	srv_dict_stats_thread_active = FALSE;
 
 UNIV_INTERN ibool	srv_log_scrub_active = FALSE;
@@ -141,6 +143,16 @@ UNIV_INTERN ulint	srv_undo_tablespaces_open = 8;
 /* The number of rollback segments to use */
 UNIV_INTERN ulong	srv_undo_logs = 1;
 
+/** Whether to truncate undo tablespaces that exceed srv_max_undo_log_size */
+UNIV_INTERN my_bool	srv_undo_log_truncate = FALSE;
+
+/** Size of an undo tablespace in bytes above which it is truncated */
+UNIV_INTERN unsigned long long	srv_max_undo_log_size;
+
+/** Every this many purge batches, the history list is truncated and the
+undo tablespaces are checked for truncation */
+UNIV_INTERN ulong	srv_purge_rseg_truncate_frequency = 128;
+
 #ifdef UNIV_LOG_ARCHIVE
 UNIV_INTERN char*	srv_arch_dir	= NULL;
 UNIV_INTERN ulong	srv_log_arch_expire_sec	= 0;
@@ -172,6 +184,9 @@ on duplicate key checking and foreign key checking */
 UNIV_INTERN ibool	srv_locks_unsafe_for_binlog = FALSE;
 /** Sort buffer size in index creation */
 UNIV_INTERN ulong	srv_sort_buf_size = 1048576;
+/** Percentage of each B-tree page to fill when building an index
+with the bulk loader */
+UNIV_INTERN ulong	srv_fill_factor = 100;
 /** Maximum modification log file size for online index creation */
 UNIV_INTERN unsigned long long	srv_online_max_size;
 
@@ -181,6 +196,9 @@ use simulated aio we build below with threads.
 Currently we support native aio on windows and linux */
 UNIV_INTERN my_bool	srv_use_native_aio = TRUE;
 UNIV_INTERN my_bool	srv_numa_interleave = FALSE;
+/* If this flag is TRUE, each buffer pool instance is placed on a NUMA
+node of its own, and the threads that flush it run on that node. */
+UNIV_INTERN my_bool	srv_numa_bind = FALSE;
 
 /* Default compression level if page compression is used and no compression
 level is set for the table*/
@@ -291,6 +309,8 @@ UNIV_INTERN my_bool	srv_use_sys_malloc	= TRUE;
 UNIV_INTERN ulint	srv_buf_pool_size	= ULINT_MAX;
 /* requested number of buffer pool instances */
 UNIV_INTERN ulint       srv_buf_pool_instances  = 1;
+/* size of a buffer pool chunk in bytes */
+UNIV_INTERN ulong	srv_buf_pool_chunk_unit;
 /* number of locks to protect buf_pool->page_hash */
 UNIV_INTERN ulong	srv_n_page_hash_locks = 16;
 /** Scan depth for LRU flush batch i.e.: number of blocks scanned*/
@@ -354,6 +374,9 @@ UNIV_INTERN ulong	srv_cleaner_lsn_age_factor
 UNIV_INTERN ulong	srv_empty_free_list_algorithm
 	= SRV_EMPTY_FREE_LIST_BACKOFF;
 
+/** Buffer pool replacement policy */
+UNIV_INTERN ulong	srv_lru_algorithm = SRV_LRU_ALGORITHM_MIDPOINT;
+
 UNIV_INTERN ulong	srv_idle_flush_pct = 100;
 
 /* This parameter is deprecated. Use srv_n_io_[read|write]_threads
@@ -373,6 +396,15 @@ in the buffer cache and accessed sequentially for InnoDB to trigger a
 readahead request. */
 UNIV_INTERN ulong	srv_read_ahead_threshold	= 56;
 
+/* Maximum number of leaf pages that a forward index scan reads ahead
+from the node pointers of the parent page; 0 disables the scan
+read-ahead. */
+UNIV_INTERN ulong	srv_scan_read_ahead_pages	= 0;
+
+/* Number of threads that scan the clustered index in parallel for
+SELECT COUNT(*) and CHECK TABLE; 0 disables the parallel read. */
+UNIV_INTERN ulong	srv_parallel_read_threads	= 0;
+
 #ifdef UNIV_LOG_ARCHIVE
 UNIV_INTERN ibool		srv_log_archive_on	= FALSE;
 #endif /* UNIV_LOG_ARCHIVE */
@@ -458,6 +490,9 @@ UNIV_INTERN my_bool	srv_master_thread_priority	= FALSE;
 /* The number of purge threads to use.*/
 UNIV_INTERN ulong	srv_n_purge_threads = 1;
 
+/* The number of purge threads used for the latest purge batch */
+UNIV_INTERN ulint	srv_n_purge_threads_active = 0;
+
 /* the number of pages to purge in one batch */
 UNIV_INTERN ulong	srv_purge_batch_size = 20;
 
@@ -524,6 +559,18 @@ UNIV_INTERN unsigned long long srv_stats_modified_counter = 0;
 pages default true. */
 UNIV_INTERN my_bool	srv_stats_sample_traditional = TRUE;
 
+/* Number of threads of the background recalculation of persistent
+statistics */
+UNIV_INTERN ulong	srv_stats_recalc_threads = 1;
+
+/* Maximum number of index pages per second that the background
+recalculation of persistent statistics may read (0 = no limit) */
+UNIV_INTERN ulong	srv_stats_recalc_io_budget = 0;
+
+/* Whether the background recalculation of persistent statistics skips
+the secondary indexes that changed little since they were analyzed */
+UNIV_INTERN my_bool	srv_stats_recalc_incremental = TRUE;
+
 UNIV_INTERN ibool	srv_use_doublewrite_buf	= TRUE;
 
 /** doublewrite buffer is 1MB is size i.e.: it can hold 128 16K pages.
@@ -532,6 +579,15 @@ batch flushing i.e.: LRU flushing and flush_list flushing. The rest
 of the pages are used for single page flushing. */
 UNIV_INTERN ulong	srv_doublewrite_batch_size	= 120;
 
+/** Path of the parallel doublewrite file, relative to the data home
+directory unless absolute. If empty, LRU and flush list batches use the
+doublewrite buffer in the system tablespace. */
+UNIV_INTERN char*	srv_parallel_doublewrite_path	= NULL;
+
+/** Number of pages in each shard of the parallel doublewrite file, i.e.
+the largest batch that is written to it with a single write and fsync */
+UNIV_INTERN ulong	srv_parallel_doublewrite_batch_size	= 120;
+
 UNIV_INTERN ulong	srv_replication_delay		= 0;
 
 UNIV_INTERN ulong	srv_pass_corrupt_table = 0; /* 0:disable 1:enable */
@@ -568,6 +624,7 @@ static ulint		srv_n_system_rows_read_old	= 0;
 
 UNIV_INTERN ulint	srv_truncated_status_writes	= 0;
 UNIV_INTERN ulint	srv_available_undo_logs         = 0;
+UNIV_INTERN ulint	srv_undo_truncations		= 0;
 
 UNIV_INTERN ib_uint64_t srv_page_compression_saved      = 0;
 UNIV_INTERN ib_uint64_t srv_page_compression_trim_sect512       = 0;
@@ -833,6 +890,9 @@ UNIV_INTERN os_event_t	srv_error_event;
 /** Event to signal the buffer pool dump/load thread */
 UNIV_INTERN os_event_t	srv_buf_dump_event;
 
+/** Event to signal the buffer pool resize thread */
+UNIV_INTERN os_event_t	srv_buf_resize_event;
+
 /** The buffer pool dump/load file name */
 UNIV_INTERN char*	srv_buf_dump_filename;
 
@@ -841,6 +901,12 @@ and/or load it during startup. */
 UNIV_INTERN char	srv_buffer_pool_dump_at_shutdown = FALSE;
 UNIV_INTERN char	srv_buffer_pool_load_at_startup = FALSE;
 
+/** Seconds between periodic buffer pool dumps, 0 if disabled */
+UNIV_INTERN ulong	srv_buf_dump_interval = 0;
+
+/** Number of threads that issue the reads of a buffer pool load */
+UNIV_INTERN ulong	srv_buf_load_threads = 4;
+
 /** Slot index in the srv_sys->sys_threads array for the purge thread. */
 static const ulint	SRV_PURGE_SLOT	= 1;
 
@@ -1206,6 +1272,8 @@ srv_init(void)
 
 		srv_buf_dump_event = os_event_create();
 
+		srv_buf_resize_event = os_event_create();
+
 		srv_checkpoint_completed_event = os_event_create();
 
 		srv_redo_log_tracked_event = os_event_create();
@@ -1268,6 +1336,7 @@ srv_free(void)
 		os_event_free(srv_error_event);
 		os_event_free(srv_monitor_event);
 		os_event_free(srv_buf_dump_event);
+		os_event_free(srv_buf_resize_event);
 		os_event_free(srv_checkpoint_completed_event);
 		os_event_free(srv_redo_log_tracked_event);
 		mutex_free(&srv_sys->mutex);
@@ -1807,6 +1876,9 @@ srv_export_innodb_status(void)
 
 	export_vars.innodb_buffer_pool_read_requests = stat.n_page_gets;
 
+	export_vars.innodb_buffer_pool_read_requests_remote
+		= stat.n_page_gets_remote;
+
 	export_vars.innodb_buffer_pool_write_requests =
 		srv_stats.buf_pool_write_requests;
 
@@ -1922,6 +1994,7 @@ srv_export_innodb_status(void)
 	export_vars.innodb_oldest_view_low_limit_trx_id
 		= oldest_view ? oldest_view->low_limit_id : 0;
 
+	export_vars.innodb_purge_threads_active = srv_n_purge_threads_active;
 	export_vars.innodb_purge_trx_id = purge_sys->limit.trx_no;
 	export_vars.innodb_purge_undo_no = purge_sys->limit.undo_no;
 	export_vars.innodb_current_row_locks
@@ -2006,6 +2079,7 @@ srv_export_innodb_status(void)
 		srv_truncated_status_writes;
 
 	export_vars.innodb_available_undo_logs = srv_available_undo_logs;
+	export_vars.innodb_undo_truncations = srv_undo_truncations;
 	export_vars.innodb_read_views_memory
 		= os_atomic_increment_ulint(&srv_read_views_memory, 0);
 	export_vars.innodb_descriptors_memory
@@ -2506,6 +2580,8 @@ srv_any_background_threads_are_active(void)
 		thread_active = "srv_monitor_thread";
 	} else if (srv_buf_dump_thread_active) {
 		thread_active = "buf_dump_thread";
+	} else if (srv_buf_resize_thread_active) {
+		thread_active = "buf_resize_thread";
 	} else if (srv_dict_stats_thread_active) {
 		thread_active = "dict_stats_thread";
 	} else if (srv_scrub_log && srv_log_scrub_thread_active) {
@@ -2515,6 +2591,7 @@ srv_any_background_threads_are_active(void)
 	os_event_set(srv_error_event);
 	os_event_set(srv_monitor_event);
 	os_event_set(srv_buf_dump_event);
+	os_event_set(srv_buf_resize_event);
 	os_event_set(lock_sys->timeout_event);
 	os_event_set(dict_stats_event);
 	if (srv_scrub_log)
@@ -3432,6 +3509,11 @@ DECLARE_THREAD(srv_worker_thread)(
 	OS_THREAD_DUMMY_RETURN;	/* Not reached, avoid compiler warning */
 }
 
+/** Length of the history list that one purge thread is expected to keep
+up with. srv_do_purge() uses at least one more purge thread for each
+multiple of this. */
+static const ulint	SRV_PURGE_HISTORY_PER_THREAD = 10000;
+
 /*********************************************************************//**
 Do the actual purge operation.
 @return length of history list before the last purge batch. */
@@ -3442,7 +3524,8 @@ srv_do_purge(
 	ulint		n_threads,	/*!< in: number of threads to use */
 	ulint*		n_total_purged)	/*!< in/out: total pages purged */
 {
-	ulint		n_pages_purged;
+	ulint		n_pages_purged = 0;
+	bool		truncate = false;
 
 	static ulint	count = 0;
 	static ulint	n_use_threads = 0;
@@ -3465,6 +3548,16 @@ srv_do_purge(
 	do {
 		srv_current_thread_priority = srv_purge_thread_priority;
 
+		/* Use at least one thread for each
+		SRV_PURGE_HISTORY_PER_THREAD transactions in the history
+		list, so that a large backlog is attacked with all the
+		threads at once instead of adding them one batch at a
+		time. */
+		ulint	n_min_threads = ut_min(
+			n_threads,
+			1 + trx_sys->rseg_history_len
+			/ SRV_PURGE_HISTORY_PER_THREAD);
+
 		if (trx_sys->rseg_history_len > rseg_history_len
 		    || (srv_max_purge_lag > 0
 			&& rseg_history_len > srv_max_purge_lag)) {
@@ -3477,7 +3570,7 @@ srv_do_purge(
 			}
 
 		} else if (srv_check_activity(old_activity_count)
-			   && n_use_threads > 1) {
+			   && n_use_threads > n_min_threads) {
 
 			/* History length same or smaller since last snapshot,
 			use fewer threads. */
@@ -3487,6 +3580,12 @@ srv_do_purge(
 			old_activity_count = srv_get_activity_count();
 		}
 
+		if (n_use_threads < n_min_threads) {
+			n_use_threads = n_min_threads;
+		}
+
+		srv_n_purge_threads_active = n_use_threads;
+
 		/* Ensure that the purge threads are less than what
 		was configured. */
 
@@ -3498,9 +3597,10 @@ srv_do_purge(
 			break;
 		}
 
+		truncate = (++count % srv_purge_rseg_truncate_frequency) == 0;
+
 		n_pages_purged = trx_purge(
-			n_use_threads, srv_purge_batch_size,
-			(++count % TRX_SYS_N_RSEGS) == 0);
+			n_use_threads, srv_purge_batch_size, truncate);
 
 		*n_total_purged += n_pages_purged;
 
@@ -3508,6 +3608,20 @@ srv_do_purge(
 		 && n_pages_purged > 0
 		 && purge_sys->state == PURGE_STATE_RUN);
 
+	/* Purge has caught up. Free the history that it has processed,
+	so that an undo tablespace can be truncated while the server is
+	idle. */
+
+	if (rseg_history_len > 0
+	    && n_pages_purged == 0
+	    && !truncate
+	    && srv_undo_log_truncate
+	    && purge_sys->state == PURGE_STATE_RUN
+	    && !srv_purge_should_exit(n_pages_purged)) {
+
+		trx_purge(n_use_threads, srv_purge_batch_size, true);
+	}
+
 	return(rseg_history_len);
 }
 
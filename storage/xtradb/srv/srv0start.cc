@@ -161,6 +161,7 @@ void *mtflush_ctx=NULL;
 static os_thread_t	thread_handles[SRV_MAX_N_IO_THREADS + 7 + SRV_MAX_N_PURGE_THREADS];
 static os_thread_t	buf_flush_page_cleaner_thread_handle;
 static os_thread_t	buf_dump_thread_handle;
+static os_thread_t	buf_resize_thread_handle;
 static os_thread_t	dict_stats_thread_handle;
 static os_thread_t	buf_flush_lru_manager_thread_handle;
 static os_thread_t	srv_redo_log_follow_thread_handle;
@@ -168,6 +169,7 @@ static os_thread_t	srv_redo_log_follow_thread_handle;
 static bool		thread_started[SRV_MAX_N_IO_THREADS + 7 + SRV_MAX_N_PURGE_THREADS] = {false};
 static bool		buf_flush_page_cleaner_thread_started = false;
 static bool		buf_dump_thread_started = false;
+static bool		buf_resize_thread_started = false;
 static bool		dict_stats_thread_started = false;
 static bool		buf_flush_lru_manager_thread_started = false;
 static bool		srv_redo_log_follow_thread_started = false;
@@ -180,10 +182,6 @@ static os_fast_mutex_t	srv_os_test_mutex;
 static char*	srv_monitor_file_name;
 #endif /* !UNIV_HOTBACKUP */
 
-/** Default undo tablespace size in UNIV_PAGEs count (10MB). */
-static const ulint SRV_UNDO_TABLESPACE_SIZE_IN_PAGES =
-	((1024 * 1024) * 10) / UNIV_PAGE_SIZE_DEF;
-
 /** */
 #define SRV_N_PENDING_IOS_PER_THREAD	OS_AIO_N_PENDING_IOS_PER_THREAD
 #define SRV_MAX_N_PENDING_SYNC_IOS	100
@@ -1460,6 +1458,16 @@ srv_undo_tablespaces_init(
 		ut_a(undo_tablespace_ids[i] != 0);
 		ut_a(undo_tablespace_ids[i] != ULINT_UNDEFINED);
 
+		/* Complete a truncation that was interrupted by a crash
+		before the file is opened, because its size is read
+		from the file. */
+
+		if (!trx_purge_undo_trunc_recover(
+			    name, undo_tablespace_ids[i])) {
+
+			return(DB_ERROR);
+		}
+
 		/* Undo space ids start from 1. */
 
 		err = srv_undo_tablespace_open(name, undo_tablespace_ids[i]);
@@ -1944,6 +1952,7 @@ innobase_start_or_create_for_mysql(void)
 			    + 1 /* srv_redo_log_follow_thread */
 			    + 1 /* srv_purge_coordinator_thread */
 			    + 1 /* buf_dump_thread */
+			    + 1 /* buf_resize_thread */
 			    + 1 /* dict_stats_thread */
 			    + 1 /* fts_optimize_thread */
 			    + 1 /* recv_writer_thread */
@@ -2085,6 +2094,23 @@ innobase_start_or_create_for_mysql(void)
 
 	fil_init(srv_file_per_table ? 50000 : 5000, srv_max_n_open_files);
 
+	/* Each buffer pool instance consists of whole chunks, so that
+	it can be grown and shrunk online one chunk at a time. */
+	if (srv_buf_pool_chunk_unit * srv_buf_pool_instances
+	    > srv_buf_pool_size) {
+		srv_buf_pool_chunk_unit = static_cast<ulong>(ut_max(
+			ut_2pow_round(srv_buf_pool_size
+				      / srv_buf_pool_instances,
+				      1024 * 1024),
+			1024 * 1024));
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Adjusting innodb_buffer_pool_chunk_size to %lu",
+			(ulong) srv_buf_pool_chunk_unit);
+	}
+
+	srv_buf_pool_size = buf_pool_size_align(srv_buf_pool_size);
+
 	double	size;
 	char	unit;
 
@@ -2543,6 +2569,11 @@ innobase_start_or_create_for_mysql(void)
 			return(err);
 		}
 
+		/* Re-create the rollback segment headers of the undo
+		tablespaces whose truncation was interrupted. */
+
+		trx_purge_undo_trunc_fixup();
+
 		ib_bh = trx_sys_init_at_db_start();
 		n_recovered_trx = UT_LIST_GET_LEN(trx_sys->rw_trx_list);
 
@@ -2556,6 +2587,8 @@ innobase_start_or_create_for_mysql(void)
 
 		recv_recovery_from_checkpoint_finish();
 
+		trx_purge_undo_trunc_fixup_done();
+
 		if (srv_force_recovery < SRV_FORCE_NO_IBUF_MERGE) {
 			/* The following call is necessary for the insert
 			buffer to work with multiple tablespaces. We must
@@ -2744,6 +2777,12 @@ innobase_start_or_create_for_mysql(void)
 		buf_dblwr_create();
 	}
 
+	err = buf_parallel_dblwr_create();
+
+	if (err != DB_SUCCESS) {
+		return(err);
+	}
+
 	/* Here the double write buffer has already been created and so
 	any new rollback segments will be allocated after the double
 	write buffer. The default segment should already exist.
@@ -3047,6 +3086,11 @@ innobase_start_or_create_for_mysql(void)
 		buf_dump_thread_handle=
 			os_thread_create(buf_dump_thread, NULL, NULL);
 		buf_dump_thread_started = true;
+
+		/* Create the buffer pool resize thread */
+		buf_resize_thread_handle=
+			os_thread_create(buf_resize_thread, NULL, NULL);
+		buf_resize_thread_started = true;
 #ifdef WITH_WSREP
 		} else {
 			ib_logf(IB_LOG_LEVEL_WARN,
@@ -3279,6 +3323,10 @@ innobase_shutdown_for_mysql(void)
 			CloseHandle(buf_dump_thread_handle);
 		}
 
+		if (buf_resize_thread_started) {
+			CloseHandle(buf_resize_thread_handle);
+		}
+
 		if (dict_stats_thread_started) {
 			CloseHandle(dict_stats_thread_handle);
 		}
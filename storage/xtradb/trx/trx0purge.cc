@@ -45,6 +45,10 @@ Created 3/26/1996 Heikki Tuuri
 #include "os0thread.h"
 #include "srv0mon.h"
 #include "mtr0log.h"
+#include "buf0lru.h"
+#include "log0log.h"
+
+#include <map>
 
 /** Maximum allowable purge history length.  <=0 means 'infinite'. */
 UNIV_INTERN ulong		srv_max_purge_lag = 0;
@@ -133,6 +137,8 @@ trx_purge_sys_create(
 
 	purge_sys->heap = mem_heap_create(256);
 
+	purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+
 	ut_a(n_purge_threads > 0);
 
 	purge_sys->sess = sess_open();
@@ -960,7 +966,44 @@ trx_purge_fetch_next_rec(
 }
 
 /*******************************************************************//**
-This function runs a purge batch.
+Finds the purge node that has been assigned the fewest undo log records in
+the current batch.
+@return purge node */
+static
+purge_node_t*
+trx_purge_least_loaded_node(
+/*========================*/
+	trx_purge_t*	purge_sys,	/*!< in: purge instance */
+	ulint		n_purge_threads)/*!< in: number of purge threads */
+{
+	purge_node_t*	best = NULL;
+	ulint		best_n_recs = ULINT_UNDEFINED;
+	que_thr_t*	thr = UT_LIST_GET_FIRST(purge_sys->query->thrs);
+
+	for (ulint i = 0; i < n_purge_threads; ++i) {
+		purge_node_t*	node = static_cast<purge_node_t*>(thr->child);
+		ulint		n_recs = node->undo_recs == NULL
+			? 0 : ib_vector_size(node->undo_recs);
+
+		if (n_recs < best_n_recs) {
+			best = node;
+			best_n_recs = n_recs;
+		}
+
+		thr = UT_LIST_GET_NEXT(thrs, thr);
+	}
+
+	return(best);
+}
+
+/** Purge nodes that the tables of a purge batch have been assigned to */
+typedef std::map<table_id_t, purge_node_t*>	purge_table_map_t;
+
+/*******************************************************************//**
+Fetches the undo log records of a purge batch and distributes them to the
+purge nodes. All records of a table are assigned to the same node, so that
+the purge threads do not contend for the pages of the same indexes. Each
+new table goes to the node that has been assigned the fewest records.
 @return	number of undo log pages handled in the batch */
 static
 ulint
@@ -971,10 +1014,11 @@ trx_purge_attach_undo_recs(
 	purge_iter_t*	limit,		/*!< out: records read up to */
 	ulint		batch_size)	/*!< in: no. of pages to purge */
 {
-	que_thr_t*	thr;
-	ulint		i = 0;
-	ulint		n_pages_handled = 0;
-	ulint		n_thrs = UT_LIST_GET_LEN(purge_sys->query->thrs);
+	que_thr_t*		thr;
+	ulint			i = 0;
+	ulint			n_pages_handled = 0;
+	ulint			n_thrs = UT_LIST_GET_LEN(purge_sys->query->thrs);
+	purge_table_map_t	table_map;
 
 	ut_a(n_purge_threads > 0);
 
@@ -1001,27 +1045,24 @@ trx_purge_attach_undo_recs(
 	however is allowed because we only use purge threads as needed. */
 	ut_a(i == n_purge_threads);
 
-	/* Fetch and parse the UNDO records. The UNDO records are added
-	to a per purge node vector. */
-	thr = UT_LIST_GET_FIRST(purge_sys->query->thrs);
-	ut_a(n_thrs > 0 && thr != NULL);
+	ut_a(n_thrs > 0);
 
 	ut_ad(trx_purge_check_limit());
 
-	i = 0;
+	/* Fetch and parse the UNDO records. The UNDO records are added
+	to a per purge node vector. The copies of the records are
+	allocated from purge_sys->heap, which is emptied at the start of
+	the next batch, because the node of a record is only known after
+	the record has been read. */
 
 	for (;;) {
 		purge_node_t*		node;
-		trx_purge_rec_t*	purge_rec;
-
-		ut_a(!thr->is_active);
-
-		/* Get the purge node. */
-		node = (purge_node_t*) thr->child;
-		ut_a(que_node_get_type(node) == QUE_NODE_PURGE);
-
-		purge_rec = static_cast<trx_purge_rec_t*>(
-			mem_heap_zalloc(node->heap, sizeof(*purge_rec)));
+		trx_purge_rec_t		purge_rec;
+		ulint			type;
+		ulint			cmpl_info;
+		bool			updated_extern;
+		undo_no_t		undo_no;
+		table_id_t		table_id;
 
 		/* Track the max {trx_id, undo_no} for truncating the
 		UNDO logs once we have purged the records. */
@@ -1033,38 +1074,48 @@ trx_purge_attach_undo_recs(
 			*limit = purge_sys->iter;
 		}
 
+		purge_rec.trx_no = purge_sys->iter.trx_no;
+
 		/* Fetch the next record, and advance the purge_sys->iter. */
-		purge_rec->undo_rec = trx_purge_fetch_next_rec(
-			&purge_rec->roll_ptr, &n_pages_handled, node->heap);
+		purge_rec.undo_rec = trx_purge_fetch_next_rec(
+			&purge_rec.roll_ptr, &n_pages_handled,
+			purge_sys->heap);
 
-		if (purge_rec->undo_rec != NULL) {
+		if (purge_rec.undo_rec == NULL) {
+			break;
+		} else if (purge_rec.undo_rec == &trx_purge_dummy_rec) {
+			/* The whole undo log needs no purge. */
+		} else {
+			trx_undo_rec_get_pars(
+				purge_rec.undo_rec, &type, &cmpl_info,
+				&updated_extern, &undo_no, &table_id);
+
+			purge_table_map_t::iterator	it
+				= table_map.find(table_id);
+
+			if (it != table_map.end()) {
+				node = it->second;
+			} else {
+				node = trx_purge_least_loaded_node(
+					purge_sys, n_purge_threads);
+
+				table_map[table_id] = node;
+			}
 
 			if (node->undo_recs == NULL) {
 				node->undo_recs = ib_vector_create(
 					ib_heap_allocator_create(node->heap),
 					sizeof(trx_purge_rec_t),
 					batch_size);
-			} else {
-				ut_a(!ib_vector_is_empty(node->undo_recs));
 			}
 
-			ib_vector_push(node->undo_recs, purge_rec);
-
-			if (n_pages_handled >= batch_size) {
-
-				break;
-			}
-		} else {
-			break;
+			ib_vector_push(node->undo_recs, &purge_rec);
 		}
 
-		thr = UT_LIST_GET_NEXT(thrs, thr);
+		if (n_pages_handled >= batch_size) {
 
-		if (!(++i % n_purge_threads)) {
-			thr = UT_LIST_GET_FIRST(purge_sys->query->thrs);
+			break;
 		}
-
-		ut_a(thr != NULL);
 	}
 
 	ut_ad(trx_purge_check_limit());
@@ -1159,6 +1210,494 @@ trx_purge_wait_for_workers_to_complete(
 	ut_a(srv_get_task_queue_length() == 0);
 }
 
+/** Undo tablespaces that were truncated by trx_purge_undo_trunc_recover()
+and whose headers must be re-created before the rollback segments are read */
+static ulint	trx_undo_trunc_fixup_spaces[TRX_SYS_N_RSEGS];
+
+/** Number of entries in trx_undo_trunc_fixup_spaces */
+static ulint	trx_undo_trunc_n_fixup;
+
+/*******************************************************************//**
+Builds the name of the file whose existence tells that an undo tablespace
+is being truncated. The file is created before the data file is shrunk,
+and removed once the re-created tablespace is covered by a checkpoint. */
+static
+void
+trx_purge_undo_trunc_log_name(
+/*==========================*/
+	char*	name,		/*!< out: file name */
+	ulint	len,		/*!< in: size of name in bytes */
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	ut_snprintf(name, len, "%s%cundo%03lu_trunc.log",
+		    srv_undo_dir, SRV_PATH_SEPARATOR, space_id);
+}
+
+/*******************************************************************//**
+Creates the truncation log file of an undo tablespace.
+@return	true if success */
+static
+bool
+trx_purge_undo_trunc_log_create(
+/*============================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	char		name[OS_FILE_MAX_PATH];
+	os_file_t	fh;
+	ibool		ret;
+
+	trx_purge_undo_trunc_log_name(name, sizeof(name), space_id);
+
+	fh = os_file_create(
+		innodb_file_data_key, name,
+		OS_FILE_CREATE | OS_FILE_ON_ERROR_NO_EXIT,
+		OS_FILE_NORMAL, OS_DATA_FILE, &ret, FALSE);
+
+	if (!ret) {
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Cannot create %s, not truncating undo tablespace "
+			"%lu", name, space_id);
+
+		return(false);
+	}
+
+	/* The file must survive a crash of the server before the
+	data file is shrunk. */
+	ret = os_file_flush(fh);
+
+	os_file_close(fh);
+
+	return(ret);
+}
+
+/*******************************************************************//**
+Checks if the truncation log file of an undo tablespace exists.
+@return	true if the tablespace was being truncated */
+static
+bool
+trx_purge_undo_trunc_log_exists(
+/*============================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	char		name[OS_FILE_MAX_PATH];
+	ibool		exists;
+	os_file_type_t	type;
+
+	trx_purge_undo_trunc_log_name(name, sizeof(name), space_id);
+
+	return(os_file_status(name, &exists, &type) && exists);
+}
+
+/*******************************************************************//**
+Removes the truncation log file of an undo tablespace. */
+static
+void
+trx_purge_undo_trunc_log_delete(
+/*============================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	char	name[OS_FILE_MAX_PATH];
+
+	trx_purge_undo_trunc_log_name(name, sizeof(name), space_id);
+
+	os_file_delete_if_exists(innodb_file_data_key, name);
+}
+
+/*******************************************************************//**
+Allows or prevents the assignment of the rollback segments of an undo
+tablespace to new transactions. */
+static
+void
+trx_purge_undo_trunc_set_skip(
+/*==========================*/
+	ulint	space_id,	/*!< in: undo tablespace id */
+	bool	skip)		/*!< in: true to stop assigning the
+				rollback segments */
+{
+	for (ulint i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+
+		if (rseg != NULL && rseg->space == space_id) {
+			mutex_enter(&rseg->mutex);
+			rseg->skip_allocation = skip;
+			mutex_exit(&rseg->mutex);
+		}
+	}
+}
+
+/*******************************************************************//**
+Selects an undo tablespace that has grown beyond innodb_max_undo_log_size,
+and stops assigning its rollback segments to new transactions, so that
+trx_purge_initiate_truncate() can truncate it once purge has processed
+all of its undo logs. The undo tablespaces are selected in a round-robin
+fashion. At least one other undo tablespace must remain available for
+new transactions, because the system tablespace cannot be shrunk and is
+not used for undo logs when undo tablespaces exist. */
+static
+void
+trx_purge_mark_undo_for_truncate(void)
+/*==================================*/
+{
+	if (!srv_undo_log_truncate
+	    || purge_sys->undo_trunc_space != ULINT_UNDEFINED
+	    || srv_undo_tablespaces_open < 2
+	    || srv_read_only_mode) {
+
+		return;
+	}
+
+	for (ulint n = 1; n <= srv_undo_tablespaces_open; ++n) {
+		ulint	space_id = (purge_sys->undo_trunc_last + n - 1)
+			% srv_undo_tablespaces_open + 1;
+		ulint	size = fil_space_get_size(space_id);
+		bool	has_rseg = false;
+		bool	has_other = false;
+
+		if (size == ULINT_UNDEFINED
+		    || (ib_uint64_t) size * UNIV_PAGE_SIZE
+		    <= srv_max_undo_log_size) {
+
+			continue;
+		}
+
+		for (ulint i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+			const trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+
+			if (rseg == NULL) {
+				break;
+			} else if (rseg->space == space_id) {
+				has_rseg = true;
+			} else if (rseg->space != 0) {
+				has_other = true;
+			}
+		}
+
+		if (!has_rseg || !has_other) {
+			continue;
+		}
+
+		trx_purge_undo_trunc_set_skip(space_id, true);
+
+		purge_sys->undo_trunc_space = space_id;
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Undo tablespace %lu of %lu pages is marked for "
+			"truncation", space_id, size);
+
+		return;
+	}
+}
+
+/*******************************************************************//**
+Truncates the undo tablespace that was marked by
+trx_purge_mark_undo_for_truncate(), if no transaction is using its
+rollback segments any more and purge has processed all of their undo
+logs. The data file is shrunk to its initial size, and the space header
+and the rollback segment headers are created again. */
+static
+void
+trx_purge_initiate_truncate(void)
+/*=============================*/
+{
+	ulint	space_id = purge_sys->undo_trunc_space;
+	ulint	n_history = 0;
+
+	if (space_id == ULINT_UNDEFINED) {
+		return;
+	}
+
+	if (!srv_undo_log_truncate) {
+		/* The truncation was disabled after the tablespace
+		was marked. */
+		trx_purge_undo_trunc_set_skip(space_id, false);
+		purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+		return;
+	}
+
+	for (ulint i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+		bool		busy;
+
+		if (rseg == NULL || rseg->space != space_id) {
+			continue;
+		}
+
+		mutex_enter(&rseg->mutex);
+
+		/* A committed transaction adds its update undo log to
+		the purge queue before it releases the rollback segment,
+		so last_page_no == FIL_NULL means that purge has read
+		all the undo logs of the rollback segment. */
+
+		busy = rseg->trx_ref_count > 0
+			|| UT_LIST_GET_LEN(rseg->update_undo_list) > 0
+			|| UT_LIST_GET_LEN(rseg->insert_undo_list) > 0
+			|| rseg->last_page_no != FIL_NULL
+			|| (purge_sys->next_stored && purge_sys->rseg == rseg);
+
+		if (!busy) {
+			mtr_t		mtr;
+			trx_rsegf_t*	rseg_hdr;
+
+			mtr_start(&mtr);
+
+			rseg_hdr = trx_rsegf_get(
+				rseg->space, rseg->zip_size, rseg->page_no,
+				&mtr);
+
+			/* The history is truncated lazily by
+			trx_purge_truncate_history(); the remaining
+			entries are freed together with the file. */
+			n_history += flst_get_len(
+				rseg_hdr + TRX_RSEG_HISTORY, &mtr);
+
+			mtr_commit(&mtr);
+		}
+
+		mutex_exit(&rseg->mutex);
+
+		if (busy) {
+			return;
+		}
+	}
+
+	if (!trx_purge_undo_trunc_log_create(space_id)) {
+		trx_purge_undo_trunc_set_skip(space_id, false);
+		purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+		return;
+	}
+
+	ulint	old_size = fil_space_get_size(space_id);
+
+	/* Write the dirty pages of the tablespace to the file before
+	they are discarded, so that the file is still consistent if it
+	cannot be truncated. The purge trx is not attached to a
+	connection, so the flush is not interrupted. */
+	buf_LRU_flush_or_remove_pages(
+		space_id, BUF_REMOVE_FLUSH_WRITE, purge_sys->trx);
+	buf_LRU_flush_or_remove_pages(space_id, BUF_REMOVE_ALL_NO_WRITE, NULL);
+
+	if (!fil_truncate_undo_tablespace(
+		    space_id, SRV_UNDO_TABLESPACE_SIZE_IN_PAGES)) {
+
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Failed to truncate undo tablespace %lu", space_id);
+
+		/* The file was not changed, and its pages were
+		written above. */
+		trx_purge_undo_trunc_log_delete(space_id);
+		trx_purge_undo_trunc_set_skip(space_id, false);
+		purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+		return;
+	}
+
+	DBUG_EXECUTE_IF("ib_undo_trunc_crash_after_truncate",
+			DBUG_SUICIDE(););
+
+	mtr_t	mtr;
+
+	mtr_start(&mtr);
+	mtr_x_lock(fil_space_get_latch(space_id, NULL), &mtr);
+	fsp_header_init(space_id, SRV_UNDO_TABLESPACE_SIZE_IN_PAGES, &mtr);
+	mtr_commit(&mtr);
+
+	for (ulint i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+		ulint		page_no;
+
+		if (rseg == NULL || rseg->space != space_id) {
+			continue;
+		}
+
+		mtr_start(&mtr);
+		mtr_x_lock(fil_space_get_latch(space_id, NULL), &mtr);
+
+		page_no = trx_rseg_header_create(
+			space_id, rseg->zip_size, rseg->max_size, rseg->id,
+			&mtr);
+
+		mtr_commit(&mtr);
+
+		/* The tablespace was just initialized with enough free
+		pages for all rollback segment headers. */
+		ut_a(page_no != FIL_NULL);
+
+		trx_rseg_mem_reset(rseg, page_no);
+	}
+
+#ifdef HAVE_ATOMIC_BUILTINS
+	os_atomic_decrement_ulint(&trx_sys->rseg_history_len, n_history);
+#else
+	mutex_enter(&trx_sys->mutex);
+	trx_sys->rseg_history_len -= n_history;
+	mutex_exit(&trx_sys->mutex);
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+	/* Make the re-created headers durable before the truncation
+	log is removed. Until then, recovery would truncate the file
+	again and ignore the redo log of the tablespace. */
+	log_make_checkpoint_at(LSN_MAX, TRUE);
+
+	trx_purge_undo_trunc_log_delete(space_id);
+
+	trx_purge_undo_trunc_set_skip(space_id, false);
+
+	purge_sys->undo_trunc_last = space_id;
+	purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+
+	srv_undo_truncations++;
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Truncated undo tablespace %lu from %lu to %lu pages",
+		space_id, old_size,
+		(ulint) SRV_UNDO_TABLESPACE_SIZE_IN_PAGES);
+}
+
+/*******************************************************************//**
+Checks if an undo tablespace was being truncated when the server was
+killed, and if so, completes the truncation of the file. Called at startup
+for each undo tablespace, before redo log apply.
+@return false if the truncation could not be completed */
+UNIV_INTERN
+bool
+trx_purge_undo_trunc_recover(
+/*=========================*/
+	const char*	name,		/*!< in: data file name */
+	ulint		space_id)	/*!< in: undo tablespace id */
+{
+	os_file_t	fh;
+	ibool		ret;
+	os_offset_t	size = (os_offset_t) SRV_UNDO_TABLESPACE_SIZE_IN_PAGES
+		* UNIV_PAGE_SIZE;
+
+	if (!trx_purge_undo_trunc_log_exists(space_id)) {
+		return(true);
+	}
+
+	if (srv_read_only_mode) {
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Undo tablespace '%s' was being truncated. "
+			"Cannot complete the truncation in read-only mode",
+			name);
+
+		return(false);
+	}
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Completing the truncation of undo tablespace '%s'", name);
+
+	fh = os_file_create(
+		innodb_file_data_key, name,
+		OS_FILE_OPEN | OS_FILE_ON_ERROR_NO_EXIT,
+		OS_FILE_NORMAL, OS_DATA_FILE, &ret, FALSE);
+
+	if (!ret) {
+		return(false);
+	}
+
+	/* All pages of the tablespace are initialized again, so the
+	old contents must not survive in the shrunk file. */
+	ret = os_file_set_eof_at(fh, 0)
+		&& os_file_set_size(name, fh, size)
+		&& os_file_flush(fh);
+
+	os_file_close(fh);
+
+	if (!ret) {
+		return(false);
+	}
+
+	ut_a(trx_undo_trunc_n_fixup < TRX_SYS_N_RSEGS);
+	trx_undo_trunc_fixup_spaces[trx_undo_trunc_n_fixup++] = space_id;
+
+	return(true);
+}
+
+/*******************************************************************//**
+Checks if the redo log for a tablespace must be ignored because the
+tablespace was truncated by trx_purge_undo_trunc_recover().
+@return true if the tablespace is being re-initialized */
+UNIV_INTERN
+bool
+trx_purge_undo_trunc_is_pending(
+/*============================*/
+	ulint	space_id)	/*!< in: tablespace id */
+{
+	for (ulint i = 0; i < trx_undo_trunc_n_fixup; ++i) {
+		if (trx_undo_trunc_fixup_spaces[i] == space_id) {
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/*******************************************************************//**
+Re-creates the space header and the rollback segment headers of the undo
+tablespaces that were truncated by trx_purge_undo_trunc_recover(). Called
+before the rollback segments are read from the TRX_SYS page. */
+UNIV_INTERN
+void
+trx_purge_undo_trunc_fixup(void)
+/*============================*/
+{
+	for (ulint n = 0; n < trx_undo_trunc_n_fixup; ++n) {
+		ulint	space_id = trx_undo_trunc_fixup_spaces[n];
+		mtr_t	mtr;
+
+		mtr_start(&mtr);
+		mtr_x_lock(fil_space_get_latch(space_id, NULL), &mtr);
+		fsp_header_init(
+			space_id, SRV_UNDO_TABLESPACE_SIZE_IN_PAGES, &mtr);
+		mtr_commit(&mtr);
+
+		for (ulint i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+			trx_sysf_t*	sys_header;
+			ulint		page_no;
+
+			mtr_start(&mtr);
+			mtr_x_lock(fil_space_get_latch(space_id, NULL), &mtr);
+
+			sys_header = trx_sysf_get(&mtr);
+
+			if (trx_sysf_rseg_get_page_no(sys_header, i, &mtr)
+			    != FIL_NULL
+			    && trx_sysf_rseg_get_space(sys_header, i, &mtr)
+			    == space_id) {
+
+				page_no = trx_rseg_header_create(
+					space_id, 0, ULINT_MAX, i, &mtr);
+
+				ut_a(page_no != FIL_NULL);
+			}
+
+			mtr_commit(&mtr);
+		}
+	}
+}
+
+/*******************************************************************//**
+Makes the re-created undo tablespaces durable with a checkpoint, and
+removes their truncation log files. Called after redo log apply. */
+UNIV_INTERN
+void
+trx_purge_undo_trunc_fixup_done(void)
+/*=================================*/
+{
+	if (trx_undo_trunc_n_fixup == 0) {
+		return;
+	}
+
+	log_make_checkpoint_at(LSN_MAX, TRUE);
+
+	for (ulint n = 0; n < trx_undo_trunc_n_fixup; ++n) {
+		trx_purge_undo_trunc_log_delete(
+			trx_undo_trunc_fixup_spaces[n]);
+	}
+
+	trx_undo_trunc_n_fixup = 0;
+}
+
 /******************************************************************//**
 Remove old historical changes from the rollback segments. */
 static
@@ -1173,6 +1712,10 @@ trx_purge_truncate(void)
 	} else {
 		trx_purge_truncate_history(&purge_sys->limit, purge_sys->view);
 	}
+
+	trx_purge_mark_undo_for_truncate();
+
+	trx_purge_initiate_truncate();
 }
 
 /*******************************************************************//**
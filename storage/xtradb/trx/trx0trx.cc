@@ -696,6 +696,7 @@ trx_resurrect_insert(
 	trx = trx_allocate_for_background();
 
 	trx->rseg = rseg;
+	rseg->trx_ref_count++;
 	trx->xid = undo->xid;
 	trx->id = undo->trx_id;
 	trx->insert_undo = undo;
@@ -816,6 +817,10 @@ trx_resurrect_update(
 	trx_undo_t*	undo,	/*!< in/out: update UNDO record */
 	trx_rseg_t*	rseg)	/*!< in/out: rollback segment */
 {
+	if (trx->rseg == NULL) {
+		rseg->trx_ref_count++;
+	}
+
 	trx->rseg = rseg;
 	trx->xid = undo->xid;
 	trx->id = undo->trx_id;
@@ -982,18 +987,55 @@ trx_assign_rseg_low(
 	defined for rollback segments. We want all UNDO records to be in
 	the non-system tablespaces. */
 
-	do {
-		rseg = trx_sys->rseg_array[i];
-		ut_a(rseg == NULL || i == rseg->id);
+	for (;;) {
+		do {
+			rseg = trx_sys->rseg_array[i];
+			ut_a(rseg == NULL || i == rseg->id);
+
+			i = (rseg == NULL || i + 1 == TRX_SYS_N_RSEGS)
+				? 0 : i + 1;
+
+		} while (rseg == NULL
+			 || (rseg->space == 0
+			     && n_tablespaces > 0
+			     && trx_sys->rseg_array[1] != NULL)
+			 || rseg->skip_allocation);
+
+		/* Skip the rollback segments of an undo tablespace that
+		is being truncated. Purge will only truncate it after the
+		last transaction has released its rollback segment. */
+
+		mutex_enter(&rseg->mutex);
+
+		if (!rseg->skip_allocation) {
+			rseg->trx_ref_count++;
+			mutex_exit(&rseg->mutex);
+
+			return(rseg);
+		}
 
-		i = (rseg == NULL) ? 0 : i + 1;
+		mutex_exit(&rseg->mutex);
+	}
+}
+
+/****************************************************************//**
+Releases the rollback segment of a transaction. */
+static
+void
+trx_release_rseg(
+/*=============*/
+	trx_t*	trx)	/*!< in/out: transaction */
+{
+	trx_rseg_t*	rseg = trx->rseg;
 
-	} while (rseg == NULL
-		 || (rseg->space == 0
-		     && n_tablespaces > 0
-		     && trx_sys->rseg_array[1] != NULL));
+	if (rseg != NULL) {
+		mutex_enter(&rseg->mutex);
+		ut_ad(rseg->trx_ref_count > 0);
+		rseg->trx_ref_count--;
+		mutex_exit(&rseg->mutex);
 
-	return(rseg);
+		trx->rseg = NULL;
+	}
 }
 
 /****************************************************************//**
@@ -1546,7 +1588,7 @@ trx_commit_in_memory(
 	trx_named_savept_t*	savep = UT_LIST_GET_FIRST(trx->trx_savepoints);
 	trx_roll_savepoints_free(trx, savep);
 
-	trx->rseg = NULL;
+	trx_release_rseg(trx);
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
 
@@ -1692,7 +1734,7 @@ trx_cleanup_at_db_startup(
 		trx_undo_insert_cleanup(trx);
 	}
 
-	trx->rseg = NULL;
+	trx_release_rseg(trx);
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
 